@@ -111,6 +111,10 @@ enum options_client
   OPT_ENABLE_COMPRESSED_COLUMNS,
   OPT_ENABLE_COMPRESSED_COLUMNS_WITH_DICTIONARIES,
   OPT_DROP_COMPRESSION_DICTIONARY,
+  OPT_PARALLEL,
+  OPT_PARALLEL_CHUNK_ROWS,
+  OPT_COMPRESS_OUTPUT,
+  OPT_PARALLEL_DUMP,
   OPT_MAX_CLIENT_OPTION
 };
 
@@ -48,6 +48,7 @@
 #include <hash.h>
 #include <stdarg.h>
 #include <my_list.h>
+#include <zlib.h>
 
 #include "client_priv.h"
 #include "my_default.h"
@@ -123,7 +124,8 @@ static my_bool  verbose= 0, opt_no_create_info= 0, opt_no_data= 0,
                 opt_secure_auth= 1,
                 opt_compressed_columns= 0,
                 opt_compressed_columns_with_dictionaries= 0,
-                opt_drop_compression_dictionary= 1;
+                opt_drop_compression_dictionary= 1,
+                opt_compress_output= 0;
 static my_bool insert_pat_inited= 0, debug_info_flag= 0, debug_check_flag= 0;
 static ulong opt_max_allowed_packet, opt_net_buffer_length;
 static MYSQL mysql_connection,*mysql=0;
@@ -153,6 +155,8 @@ static char * opt_mysql_unix_port=0;
 static char *opt_bind_addr = NULL;
 static int   first_error=0;
 static uint opt_lock_for_backup= 0;
+static uint opt_parallel= 0;
+static ulonglong opt_parallel_chunk_rows;
 #include <sslopt-vars.h>
 FILE *md_result_file= 0;
 FILE *stderror_file=0;
@@ -466,6 +470,23 @@ static struct my_option my_long_options[] =
   {"opt", OPT_OPTIMIZE,
    "Same as --add-drop-table, --add-locks, --create-options, --quick, --extended-insert, --lock-tables, --set-charset, and --disable-keys. Enabled by default, disable with --skip-opt.",
    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"parallel", OPT_PARALLEL,
+   "Dump table data over this many additional connections. All of them "
+   "share the consistent snapshot of --single-transaction. Works only "
+   "together with --tab; the data files are then written by mysqldump "
+   "itself instead of the server.",
+   &opt_parallel, &opt_parallel, 0, GET_UINT, REQUIRED_ARG,
+   0, 0, 256, 0, 0, 0},
+  {"parallel-chunk-rows", OPT_PARALLEL_CHUNK_ROWS,
+   "With --parallel, split tables with a single column integer primary key "
+   "into chunks of about this many rows. Each chunk is dumped to its own "
+   "data file.",
+   &opt_parallel_chunk_rows, &opt_parallel_chunk_rows, 0, GET_ULL,
+   REQUIRED_ARG, 1000000, 1, ULONGLONG_MAX, 0, 0, 0},
+  {"compress-output", OPT_COMPRESS_OUTPUT,
+   "With --parallel, write the data files compressed with gzip.",
+   &opt_compress_output, &opt_compress_output, 0, GET_BOOL, NO_ARG,
+   0, 0, 0, 0, 0, 0},
   {"order-by-primary", OPT_ORDER_BY_PRIMARY,
    "Sorts each table's rows by primary key, or first unique key, if such a key exists.  Useful when dumping a MyISAM table to be loaded into an InnoDB table, but will make the dump itself take considerably longer.",
    &opt_order_by_primary, &opt_order_by_primary, 0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
@@ -1089,6 +1110,25 @@ static int get_options(int *argc, char ***argv)
     fprintf(stderr, "%s: You can't use ..enclosed.. and ..optionally-enclosed.. at the same time.\n", my_progname);
     return(EX_USAGE);
   }
+  if (opt_parallel && (!path || !opt_single_transaction))
+  {
+    fprintf(stderr, "%s: --parallel requires --tab and "
+            "--single-transaction.\n", my_progname);
+    return(EX_USAGE);
+  }
+  if (opt_parallel && (enclosed || opt_enclosed || escaped ||
+                       lines_terminated || fields_terminated))
+  {
+    fprintf(stderr, "%s: --parallel can't be used with --fields-... "
+            "or --lines-terminated-by.\n", my_progname);
+    return(EX_USAGE);
+  }
+  if (opt_compress_output && !opt_parallel)
+  {
+    fprintf(stderr, "%s: --compress-output requires --parallel.\n",
+            my_progname);
+    return(EX_USAGE);
+  }
   if ((opt_databases || opt_alldbs) && path)
   {
     fprintf(stderr,
@@ -1617,54 +1657,64 @@ static void maybe_exit(int error)
 
 
 /*
-  db_connect -- connects to the host and selects DB.
+  Set the connect options given on the command line for a connection.
 */
 
-static int connect_to_db(char *host, char *user,char *passwd)
+static void set_connection_options(MYSQL *mysql_con)
 {
-  char buff[20+FN_REFLEN];
-  DBUG_ENTER("connect_to_db");
-
-  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
-  mysql_init(&mysql_connection);
   if (opt_compress)
-    mysql_options(&mysql_connection,MYSQL_OPT_COMPRESS,NullS);
+    mysql_options(mysql_con,MYSQL_OPT_COMPRESS,NullS);
 #ifdef HAVE_OPENSSL
   if (opt_use_ssl)
   {
-    mysql_ssl_set(&mysql_connection, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
+    mysql_ssl_set(mysql_con, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
                   opt_ssl_capath, opt_ssl_cipher);
-    mysql_options(&mysql_connection, MYSQL_OPT_SSL_CRL, opt_ssl_crl);
-    mysql_options(&mysql_connection, MYSQL_OPT_SSL_CRLPATH, opt_ssl_crlpath);
+    mysql_options(mysql_con, MYSQL_OPT_SSL_CRL, opt_ssl_crl);
+    mysql_options(mysql_con, MYSQL_OPT_SSL_CRLPATH, opt_ssl_crlpath);
   }
-  mysql_options(&mysql_connection,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
+  mysql_options(mysql_con,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
                 (char*)&opt_ssl_verify_server_cert);
 #endif
   if (opt_protocol)
-    mysql_options(&mysql_connection,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
+    mysql_options(mysql_con,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
   if (opt_bind_addr)
-    mysql_options(&mysql_connection,MYSQL_OPT_BIND,opt_bind_addr);
+    mysql_options(mysql_con,MYSQL_OPT_BIND,opt_bind_addr);
   if (!opt_secure_auth)
-    mysql_options(&mysql_connection,MYSQL_SECURE_AUTH,(char*)&opt_secure_auth);
+    mysql_options(mysql_con,MYSQL_SECURE_AUTH,(char*)&opt_secure_auth);
 #ifdef HAVE_SMEM
   if (shared_memory_base_name)
-    mysql_options(&mysql_connection,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
+    mysql_options(mysql_con,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
 #endif
-  mysql_options(&mysql_connection, MYSQL_SET_CHARSET_NAME, default_charset);
+  mysql_options(mysql_con, MYSQL_SET_CHARSET_NAME, default_charset);
 
   if (opt_plugin_dir && *opt_plugin_dir)
-    mysql_options(&mysql_connection, MYSQL_PLUGIN_DIR, opt_plugin_dir);
+    mysql_options(mysql_con, MYSQL_PLUGIN_DIR, opt_plugin_dir);
 
   if (opt_default_auth && *opt_default_auth)
-    mysql_options(&mysql_connection, MYSQL_DEFAULT_AUTH, opt_default_auth);
+    mysql_options(mysql_con, MYSQL_DEFAULT_AUTH, opt_default_auth);
 
   if (using_opt_enable_cleartext_plugin)
-    mysql_options(&mysql_connection, MYSQL_ENABLE_CLEARTEXT_PLUGIN,
+    mysql_options(mysql_con, MYSQL_ENABLE_CLEARTEXT_PLUGIN,
                   (char *) &opt_enable_cleartext_plugin);
 
-  mysql_options(&mysql_connection, MYSQL_OPT_CONNECT_ATTR_RESET, 0);
-  mysql_options4(&mysql_connection, MYSQL_OPT_CONNECT_ATTR_ADD,
+  mysql_options(mysql_con, MYSQL_OPT_CONNECT_ATTR_RESET, 0);
+  mysql_options4(mysql_con, MYSQL_OPT_CONNECT_ATTR_ADD,
                  "program_name", "mysqldump");
+}
+
+
+/*
+  db_connect -- connects to the host and selects DB.
+*/
+
+static int connect_to_db(char *host, char *user,char *passwd)
+{
+  char buff[20+FN_REFLEN];
+  DBUG_ENTER("connect_to_db");
+
+  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
+  mysql_init(&mysql_connection);
+  set_connection_options(&mysql_connection);
   if (!(mysql= mysql_connect_ssl_check(&mysql_connection, host, user,
                                        passwd, NULL, opt_mysql_port,
                                        opt_mysql_unix_port, 0,
@@ -4238,6 +4288,657 @@ static void dump_skipped_keys(const char *table)
 }
 
 
+/*
+  Parallel dump of table data (--parallel).
+
+  The main connection writes the table structures and splits the table
+  data into chunks. The chunks are dumped by worker threads, each over its
+  own connection. Every worker clones the consistent snapshot of the main
+  connection with START TRANSACTION WITH CONSISTENT SNAPSHOT FROM SESSION,
+  so all of them see the same data. A chunk is written by the worker to
+  its own data file in the default LOAD DATA INFILE format, optionally
+  compressed with gzip, so that mysqlimport --parallel-dump can load the
+  files back concurrently.
+*/
+
+typedef struct st_dump_chunk
+{
+  char *query;                          /* SELECT returning the rows */
+  char *filename;                       /* Data file to write them to */
+  struct st_dump_chunk *next;
+} DUMP_CHUNK;
+
+typedef struct st_dump_worker
+{
+  MYSQL mysql;
+  pthread_t thread;
+  my_bool started;
+} DUMP_WORKER;
+
+static DUMP_WORKER *dump_workers= 0;
+static uint dump_workers_count= 0;
+static DUMP_CHUNK *dump_chunks_first= 0, **dump_chunks_last= &dump_chunks_first;
+static my_bool dump_chunks_done= 0;
+static int dump_workers_error= 0;
+static pthread_mutex_t dump_chunks_mutex;
+static pthread_cond_t dump_chunks_cond;
+
+/* Size of the buffer a worker collects rows in before writing them */
+#define DUMP_CHUNK_BUFFER_SIZE (256 * 1024)
+
+
+/*
+  Record an error of a worker thread. The main thread stops when it
+  queues the next chunk, unless --force is given.
+*/
+
+static void dump_worker_error(int error_num, const char *fmt, ...)
+{
+  char buffer[1000];
+  va_list args;
+  va_start(args, fmt);
+  my_vsnprintf(buffer, sizeof(buffer), fmt, args);
+  va_end(args);
+
+  pthread_mutex_lock(&dump_chunks_mutex);
+  fprintf(stderr, "%s: %s\n", my_progname, buffer);
+  fflush(stderr);
+  if (!dump_workers_error)
+    dump_workers_error= error_num;
+  pthread_mutex_unlock(&dump_chunks_mutex);
+}
+
+
+static void free_dump_chunk(DUMP_CHUNK *chunk)
+{
+  my_free(chunk->query);
+  my_free(chunk->filename);
+  my_free(chunk);
+}
+
+
+/*
+  Write the collected rows of a chunk to its data file.
+
+  RETURN VALUES
+    0        Ok
+    1        Write error
+*/
+
+static int write_chunk_buffer(FILE *file, gzFile gz_file,
+                              DYNAMIC_STRING *buffer)
+{
+  int error= 0;
+  if (buffer->length)
+  {
+    if (gz_file)
+      error= gzwrite(gz_file, buffer->str, (unsigned) buffer->length) !=
+             (int) buffer->length;
+    else
+      error= my_fwrite(file, (uchar*) buffer->str, buffer->length,
+                       MYF(MY_WME | MY_NABP)) != 0;
+  }
+  buffer->length= 0;
+  return error;
+}
+
+
+/*
+  Append a column value in the format SELECT ... INTO OUTFILE uses with
+  the default FIELDS and LINES options.
+*/
+
+static my_bool append_chunk_value(DYNAMIC_STRING *buffer, const char *value,
+                                  ulong length)
+{
+  const char *pos, *start, *end= value + length;
+
+  if (!value)
+    return dynstr_append_mem(buffer, "\\N", 2);
+  for (start= pos= value; pos != end; pos++)
+  {
+    if (*pos == '\\' || *pos == '\t' || *pos == '\n' || !*pos)
+    {
+      char escaped_char[2];
+      escaped_char[0]= '\\';
+      escaped_char[1]= *pos ? *pos : '0';
+      if (dynstr_append_mem(buffer, start, (uint) (pos - start)) ||
+          dynstr_append_mem(buffer, escaped_char, 2))
+        return TRUE;
+      start= pos + 1;
+    }
+  }
+  return dynstr_append_mem(buffer, start, (uint) (pos - start));
+}
+
+
+/*
+  Dump the rows of one chunk into its data file.
+
+  RETURN VALUES
+    0        Ok
+    > 0      Error code, the error is already reported
+*/
+
+static int dump_chunk(MYSQL *mysql_con, DUMP_CHUNK *chunk)
+{
+  FILE *file= 0;
+  gzFile gz_file= 0;
+  MYSQL_RES *res= 0;
+  MYSQL_ROW row;
+  DYNAMIC_STRING buffer;
+  uint num_fields, i;
+  int error= 0;
+
+  verbose_msg("-- Dumping chunk to %s...\n", chunk->filename);
+  if (init_dynamic_string(&buffer, "", DUMP_CHUNK_BUFFER_SIZE + 1024, 1024))
+  {
+    dump_worker_error(EX_EOM, "Couldn't allocate memory");
+    return EX_EOM;
+  }
+
+  if (opt_compress_output)
+    gz_file= gzopen(chunk->filename, "wb");
+  else
+    file= my_fopen(chunk->filename, O_WRONLY | O_TRUNC, MYF(MY_WME));
+  if (!file && !gz_file)
+  {
+    dump_worker_error(EX_EOF, "Couldn't open file '%s'", chunk->filename);
+    error= EX_EOF;
+    goto err;
+  }
+
+  if (mysql_query(mysql_con, chunk->query) ||
+      !(res= mysql_use_result(mysql_con)))
+  {
+    dump_worker_error(EX_MYSQLERR, "Couldn't execute '%s': %s (%d)",
+                      chunk->query, mysql_error(mysql_con),
+                      mysql_errno(mysql_con));
+    error= EX_MYSQLERR;
+    goto err;
+  }
+
+  num_fields= mysql_num_fields(res);
+  while ((row= mysql_fetch_row(res)))
+  {
+    ulong *lengths= mysql_fetch_lengths(res);
+    for (i= 0; i < num_fields; i++)
+    {
+      if ((i && dynstr_append_mem(&buffer, "\t", 1)) ||
+          append_chunk_value(&buffer, row[i], lengths[i]))
+      {
+        dump_worker_error(EX_EOM, "Couldn't allocate memory");
+        error= EX_EOM;
+        goto err;
+      }
+    }
+    if (dynstr_append_mem(&buffer, "\n", 1))
+    {
+      dump_worker_error(EX_EOM, "Couldn't allocate memory");
+      error= EX_EOM;
+      goto err;
+    }
+    if (buffer.length >= DUMP_CHUNK_BUFFER_SIZE &&
+        write_chunk_buffer(file, gz_file, &buffer))
+    {
+      dump_worker_error(EX_EOF, "Got error on write to '%s'",
+                        chunk->filename);
+      error= EX_EOF;
+      goto err;
+    }
+  }
+  if (mysql_errno(mysql_con))
+  {
+    dump_worker_error(EX_MYSQLERR, "Error %d: %s when dumping chunk to '%s'",
+                      mysql_errno(mysql_con), mysql_error(mysql_con),
+                      chunk->filename);
+    error= EX_MYSQLERR;
+    goto err;
+  }
+  if (write_chunk_buffer(file, gz_file, &buffer))
+  {
+    dump_worker_error(EX_EOF, "Got error on write to '%s'", chunk->filename);
+    error= EX_EOF;
+  }
+
+err:
+  if (res)
+    mysql_free_result(res);
+  if (gz_file && gzclose(gz_file) != Z_OK && !error)
+  {
+    dump_worker_error(EX_EOF, "Got error on close of '%s'", chunk->filename);
+    error= EX_EOF;
+  }
+  if (file && my_fclose(file, MYF(MY_WME)) && !error)
+  {
+    dump_worker_error(EX_EOF, "Got error on close of '%s'", chunk->filename);
+    error= EX_EOF;
+  }
+  dynstr_free(&buffer);
+  return error;
+}
+
+
+pthread_handler_t dump_worker_thread(void *arg)
+{
+  DUMP_WORKER *worker= (DUMP_WORKER*) arg;
+  my_bool use_savepoint=
+    mysql_get_server_version(&worker->mysql) >= 50500;
+
+  if (mysql_thread_init())
+  {
+    dump_worker_error(EX_MYSQLERR, "Couldn't initialize worker thread");
+    goto end;
+  }
+
+  if (use_savepoint && mysql_query(&worker->mysql, "SAVEPOINT sp"))
+  {
+    dump_worker_error(EX_MYSQLERR, "Couldn't execute 'SAVEPOINT sp': %s (%d)",
+                      mysql_error(&worker->mysql),
+                      mysql_errno(&worker->mysql));
+    goto end;
+  }
+
+  for (;;)
+  {
+    DUMP_CHUNK *chunk;
+    int error;
+
+    pthread_mutex_lock(&dump_chunks_mutex);
+    while (!dump_chunks_first && !dump_chunks_done)
+      pthread_cond_wait(&dump_chunks_cond, &dump_chunks_mutex);
+    if ((chunk= dump_chunks_first))
+    {
+      if (!(dump_chunks_first= chunk->next))
+        dump_chunks_last= &dump_chunks_first;
+    }
+    pthread_mutex_unlock(&dump_chunks_mutex);
+    if (!chunk)
+      break;
+
+    error= dump_chunk(&worker->mysql, chunk);
+    free_dump_chunk(chunk);
+    if (error == EX_MYSQLERR && !ignore_errors)
+      break;
+
+    /*
+      Release the metadata lock on the dumped table, like the main
+      connection does in --single-transaction mode.
+    */
+    if (use_savepoint && mysql_query(&worker->mysql, "ROLLBACK TO SAVEPOINT sp"))
+    {
+      dump_worker_error(EX_MYSQLERR,
+                        "Couldn't execute 'ROLLBACK TO SAVEPOINT sp': %s (%d)",
+                        mysql_error(&worker->mysql),
+                        mysql_errno(&worker->mysql));
+      break;
+    }
+  }
+
+end:
+  mysql_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/*
+  Open the worker connections of --parallel and start the worker threads.
+
+  The main connection must already be in its consistent snapshot
+  transaction, which the workers clone.
+
+  RETURN VALUES
+    0        Ok
+    1        Error
+*/
+
+static int start_dump_workers(void)
+{
+  char buff[64 + 2 * NAME_LEN];
+  uint i;
+  DBUG_ENTER("start_dump_workers");
+
+  pthread_mutex_init(&dump_chunks_mutex, NULL);
+  pthread_cond_init(&dump_chunks_cond, NULL);
+
+  if (!(dump_workers= (DUMP_WORKER*) my_malloc(opt_parallel *
+                                               sizeof(DUMP_WORKER),
+                                               MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+
+  for (i= 0; i < opt_parallel; i++)
+  {
+    DUMP_WORKER *worker= dump_workers + i;
+
+    verbose_msg("-- Connecting worker %u to %s...\n", i + 1,
+                current_host ? current_host : "localhost");
+    mysql_init(&worker->mysql);
+    dump_workers_count++;
+    set_connection_options(&worker->mysql);
+    if (!mysql_connect_ssl_check(&worker->mysql, current_host, current_user,
+                                 opt_password, NULL, opt_mysql_port,
+                                 opt_mysql_unix_port, 0,
+                                 opt_ssl_mode == SSL_MODE_REQUIRED))
+    {
+      DB_error(&worker->mysql, "when trying to connect");
+      DBUG_RETURN(1);
+    }
+    worker->mysql.reconnect= 0;
+
+    /*
+      Rows are written to the data files the way the server writes them for
+      --tab, that is in the binary character set unless a character set was
+      given explicitly.
+    */
+    my_snprintf(buff, sizeof(buff), "/*!40101 SET NAMES %s */",
+                default_charset == mysql_universal_client_charset ?
+                my_charset_bin.csname : default_charset);
+    if (mysql_query_with_error_report(&worker->mysql, 0, buff))
+      DBUG_RETURN(1);
+    my_snprintf(buff, sizeof(buff), "/*!40100 SET @@SQL_MODE='%s' */",
+                compatible_mode_normal_str);
+    if (mysql_query_with_error_report(&worker->mysql, 0, buff))
+      DBUG_RETURN(1);
+    if (opt_tz_utc &&
+        mysql_query_with_error_report(&worker->mysql, 0,
+                                      "/*!40103 SET TIME_ZONE='+00:00' */"))
+      DBUG_RETURN(1);
+
+    if (mysql_query_with_error_report(&worker->mysql, 0,
+                                      "SET SESSION TRANSACTION ISOLATION "
+                                      "LEVEL REPEATABLE READ"))
+      DBUG_RETURN(1);
+    my_snprintf(buff, sizeof(buff),
+                "START TRANSACTION WITH CONSISTENT SNAPSHOT FROM SESSION %lu",
+                mysql_thread_id(mysql));
+    if (mysql_query(&worker->mysql, buff))
+    {
+      fprintf(stderr, "%s: Error: Couldn't clone the consistent snapshot of "
+              "the main connection: %s (%d). --parallel needs a server "
+              "that supports START TRANSACTION WITH CONSISTENT SNAPSHOT "
+              "FROM SESSION.\n", my_progname, mysql_error(&worker->mysql),
+              mysql_errno(&worker->mysql));
+      DBUG_RETURN(1);
+    }
+  }
+
+  for (i= 0; i < opt_parallel; i++)
+  {
+    DUMP_WORKER *worker= dump_workers + i;
+    if (pthread_create(&worker->thread, NULL, dump_worker_thread, worker))
+    {
+      fprintf(stderr, "%s: Could not create thread\n", my_progname);
+      DBUG_RETURN(1);
+    }
+    worker->started= 1;
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Wait until the workers have dumped all queued chunks and disconnect them.
+
+  RETURN VALUES
+    0        Ok
+    > 0      Error code of the first failed chunk
+*/
+
+static int finish_dump_workers(void)
+{
+  uint i;
+  DBUG_ENTER("finish_dump_workers");
+
+  if (!dump_workers)
+    DBUG_RETURN(0);
+
+  pthread_mutex_lock(&dump_chunks_mutex);
+  dump_chunks_done= 1;
+  pthread_cond_broadcast(&dump_chunks_cond);
+  pthread_mutex_unlock(&dump_chunks_mutex);
+
+  for (i= 0; i < dump_workers_count; i++)
+  {
+    DUMP_WORKER *worker= dump_workers + i;
+    if (worker->started && pthread_join(worker->thread, NULL))
+      fprintf(stderr, "%s: Could not join worker thread.\n", my_progname);
+    mysql_close(&worker->mysql);
+  }
+  my_free(dump_workers);
+  dump_workers= 0;
+  dump_workers_count= 0;
+
+  /* Chunks left over after the workers stopped on an error */
+  while (dump_chunks_first)
+  {
+    DUMP_CHUNK *chunk= dump_chunks_first;
+    dump_chunks_first= chunk->next;
+    free_dump_chunk(chunk);
+  }
+  dump_chunks_last= &dump_chunks_first;
+
+  pthread_mutex_destroy(&dump_chunks_mutex);
+  pthread_cond_destroy(&dump_chunks_cond);
+  DBUG_RETURN(dump_workers_error);
+}
+
+
+/*
+  Queue a chunk of table data for the worker threads.
+*/
+
+static void queue_dump_chunk(const char *query, const char *filename)
+{
+  DUMP_CHUNK *chunk;
+  int error;
+
+  if (!(chunk= (DUMP_CHUNK*) my_malloc(sizeof(DUMP_CHUNK), MYF(MY_WME))) ||
+      !(chunk->query= my_strdup(query, MYF(MY_WME))) ||
+      !(chunk->filename= my_strdup(filename, MYF(MY_WME))))
+    die(EX_EOM, "Couldn't allocate memory");
+  chunk->next= 0;
+
+  pthread_mutex_lock(&dump_chunks_mutex);
+  error= dump_workers_error;
+  *dump_chunks_last= chunk;
+  dump_chunks_last= &chunk->next;
+  pthread_cond_signal(&dump_chunks_cond);
+  pthread_mutex_unlock(&dump_chunks_mutex);
+
+  if (error && !ignore_errors)
+    die(error, "Stopping because of an error in a worker thread");
+}
+
+
+/*
+  Find the column a table can be split into chunks by.
+
+  SYNOPSIS
+    get_chunk_column()
+    table         quoted name of the table
+    column        buffer of NAME_LEN+1 bytes for the column name
+    is_unsigned   set if the column is unsigned
+
+  RETURN VALUES
+    0        The table has a primary key over one integer column
+    1        The table can't be split
+*/
+
+static int get_chunk_column(const char *table, char *column,
+                            my_bool *is_unsigned)
+{
+  char query[QUERY_LENGTH], show_name_buff[NAME_LEN * 2 + 3];
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  my_bool found= FALSE;
+
+  my_snprintf(query, sizeof(query), "SHOW KEYS FROM %s", table);
+  if (mysql_query_with_error_report(mysql, &res, query))
+    return 1;
+  /* The PRIMARY key is always the first one */
+  if ((row= mysql_fetch_row(res)) && !strcmp(row[2], "PRIMARY") &&
+      (!(row= mysql_fetch_row(res)) || strcmp(row[2], "PRIMARY")))
+  {
+    mysql_data_seek(res, 0);
+    row= mysql_fetch_row(res);
+    strmake(column, row[4], NAME_LEN);
+    found= TRUE;
+  }
+  mysql_free_result(res);
+  if (!found)
+    return 1;
+
+  my_snprintf(query, sizeof(query), "SHOW COLUMNS FROM %s LIKE %s",
+              table, quote_for_like(column, show_name_buff));
+  if (mysql_query_with_error_report(mysql, &res, query))
+    return 1;
+  found= FALSE;
+  if ((row= mysql_fetch_row(res)))
+  {
+    const char *type= row[SHOW_TYPE];
+    if (is_prefix(type, "tinyint") || is_prefix(type, "smallint") ||
+        is_prefix(type, "mediumint") || is_prefix(type, "int") ||
+        is_prefix(type, "bigint"))
+    {
+      *is_unsigned= strstr(type, "unsigned") != NULL;
+      found= TRUE;
+    }
+  }
+  mysql_free_result(res);
+  return !found;
+}
+
+
+/*
+  Split the data of a table into chunks and queue them for the workers.
+
+  SYNOPSIS
+    queue_table_chunks()
+    table         name of the table
+    db            name of the database
+    tmp_path      directory of the data files
+*/
+
+static void queue_table_chunks(char *table, char *db, const char *tmp_path)
+{
+  char db_buff[NAME_LEN * 2 + 3], table_buff[NAME_LEN * 2 + 3];
+  char column[NAME_LEN + 1], column_buff[NAME_LEN * 2 + 3];
+  char query[QUERY_LENGTH], name[FN_REFLEN], filename[FN_REFLEN];
+  char show_name_buff[NAME_LEN * 2 + 3];
+  char *result_table, *quoted_column= 0;
+  my_bool is_unsigned= FALSE;
+  int err;
+  ulonglong rows= 0, min_value= 0, span= 0, step= 0, chunks= 1, i;
+  DYNAMIC_STRING chunk_query;
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  const char *ext= opt_compress_output ? ".txt.gz" : ".txt";
+
+  result_table= quote_name(table, table_buff, 1);
+
+  if (!get_chunk_column(result_table, column, &is_unsigned))
+  {
+    my_snprintf(query, sizeof(query), "SHOW TABLE STATUS LIKE %s",
+                quote_for_like(table, show_name_buff));
+    if (!mysql_query_with_error_report(mysql, &res, query))
+    {
+      if ((row= mysql_fetch_row(res)) && mysql_num_fields(res) > 4 && row[4])
+        rows= (ulonglong) my_strtoll10(row[4], NULL, &err);
+      mysql_free_result(res);
+    }
+    chunks= rows / opt_parallel_chunk_rows + 1;
+  }
+
+  if (chunks > 1)
+  {
+    /* MIN() and MAX() are read in the snapshot shared with the workers */
+    quoted_column= quote_name(column, column_buff, 1);
+    my_snprintf(query, sizeof(query), "SELECT MIN(%s), MAX(%s) FROM %s",
+                quoted_column, quoted_column, result_table);
+    chunks= 1;
+    if (!mysql_query_with_error_report(mysql, &res, query))
+    {
+      if ((row= mysql_fetch_row(res)) && row[0] && row[1])
+      {
+        /* my_strtoll10() returns unsigned values above LONGLONG_MAX too */
+        ulonglong max_value= (ulonglong) my_strtoll10(row[1], NULL, &err);
+        min_value= (ulonglong) my_strtoll10(row[0], NULL, &err);
+        /* Modular arithmetic gives the span for signed values too */
+        span= max_value - min_value;
+        chunks= rows / opt_parallel_chunk_rows + 1;
+        if (span < chunks - 1)
+          chunks= span + 1;
+        step= span / chunks + 1;
+      }
+      mysql_free_result(res);
+    }
+  }
+
+  verbose_msg("-- Queueing %llu chunk(s) of table '%s'...\n", chunks, table);
+  init_dynamic_string_checked(&chunk_query, "", 1024, 1024);
+  for (i= 0; i < chunks; i++)
+  {
+    my_bool has_where= FALSE;
+
+    dynstr_set_checked(&chunk_query,
+                       "SELECT /*!40001 SQL_NO_CACHE */ * FROM ");
+    dynstr_append_checked(&chunk_query, quote_name(db, db_buff, 1));
+    dynstr_append_checked(&chunk_query, ".");
+    dynstr_append_checked(&chunk_query, result_table);
+    if (where)
+    {
+      dynstr_append_checked(&chunk_query, " WHERE (");
+      dynstr_append_checked(&chunk_query, where);
+      dynstr_append_checked(&chunk_query, ")");
+      has_where= TRUE;
+    }
+    if (chunks > 1)
+    {
+      /* Chunk i holds the values in [min + i * step, min + (i + 1) * step) */
+      char bound[LONGLONG_LEN + 1];
+      if (i > 0)
+      {
+        ulonglong value= min_value + i * step;
+        dynstr_append_checked(&chunk_query, has_where ? " AND " : " WHERE ");
+        dynstr_append_checked(&chunk_query, quoted_column);
+        dynstr_append_checked(&chunk_query, " >= ");
+        if (is_unsigned)
+          ullstr(value, bound);
+        else
+          llstr((longlong) value, bound);
+        dynstr_append_checked(&chunk_query, bound);
+        has_where= TRUE;
+      }
+      if (i < chunks - 1)
+      {
+        ulonglong value= min_value + (i + 1) * step;
+        dynstr_append_checked(&chunk_query, has_where ? " AND " : " WHERE ");
+        dynstr_append_checked(&chunk_query, quoted_column);
+        dynstr_append_checked(&chunk_query, " < ");
+        if (is_unsigned)
+          ullstr(value, bound);
+        else
+          llstr((longlong) value, bound);
+        dynstr_append_checked(&chunk_query, bound);
+      }
+    }
+    if (order_by)
+    {
+      dynstr_append_checked(&chunk_query, " ORDER BY ");
+      dynstr_append_checked(&chunk_query, order_by);
+    }
+
+    /* The chunk number is always there for mysqlimport --parallel-dump */
+    my_snprintf(name, sizeof(name), "%s.%06llu", table, i + 1);
+    fn_format(filename, name, tmp_path, ext,
+              MYF(MY_UNPACK_FILENAME | MY_APPEND_EXT));
+    queue_dump_chunk(chunk_query.str, filename);
+  }
+  dynstr_free(&chunk_query);
+}
+
+
 /*
 
  SYNOPSIS
@@ -4333,6 +5034,17 @@ static void dump_table(char *table, char *db)
     */
     convert_dirname(tmp_path,path,NullS);    
     my_load_path(tmp_path, tmp_path, NULL);
+
+    if (opt_parallel)
+    {
+      /* The data files are written by the worker threads */
+      queue_table_chunks(table, db, tmp_path);
+      dynstr_free(&query_string);
+      if (extended_insert)
+        dynstr_free(&extended_row);
+      DBUG_VOID_RETURN;
+    }
+
     fn_format(filename, table, tmp_path, ".txt", MYF(MY_UNPACK_FILENAME));
 
     /* Must delete the file that 'INTO OUTFILE' will write to */
@@ -6814,6 +7526,9 @@ int main(int argc, char **argv)
   if (opt_single_transaction && start_transaction(mysql))
     goto err;
 
+  if (opt_parallel && start_dump_workers())
+    goto err;
+
   /* Add 'STOP SLAVE to beginning of dump */
   if (opt_slave_apply && add_stop_slave())
     goto err;
@@ -6873,6 +7588,14 @@ int main(int argc, char **argv)
     }
   }
 
+  if ((exit_code= finish_dump_workers()))
+  {
+    if (!first_error)
+      first_error= exit_code;
+    if (!ignore_errors)
+      goto err;
+  }
+
   /* if --dump-slave , start the slave sql thread */
   if (opt_slave_data && do_start_slave_sql(mysql))
     goto err;
@@ -6919,6 +7642,7 @@ int main(int argc, char **argv)
     server.
   */
 err:
+  (void) finish_dump_workers();
   dbDisconnect(current_host);
   if (!path)
     write_footer(md_result_file);
@@ -27,6 +27,7 @@
 #include "mysql_version.h"
 
 #include <welcome_copyright_notice.h>   /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
+#include <zlib.h>
 
 
 /* Global Thread counter */
@@ -43,7 +44,8 @@ static char *add_load_option(char *ptr,const char *object,
 
 static my_bool	verbose=0,lock_tables=0,ignore_errors=0,opt_delete=0,
 		replace=0,silent=0,ignore=0,opt_compress=0,
-                opt_low_priority= 0, tty_password= 0, opt_secure_auth= 1;
+                opt_low_priority= 0, tty_password= 0, opt_secure_auth= 1,
+                opt_parallel_dump= 0;
 static my_bool debug_info_flag= 0, debug_check_flag= 0;
 static uint opt_use_threads=0, opt_local_file=0, my_end_arg= 0;
 static char	*opt_password=0, *current_user=0,
@@ -140,6 +142,12 @@ static struct my_option my_long_options[] =
   {"low-priority", OPT_LOW_PRIORITY,
    "Use LOW_PRIORITY when updating the table.", &opt_low_priority,
    &opt_low_priority, 0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"parallel-dump", OPT_PARALLEL_DUMP,
+   "Load the data files written by mysqldump --parallel. The table name is "
+   "the file name without the chunk number and extensions, and files "
+   "compressed with gzip are read through the client. Implies --local.",
+   &opt_parallel_dump, &opt_parallel_dump, 0, GET_BOOL, NO_ARG,
+   0, 0, 0, 0, 0, 0},
   {"password", 'p',
    "Password to use when connecting to server. If password is not given it's asked from the tty.",
    0, 0, 0, GET_PASSWORD, OPT_ARG, 0, 0, 0, 0, 0, 0},
@@ -292,6 +300,14 @@ static int get_options(int *argc, char ***argv)
     fprintf(stderr, "You can't use --ignore (-i) and --replace (-r) at the same time.\n");
     return(1);
   }
+  if (opt_parallel_dump && (opt_delete || lock_tables))
+  {
+    /* Both would be applied once per chunk of a table */
+    fprintf(stderr, "You can't use --parallel-dump with --delete (-d) or --lock-tables (-l).\n");
+    return(1);
+  }
+  if (opt_parallel_dump)
+    opt_local_file= 1;
   if (*argc < 2)
   {
     usage();
@@ -306,6 +322,93 @@ static int get_options(int *argc, char ***argv)
 
 
 
+/*
+  Get the name of the table a data file is loaded into.
+
+  With --parallel-dump the files are named <table>.<chunk>.txt, optionally
+  followed by .gz.
+*/
+
+static void get_table_name(char *tablename, const char *filename)
+{
+  char *ext;
+
+  if (!opt_parallel_dump)
+  {
+    fn_format(tablename, filename, "", "", 1 | 2); /* removes path & ext. */
+    return;
+  }
+  fn_format(tablename, filename, "", "", 1);    /* removes path */
+  if ((ext= strrchr(tablename, '.')) && !strcmp(ext, ".gz"))
+    *ext= '\0';
+  if ((ext= strrchr(tablename, '.')))
+    *ext= '\0';
+  if ((ext= strrchr(tablename, '.')) && ext[1] &&
+      strspn(ext + 1, "0123456789") == strlen(ext + 1))
+    *ext= '\0';
+}
+
+
+/*
+  LOAD DATA LOCAL INFILE handler of --parallel-dump. It reads files
+  compressed with gzip as well as plain files.
+*/
+
+typedef struct st_gz_infile
+{
+  gzFile file;
+  char error[FN_REFLEN + 64];
+} GZ_INFILE;
+
+
+static int gz_infile_init(void **ptr, const char *filename,
+                          void *userdata MY_ATTRIBUTE((unused)))
+{
+  GZ_INFILE *infile;
+  if (!(*ptr= infile= (GZ_INFILE*) my_malloc(sizeof(GZ_INFILE),
+                                             MYF(MY_ZEROFILL))))
+    return 1;
+  if (!(infile->file= gzopen(filename, "rb")))
+  {
+    my_snprintf(infile->error, sizeof(infile->error),
+                "Couldn't open file '%s'", filename);
+    return 1;
+  }
+  return 0;
+}
+
+
+static int gz_infile_read(void *ptr, char *buf, unsigned int buf_len)
+{
+  GZ_INFILE *infile= (GZ_INFILE*) ptr;
+  int count= gzread(infile->file, buf, buf_len);
+  if (count < 0)
+    strmov(infile->error, "Couldn't read compressed data");
+  return count;
+}
+
+
+static void gz_infile_end(void *ptr)
+{
+  GZ_INFILE *infile= (GZ_INFILE*) ptr;
+  if (infile)
+  {
+    if (infile->file)
+      gzclose(infile->file);
+    my_free(infile);
+  }
+}
+
+
+static int gz_infile_error(void *ptr, char *error_msg, unsigned int error_msg_len)
+{
+  GZ_INFILE *infile= (GZ_INFILE*) ptr;
+  strmake(error_msg, infile ? infile->error : "Out of memory",
+          error_msg_len - 1);
+  return CR_UNKNOWN_ERROR;
+}
+
+
 static int write_to_table(char *filename, MYSQL *mysql)
 {
   char tablename[FN_REFLEN], hard_path[FN_REFLEN],
@@ -314,7 +417,7 @@ static int write_to_table(char *filename, MYSQL *mysql)
   DBUG_ENTER("write_to_table");
   DBUG_PRINT("enter",("filename: %s",filename));
 
-  fn_format(tablename, filename, "", "", 1 | 2); /* removes path & ext. */
+  get_table_name(tablename, filename);
   if (!opt_local_file)
     strmov(hard_path,filename);
   else
@@ -409,7 +512,7 @@ static void lock_table(MYSQL *mysql, int tablecount, char **raw_tablename)
   init_dynamic_string(&query, "LOCK TABLES ", 256, 1024);
   for (i=0 ; i < tablecount ; i++)
   {
-    fn_format(tablename, raw_tablename[i], "", "", 1 | 2);
+    get_table_name(tablename, raw_tablename[i]);
     dynstr_append(&query, tablename);
     dynstr_append(&query, " WRITE,");
   }
@@ -488,6 +591,9 @@ static MYSQL *db_connect(char *host, char *database,
     db_error(mysql);
   }
   mysql->reconnect= 0;
+  if (opt_parallel_dump)
+    mysql_set_local_infile_handler(mysql, gz_infile_init, gz_infile_read,
+                                   gz_infile_end, gz_infile_error, NULL);
   if (verbose)
     fprintf(stdout, "Selecting database %s\n", database);
   if (mysql_select_db(mysql, database))
@@ -203,6 +203,7 @@ typedef struct st_heap_share
   uint auto_key_type;			/* real type of the auto key segment */
   ulonglong auto_increment;
   uint blobs;  /* Number of blobs in table */
+  my_bool internal_table;  /* Internal temporary table, see heap_create() */
 } HP_SHARE;
 
 struct st_hp_hash_info;
@@ -228,6 +229,7 @@ typedef struct st_heap_info
   uchar *blob_buffer;  /* Temporary buffer used to return BLOB values */
   uint blob_size;      /* Current blob_buffer size */
   uint blob_offset;    /* Current offset in blob_buffer */
+  ulong position_record; /* current_record at the last heap_position() */
 } HP_INFO;
 
 
@@ -271,6 +273,7 @@ extern int heap_update(HP_INFO *info,const uchar *old,const uchar *newdata);
 extern int heap_rrnd(HP_INFO *info,uchar *buf,uchar *pos);
 extern int heap_scan_init(HP_INFO *info);
 extern int heap_scan(register HP_INFO *info, uchar *record);
+extern int heap_scan_restart(HP_INFO *info, uchar *record, uchar *pos);
 extern int heap_delete(HP_INFO *info,const uchar *buff);
 extern int heap_info(HP_INFO *info,HEAPINFO *x,int flag);
 extern int heap_create(const char *name, HP_CREATE_INFO *create_info,
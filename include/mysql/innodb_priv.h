@@ -30,6 +30,7 @@ uint strconvert(CHARSET_INFO *from_cs, const char *from,
                 CHARSET_INFO *to_cs, char *to, uint to_length,
                 uint *errors);
 void sql_print_error(const char *format, ...);
+void thd_report_row_lock_wait(THD *self, THD *wait_for);
 
 
 
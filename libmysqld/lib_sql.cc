@@ -640,6 +640,8 @@ int init_embedded_server(int argc, char **argv, char **groups)
   if (!opt_bootstrap)
     servers_init(0);
 
+  (void) histograms_init(opt_bootstrap);
+
 #ifdef HAVE_DLOPEN
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   if (!opt_noacl)
@@ -64,56 +64,106 @@ static unsigned long long timespec_to_usec(const struct timespec *ts)
  *
  ******************************************************************************/
 
-ActiveTranx::ActiveTranx(mysql_mutex_t *lock,
-			 unsigned long trace_level)
-  : Trace(trace_level), allocator_(max_connections),
-    num_entries_(max_connections << 1), /* Transaction hash table size
-                                         * is set to double the size
-                                         * of max_connections */
-    lock_(lock)
+ActiveTranx::ActiveTranx(unsigned long trace_level)
+  : Trace(trace_level), ring_(NULL), head_(0), tail_(0)
 {
-  /* No transactions are in the list initially. */
-  trx_front_ = NULL;
-  trx_rear_  = NULL;
-
-  /* Create the hash table to find a transaction's ending event. */
-  trx_htb_ = new TranxNode *[num_entries_];
-  for (int idx = 0; idx < num_entries_; ++idx)
-    trx_htb_[idx] = NULL;
+  /* Each session can have only one open transaction, and a transaction
+   * is removed from the list as soon as a slave acknowledges it.  Because
+   * of EVENT, the total active transactions can exceed the maximum
+   * allowed connections, so the ring starts twice as large.  It grows
+   * if that is not enough.
+   */
+  ring_ = new Ring;
+  ring_->size = 1024;
+  while (ring_->size < (uint64) max_connections * 2)
+    ring_->size<<= 1;
+  ring_->keys = new int64[ring_->size];
+  ring_->prev = NULL;
+  my_atomic_rwlock_init(&lock_);
 
   sql_print_information("Semi-sync replication initialized for transactions.");
 }
 
 ActiveTranx::~ActiveTranx()
 {
-  delete [] trx_htb_;
-  trx_htb_          = NULL;
-  num_entries_      = 0;
+  my_atomic_rwlock_destroy(&lock_);
+  while (ring_)
+  {
+    Ring *prev = ring_->prev;
+    delete [] ring_->keys;
+    delete ring_;
+    ring_ = prev;
+  }
 }
 
-unsigned int ActiveTranx::calc_hash(const unsigned char *key,
-                                    unsigned int length)
+int64 ActiveTranx::load_head()
 {
-  unsigned int nr = 1, nr2 = 4;
+  int64 head;
+  my_atomic_rwlock_rdlock(&lock_);
+  head= my_atomic_load64(&head_);
+  my_atomic_rwlock_rdunlock(&lock_);
+  return head;
+}
 
-  /* The hash implementation comes from calc_hashnr() in mysys/hash.c. */
-  while (length--)
-  {
-    nr  ^= (((nr & 63)+nr2)*((unsigned int) (unsigned char) *key++))+ (nr << 8);
-    nr2 += 3;
-  }
-  return((unsigned int) nr);
+int64 ActiveTranx::load_tail()
+{
+  int64 tail;
+  my_atomic_rwlock_rdlock(&lock_);
+  tail= my_atomic_load64(&tail_);
+  my_atomic_rwlock_rdunlock(&lock_);
+  return tail;
+}
+
+ActiveTranx::Ring *ActiveTranx::load_ring()
+{
+  void *ring;
+  my_atomic_rwlock_rdlock(&lock_);
+  ring= my_atomic_loadptr((void * volatile *) &ring_);
+  my_atomic_rwlock_rdunlock(&lock_);
+  return (Ring *) ring;
+}
+
+ActiveTranx::Ring *ActiveTranx::grow(Ring *ring, int64 head, int64 tail)
+{
+  Ring *new_ring = new Ring;
+
+  new_ring->size = ring->size << 1;
+  new_ring->keys = new int64[new_ring->size];
+  new_ring->prev = ring;
+
+  /* The consumers may move the head meanwhile, but nobody else writes
+   * the slots, so the copy is consistent.
+   */
+  for (int64 i = head; i < tail; i++)
+    new_ring->keys[i & (new_ring->size - 1)] = key_at(ring, i);
+
+  my_atomic_rwlock_wrlock(&lock_);
+  my_atomic_storeptr((void * volatile *) &ring_, new_ring);
+  my_atomic_rwlock_wrunlock(&lock_);
+
+  sql_print_information("Semi-sync replication: %lu transactions are "
+                        "waiting for slave reply, growing the active "
+                        "transaction list to %lu slots",
+                        (unsigned long)(tail - head),
+                        (unsigned long)new_ring->size);
+  return new_ring;
 }
 
-unsigned int ActiveTranx::get_hash_value(const char *log_file_name,
-				 my_off_t    log_file_pos)
+int64 ActiveTranx::make_key(const char *log_file_name, my_off_t log_file_pos)
 {
-  unsigned int hash1 = calc_hash((const unsigned char *)log_file_name,
-                                 strlen(log_file_name));
-  unsigned int hash2 = calc_hash((const unsigned char *)(&log_file_pos),
-                                 sizeof(log_file_pos));
+  const char *ext= strrchr(log_file_name, '.');
+  char *end;
+  ulonglong seq;
 
-  return (hash1 + hash2) % num_entries_;
+  if (ext == NULL || !my_isdigit(&my_charset_latin1, ext[1]))
+    return 0;
+  seq= strtoull(ext + 1, &end, 10);
+  if (*end != '\0' || seq > INT_MAX32)
+    return 0;
+
+  /* Binlog events carry 32 bit positions. */
+  DBUG_ASSERT(log_file_pos <= UINT_MAX32);
+  return (int64) ((seq << 32) | (log_file_pos & UINT_MAX32));
 }
 
 int ActiveTranx::compare(const char *log_file_name1, my_off_t log_file_pos1,
@@ -131,226 +181,151 @@ int ActiveTranx::compare(const char *log_file_name1, my_off_t log_file_pos1,
   return 0;
 }
 
+int64 ActiveTranx::upper_bound(const Ring *ring, int64 from, int64 to,
+                               int64 key)
+{
+  while (from < to)
+  {
+    int64 mid= from + (to - from) / 2;
+    if (key_at(ring, mid) <= key)
+      from= mid + 1;
+    else
+      to= mid;
+  }
+  return from;
+}
+
 int ActiveTranx::insert_tranx_node(const char *log_file_name,
 				   my_off_t log_file_pos)
 {
   const char *kWho = "ActiveTranx:insert_tranx_node";
-  TranxNode  *ins_node;
+  int64       key = make_key(log_file_name, log_file_pos);
+  int64       head, tail;
+  Ring       *ring;
   int         result = 0;
-  unsigned int        hash_val;
 
   function_enter(kWho);
 
-  ins_node = allocator_.allocate_node();
-  if (!ins_node)
+  if (!key)
   {
-    sql_print_error("%s: transaction node allocation failed for: (%s, %lu)",
+    sql_print_error("%s: binlog file name has no sequence number: (%s, %lu)",
                     kWho, log_file_name, (unsigned long)log_file_pos);
     result = -1;
     goto l_end;
   }
 
-  /* insert the binlog position in the active transaction list. */
-  strncpy(ins_node->log_name_, log_file_name, FN_REFLEN-1);
-  ins_node->log_name_[FN_REFLEN-1] = 0; /* make sure it ends properly */
-  ins_node->log_pos_ = log_file_pos;
+  /* Only the thread holding mysql_bin_log.LOCK_log gets here, so the tail
+   * does not move and the ring is not replaced under us.
+   */
+  tail = load_tail();
+  head = load_head();
+  ring = load_ring();
 
-  if (!trx_front_)
-  {
-    /* The list is empty. */
-    trx_front_ = trx_rear_ = ins_node;
-  }
-  else
+  if (head != tail && key_at(ring, tail - 1) >= key)
   {
-    int cmp = compare(ins_node, trx_rear_);
-    if (cmp > 0)
-    {
-      /* Compare with the tail first.  If the transaction happens later in
-       * binlog, then make it the new tail.
-       */
-      trx_rear_->next_ = ins_node;
-      trx_rear_        = ins_node;
-    }
-    else
-    {
-      /* Otherwise, it is an error because the transaction should hold the
-       * mysql_bin_log.LOCK_log when appending events.
-       */
-      sql_print_error("%s: binlog write out-of-order, tail (%s, %lu), "
-                      "new node (%s, %lu)", kWho,
-                      trx_rear_->log_name_, (unsigned long)trx_rear_->log_pos_,
-                      ins_node->log_name_, (unsigned long)ins_node->log_pos_);
-      result = -1;
-      goto l_end;
-    }
+    /* It is an error because the transaction should hold the
+     * mysql_bin_log.LOCK_log when appending events.
+     */
+    sql_print_error("%s: binlog write out-of-order, tail (%lu, %lu), "
+                    "new node (%s, %lu)", kWho,
+                    (unsigned long)(key_at(ring, tail - 1) >> 32),
+                    (unsigned long)(key_at(ring, tail - 1) & UINT_MAX32),
+                    log_file_name, (unsigned long)log_file_pos);
+    result = -1;
+    goto l_end;
   }
 
-  hash_val = get_hash_value(ins_node->log_name_, ins_node->log_pos_);
-  ins_node->hash_next_ = trx_htb_[hash_val];
-  trx_htb_[hash_val]   = ins_node;
+  /* The head only moves forward, so a stale head just makes us grow a
+   * bit early.
+   */
+  if ((uint64)(tail - head) >= ring->size ||
+      DBUG_EVALUATE_IF("semi_sync_grow_active_tranx", head != tail, false))
+    ring = grow(ring, head, tail);
+
+  /* The slot is written before the new tail is published. */
+  ring->keys[tail & (ring->size - 1)] = key;
+  my_atomic_rwlock_wrlock(&lock_);
+  my_atomic_store64(&tail_, tail + 1);
+  my_atomic_rwlock_wrunlock(&lock_);
 
   if (trace_level_ & kTraceDetail)
-    sql_print_information("%s: insert (%s, %lu) in entry(%u)", kWho,
-                          ins_node->log_name_, (unsigned long)ins_node->log_pos_,
-                          hash_val);
+    sql_print_information("%s: insert (%s, %lu) in slot(%lu)", kWho,
+                          log_file_name, (unsigned long)log_file_pos,
+                          (unsigned long)(tail & (ring->size - 1)));
 
  l_end:
   return function_exit(kWho, result);
 }
 
-bool ActiveTranx::is_tranx_end_pos(const char *log_file_name,
-				   my_off_t    log_file_pos)
+bool ActiveTranx::is_tranx_end_pos(int64 key)
 {
   const char *kWho = "ActiveTranx::is_tranx_end_pos";
-  function_enter(kWho);
+  int64 head, tail, pos;
+  Ring *ring;
+  bool  found;
 
-  unsigned int hash_val = get_hash_value(log_file_name, log_file_pos);
-  TranxNode *entry = trx_htb_[hash_val];
+  function_enter(kWho);
 
-  while (entry != NULL)
+  /* A slot is recycled only after the head has moved past it: retry the
+   * lookup if the head moved while we were reading.
+   */
+  do
   {
-    if (compare(entry, log_file_name, log_file_pos) == 0)
-      break;
-
-    entry = entry->hash_next_;
-  }
+    head = load_head();
+    tail = load_tail();
+    ring = load_ring();
+    pos = upper_bound(ring, head, tail, key);
+    found = (pos > head && key_at(ring, pos - 1) == key);
+  } while (load_head() != head);
 
   if (trace_level_ & kTraceDetail)
-    sql_print_information("%s: probe (%s, %lu) in entry(%u)", kWho,
-                          log_file_name, (unsigned long)log_file_pos, hash_val);
+    sql_print_information("%s: probe (%lu, %lu) in slot(%lu)", kWho,
+                          (unsigned long)(key >> 32),
+                          (unsigned long)(key & UINT_MAX32),
+                          (unsigned long)(pos & (ring->size - 1)));
 
-  function_exit(kWho, (entry != NULL));
-  return (entry != NULL);
+  function_exit(kWho, found);
+  return found;
 }
 
-int ActiveTranx::signal_waiting_sessions_all()
+bool ActiveTranx::is_active(int64 key)
 {
-  const char *kWho = "ActiveTranx::signal_waiting_sessions_all";
-  function_enter(kWho);
-  for (TranxNode* entry= trx_front_; entry; entry=entry->next_)
-    mysql_cond_broadcast(&entry->cond);
+  int64 tail = load_tail();
+  int64 last = (tail > 0) ? key_at(load_ring(), tail - 1) : 0;
 
-  return function_exit(kWho, 0);
-}
-
-int ActiveTranx::signal_waiting_sessions_up_to(const char *log_file_name,
-                                               my_off_t log_file_pos)
-{
-  const char *kWho = "ActiveTranx::signal_waiting_sessions_up_to";
-  function_enter(kWho);
-
-  TranxNode* entry= trx_front_;
-  int cmp= ActiveTranx::compare(entry->log_name_, entry->log_pos_, log_file_name, log_file_pos) ;
-  while (entry && cmp <= 0)
-  {
-    mysql_cond_broadcast(&entry->cond);
-    entry= entry->next_;
-    if (entry)
-      cmp= ActiveTranx::compare(entry->log_name_, entry->log_pos_, log_file_name, log_file_pos) ;
-  }
-
-  return function_exit(kWho, (entry != NULL));
+  /* The last slot is valid as long as the head has not passed it. */
+  return (load_head() < tail && last >= key);
 }
 
-TranxNode * ActiveTranx::find_active_tranx_node(const char *log_file_name,
-                                                my_off_t log_file_pos)
-{
-  const char *kWho = "ActiveTranx::find_active_tranx_node";
-  function_enter(kWho);
-
-  TranxNode* entry= trx_front_;
-
-  while (entry)
-  {
-    if (ActiveTranx::compare(log_file_name, log_file_pos, entry->log_name_,
-                             entry->log_pos_) <= 0)
-      break;
-    entry= entry->next_;
-  }
-  function_exit(kWho, 0);
-  return entry;
-}
-
-int ActiveTranx::clear_active_tranx_nodes(const char *log_file_name,
-					  my_off_t log_file_pos)
+int ActiveTranx::clear_active_tranx_nodes(int64 key)
 {
   const char *kWho = "ActiveTranx::::clear_active_tranx_nodes";
-  TranxNode *new_front;
+  int64 head, tail, new_head;
 
   function_enter(kWho);
 
-  if (log_file_name != NULL)
-  {
-    new_front = trx_front_;
-
-    while (new_front)
-    {
-      if (compare(new_front, log_file_name, log_file_pos) > 0 ||
-          new_front->n_waiters > 0)
-        break;
-      new_front = new_front->next_;
-    }
-  }
-  else
+  do
   {
-    /* If log_file_name is NULL, clear everything. */
-    new_front = NULL;
-  }
-
-  if (new_front == NULL)
-  {
-    /* No active transaction nodes after the call. */
-
-    /* Clear the hash table. */
-    memset(trx_htb_, 0, num_entries_ * sizeof(TranxNode *));
-    allocator_.free_all_nodes();
-
-    /* Clear the active transaction list. */
-    if (trx_front_ != NULL)
-    {
-      trx_front_ = NULL;
-      trx_rear_  = NULL;
-    }
-
-    if (trace_level_ & kTraceDetail)
-      sql_print_information("%s: cleared all nodes", kWho);
-  }
-  else if (new_front != trx_front_)
-  {
-    TranxNode *curr_node, *next_node;
-
-    /* Delete all transaction nodes before the confirmation point. */
-    int n_frees = 0;
-    curr_node = trx_front_;
-    while (curr_node != new_front)
-    {
-      next_node = curr_node->next_;
-      n_frees++;
-
-      /* Remove the node from the hash table. */
-      unsigned int hash_val = get_hash_value(curr_node->log_name_, curr_node->log_pos_);
-      TranxNode **hash_ptr = &(trx_htb_[hash_val]);
-      while ((*hash_ptr) != NULL)
-      {
-        if ((*hash_ptr) == curr_node)
-	{
-          (*hash_ptr) = curr_node->hash_next_;
-          break;
-        }
-        hash_ptr = &((*hash_ptr)->hash_next_);
-      }
-
-      curr_node = next_node;
-    }
-
-    trx_front_ = new_front;
-    allocator_.free_nodes_before(trx_front_);
+    head = load_head();
+    tail = load_tail();
+    new_head = key ? upper_bound(load_ring(), head, tail, key) : tail;
+    if (new_head <= head)
+      break;
+    /* A failed swap means another thread cleared in the meantime and the
+     * slots we read may have been recycled: start over.
+     */
+    my_atomic_rwlock_wrlock(&lock_);
+    bool swapped = my_atomic_cas64(&head_, &head, new_head);
+    my_atomic_rwlock_wrunlock(&lock_);
+    if (swapped)
+      break;
+  } while (true);
 
-    if (trace_level_ & kTraceDetail)
-      sql_print_information("%s: cleared %d nodes back until pos (%s, %lu)",
-                            kWho, n_frees,
-                            trx_front_->log_name_, (unsigned long)trx_front_->log_pos_);
-  }
+  if ((trace_level_ & kTraceDetail) && new_head > head)
+    sql_print_information("%s: cleared %lu nodes back until pos (%lu, %lu)",
+                          kWho, (unsigned long)(new_head - head),
+                          (unsigned long)(key >> 32),
+                          (unsigned long)(key & UINT_MAX32));
 
   return function_exit(kWho, 0);
 }
@@ -382,16 +357,13 @@ int ActiveTranx::clear_active_tranx_nodes(const char *log_file_name,
 ReplSemiSyncMaster::ReplSemiSyncMaster()
   : active_tranxs_(NULL),
     init_done_(false),
-    reply_file_name_inited_(false),
-    reply_file_pos_(0L),
-    wait_file_name_inited_(false),
-    wait_file_pos_(0),
+    reply_key_(0),
+    wait_key_(0),
+    commit_key_(0),
     master_enabled_(false),
     wait_timeout_(0L),
     state_(0)
 {
-  strcpy(reply_file_name_, "");
-  strcpy(wait_file_name_, "");
 }
 
 int ReplSemiSyncMaster::initObject()
@@ -413,6 +385,9 @@ int ReplSemiSyncMaster::initObject()
   /* Mutex initialization can only be done after MY_INIT(). */
   mysql_mutex_init(key_ss_mutex_LOCK_binlog_,
                    &LOCK_binlog_, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_ss_cond_COND_binlog_send_,
+                  &COND_binlog_send_, NULL);
+  my_atomic_rwlock_init(&key_lock_);
 
   if (rpl_semi_sync_master_enabled)
     result = enableMaster();
@@ -432,13 +407,14 @@ int ReplSemiSyncMaster::enableMaster()
   if (!getMasterEnabled())
   {
     if (active_tranxs_ == NULL)
-      active_tranxs_ = new ActiveTranx(&LOCK_binlog_, trace_level_);
+      active_tranxs_ = new ActiveTranx(trace_level_);
 
     if (active_tranxs_ != NULL)
     {
-      commit_file_name_inited_ = false;
-      reply_file_name_inited_  = false;
-      wait_file_name_inited_   = false;
+      store_key(&commit_key_, 0);
+      store_key(&reply_key_, 0);
+      store_key(&wait_key_, 0);
+      active_tranxs_->clear_active_tranx_nodes(0);
 
       set_master_enabled(true);
       state_ = true;
@@ -468,15 +444,12 @@ int ReplSemiSyncMaster::disableMaster()
      */
     switch_off();
 
-    if ( active_tranxs_ && active_tranxs_->is_empty())
-    {
-      delete active_tranxs_;
-      active_tranxs_ = NULL;
-    }
-
-    reply_file_name_inited_ = false;
-    wait_file_name_inited_  = false;
-    commit_file_name_inited_ = false;
+    /* The active transaction list is kept until the plugin is unloaded:
+     * the binlog and dump threads read it without holding the lock.
+     */
+    store_key(&reply_key_, 0);
+    store_key(&wait_key_, 0);
+    store_key(&commit_key_, 0);
 
     set_master_enabled(false);
     sql_print_information("Semi-sync replication disabled on the master.");
@@ -491,6 +464,8 @@ ReplSemiSyncMaster::~ReplSemiSyncMaster()
 {
   if (init_done_)
   {
+    my_atomic_rwlock_destroy(&key_lock_);
+    mysql_cond_destroy(&COND_binlog_send_);
     mysql_mutex_destroy(&LOCK_binlog_);
   }
 
@@ -507,6 +482,32 @@ void ReplSemiSyncMaster::unlock()
   mysql_mutex_unlock(&LOCK_binlog_);
 }
 
+int64 ReplSemiSyncMaster::load_key(volatile int64 *key)
+{
+  int64 value;
+  my_atomic_rwlock_rdlock(&key_lock_);
+  value= my_atomic_load64(key);
+  my_atomic_rwlock_rdunlock(&key_lock_);
+  return value;
+}
+
+void ReplSemiSyncMaster::store_key(volatile int64 *key, int64 value)
+{
+  my_atomic_rwlock_wrlock(&key_lock_);
+  my_atomic_store64(key, value);
+  my_atomic_rwlock_wrunlock(&key_lock_);
+}
+
+void ReplSemiSyncMaster::advance_key(volatile int64 *key, int64 value)
+{
+  int64 old;
+  my_atomic_rwlock_wrlock(&key_lock_);
+  old= my_atomic_load64(key);
+  while (old < value && !my_atomic_cas64(key, &old, value))
+  {}
+  my_atomic_rwlock_wrunlock(&key_lock_);
+}
+
 void ReplSemiSyncMaster::add_slave()
 {
   lock();
@@ -531,14 +532,11 @@ void ReplSemiSyncMaster::remove_slave()
     {
       if (abort_loop)
       {
-        if (commit_file_name_inited_ && reply_file_name_inited_)
-        {
-          int cmp = ActiveTranx::compare(reply_file_name_, reply_file_pos_ ,
-                                         commit_file_name_, commit_file_pos_);
-          if (cmp < 0)
-            sql_print_warning("SEMISYNC: Forced shutdown. Some updates might "
-                              "not be replicated.");
-        }
+        int64 commit_key = load_key(&commit_key_);
+        int64 reply_key = load_key(&reply_key_);
+        if (commit_key && reply_key && reply_key < commit_key)
+          sql_print_warning("SEMISYNC: Forced shutdown. Some updates might "
+                            "not be replicated.");
       }
       switch_off();
     }
@@ -560,96 +558,80 @@ int ReplSemiSyncMaster::reportReplyBinlog(uint32 server_id,
                                           bool skipped_event)
 {
   const char *kWho = "ReplSemiSyncMaster::reportReplyBinlog";
-  int   cmp;
-  bool  can_release_threads = false;
-  bool  need_copy_send_pos = true;
+  int64 key;
 
   if (!(getMasterEnabled()))
     return 0;
 
   function_enter(kWho);
 
-  lock();
-
-  /* This is the real check inside the mutex. */
-  if (!getMasterEnabled())
-    goto l_end;
-
   if (!is_on())
-    /* We check to see whether we can switch semi-sync ON. */
-    try_switch_on(server_id, log_file_name, log_file_pos);
+  {
+    lock();
+    /* This is the real check inside the mutex. */
+    if (getMasterEnabled() && !is_on())
+      /* We check to see whether we can switch semi-sync ON. */
+      try_switch_on(server_id, log_file_name, log_file_pos);
+    unlock();
+  }
 
   /* The position should increase monotonically, if there is only one
    * thread sending the binlog to the slave.
    * In reality, to improve the transaction availability, we allow multiple
    * sync replication slaves.  So, if any one of them get the transaction,
    * the transaction session in the primary can move forward.
+   * If the requested position is behind the reply position we already
+   * have, it is ignored: at least one of the slaves should be up to date.
    */
-  if (reply_file_name_inited_)
-  {
-    cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                               reply_file_name_, reply_file_pos_);
-
-    /* If the requested position is behind the sending binlog position,
-     * would not adjust sending binlog position.
-     * We based on the assumption that there are multiple semi-sync slave,
-     * and at least one of them shou/ld be up to date.
-     * If all semi-sync slaves are behind, at least initially, the primary
-     * can find the situation after the waiting timeout.  After that, some
-     * slaves should catch up quickly.
-     */
-    if (cmp < 0)
-    {
-      /* If the position is behind, do not copy it. */
-      need_copy_send_pos = false;
-    }
-  }
+  key = ActiveTranx::make_key(log_file_name, log_file_pos);
+  advance_key(&reply_key_, key);
 
-  if (need_copy_send_pos)
+  if (trace_level_ & kTraceDetail)
   {
-    strncpy(reply_file_name_, log_file_name, sizeof(reply_file_name_) - 1);
-    reply_file_name_[sizeof(reply_file_name_) - 1]= '\0';
-    reply_file_pos_ = log_file_pos;
-    reply_file_name_inited_ = true;
-
-    if (trace_level_ & kTraceDetail)
-    {
-      if(!skipped_event)
-        sql_print_information("%s: Got reply at (%s, %lu)", kWho,
+    if(!skipped_event)
+      sql_print_information("%s: Got reply at (%s, %lu)", kWho,
                             log_file_name, (unsigned long)log_file_pos);
-      else
-        sql_print_information("%s: Transaction skipped at (%s, %lu)", kWho,
+    else
+      sql_print_information("%s: Transaction skipped at (%s, %lu)", kWho,
                             log_file_name, (unsigned long)log_file_pos);
-    }
   }
 
-  if (rpl_semi_sync_master_wait_sessions > 0)
-  {
-    /* Let us check if some of the waiting threads doing a trx
-     * commit can now proceed.
-     */
-    cmp = ActiveTranx::compare(reply_file_name_, reply_file_pos_,
-                               wait_file_name_, wait_file_pos_);
-    if (cmp >= 0)
-    {
-      /* Yes, at least one waiting thread can now proceed:
-       * let us release all waiting threads with a broadcast
-       */
-      can_release_threads = true;
-      wait_file_name_inited_ = false;
-    }
-  }
+  /* The acknowledged transactions need no more replies. */
+  active_tranxs_->clear_active_tranx_nodes(load_key(&reply_key_));
 
- l_end:
+  /* Let us check if some of the waiting threads doing a trx
+   * commit can now proceed.
+   */
+  signal_waiting_sessions();
+
+  return function_exit(kWho, 0);
+}
+
+void ReplSemiSyncMaster::signal_waiting_sessions()
+{
+  const char *kWho = "ReplSemiSyncMaster::signal_waiting_sessions";
+
+  /* A waiting session publishes its position before it checks the reply
+   * position, and we store the reply position before we look at the
+   * wait position here, so one of the two sides always sees the other.
+   */
+  int64 wait_key = load_key(&wait_key_);
+  if (wait_key == 0 || load_key(&reply_key_) < wait_key)
+    return;
 
-  if (can_release_threads)
+  lock();
+  wait_key = load_key(&wait_key_);
+  if (wait_key != 0 && load_key(&reply_key_) >= wait_key)
   {
+    /* Yes, at least one waiting thread can now proceed:
+     * let us release all waiting threads with a broadcast
+     */
+    store_key(&wait_key_, 0);
     if (trace_level_ & kTraceDetail)
       sql_print_information("%s: signal all waiting threads.", kWho);
-    active_tranxs_->signal_waiting_sessions_up_to(reply_file_name_, reply_file_pos_);
+    mysql_cond_broadcast(&COND_binlog_send_);
   }
   unlock();
-  return function_exit(kWho, 0);
 }
 
 int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
@@ -665,26 +647,20 @@ int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
   if (current_thd->debug_sync_control)
     DEBUG_SYNC(current_thd, "rpl_semisync_master_commit_trx_before_lock");
 #endif
+  int64 trx_wait_key= trx_wait_binlog_name ?
+    ActiveTranx::make_key(trx_wait_binlog_name, trx_wait_binlog_pos) : 0;
+
   /* Acquire the mutex. */
   lock();
 
-  TranxNode* entry= NULL;
-  mysql_cond_t* thd_cond= NULL;
   bool is_semi_sync_trans= true;
-  if (active_tranxs_ != NULL && trx_wait_binlog_name)
-  {
-    entry=
-      active_tranxs_->find_active_tranx_node(trx_wait_binlog_name,
-                                             trx_wait_binlog_pos);
-    if (entry)
-      thd_cond= &entry->cond;
-  }
+
   /* This must be called after acquired the lock */
-  THD_ENTER_COND(NULL, thd_cond, &LOCK_binlog_,
+  THD_ENTER_COND(NULL, &COND_binlog_send_, &LOCK_binlog_,
                  & stage_waiting_for_semi_sync_ack_from_slave,
                  & old_stage);
 
-  if (getMasterEnabled() && trx_wait_binlog_name)
+  if (getMasterEnabled() && trx_wait_key)
   {
     struct timespec start_ts;
     struct timespec abstime;
@@ -719,37 +695,38 @@ int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
 
     while (is_on())
     {
-      if (reply_file_name_inited_)
+      int64 reply_key = load_key(&reply_key_);
+      if (reply_key >= trx_wait_key)
       {
-        int cmp = ActiveTranx::compare(reply_file_name_, reply_file_pos_,
-                                       trx_wait_binlog_name, trx_wait_binlog_pos);
-        if (cmp >= 0)
-        {
-          /* We have already sent the relevant binlog to the slave: no need to
-           * wait here.
-           */
-          if (trace_level_ & kTraceDetail)
-            sql_print_information("%s: Binlog reply is ahead (%s, %lu),",
-                                  kWho, reply_file_name_, (unsigned long)reply_file_pos_);
-          break;
-        }
+        /* We have already sent the relevant binlog to the slave: no need to
+         * wait here.
+         */
+        if (trace_level_ & kTraceDetail)
+          sql_print_information("%s: Binlog reply is ahead (%lu, %lu),",
+                                kWho, (unsigned long)(reply_key >> 32),
+                                (unsigned long)(reply_key & UINT_MAX32));
+        break;
       }
       /*
-        When code reaches here an Entry object may not be present in the
-        following scenario.
+        When code reaches here the transaction may not be in the active
+        transaction list in the following scenario.
 
         Semi sync was not enabled when transaction entered into ordered_commit
-        process. During flush stage, semi sync was not enabled and there was no
-        'Entry' object created for the transaction being committed and at a
-        later stage it was enabled. In this case trx_wait_binlog_name and
-        trx_wait_binlog_pos are set but the 'Entry' object is not present. Hence
-        dump thread will not wait for reply from slave and it will not update
-        reply_file_name. In such case the committing transaction should not wait
-        for an ack from slave and it should be considered as an async
-        transaction.
+        process. During flush stage, semi sync was not enabled and the
+        transaction was not added to the list and at a later stage it was
+        enabled. In this case trx_wait_binlog_name and trx_wait_binlog_pos
+        are set but dump thread will not wait for reply from slave and it
+        will not update the reply position. In such case the committing
+        transaction should not wait for an ack from slave and it should be
+        considered as an async transaction.
+
+        The transaction also leaves the list once a slave acknowledged it,
+        which is why the reply position is checked once more.
       */
-      if (!entry)
+      if (!active_tranxs_->is_active(trx_wait_key))
       {
+        if (load_key(&reply_key_) >= trx_wait_key)
+          continue;
         is_semi_sync_trans= false;
         goto l_end;
       }
@@ -757,33 +734,30 @@ int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
       /* Let us update the info about the minimum binlog position of waiting
        * threads.
        */
-      if (wait_file_name_inited_)
+      int64 wait_key = load_key(&wait_key_);
+      if (wait_key == 0 || trx_wait_key <= wait_key)
       {
-        int cmp = ActiveTranx::compare(trx_wait_binlog_name, trx_wait_binlog_pos,
-                                       wait_file_name_, wait_file_pos_);
-        if (cmp <= 0)
-	{
-          /* This thd has a lower position, let's update the minimum info. */
-          strncpy(wait_file_name_, trx_wait_binlog_name, sizeof(wait_file_name_) - 1);
-          wait_file_name_[sizeof(wait_file_name_) - 1]= '\0';
-          wait_file_pos_ = trx_wait_binlog_pos;
+        /* This thd has a lower position, let's update the minimum info. */
+        store_key(&wait_key_, trx_wait_key);
 
+        if (wait_key != 0)
+        {
           rpl_semi_sync_master_wait_pos_backtraverse++;
           if (trace_level_ & kTraceDetail)
             sql_print_information("%s: move back wait position (%s, %lu),",
-                                  kWho, wait_file_name_, (unsigned long)wait_file_pos_);
+                                  kWho, trx_wait_binlog_name,
+                                  (unsigned long)trx_wait_binlog_pos);
         }
-      }
-      else
-      {
-        strncpy(wait_file_name_, trx_wait_binlog_name, sizeof(wait_file_name_) - 1);
-        wait_file_name_[sizeof(wait_file_name_) - 1]= '\0';
-        wait_file_pos_ = trx_wait_binlog_pos;
-        wait_file_name_inited_ = true;
-
-        if (trace_level_ & kTraceDetail)
+        else if (trace_level_ & kTraceDetail)
           sql_print_information("%s: init wait position (%s, %lu),",
-                                kWho, wait_file_name_, (unsigned long)wait_file_pos_);
+                                kWho, trx_wait_binlog_name,
+                                (unsigned long)trx_wait_binlog_pos);
+
+        /* The reply may have arrived before the wait position was
+         * published, in which case nobody is going to signal us.
+         */
+        if (load_key(&reply_key_) >= trx_wait_key)
+          continue;
       }
 
       /* In semi-synchronous replication, we wait until the binlog-dump
@@ -806,13 +780,12 @@ int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
       if (trace_level_ & kTraceDetail)
         sql_print_information("%s: wait %lu ms for binlog sent (%s, %lu)",
                               kWho, wait_timeout_,
-                              wait_file_name_, (unsigned long)wait_file_pos_);
+                              trx_wait_binlog_name,
+                              (unsigned long)trx_wait_binlog_pos);
       
       /* wait for the position to be ACK'ed back */
-      assert(entry);
-      entry->n_waiters++;
-      wait_result= mysql_cond_timedwait(&entry->cond, &LOCK_binlog_, &abstime);
-      entry->n_waiters--;
+      wait_result= mysql_cond_timedwait(&COND_binlog_send_, &LOCK_binlog_,
+                                        &abstime);
       /*
         After we release LOCK_binlog_ above while waiting for the condition,
         it can happen that some other parallel client session executed
@@ -826,10 +799,12 @@ int ReplSemiSyncMaster::commitTrx(const char* trx_wait_binlog_name,
       if (wait_result != 0)
       {
         /* This is a real wait timeout. */
+        reply_key = load_key(&reply_key_);
         sql_print_warning("Timeout waiting for reply of binlog (file: %s, pos: %lu), "
-                          "semi-sync up to file %s, position %lu.",
+                          "semi-sync up to file number %lu, position %lu.",
                           trx_wait_binlog_name, (unsigned long)trx_wait_binlog_pos,
-                          reply_file_name_, (unsigned long)reply_file_pos_);
+                          (unsigned long)(reply_key >> 32),
+                          (unsigned long)(reply_key & UINT_MAX32));
         rpl_semi_sync_master_wait_timeouts++;
         
         /* switch semi-sync off */
@@ -868,12 +843,6 @@ l_end:
 
   }
 
-  /* Last waiter removes the TranxNode */
-  if (trx_wait_binlog_name && active_tranxs_
-      && entry && entry->n_waiters == 0)
-    active_tranxs_->clear_active_tranx_nodes(trx_wait_binlog_name,
-                                             trx_wait_binlog_pos);
-
   /* The lock held will be released by thd_exit_cond, so no need to
     call unlock() here */
   THD_EXIT_COND(NULL, & old_stage);
@@ -906,12 +875,13 @@ int ReplSemiSyncMaster::switch_off()
   state_ = false;
 
   rpl_semi_sync_master_off_times++;
-  wait_file_name_inited_   = false;
-  reply_file_name_inited_  = false;
+  store_key(&wait_key_, 0);
+  store_key(&reply_key_, 0);
+  active_tranxs_->clear_active_tranx_nodes(0);
   sql_print_information("Semi-sync replication switched OFF.");
 
   /* signal waiting sessions */
-  active_tranxs_->signal_waiting_sessions_all();
+  mysql_cond_broadcast(&COND_binlog_send_);
 
   return function_exit(kWho, 0);
 }
@@ -922,25 +892,21 @@ int ReplSemiSyncMaster::try_switch_on(int server_id,
 {
   const char *kWho = "ReplSemiSyncMaster::try_switch_on";
   bool semi_sync_on = false;
+  int64 commit_key = load_key(&commit_key_);
 
   function_enter(kWho);
 
   /* If the current sending event's position is larger than or equal to the
    * 'largest' commit transaction binlog position, the slave is already
    * catching up now and we can switch semi-sync on here.
-   * If commit_file_name_inited_ indicates there are no recent transactions,
-   * we can enable semi-sync immediately.
+   * If commit_key_ indicates there are no recent transactions, we can
+   * enable semi-sync immediately.
    */
-  if (commit_file_name_inited_)
-  {
-    int cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                                   commit_file_name_, commit_file_pos_);
-    semi_sync_on = (cmp >= 0);
-  }
+  if (commit_key)
+    semi_sync_on =
+      (ActiveTranx::make_key(log_file_name, log_file_pos) >= commit_key);
   else
-  {
     semi_sync_on = true;
-  }
 
   if (semi_sync_on)
   {
@@ -994,8 +960,8 @@ int ReplSemiSyncMaster::updateSyncHeader(unsigned char *packet,
 					 uint32 server_id)
 {
   const char *kWho = "ReplSemiSyncMaster::updateSyncHeader";
-  int  cmp = 0;
   bool sync = false;
+  int64 key, reply_key, wait_key, commit_key;
 
   /* If the semi-sync master is not enabled, or the slave is not a semi-sync
    * target, do not request replies from the slave.
@@ -1005,65 +971,39 @@ int ReplSemiSyncMaster::updateSyncHeader(unsigned char *packet,
 
   function_enter(kWho);
 
-  lock();
-
-  /* This is the real check inside the mutex. */
-  if (!getMasterEnabled())
-    goto l_end; // sync= false at this point in time
+  key = ActiveTranx::make_key(log_file_name, log_file_pos);
 
   if (is_on())
   {
     /* semi-sync is ON */
     /* sync= false; No sync unless a transaction is involved. */
 
-    if (reply_file_name_inited_)
+    reply_key = load_key(&reply_key_);
+    if (reply_key && key <= reply_key)
     {
-      cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                                 reply_file_name_, reply_file_pos_);
-      if (cmp <= 0)
-      {
-        /* If we have already got the reply for the event, then we do
-         * not need to sync the transaction again.
-         */
-        goto l_end;
-      }
+      /* If we have already got the reply for the event, then we do
+       * not need to sync the transaction again.
+       */
+      goto l_end;
     }
 
-    if (wait_file_name_inited_)
-    {
-      cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                                 wait_file_name_, wait_file_pos_);
-    }
-    else
-    {
-      cmp = 1;
-    }
-    
     /* If we are already waiting for some transaction replies which
      * are later in binlog, do not wait for this one event.
      */
-    if (cmp >= 0)
+    wait_key = load_key(&wait_key_);
+    if (wait_key == 0 || key >= wait_key)
     {
       /* 
        * We only wait if the event is a transaction's ending event.
        */
       assert(active_tranxs_ != NULL);
-      sync = active_tranxs_->is_tranx_end_pos(log_file_name,
-                                               log_file_pos);
+      sync = active_tranxs_->is_tranx_end_pos(key);
     }
   }
   else
   {
-    if (commit_file_name_inited_)
-    {
-      int cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                                     commit_file_name_, commit_file_pos_);
-      sync = (cmp >= 0);
-    }
-    else
-    {
-      sync = true;
-    }
+    commit_key = load_key(&commit_key_);
+    sync = (commit_key == 0 || key >= commit_key);
   }
 
   if (trace_level_ & kTraceDetail)
@@ -1072,8 +1012,6 @@ int ReplSemiSyncMaster::updateSyncHeader(unsigned char *packet,
                           (unsigned long)log_file_pos, sync, (int)is_on());
 
  l_end:
-  unlock();
-
   /* We do not need to clear sync flag because we set it to 0 when we
    * reserve the packet header.
    */
@@ -1093,38 +1031,20 @@ int ReplSemiSyncMaster::writeTranxInBinlog(const char* log_file_name,
 
   function_enter(kWho);
 
-  lock();
-
-  /* This is the real check inside the mutex. */
+  /* The caller holds mysql_bin_log.LOCK_log, so this is the only thread
+   * adding positions: no need for LOCK_binlog_ here.
+   */
   if (!getMasterEnabled())
     goto l_end;
 
   /* Update the 'largest' transaction commit position seen so far even
    * though semi-sync is switched off.
-   * It is much better that we update commit_file_* here, instead of
+   * It is much better that we update commit_key_ here, instead of
    * inside commitTrx().  This is mostly because updateSyncHeader()
-   * will watch for commit_file_* to decide whether to switch semi-sync
+   * will watch for commit_key_ to decide whether to switch semi-sync
    * on. The detailed reason is explained in function updateSyncHeader().
    */
-  if (commit_file_name_inited_)
-  {
-    int cmp = ActiveTranx::compare(log_file_name, log_file_pos,
-                                   commit_file_name_, commit_file_pos_);
-    if (cmp > 0)
-    {
-      /* This is a larger position, let's update the maximum info. */
-      strncpy(commit_file_name_, log_file_name, FN_REFLEN-1);
-      commit_file_name_[FN_REFLEN-1] = 0; /* make sure it ends properly */
-      commit_file_pos_ = log_file_pos;
-    }
-  }
-  else
-  {
-    strncpy(commit_file_name_, log_file_name, FN_REFLEN-1);
-    commit_file_name_[FN_REFLEN-1] = 0; /* make sure it ends properly */
-    commit_file_pos_ = log_file_pos;
-    commit_file_name_inited_ = true;
-  }
+  advance_key(&commit_key_, ActiveTranx::make_key(log_file_name, log_file_pos));
 
   if (is_on())
   {
@@ -1132,18 +1052,19 @@ int ReplSemiSyncMaster::writeTranxInBinlog(const char* log_file_name,
     if(active_tranxs_->insert_tranx_node(log_file_name, log_file_pos))
     {
       /*
-        if insert tranx_node failed, print a warning message
-        and turn off semi-sync
+        Only an out of order position or a file name without a sequence
+        number gets here: print a warning message and turn off semi-sync
       */
       sql_print_warning("Semi-sync failed to insert tranx_node for binlog file: %s, position: %lu",
                         log_file_name, (ulong)log_file_pos);
-      switch_off();
+      lock();
+      if (is_on())
+        switch_off();
+      unlock();
     }
   }
 
  l_end:
-  unlock();
-
   return function_exit(kWho, result);
 }
 
@@ -1174,10 +1095,6 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
                                        const char *event_buf)
 {
   const char *kWho = "ReplSemiSyncMaster::readSlaveReply";
-  const unsigned char *packet;
-  char     log_file_name[FN_REFLEN];
-  my_off_t log_file_pos;
-  ulong    log_file_len = 0;
   ulong    packet_len;
   int      result = -1;
 
@@ -1234,18 +1151,71 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
     }
   }
 
-  if (packet_len == packet_error || packet_len < REPLY_BINLOG_NAME_OFFSET)
+  if (packet_len == packet_error)
   {
-    if (packet_len == packet_error)
-      sql_print_error("Read semi-sync reply network error: %s (errno: %d)",
-                      net->last_error, net->last_errno);
-    else
-      sql_print_error("Read semi-sync reply length error: %s (errno: %d)",
-                      net->last_error, net->last_errno);
+    sql_print_error("Read semi-sync reply network error: %s (errno: %d)",
+                    net->last_error, net->last_errno);
+    goto l_end;
+  }
+
+  result = reportReplyPacket(server_id, net->read_pos, packet_len);
+
+ l_end:
+  return function_exit(kWho, result);
+}
+
+int ReplSemiSyncMaster::flushSyncEvent(NET *net, const char *event_buf)
+{
+  const char *kWho = "ReplSemiSyncMaster::flushSyncEvent";
+  int result = 0;
+
+  function_enter(kWho);
+
+  assert((unsigned char)event_buf[1] == kPacketMagicNum);
+  if ((unsigned char)event_buf[2] != kPacketFlagSync)
+  {
+    /* current event does not require reply */
+    goto l_end;
+  }
+
+  /* We flush to make sure that the current event is sent to the network,
+   * instead of being buffered in the TCP/IP stack.
+   */
+  if (net_flush(net))
+  {
+    sql_print_error("Semi-sync master failed on net_flush() "
+                    "before waiting for slave reply");
+    result = -1;
+    goto l_end;
+  }
+
+  /* The slave sends its reply as packet 0 and continues to read events
+   * from packet 1 on, exactly as if we had read the reply here.
+   */
+  net->pkt_nr= net->compress_pkt_nr= 1;
+
+ l_end:
+  return function_exit(kWho, result);
+}
+
+int ReplSemiSyncMaster::reportReplyPacket(uint32 server_id,
+                                          const unsigned char *packet,
+                                          ulong packet_len)
+{
+  const char *kWho = "ReplSemiSyncMaster::reportReplyPacket";
+  char     log_file_name[FN_REFLEN];
+  my_off_t log_file_pos;
+  ulong    log_file_len = 0;
+  int      result = -1;
+
+  function_enter(kWho);
+
+  if (packet_len < REPLY_BINLOG_NAME_OFFSET)
+  {
+    sql_print_error("Read semi-sync reply length error: packet is too small");
     goto l_end;
   }
 
-  packet = net->read_pos;
   if (packet[REPLY_MAGIC_NUM_OFFSET] != ReplSemiSyncMaster::kPacketMagicNum)
   {
     sql_print_error("Read semi-sync reply magic number error");
@@ -1262,7 +1232,7 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
   strncpy(log_file_name, (const char*)packet + REPLY_BINLOG_NAME_OFFSET, log_file_len);
   log_file_name[log_file_len] = 0;
 
-  if (trc_level & kTraceDetail)
+  if (trace_level_ & kTraceDetail)
     sql_print_information("%s: Got reply (%s, %lu)",
                           kWho, log_file_name, (ulong)log_file_pos);
 
@@ -1285,9 +1255,12 @@ int ReplSemiSyncMaster::resetMaster()
 
   state_ = getMasterEnabled()? 1 : 0;
 
-  wait_file_name_inited_   = false;
-  reply_file_name_inited_  = false;
-  commit_file_name_inited_ = false;
+  /* The binlog file numbers start over, forget the old positions. */
+  store_key(&wait_key_, 0);
+  store_key(&reply_key_, 0);
+  store_key(&commit_key_, 0);
+  if (active_tranxs_)
+    active_tranxs_->clear_active_tranx_nodes(0);
 
   rpl_semi_sync_master_yes_transactions = 0;
   rpl_semi_sync_master_no_transactions = 0;
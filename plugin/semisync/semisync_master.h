@@ -19,6 +19,7 @@
 #define SEMISYNC_MASTER_H
 
 #include "semisync.h"
+#include <my_atomic.h>
 
 #ifdef HAVE_PSI_INTERFACE
 extern PSI_mutex_key key_ss_mutex_LOCK_binlog_;
@@ -27,349 +28,96 @@ extern PSI_cond_key key_ss_cond_COND_binlog_send_;
 
 extern PSI_stage_info stage_waiting_for_semi_sync_ack_from_slave;
 
-struct TranxNode {
-  char             log_name_[FN_REFLEN];
-  my_off_t         log_pos_;
-  mysql_cond_t     cond;
-  int              n_waiters;
-  struct TranxNode *next_;            /* the next node in the sorted list */
-  struct TranxNode *hash_next_;    /* the next node during hash collision */
-};
-
 /**
-  @class TranxNodeAllocator
-
-  This class provides memory allocating and freeing methods for
-  TranxNode. The main target is performance.
-
-  @section ALLOCATE How to allocate a node
-    The pointer of the first node after 'last_node' in current_block is
-    returned. current_block will move to the next free Block when all nodes of
-    it are in use. A new Block is allocated and is put into the rear of the
-    Block link table if no Block is free.
-
-    The list starts up empty (ie, there is no allocated Block).
-
-    After some nodes are freed, there probably are some free nodes before
-    the sequence of the allocated nodes, but we do not reuse it. It is better
-    to keep the allocated nodes are in the sequence, for it is more efficient
-    for allocating and freeing TranxNode.
-
-  @section FREENODE How to free nodes
-    There are two methods for freeing nodes. They are free_all_nodes and
-    free_nodes_before.
-
-    'A Block is free' means all of its nodes are free.
-    @subsection free_nodes_before
-    As all allocated nodes are in the sequence, 'Before one node' means all
-    nodes before given node in the same Block and all Blocks before the Block
-    which containing the given node. As such, all Blocks before the given one
-    ('node') are free Block and moved into the rear of the Block link table.
-    The Block containing the given 'node', however, is not. For at least the
-    given 'node' is still in use. This will waste at most one Block, but it is
-    more efficient.
- */
-#define BLOCK_TRANX_NODES 16
-class TranxNodeAllocator
-{
-public:
-  /**
-    @param reserved_nodes
-      The number of reserved TranxNodes. It is used to set 'reserved_blocks'
-      which can contain at least 'reserved_nodes' number of TranxNodes.  When
-      freeing memory, we will reserve at least reserved_blocks of Blocks not
-      freed.
-   */
-  TranxNodeAllocator(uint reserved_nodes) :
-    reserved_blocks(reserved_nodes/BLOCK_TRANX_NODES +
-                  (reserved_nodes%BLOCK_TRANX_NODES > 1 ? 2 : 1)),
-    first_block(NULL), last_block(NULL),
-    current_block(NULL), last_node(-1), block_num(0) {}
-
-  ~TranxNodeAllocator()
-  {
-    Block *block= first_block;
-    while (block != NULL)
-    {
-      Block *next= block->next;
-      free_block(block);
-      block= next;
-    }
-  }
-
-  /**
-    The pointer of the first node after 'last_node' in current_block is
-    returned. current_block will move to the next free Block when all nodes of
-    it are in use. A new Block is allocated and is put into the rear of the
-    Block link table if no Block is free.
-
-    @return Return a TranxNode *, or NULL if an error occured.
-   */
-  TranxNode *allocate_node()
-  {
-    TranxNode *trx_node;
-    Block *block= current_block;
-
-    if (last_node == BLOCK_TRANX_NODES-1)
-    {
-      current_block= current_block->next;
-      last_node= -1;
-    }
-
-    if (current_block == NULL && allocate_block())
-    {
-      current_block= block;
-      if (current_block)
-        last_node= BLOCK_TRANX_NODES-1;
-      return NULL;
-    }
-
-    trx_node= &(current_block->nodes[++last_node]);
-    trx_node->log_name_[0] = '\0';
-    trx_node->log_pos_= 0;
-    trx_node->next_= 0;
-    trx_node->hash_next_= 0;
-    trx_node->n_waiters= 0;
-    return trx_node;
-  }
-
-  /**
-    All nodes are freed.
-
-    @return Return 0, or 1 if an error occured.
-   */
-  int free_all_nodes()
-  {
-    current_block= first_block;
-    last_node= -1;
-    free_blocks();
-    return 0;
-  }
-
-  /**
-    All Blocks before the given 'node' are free Block and moved into the rear
-    of the Block link table.
-
-    @param node All nodes before 'node' will be freed
-
-    @return Return 0, or 1 if an error occured.
-   */
-  int free_nodes_before(TranxNode* node)
-  {
-    Block *block;
-    Block *prev_block= NULL;
-
-    block= first_block;
-    while (block != current_block->next)
-    {
-      /* Find the Block containing the given node */
-      if (&(block->nodes[0]) <= node && &(block->nodes[BLOCK_TRANX_NODES]) >= node)
-      {
-        /* All Blocks before the given node are put into the rear */
-        if (first_block != block)
-        {
-          last_block->next= first_block;
-          first_block= block;
-          last_block= prev_block;
-          last_block->next= NULL;
-          free_blocks();
-        }
-        return 0;
-      }
-      prev_block= block;
-      block= block->next;
-    }
-
-    /* Node does not find should never happen */
-    DBUG_ASSERT(0);
-    return 1;
-  }
-
+   This class tracks the binlog positions of the active transactions.
+
+   Each position is packed into a single 64 bit key: the sequence number
+   of the binlog file in the upper half and the offset in the lower half,
+   so positions compare as plain integers.  The keys are kept in sorted
+   order in a ring of size power of two.
+
+   There is only one producer: the transaction thread holding
+   mysql_bin_log.LOCK_log appends the end of each flushed group at the
+   tail.  The binlog dump threads and the ACK receiver consume from the
+   head, which is advanced with compare-and-swap.  A slot is only reused
+   once the head has moved past it, so readers detect a recycled slot by
+   re-reading the head after the lookup.  None of the operations take a
+   mutex.
+
+   When the ring is full the producer copies it into one twice as large
+   and publishes that before it moves the tail.  Readers load the ring
+   after the tail, so the ring they see holds every slot below that tail.
+   The replaced rings are only freed with the object, as readers may
+   still be looking at them.
+*/
+class ActiveTranx
+  :public Trace {
 private:
-  uint reserved_blocks;
-
- /**
-   A sequence memory which contains BLOCK_TRANX_NODES TranxNodes.
 
-   BLOCK_TRANX_NODES The number of TranxNodes which are in a Block.
-
-   next Every Block has a 'next' pointer which points to the next Block.
-        These linking Blocks constitute a Block link table.
-  */
-  struct Block {
-    Block *next;
-    TranxNode nodes[BLOCK_TRANX_NODES];
+  struct Ring {
+    int64         *keys;            /* ring of active transaction keys */
+    uint64         size;                   /* number of slots, power of 2 */
+    Ring          *prev;              /* the smaller ring this replaced */
   };
 
-  /**
-    The 'first_block' is the head of the Block link table;
-   */
-  Block *first_block;
-  /**
-    The 'last_block' is the rear of the Block link table;
-   */
-  Block *last_block;
+  Ring * volatile  ring_;                          /* the current ring */
+  volatile int64   head_;                 /* first active slot (absolute) */
+  volatile int64   tail_;                /* next free slot (absolute) */
 
-  /**
-    current_block always points the Block in the Block link table in
-    which the last allocated node is. The Blocks before it are all in use
-    and the Blocks after it are all free.
-   */
-  Block *current_block;
+  my_atomic_rwlock_t lock_;
 
-  /**
-    It always points to the last node which has been allocated in the
-    current_block.
-   */
-  int last_node;
-
-  /**
-    How many Blocks are in the Block link table.
-   */
-  uint block_num;
-
-  /**
-    Allocate a block and then assign it to current_block.
-  */
-  int allocate_block()
+  int64 load_head();
+  int64 load_tail();
+  Ring *load_ring();
+  static int64 key_at(const Ring *ring, int64 index)
   {
-    Block *block= (Block *)my_malloc(sizeof(Block), MYF(0));
-    if (block)
-    {
-      block->next= NULL;
-
-      if (first_block == NULL)
-        first_block= block;
-      else
-        last_block->next= block;
-
-      /* New Block is always put into the rear */
-      last_block= block;
-      /* New Block is always the current_block */
-      current_block= block;
-      ++block_num;
-
-      for (int i=0; i< BLOCK_TRANX_NODES; i++)
-        mysql_cond_init(key_ss_cond_COND_binlog_send_,
-                        &current_block->nodes[i].cond,
-                        NULL);
-
-      return 0;
-    }
-    return 1;
+    return ring->keys[index & (ring->size - 1)];
   }
 
-  /**
-    Free a given Block.
-    @param block The Block will be freed.
-   */
-  void free_block(Block *block)
-  {
-    for (int i=0; i< BLOCK_TRANX_NODES; i++)
-      mysql_cond_destroy(&block->nodes[i].cond);
-    my_free(block);
-    --block_num;
-  }
+  /* Find the first slot in [from, to) whose key is larger than 'key'. */
+  static int64 upper_bound(const Ring *ring, int64 from, int64 to,
+                           int64 key);
 
-
-  /**
-    If there are some free Blocks and the total number of the Blocks in the
-    Block link table is larger than the 'reserved_blocks', Some free Blocks
-    will be freed until the total number of the Blocks is equal to the
-    'reserved_blocks' or there is only one free Block behind the
-    'current_block'.
+  /* Replace the ring by one twice as large holding the slots from 'head'
+   * to 'tail'.  Only called by the producer.
    */
-  void free_blocks()
-  {
-    if (current_block == NULL || current_block->next == NULL)
-      return;
-
-    /* One free Block is always kept behind the current block */
-    Block *block= current_block->next->next;
-    while (block_num > reserved_blocks && block != NULL)
-    {
-      Block *next= block->next;
-      free_block(block);
-      block= next;
-    }
-    current_block->next->next= block;
-    if (block == NULL)
-      last_block= current_block->next;
-  }
-};
-
-/**
-   This class manages memory for active transaction list.
-
-   We record each active transaction with a TranxNode, each session
-   can have only one open transaction. Because of EVENT, the total
-   active transaction nodes can exceed the maximum allowed
-   connections.
-*/
-class ActiveTranx
-  :public Trace {
-private:
-
-  TranxNodeAllocator allocator_;
-  /* These two record the active transaction list in sort order. */
-  TranxNode       *trx_front_, *trx_rear_;
-
-  TranxNode      **trx_htb_;        /* A hash table on active transactions. */
-
-  int              num_entries_;              /* maximum hash table entries */
-  mysql_mutex_t *lock_;                                     /* mutex lock */
-
-  inline void assert_lock_owner();
-
-  inline unsigned int calc_hash(const unsigned char *key,unsigned int length);
-  unsigned int get_hash_value(const char *log_file_name, my_off_t log_file_pos);
-
-  int compare(const char *log_file_name1, my_off_t log_file_pos1,
-              const TranxNode *node2) {
-    return compare(log_file_name1, log_file_pos1,
-                   node2->log_name_, node2->log_pos_);
-  }
-  int compare(const TranxNode *node1,
-              const char *log_file_name2, my_off_t log_file_pos2) {
-    return compare(node1->log_name_, node1->log_pos_,
-                   log_file_name2, log_file_pos2);
-  }
-  int compare(const TranxNode *node1, const TranxNode *node2) {
-    return compare(node1->log_name_, node1->log_pos_,
-                   node2->log_name_, node2->log_pos_);
-  }
+  Ring *grow(Ring *ring, int64 head, int64 tail);
 
 public:
-  int signal_waiting_sessions_all();
-  int signal_waiting_sessions_up_to(const char *log_file_name,
-                                    my_off_t log_file_pos);
-  TranxNode* find_active_tranx_node(const char *log_file_name,
-                                    my_off_t log_file_pos);
-  ActiveTranx(mysql_mutex_t *lock, unsigned long trace_level);
+  ActiveTranx(unsigned long trace_level);
   ~ActiveTranx();
 
-  /* Insert an active transaction node with the specified position.
+  /* Pack a binlog position into a key, see the class comment.  Returns 0
+   * if the file name carries no sequence number.
+   */
+  static int64 make_key(const char *log_file_name, my_off_t log_file_pos);
+
+  /* Insert an active transaction with the specified position.  Positions
+   * must be inserted in increasing order.
    *
    * Return:
-   *  0: success;  non-zero: error
+   *  0: success;  non-zero: error (out of order)
    */
   int insert_tranx_node(const char *log_file_name, my_off_t log_file_pos);
 
-  /* Clear the active transaction nodes until(inclusive) the specified
-   * position.
-   * If log_file_name is NULL, everything will be cleared: the sorted
-   * list and the hash table will be reset to empty.
+  /* Clear the active transactions until(inclusive) the specified key.
+   * If key is 0, everything will be cleared.
    * 
    * Return:
    *  0: success;  non-zero: error
    */
-  int clear_active_tranx_nodes(const char *log_file_name,
-                               my_off_t    log_file_pos);
+  int clear_active_tranx_nodes(int64 key);
 
-  /* Given a position, check to see whether the position is an active
-   * transaction's ending position by probing the hash table.
+  /* Given a key, check to see whether the position is an active
+   * transaction's ending position.
    */
-  bool is_tranx_end_pos(const char *log_file_name, my_off_t log_file_pos);
+  bool is_tranx_end_pos(int64 key);
+
+  /* Check whether an active transaction ends at or after the given key,
+   * i.e. whether a transaction committing at this position will get an
+   * ACK from the slave.
+   */
+  bool is_active(int64 key);
 
   /* Given two binlog positions, compare which one is bigger based on
    * (file_name, file_position).
@@ -377,15 +125,15 @@ public:
   static int compare(const char *log_file_name1, my_off_t log_file_pos1,
                      const char *log_file_name2, my_off_t log_file_pos2);
 
-  /* Find out if active tranx node list is empty or not
+  /* Find out if active tranx list is empty or not
    *
    * Return:
-   *   True :  If there are no nodes
+   *   True :  If there are no active transactions
    *   False:  othewise
   */
   bool is_empty()
   {
-    return (trx_front_ == NULL);
+    return load_head() == load_tail();
   }
 
 };
@@ -402,56 +150,53 @@ class ReplSemiSyncMaster
   /* True when initObject has been called */
   bool init_done_;
 
-  /* Mutex that protects the following state variables and the active
-   * transaction list.
+  /* Mutex that protects the state changes and the waiting sessions.
+   * The binlog positions below and the active transaction list are
+   * atomics and are read and advanced without it; the mutex is only taken
+   * to switch semi-sync on/off and to wake up waiting sessions.
    * Under no cirumstances we can acquire mysql_bin_log.LOCK_log if we are
    * already holding LOCK_binlog_ because it can cause deadlocks.
    */
   mysql_mutex_t LOCK_binlog_;
 
-  /* This is set to true when reply_file_name_ contains meaningful data. */
-  bool            reply_file_name_inited_;
-
-  /* The binlog name up to which we have received replies from any slaves. */
-  char            reply_file_name_[FN_REFLEN];
+  /* Sessions waiting for a slave reply wait on this condition. */
+  mysql_cond_t  COND_binlog_send_;
 
-  /* The position in that file up to which we have the reply from any slaves. */
-  my_off_t        reply_file_pos_;
+  /* Protects the atomic accesses to the keys below. */
+  my_atomic_rwlock_t key_lock_;
 
-  /* This is set to true when we know the 'smallest' wait position. */
-  bool            wait_file_name_inited_;
-
-  /* NULL, or the 'smallest' filename that a transaction is waiting for
-   * slave replies.
+  /* The binlog position (see ActiveTranx::make_key) up to which we have
+   * received replies from any slaves, 0 if unknown.
    */
-  char            wait_file_name_[FN_REFLEN];
+  volatile int64  reply_key_;
 
-  /* The smallest position in that file that a trx is waiting for: the trx
-   * can proceed and send an 'ok' to the client when the master has got the
-   * reply from the slave indicating that it already got the binlog events.
+  /* The 'smallest' position that a transaction is waiting for slave
+   * replies, 0 if no session waits.  Only changed under LOCK_binlog_,
+   * read without it: the trx can proceed and send an 'ok' to the client
+   * when the master has got the reply from the slave indicating that it
+   * already got the binlog events.
    */
-  my_off_t        wait_file_pos_;
+  volatile int64  wait_key_;
 
-  /* This is set to true when we know the 'largest' transaction commit
-   * position in the binlog file.
+  /* The 'largest' transaction commit position in the binlog, 0 if
+   * unknown.
    * We always maintain the position no matter whether semi-sync is switched
    * on switched off.  When a transaction wait timeout occurs, semi-sync will
-   * switch off.  Binlog-dump thread can use the three fields to detect when
+   * switch off.  Binlog-dump thread can use the position to detect when
    * slaves catch up on replication so that semi-sync can switch on again.
    */
-  bool            commit_file_name_inited_;
-
-  /* The 'largest' binlog filename that a commit transaction is seeing.       */
-  char            commit_file_name_[FN_REFLEN];
+  volatile int64  commit_key_;
 
-  /* The 'largest' position in that file that a commit transaction is seeing. */
-  my_off_t        commit_file_pos_;
+  int64 load_key(volatile int64 *key);
+  void store_key(volatile int64 *key, int64 value);
+  /* Move *key forward to value, never backwards. */
+  void advance_key(volatile int64 *key, int64 value);
 
   /* All global variables which can be set by parameters. */
   volatile bool            master_enabled_;      /* semi-sync is enabled on the master */
   unsigned long           wait_timeout_;      /* timeout period(ms) during tranx wait */
 
-  bool            state_;                    /* whether semi-sync is switched */
+  volatile bool   state_;                    /* whether semi-sync is switched */
 
   void lock();
   void unlock();
@@ -472,6 +217,9 @@ class ReplSemiSyncMaster
   int try_switch_on(int server_id,
                     const char *log_file_name, my_off_t log_file_pos);
 
+  /* Wake up the waiting sessions if the reply has reached any of them. */
+  void signal_waiting_sessions();
+
  public:
   ReplSemiSyncMaster();
   ~ReplSemiSyncMaster();
@@ -605,6 +353,32 @@ class ReplSemiSyncMaster
    */
   int readSlaveReply(NET *net, uint32 server_id, const char *event_buf);
 
+  /* Send out the current event when it requests a reply from the slave,
+   * without waiting for the reply: the ACK receiver thread reads it.
+   *
+   * Input:
+   *  net          - (IN)  the connection to the slave
+   *  event_buf    - (IN)  pointer to the event packet
+   *
+   * Return:
+   *  0: success;  non-zero: error
+   */
+  int flushSyncEvent(NET *net, const char *event_buf);
+
+  /* Parse a reply packet read from the slave and report its position.
+   * Used by readSlaveReply() and by the ACK receiver thread.
+   *
+   * Input:
+   *  server_id    - (IN)  slave server id number
+   *  packet       - (IN)  the reply packet payload
+   *  packet_len   - (IN)  length of the payload
+   *
+   * Return:
+   *  0: success;  non-zero: error
+   */
+  int reportReplyPacket(uint32 server_id, const unsigned char *packet,
+                        ulong packet_len);
+
   /* In semi-sync replication, this method simulates the reception of
    * an reply and executes reportReplyBinlog directly when a transaction
    * is skipped in the master.
@@ -0,0 +1,375 @@
+/* Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+
+#include "semisync_master_ack_receiver.h"
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+extern ReplSemiSyncMaster repl_semisync;
+
+Ack_receiver ack_receiver;
+
+/* How long the thread sleeps in poll() before it checks for stop. */
+#define ACK_RECEIVER_POLL_TIMEOUT_MS 1000
+
+pthread_handler_t ack_receive_handler(void *arg)
+{
+  my_thread_init();
+  reinterpret_cast<Ack_receiver *>(arg)->run();
+  my_thread_end();
+  pthread_exit(0);
+  return NULL;
+}
+
+Ack_receiver::Ack_receiver()
+  : m_inited(false), m_status(ST_DOWN), m_slaves_changed(false),
+    m_reading(NULL), m_abort_read(false)
+{
+}
+
+Ack_receiver::~Ack_receiver()
+{
+  if (m_inited)
+  {
+    mysql_cond_destroy(&m_cond);
+    mysql_mutex_destroy(&m_mutex);
+  }
+}
+
+void Ack_receiver::init()
+{
+  if (m_inited)
+    return;
+  mysql_mutex_init(key_ss_mutex_Ack_receiver_mutex, &m_mutex,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_ss_cond_Ack_receiver_cond, &m_cond, NULL);
+  m_inited= true;
+}
+
+int Ack_receiver::start()
+{
+  const char *kWho = "Ack_receiver::start";
+  pthread_attr_t attr;
+  int result = 0;
+
+  function_enter(kWho);
+
+  mysql_mutex_lock(&m_mutex);
+  if (m_status == ST_DOWN)
+  {
+    /* The thread runs as long as the status stays up. */
+    m_status= ST_UP;
+    if (pthread_attr_init(&attr) ||
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE) ||
+        mysql_thread_create(key_ss_thread_Ack_receiver_thread, &m_pid,
+                            &attr, ack_receive_handler, this))
+    {
+      sql_print_error("Failed to start semi-sync ACK receiver thread, "
+                      "errno(%d)", errno);
+      m_status= ST_DOWN;
+      result = -1;
+    }
+    (void) pthread_attr_destroy(&attr);
+  }
+  mysql_mutex_unlock(&m_mutex);
+
+  return function_exit(kWho, result);
+}
+
+void Ack_receiver::stop()
+{
+  const char *kWho = "Ack_receiver::stop";
+
+  function_enter(kWho);
+
+  mysql_mutex_lock(&m_mutex);
+  if (m_status == ST_UP)
+  {
+    m_status= ST_STOPPING;
+    mysql_cond_broadcast(&m_cond);
+
+    while (m_status == ST_STOPPING)
+      mysql_cond_wait(&m_cond, &m_mutex);
+    mysql_mutex_unlock(&m_mutex);
+
+    pthread_join(m_pid, NULL);
+  }
+  else
+    mysql_mutex_unlock(&m_mutex);
+
+  function_exit(kWho, 0);
+}
+
+bool Ack_receiver::can_serve(THD *thd)
+{
+  Vio *vio= thd->net.vio;
+
+  if (vio == NULL || thd->net.compress)
+    return false;
+  return (vio_type(vio) == VIO_TYPE_TCPIP || vio_type(vio) == VIO_TYPE_SOCKET);
+}
+
+int Ack_receiver::add_slave(THD *thd)
+{
+  const char *kWho = "Ack_receiver::add_slave";
+  Slave slave;
+  int result = 0;
+
+  function_enter(kWho);
+
+  slave.thd= thd;
+  slave.vio= thd->net.vio;
+  slave.server_id= thd->server_id;
+
+  mysql_mutex_lock(&m_mutex);
+  if (m_slaves.append(slave))
+    result = -1;
+  else
+  {
+    m_slaves_changed= true;
+    mysql_cond_broadcast(&m_cond);
+  }
+  mysql_mutex_unlock(&m_mutex);
+
+  return function_exit(kWho, result);
+}
+
+void Ack_receiver::remove_slave(THD *thd)
+{
+  const char *kWho = "Ack_receiver::remove_slave";
+
+  function_enter(kWho);
+
+  mysql_mutex_lock(&m_mutex);
+  for (int i= 0; i < m_slaves.elements(); i++)
+  {
+    if (m_slaves.at(i).thd == thd)
+    {
+      m_slaves.del(i);
+      m_slaves_changed= true;
+      break;
+    }
+  }
+
+  /* The thread reads from a slave without m_mutex: wait until it is done
+   * with the connection.  A read in the middle of a reply gives up at its
+   * next timeout.
+   */
+  if (m_reading == thd)
+  {
+    m_abort_read= true;
+    while (m_reading == thd)
+      mysql_cond_wait(&m_cond, &m_mutex);
+  }
+  mysql_mutex_unlock(&m_mutex);
+
+  function_exit(kWho, 0);
+}
+
+bool Ack_receiver::read_aborted()
+{
+  bool aborted;
+
+  mysql_mutex_lock(&m_mutex);
+  aborted= m_abort_read || m_status != ST_UP;
+  mysql_mutex_unlock(&m_mutex);
+  return aborted;
+}
+
+/*
+  Read len bytes from the connection, waiting for readability first so
+  that remove_slave() and stop() are not held up by a slave which stops
+  in the middle of a reply.
+*/
+bool Ack_receiver::read_fully(Vio *vio, uchar *buf, size_t len)
+{
+  while (len > 0)
+  {
+    int ready= vio_io_wait(vio, VIO_IO_EVENT_READ,
+                           ACK_RECEIVER_POLL_TIMEOUT_MS);
+    if (ready < 0)
+      return true;
+    if (ready == 0)
+    {
+      if (read_aborted())
+        return true;
+      continue;
+    }
+
+    size_t ret= vio_read(vio, buf, len);
+    if (ret == 0 || ret == (size_t) -1)
+      return true;
+    buf+= ret;
+    len-= ret;
+  }
+  return false;
+}
+
+/*
+  Read all replies which are available on the connection of the given
+  slave.  Called without m_mutex: run() marks the slave in m_reading
+  instead, and remove_slave() waits for it.
+
+  A reply is a single small uncompressed packet which the slave always
+  sends with packet number 0 (see ReplSemiSyncSlave::slaveReply()), so
+  the framing is read here directly: reading through a NET would need a
+  THD, which cannot be released safely when the plugin is shut down after
+  the binary log.
+*/
+void Ack_receiver::read_replies(const Slave &slave, bool *failed)
+{
+  const char *kWho = "Ack_receiver::read_replies";
+  uchar header[NET_HEADER_SIZE];
+  uchar packet[REPLY_BINLOG_NAME_OFFSET + REPLY_BINLOG_NAME_LEN];
+  ulong len;
+
+  do
+  {
+    if (read_fully(slave.vio, header, NET_HEADER_SIZE))
+    {
+      /* The connection is closing: stop listening to it until the dump
+       * thread removes the slave.
+       */
+      if (trace_level_ & kTraceGeneral)
+        sql_print_information("%s: failed to read reply from slave "
+                              "(server_id: %u), errno: %d", kWho,
+                              slave.server_id, socket_errno);
+      *failed= true;
+      break;
+    }
+
+    len= uint3korr(header);
+    if (header[3] != 0 || len > sizeof(packet) ||
+        read_fully(slave.vio, packet, len))
+    {
+      sql_print_error("Read semi-sync reply network error from slave "
+                      "(server_id: %u)", slave.server_id);
+      *failed= true;
+      break;
+    }
+
+    (void) repl_semisync.reportReplyPacket(slave.server_id, packet, len);
+  } while (slave.vio->has_data(slave.vio));
+}
+
+void Ack_receiver::run()
+{
+  int ret;
+  uint i, listening= 0;
+#ifdef _WIN32
+  Dynamic_array<my_socket> fds;
+  fd_set read_fds;
+  struct timeval tv;
+#else
+  Dynamic_array<struct pollfd> fds;
+#endif
+
+  sql_print_information("Starting semi-sync ACK receiver thread.");
+
+  mysql_mutex_lock(&m_mutex);
+  m_slaves_changed= true;
+
+  while (m_status == ST_UP)
+  {
+    if (m_slaves_changed)
+    {
+      fds.clear();
+      for (i= 0; i < (uint) m_slaves.elements(); i++)
+      {
+#ifdef _WIN32
+        fds.append(vio_fd(m_slaves.at(i).vio));
+#else
+        struct pollfd pfd;
+        pfd.fd= vio_fd(m_slaves.at(i).vio);
+        pfd.events= POLLIN;
+        pfd.revents= 0;
+        fds.append(pfd);
+#endif
+      }
+      listening= fds.elements();
+      m_slaves_changed= false;
+    }
+
+    if (listening == 0)
+    {
+      struct timespec abstime;
+      set_timespec(abstime, 1);
+      mysql_cond_timedwait(&m_cond, &m_mutex, &abstime);
+      continue;
+    }
+
+    /* Wait for replies without the mutex, the dump threads may come and
+     * go meanwhile.
+     */
+    mysql_mutex_unlock(&m_mutex);
+#ifdef _WIN32
+    FD_ZERO(&read_fds);
+    for (i= 0; i < (uint) fds.elements(); i++)
+      if (fds.at(i) != INVALID_SOCKET)
+        FD_SET(fds.at(i), &read_fds);
+    tv.tv_sec= ACK_RECEIVER_POLL_TIMEOUT_MS / 1000;
+    tv.tv_usec= 0;
+    ret= select(0, &read_fds, NULL, NULL, &tv);
+#else
+    ret= poll(fds.front(), fds.elements(), ACK_RECEIVER_POLL_TIMEOUT_MS);
+#endif
+    mysql_mutex_lock(&m_mutex);
+
+    /* The sockets may not belong to the same slaves anymore. */
+    if (ret <= 0 || m_slaves_changed)
+      continue;
+
+    for (i= 0; i < (uint) fds.elements() && !m_slaves_changed; i++)
+    {
+      bool failed= false;
+#ifdef _WIN32
+      if (fds.at(i) == INVALID_SOCKET || !FD_ISSET(fds.at(i), &read_fds))
+        continue;
+#else
+      if (fds.at(i).fd < 0 || fds.at(i).revents == 0)
+        continue;
+#endif
+
+      /* m_slaves may be reallocated while we read: work on a copy. */
+      Slave slave= m_slaves.at(i);
+      m_reading= slave.thd;
+      mysql_mutex_unlock(&m_mutex);
+      read_replies(slave, &failed);
+      mysql_mutex_lock(&m_mutex);
+      m_reading= NULL;
+      m_abort_read= false;
+      mysql_cond_broadcast(&m_cond);
+
+      if (failed)
+      {
+#ifdef _WIN32
+        fds.at(i)= INVALID_SOCKET;
+#else
+        /* poll() ignores negative descriptors. */
+        fds.at(i).fd= -1;
+#endif
+        listening--;
+      }
+    }
+  }
+
+  sql_print_information("Stopping semi-sync ACK receiver thread.");
+
+  m_status= ST_DOWN;
+  mysql_cond_broadcast(&m_cond);
+  mysql_mutex_unlock(&m_mutex);
+}
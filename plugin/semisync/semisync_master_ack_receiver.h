@@ -0,0 +1,112 @@
+/* Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+
+#ifndef SEMISYNC_MASTER_ACK_RECEIVER_H
+#define SEMISYNC_MASTER_ACK_RECEIVER_H
+
+#include "semisync_master.h"
+#include "sql_class.h"                          // THD
+#include "sql_array.h"                          // Dynamic_array
+
+#ifdef HAVE_PSI_INTERFACE
+extern PSI_mutex_key key_ss_mutex_Ack_receiver_mutex;
+extern PSI_cond_key key_ss_cond_Ack_receiver_cond;
+extern PSI_thread_key key_ss_thread_Ack_receiver_thread;
+#endif
+
+/**
+   The ACK receiver reads the replies of all semi-sync slaves in one
+   thread, so that the binlog dump threads can go on sending events
+   instead of waiting for the reply of each transaction.
+
+   A binlog dump thread registers its slave with add_slave() when the dump
+   starts and removes it with remove_slave() when the dump ends.  The
+   thread polls the sockets of the registered slaves and reads the replies
+   while the dump threads keep writing to the same sockets.
+
+   Slaves connected through SSL or with a compressed protocol keep reading
+   their replies in the dump thread: both keep per-connection state which
+   cannot be shared between a reader and a writer thread.
+*/
+class Ack_receiver
+  :public Trace {
+public:
+  Ack_receiver();
+  ~Ack_receiver();
+
+  /* Initialize the mutex and the condition; call once from plugin init. */
+  void init();
+
+  /* Start the receiver thread if it is not running.
+   *
+   * Return:
+   *  0: success;  non-zero: error
+   */
+  int start();
+
+  /* Stop the receiver thread and wait until it exits. */
+  void stop();
+
+  /* Can the receiver read the replies of the slave connected to thd? */
+  static bool can_serve(THD *thd);
+
+  /* Start listening to the replies of the slave served by thd. */
+  int add_slave(THD *thd);
+
+  /* Stop listening to the slave served by thd.  After the call returns
+   * the receiver does not touch the connection anymore.
+   */
+  void remove_slave(THD *thd);
+
+  void setTraceLevel(unsigned long trace_level) {
+    trace_level_ = trace_level;
+  }
+
+  /* The body of the receiver thread. */
+  void run();
+
+private:
+  enum status { ST_UP, ST_DOWN, ST_STOPPING };
+
+  struct Slave
+  {
+    THD    *thd;
+    Vio    *vio;
+    uint32  server_id;
+  };
+
+  /* Protects the fields below. */
+  mysql_mutex_t        m_mutex;
+  mysql_cond_t         m_cond;
+  bool                 m_inited;
+  status               m_status;
+  /* Set when m_slaves changed since the thread built its socket list. */
+  bool                 m_slaves_changed;
+  Dynamic_array<Slave> m_slaves;
+  pthread_t            m_pid;
+  /* The slave whose replies the thread is reading, without m_mutex. */
+  THD                 *m_reading;
+  /* Set by remove_slave() to make that read give up at its next timeout. */
+  bool                 m_abort_read;
+
+  bool read_aborted();
+  bool read_fully(Vio *vio, uchar *buf, size_t len);
+  void read_replies(const Slave &slave, bool *failed);
+};
+
+extern Ack_receiver ack_receiver;
+
+#endif /* SEMISYNC_MASTER_ACK_RECEIVER_H */
@@ -17,6 +17,7 @@
 
 
 #include "semisync_master.h"
+#include "semisync_master_ack_receiver.h"
 #include "sql_class.h"                          // THD
 
 ReplSemiSyncMaster repl_semisync;
@@ -74,6 +75,18 @@ int repl_semi_binlog_dump_start(Binlog_transmit_param *param,
   
   if (semi_sync_slave)
   {
+    /*
+      Replies of this slave are read by the ACK receiver thread instead of
+      this dump thread, if the connection allows it.
+    */
+    THD *thd= current_thd;
+    if (Ack_receiver::can_serve(thd) && ack_receiver.add_slave(thd))
+    {
+      sql_print_error("Failed to register slave (server_id: %d) "
+                      "with the semi-sync ACK receiver", param->server_id);
+      return 1;
+    }
+
     /* One more semi-sync slave */
     repl_semisync.add_slave();
     /* Tell server it will observe the transmission.*/
@@ -104,6 +117,10 @@ int repl_semi_binlog_dump_end(Binlog_transmit_param *param)
                         param->server_id);
   if (semi_sync_slave)
   {
+    THD *thd= current_thd;
+    if (Ack_receiver::can_serve(thd))
+      ack_receiver.remove_slave(thd);
+
     /* One less semi-sync slave */
     repl_semisync.remove_slave();
   }
@@ -146,8 +163,11 @@ int repl_semi_after_send_event(Binlog_transmit_param *param,
         because we do not want dump thread to quit on this. Error
         messages are already reported.
       */
-      (void) repl_semisync.readSlaveReply(&thd->net,
-                                          param->server_id, event_buf);
+      if (Ack_receiver::can_serve(thd))
+        (void) repl_semisync.flushSyncEvent(&thd->net, event_buf);
+      else
+        (void) repl_semisync.readSlaveReply(&thd->net,
+                                            param->server_id, event_buf);
       thd->clear_error();
     }
   }
@@ -235,6 +255,7 @@ static void fix_rpl_semi_sync_master_trace_level(MYSQL_THD thd,
 {
   *(unsigned long *)ptr= *(unsigned long *)val;
   repl_semisync.setTraceLevel(rpl_semi_sync_master_trace_level);
+  ack_receiver.setTraceLevel(rpl_semi_sync_master_trace_level);
   return;
 }
 
@@ -248,11 +269,18 @@ static void fix_rpl_semi_sync_master_enabled(MYSQL_THD thd,
   {
     if (repl_semisync.enableMaster() != 0)
       rpl_semi_sync_master_enabled = false;
+    else if (ack_receiver.start())
+    {
+      repl_semisync.disableMaster();
+      rpl_semi_sync_master_enabled = false;
+    }
   }
   else
   {
     if (repl_semisync.disableMaster() != 0)
       rpl_semi_sync_master_enabled = true;
+    else
+      ack_receiver.stop();
   }
 
   return;
@@ -355,17 +383,28 @@ static SHOW_VAR semi_sync_master_status_vars[]= {
 
 #ifdef HAVE_PSI_INTERFACE
 PSI_mutex_key key_ss_mutex_LOCK_binlog_;
+PSI_mutex_key key_ss_mutex_Ack_receiver_mutex;
 
 static PSI_mutex_info all_semisync_mutexes[]=
 {
-  { &key_ss_mutex_LOCK_binlog_, "LOCK_binlog_", 0}
+  { &key_ss_mutex_LOCK_binlog_, "LOCK_binlog_", 0},
+  { &key_ss_mutex_Ack_receiver_mutex, "Ack_receiver::m_mutex", 0}
 };
 
 PSI_cond_key key_ss_cond_COND_binlog_send_;
+PSI_cond_key key_ss_cond_Ack_receiver_cond;
 
 static PSI_cond_info all_semisync_conds[]=
 {
-  { &key_ss_cond_COND_binlog_send_, "COND_binlog_send_", 0}
+  { &key_ss_cond_COND_binlog_send_, "COND_binlog_send_", 0},
+  { &key_ss_cond_Ack_receiver_cond, "Ack_receiver::m_cond", 0}
+};
+
+PSI_thread_key key_ss_thread_Ack_receiver_thread;
+
+static PSI_thread_info all_semisync_threads[]=
+{
+  { &key_ss_thread_Ack_receiver_thread, "Ack_receiver", PSI_FLAG_GLOBAL}
 };
 #endif /* HAVE_PSI_INTERFACE */
 
@@ -389,6 +428,9 @@ static void init_semisync_psi_keys(void)
   count= array_elements(all_semisync_conds);
   mysql_cond_register(category, all_semisync_conds, count);
 
+  count= array_elements(all_semisync_threads);
+  mysql_thread_register(category, all_semisync_threads, count);
+
   count= array_elements(all_semisync_stages);
   mysql_stage_register(category, all_semisync_stages, count);
 }
@@ -400,8 +442,12 @@ static int semi_sync_master_plugin_init(void *p)
   init_semisync_psi_keys();
 #endif
 
+  ack_receiver.init();
+  ack_receiver.setTraceLevel(rpl_semi_sync_master_trace_level);
   if (repl_semisync.initObject())
     return 1;
+  if (rpl_semi_sync_master_enabled && ack_receiver.start())
+    return 1;
   if (register_trans_observer(&trans_observer, p))
     return 1;
   if (register_binlog_storage_observer(&storage_observer, p))
@@ -413,6 +459,8 @@ static int semi_sync_master_plugin_init(void *p)
 
 static int semi_sync_master_plugin_deinit(void *p)
 {
+  ack_receiver.stop();
+
   if (unregister_trans_observer(&trans_observer, p))
   {
     sql_print_error("unregister_trans_observer failed");
@@ -139,6 +139,19 @@ DROP PREPARE stmt;
 
 SET SESSION sql_mode=@sql_mode_orig;
 
+CREATE TABLE IF NOT EXISTS column_stats (
+	database_name			VARCHAR(64) NOT NULL,
+	table_name			VARCHAR(64) NOT NULL,
+	column_name			VARCHAR(64) COLLATE utf8_general_ci NOT NULL,
+	last_update			TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+	histogram_type			ENUM('SINGLETON', 'EQUI-HEIGHT') NOT NULL,
+	buckets				INT UNSIGNED NOT NULL,
+	sampled_rows			BIGINT UNSIGNED NOT NULL,
+	null_fraction			DOUBLE NOT NULL,
+	histogram			LONGBLOB NOT NULL,
+	PRIMARY KEY (database_name, table_name, column_name)
+) ENGINE=MyISAM DEFAULT CHARSET=utf8 COLLATE=utf8_bin comment='Column value histograms';
+
 SET @cmd="CREATE TABLE IF NOT EXISTS slave_relay_log_info (
   Number_of_lines INTEGER UNSIGNED NOT NULL COMMENT 'Number of lines in the file or rows in the table. Used to version table definitions.', 
   Relay_log_name TEXT CHARACTER SET utf8 COLLATE utf8_bin NOT NULL COMMENT 'The name of the current relay log file.', 
@@ -20,6 +20,7 @@
 #include "log_event.h"
 #include "rpl_filter.h"
 #include "rpl_rli.h"
+#include "rpl_rli_pdb.h"
 #include "sql_plugin.h"
 #include "rpl_handler.h"
 #include "rpl_info_factory.h"
@@ -63,6 +64,8 @@ static int limit_unsafe_warning_count= 0;
 
 static handlerton *binlog_hton;
 bool opt_binlog_order_commits= true;
+ulong opt_binlog_dump_ring_size= 0;
+Binlog_dump_ring binlog_dump_ring;
 
 const char *log_bin_index= 0;
 const char *log_bin_basename= 0;
@@ -733,7 +736,8 @@ public:
                ptr_binlog_stmt_cache_disk_use_arg),
     trx_cache(TRUE, max_binlog_cache_size_arg,
               ptr_binlog_cache_use_arg,
-              ptr_binlog_cache_disk_use_arg)
+              ptr_binlog_cache_disk_use_arg),
+    last_committed(0)
   {  }
 
   binlog_cache_data* get_binlog_cache_data(bool is_transactional)
@@ -802,6 +806,12 @@ public:
 
   LOG_INFO binlog_info;
 
+  /*
+    Logical clock of the binary log when the transaction started to
+    commit, written into its Gtid event as the commit parent.
+  */
+  int64 last_committed;
+
 private:
 
   binlog_cache_mngr& operator=(const binlog_cache_mngr& info);
@@ -1103,7 +1113,8 @@ static int write_empty_groups_to_cache(THD *thd, binlog_cache_data *cache_data)
   @todo Move this function into the cache class?
  */
 static int
-gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data)
+gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data,
+                        bool flushing= false)
 {
   DBUG_ENTER("gtid_before_write_cache");
   int error= 0;
@@ -1138,15 +1149,25 @@ gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data)
 
   /*
     If an automatic group number was generated, change the first event
-    into a "real" one.
+    into a "real" one.  When the cache is flushed to the binary log
+    the event also gets its logical timestamps, so it is rewritten for
+    any single group.
   */
-  if (thd->variables.gtid_next.type == AUTOMATIC_GROUP)
+  if (thd->variables.gtid_next.type == AUTOMATIC_GROUP ||
+      (flushing && group_cache->get_n_groups() == 1))
   {
     DBUG_ASSERT(group_cache->get_n_groups() == 1);
     Cached_group *cached_group= group_cache->get_unsafe_pointer(0);
     DBUG_ASSERT(cached_group->spec.type != AUTOMATIC_GROUP);
     Gtid_log_event gtid_ev(thd, cache_data->is_trx_cache(),
                            &cached_group->spec);
+    if (flushing)
+    {
+      int64 last_committed= thd_get_cache_mngr(thd)->last_committed;
+      int64 sequence_number;
+      mysql_bin_log.step_logical_clock(&last_committed, &sequence_number);
+      gtid_ev.set_logical_timestamps(last_committed, sequence_number);
+    }
     bool using_file= cache_data->cache_log.pos_in_file > 0;
     my_off_t saved_position= cache_data->reset_write_pos(0, using_file);
     error= gtid_ev.write(&cache_data->cache_log);
@@ -1273,7 +1294,7 @@ binlog_cache_data::flush(THD *thd, my_off_t *bytes_written, bool *wrote_xid)
       transactions might trigger attempts to write to the binary log
       if the cache is not reset.
      */
-    if (!(error= gtid_before_write_cache(thd, this)))
+    if (!(error= gtid_before_write_cache(thd, this, true)))
       error= mysql_bin_log.write_cache(thd, this);
     else
       thd->commit_error= THD::CE_FLUSH_ERROR;
@@ -1562,6 +1583,19 @@ Stage_manager::enroll_for(StageID stage, THD *thd, mysql_mutex_t *stage_mutex)
                        (ulonglong) thd, stage));
   bool leader= m_queue[stage].append(thd);
 
+  /*
+    The order of the flush queue is the commit order: a slave Worker
+    committing in the relay log order lets the next group go.
+  */
+#ifdef HAVE_REPLICATION
+  if (stage == FLUSH_STAGE)
+  {
+    Commit_order_manager *mngr= get_commit_order_manager(thd);
+    if (mngr)
+      mngr->unregister_trx(static_cast<Slave_worker*>(thd->rli_slave));
+  }
+#endif
+
   /*
     The stage mutex can be NULL if we are enrolling for the first
     stage.
@@ -2590,7 +2624,7 @@ bool mysql_show_binlog_events(THD* thd)
 MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
   :bytes_written(0), file_id(1), open_count(1),
    sync_period_ptr(sync_period), sync_counter(0),
-   m_prep_xids(0),
+   m_prep_xids(0), m_logical_clock(0), m_logical_clock_offset(0),
    is_relay_log(0), signal_cnt(0),
    checksum_alg_reset(BINLOG_CHECKSUM_ALG_UNDEF),
    relay_log_checksum_alg(BINLOG_CHECKSUM_ALG_UNDEF),
@@ -2626,6 +2660,7 @@ void MYSQL_BIN_LOG::cleanup()
     mysql_mutex_destroy(&LOCK_xids);
     mysql_cond_destroy(&update_cond);
     my_atomic_rwlock_destroy(&m_prep_xids_lock);
+    my_atomic_rwlock_destroy(&m_logical_clock_lock);
     mysql_cond_destroy(&m_prep_xids_cond);
     stage_manager.deinit();
   }
@@ -2642,6 +2677,7 @@ void MYSQL_BIN_LOG::init_pthread_objects()
   mysql_mutex_init(m_key_LOCK_xids, &LOCK_xids, MY_MUTEX_INIT_FAST);
   mysql_cond_init(m_key_update_cond, &update_cond, 0);
   my_atomic_rwlock_init(&m_prep_xids_lock);
+  my_atomic_rwlock_init(&m_logical_clock_lock);
   mysql_cond_init(m_key_prep_xids_cond, &m_prep_xids_cond, NULL);
   stage_manager.init(
 #ifdef HAVE_PSI_INTERFACE
@@ -3478,7 +3514,7 @@ bool MYSQL_BIN_LOG::open_binlog(const char *log_name,
       goto err;
     bytes_written+= extra_description_event->data_written;
   }
-  if (flush_io_cache(&log_file) ||
+  if (flush_log_file() ||
       mysql_file_sync(log_file.file, MYF(MY_WME)))
     goto err;
   
@@ -5183,6 +5219,12 @@ int MYSQL_BIN_LOG::new_file_impl(bool need_lock_log, Format_description_log_even
   }
   mysql_mutex_unlock(&LOCK_xids);
 
+  /*
+    All groups of the old file are committed: the sequence numbers
+    of the new file start over.
+  */
+  m_logical_clock_offset= get_logical_clock();
+
   mysql_mutex_lock(&LOCK_index);
 
   if (DBUG_EVALUATE_IF("expire_logs_always", 0, 1)
@@ -5442,7 +5484,7 @@ bool MYSQL_BIN_LOG::flush_and_sync(const bool force)
 {
   mysql_mutex_assert_owner(&LOCK_log);
 
-  if (flush_io_cache(&log_file))
+  if (flush_log_file())
     return 1;
 
   std::pair<bool, bool> result= sync_binlog_file(force);
@@ -5864,6 +5906,234 @@ uint MYSQL_BIN_LOG::next_file_id()
   return ret;
 }
 
+
+Binlog_dump_ring::Binlog_dump_ring()
+  : m_buffer(NULL), m_size(0), m_start(0), m_end(0), m_published(0)
+{
+  m_log_name[0]= 0;
+}
+
+
+void Binlog_dump_ring::init()
+{
+  mysql_rwlock_init(key_rwlock_binlog_dump_ring, &m_lock);
+}
+
+
+void Binlog_dump_ring::cleanup()
+{
+  my_free(m_buffer);
+  m_buffer= NULL;
+  m_size= 0;
+  mysql_rwlock_destroy(&m_lock);
+}
+
+
+/**
+  Reallocate the ring. The ring is emptied, and a size of 0 disables it.
+
+  @retval false Success
+  @retval true  Out of memory, the ring is disabled
+*/
+
+bool Binlog_dump_ring::resize(ulong size)
+{
+  bool error= false;
+  mysql_rwlock_wrlock(&m_lock);
+  my_free(m_buffer);
+  m_buffer= NULL;
+  m_size= 0;
+  if (size && !(m_buffer= (uchar*) my_malloc(size, MYF(MY_WME))))
+    error= true;
+  else
+    m_size= size;
+  reset_to("", 0);
+  mysql_rwlock_unlock(&m_lock);
+  return error;
+}
+
+
+void Binlog_dump_ring::reset()
+{
+  mysql_rwlock_wrlock(&m_lock);
+  reset_to("", 0);
+  mysql_rwlock_unlock(&m_lock);
+}
+
+
+void Binlog_dump_ring::reset_to(const char *log_name, my_off_t pos)
+{
+  strmake(m_log_name, log_name, sizeof(m_log_name) - 1);
+  m_start= m_end= m_published= pos;
+}
+
+
+void Binlog_dump_ring::copy_in(my_off_t pos, const uchar *buf, size_t length)
+{
+  size_t offset= (size_t) (pos % m_size);
+  size_t first= min<size_t>(length, m_size - offset);
+  memcpy(m_buffer + offset, buf, first);
+  memcpy(m_buffer, buf + first, length - first);
+}
+
+
+void Binlog_dump_ring::copy_out(my_off_t pos, uchar *to, size_t length) const
+{
+  size_t offset= (size_t) (pos % m_size);
+  size_t first= min<size_t>(length, m_size - offset);
+  memcpy(to, m_buffer + offset, first);
+  memcpy(to + first, m_buffer, length - first);
+}
+
+
+/**
+  Copy bytes that are about to be written at position @c pos of the log
+  file @c log_name into the ring.
+
+  The same bytes may be appended more than once (for example from the
+  transaction cache and again when the log file is flushed), only the
+  part that extends the ring is copied.
+*/
+
+void Binlog_dump_ring::append(const char *log_name, my_off_t pos,
+                              const uchar *buf, size_t length)
+{
+  mysql_rwlock_wrlock(&m_lock);
+  if (m_size == 0)
+    goto end;
+
+  if (pos < m_published || pos > m_end || strcmp(m_log_name, log_name))
+    reset_to(log_name, pos);
+
+  if (pos + length > m_end)
+  {
+    size_t skip= (size_t) (m_end - pos);
+    buf+= skip;
+    length-= skip;
+    m_end+= length;
+    if (length > m_size)
+    {
+      buf+= length - m_size;
+      length= m_size;
+    }
+    copy_in(m_end - length, buf, length);
+    if (m_end - m_start > m_size)
+      m_start= m_end - m_size;
+  }
+
+end:
+  mysql_rwlock_unlock(&m_lock);
+}
+
+
+/**
+  Make the ring content up to @c end_pos visible to the dump threads,
+  once it has been flushed to the log file.
+*/
+
+void Binlog_dump_ring::publish(const char *log_name, my_off_t end_pos)
+{
+  mysql_rwlock_wrlock(&m_lock);
+  if (m_size == 0 || strcmp(m_log_name, log_name))
+    goto end;
+
+  if (end_pos < m_published)
+    reset_to(log_name, end_pos);
+  else
+    m_published= min(end_pos, m_end);
+
+end:
+  mysql_rwlock_unlock(&m_lock);
+}
+
+
+/**
+  Append the event that starts at position @c pos of the log file
+  @c log_name to @c packet, if the ring has all of it.
+
+  The event is not checksum verified: the ring holds the bytes exactly
+  as this server wrote them.
+
+  @retval true  The event was appended to the packet
+  @retval false The event is not in the ring, read it from the file
+*/
+
+bool Binlog_dump_ring::read_event(const char *log_name, my_off_t pos,
+                                  String *packet, ulong max_event_len)
+{
+  bool found= false;
+  mysql_rwlock_rdlock(&m_lock);
+  if (m_size != 0 && pos >= m_start &&
+      pos + LOG_EVENT_MINIMAL_HEADER_LEN <= m_published &&
+      !strcmp(m_log_name, log_name))
+  {
+    uchar header[LOG_EVENT_MINIMAL_HEADER_LEN];
+    copy_out(pos, header, sizeof(header));
+    ulong event_len= uint4korr(header + EVENT_LEN_OFFSET);
+    uint32 length= packet->length();
+
+    if (event_len >= LOG_EVENT_MINIMAL_HEADER_LEN &&
+        event_len <= max_event_len &&
+        pos + event_len <= m_published &&
+        !packet->reserve(event_len))
+    {
+      copy_out(pos, (uchar*) packet->ptr() + length, event_len);
+      packet->length(length + event_len);
+      found= true;
+    }
+  }
+  mysql_rwlock_unlock(&m_lock);
+  return found;
+}
+
+
+/**
+  Write to the binary log file, copying the bytes to the binlog dump
+  ring as well.
+*/
+
+int MYSQL_BIN_LOG::write_log_file(const uchar *buf, size_t length)
+{
+  bool use_ring= (opt_binlog_dump_ring_size && !is_relay_log);
+
+  if (use_ring)
+    binlog_dump_ring.append(log_file_name, my_b_tell(&log_file), buf, length);
+  if (my_b_write(&log_file, buf, length))
+  {
+    if (use_ring)
+      binlog_dump_ring.reset();
+    return 1;
+  }
+  return 0;
+}
+
+
+/**
+  Flush the binary log file. What is still in the file cache is copied
+  to the binlog dump ring first, and the ring content is handed out to
+  the dump threads once the flush succeeded.
+*/
+
+int MYSQL_BIN_LOG::flush_log_file()
+{
+  bool use_ring= (opt_binlog_dump_ring_size && !is_relay_log &&
+                  log_file.type == WRITE_CACHE);
+
+  if (use_ring)
+    binlog_dump_ring.append(log_file_name, log_file.pos_in_file,
+                            log_file.write_buffer,
+                            log_file.write_pos - log_file.write_buffer);
+  if (flush_io_cache(&log_file))
+  {
+    if (use_ring)
+      binlog_dump_ring.reset();
+    return 1;
+  }
+  if (use_ring)
+    binlog_dump_ring.publish(log_file_name, my_b_tell(&log_file));
+  return 0;
+}
+
 /*
   Write the contents of a cache to the binary log.
 
@@ -5962,7 +6232,7 @@ int MYSQL_BIN_LOG::do_write_cache(THD *thd, IO_CACHE *cache)
       }
 
       /* write the first half of the split header */
-      if (my_b_write(&log_file, header, carry))
+      if (write_log_file(header, carry))
         DBUG_RETURN(ER_ERROR_ON_WRITE);
       thd->binlog_bytes_written+= carry;
 
@@ -6006,12 +6276,12 @@ int MYSQL_BIN_LOG::do_write_cache(THD *thd, IO_CACHE *cache)
 
         crc= my_checksum(crc, cache->read_pos, length); 
         remains -= length;
-        if (my_b_write(&log_file, cache->read_pos, length))
+        if (write_log_file(cache->read_pos, length))
           DBUG_RETURN(ER_ERROR_ON_WRITE);
         if (remains == 0)
         {
           int4store(buf, crc);
-          if (my_b_write(&log_file, buf, BINLOG_CHECKSUM_LEN))
+          if (write_log_file(buf, BINLOG_CHECKSUM_LEN))
             DBUG_RETURN(ER_ERROR_ON_WRITE);
           crc= crc_0;
         }
@@ -6037,8 +6307,8 @@ int MYSQL_BIN_LOG::do_write_cache(THD *thd, IO_CACHE *cache)
             int4store(buf, crc);
             remains -= hdr_offs;
             DBUG_ASSERT(remains == 0);
-            if (my_b_write(&log_file, cache->read_pos, hdr_offs) ||
-                my_b_write(&log_file, buf, BINLOG_CHECKSUM_LEN))
+            if (write_log_file(cache->read_pos, hdr_offs) ||
+                write_log_file(buf, BINLOG_CHECKSUM_LEN))
               DBUG_RETURN(ER_ERROR_ON_WRITE);
             crc= crc_0;
           }
@@ -6071,13 +6341,13 @@ int MYSQL_BIN_LOG::do_write_cache(THD *thd, IO_CACHE *cache)
                                        length, &crc);
             DBUG_EXECUTE_IF("fail_binlog_write_1",
                             errno= 28; DBUG_RETURN(ER_ERROR_ON_WRITE););
-            if (my_b_write(&log_file, ev, 
+            if (write_log_file(ev, 
                            remains == 0 ? event_len : length - hdr_offs))
               DBUG_RETURN(ER_ERROR_ON_WRITE);
             if (remains == 0)
             {
               int4store(buf, crc);
-              if (my_b_write(&log_file, buf, BINLOG_CHECKSUM_LEN))
+              if (write_log_file(buf, BINLOG_CHECKSUM_LEN))
                 DBUG_RETURN(ER_ERROR_ON_WRITE);
               crc= crc_0; // crc is complete
             }
@@ -6106,7 +6376,7 @@ int MYSQL_BIN_LOG::do_write_cache(THD *thd, IO_CACHE *cache)
     {
 /*      DBUG_EXECUTE_IF("fail_binlog_write_1",
         errno= 28; DBUG_RETURN(ER_ERROR_ON_WRITE);); */
-      if (my_b_write(&log_file, cache->read_pos, length))
+      if (write_log_file(cache->read_pos, length))
         DBUG_RETURN(ER_ERROR_ON_WRITE);
       thd->binlog_bytes_written+= length;
     }
@@ -6426,6 +6696,9 @@ void MYSQL_BIN_LOG::close(uint exiting, bool need_lock_log,
 
     /* this will cleanup IO_CACHE, sync and close the file */
     MYSQL_LOG::close(exiting);
+
+    if (!is_relay_log)
+      binlog_dump_ring.reset();
   }
 
   /*
@@ -6872,6 +7145,11 @@ TC_LOG::enum_result MYSQL_BIN_LOG::commit(THD *thd, bool all)
       binlog_prot_acquired= true;
     }
 
+    /*
+      All locks of the transaction are held at this point: any group
+      flushed later cannot conflict with it.
+    */
+    cache_mngr->last_committed= get_logical_clock();
     rc= ordered_commit(thd, all);
 
     if (binlog_prot_acquired)
@@ -7185,7 +7463,7 @@ MYSQL_BIN_LOG::change_stage(THD *thd,
 int
 MYSQL_BIN_LOG::flush_cache_to_file(my_off_t *end_pos_var)
 {
-  if (flush_io_cache(&log_file))
+  if (flush_log_file())
   {
     THD *thd= current_thd;
     thd->commit_error= THD::CE_FLUSH_ERROR;
@@ -7494,6 +7772,21 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit)
     anything more since it is possible that a thread entered and
     appointed itself leader for the flush phase.
   */
+  /*
+    A slave Worker preserving the commit order waits for the preceding
+    groups to enter the flush stage.
+  */
+#ifdef HAVE_REPLICATION
+  Commit_order_manager *commit_order_mngr= get_commit_order_manager(thd);
+  if (commit_order_mngr &&
+      commit_order_mngr->wait_for_its_turn(
+        static_cast<Slave_worker*>(thd->rli_slave)))
+  {
+    thd->commit_error= THD::CE_COMMIT_ERROR;
+    DBUG_RETURN(thd->commit_error);
+  }
+#endif
+
   DEBUG_SYNC(thd, "waiting_to_enter_flush_stage");
   if (change_stage(thd, Stage_manager::FLUSH_STAGE, thd, NULL, &LOCK_log))
   {
@@ -357,6 +357,16 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
     return result;
   }
 
+  /*
+    Logical clock of the binary log, see Gtid_log_event::last_committed.
+    m_logical_clock is stepped under LOCK_log each time a group is
+    flushed; m_logical_clock_offset is its value at the last rotation
+    so that the sequence numbers start from 1 in every binary log file.
+  */
+  my_atomic_rwlock_t m_logical_clock_lock;
+  volatile int64 m_logical_clock;
+  int64 m_logical_clock_offset;
+
   inline uint get_sync_period()
   {
     return *sync_period_ptr;
@@ -379,6 +389,39 @@ public:
   using MYSQL_LOG::generate_name;
   using MYSQL_LOG::is_open;
 
+  /**
+    Read the logical clock, that is the sequence number of the last
+    group flushed to the binary log.  A committing transaction stores
+    it as its commit parent.
+  */
+  int64 get_logical_clock()
+  {
+    my_atomic_rwlock_rdlock(&m_logical_clock_lock);
+    int64 result= my_atomic_load64(&m_logical_clock);
+    my_atomic_rwlock_rdunlock(&m_logical_clock_lock);
+    return result;
+  }
+
+  /**
+    Step the logical clock for a group being flushed and compute its
+    timestamps relative to the current binary log file.  Must be
+    called with LOCK_log held.
+
+    @param[in,out] last_committed  commit parent read at commit time,
+                                   made relative to the current file
+    @param[out]    sequence_number sequence number of the group
+  */
+  void step_logical_clock(int64 *last_committed, int64 *sequence_number)
+  {
+    mysql_mutex_assert_owner(&LOCK_log);
+    my_atomic_rwlock_wrlock(&m_logical_clock_lock);
+    int64 clock= my_atomic_add64(&m_logical_clock, 1) + 1;
+    my_atomic_rwlock_wrunlock(&m_logical_clock_lock);
+    *sequence_number= clock - m_logical_clock_offset;
+    *last_committed= *last_committed > m_logical_clock_offset ?
+      *last_committed - m_logical_clock_offset : 0;
+  }
+
   /* This is relay log */
   bool is_relay_log;
   ulong signal_cnt;  // update of the counter is checked by heartbeat
@@ -513,6 +556,8 @@ private:
                     mysql_mutex_t *enter);
   std::pair<int,my_off_t> flush_thread_caches(THD *thd);
   int flush_cache_to_file(my_off_t *flush_end_pos);
+  int write_log_file(const uchar *buf, size_t length);
+  int flush_log_file();
   int finish_commit(THD *thd);
   std::pair<bool, bool> sync_binlog_file(bool force);
   void process_commit_stage_queue(THD *thd, THD *queue);
@@ -703,6 +748,55 @@ typedef struct st_load_file_info
 
 extern MYSQL_PLUGIN_IMPORT MYSQL_BIN_LOG mysql_bin_log;
 
+/**
+  Shared in-memory copy of the most recently written bytes of the
+  active binary log.
+
+  The ring is filled by the binary log while it writes transaction
+  caches and flushes the log file, and it is read by the binlog dump
+  threads. A dump thread that asks for an event which is still in the
+  ring gets it from memory; otherwise it reads the event from the log
+  file as usual.
+
+  The ring holds one contiguous range of one log file. A write that
+  does not continue that range (a new file, or bytes that bypassed the
+  ring) restarts the ring at the new position. Only bytes that have
+  already been flushed to the log file are handed out to readers.
+*/
+class Binlog_dump_ring
+{
+public:
+  Binlog_dump_ring();
+
+  void init();
+  void cleanup();
+  bool resize(ulong size);
+  void reset();
+
+  void append(const char *log_name, my_off_t pos, const uchar *buf,
+              size_t length);
+  void publish(const char *log_name, my_off_t end_pos);
+  bool read_event(const char *log_name, my_off_t pos, String *packet,
+                  ulong max_event_len);
+
+private:
+  void reset_to(const char *log_name, my_off_t pos);
+  void copy_in(my_off_t pos, const uchar *buf, size_t length);
+  void copy_out(my_off_t pos, uchar *to, size_t length) const;
+
+  mysql_rwlock_t m_lock;
+  uchar *m_buffer;
+  ulong m_size;
+  char m_log_name[FN_REFLEN];
+  /* File range [m_start, m_end) is in the ring, m_published of it on disk */
+  my_off_t m_start;
+  my_off_t m_end;
+  my_off_t m_published;
+};
+
+extern Binlog_dump_ring binlog_dump_ring;
+extern ulong opt_binlog_dump_ring_size;
+
 bool trans_has_updated_trans_table(const THD* thd);
 bool stmt_has_updated_trans_table(Ha_trx_info* ha_list);
 bool ending_trans(THD* thd, const bool all);
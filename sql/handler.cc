@@ -5081,7 +5081,8 @@ void handler::get_dynamic_partition_info(PARTITION_STATS *stat_info,
   return;
 }
 
-// Updates the global table stats with the TABLE this handler represents.
+// Updates the table stats with the TABLE this handler represents.  They are
+// kept in the userstat shard of the thread until global_table_stats is read.
 void handler::update_global_table_stats()
 {
   if (!rows_read && !rows_changed)
@@ -5090,14 +5091,16 @@ void handler::update_global_table_stats()
   if (!table->s || !table->s->table_cache_key.str || !table->s->table_name.str)
     return;
 
+  THD *thd= ha_thd();
+  USERSTAT_SHARD *shard= get_userstat_shard(thd->thread_id);
   TABLE_STATS* table_stats;
   char key[NAME_LEN * 2 + 2];
   // [db] + '.' + [table]
   sprintf(key, "%s.%s", table->s->table_cache_key.str, table->s->table_name.str);
 
-  mysql_mutex_lock(&LOCK_global_table_stats);
-  // Gets the global table stats, creating one if necessary.
-  if (!(table_stats = (TABLE_STATS *) my_hash_search(&global_table_stats,
+  mysql_mutex_lock(&shard->lock);
+  // Gets the shard table stats, creating one if necessary.
+  if (!(table_stats = (TABLE_STATS *) my_hash_search(&shard->table_stats,
                                                      (uchar*)key,
                                                      strlen(key))))
   {
@@ -5115,7 +5118,7 @@ void handler::update_global_table_stats()
     table_stats->rows_changed_x_indexes= 0;
     table_stats->engine_type=            (int) ht->db_type;
 
-    if (my_hash_insert(&global_table_stats, (uchar *) table_stats))
+    if (my_hash_insert(&shard->table_stats, (uchar *) table_stats))
     {
       // Out of memory.
       sql_print_error("Inserting table stats failed.");
@@ -5123,18 +5126,20 @@ void handler::update_global_table_stats()
       goto end;
     }
   }
-  // Updates the global table stats.
+  // Updates the shard table stats.
   table_stats->rows_read+=              rows_read;
   table_stats->rows_changed+=           rows_changed;
   table_stats->rows_changed_x_indexes+=
     rows_changed * (table->s->keys ? table->s->keys : 1);
-  ha_thd()->diff_total_read_rows+=   rows_read;
+  thd->diff_total_read_rows+=        rows_read;
   rows_read= rows_changed=              0;
 end:
-  mysql_mutex_unlock(&LOCK_global_table_stats);
+  mysql_mutex_unlock(&shard->lock);
 }
 
-// Updates the global index stats with this handler's accumulated index reads.
+// Updates the index stats with this handler's accumulated index reads.  They
+// are kept in the userstat shard of the thread until global_index_stats is
+// read.
 void handler::update_global_index_stats()
 {
   // table_cache_key is db_name + '\0' + table_name + '\0'.
@@ -5142,6 +5147,8 @@ void handler::update_global_index_stats()
       !table->s->table_name.str)
     return;
 
+  USERSTAT_SHARD *shard= get_userstat_shard(ha_thd()->thread_id);
+
   for (uint x = 0; x < table->s->keys; ++x)
   {
     if (index_rows_read[x])
@@ -5157,9 +5164,9 @@ void handler::update_global_index_stats()
       sprintf(key, "%s.%s.%s",  table->s->table_cache_key.str,
               table->s->table_name.str, key_info->name);
 
-      mysql_mutex_lock(&LOCK_global_index_stats);
-      // Gets the global index stats, creating one if necessary.
-      if (!(index_stats = (INDEX_STATS *) my_hash_search(&global_index_stats,
+      mysql_mutex_lock(&shard->lock);
+      // Gets the shard index stats, creating one if necessary.
+      if (!(index_stats = (INDEX_STATS *) my_hash_search(&shard->index_stats,
                                                          (uchar *) key,
                                                          strlen(key))))
       {
@@ -5174,7 +5181,7 @@ void handler::update_global_index_stats()
         index_stats->index_len= strlen(index_stats->index);
         index_stats->rows_read= 0;
 
-        if (my_hash_insert(&global_index_stats, (uchar *) index_stats))
+        if (my_hash_insert(&shard->index_stats, (uchar *) index_stats))
         {
           // Out of memory.
           sql_print_error("Inserting index stats failed.");
@@ -5182,11 +5189,11 @@ void handler::update_global_index_stats()
           goto end;
         }
       }
-      // Updates the global index stats.
+      // Updates the shard index stats.
       index_stats->rows_read+= index_rows_read[x];
       index_rows_read[x]=      0;
   end:
-      mysql_mutex_unlock(&LOCK_global_index_stats);
+      mysql_mutex_unlock(&shard->lock);
     }
   }
 }
@@ -6701,6 +6708,7 @@ int DsMrr_impl::dsmrr_fill_buffer()
   
   my_qsort2(rowids_buf, n_rowids, elem_size, (qsort2_cmp)rowid_cmp,
             (void*)h);
+  h->mrr_prefetch_rowids(rowids_buf, n_rowids, elem_size);
   rowids_buf_last= rowids_buf_cur;
   rowids_buf_cur=  rowids_buf;
   DBUG_RETURN(0);
@@ -633,12 +633,14 @@ enum enum_schema_tables
   SCH_PLUGINS,
   SCH_PROCESSLIST,
   SCH_PROFILES,
+  SCH_QUERY_CACHE_SHARDS,
   SCH_REFERENTIAL_CONSTRAINTS,
   SCH_PROCEDURES,
   SCH_SCHEMATA,
   SCH_SCHEMA_PRIVILEGES,
   SCH_SESSION_STATUS,
   SCH_SESSION_VARIABLES,
+  SCH_SLAVE_WORKER_STATS,
   SCH_STATISTICS,
   SCH_STATUS,
   SCH_TABLES,
@@ -648,6 +650,7 @@ enum enum_schema_tables
   SCH_TABLE_PRIVILEGES,
   SCH_TABLE_STATS,
   SCH_TEMPORARY_TABLES,
+  SCH_THREAD_POOL_GROUPS,
   SCH_THREAD_STATS,
   SCH_TRIGGERS,
   SCH_USER_PRIVILEGES,
@@ -2194,6 +2197,20 @@ public:
                                     uint n_ranges, uint mode,
                                     HANDLER_BUFFER *buf);
   virtual int multi_range_read_next(char **range_info);
+  /**
+    Announce the rowids that DS-MRR is about to read with rnd_pos().
+
+    Called by DsMrr_impl after a batch of rowids has been collected and
+    sorted, so that engines can fetch the rows with one batched lookup
+    instead of a point lookup per rnd_pos() call. The rows are requested
+    in buffer order afterwards, possibly skipping some of them.
+
+    @param rowids     First rowid in the buffer
+    @param n_rowids   Number of rowids in the buffer
+    @param elem_size  Distance in bytes between two consecutive rowids
+  */
+  virtual void mrr_prefetch_rowids(const uchar *rowids, uint n_rowids,
+                                   uint elem_size) {}
 
 
   virtual const key_map *keys_to_use_for_scanning() { return &key_map_empty; }
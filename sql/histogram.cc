@@ -0,0 +1,1860 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/*
+  Column value histograms
+
+  ANALYZE TABLE ... UPDATE HISTOGRAM ON ... reads the table once, keeps a
+  reservoir sample of the rows and builds a histogram of the values of
+  each column from it: a singleton histogram with one bucket per distinct
+  value when the column has no more distinct values than buckets, an
+  equi-height histogram otherwise. The histograms are stored in
+  mysql.column_stats and cached in memory, where the optimizer looks them
+  up to estimate how many rows satisfy the conditions on non-indexed
+  columns.
+
+  Values are kept as sort keys (Field::make_sort_key), so that comparing
+  them is a memcmp() whatever the type of the column is. Long strings are
+  cut to a prefix.
+*/
+
+#include "histogram.h"
+#include "sql_class.h"                          // THD
+#include "sql_base.h"                           // open_and_lock_tables
+#include "records.h"                            // init_read_record
+#include "lock.h"                               // MYSQL_LOCK_IGNORE_TIMEOUT
+#include "transaction.h"                        // trans_commit_stmt
+#include "key.h"                                // key_copy
+#include "item_cmpfunc.h"                       // Item_equal
+#include "opt_trace.h"                          // Opt_trace_object
+#include "log.h"                                // sql_print_error
+#include "sql_alter.h"                          // Alter_info
+
+using std::min;
+using std::max;
+
+/** Version of the format of mysql.column_stats.histogram */
+#define HISTOGRAM_FORMAT_VERSION 1
+
+/**
+  Size of the header of mysql.column_stats.histogram: the format version,
+  the type and the character set of the column, the length of the values
+  and the number of buckets.
+*/
+#define HISTOGRAM_HEADER_SIZE 10
+
+/**
+  Size of the fixed part of a bucket: the cumulative frequency and the
+  number of distinct values. The lowest and the highest values follow.
+*/
+#define HISTOGRAM_BUCKET_HEADER_SIZE 16
+
+/** Longest prefix of a string sort key kept in a histogram */
+#define HISTOGRAM_MAX_VALUE_LENGTH 64
+
+/** Most rows sampled by ANALYZE TABLE ... UPDATE HISTOGRAM */
+#define HISTOGRAM_MAX_SAMPLE_ROWS 100000
+
+/** Memory for the values sampled by ANALYZE TABLE ... UPDATE HISTOGRAM */
+#define HISTOGRAM_SAMPLE_MEMORY (16 * 1024 * 1024)
+
+/** Values of mysql.column_stats.histogram_type */
+enum enum_histogram_type
+{
+  HISTOGRAM_SINGLETON= 1,
+  HISTOGRAM_EQUI_HEIGHT= 2
+};
+
+static const char *histogram_type_names[]= { "", "singleton", "equi-height" };
+
+/** Columns of mysql.column_stats */
+enum enum_column_stats_field
+{
+  COLUMN_STATS_DATABASE_NAME= 0,
+  COLUMN_STATS_TABLE_NAME,
+  COLUMN_STATS_COLUMN_NAME,
+  COLUMN_STATS_LAST_UPDATE,
+  COLUMN_STATS_HISTOGRAM_TYPE,
+  COLUMN_STATS_BUCKETS,
+  COLUMN_STATS_SAMPLED_ROWS,
+  COLUMN_STATS_NULL_FRACTION,
+  COLUMN_STATS_HISTOGRAM,
+  COLUMN_STATS_FIELD_COUNT
+};
+
+static const LEX_STRING column_stats_db= { C_STRING_WITH_LEN("mysql") };
+static const LEX_STRING column_stats_name=
+  { C_STRING_WITH_LEN("column_stats") };
+
+
+/**
+  A cached histogram.
+
+  The buckets are kept in their stored format. Every bucket is the
+  cumulative frequency of the values up to its highest value (float8), the
+  number of distinct values in it (int8), then its lowest and its highest
+  value. Frequencies are fractions of all the sampled rows, NULLs
+  included, so the cumulative frequency of the last bucket is the fraction
+  of the rows that are not NULL.
+*/
+
+struct Column_histogram
+{
+  /** "database\0table\0column", the key in histogram_cache */
+  char *key;
+  uint key_length;
+  enum_histogram_type type;
+  ha_rows sampled_rows;
+  double null_fraction;
+  /** Field::real_type() of the column when the histogram was built */
+  uint field_type;
+  /** Character set number of the column when the histogram was built */
+  uint charset_number;
+  /** Length of the sort keys of the values */
+  uint value_length;
+  uint buckets;
+  const uchar *bucket_data;
+
+  const uchar *bucket(uint i) const
+  {
+    return bucket_data +
+           i * (HISTOGRAM_BUCKET_HEADER_SIZE + 2 * value_length);
+  }
+
+  double cumulative_frequency(uint i) const
+  {
+    double value;
+    float8get(value, bucket(i));
+    return value;
+  }
+
+  double frequency(uint i) const
+  {
+    return cumulative_frequency(i) - (i ? cumulative_frequency(i - 1) : 0.0);
+  }
+
+  ulonglong distinct_values(uint i) const
+  {
+    return uint8korr(bucket(i) + 8);
+  }
+
+  const uchar *lowest_value(uint i) const
+  {
+    return bucket(i) + HISTOGRAM_BUCKET_HEADER_SIZE;
+  }
+
+  const uchar *highest_value(uint i) const
+  {
+    return lowest_value(i) + value_length;
+  }
+
+  double not_null_fraction() const
+  {
+    return buckets ? cumulative_frequency(buckets - 1) : 0.0;
+  }
+
+  /** The histogram in the stored format */
+  const uchar *stored_data() const
+  {
+    return bucket_data - HISTOGRAM_HEADER_SIZE;
+  }
+
+  size_t stored_length() const
+  {
+    return HISTOGRAM_HEADER_SIZE +
+           (size_t) buckets * (HISTOGRAM_BUCKET_HEADER_SIZE + 2 * value_length);
+  }
+
+  int compare(const uchar *a, const uchar *b) const
+  {
+    return memcmp(a, b, value_length);
+  }
+
+  uint find_bucket(const uchar *value) const;
+  double equal_to(const uchar *value) const;
+  double less_than(const uchar *value, bool inclusive) const;
+};
+
+
+/**
+  Finds the first bucket whose highest value is not less than a value.
+
+  @return the bucket, or the number of buckets if all the values are less
+*/
+
+uint Column_histogram::find_bucket(const uchar *value) const
+{
+  uint low= 0, high= buckets;
+  while (low < high)
+  {
+    uint middle= (low + high) / 2;
+    if (compare(highest_value(middle), value) < 0)
+      low= middle + 1;
+    else
+      high= middle;
+  }
+  return low;
+}
+
+
+/** Fraction of the rows equal to a value */
+
+double Column_histogram::equal_to(const uchar *value) const
+{
+  uint i= find_bucket(value);
+  if (i == buckets || compare(value, lowest_value(i)) < 0)
+    return 0.0;
+  return frequency(i) / distinct_values(i);
+}
+
+
+/**
+  Position of a sort key in the range of the 64-bit unsigned integers,
+  used to interpolate inside a bucket.
+*/
+
+static double sort_key_position(const uchar *key, uint length)
+{
+  ulonglong position= 0;
+  for (uint i= 0; i < 8; i++)
+    position= (position << 8) | (i < length ? key[i] : 0);
+  return ulonglong2double(position);
+}
+
+
+/** Fraction of the rows less than, or less than or equal to, a value */
+
+double Column_histogram::less_than(const uchar *value, bool inclusive) const
+{
+  uint i= find_bucket(value);
+  double below= i ? cumulative_frequency(i - 1) : 0.0;
+  if (i == buckets || compare(value, lowest_value(i)) < 0)
+    return below;
+
+  /*
+    The value is inside the bucket. Assume the distinct values of the
+    bucket are spread evenly between its lowest and highest values.
+  */
+  double value_frequency= frequency(i) / distinct_values(i);
+  double others= frequency(i) - value_frequency;
+  if (compare(value, highest_value(i)) == 0)
+    below+= others;
+  else
+  {
+    double low= sort_key_position(lowest_value(i), value_length);
+    double high= sort_key_position(highest_value(i), value_length);
+    double pos= sort_key_position(value, value_length);
+    below+= (high > low) ? others * (pos - low) / (high - low) : others / 2;
+  }
+  return inclusive ? below + value_frequency : below;
+}
+
+
+/*
+  The histogram cache. Readers look histograms up under a read lock on
+  LOCK_histograms, ANALYZE TABLE replaces them under a write lock.
+  histograms_cached lets queries skip the lookups when there are no
+  histograms at all.
+*/
+
+static HASH histogram_cache;
+static mysql_rwlock_t LOCK_histograms;
+static volatile ulong histograms_cached= 0;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_rwlock_key key_rwlock_LOCK_histograms;
+
+static PSI_rwlock_info all_histogram_rwlocks[]=
+{
+  { &key_rwlock_LOCK_histograms, "LOCK_histograms", PSI_FLAG_GLOBAL}
+};
+
+static void init_histogram_psi_keys(void)
+{
+  const char* category= "sql";
+  int count;
+
+  count= array_elements(all_histogram_rwlocks);
+  mysql_rwlock_register(category, all_histogram_rwlocks, count);
+}
+#endif /* HAVE_PSI_INTERFACE */
+
+
+static uchar *histogram_cache_get_key(Column_histogram *histogram,
+                                      size_t *length,
+                                      my_bool not_used MY_ATTRIBUTE((unused)))
+{
+  *length= histogram->key_length;
+  return (uchar*) histogram->key;
+}
+
+
+static void histogram_cache_free(void *histogram)
+{
+  my_free(histogram);
+}
+
+
+/**
+  Builds the key of a column in histogram_cache.
+
+  @return the length of the key
+*/
+
+static uint histogram_key(char *buff, const char *db, const char *table_name,
+                          const char *column)
+{
+  char *pos= strmake(buff, db, NAME_LEN) + 1;
+  pos= strmake(pos, table_name, NAME_LEN) + 1;
+  pos= strmake(pos, column, NAME_LEN);
+  return (uint) (pos - buff);
+}
+
+
+/**
+  Creates a histogram from its stored format.
+
+  @return the histogram, or NULL if the stored histogram is malformed or
+          if out of memory
+*/
+
+static Column_histogram *new_histogram(const char *db,
+                                       const char *table_name,
+                                       const char *column,
+                                       enum_histogram_type type,
+                                       ha_rows sampled_rows,
+                                       double null_fraction,
+                                       const uchar *data, size_t length)
+{
+  char key[3 * (NAME_LEN + 1)];
+  uint key_length= histogram_key(key, db, table_name, column);
+
+  if (length < HISTOGRAM_HEADER_SIZE ||
+      data[0] != HISTOGRAM_FORMAT_VERSION ||
+      (type != HISTOGRAM_SINGLETON && type != HISTOGRAM_EQUI_HEIGHT))
+    return NULL;
+
+  uint value_length= uint2korr(data + 4);
+  uint buckets= uint4korr(data + 6);
+  if (length != HISTOGRAM_HEADER_SIZE +
+                (size_t) buckets *
+                (HISTOGRAM_BUCKET_HEADER_SIZE + 2 * value_length))
+    return NULL;
+
+  Column_histogram *histogram= (Column_histogram*)
+    my_malloc(sizeof(Column_histogram) + key_length + length, MYF(MY_WME));
+  if (!histogram)
+    return NULL;
+
+  histogram->key= (char*) (histogram + 1);
+  memcpy(histogram->key, key, key_length);
+  histogram->key_length= key_length;
+  uchar *copy= (uchar*) histogram->key + key_length;
+  memcpy(copy, data, length);
+
+  histogram->type= type;
+  histogram->sampled_rows= sampled_rows;
+  histogram->null_fraction= null_fraction;
+  histogram->field_type= data[1];
+  histogram->charset_number= uint2korr(data + 2);
+  histogram->value_length= value_length;
+  histogram->buckets= buckets;
+  histogram->bucket_data= copy + HISTOGRAM_HEADER_SIZE;
+  return histogram;
+}
+
+
+/**
+  Adds a histogram to the cache, replacing the previous histogram of the
+  column. LOCK_histograms must be write locked.
+
+  @retval false OK
+  @retval true  Out of memory, the histogram is freed
+*/
+
+static bool cache_histogram(Column_histogram *histogram)
+{
+  uchar *old= my_hash_search(&histogram_cache, (uchar*) histogram->key,
+                             histogram->key_length);
+  if (old)
+    my_hash_delete(&histogram_cache, old);
+  if (my_hash_insert(&histogram_cache, (uchar*) histogram))
+  {
+    my_free(histogram);
+    histograms_cached= histogram_cache.records;
+    return true;
+  }
+  histograms_cached= histogram_cache.records;
+  return false;
+}
+
+
+/**
+  Removes the histogram of a column from the cache. LOCK_histograms must
+  be write locked.
+*/
+
+static void uncache_histogram(const char *key, uint key_length)
+{
+  uchar *old= my_hash_search(&histogram_cache, (const uchar*) key,
+                             key_length);
+  if (old)
+    my_hash_delete(&histogram_cache, old);
+  histograms_cached= histogram_cache.records;
+}
+
+
+/**
+  Checks that an open mysql.column_stats has the expected columns.
+
+  @retval false OK
+  @retval true  Error, reported to the client
+*/
+
+static bool check_column_stats_table(TABLE *table)
+{
+  if (table->s->fields < COLUMN_STATS_FIELD_COUNT)
+  {
+    my_error(ER_COL_COUNT_DOESNT_MATCH_CORRUPTED_V2, MYF(0),
+             column_stats_db.str, column_stats_name.str,
+             COLUMN_STATS_FIELD_COUNT, table->s->fields);
+    return true;
+  }
+  return false;
+}
+
+
+/**
+  Loads all the histograms of mysql.column_stats into the cache. Histograms
+  that cannot be parsed are skipped.
+
+  @retval false OK
+  @retval true  Error
+*/
+
+static bool histograms_load(THD *thd, TABLE *table)
+{
+  READ_RECORD read_record_info;
+  char db_buff[NAME_LEN + 1], table_buff[NAME_LEN + 1];
+  char column_buff[NAME_LEN + 1];
+  String db(db_buff, sizeof(db_buff), system_charset_info);
+  String table_name(table_buff, sizeof(table_buff), system_charset_info);
+  String column(column_buff, sizeof(column_buff), system_charset_info);
+  String data;
+  bool error= false;
+  DBUG_ENTER("histograms_load");
+
+  if (check_column_stats_table(table))
+    DBUG_RETURN(true);
+
+  table->use_all_columns();
+  if (init_read_record(&read_record_info, thd, table, NULL, 1, 1, FALSE))
+    DBUG_RETURN(true);
+
+  while (!(read_record_info.read_record(&read_record_info)))
+  {
+    Field **field= table->field;
+    field[COLUMN_STATS_DATABASE_NAME]->val_str(&db);
+    field[COLUMN_STATS_TABLE_NAME]->val_str(&table_name);
+    field[COLUMN_STATS_COLUMN_NAME]->val_str(&column);
+    field[COLUMN_STATS_HISTOGRAM]->val_str(&data);
+
+    Column_histogram *histogram=
+      new_histogram(db.c_ptr_safe(), table_name.c_ptr_safe(),
+                    column.c_ptr_safe(),
+                    (enum_histogram_type)
+                    field[COLUMN_STATS_HISTOGRAM_TYPE]->val_int(),
+                    (ha_rows) field[COLUMN_STATS_SAMPLED_ROWS]->val_int(),
+                    field[COLUMN_STATS_NULL_FRACTION]->val_real(),
+                    (const uchar*) data.ptr(), data.length());
+    if (!histogram)
+    {
+      sql_print_warning("Skipping the malformed histogram of column "
+                        "'%s'.'%s'.'%s' in mysql.column_stats",
+                        db.c_ptr_safe(), table_name.c_ptr_safe(),
+                        column.c_ptr_safe());
+      continue;
+    }
+    if ((error= cache_histogram(histogram)))
+      break;
+  }
+
+  end_read_record(&read_record_info);
+  DBUG_RETURN(error);
+}
+
+
+bool histograms_init(bool dont_read_table)
+{
+  THD *thd;
+  TABLE_LIST tables;
+  DBUG_ENTER("histograms_init");
+
+#ifdef HAVE_PSI_INTERFACE
+  init_histogram_psi_keys();
+#endif
+
+  if (mysql_rwlock_init(key_rwlock_LOCK_histograms, &LOCK_histograms))
+    DBUG_RETURN(true);
+
+  if (my_hash_init(&histogram_cache, &my_charset_bin, 32, 0, 0,
+                   (my_hash_get_key) histogram_cache_get_key,
+                   histogram_cache_free, 0))
+    DBUG_RETURN(true);
+
+  if (dont_read_table)
+    DBUG_RETURN(false);
+
+  /*
+    To be able to run this from boot, we allocate a temporary THD
+  */
+  if (!(thd= new THD))
+    DBUG_RETURN(true);
+  thd->thread_stack= (char*) &thd;
+  thd->store_globals();
+
+  tables.init_one_table(column_stats_db.str, column_stats_db.length,
+                        column_stats_name.str, column_stats_name.length,
+                        column_stats_name.str, TL_READ);
+
+  /*
+    A data directory that has not been upgraded has no mysql.column_stats,
+    run without histograms then.
+  */
+  if (open_and_lock_tables(thd, &tables, FALSE, MYSQL_LOCK_IGNORE_TIMEOUT))
+  {
+    if (thd->get_stmt_da()->is_error() &&
+        thd->get_stmt_da()->sql_errno() != ER_NO_SUCH_TABLE)
+      sql_print_error("Can't open and lock mysql.column_stats: %s",
+                      thd->get_stmt_da()->message());
+  }
+  else
+  {
+    mysql_rwlock_wrlock(&LOCK_histograms);
+    if (histograms_load(thd, tables.table))
+    {
+      sql_print_error("Failed to load the column histograms from "
+                      "mysql.column_stats");
+      my_hash_reset(&histogram_cache);
+      histograms_cached= 0;
+    }
+    mysql_rwlock_unlock(&LOCK_histograms);
+  }
+  close_mysql_tables(thd);
+
+  delete thd;
+  /* Remember that we don't have a THD */
+  my_pthread_setspecific_ptr(THR_THD, 0);
+  DBUG_RETURN(false);
+}
+
+
+void histograms_free()
+{
+  DBUG_ENTER("histograms_free");
+  if (!my_hash_inited(&histogram_cache))
+    DBUG_VOID_RETURN;
+  histograms_cached= 0;
+  my_hash_free(&histogram_cache);
+  mysql_rwlock_destroy(&LOCK_histograms);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Length of the sort keys of the values of a column in its histogram.
+  Only string sort keys can be cut, the other types ignore the length
+  passed to Field::make_sort_key().
+*/
+
+static uint histogram_value_length(const Field *field)
+{
+  uint length= field->sort_length();
+  if ((field->real_type() == MYSQL_TYPE_STRING ||
+       field->real_type() == MYSQL_TYPE_VARCHAR) &&
+      length > HISTOGRAM_MAX_VALUE_LENGTH)
+    length= HISTOGRAM_MAX_VALUE_LENGTH;
+  return length;
+}
+
+
+/** Sends the metadata of the result set of the histogram statements */
+
+static bool send_histogram_result_metadata(THD *thd)
+{
+  List<Item> field_list;
+  Item *item;
+
+  field_list.push_back(item= new Item_empty_string("Table", NAME_CHAR_LEN*2));
+  item->maybe_null= 1;
+  field_list.push_back(item= new Item_empty_string("Op", 10));
+  item->maybe_null= 1;
+  field_list.push_back(item= new Item_empty_string("Msg_type", 10));
+  item->maybe_null= 1;
+  field_list.push_back(item= new Item_empty_string("Msg_text", 255));
+  item->maybe_null= 1;
+  return thd->protocol->send_result_set_metadata(&field_list,
+                                                 Protocol::SEND_NUM_ROWS |
+                                                 Protocol::SEND_EOF);
+}
+
+
+/** Sends a row of the result set of the histogram statements */
+
+static bool send_histogram_message(THD *thd, const char *table_name,
+                                   const char *msg_type,
+                                   const char *format, const char *column)
+{
+  Protocol *protocol= thd->protocol;
+  char msg[NAME_LEN + 128];
+
+  my_snprintf(msg, sizeof(msg), format, column);
+  protocol->prepare_for_resend();
+  protocol->store(table_name, system_charset_info);
+  protocol->store(STRING_WITH_LEN("histogram"), system_charset_info);
+  protocol->store(msg_type, system_charset_info);
+  protocol->store(msg, system_charset_info);
+  return protocol->write();
+}
+
+
+/** A column whose histogram is built by ANALYZE TABLE */
+
+struct Histogram_column
+{
+  Field *field;
+  /** Length of the sort keys of the values */
+  uint value_length;
+  /**
+    Offset of the column in a sampled row: a NULL flag byte followed by
+    the sort key of the value
+  */
+  uint offset;
+};
+
+
+/**
+  Reads a table and keeps a uniform random sample of its rows, as the NULL
+  flags and the sort keys of the values of the columns.
+
+  @param      thd          thread descriptor
+  @param      table        the table
+  @param      columns      the sampled columns
+  @param      count        number of sampled columns
+  @param      row_length   length of a sampled row
+  @param[out] sample       the sampled rows, to be freed with my_free()
+  @param[out] sample_rows  number of sampled rows
+
+  @retval false OK
+  @retval true  Error, reported to the client
+*/
+
+static bool sample_table(THD *thd, TABLE *table, Histogram_column *columns,
+                         uint count, uint row_length, uchar **sample,
+                         ha_rows *sample_rows)
+{
+  READ_RECORD read_record_info;
+  ha_rows capacity= HISTOGRAM_SAMPLE_MEMORY / row_length;
+  ha_rows rows= 0;
+  int error;
+  DBUG_ENTER("sample_table");
+
+  set_if_smaller(capacity, HISTOGRAM_MAX_SAMPLE_ROWS);
+  set_if_bigger(capacity, 1);
+
+  if (!(*sample= (uchar*) my_malloc((size_t) (capacity * row_length),
+                                    MYF(MY_WME))))
+    DBUG_RETURN(true);
+
+  bitmap_clear_all(table->read_set);
+  for (uint i= 0; i < count; i++)
+    bitmap_set_bit(table->read_set, columns[i].field->field_index);
+  table->file->column_bitmaps_signal();
+
+  if (init_read_record(&read_record_info, thd, table, NULL, 1, 1, FALSE))
+  {
+    my_free(*sample);
+    *sample= NULL;
+    DBUG_RETURN(true);
+  }
+
+  /* Reservoir sampling: row n replaces a random sampled row */
+  while (!(error= read_record_info.read_record(&read_record_info)))
+  {
+    ha_rows slot= rows++;
+    if (slot >= capacity &&
+        (slot= (ha_rows) (my_rnd(&thd->rand) * rows)) >= capacity)
+      continue;
+
+    uchar *pos= *sample + slot * row_length;
+    for (uint i= 0; i < count; i++)
+    {
+      Field *field= columns[i].field;
+      uchar *value= pos + columns[i].offset;
+      if ((value[0]= field->is_null()))
+        memset(value + 1, 0, columns[i].value_length);
+      else
+        field->make_sort_key(value + 1, columns[i].value_length);
+    }
+  }
+  end_read_record(&read_record_info);
+
+  if (error > 0)
+  {
+    my_free(*sample);
+    *sample= NULL;
+    DBUG_RETURN(true);
+  }
+
+  *sample_rows= min(rows, capacity);
+  DBUG_RETURN(false);
+}
+
+
+static int compare_sort_keys(const void *length, const void *a, const void *b)
+{
+  return memcmp(*(const uchar**) a, *(const uchar**) b,
+                *(const uint*) length);
+}
+
+
+/** Appends a bucket to a histogram in the stored format */
+
+static void append_bucket(String *data, double cumulative_frequency,
+                          ulonglong distinct_values, const uchar *lowest,
+                          const uchar *highest, uint value_length)
+{
+  char buff[HISTOGRAM_BUCKET_HEADER_SIZE];
+  float8store(buff, cumulative_frequency);
+  int8store(buff + 8, distinct_values);
+  data->append(buff, sizeof(buff));
+  data->append((const char*) lowest, value_length);
+  data->append((const char*) highest, value_length);
+}
+
+
+/**
+  Builds the histogram of a column from the sampled rows.
+
+  @param      column         the column
+  @param      sample         the sampled rows
+  @param      sample_rows    number of sampled rows
+  @param      row_length     length of a sampled row
+  @param      max_buckets    maximum number of buckets
+  @param[out] data           the histogram in the stored format
+  @param[out] type           the type of the histogram
+  @param[out] null_fraction  fraction of the sampled values that are NULL
+
+  @retval false OK
+  @retval true  Out of memory
+*/
+
+static bool build_histogram(const Histogram_column *column,
+                            const uchar *sample, ha_rows sample_rows,
+                            uint row_length, ulong max_buckets, String *data,
+                            enum_histogram_type *type, double *null_fraction)
+{
+  const uint length= column->value_length;
+  const uchar **values= (const uchar**)
+    my_malloc((size_t) max<ha_rows>(sample_rows, 1) * sizeof(uchar*),
+              MYF(MY_WME));
+  if (!values)
+    return true;
+
+  ha_rows not_null= 0;
+  for (ha_rows i= 0; i < sample_rows; i++)
+  {
+    const uchar *value= sample + i * row_length + column->offset;
+    if (!value[0])
+      values[not_null++]= value + 1;
+  }
+  my_qsort2(values, (size_t) not_null, sizeof(uchar*), compare_sort_keys,
+            &length);
+
+  ha_rows distinct= 0;
+  for (ha_rows i= 0; i < not_null; i++)
+    if (!i || memcmp(values[i], values[i - 1], length))
+      distinct++;
+
+  *type= distinct <= max_buckets ? HISTOGRAM_SINGLETON :
+                                   HISTOGRAM_EQUI_HEIGHT;
+  *null_fraction= sample_rows ?
+                  (double) (sample_rows - not_null) / sample_rows : 0.0;
+
+  char header[HISTOGRAM_HEADER_SIZE];
+  data->set_charset(&my_charset_bin);
+  data->length(0);
+  data->append(header, sizeof(header));
+
+  /*
+    A singleton histogram has a bucket per distinct value. An equi-height
+    histogram closes bucket k once it reaches k/max_buckets of the values,
+    the equal values always go to the same bucket.
+  */
+  uint buckets= 0;
+  ha_rows i= 0;
+  while (i < not_null)
+  {
+    const ha_rows first= i;
+    const double limit= (double) (buckets + 1) * not_null / max_buckets;
+    ha_rows last;
+    ulonglong bucket_distinct= 0;
+    do
+    {
+      last= i;
+      while (++i < not_null && !memcmp(values[i], values[last], length))
+      {}
+      bucket_distinct++;
+    } while (*type == HISTOGRAM_EQUI_HEIGHT && i < not_null && i < limit);
+
+    append_bucket(data, (double) i / sample_rows, bucket_distinct,
+                  values[first], values[last], length);
+    buckets++;
+  }
+  my_free(values);
+
+  uchar *pos= (uchar*) data->ptr();
+  pos[0]= HISTOGRAM_FORMAT_VERSION;
+  pos[1]= (uchar) column->field->real_type();
+  int2store(pos + 2, column->field->charset()->number);
+  int2store(pos + 4, length);
+  int4store(pos + 6, buckets);
+  return false;
+}
+
+
+/**
+  Stores the key of a histogram in a mysql.column_stats record and reads
+  the current row of the key into record[1].
+
+  @retval 0                    the row exists
+  @retval HA_ERR_KEY_NOT_FOUND the row does not exist
+  @retval other                error
+*/
+
+static int find_column_stats_row(TABLE *table, const char *db,
+                                 const char *table_name, const char *column)
+{
+  uchar key[MAX_KEY_LENGTH];
+  Field **field= table->field;
+
+  table->use_all_columns();
+  empty_record(table);
+  field[COLUMN_STATS_DATABASE_NAME]->store(db, strlen(db),
+                                           system_charset_info);
+  field[COLUMN_STATS_TABLE_NAME]->store(table_name, strlen(table_name),
+                                        system_charset_info);
+  field[COLUMN_STATS_COLUMN_NAME]->store(column, strlen(column),
+                                         system_charset_info);
+  key_copy(key, table->record[0], table->key_info,
+           table->key_info->key_length);
+
+  int error= table->file->ha_index_read_idx_map(table->record[1], 0, key,
+                                                HA_WHOLE_KEY,
+                                                HA_READ_KEY_EXACT);
+  if (error == HA_ERR_END_OF_FILE)
+    error= HA_ERR_KEY_NOT_FOUND;
+  return error;
+}
+
+
+/**
+  Stores a histogram in mysql.column_stats.
+
+  @retval false OK
+  @retval true  Error, reported to the client
+*/
+
+static bool store_histogram(THD *thd, TABLE *table, const char *db,
+                            const char *table_name, const char *column,
+                            enum_histogram_type type, ha_rows sample_rows,
+                            double null_fraction, const String &data)
+{
+  int error;
+
+  tmp_disable_binlog(thd);
+  error= find_column_stats_row(table, db, table_name, column);
+  if (!error || error == HA_ERR_KEY_NOT_FOUND)
+  {
+    Field **field= table->field;
+    timeval now= thd->query_start_timeval_trunc(0);
+    field[COLUMN_STATS_LAST_UPDATE]->store_timestamp(&now);
+    field[COLUMN_STATS_HISTOGRAM_TYPE]->store((longlong) type, true);
+    field[COLUMN_STATS_BUCKETS]->store((longlong) uint4korr(data.ptr() + 6),
+                                       true);
+    field[COLUMN_STATS_SAMPLED_ROWS]->store((longlong) sample_rows, true);
+    field[COLUMN_STATS_NULL_FRACTION]->store(null_fraction);
+    field[COLUMN_STATS_HISTOGRAM]->store(data.ptr(), data.length(),
+                                         &my_charset_bin);
+
+    if (error)
+      error= table->file->ha_write_row(table->record[0]);
+    else if ((error= table->file->ha_update_row(table->record[1],
+                                                table->record[0])) ==
+             HA_ERR_RECORD_IS_THE_SAME)
+      error= 0;
+  }
+  if (error)
+    table->file->print_error(error, MYF(0));
+
+  reenable_binlog(thd);
+  return error != 0;
+}
+
+
+/**
+  Checks whether a histogram can be built for a column.
+
+  @return the message to send to the client if not, NULL if it can
+*/
+
+static const char *histogram_unsupported(TABLE *table, Field *field)
+{
+  switch (field->real_type()) {
+  case MYSQL_TYPE_GEOMETRY:
+  case MYSQL_TYPE_TINY_BLOB:
+  case MYSQL_TYPE_MEDIUM_BLOB:
+  case MYSQL_TYPE_LONG_BLOB:
+  case MYSQL_TYPE_BLOB:
+    return "The column '%s' has an unsupported data type.";
+  default:
+    break;
+  }
+
+  /* The optimizer knows the selectivity of those without a histogram */
+  for (uint i= 0; i < table->s->keys; i++)
+  {
+    KEY *key= table->key_info + i;
+    if ((key->flags & HA_NOSAME) && key->user_defined_key_parts == 1 &&
+        key->key_part[0].fieldnr == field->field_index + 1)
+      return "The column '%s' is covered by a single-part unique index.";
+  }
+  return NULL;
+}
+
+
+bool mysql_update_histograms(THD *thd, TABLE_LIST *table_list,
+                             List<String> *columns, ulong max_buckets)
+{
+  char table_name[NAME_LEN * 2 + 2];
+  Histogram_column *histogram_columns;
+  uint count= 0;
+  uint row_length= 0;
+  uchar *sample= NULL;
+  ha_rows sample_rows= 0;
+  TABLE *table;
+  String data;
+  String *name;
+  List_iterator<String> it(*columns);
+  DBUG_ENTER("mysql_update_histograms");
+
+  if (max_buckets < 1 || max_buckets > HISTOGRAM_MAX_BUCKETS)
+  {
+    my_error(ER_DATA_OUT_OF_RANGE, MYF(0), "Number of buckets",
+             "ANALYZE TABLE");
+    DBUG_RETURN(true);
+  }
+
+  if (thd->locked_tables_mode)
+  {
+    my_error(ER_LOCK_OR_ACTIVE_TRANSACTION, MYF(0));
+    DBUG_RETURN(true);
+  }
+
+  /*
+    Close the temporary tables which were pre-opened for privilege
+    checking, then open the table for reading.
+  */
+  close_thread_tables(thd);
+  table_list->table= NULL;
+  table_list->lock_type= TL_READ;
+  table_list->mdl_request.set_type(MDL_SHARED_READ);
+  table_list->required_type= FRMTYPE_TABLE;
+  if (open_temporary_tables(thd, table_list) ||
+      open_and_lock_tables(thd, table_list, FALSE, 0))
+    DBUG_RETURN(true);
+  table= table_list->table;
+  strxmov(table_name, table->s->db.str, ".", table->s->table_name.str, NullS);
+
+  if (send_histogram_result_metadata(thd))
+    goto err;
+
+  if (table->s->tmp_table != NO_TMP_TABLE)
+  {
+    if (send_histogram_message(thd, table_name, "Error", "%s",
+                               "Cannot create histogram statistics for a "
+                               "temporary table."))
+      goto err;
+    trans_commit_stmt(thd);
+    close_thread_tables(thd);
+    my_eof(thd);
+    DBUG_RETURN(false);
+  }
+
+  histogram_columns= (Histogram_column*)
+    thd->alloc(columns->elements * sizeof(Histogram_column));
+  if (!histogram_columns)
+    goto err;
+
+  while ((name= it++))
+  {
+    Field *field= NULL;
+    for (Field **f= table->field; *f; f++)
+    {
+      if (!my_strcasecmp(system_charset_info, (*f)->field_name,
+                         name->c_ptr_safe()))
+      {
+        field= *f;
+        break;
+      }
+    }
+
+    if (!field)
+    {
+      if (send_histogram_message(thd, table_name, "Error",
+                                 "The column '%s' does not exist.",
+                                 name->c_ptr_safe()))
+        goto err;
+      continue;
+    }
+
+    const char *unsupported= histogram_unsupported(table, field);
+    if (unsupported)
+    {
+      if (send_histogram_message(thd, table_name, "Error", unsupported,
+                                 field->field_name))
+        goto err;
+      continue;
+    }
+
+    bool duplicate= false;
+    for (uint i= 0; i < count; i++)
+      duplicate|= histogram_columns[i].field == field;
+    if (duplicate)
+      continue;
+
+    histogram_columns[count].field= field;
+    histogram_columns[count].value_length= histogram_value_length(field);
+    histogram_columns[count].offset= row_length;
+    row_length+= 1 + histogram_columns[count].value_length;
+    count++;
+  }
+
+  if (count &&
+      sample_table(thd, table, histogram_columns, count, row_length, &sample,
+                   &sample_rows))
+    goto err;
+
+  trans_commit_stmt(thd);
+  close_thread_tables(thd);
+
+  if (count)
+  {
+    TABLE_LIST tables;
+    tables.init_one_table(column_stats_db.str, column_stats_db.length,
+                          column_stats_name.str, column_stats_name.length,
+                          column_stats_name.str, TL_WRITE);
+    TABLE *stats= open_ltable(thd, &tables, TL_WRITE,
+                              MYSQL_LOCK_IGNORE_TIMEOUT);
+    if (!stats || check_column_stats_table(stats))
+    {
+      my_free(sample);
+      goto err;
+    }
+
+    for (uint i= 0; i < count; i++)
+    {
+      enum_histogram_type type;
+      double null_fraction;
+      const char *column= histogram_columns[i].field->field_name;
+
+      if (build_histogram(&histogram_columns[i], sample, sample_rows,
+                          row_length, max_buckets, &data, &type,
+                          &null_fraction) ||
+          store_histogram(thd, stats, table_list->db, table_list->table_name,
+                          column, type, sample_rows, null_fraction, data))
+      {
+        my_free(sample);
+        goto err;
+      }
+
+      Column_histogram *histogram=
+        new_histogram(table_list->db, table_list->table_name, column, type,
+                      sample_rows, null_fraction, (const uchar*) data.ptr(),
+                      data.length());
+      mysql_rwlock_wrlock(&LOCK_histograms);
+      bool error= !histogram || cache_histogram(histogram);
+      mysql_rwlock_unlock(&LOCK_histograms);
+      if (error)
+      {
+        my_free(sample);
+        goto err;
+      }
+
+      if (send_histogram_message(thd, table_name, "status",
+                                 "Histogram statistics created for column "
+                                 "'%s'.", column))
+      {
+        my_free(sample);
+        goto err;
+      }
+    }
+    my_free(sample);
+    close_mysql_tables(thd);
+  }
+
+  my_eof(thd);
+  DBUG_RETURN(false);
+
+err:
+  trans_rollback_stmt(thd);
+  close_thread_tables(thd);
+  DBUG_RETURN(true);
+}
+
+
+bool mysql_drop_histograms(THD *thd, TABLE_LIST *table_list,
+                           List<String> *columns)
+{
+  char table_name[NAME_LEN * 2 + 2];
+  char key[3 * (NAME_LEN + 1)];
+  char column_buff[NAME_LEN + 1];
+  String column(column_buff, sizeof(column_buff), system_charset_info);
+  TABLE_LIST tables;
+  String *name;
+  List_iterator<String> it(*columns);
+  DBUG_ENTER("mysql_drop_histograms");
+
+  if (thd->locked_tables_mode)
+  {
+    my_error(ER_LOCK_OR_ACTIVE_TRANSACTION, MYF(0));
+    DBUG_RETURN(true);
+  }
+
+  close_thread_tables(thd);
+  table_list->table= NULL;
+
+  tables.init_one_table(column_stats_db.str, column_stats_db.length,
+                        column_stats_name.str, column_stats_name.length,
+                        column_stats_name.str, TL_WRITE);
+  TABLE *stats= open_ltable(thd, &tables, TL_WRITE,
+                            MYSQL_LOCK_IGNORE_TIMEOUT);
+  if (!stats || check_column_stats_table(stats) ||
+      send_histogram_result_metadata(thd))
+    goto err;
+
+  strxmov(table_name, table_list->db, ".", table_list->table_name, NullS);
+
+  while ((name= it++))
+  {
+    int error;
+    tmp_disable_binlog(thd);
+    error= find_column_stats_row(stats, table_list->db,
+                                     table_list->table_name,
+                                     name->c_ptr_safe());
+    if (!error)
+    {
+      /* Column names are case insensitive, uncache the stored name */
+      stats->field[COLUMN_STATS_COLUMN_NAME]->val_str(&column);
+      error= stats->file->ha_delete_row(stats->record[1]);
+    }
+    reenable_binlog(thd);
+
+    if (error == HA_ERR_KEY_NOT_FOUND)
+    {
+      if (send_histogram_message(thd, table_name, "status",
+                                 "No histogram statistics found for "
+                                 "column '%s'.", name->c_ptr_safe()))
+        goto err;
+      continue;
+    }
+    if (error)
+    {
+      stats->file->print_error(error, MYF(0));
+      goto err;
+    }
+
+    uint key_length= histogram_key(key, table_list->db,
+                                   table_list->table_name,
+                                   column.c_ptr_safe());
+    mysql_rwlock_wrlock(&LOCK_histograms);
+    uncache_histogram(key, key_length);
+    mysql_rwlock_unlock(&LOCK_histograms);
+
+    if (send_histogram_message(thd, table_name, "status",
+                               "Histogram statistics removed for column "
+                               "'%s'.", name->c_ptr_safe()))
+      goto err;
+  }
+
+  close_mysql_tables(thd);
+  my_eof(thd);
+  DBUG_RETURN(false);
+
+err:
+  close_mysql_tables(thd);
+  DBUG_RETURN(true);
+}
+
+
+/**
+  Swallows the errors of the updates of mysql.column_stats done by DDL,
+  which do not fail the statement, and keeps the last message for the
+  error log.
+*/
+
+class Histogram_ddl_error_handler : public Internal_error_handler
+{
+  char m_message[MYSQL_ERRMSG_SIZE];
+public:
+  Histogram_ddl_error_handler()
+  {
+    m_message[0]= '\0';
+  }
+
+  virtual bool handle_condition(THD *thd,
+                                uint sql_errno,
+                                const char *sql_state,
+                                Sql_condition::enum_warning_level level,
+                                const char *msg,
+                                Sql_condition **cond_hdl)
+  {
+    *cond_hdl= NULL;
+    if (level == Sql_condition::WARN_LEVEL_ERROR)
+      strmake(m_message, msg, sizeof(m_message) - 1);
+    return true;
+  }
+
+  const char *message() const { return m_message; }
+};
+
+
+/** A histogram removed or moved to another column by DDL */
+
+struct Histogram_move
+{
+  /** the column, as in the key of the histogram in the cache */
+  char column[NAME_LEN + 1];
+  /** the new name of the column, NULL if it keeps its name */
+  const char *new_column;
+  /** the histogram under its new name, NULL if it is removed */
+  Column_histogram *moved;
+  /** the row of the histogram in mysql.column_stats, if it is moved */
+  uchar *record;
+};
+
+
+/**
+  Removes or moves the histograms of the columns of a table, in
+  mysql.column_stats and in the cache.
+
+  All the rows are removed before the moved ones are written back, so
+  that ALTER TABLE can swap the names of two columns.
+
+  @param thd             thread descriptor
+  @param db              database of the table
+  @param table_name      name of the table
+  @param new_db          new database of the table, NULL if the table is
+                         dropped
+  @param new_table_name  new name of the table
+  @param changes         the columns ALTER TABLE drops or renames
+  @param change_count    number of changed columns
+*/
+
+static void move_histograms(THD *thd, const char *db, const char *table_name,
+                            const char *new_db, const char *new_table_name,
+                            const Histogram_alter *changes,
+                            uint change_count)
+{
+  char key[3 * (NAME_LEN + 1)];
+  Mem_root_array<Histogram_move, true> moves(thd->mem_root);
+  const bool table_moved= !new_db || strcmp(db, new_db) ||
+                          strcmp(table_name, new_table_name);
+  DBUG_ENTER("move_histograms");
+
+  if (!histograms_cached)
+    DBUG_VOID_RETURN;
+
+  /*
+    The cache has the histograms of all the rows of mysql.column_stats,
+    look for those of the table there: "db\0table\0" prefixes their keys.
+  */
+  const uint prefix_length= histogram_key(key, db, table_name, "");
+
+  mysql_rwlock_rdlock(&LOCK_histograms);
+  for (ulong i= 0; i < histogram_cache.records; i++)
+  {
+    const Column_histogram *histogram= (const Column_histogram*)
+      my_hash_element(&histogram_cache, i);
+    if (histogram->key_length <= prefix_length ||
+        memcmp(histogram->key, key, prefix_length))
+      continue;
+
+    Histogram_move move;
+    strmake(move.column, histogram->key + prefix_length,
+            min<size_t>(histogram->key_length - prefix_length, NAME_LEN));
+    move.new_column= NULL;
+    move.moved= NULL;
+    move.record= NULL;
+
+    bool changed= table_moved;
+    bool dropped= !new_db;
+    for (uint j= 0; j < change_count; j++)
+    {
+      if (!strcmp(changes[j].column, move.column))
+      {
+        changed= true;
+        dropped|= !changes[j].new_column;
+        move.new_column= changes[j].new_column;
+        break;
+      }
+    }
+    if (!changed)
+      continue;
+
+    /* Out of memory drops the histogram */
+    if (!dropped)
+      move.moved= new_histogram(new_db, new_table_name,
+                                move.new_column ? move.new_column :
+                                                  move.column,
+                                histogram->type, histogram->sampled_rows,
+                                histogram->null_fraction,
+                                histogram->stored_data(),
+                                histogram->stored_length());
+    if (moves.push_back(move))
+    {
+      my_free(move.moved);
+      break;
+    }
+  }
+  mysql_rwlock_unlock(&LOCK_histograms);
+
+  if (moves.empty())
+    DBUG_VOID_RETURN;
+
+  Histogram_ddl_error_handler error_handler;
+  Open_tables_backup backup;
+  Query_tables_list query_tables_list_backup;
+  TABLE_LIST tables;
+  int error= 0;
+
+  thd->push_internal_handler(&error_handler);
+
+  /*
+    The statement may have tables open, or be under LOCK TABLES: open
+    mysql.column_stats in a new Open_tables_state, as the log tables are.
+  */
+  tables.init_one_table(column_stats_db.str, column_stats_db.length,
+                        column_stats_name.str, column_stats_name.length,
+                        column_stats_name.str, TL_WRITE);
+  thd->lex->reset_n_backup_query_tables_list(&query_tables_list_backup);
+  thd->reset_n_backup_open_tables_state(&backup);
+  if (open_and_lock_tables(thd, &tables, FALSE,
+                           MYSQL_OPEN_IGNORE_FLUSH |
+                           MYSQL_LOCK_IGNORE_TIMEOUT) ||
+      check_column_stats_table(tables.table))
+    error= -1;
+  thd->lex->restore_backup_query_tables_list(&query_tables_list_backup);
+
+  if (!error)
+  {
+    TABLE *stats= tables.table;
+    Field **field= stats->field;
+
+    tmp_disable_binlog(thd);
+    for (size_t i= 0; i < moves.size() && !error; i++)
+    {
+      Histogram_move *move= &moves.at(i);
+      if ((error= find_column_stats_row(stats, db, table_name,
+                                        move->column)))
+      {
+        if (error == HA_ERR_KEY_NOT_FOUND)
+          error= 0;
+        continue;
+      }
+      if (move->moved &&
+          !(move->record= (uchar*) thd->memdup(stats->record[1],
+                                               stats->s->reclength)))
+        error= HA_ERR_OUT_OF_MEM;
+      else
+        error= stats->file->ha_delete_row(stats->record[1]);
+    }
+
+    for (size_t i= 0; i < moves.size() && !error; i++)
+    {
+      Histogram_move *move= &moves.at(i);
+      const char *new_column= move->new_column ? move->new_column :
+                                                 move->column;
+      if (!move->record)
+        continue;
+
+      /* A row left behind by a dropped table of the same name */
+      if (!(error= find_column_stats_row(stats, new_db, new_table_name,
+                                         new_column)))
+        error= stats->file->ha_delete_row(stats->record[1]);
+      if (error && error != HA_ERR_KEY_NOT_FOUND)
+        break;
+
+      memcpy(stats->record[0], move->record, stats->s->reclength);
+      field[COLUMN_STATS_DATABASE_NAME]->store(new_db, strlen(new_db),
+                                               system_charset_info);
+      field[COLUMN_STATS_TABLE_NAME]->store(new_table_name,
+                                            strlen(new_table_name),
+                                            system_charset_info);
+      field[COLUMN_STATS_COLUMN_NAME]->store(new_column, strlen(new_column),
+                                             system_charset_info);
+      field[COLUMN_STATS_HISTOGRAM]->store((const char*)
+                                           move->moved->stored_data(),
+                                           move->moved->stored_length(),
+                                           &my_charset_bin);
+      error= stats->file->ha_write_row(stats->record[0]);
+    }
+    if (error)
+      stats->file->print_error(error, MYF(0));
+    reenable_binlog(thd);
+  }
+  close_system_tables(thd, &backup);
+  thd->pop_internal_handler();
+
+  if (error)
+    sql_print_warning("Could not update the histograms of table '%s'.'%s' "
+                      "in mysql.column_stats: %s", db, table_name,
+                      error_handler.message());
+
+  /* The cache follows the DDL even if mysql.column_stats could not */
+  mysql_rwlock_wrlock(&LOCK_histograms);
+  for (size_t i= 0; i < moves.size(); i++)
+  {
+    uint key_length= histogram_key(key, db, table_name, moves.at(i).column);
+    uncache_histogram(key, key_length);
+  }
+  for (size_t i= 0; i < moves.size(); i++)
+    if (moves.at(i).moved)
+      (void) cache_histogram(moves.at(i).moved);
+  mysql_rwlock_unlock(&LOCK_histograms);
+  DBUG_VOID_RETURN;
+}
+
+
+void histograms_drop_table(THD *thd, const char *db, const char *table_name)
+{
+  move_histograms(thd, db, table_name, NULL, NULL, NULL, 0);
+}
+
+
+void histograms_rename_table(THD *thd, const char *db,
+                             const char *table_name, const char *new_db,
+                             const char *new_table_name)
+{
+  move_histograms(thd, db, table_name, new_db, new_table_name, NULL, 0);
+}
+
+
+bool histograms_prepare_alter(THD *thd, TABLE *table, Alter_info *alter_info,
+                              Histogram_alter **changes, uint *change_count)
+{
+  char key[3 * (NAME_LEN + 1)];
+  bool error= false;
+  DBUG_ENTER("histograms_prepare_alter");
+
+  *changes= NULL;
+  *change_count= 0;
+  if (!histograms_cached)
+    DBUG_RETURN(false);
+
+  if (!(*changes= (Histogram_alter*)
+                  thd->alloc(table->s->fields * sizeof(Histogram_alter))))
+    DBUG_RETURN(true);
+
+  mysql_rwlock_rdlock(&LOCK_histograms);
+  for (Field **f= table->field; *f && !error; f++)
+  {
+    Field *field= *f;
+    uint key_length= histogram_key(key, table->s->db.str,
+                                   table->s->table_name.str,
+                                   field->field_name);
+    if (!my_hash_search(&histogram_cache, (uchar*) key, key_length))
+      continue;
+
+    /* mysql_prepare_alter_table() links a kept column to its old field */
+    Create_field *def;
+    List_iterator_fast<Create_field> it(alter_info->create_list);
+    while ((def= it++))
+      if (def->field == field)
+        break;
+
+    const char *new_column;
+    if (!def || field->is_equal(def) == IS_EQUAL_NO)
+      new_column= NULL;                 // Dropped, or its values change
+    else if (strcmp(field->field_name, def->field_name))
+      new_column= def->field_name;
+    else
+      continue;
+
+    /* The old definition of the table is gone when they are applied */
+    Histogram_alter *change= *changes + *change_count;
+    error= !(change->column= thd->strdup(field->field_name)) ||
+           (new_column && !(new_column= thd->strdup(new_column)));
+    change->new_column= new_column;
+    (*change_count)++;
+  }
+  mysql_rwlock_unlock(&LOCK_histograms);
+  DBUG_RETURN(error);
+}
+
+
+void histograms_alter_table(THD *thd, const char *db, const char *table_name,
+                            const char *new_db, const char *new_table_name,
+                            const Histogram_alter *changes,
+                            uint change_count)
+{
+  move_histograms(thd, db, table_name, new_db, new_table_name, changes,
+                  change_count);
+}
+
+
+/**
+  Looks up the histogram of a column. LOCK_histograms must be read locked.
+
+  @return the histogram, or NULL if the column has none or if it was built
+          for another definition of the column
+*/
+
+static const Column_histogram *find_histogram(const Field *field)
+{
+  char key[3 * (NAME_LEN + 1)];
+  const TABLE_SHARE *share= field->table->s;
+  uint key_length= histogram_key(key, share->db.str, share->table_name.str,
+                                 field->field_name);
+  const Column_histogram *histogram= (const Column_histogram*)
+    my_hash_search(&histogram_cache, (uchar*) key, key_length);
+
+  if (!histogram ||
+      histogram->field_type != (uint) field->real_type() ||
+      histogram->charset_number != field->charset()->number ||
+      histogram->value_length != histogram_value_length(field))
+    return NULL;
+  return histogram;
+}
+
+
+/**
+  Converts a constant to the sort key it would have as a value of a
+  column.
+
+  @retval false OK
+  @retval true  The constant cannot be converted exactly, or comparing it
+                with the column is not comparing values of the column
+*/
+
+static bool value_sort_key(Field *field, Item *value, uint length,
+                           uchar *key)
+{
+  if (!value->const_item() || value->is_expensive() || value->is_null())
+    return true;
+
+  /* A string column compared with a number is compared as a number */
+  if (field->result_type() == STRING_RESULT && !field->is_temporal() &&
+      (value->result_type() != STRING_RESULT ||
+       value->collation.collation != field->charset()))
+    return true;
+
+  TABLE *table= field->table;
+  my_bitmap_map *old_map= dbug_tmp_use_all_columns(table, table->write_set);
+  type_conversion_status status= value->save_in_field_no_warnings(field,
+                                                                  true);
+  dbug_tmp_restore_column_map(table->write_set, old_map);
+  if (status != TYPE_OK || field->is_null())
+    return true;
+
+  field->make_sort_key(key, length);
+  return false;
+}
+
+
+/** Returns the column of a table an item refers to, or NULL */
+
+static Field *histogram_field(TABLE *table, Item *item)
+{
+  item= item->real_item();
+  if (item->type() != Item::FIELD_ITEM)
+    return NULL;
+  Field *field= static_cast<Item_field*>(item)->field;
+  if (field->table != table || !field->part_of_key.is_clear_all())
+    return NULL;
+  return field;
+}
+
+
+/**
+  Estimates the selectivity of a comparison of a column with constants.
+
+  @param      histogram  histogram of the column
+  @param      field      the column
+  @param      functype   the comparison, with the column as first argument
+  @param      negated    true for NOT BETWEEN and NOT IN
+  @param      values     the constants
+  @param      count      number of constants
+  @param[out] selectivity
+
+  @retval false OK
+  @retval true  No estimate
+*/
+
+static bool comparison_selectivity(const Column_histogram *histogram,
+                                   Field *field, Item_func::Functype functype,
+                                   bool negated, Item **values, uint count,
+                                   double *selectivity)
+{
+  uchar key[MAX_FIELD_WIDTH], key2[MAX_FIELD_WIDTH];
+  const uint length= histogram->value_length;
+  const double not_null= histogram->not_null_fraction();
+
+  /* The sort keys of ENUM and SET columns do not sort as strings */
+  const bool ordered= field->real_type() != MYSQL_TYPE_ENUM &&
+                      field->real_type() != MYSQL_TYPE_SET;
+
+  DBUG_ASSERT(length <= sizeof(key));
+
+  switch (functype) {
+  case Item_func::ISNULL_FUNC:
+    *selectivity= histogram->null_fraction;
+    return false;
+  case Item_func::ISNOTNULL_FUNC:
+    *selectivity= not_null;
+    return false;
+  case Item_func::EQ_FUNC:
+  case Item_func::EQUAL_FUNC:
+  case Item_func::MULT_EQUAL_FUNC:
+  case Item_func::NE_FUNC:
+    if (value_sort_key(field, values[0], length, key))
+      return true;
+    *selectivity= histogram->equal_to(key);
+    if (functype == Item_func::NE_FUNC)
+      *selectivity= not_null - *selectivity;
+    return false;
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    if (!ordered || value_sort_key(field, values[0], length, key))
+      return true;
+    if (functype == Item_func::LT_FUNC || functype == Item_func::LE_FUNC)
+      *selectivity= histogram->less_than(key,
+                                         functype == Item_func::LE_FUNC);
+    else
+      *selectivity= not_null -
+                    histogram->less_than(key,
+                                         functype == Item_func::GT_FUNC);
+    return false;
+  case Item_func::BETWEEN:
+    if (!ordered || value_sort_key(field, values[0], length, key) ||
+        value_sort_key(field, values[1], length, key2))
+      return true;
+    *selectivity= max(0.0, histogram->less_than(key2, true) -
+                           histogram->less_than(key, false));
+    break;
+  case Item_func::IN_FUNC:
+    *selectivity= 0.0;
+    for (uint i= 0; i < count; i++)
+    {
+      if (value_sort_key(field, values[i], length, key))
+        return true;
+      *selectivity+= histogram->equal_to(key);
+    }
+    *selectivity= min(*selectivity, not_null);
+    break;
+  default:
+    return true;
+  }
+
+  if (negated)
+    *selectivity= not_null - *selectivity;
+  return false;
+}
+
+
+/** A conjunct estimated with a histogram */
+
+struct Histogram_estimate
+{
+  Item *condition;
+  Field *field;
+  const Column_histogram *histogram;
+  double selectivity;
+};
+
+
+/**
+  Estimates the selectivity of a conjunct of the WHERE condition with the
+  histograms of the columns of a table.
+
+  @param      table      the table
+  @param      cond       the conjunct
+  @param[out] estimates  the estimates of the conjunct are appended here
+*/
+
+static void estimate_conjunct(TABLE *table, Item *cond,
+                              Mem_root_array<Histogram_estimate, true>
+                              *estimates)
+{
+  if (cond->type() != Item::FUNC_ITEM)
+    return;
+
+  Item_func *func= static_cast<Item_func*>(cond);
+  Item_func::Functype functype= func->functype();
+  Histogram_estimate estimate;
+  estimate.condition= cond;
+
+  if (functype == Item_func::MULT_EQUAL_FUNC)
+  {
+    /* Every column of the table in col1 = col2 = ... = constant */
+    Item_equal *item_equal= static_cast<Item_equal*>(func);
+    Item *value= item_equal->get_const();
+    if (!value)
+      return;
+    Item_equal_iterator it(*item_equal);
+    Item_field *item;
+    while ((item= it++))
+    {
+      if (!(estimate.field= histogram_field(table, item)) ||
+          !(estimate.histogram= find_histogram(estimate.field)) ||
+          comparison_selectivity(estimate.histogram, estimate.field,
+                                 functype, false, &value, 1,
+                                 &estimate.selectivity))
+        continue;
+      estimates->push_back(estimate);
+    }
+    return;
+  }
+
+  if (func->argument_count() < 1)
+    return;
+
+  Item **args= func->arguments();
+  Item *swapped[2];
+  bool negated= false;
+  uint first_value= 1;
+  switch (functype) {
+  case Item_func::EQ_FUNC:
+  case Item_func::EQUAL_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    if (!histogram_field(table, args[0]))
+    {
+      /* constant < column is column > constant */
+      if (!histogram_field(table, args[1]))
+        return;
+      swapped[0]= args[1];
+      swapped[1]= args[0];
+      args= swapped;
+      if (functype != Item_func::NE_FUNC)
+        functype= static_cast<Item_bool_func2*>(func)->rev_functype();
+    }
+    break;
+  case Item_func::BETWEEN:
+  case Item_func::IN_FUNC:
+    negated= static_cast<Item_func_opt_neg*>(func)->negated;
+    break;
+  case Item_func::ISNULL_FUNC:
+  case Item_func::ISNOTNULL_FUNC:
+    first_value= 0;
+    break;
+  default:
+    return;
+  }
+
+  if (!(estimate.field= histogram_field(table, args[0])) ||
+      !(estimate.histogram= find_histogram(estimate.field)) ||
+      comparison_selectivity(estimate.histogram, estimate.field, functype,
+                             negated, args + first_value,
+                             func->argument_count() - first_value,
+                             &estimate.selectivity))
+    return;
+  estimates->push_back(estimate);
+}
+
+
+double histogram_selectivity(THD *thd, TABLE *table, Item *cond,
+                             const char **columns_used)
+{
+  *columns_used= NULL;
+  if (!cond || !histograms_cached || table->s->tmp_table != NO_TMP_TABLE)
+    return 1.0;
+
+  Mem_root_array<Histogram_estimate, true> estimates(thd->mem_root);
+
+  mysql_rwlock_rdlock(&LOCK_histograms);
+  if (cond->type() == Item::COND_ITEM &&
+      static_cast<Item_cond*>(cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator_fast<Item> it(*static_cast<Item_cond*>(cond)->
+                                argument_list());
+    Item *item;
+    while ((item= it++))
+      estimate_conjunct(table, item, &estimates);
+  }
+  else
+    estimate_conjunct(table, cond, &estimates);
+
+  if (estimates.empty())
+  {
+    mysql_rwlock_unlock(&LOCK_histograms);
+    return 1.0;
+  }
+
+  /*
+    Assume the conjuncts are independent. A value missing from the sample
+    may still be in the table, so do not go below half a sampled row.
+  */
+  double selectivity= 1.0;
+  StringBuffer<NAME_LEN * 4> used(system_charset_info);
+  Opt_trace_context *const trace= &thd->opt_trace;
+  Opt_trace_array trace_histograms(trace, "histograms");
+  for (size_t i= 0; i < estimates.size(); i++)
+  {
+    Histogram_estimate *estimate= &estimates.at(i);
+    const Column_histogram *histogram= estimate->histogram;
+    double lowest= 0.5 / max<ha_rows>(histogram->sampled_rows, 1);
+    estimate->selectivity= min(max(estimate->selectivity, lowest), 1.0);
+    selectivity*= estimate->selectivity;
+
+    Opt_trace_object(trace).
+      add_utf8("column", estimate->field->field_name).
+      add_alnum("histogram_type", histogram_type_names[histogram->type]).
+      add("condition", estimate->condition).
+      add("selectivity", estimate->selectivity);
+
+    bool listed= false;
+    for (size_t j= 0; j < i; j++)
+      listed|= estimates.at(j).field == estimate->field;
+    if (!listed)
+    {
+      if (used.length())
+        used.append(',');
+      used.append(estimate->field->field_name);
+    }
+  }
+  mysql_rwlock_unlock(&LOCK_histograms);
+
+  *columns_used= thd->strmake(used.ptr(), used.length());
+  return selectivity;
+}
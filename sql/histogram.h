@@ -0,0 +1,173 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+#ifndef HISTOGRAM_INCLUDED
+#define HISTOGRAM_INCLUDED
+
+#include "my_global.h"
+
+class THD;
+class Item;
+class String;
+struct TABLE;
+struct TABLE_LIST;
+class Alter_info;
+template <class T> class List;
+
+/** Number of buckets of ANALYZE TABLE ... UPDATE HISTOGRAM without WITH */
+#define HISTOGRAM_DEFAULT_BUCKETS 100
+
+/** Largest number of buckets of a column histogram */
+#define HISTOGRAM_MAX_BUCKETS 1024
+
+/**
+  Initializes the column histogram cache and loads it from
+  mysql.column_stats.
+
+  @param dont_read_table  only initialize the cache, used when bootstrapping
+
+  @retval false OK
+  @retval true  Error
+*/
+bool histograms_init(bool dont_read_table);
+
+/**
+  Frees the column histogram cache.
+*/
+void histograms_free();
+
+/**
+  Builds the histograms of the given columns of a table from a sample of
+  its rows, stores them in mysql.column_stats and sends the result set of
+  ANALYZE TABLE ... UPDATE HISTOGRAM to the client.
+
+  @param thd      thread descriptor
+  @param table    the table
+  @param columns  names of the columns
+  @param buckets  maximum number of buckets of each histogram
+
+  @retval false OK
+  @retval true  Error
+*/
+bool mysql_update_histograms(THD *thd, TABLE_LIST *table,
+                             List<String> *columns, ulong buckets);
+
+/**
+  Removes the histograms of the given columns of a table and sends the
+  result set of ANALYZE TABLE ... DROP HISTOGRAM to the client.
+
+  @param thd      thread descriptor
+  @param table    the table
+  @param columns  names of the columns
+
+  @retval false OK
+  @retval true  Error
+*/
+bool mysql_drop_histograms(THD *thd, TABLE_LIST *table,
+                           List<String> *columns);
+
+/**
+  What ALTER TABLE does to a column that has a histogram.
+*/
+struct Histogram_alter
+{
+  const char *column;
+  /** the new name of the column, NULL if its histogram is dropped */
+  const char *new_column;
+};
+
+/**
+  Removes the histograms of the columns of a dropped table from
+  mysql.column_stats and from the cache. Errors are written to the error
+  log, they do not fail the statement.
+
+  @param thd         thread descriptor
+  @param db          database of the table
+  @param table_name  name of the table
+*/
+void histograms_drop_table(THD *thd, const char *db, const char *table_name);
+
+/**
+  Moves the histograms of the columns of a renamed table to its new name
+  in mysql.column_stats and in the cache. Errors are written to the error
+  log, they do not fail the statement.
+
+  @param thd             thread descriptor
+  @param db              database of the table
+  @param table_name      name of the table
+  @param new_db          new database of the table
+  @param new_table_name  new name of the table
+*/
+void histograms_rename_table(THD *thd, const char *db,
+                             const char *table_name, const char *new_db,
+                             const char *new_table_name);
+
+/**
+  Finds the columns with a histogram that ALTER TABLE drops, renames or
+  changes to an incompatible type. Called once mysql_prepare_create_table()
+  has prepared the new definition, while the old one is still open.
+
+  @param      thd           thread descriptor
+  @param      table         the altered table
+  @param      alter_info    the new definition of the table
+  @param[out] changes       the columns, allocated on the statement memory
+  @param[out] change_count  number of columns
+
+  @retval false OK
+  @retval true  Out of memory
+*/
+bool histograms_prepare_alter(THD *thd, TABLE *table, Alter_info *alter_info,
+                              Histogram_alter **changes, uint *change_count);
+
+/**
+  Drops and renames the histograms of an altered table as found by
+  histograms_prepare_alter(), and moves them to the new name of the table
+  if it was renamed. Errors are written to the error log, they do not
+  fail the statement.
+
+  @param thd             thread descriptor
+  @param db              database of the table
+  @param table_name      name of the table
+  @param new_db          new database of the table
+  @param new_table_name  new name of the table
+  @param changes         the changed columns
+  @param change_count    number of changed columns
+*/
+void histograms_alter_table(THD *thd, const char *db, const char *table_name,
+                            const char *new_db, const char *new_table_name,
+                            const Histogram_alter *changes,
+                            uint change_count);
+
+/**
+  Estimates which fraction of the rows of a table satisfy the top-level
+  conjuncts of a condition that compare non-indexed columns with
+  constants, using the histograms of those columns. The conjuncts on
+  indexed columns are left to range analysis and index statistics.
+
+  @param      thd           thread descriptor
+  @param      table         the table
+  @param      cond          the condition, may be NULL
+  @param[out] columns_used  the columns whose histograms were used, or
+                            NULL if none was
+
+  @return the selectivity, 1.0 if no histogram applies
+*/
+double histogram_selectivity(THD *thd, TABLE *table, Item *cond,
+                             const char **columns_used);
+
+#endif /* HISTOGRAM_INCLUDED */
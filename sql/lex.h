@@ -93,6 +93,7 @@ static SYMBOL symbols[] = {
   { "BOOLEAN",		SYM(BOOLEAN_SYM)},
   { "BOTH",		SYM(BOTH)},
   { "BTREE",		SYM(BTREE_SYM)},
+  { "BUCKETS",		SYM(BUCKETS_SYM)},
   { "BY",		SYM(BY)},
   { "BYTE",		SYM(BYTE_SYM)},
   { "CACHE",		SYM(CACHE_SYM)},
@@ -256,6 +257,7 @@ static SYMBOL symbols[] = {
   { "HAVING",		SYM(HAVING)},
   { "HELP",		SYM(HELP_SYM)},
   { "HIGH_PRIORITY",	SYM(HIGH_PRIORITY)},
+  { "HISTOGRAM",	SYM(HISTOGRAM_SYM)},
   { "HOST",		SYM(HOST_SYM)},
   { "HOSTS",		SYM(HOSTS_SYM)},
   { "HOUR",		SYM(HOUR_SYM)},
@@ -2740,6 +2740,7 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
       rli->mts_groups_assigned++;
 
       rli->curr_group_isolated= FALSE;
+      rli->mts_last_committed= rli->mts_sequence_number= 0;
       group.reset(log_pos, rli->mts_groups_assigned);
       // the last occupied GAQ's array index
       gaq_idx= gaq->assigned_group_index= gaq->en_queue((void *) &group);
@@ -2767,9 +2768,21 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
         }
 
         if (is_gtid_event(this))
+        {
           // mark the current group as started with explicit Gtid-event
           rli->curr_group_seen_gtid= true;
 
+          if (rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK)
+          {
+            Gtid_log_event *gtid_ev= static_cast<Gtid_log_event*>(this);
+
+            rli->mts_last_committed= gtid_ev->last_committed;
+            rli->mts_sequence_number= gtid_ev->sequence_number;
+            gaq->get_job_group(gaq_idx)->sequence_number=
+              gtid_ev->sequence_number;
+          }
+        }
+
         return ret_worker;
       }
     }
@@ -2818,7 +2831,45 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
     // partioning info is found which drops the flag
     rli->mts_end_group_sets_max_dbs= false;
     ret_worker= rli->last_assigned_worker;
-    if (mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS)
+
+    if (!ret_worker &&
+        rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK)
+    {
+      /*
+        The first partitioned event of the group: its commit parent has
+        to be applied before the group is handed over to a Worker.
+      */
+      if (mts_wait_for_commit_parent(rli, false))
+      {
+        llstr(rli->get_event_relay_log_pos(), llbuff);
+        my_error(ER_MTS_CANT_PARALLEL, MYF(0),
+                 get_type_str(), rli->get_event_relay_log_name(), llbuff,
+                 "the Coordinator was killed while waiting for "
+                 "preceding transactions");
+        return ret_worker;
+      }
+      /*
+        A row-based group of known timestamps needs no partitions at all
+        and goes to the least busy Worker.  Statements still go through
+        the partitions as they may use temporary tables.
+      */
+      if (rli->mts_sequence_number != 0 &&
+          get_type_code() == TABLE_MAP_EVENT)
+        ret_worker= get_least_busy_worker(&rli->workers);
+    }
+
+    /* a row event of a group scheduled by the logical clock */
+    bool clock_group= ret_worker &&
+      rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK &&
+      get_type_code() == TABLE_MAP_EVENT &&
+      rli->curr_group_assigned_parts.elements == 0;
+
+    if (clock_group)
+    {
+      for (i= 0; i < mts_dbs.num; i++)
+        mts_assigned_partitions[i]= NULL;
+    }
+    else if (mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS)
     {
       // Worker with id 0 to handle serial execution
       if (!ret_worker)
@@ -2832,7 +2883,8 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
     }
 
     /* One run of the loop in the case of over-max-db:s */
-    for (i= 0; i < ((mts_dbs.num != OVER_MAX_DBS_IN_EVENT_MTS) ? mts_dbs.num : 1);
+    for (i= 0; !clock_group &&
+           i < ((mts_dbs.num != OVER_MAX_DBS_IN_EVENT_MTS) ? mts_dbs.num : 1);
          i++)
     {
       /*
@@ -2872,11 +2924,14 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
         worker_id == MTS_WORKER_UNDEF)
     {
       ptr_group->worker_id= ret_worker->id;
+      if (rli->commit_order_mngr)
+        rli->commit_order_mngr->register_trx(ret_worker);
 
       DBUG_ASSERT(ptr_group->group_relay_log_name == NULL);
     }
 
-    DBUG_ASSERT(i == mts_dbs.num || mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS);
+    DBUG_ASSERT(i == mts_dbs.num || mts_dbs.num == OVER_MAX_DBS_IN_EVENT_MTS ||
+                clock_group);
   }
   else
   {
@@ -2886,7 +2941,8 @@ Slave_worker *Log_event::get_slave_worker(Relay_log_info *rli)
       ret_worker= rli->last_assigned_worker;
 
       DBUG_ASSERT(rli->curr_group_assigned_parts.elements > 0 ||
-                  ret_worker->id == 0);
+                  ret_worker->id == 0 ||
+                  rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK);
     }
     else // int_, rand_, user_ var:s, load-data events
     {
@@ -13778,6 +13834,17 @@ Gtid_log_event::Gtid_log_event(const char *buffer, uint event_len,
   spec.gtid.gno= uint8korr(ptr_buffer);
   ptr_buffer+= ENCODED_GNO_LENGTH;
 
+  last_committed= sequence_number= 0;
+  if (buffer + event_len - ptr_buffer >= LOGICAL_TIMESTAMP_LENGTH &&
+      (uchar) *ptr_buffer == LOGICAL_TIMESTAMP_TYPECODE)
+  {
+    ptr_buffer++;
+    last_committed= sint8korr(ptr_buffer);
+    ptr_buffer+= 8;
+    sequence_number= sint8korr(ptr_buffer);
+    ptr_buffer+= 8;
+  }
+
   DBUG_VOID_RETURN;
 }
 
@@ -13788,7 +13855,7 @@ Gtid_log_event::Gtid_log_event(THD* thd_arg, bool using_trans,
             LOG_EVENT_IGNORABLE_F : 0,
             using_trans ? Log_event::EVENT_TRANSACTIONAL_CACHE :
             Log_event::EVENT_STMT_CACHE, Log_event::EVENT_NORMAL_LOGGING),
-  commit_flag(true)
+  last_committed(0), sequence_number(0), commit_flag(true)
 {
   DBUG_ENTER("Gtid_log_event::Gtid_log_event(THD *)");
   spec= spec_arg ? *spec_arg : thd_arg->variables.gtid_next;
@@ -13840,7 +13907,15 @@ Gtid_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
   if (!print_event_info->short_form)
   {
     print_header(head, print_event_info, FALSE);
-    my_b_printf(head, "\tGTID [commit=%s]\n", commit_flag ? "yes" : "no");
+    my_b_printf(head, "\tGTID [commit=%s]", commit_flag ? "yes" : "no");
+    if (has_logical_timestamps())
+    {
+      char llbuff1[22], llbuff2[22];
+      my_b_printf(head, "\tlast_committed=%s\tsequence_number=%s",
+                  llstr(last_committed, llbuff1),
+                  llstr(sequence_number, llbuff2));
+    }
+    my_b_printf(head, "\n");
   }
   to_string(buffer);
   my_b_printf(head, "%s%s\n", buffer, print_event_info->delimiter);
@@ -13873,6 +13948,29 @@ bool Gtid_log_event::write_data_header(IO_CACHE *file)
   DBUG_ASSERT(ptr_buffer == (buffer + sizeof(buffer)));
   DBUG_RETURN(wrapper_my_b_safe_write(file, (uchar *) buffer, sizeof(buffer)));
 }
+
+bool Gtid_log_event::write_data_body(IO_CACHE *file)
+{
+  DBUG_ENTER("Gtid_log_event::write_data_body");
+  uchar buffer[LOGICAL_TIMESTAMP_LENGTH];
+  uchar* ptr_buffer= buffer;
+
+  /*
+    The body has a fixed size so that the Gtid event written into the
+    cache at the beginning of the group can be rewritten in place when
+    the timestamps are assigned at flush time.
+  */
+  *ptr_buffer++= LOGICAL_TIMESTAMP_TYPECODE;
+  int8store(ptr_buffer, last_committed);
+  ptr_buffer+= 8;
+  int8store(ptr_buffer, sequence_number);
+  ptr_buffer+= 8;
+
+  DBUG_PRINT("info", ("last_committed=%lld sequence_number=%lld",
+                      last_committed, sequence_number));
+  DBUG_ASSERT(ptr_buffer == (buffer + sizeof(buffer)));
+  DBUG_RETURN(wrapper_my_b_safe_write(file, buffer, sizeof(buffer)));
+}
 #endif // MYSQL_SERVER
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
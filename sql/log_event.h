@@ -1610,6 +1610,12 @@ public:
 
   virtual int do_apply_event_worker(Slave_worker *w);
 
+  /**
+    Prepares an applied event to be applied once more, when a Worker
+    rolls back its group and retries it.
+  */
+  virtual void rewind_apply() {}
+
 protected:
 
   /**
@@ -4158,6 +4164,14 @@ public:
   virtual bool write_data_body(IO_CACHE *file);
   virtual const char *get_db() { return m_table->s->db.str; }
 #endif
+
+#if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
+  virtual void rewind_apply()
+  {
+    m_curr_row= m_rows_buf;
+    m_curr_row_end= NULL;
+  }
+#endif
   /*
     Check that malloc() succeeded in allocating memory for the rows
     buffer and the COLS vector. Checking that an Update_rows_log_event
@@ -4988,7 +5002,7 @@ public:
     DBUG_RETURN(ret);
   }
 
-  int get_data_size() { return POST_HEADER_LENGTH; }
+  int get_data_size() { return POST_HEADER_LENGTH + LOGICAL_TIMESTAMP_LENGTH; }
 
 private:
   /// Used internally by both print() and pack_info().
@@ -5000,6 +5014,7 @@ public:
 #endif
 #ifdef MYSQL_SERVER
   bool write_data_header(IO_CACHE *file);
+  bool write_data_body(IO_CACHE *file);
 #endif
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
@@ -5007,6 +5022,22 @@ public:
   int do_update_pos(Relay_log_info *rli);
 #endif
 
+  /**
+    Set the logical timestamps of the group, see @c last_committed
+    and @c sequence_number.
+  */
+  void set_logical_timestamps(int64 last_committed_arg,
+                              int64 sequence_number_arg)
+  {
+    last_committed= last_committed_arg;
+    sequence_number= sequence_number_arg;
+  }
+  /**
+    Return true if the event carries a commit parent, that is the
+    master assigned logical timestamps to the group.
+  */
+  bool has_logical_timestamps() const { return sequence_number > 0; }
+
   /**
     Return the group type for this Gtid_log_event: this can be
     either ANONYMOUS_GROUP, AUTOMATIC_GROUP, or GTID_GROUP.
@@ -5082,11 +5113,32 @@ private:
   static const int ENCODED_SID_LENGTH= rpl_sid::BYTE_LENGTH;
   /// Length of GNO in event encoding
   static const int ENCODED_GNO_LENGTH= 8;
+  /// Type code of the logical timestamps in the event body
+  static const uchar LOGICAL_TIMESTAMP_TYPECODE= 2;
 
 public:
   /// Total length of post header
   static const int POST_HEADER_LENGTH=
     ENCODED_FLAG_LENGTH + ENCODED_SID_LENGTH + ENCODED_GNO_LENGTH;
+  /**
+    Length of the event body: type code, last_committed and
+    sequence_number.  The body follows the post header so that
+    servers which do not know about it skip it.
+  */
+  static const int LOGICAL_TIMESTAMP_LENGTH= 1 + 8 + 8;
+
+  /**
+    Sequence number of the most recent group that was flushed to the
+    binary log when this group started to commit.  Groups whose
+    sequence numbers are greater than this did not hold conflicting
+    locks, so the slave can apply them in parallel with this one.
+  */
+  int64 last_committed;
+  /**
+    Position of this group in the binary log file, starting from 1.
+    Zero means the group carries no logical timestamps.
+  */
+  int64 sequence_number;
 
 private:
   /**
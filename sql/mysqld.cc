@@ -50,6 +50,7 @@
 #include "sql_test.h"     // mysql_print_status
 #include "item_create.h"  // item_create_cleanup, item_create_init
 #include "sql_servers.h"  // servers_free, servers_init
+#include "histogram.h"    // histograms_free, histograms_init
 #include "init.h"         // unireg_init
 #include "derror.h"       // init_errmessage
 #include "derror.h"       // init_errmessage
@@ -537,6 +538,8 @@ uint  slave_net_timeout;
 ulong slave_exec_mode_options;
 ulonglong slave_type_conversions_options;
 ulong opt_mts_slave_parallel_workers;
+ulong opt_mts_parallel_type;
+my_bool opt_slave_preserve_commit_order;
 ulonglong opt_mts_pending_jobs_size_max;
 ulonglong slave_rows_search_algorithms_options;
 #ifndef DBUG_OFF
@@ -1276,7 +1279,8 @@ int deny_severity = LOG_WARNING;
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
 my_bool opt_query_cache_strip_comments= FALSE;
-Query_cache query_cache;
+uint query_cache_shards= 1;
+Query_cache_shards query_cache;
 #endif
 #ifdef HAVE_SMEM
 char *shared_memory_base_name= default_shared_memory_base_name;
@@ -1944,6 +1948,7 @@ void clean_up(bool print_message)
   my_tz_free();
   my_dboptions_cache_free();
   ignore_db_dirs_free();
+  histograms_free();
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   servers_free(1);
   acl_free(1);
@@ -1986,6 +1991,7 @@ void clean_up(bool print_message)
   free_global_thread_stats();
   free_global_table_stats();
   free_global_index_stats();
+  free_userstat_shards();
 #endif
 #ifdef HAVE_REPLICATION
   end_slave_list();
@@ -2113,6 +2119,7 @@ static void clean_up_mutexes()
   mysql_mutex_destroy(&LOCK_global_table_stats);
   mysql_mutex_destroy(&LOCK_global_index_stats);
   mysql_rwlock_destroy(&LOCK_consistent_snapshot);
+  binlog_dump_ring.cleanup();
   mysql_cond_destroy(&COND_connection_count);
 }
 #endif /*EMBEDDED_LIBRARY*/
@@ -4574,6 +4581,7 @@ static int init_thread_environment()
   mysql_rwlock_init(key_rwlock_LOCK_grant, &LOCK_grant);
   mysql_rwlock_init(key_rwlock_LOCK_consistent_snapshot,
                     &LOCK_consistent_snapshot);
+  binlog_dump_ring.init();
   mysql_cond_init(key_COND_thread_count, &COND_thread_count, NULL);
   mysql_cond_init(key_COND_connection_count, &COND_connection_count, NULL);
   mysql_cond_init(key_COND_thread_cache, &COND_thread_cache, NULL);
@@ -4991,8 +4999,8 @@ static int init_server_components()
   have_statement_timeout= SHOW_OPTION_NO;
 #endif
 
-  query_cache_set_min_res_unit(query_cache_min_res_unit);
   query_cache_init();
+  query_cache_set_min_res_unit(query_cache_min_res_unit);
   query_cache_resize(query_cache_size);
   randominit(&sql_rand,(ulong) server_start_time,(ulong) server_start_time/2);
   setup_fpu();
@@ -5004,6 +5012,7 @@ static int init_server_components()
 #ifndef EMBEDDED_LIBRARY
   init_global_table_stats();
   init_global_index_stats();
+  init_userstat_shards();
 #endif
 
   /* Setup logs */
@@ -5413,6 +5422,12 @@ a file name for --log-bin-index option", opt_binlog_index_name);
 
   if (opt_bin_log)
   {
+    if (binlog_dump_ring.resize(opt_binlog_dump_ring_size))
+    {
+      sql_print_error("Could not allocate the binlog dump ring of %lu bytes",
+                      opt_binlog_dump_ring_size);
+      unireg_abort(1);
+    }
     /*
       Configures what object is used by the current log to store processed
       gtid(s). This is necessary in the MYSQL_BIN_LOG::MYSQL_BIN_LOG to
@@ -5997,6 +6012,8 @@ int mysqld_main(int argc, char **argv)
   if (!opt_bootstrap)
     servers_init(0);
 
+  (void) histograms_init(opt_bootstrap);
+
   if (!opt_noacl)
   {
 #ifdef HAVE_DLOPEN
@@ -7894,6 +7911,58 @@ static int show_flushstatustime(THD *thd, SHOW_VAR *var, char *buff)
 }
 #endif
 
+#ifdef HAVE_QUERY_CACHE
+/* Query cache statistics are kept per shard and summed up here. */
+static int show_qcache_stat(SHOW_VAR *var, char *buff,
+                            ulong Query_cache::*counter)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((ulong *)buff)= query_cache.stat_sum(counter);
+  return 0;
+}
+
+static int show_qcache_free_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::free_memory_blocks);
+}
+
+static int show_qcache_free_memory(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::free_memory);
+}
+
+static int show_qcache_hits(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::hits);
+}
+
+static int show_qcache_inserts(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::inserts);
+}
+
+static int show_qcache_lowmem_prunes(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::lowmem_prunes);
+}
+
+static int show_qcache_not_cached(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::refused);
+}
+
+static int show_qcache_queries_in_cache(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::queries_in_cache);
+}
+
+static int show_qcache_total_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_stat(var, buff, &Query_cache::total_blocks);
+}
+#endif /* HAVE_QUERY_CACHE */
+
 #ifdef HAVE_REPLICATION
 static int show_slave_running(THD *thd, SHOW_VAR *var, char *buff)
 {
@@ -8395,6 +8464,8 @@ SHOW_VAR status_vars[]= {
   {"Aborted_connects",         (char*) &aborted_connects,       SHOW_LONG},
   {"Binlog_cache_disk_use",    (char*) &binlog_cache_disk_use,  SHOW_LONG},
   {"Binlog_cache_use",         (char*) &binlog_cache_use,       SHOW_LONG},
+  {"Binlog_dump_ring_hits",    (char*) offsetof(STATUS_VAR, binlog_dump_ring_hits), SHOW_LONGLONG_STATUS},
+  {"Binlog_dump_ring_misses",  (char*) offsetof(STATUS_VAR, binlog_dump_ring_misses), SHOW_LONGLONG_STATUS},
   {"Binlog_stmt_cache_disk_use",(char*) &binlog_stmt_cache_disk_use,  SHOW_LONG},
   {"Binlog_stmt_cache_use",    (char*) &binlog_stmt_cache_use,       SHOW_LONG},
   {"Bytes_received",           (char*) offsetof(STATUS_VAR, bytes_received), SHOW_LONGLONG_STATUS},
@@ -8454,16 +8525,19 @@ SHOW_VAR status_vars[]= {
   {"Opened_files",             (char*) &my_file_total_opened, SHOW_LONG_NOFLUSH},
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONGLONG_STATUS},
   {"Opened_table_definitions", (char*) offsetof(STATUS_VAR, opened_shares), SHOW_LONGLONG_STATUS},
+  {"Plan_cache_hits",          (char*) offsetof(STATUS_VAR, plan_cache_hits), SHOW_LONGLONG_STATUS},
+  {"Plan_cache_invalidations", (char*) offsetof(STATUS_VAR, plan_cache_invalidations), SHOW_LONGLONG_STATUS},
+  {"Plan_cache_misses",        (char*) offsetof(STATUS_VAR, plan_cache_misses), SHOW_LONGLONG_STATUS},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_FUNC},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache_free_blocks",       (char*) &show_qcache_free_blocks, SHOW_FUNC},
+  {"Qcache_free_memory",       (char*) &show_qcache_free_memory, SHOW_FUNC},
+  {"Qcache_hits",              (char*) &show_qcache_hits,       SHOW_FUNC},
+  {"Qcache_inserts",           (char*) &show_qcache_inserts,    SHOW_FUNC},
+  {"Qcache_lowmem_prunes",     (char*) &show_qcache_lowmem_prunes, SHOW_FUNC},
+  {"Qcache_not_cached",        (char*) &show_qcache_not_cached, SHOW_FUNC},
+  {"Qcache_queries_in_cache",  (char*) &show_qcache_queries_in_cache, SHOW_FUNC},
+  {"Qcache_total_blocks",      (char*) &show_qcache_total_blocks, SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONGLONG_STATUS},
@@ -8541,6 +8615,8 @@ SHOW_VAR status_vars[]= {
   {"Threads_connected",        (char*) &connection_count,       SHOW_INT},
   {"Threads_created",        (char*) &thread_created,   SHOW_LONG_NOFLUSH},
   {"Threads_running",          (char*) &num_thread_running,     SHOW_INT},
+  {"Tmp_table_disk_spill_bytes",(char*) offsetof(STATUS_VAR, tmp_table_disk_spill_bytes), SHOW_LONGLONG_STATUS},
+  {"Tmp_table_disk_spills",    (char*) offsetof(STATUS_VAR, tmp_table_disk_spills), SHOW_LONGLONG_STATUS},
   {"Uptime",                   (char*) &show_starttime,         SHOW_FUNC},
 #ifdef ENABLED_PROFILING
   {"Uptime_since_flush_status",(char*) &show_flushstatustime,   SHOW_FUNC},
@@ -10159,6 +10235,10 @@ void refresh_status(THD *thd)
 
   /* Reset the counters of all key caches (default and named). */
   process_key_caches(reset_key_cache_counters);
+#ifdef HAVE_QUERY_CACHE
+  /* The query cache counters are summed over its shards, reset them too. */
+  query_cache.reset_counters();
+#endif
   flush_status_time= time((time_t*) 0);
   mysql_mutex_unlock(&LOCK_status);
 
@@ -10204,6 +10284,7 @@ PSI_mutex_key
   key_LOCK_delayed_insert, key_LOCK_delayed_status, key_LOCK_error_log,
   key_LOCK_global_user_client_stats,
   key_LOCK_global_table_stats, key_LOCK_global_index_stats,
+  key_LOCK_userstat_shard,
   key_LOCK_gdl, key_LOCK_global_system_variables,
   key_LOCK_manager,
   key_LOCK_prepared_stmt_count,
@@ -10220,7 +10301,9 @@ PSI_mutex_key
   key_mutex_slave_parallel_pend_jobs, key_mutex_mts_temp_tables_lock,
   key_mutex_slave_parallel_worker_count,
   key_mutex_slave_parallel_worker,
-  key_structure_guard_mutex, key_TABLE_SHARE_LOCK_ha_data,
+  key_mutex_slave_commit_order_manager,
+  key_structure_guard_mutex, key_queries_list_mutex,
+  key_TABLE_SHARE_LOCK_ha_data,
   key_LOCK_error_messages, key_LOG_INFO_lock, key_LOCK_thread_count,
   key_LOCK_log_throttle_qni;
 PSI_mutex_key key_LOCK_thd_remove;
@@ -10283,6 +10366,7 @@ static PSI_mutex_info all_server_mutexes[]=
      "LOCK_global_table_stats", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_index_stats,
     "LOCK_global_index_stats", PSI_FLAG_GLOBAL},
+  { &key_LOCK_userstat_shard, "LOCK_userstat_shard", 0},
   { &key_LOCK_gdl, "LOCK_gdl", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_system_variables, "LOCK_global_system_variables", PSI_FLAG_GLOBAL},
   { &key_LOCK_manager, "LOCK_manager", PSI_FLAG_GLOBAL},
@@ -10311,7 +10395,9 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_mutex_slave_parallel_worker_count, "Relay_log_info::exit_count_lock", 0},
   { &key_mutex_mts_temp_tables_lock, "Relay_log_info::temp_tables_lock", 0},
   { &key_mutex_slave_parallel_worker, "Worker_info::jobs_lock", 0},
+  { &key_mutex_slave_commit_order_manager, "Commit_order_manager::m_mutex", 0},
   { &key_structure_guard_mutex, "Query_cache::structure_guard_mutex", 0},
+  { &key_queries_list_mutex, "Query_cache::queries_list_mutex", 0},
   { &key_TABLE_SHARE_LOCK_ha_data, "TABLE_SHARE::LOCK_ha_data", 0},
   { &key_LOCK_error_messages, "LOCK_error_messages", PSI_FLAG_GLOBAL},
   { &key_LOG_INFO_lock, "LOG_INFO::lock", 0},
@@ -10325,7 +10411,8 @@ static PSI_mutex_info all_server_mutexes[]=
 PSI_rwlock_key key_rwlock_LOCK_grant, key_rwlock_LOCK_logger,
   key_rwlock_LOCK_sys_init_connect, key_rwlock_LOCK_sys_init_slave,
   key_rwlock_LOCK_system_variables_hash, key_rwlock_query_cache_query_lock,
-  key_rwlock_global_sid_lock, key_rwlock_LOCK_consistent_snapshot;
+  key_rwlock_global_sid_lock, key_rwlock_LOCK_consistent_snapshot,
+  key_rwlock_binlog_dump_ring;
 
 PSI_rwlock_key key_rwlock_Trans_delegate_lock;
 PSI_rwlock_key key_rwlock_Binlog_storage_delegate_lock;
@@ -10352,7 +10439,8 @@ static PSI_rwlock_info all_server_rwlocks[]=
   { &key_rwlock_global_sid_lock, "gtid_commit_rollback", PSI_FLAG_GLOBAL},
   { &key_rwlock_Trans_delegate_lock, "Trans_delegate::lock", PSI_FLAG_GLOBAL},
   { &key_rwlock_Binlog_storage_delegate_lock, "Binlog_storage_delegate::lock", PSI_FLAG_GLOBAL},
-  { &key_rwlock_LOCK_consistent_snapshot, "LOCK_consistent_snapshot", PSI_FLAG_GLOBAL}
+  { &key_rwlock_LOCK_consistent_snapshot, "LOCK_consistent_snapshot", PSI_FLAG_GLOBAL},
+  { &key_rwlock_binlog_dump_ring, "Binlog_dump_ring::m_lock", PSI_FLAG_GLOBAL}
 };
 
 #ifdef HAVE_MMAP
@@ -10369,7 +10457,7 @@ PSI_cond_key key_BINLOG_update_cond,
   key_relay_log_info_data_cond, key_relay_log_info_log_space_cond,
   key_relay_log_info_start_cond, key_relay_log_info_stop_cond,
   key_relay_log_info_sleep_cond, key_cond_slave_parallel_pend_jobs,
-  key_cond_slave_parallel_worker,
+  key_cond_slave_parallel_worker, key_cond_slave_commit_order_manager,
   key_TABLE_SHARE_cond, key_user_level_lock_cond,
   key_COND_thread_count, key_COND_thread_cache, key_COND_flush_thread_cache,
   key_COND_connection_count;
@@ -10413,6 +10501,7 @@ static PSI_cond_info all_server_conds[]=
   { &key_relay_log_info_sleep_cond, "Relay_log_info::sleep_cond", 0},
   { &key_cond_slave_parallel_pend_jobs, "Relay_log_info::pending_jobs_cond", 0},
   { &key_cond_slave_parallel_worker, "Worker_info::jobs_cond", 0},
+  { &key_cond_slave_commit_order_manager, "Commit_order_manager::cond", 0},
   { &key_TABLE_SHARE_cond, "TABLE_SHARE::cond", 0},
   { &key_user_level_lock_cond, "User_level_lock::cond", 0},
   { &key_COND_thread_count, "COND_thread_count", PSI_FLAG_GLOBAL},
@@ -10605,6 +10694,8 @@ PSI_stage_info stage_slave_waiting_worker_to_release_partition= { 0, "Waiting fo
 PSI_stage_info stage_slave_waiting_worker_to_free_events= { 0, "Waiting for Slave Workers to free pending events", 0};
 PSI_stage_info stage_slave_waiting_worker_queue= { 0, "Waiting for Slave Worker queue", 0};
 PSI_stage_info stage_slave_waiting_event_from_coordinator= { 0, "Waiting for an event from Coordinator", 0};
+PSI_stage_info stage_slave_waiting_for_dependent_transaction_to_commit= { 0, "Waiting for dependent transaction to commit", 0};
+PSI_stage_info stage_slave_waiting_for_preceding_transaction_to_commit= { 0, "Waiting for its turn to commit", 0};
 PSI_stage_info stage_restoring_secondary_keys= { 0, "restoring secondary keys", 0};
 
 #ifdef HAVE_PSI_INTERFACE
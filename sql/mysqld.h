@@ -202,6 +202,7 @@ extern ulong delayed_insert_threads, delayed_insert_writes;
 extern ulong delayed_rows_in_use,delayed_insert_errors;
 extern int32 slave_open_temp_tables;
 extern ulong query_cache_size, query_cache_min_res_unit;
+extern uint query_cache_shards;
 extern ulong slow_launch_threads, slow_launch_time;
 extern ulong table_cache_size, table_def_size;
 extern ulong table_cache_size_per_instance, table_cache_instances;
@@ -214,6 +215,8 @@ extern LEX_CSTRING reason_slave_blocked;
 extern ulong slave_trans_retries;
 extern uint  slave_net_timeout;
 extern ulong opt_mts_slave_parallel_workers;
+extern ulong opt_mts_parallel_type;
+extern my_bool opt_slave_preserve_commit_order;
 extern ulonglong opt_mts_pending_jobs_size_max;
 extern uint max_user_connections;
 extern ulong extra_max_connections;
@@ -369,6 +372,7 @@ extern PSI_mutex_key
   key_LOCK_delayed_insert, key_LOCK_delayed_status, key_LOCK_error_log,
   key_LOCK_global_user_client_stats,
   key_LOCK_global_table_stats, key_LOCK_global_index_stats,
+  key_LOCK_userstat_shard,
   key_LOCK_gdl, key_LOCK_global_system_variables,
   key_LOCK_lock_db, key_LOCK_logger, key_LOCK_manager,
   key_LOCK_prepared_stmt_count,
@@ -385,7 +389,9 @@ extern PSI_mutex_key
   key_mutex_slave_parallel_pend_jobs, key_mutex_mts_temp_tables_lock,
   key_mutex_slave_parallel_worker,
   key_mutex_slave_parallel_worker_count,
-  key_structure_guard_mutex, key_TABLE_SHARE_LOCK_ha_data,
+  key_mutex_slave_commit_order_manager,
+  key_structure_guard_mutex, key_queries_list_mutex,
+  key_TABLE_SHARE_LOCK_ha_data,
   key_LOCK_error_messages, key_LOCK_thread_count, key_LOCK_thd_remove,
   key_LOCK_log_throttle_qni;
 extern PSI_mutex_key key_RELAYLOG_LOCK_commit;
@@ -404,7 +410,8 @@ extern PSI_mutex_key key_LOCK_thread_created;
 extern PSI_rwlock_key key_rwlock_LOCK_grant, key_rwlock_LOCK_logger,
   key_rwlock_LOCK_sys_init_connect, key_rwlock_LOCK_sys_init_slave,
   key_rwlock_LOCK_system_variables_hash, key_rwlock_query_cache_query_lock,
-  key_rwlock_global_sid_lock, key_rwlock_LOCK_consistent_snapshot;
+  key_rwlock_global_sid_lock, key_rwlock_LOCK_consistent_snapshot,
+  key_rwlock_binlog_dump_ring;
 
 #ifdef HAVE_MMAP
 extern PSI_cond_key key_PAGE_cond, key_COND_active, key_COND_pool;
@@ -420,7 +427,7 @@ extern PSI_cond_key key_BINLOG_update_cond,
   key_relay_log_info_data_cond, key_relay_log_info_log_space_cond,
   key_relay_log_info_start_cond, key_relay_log_info_stop_cond,
   key_relay_log_info_sleep_cond, key_cond_slave_parallel_pend_jobs,
-  key_cond_slave_parallel_worker,
+  key_cond_slave_parallel_worker, key_cond_slave_commit_order_manager,
   key_TABLE_SHARE_cond, key_user_level_lock_cond,
   key_COND_thread_count, key_COND_thread_cache, key_COND_flush_thread_cache,
   key_COND_connection_count;
@@ -560,6 +567,8 @@ extern PSI_stage_info stage_slave_waiting_worker_to_free_events;
 extern PSI_stage_info stage_slave_waiting_worker_queue;
 extern PSI_stage_info stage_slave_waiting_event_from_coordinator;
 extern PSI_stage_info stage_slave_waiting_workers_to_exit;
+extern PSI_stage_info stage_slave_waiting_for_dependent_transaction_to_commit;
+extern PSI_stage_info stage_slave_waiting_for_preceding_transaction_to_commit;
 extern PSI_stage_info stage_restoring_secondary_keys;
 #ifdef HAVE_PSI_STATEMENT_INTERFACE
 /**
@@ -633,6 +642,33 @@ extern mysql_mutex_t
        LOCK_sql_slave_skip_counter, LOCK_slave_net_timeout,
        LOCK_global_user_client_stats,
        LOCK_global_table_stats, LOCK_global_index_stats;
+
+/* Number of shards of the statement-level userstat counters */
+#define USERSTAT_SHARDS 64
+
+/*
+  The user, client, thread, table and index statistics of a statement are
+  added to the shard of its thread rather than to the global_*_stats
+  hashes, so that concurrent sessions do not serialize on
+  LOCK_global_user_client_stats, LOCK_global_table_stats and
+  LOCK_global_index_stats at the end of every statement.  The shards are
+  merged into the global hashes when those are read or flushed.
+*/
+typedef struct st_userstat_shard {
+  mysql_mutex_t lock;
+  HASH user_stats;       // USER_STATS deltas by user name
+  HASH client_stats;     // USER_STATS deltas by client host
+  HASH thread_stats;     // THREAD_STATS deltas by thread id
+  HASH table_stats;      // TABLE_STATS deltas by [db].[table]
+  HASH index_stats;      // INDEX_STATS deltas by [db].[table].[index]
+} MY_ATTRIBUTE((aligned(CPU_LEVEL1_DCACHE_LINESIZE))) USERSTAT_SHARD;
+
+extern USERSTAT_SHARD userstat_shards[USERSTAT_SHARDS];
+
+inline USERSTAT_SHARD *get_userstat_shard(my_thread_id thread_id)
+{
+  return &userstat_shards[thread_id % USERSTAT_SHARDS];
+}
 #ifdef HAVE_OPENSSL
 extern char* des_key_file;
 extern mysql_mutex_t LOCK_des_key_file;
@@ -778,6 +814,12 @@ void free_global_table_stats(void);
 void free_global_index_stats(void);
 void free_global_client_stats(void);
 void free_global_thread_stats(void);
+void init_userstat_shards(void);
+void free_userstat_shards(void);
+void merge_user_client_stats_shards(void);
+void merge_table_stats_shards(void);
+void merge_index_stats_shards(void);
+void clear_userstat_shards(ulong options);
 
 void refresh_concurrent_conn_stats();
 
@@ -1418,7 +1418,7 @@ bool Explain_join::explain_rows_and_filtered()
   {
     float f= 0.0;
     if (examined_rows)
-      f= 100.0 * tab->position->records_read / examined_rows;
+      f= 100.0 * tab->position->fanout() / examined_rows;
     fmt->entry()->col_filtered.set(f);
   }
   return false;
@@ -1588,6 +1588,8 @@ bool Explain_join::explain_extra()
       StringBuffer<64> buff(cs);
       if ((tab->use_join_cache & JOIN_CACHE::ALG_BNL))
         buff.append("Block Nested Loop");
+      else if ((tab->use_join_cache & JOIN_CACHE::ALG_HASH))
+        buff.append("Hash Join");
       else if ((tab->use_join_cache & JOIN_CACHE::ALG_BKA))
         buff.append("Batched Key Access");
       else if ((tab->use_join_cache & JOIN_CACHE::ALG_BKA_UNIQUE))
@@ -1598,6 +1600,9 @@ bool Explain_join::explain_extra()
         return true;
     }
   }
+  if (tab->histograms_used && push_extra(ET_USING_HISTOGRAM,
+                                         tab->histograms_used))
+    return true;
   return false;
 }
 
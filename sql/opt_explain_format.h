@@ -99,6 +99,7 @@ enum Extra_tag
   ET_UNIQUE_ROW_NOT_FOUND,
   ET_IMPOSSIBLE_ON_CONDITION,
   ET_PUSHED_JOIN,
+  ET_USING_HISTOGRAM,
   //------------------------------------
   ET_total
 };
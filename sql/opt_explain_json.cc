@@ -53,7 +53,8 @@ static const char *json_extra_tags[ET_total]=
   "const_row_not_found",                // ET_CONST_ROW_NOT_FOUND
   "unique_row_not_found",               // ET_UNIQUE_ROW_NOT_FOUND
   "impossible_on_condition",            // ET_IMPOSSIBLE_ON_CONDITION
-  "pushed_join"                         // ET_PUSHED_JOIN
+  "pushed_join",                        // ET_PUSHED_JOIN
+  "using_histogram"                     // ET_USING_HISTOGRAM
 };
 
 
@@ -52,7 +52,8 @@ static const char *traditional_extra_tags[ET_total]=
   "const row not found",               // ET_CONST_ROW_NOT_FOUND
   "unique row not found",              // ET_UNIQUE_ROW_NOT_FOUND
   "Impossible ON condition",           // ET_IMPOSSIBLE_ON_CONDITION
-  ""                                   // ET_PUSHED_JOIN
+  "",                                  // ET_PUSHED_JOIN
+  "Using histogram on"                 // ET_USING_HISTOGRAM
 };
 
 
@@ -28,6 +28,8 @@
 #include "rpl_master.h"
 #include "debug_sync.h"
 
+using std::max;
+
 int max_binlog_dump_events = 0; // unlimited
 my_bool opt_sporadic_binlog_dump_fail = 0;
 
@@ -828,6 +830,43 @@ error_malformed_packet:
 }
 
 
+/**
+  Read the next event of the binary log being sent to the slave.
+
+  The event is taken from the binlog dump ring when the ring still holds
+  it, and read from the log file otherwise. Arguments are the same as
+  for Log_event::read_log_event(). A ring read does not touch
+  @c is_binlog_active, as it never reports the end of the log.
+*/
+static int read_dump_event(THD *thd, IO_CACHE *log, String *packet,
+                           mysql_mutex_t *log_lock, uint8 checksum_alg,
+                           const char *log_file_name,
+                           bool *is_binlog_active)
+{
+  if (opt_binlog_dump_ring_size &&
+      !DBUG_EVALUATE_IF("corrupt_read_log_event", 1, 0))
+  {
+    my_off_t pos= my_b_tell(log);
+    uint32 length= packet->length();
+    ulong max_event_len= max(thd->variables.max_allowed_packet,
+                             opt_binlog_rows_event_max_size +
+                             MAX_LOG_EVENT_HEADER);
+
+    if (binlog_dump_ring.read_event(log_file_name, pos, packet,
+                                    max_event_len))
+    {
+      my_b_seek(log, pos + (packet->length() - length));
+      status_var_increment(thd->status_var.binlog_dump_ring_hits);
+      return 0;
+    }
+    status_var_increment(thd->status_var.binlog_dump_ring_misses);
+  }
+  return Log_event::read_log_event(log, packet, log_lock, checksum_alg,
+                                   is_binlog_active ? log_file_name : NULL,
+                                   is_binlog_active);
+}
+
+
 void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
                        const Gtid_set* slave_gtid_executed, int flags)
 {
@@ -1242,10 +1281,10 @@ void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
                     };);
     bool is_active_binlog= false;
     while (!thd->killed &&
-           !(error= Log_event::read_log_event(&log, packet, log_lock,
-                                              current_checksum_alg,
-                                              log_file_name,
-                                              &is_active_binlog)))
+           !(error= read_dump_event(thd, &log, packet, log_lock,
+                                    current_checksum_alg,
+                                    log_file_name,
+                                    &is_active_binlog)))
     {
       DBUG_EXECUTE_IF("simulate_dump_thread_kill",
                       {
@@ -1631,8 +1670,9 @@ void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
 	*/
 
         mysql_mutex_lock(log_lock);
-        switch (error= Log_event::read_log_event(&log, packet, (mysql_mutex_t*) 0,
-                                                 current_checksum_alg)) {
+        switch (error= read_dump_event(thd, &log, packet, (mysql_mutex_t*) 0,
+                                       current_checksum_alg, log_file_name,
+                                       NULL)) {
 	case 0:
           DBUG_PRINT("info", ("read_log_event returned 0 on line %d",
                               __LINE__));
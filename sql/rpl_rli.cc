@@ -98,6 +98,8 @@ Relay_log_info::Relay_log_info(bool is_slave_recovery
    checkpoint_group(opt_mts_checkpoint_group),
    recovery_groups_inited(false), mts_recovery_group_cnt(0),
    mts_recovery_index(0), mts_recovery_group_seen_begin(0),
+   mts_parallel_type(MTS_PARALLEL_TYPE_DB_NAME),
+   mts_last_committed(0), mts_sequence_number(0), commit_order_mngr(NULL),
    mts_group_status(MTS_NOT_IN_GROUP), reported_unsafe_warning(false),
    rli_description_event(NULL),
    sql_delay(0), sql_delay_end(0), m_flags(0), row_stmt_start_timestamp(0),
@@ -157,6 +159,8 @@ void Relay_log_info::init_workers(ulong n_workers)
   */
   mts_groups_assigned= mts_events_assigned= pending_jobs= wq_size_waits_cnt= 0;
   mts_wq_excess_cnt= mts_wq_no_underrun_cnt= mts_wq_overfill_cnt= 0;
+  mts_clock_waits_cnt= 0;
+  mts_clock_wait_time= 0;
   mts_last_online_stat= 0;
   my_init_dynamic_array(&workers, sizeof(Slave_worker *), n_workers, 4);
 }
@@ -28,6 +28,7 @@
 
 struct RPL_TABLE_LIST;
 class Master_info;
+class Commit_order_manager;
 extern uint sql_slave_skip_counter;
 
 /*******************************************************************************
@@ -545,6 +546,15 @@ public:
   ulong mts_recovery_group_cnt; // number of groups to execute at recovery
   ulong mts_recovery_index;     // running index of recoverable groups
   bool mts_recovery_group_seen_begin;
+  ulong mts_parallel_type;  // cache for ::opt_mts_parallel_type
+  /*
+    Logical timestamps of the group being scheduled, taken from its
+    Gtid event. Zero sequence number means the group has none.
+  */
+  int64 mts_last_committed;
+  int64 mts_sequence_number;
+  /* non-NULL when the Workers commit in the order of the relay log */
+  Commit_order_manager *commit_order_mngr;
 
   /*
     While distibuting events basing on their properties MTS
@@ -586,6 +596,8 @@ public:
   */
   ulong mts_wq_no_underrun_cnt;
   ulong mts_wq_overfill_cnt;  // counter of C waited due to a WQ queue was full
+  ulong mts_clock_waits_cnt;  // number of times C waited for a commit parent
+  ulonglong mts_clock_wait_time; // total time in microseconds of the waits
   /* 
      A sorted array of the Workers' current assignement numbers to provide
      approximate view on Workers loading.
@@ -216,6 +216,7 @@ Slave_worker::Slave_worker(Relay_log_info *rli
   checkpoint_master_log_name[0]= 0;
   my_init_dynamic_array(&curr_group_exec_parts, sizeof(db_worker_hash_entry*),
                         SLAVE_INIT_DBS_IN_GROUP, 1);
+  my_init_dynamic_array(&curr_group_events, sizeof(Log_event*), 16, 16);
   mysql_mutex_init(key_mutex_slave_parallel_worker, &jobs_lock,
                    MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_cond_slave_parallel_worker, &jobs_cond, NULL);
@@ -230,6 +231,8 @@ Slave_worker::~Slave_worker()
     delete_dynamic(&jobs.Q);
   }
   delete_dynamic(&curr_group_exec_parts);
+  clear_group_events();
+  delete_dynamic(&curr_group_events);
   mysql_mutex_destroy(&jobs_lock);
   mysql_cond_destroy(&jobs_cond);
   info_thd= NULL;
@@ -266,6 +269,9 @@ int Slave_worker::init_worker(Relay_log_info * rli, ulong i)
   bitmap_shifted= 0;
   workers= c_rli->workers; // shallow copying is sufficient
   wq_size_waits_cnt= groups_done= events_done= curr_jobs= 0;
+  busy_time= idle_time= commit_order_wait_time= 0;
+  commit_order_waits= commit_order_retries= 0;
+  commit_order_deadlock= false;
   usage_partition= 0;
   end_group_sets_max_dbs= false;
   gaq_index= last_group_done_index= c_rli->gaq->size; // out of range
@@ -1075,7 +1081,8 @@ Slave_worker *map_db_to_worker(const char *dbname, Relay_log_info *rli,
       PSI_stage_info old_stage;
 
       DBUG_ASSERT(last_worker != NULL &&
-                  rli->curr_group_assigned_parts.elements > 0);
+                  (rli->curr_group_assigned_parts.elements > 0 ||
+                   rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK));
 
       // future assignenment and marking at the same time
       entry->worker= last_worker;
@@ -1192,6 +1199,37 @@ Slave_worker *get_least_occupied_worker(DYNAMIC_ARRAY *ws)
   DBUG_RETURN(worker);
 }
 
+/**
+   Get the Worker with the fewest pending events.  Used for groups that
+   are scheduled by the logical clock and so do not occupy partitions.
+
+   @param ws  dynarray of pointers to Slave_worker
+
+   @return a pointer to chosen Slave_worker instance
+*/
+Slave_worker *get_least_busy_worker(DYNAMIC_ARRAY *ws)
+{
+  ulong len= ULONG_MAX;
+  Slave_worker *worker= NULL;
+
+  DBUG_ENTER("get_least_busy_worker");
+
+  for (ulong i= 0; i < ws->elements; i++)
+  {
+    Slave_worker *w= *(Slave_worker **) dynamic_array_ptr(ws, i);
+    /* the length is read without jobs_lock, it is a hint only */
+    if (w->jobs.len < len)
+    {
+      worker= w;
+      len= w->jobs.len;
+    }
+  }
+
+  DBUG_ASSERT(worker != NULL);
+
+  DBUG_RETURN(worker);
+}
+
 /**
    Deallocation routine to cancel out few effects of
    @c map_db_to_worker().
@@ -1232,8 +1270,19 @@ void Slave_worker::slave_worker_ends_group(Log_event* ev, int error)
     ptr_g->group_master_log_pos= get_group_master_log_pos();
     ptr_g->group_relay_log_pos= group_relay_log_pos;
 
+    if (c_rli->commit_order_mngr)
+      c_rli->commit_order_mngr->finish_group(this, false);
+
     ptr_g->done= 1;    // GAQ index is available to C now
 
+    if (c_rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK)
+    {
+      /* Coordinator can be waiting for the group as a commit parent */
+      mysql_mutex_lock(&slave_worker_hash_lock);
+      mysql_cond_broadcast(&slave_worker_hash_cond);
+      mysql_mutex_unlock(&slave_worker_hash_lock);
+    }
+
     last_group_done_index= gaq_index;
     last_groups_assigned_index= ptr_g->total_seqno;
     reset_gaq_index();
@@ -1241,6 +1290,9 @@ void Slave_worker::slave_worker_ends_group(Log_event* ev, int error)
   }
   else
   {
+    if (c_rli->commit_order_mngr)
+      c_rli->commit_order_mngr->finish_group(this, true);
+
     if (running_status != STOP_ACCEPTED)
     {
       // tagging as exiting so Coordinator won't be able synchronize with it
@@ -1325,6 +1377,74 @@ void Slave_worker::slave_worker_ends_group(Log_event* ev, int error)
   DBUG_VOID_RETURN;
 }
 
+/**
+   Rolls back the current group and applies its kept events again, after
+   Commit_order_manager found that a preceding group waits for a row lock
+   held by the group. The failed commit rolled the transaction back
+   already, so the preceding group could go on meanwhile.
+
+   @return error of the last attempt, non-zero also when the group was
+           rolled back more than slave_transaction_retries times.
+*/
+int Slave_worker::retry_group()
+{
+  THD *thd= info_thd;
+  ulong retries= 0;
+  int error= 1;
+
+  DBUG_ENTER("Slave_worker::retry_group");
+
+  while (commit_order_deadlock && !thd->killed)
+  {
+    if (retries++ >= slave_trans_retries)
+    {
+      report(ERROR_LEVEL, ER_LOCK_DEADLOCK,
+             "Worker %lu rolled back its transaction %lu time(s) to let "
+             "preceding transactions commit, giving up. Consider raising "
+             "the value of the slave_transaction_retries variable.",
+             id, retries - 1);
+      break;
+    }
+
+    thd->clear_error();
+    cleanup_context(thd, true);
+    c_rli->commit_order_mngr->reset_deadlock(this);
+    commit_order_retries++;
+    mysql_mutex_lock(&c_rli->data_lock); // because of SHOW STATUS
+    c_rli->retried_trans++;
+    mysql_mutex_unlock(&c_rli->data_lock);
+    DBUG_PRINT("info", ("Worker %lu retries its group", id));
+
+    error= 0;
+    for (uint i= 0; i < curr_group_events.elements && !error; i++)
+    {
+      Log_event *ev=
+        *(Log_event**) dynamic_array_ptr(&curr_group_events, i);
+
+      thd->server_id= ev->server_id;
+      thd->set_time();
+      set_future_event_relay_log_pos(ev->future_event_relay_log_pos);
+      set_master_log_pos(ev->log_pos);
+      ev->rewind_apply();
+      error= ev->do_apply_event_worker(this);
+    }
+    if (!error)
+      break;
+  }
+
+  DBUG_RETURN(error);
+}
+
+/**
+   Frees the events kept for retry_group() once the group ends.
+*/
+void Slave_worker::clear_group_events()
+{
+  for (uint i= 0; i < curr_group_events.elements; i++)
+    delete *(Log_event**) dynamic_array_ptr(&curr_group_events, i);
+  curr_group_events.elements= 0;
+}
+
 
 /**
    Class circular_buffer_queue.
@@ -1724,6 +1844,14 @@ int wait_for_workers_to_finish(Relay_log_info const *rli, Slave_worker *ignore)
                           const_cast<Relay_log_info*>(rli)->get_event_relay_log_name(),
                           llbuf);
 
+  /*
+    Groups scheduled by the logical clock hold no partitions so they
+    are waited for through GAQ.
+  */
+  if (rli->mts_parallel_type == MTS_PARALLEL_TYPE_LOGICAL_CLOCK &&
+      mts_wait_for_commit_parent(const_cast<Relay_log_info*>(rli), true))
+    cant_sync= TRUE;
+
   for (uint i= 0, ret= 0; i < hash->records; i++)
   {
     db_worker_hash_entry *entry;
@@ -1788,6 +1916,84 @@ int wait_for_workers_to_finish(Relay_log_info const *rli, Slave_worker *ignore)
 }
 
 
+/**
+   Coordinator waits until the groups scheduled before the current one
+   which it depends on are applied.
+
+   With the logical clock a group depends on the groups whose sequence
+   number is not greater than its last_committed.  Groups without
+   timestamps, and the groups of a preceding master binary log (their
+   sequence numbers are not less than the current one), are waited for
+   unconditionally.  A group without timestamps is scheduled through
+   the partitions and only has to wait for the groups which are not.
+
+   @param rli       Coordinator's Relay_log_info
+   @param wait_all  wait for all the groups scheduled so far
+
+   @return false on success, true if Coordinator was killed.
+*/
+bool mts_wait_for_commit_parent(Relay_log_info *rli, bool wait_all)
+{
+  THD *thd= rli->info_thd;
+  Slave_committed_queue *gaq= rli->gaq;
+  int64 last_committed= rli->mts_last_committed;
+  int64 sequence_number= rli->mts_sequence_number;
+  bool in_group= rli->mts_group_status == Relay_log_info::MTS_IN_GROUP;
+  ulonglong start= 0;
+  PSI_stage_info old_stage;
+
+  DBUG_ENTER("mts_wait_for_commit_parent");
+
+  mysql_mutex_lock(&slave_worker_hash_lock);
+  while (!thd->killed)
+  {
+    bool blocked= false;
+
+    for (ulong i= gaq->entry, k= 0; k < gaq->len && !blocked;
+         i= (i + 1) % gaq->size, k++)
+    {
+      Slave_job_group *ptr_g= gaq->get_job_group(i);
+
+      /* the group being scheduled is the last one in GAQ */
+      if (in_group && i == gaq->assigned_group_index)
+        break;
+      if (ptr_g->done)
+        continue;
+      if (wait_all)
+        blocked= true;
+      else if (sequence_number == 0)
+        blocked= ptr_g->sequence_number != 0;
+      else
+        blocked= ptr_g->sequence_number == 0 ||
+          ptr_g->sequence_number <= last_committed ||
+          ptr_g->sequence_number >= sequence_number;
+    }
+    if (!blocked)
+      break;
+
+    if (start == 0)
+    {
+      start= my_micro_time();
+      rli->mts_clock_waits_cnt++;
+      thd->ENTER_COND(&slave_worker_hash_cond, &slave_worker_hash_lock,
+                      &stage_slave_waiting_for_dependent_transaction_to_commit,
+                      &old_stage);
+    }
+    mysql_cond_wait(&slave_worker_hash_cond, &slave_worker_hash_lock);
+  }
+
+  if (start != 0)
+  {
+    rli->mts_clock_wait_time+= my_micro_time() - start;
+    thd->EXIT_COND(&old_stage);
+  }
+  else
+    mysql_mutex_unlock(&slave_worker_hash_lock);
+
+  DBUG_RETURN(thd->killed != THD::NOT_KILLED);
+}
+
+
 // returns the next available! (TODO: incompatible to circurla_buff method!!!)
 static int en_queue(Slave_jobs_queue *jobs, Slave_job_item *item)
 {
@@ -2065,10 +2271,14 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
   THD *thd= worker->info_thd;
   Log_event *ev= NULL;
   bool part_event= FALSE;
+  bool kept_event= false, ended_group= false;
+  ulonglong start= my_micro_time();
 
   DBUG_ENTER("slave_worker_exec_job");
 
   job_item= pop_jobs_item(worker, job_item);
+  worker->idle_time+= my_micro_time() - start;
+  start= my_micro_time();
   if (thd->killed || worker->running_status == Slave_worker::STOP_ACCEPTED)
   {
     DBUG_ASSERT(worker->running_status != Slave_worker::ERROR_LEAVING);
@@ -2109,6 +2319,10 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
       {
         bool found= FALSE;
 
+        /* no partition is assigned to a group scheduled by the clock */
+        if (!ev->mts_assigned_partitions[k])
+          continue;
+
         for (uint i= 0; i < ep->elements && !found; i++)
         {
           found=
@@ -2132,7 +2346,14 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
   worker->set_future_event_relay_log_pos(ev->future_event_relay_log_pos);
   worker->set_master_log_pos(ev->log_pos);
   worker->set_gaq_index(ev->mts_group_idx);
+  if (rli->commit_order_mngr && ev->get_type_code() != ROWS_QUERY_LOG_EVENT)
+  {
+    insert_dynamic(&worker->curr_group_events, (uchar*) &ev);
+    kept_event= true;
+  }
   error= ev->do_apply_event_worker(worker);
+  if (error && worker->commit_order_deadlock)
+    error= worker->retry_group();
   if (ev->ends_group() || (!worker->curr_group_seen_begin &&
                            /*
                               p-events of B/T-less {p,g} group (see
@@ -2145,6 +2366,7 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
                (" commits GAQ index %lu, last committed  %lu",
                 ev->mts_group_idx, worker->last_group_done_index));
     worker->slave_worker_ends_group(ev, error); /* last done sets post exec */
+    ended_group= true;
 
 #ifndef DBUG_OFF
     DBUG_PRINT("mts", ("Check_slave_debug_group worker %lu mts_checkpoint_group"
@@ -2245,6 +2467,7 @@ int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli)
   mysql_mutex_unlock(&rli->pending_jobs_lock);
 
   worker->events_done++;
+  worker->busy_time+= my_micro_time() - start;
 
 err:
   if (error)
@@ -2258,11 +2481,224 @@ err:
   }
 
   // todo: simulate delay in delete
-  if (ev && ev->worker && ev->get_type_code() != ROWS_QUERY_LOG_EVENT)
+  if (ev && ev->worker && ev->get_type_code() != ROWS_QUERY_LOG_EVENT &&
+      !kept_event)
   {
     delete ev;
   }
+  if (ended_group || error)
+    worker->clear_group_events();
 
 
   DBUG_RETURN(error);
 }
+
+
+Commit_order_manager::Commit_order_manager(ulong queue_size, ulong n_workers)
+  : m_n_workers(n_workers), m_queue_size(queue_size), m_queue_head(0),
+    m_queue_len(0), m_rollback_trx(false)
+{
+  mysql_mutex_init(key_mutex_slave_commit_order_manager, &m_mutex,
+                   MY_MUTEX_INIT_FAST);
+  m_workers= new worker_info[n_workers];
+  for (ulong i= 0; i < n_workers; i++)
+  {
+    m_workers[i].status= OCS_NONE;
+    mysql_cond_init(key_cond_slave_commit_order_manager,
+                    &m_workers[i].cond, NULL);
+  }
+  m_queue= new ulong[queue_size];
+}
+
+Commit_order_manager::~Commit_order_manager()
+{
+  for (ulong i= 0; i < m_n_workers; i++)
+    mysql_cond_destroy(&m_workers[i].cond);
+  delete [] m_workers;
+  delete [] m_queue;
+  mysql_mutex_destroy(&m_mutex);
+}
+
+void Commit_order_manager::register_trx(Slave_worker *worker)
+{
+  DBUG_ENTER("Commit_order_manager::register_trx");
+
+  mysql_mutex_lock(&m_mutex);
+  /* a GAQ slot is held by each registered group */
+  DBUG_ASSERT(m_queue_len < m_queue_size);
+  m_queue[(m_queue_head + m_queue_len) % m_queue_size]= worker->id;
+  m_queue_len++;
+  mysql_mutex_unlock(&m_mutex);
+
+  DBUG_VOID_RETURN;
+}
+
+bool Commit_order_manager::wait_for_its_turn(Slave_worker *worker)
+{
+  THD *thd= worker->info_thd;
+  worker_info *info= &m_workers[worker->id];
+  bool error;
+
+  DBUG_ENTER("Commit_order_manager::wait_for_its_turn");
+
+  mysql_mutex_lock(&m_mutex);
+  if (info->status != OCS_NONE)
+  {
+    /* another commit of the same group took the turn already */
+    mysql_mutex_unlock(&m_mutex);
+    DBUG_RETURN(false);
+  }
+
+  if (m_queue_len > 0 && m_queue[m_queue_head] != worker->id &&
+      !m_rollback_trx && !worker->commit_order_deadlock)
+  {
+    PSI_stage_info old_stage;
+    ulonglong start= my_micro_time();
+
+    info->status= OCS_WAIT;
+    thd->ENTER_COND(&info->cond, &m_mutex,
+                    &stage_slave_waiting_for_preceding_transaction_to_commit,
+                    &old_stage);
+    while (m_queue_len > 0 && m_queue[m_queue_head] != worker->id &&
+           !m_rollback_trx && !worker->commit_order_deadlock &&
+           !thd->killed)
+      mysql_cond_wait(&info->cond, &m_mutex);
+    worker->commit_order_waits++;
+    worker->commit_order_wait_time+= my_micro_time() - start;
+    thd->EXIT_COND(&old_stage);
+    mysql_mutex_lock(&m_mutex);
+  }
+
+  if (worker->commit_order_deadlock)
+  {
+    /* the group does not take its turn, it is applied again */
+    info->status= OCS_NONE;
+    mysql_mutex_unlock(&m_mutex);
+    my_error(ER_LOCK_DEADLOCK, MYF(0));
+    DBUG_RETURN(true);
+  }
+
+  info->status= OCS_SIGNAL;
+  error= m_rollback_trx || thd->killed;
+  mysql_mutex_unlock(&m_mutex);
+
+  DBUG_RETURN(error);
+}
+
+void Commit_order_manager::unregister_trx(Slave_worker *worker)
+{
+  worker_info *info= &m_workers[worker->id];
+
+  DBUG_ENTER("Commit_order_manager::unregister_trx");
+
+  mysql_mutex_lock(&m_mutex);
+  if (info->status == OCS_SIGNAL)
+  {
+    /*
+      The Worker is not at the head when it stopped waiting because of
+      an error; the queue is not used anymore then.
+    */
+    if (m_queue_len > 0 && m_queue[m_queue_head] == worker->id)
+    {
+      m_queue_head= (m_queue_head + 1) % m_queue_size;
+      m_queue_len--;
+      if (m_queue_len > 0)
+        mysql_cond_signal(&m_workers[m_queue[m_queue_head]].cond);
+    }
+    info->status= OCS_FINISHED;
+  }
+  mysql_mutex_unlock(&m_mutex);
+
+  DBUG_VOID_RETURN;
+}
+
+ulong Commit_order_manager::queue_position(ulong worker_id)
+{
+  mysql_mutex_assert_owner(&m_mutex);
+  for (ulong i= 0; i < m_queue_len; i++)
+    if (m_queue[(m_queue_head + i) % m_queue_size] == worker_id)
+      return i;
+  return m_queue_len;
+}
+
+void Commit_order_manager::check_deadlock(Slave_worker *waiting,
+                                          Slave_worker *holder)
+{
+  DBUG_ENTER("Commit_order_manager::check_deadlock");
+
+  mysql_mutex_lock(&m_mutex);
+  /*
+    The current group of a Worker is its first one in the queue. A group
+    that took its turn already is committing and releases its locks soon.
+  */
+  if (m_workers[holder->id].status != OCS_SIGNAL &&
+      m_workers[holder->id].status != OCS_FINISHED &&
+      !holder->commit_order_deadlock &&
+      queue_position(waiting->id) < queue_position(holder->id))
+  {
+    DBUG_PRINT("info", ("Worker %lu waits for Worker %lu, which must "
+                        "roll back", waiting->id, holder->id));
+    holder->commit_order_deadlock= true;
+    mysql_cond_signal(&m_workers[holder->id].cond);
+  }
+  mysql_mutex_unlock(&m_mutex);
+
+  DBUG_VOID_RETURN;
+}
+
+void Commit_order_manager::reset_deadlock(Slave_worker *worker)
+{
+  mysql_mutex_lock(&m_mutex);
+  worker->commit_order_deadlock= false;
+  m_workers[worker->id].status= OCS_NONE;
+  mysql_mutex_unlock(&m_mutex);
+}
+
+void Commit_order_manager::finish_group(Slave_worker *worker, bool rollback)
+{
+  worker_info *info= &m_workers[worker->id];
+
+  DBUG_ENTER("Commit_order_manager::finish_group");
+
+  /* the group released its locks, nobody waits for it anymore */
+  mysql_mutex_lock(&m_mutex);
+  worker->commit_order_deadlock= false;
+  mysql_mutex_unlock(&m_mutex);
+
+  if (info->status != OCS_FINISHED)
+  {
+    (void) wait_for_its_turn(worker);
+    if (rollback)
+    {
+      mysql_mutex_lock(&m_mutex);
+      m_rollback_trx= true;
+      /* the following groups must not commit */
+      for (ulong i= 0; i < m_n_workers; i++)
+        mysql_cond_signal(&m_workers[i].cond);
+      mysql_mutex_unlock(&m_mutex);
+    }
+    unregister_trx(worker);
+  }
+  info->status= OCS_NONE;
+
+  DBUG_VOID_RETURN;
+}
+
+Commit_order_manager *get_commit_order_manager(THD *thd)
+{
+  if (!is_mts_worker(thd) || !thd->rli_slave)
+    return NULL;
+  return static_cast<Slave_worker*>(thd->rli_slave)->c_rli->commit_order_mngr;
+}
+
+void commit_order_check_deadlock(THD *waiting, THD *holder)
+{
+  Commit_order_manager *mngr= get_commit_order_manager(waiting);
+  if (mngr == NULL || !is_mts_worker(holder) || !holder->rli_slave)
+    return;
+
+  Slave_worker *waiting_w= static_cast<Slave_worker*>(waiting->rli_slave);
+  Slave_worker *holder_w= static_cast<Slave_worker*>(holder->rli_slave);
+  if (waiting_w->c_rli == holder_w->c_rli)
+    mngr->check_deadlock(waiting_w, holder_w);
+}
@@ -70,8 +70,10 @@ Slave_worker *map_db_to_worker(const char *dbname, Relay_log_info *rli,
                                db_worker_hash_entry **ptr_entry,
                                bool need_temp_tables, Slave_worker *w);
 Slave_worker *get_least_occupied_worker(DYNAMIC_ARRAY *workers);
+Slave_worker *get_least_busy_worker(DYNAMIC_ARRAY *workers);
 int wait_for_workers_to_finish(Relay_log_info const *rli,
                                Slave_worker *ignore= NULL);
+bool mts_wait_for_commit_parent(Relay_log_info *rli, bool wait_all);
 
 #define SLAVE_INIT_DBS_IN_GROUP 4     // initial allocation for CGEP dynarray
 
@@ -179,6 +181,7 @@ typedef struct st_slave_job_group
   volatile uchar done;  // Flag raised by W,  read and reset by Coordinator
   ulong    shifted;     // shift the last CP bitmap at receiving a new CP
   time_t   ts;          // Group's timestampt to update Seconds_behind_master
+  int64    sequence_number; // master's logical timestamp, 0 when unknown
 #ifndef DBUG_OFF
   bool     notified;    // to debug group_master_log_name change notification
 #endif
@@ -201,6 +204,7 @@ typedef struct st_slave_job_group
     checkpoint_seqno= (uint) -1;
     done= 0;
     ts= 0;
+    sequence_number= 0;
 #ifndef DBUG_OFF
     notified= false;
 #endif
@@ -322,6 +326,12 @@ public:
   mysql_cond_t  jobs_cond; // condition variable for the jobs queue
   Relay_log_info *c_rli;   // pointer to Coordinator's rli
   DYNAMIC_ARRAY curr_group_exec_parts; // Current Group Executed Partitions
+  /*
+    Applied events of the current group, kept to apply the group again
+    when it has to let a preceding group commit first. Only filled when
+    the commit order is preserved.
+  */
+  DYNAMIC_ARRAY curr_group_events;
   bool curr_group_seen_begin; // is set to TRUE with explicit B-event
   ulong id;                 // numberic identifier of the Worker
 
@@ -334,6 +344,16 @@ public:
   ulong wq_empty_waits;  // how many times got idle
   ulong events_done;     // how many events (statements) processed
   ulong groups_done;     // how many groups (transactions) processed
+  ulonglong busy_time;   // microseconds spent applying events
+  ulonglong idle_time;   // microseconds spent waiting for an assignment
+  ulong commit_order_waits;  // how many times waited for its turn to commit
+  ulonglong commit_order_wait_time; // microseconds spent in such waits
+  ulong commit_order_retries; // how many times rolled back for a preceding group
+  /*
+    Set by Commit_order_manager when a preceding group waits for a row
+    lock held by the current group, which must roll back then.
+  */
+  volatile bool commit_order_deadlock;
   volatile int curr_jobs; // number of active  assignments
   // number of partitions allocated to the worker at point in time
   long usage_partition;
@@ -398,6 +418,8 @@ public:
   int flush_info(bool force= FALSE);
   static size_t get_number_worker_fields();
   void slave_worker_ends_group(Log_event*, int);
+  int retry_group();
+  void clear_group_events();
   const char *get_master_log_name();
   ulonglong get_master_log_pos() { return master_log_pos; };
   ulonglong set_master_log_pos(ulong val) { return master_log_pos= val; };
@@ -456,6 +478,101 @@ private:
   Slave_worker(const Slave_worker& info);
 };
 
+/**
+   Commit_order_manager makes the Workers commit their groups in the
+   order the Coordinator assigned them, see slave_preserve_commit_order.
+
+   The Coordinator registers each group with the id of its Worker in a
+   queue.  A Worker waits until it is at the head of the queue before it
+   enters the binary log flush stage and leaves the queue once it is
+   enrolled there, so the next group can proceed while the group commit
+   keeps the order of the flush queue.  A group that does not reach the
+   binary log leaves the queue in its turn when the Worker ends it.
+
+   A group waiting for its turn may hold a row lock that a preceding
+   group waits for.  The storage engine reports such waits through
+   thd_report_row_lock_wait(); the following group is then told to roll
+   back, and its Worker applies it again from the events it kept.
+*/
+class Commit_order_manager
+{
+public:
+  Commit_order_manager(ulong queue_size, ulong n_workers);
+  ~Commit_order_manager();
+
+  /** Called by the Coordinator when a group is assigned to a Worker. */
+  void register_trx(Slave_worker *worker);
+  /**
+    Called by the Worker before its group enters the flush stage.
+
+    @return false when it is the Worker's turn or the group already
+            took it, true when a preceding group did not commit, the
+            group has to roll back to let a preceding one commit or the
+            Worker was killed.
+  */
+  bool wait_for_its_turn(Slave_worker *worker);
+  /** Called by the Worker once its group is enrolled to the flush stage. */
+  void unregister_trx(Slave_worker *worker);
+  /**
+    Called when the transaction of @c waiting waits for a row lock held
+    by the transaction of @c holder. If @c holder commits after
+    @c waiting, it can never get its turn: tell it to roll back.
+  */
+  void check_deadlock(Slave_worker *waiting, Slave_worker *holder);
+  /** Called by the Worker before it applies a rolled back group again. */
+  void reset_deadlock(Slave_worker *worker);
+  /**
+    Called by the Worker when its group ends. Leaves the queue in turn
+    if the group did not do it already.
+
+    @param rollback  true if the group is not committed
+  */
+  void finish_group(Slave_worker *worker, bool rollback);
+
+private:
+  enum enum_commit_order_status
+  {
+    OCS_NONE,      // the current group has not taken its turn yet
+    OCS_WAIT,      // waiting for the preceding groups
+    OCS_SIGNAL,    // is at the head of the queue
+    OCS_FINISHED   // has left the queue
+  };
+  struct worker_info
+  {
+    enum_commit_order_status status;
+    mysql_cond_t cond;
+  };
+
+  mysql_mutex_t m_mutex;
+  worker_info *m_workers;
+  ulong m_n_workers;
+  /* circular queue of Worker ids in the commit order */
+  ulong *m_queue;
+  ulong m_queue_size;
+  ulong m_queue_head;
+  ulong m_queue_len;
+  /* a preceding group did not commit, the following ones must not either */
+  bool m_rollback_trx;
+
+  /* position of the first group of the Worker in the queue, or m_queue_len */
+  ulong queue_position(ulong worker_id);
+
+  Commit_order_manager& operator=(const Commit_order_manager&);
+  Commit_order_manager(const Commit_order_manager&);
+};
+
+/**
+   Return the Commit_order_manager if @c thd is a Worker which commits
+   in the relay log order, otherwise NULL.
+*/
+Commit_order_manager *get_commit_order_manager(THD *thd);
+
+/**
+   Called when the transaction of @c waiting waits for a row lock held by
+   the transaction of @c holder, see Commit_order_manager::check_deadlock().
+*/
+void commit_order_check_deadlock(THD *waiting, THD *holder);
+
 void * head_queue(Slave_jobs_queue *jobs, Slave_job_item *ret);
 bool handle_slave_worker_stop(Slave_worker *worker, Slave_job_item *job_item);
 bool set_max_updated_index_on_stop(Slave_worker *worker,
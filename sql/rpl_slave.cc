@@ -6083,6 +6083,17 @@ int slave_start_workers(Relay_log_info *rli, ulong n, bool *mts_inited)
   rli->checkpoint_seqno= 0;
   rli->mts_last_online_stat= my_time(0);
   rli->mts_group_status= Relay_log_info::MTS_NOT_IN_GROUP;
+  rli->mts_parallel_type= opt_mts_parallel_type;
+  rli->mts_last_committed= rli->mts_sequence_number= 0;
+
+  if (opt_slave_preserve_commit_order && n > 0)
+  {
+    if (opt_bin_log && opt_log_slave_updates)
+      rli->commit_order_mngr= new Commit_order_manager(rli->gaq->size, n);
+    else
+      sql_print_warning("slave_preserve_commit_order is ignored as it "
+                        "requires --log-bin and --log-slave-updates");
+  }
 
   if (init_hash_workers(n))  // MTS: mapping_db_to_worker
   {
@@ -6196,7 +6207,24 @@ void slave_stop_workers(Relay_log_info *rli, bool *mts_inited)
   {
     Slave_worker *w= NULL;
     get_dynamic((DYNAMIC_ARRAY*)&rli->workers, (uchar*) &w, i);
+    if (log_warnings > 1)
+      sql_print_information("Worker %lu statistics: "
+                            "groups applied = %lu; "
+                            "events applied = %lu; "
+                            "busy time = %llu ms; "
+                            "idle time = %llu ms; "
+                            "waited for an event = %lu; "
+                            "waited for the commit order = %lu, %llu ms; "
+                            "rolled back for the commit order = %lu",
+                            w->id, w->groups_done, w->events_done,
+                            w->busy_time / 1000, w->idle_time / 1000,
+                            w->wq_empty_waits, w->commit_order_waits,
+                            w->commit_order_wait_time / 1000,
+                            w->commit_order_retries);
+    /* INFORMATION_SCHEMA.SLAVE_WORKER_STATISTICS reads under run_lock */
+    mysql_mutex_lock(&rli->run_lock);
     delete_dynamic_element(&rli->workers, i);
+    mysql_mutex_unlock(&rli->run_lock);
     delete w;
   }
   if (log_warnings > 1)
@@ -6205,10 +6233,13 @@ void slave_stop_workers(Relay_log_info *rli, bool *mts_inited)
                           "worker queues filled over overrun level = %lu; "
                           "waited due a Worker queue full = %lu; "
                           "waited due the total size = %lu; "
-                          "slept when Workers occupied = %lu ",
+                          "slept when Workers occupied = %lu; "
+                          "waited for preceding transactions = %lu, %llu ms ",
                           rli->mts_events_assigned, rli->mts_wq_overrun_cnt,
                           rli->mts_wq_overfill_cnt, rli->wq_size_waits_cnt,
-                          rli->mts_wq_no_underrun_cnt);
+                          rli->mts_wq_no_underrun_cnt,
+                          rli->mts_clock_waits_cnt,
+                          rli->mts_clock_wait_time / 1000);
 
   DBUG_ASSERT(rli->pending_jobs == 0);
   DBUG_ASSERT(rli->mts_pending_jobs_size == 0);
@@ -6225,6 +6256,8 @@ end:
   delete_dynamic(&rli->curr_group_da);             // GCDA
 
   delete_dynamic(&rli->curr_group_assigned_parts); // GCAP
+  delete rli->commit_order_mngr;
+  rli->commit_order_mngr= NULL;
   rli->deinit_workers();
   rli->slave_parallel_workers= 0;
   *mts_inited= false;
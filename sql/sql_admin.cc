@@ -27,6 +27,7 @@
 #include "sp.h"                              // Sroutine_hash_entry
 #include "sql_parse.h"                       // check_table_access
 #include "sql_admin.h"
+#include "histogram.h"                       // mysql_update_histograms
 
 static int send_check_errmsg(THD *thd, TABLE_LIST* table,
 			     const char* operator_name, const char* errmsg)
@@ -1069,9 +1070,23 @@ bool Sql_cmd_analyze_table::execute(THD *thd)
                          FALSE, UINT_MAX, FALSE))
     goto error;
   thd->set_slow_log_for_admin_command();
-  res= mysql_admin_table(thd, first_table, &thd->lex->check_opt,
-                         "analyze", lock_type, 1, 0, 0, 0,
-                         &handler::ha_analyze, 0);
+  if (m_histogram_command != HISTOGRAM_NONE)
+  {
+    if (first_table->next_local)
+    {
+      my_error(ER_WRONG_USAGE, MYF(0), "HISTOGRAM", "multiple tables");
+      goto error;
+    }
+    if (m_histogram_command == HISTOGRAM_UPDATE)
+      res= mysql_update_histograms(thd, first_table, m_histogram_columns,
+                                   m_histogram_buckets);
+    else
+      res= mysql_drop_histograms(thd, first_table, m_histogram_columns);
+  }
+  else
+    res= mysql_admin_table(thd, first_table, &thd->lex->check_opt,
+                           "analyze", lock_type, 1, 0, 0, 0,
+                           &handler::ha_analyze, 0);
   /* ! we write after unlocking the table */
   if (!res && !thd->lex->no_write_to_binlog)
   {
@@ -31,10 +31,20 @@ int reassign_keycache_tables(THD* thd, KEY_CACHE *src_cache,
 class Sql_cmd_analyze_table : public Sql_cmd
 {
 public:
+  /** The histogram clause of the statement, if any */
+  enum enum_histogram_command
+  {
+    HISTOGRAM_NONE,                     ///< Plain ANALYZE TABLE
+    HISTOGRAM_UPDATE,                   ///< UPDATE HISTOGRAM ON ...
+    HISTOGRAM_DROP                      ///< DROP HISTOGRAM ON ...
+  };
+
   /**
     Constructor, used to represent a ANALYZE TABLE statement.
   */
   Sql_cmd_analyze_table()
+    : m_histogram_command(HISTOGRAM_NONE), m_histogram_columns(NULL),
+      m_histogram_buckets(0)
   {}
 
   ~Sql_cmd_analyze_table()
@@ -46,6 +56,28 @@ public:
   {
     return SQLCOM_ANALYZE;
   }
+
+  /**
+    Make the statement create or remove column histograms instead of
+    analyzing the table.
+
+    @param command  HISTOGRAM_UPDATE or HISTOGRAM_DROP
+    @param columns  names of the columns
+    @param buckets  maximum number of histogram buckets, for
+                    HISTOGRAM_UPDATE
+  */
+  void set_histogram_command(enum_histogram_command command,
+                             List<String> *columns, ulong buckets)
+  {
+    m_histogram_command= command;
+    m_histogram_columns= columns;
+    m_histogram_buckets= buckets;
+  }
+
+private:
+  enum_histogram_command m_histogram_command;
+  List<String> *m_histogram_columns;
+  ulong m_histogram_buckets;
 };
 
 
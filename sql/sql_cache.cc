@@ -645,18 +645,24 @@ struct Query_cache_wait_state
   effect by another thread. This enables a quick path in execution to skip waits
   when the outcome is known.
 
+  A shared lock is taken by lookups, which only read the cache structures
+  apart from the query list (see queries_list_mutex).  Any number of them
+  can hold the cache together; they exclude the exclusive lock, and wait
+  while a thread waits for it.  It is released with unlock_shared().
+
   @param use_timeout TRUE if the lock can abort because of a timeout.
+  @param shared TRUE to take a shared lock
 
-  @note use_timeout is optional and default value is FALSE.
+  @note use_timeout and shared are optional and default value is FALSE.
 
   @return
-   @retval FALSE An exclusive lock was taken
+   @retval FALSE The lock was taken
    @retval TRUE The locking attempt failed
 */
 
-bool Query_cache::try_lock(bool use_timeout)
+bool Query_cache::try_lock(bool use_timeout, bool shared)
 {
-  bool interrupt= FALSE;
+  bool interrupt= FALSE, waited= FALSE;
   THD *thd= current_thd;
   Query_cache_wait_state wait_state(thd, __func__, __FILE__, __LINE__);
   DBUG_ENTER("Query_cache::try_lock");
@@ -669,7 +675,14 @@ bool Query_cache::try_lock(bool use_timeout)
   thd->proc_info = old_proc_info;
   while (1)
   {
-    if (m_cache_lock_status == Query_cache::UNLOCKED)
+    if (shared && m_cache_lock_status == Query_cache::UNLOCKED &&
+        m_cache_writers_waiting == 0)
+    {
+      m_cache_readers++;
+      break;
+    }
+    else if (!shared && m_cache_lock_status == Query_cache::UNLOCKED &&
+             m_cache_readers == 0)
     {
       m_cache_lock_status= Query_cache::LOCKED;
 #ifndef DBUG_OFF
@@ -689,7 +702,15 @@ bool Query_cache::try_lock(bool use_timeout)
     }
     else
     {
-      DBUG_ASSERT(m_cache_lock_status == Query_cache::LOCKED);
+      DBUG_ASSERT(m_cache_lock_status == Query_cache::LOCKED ||
+                  m_cache_readers > 0 || m_cache_writers_waiting > 0);
+      if (!waited)
+      {
+        lock_waits++;
+        if (!shared)
+          m_cache_writers_waiting++;
+        waited= TRUE;
+      }
       /*
         To prevent send_result_to_client() and query_cache_insert() from
         blocking execution for too long a timeout is put on the lock.
@@ -712,6 +733,11 @@ bool Query_cache::try_lock(bool use_timeout)
       }
     }
   }
+  if (waited && !shared && --m_cache_writers_waiting == 0 && interrupt)
+  {
+    /* Let in the lookups which waited behind this thread */
+    mysql_cond_broadcast(&COND_cache_status_changed);
+  }
   mysql_mutex_unlock(&structure_guard_mutex);
 
   DBUG_RETURN(interrupt);
@@ -736,8 +762,12 @@ void Query_cache::lock_and_suspend(void)
   DBUG_ENTER("Query_cache::lock_and_suspend");
 
   mysql_mutex_lock(&structure_guard_mutex);
-  while (m_cache_lock_status != Query_cache::UNLOCKED)
+  if (m_cache_lock_status != Query_cache::UNLOCKED || m_cache_readers)
+    lock_waits++;
+  m_cache_writers_waiting++;
+  while (m_cache_lock_status != Query_cache::UNLOCKED || m_cache_readers)
     mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
+  m_cache_writers_waiting--;
   m_cache_lock_status= Query_cache::LOCKED_NO_WAIT;
 #ifndef DBUG_OFF
   if (thd)
@@ -765,8 +795,12 @@ void Query_cache::lock(void)
   DBUG_ENTER("Query_cache::lock");
 
   mysql_mutex_lock(&structure_guard_mutex);
-  while (m_cache_lock_status != Query_cache::UNLOCKED)
+  if (m_cache_lock_status != Query_cache::UNLOCKED || m_cache_readers)
+    lock_waits++;
+  m_cache_writers_waiting++;
+  while (m_cache_lock_status != Query_cache::UNLOCKED || m_cache_readers)
     mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
+  m_cache_writers_waiting--;
   m_cache_lock_status= Query_cache::LOCKED;
 #ifndef DBUG_OFF
   if (thd)
@@ -795,7 +829,28 @@ void Query_cache::unlock(void)
               m_cache_lock_status == Query_cache::LOCKED_NO_WAIT);
   m_cache_lock_status= Query_cache::UNLOCKED;
   DBUG_PRINT("Query_cache",("Sending signal"));
-  mysql_cond_signal(&COND_cache_status_changed);
+  /*
+    Both lookups and exclusive lockers may be waiting, and a woken lookup
+    can not proceed while an exclusive locker waits: wake them all.
+  */
+  mysql_cond_broadcast(&COND_cache_status_changed);
+  mysql_mutex_unlock(&structure_guard_mutex);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Release a shared lock taken by try_lock() and signal waiting threads
+  when the last one is released.
+*/
+
+void Query_cache::unlock_shared(void)
+{
+  DBUG_ENTER("Query_cache::unlock_shared");
+  mysql_mutex_lock(&structure_guard_mutex);
+  DBUG_ASSERT(m_cache_readers > 0);
+  if (--m_cache_readers == 0)
+    mysql_cond_broadcast(&COND_cache_status_changed);
   mysql_mutex_unlock(&structure_guard_mutex);
   DBUG_VOID_RETURN;
 }
@@ -1142,8 +1197,8 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1206,7 +1261,7 @@ void Query_cache::end_of_result(THD *thd)
 
   if (thd->killed || thd->is_error())
   {
-    query_cache_abort(&thd->query_cache_tls);
+    abort(&thd->query_cache_tls);
     DBUG_VOID_RETURN;
   }
 
@@ -1253,9 +1308,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= max(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= max(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1290,6 +1345,246 @@ void mysql_query_cache_invalidate4(THD *thd,
 }
 
 
+/*****************************************************************************
+   Query_cache_shards methods
+*****************************************************************************/
+
+Query_cache_shards::Query_cache_shards()
+  :query_cache_size(0), query_cache_limit(ULONG_MAX),
+   shards(NULL), n_shards(0)
+{}
+
+
+/**
+  Pick the shard a statement is looked up in and stored to.
+
+  The statement text is hashed: it is the same buffer for the lookup in
+  send_result_to_client() and the registration in store_query(), so both
+  always agree on the shard.  With query_cache_strip_comments the text is
+  hashed without comments, as statements differing only in comments share
+  one cache entry.
+*/
+
+Query_cache *
+Query_cache_shards::shard_for_query(THD *thd, const char *query,
+                                    size_t query_length)
+{
+  ulong nr1= 1, nr2= 4;
+
+  if (n_shards == 1)
+    return shards;
+  if (opt_query_cache_strip_comments)
+  {
+    QueryStripComments *query_strip_comments= &thd->query_strip_comments;
+    query_strip_comments->set(query, query_length,
+                              QUERY_BUFFER_ADDITIONAL_LENGTH(thd->db_length));
+    query= query_strip_comments->query();
+    query_length= query_strip_comments->query_length();
+  }
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar*) query,
+                                 query_length, &nr1, &nr2);
+  return &shards[nr1 % n_shards];
+}
+
+
+ulong Query_cache_shards::stat_sum(ulong Query_cache::*counter)
+{
+  ulong sum= 0;
+  for (uint i= 0; i < n_shards; i++)
+    sum+= shards[i].*counter;
+  return sum;
+}
+
+
+void Query_cache_shards::reset_counters()
+{
+  for (uint i= 0; i < n_shards; i++)
+  {
+    Query_cache *shard= &shards[i];
+    shard->hits= shard->inserts= shard->refused= shard->lowmem_prunes= 0;
+    shard->misses= shard->lock_waits= 0;
+  }
+}
+
+
+void Query_cache_shards::init(uint shard_count)
+{
+  DBUG_ENTER("Query_cache_shards::init");
+  DBUG_ASSERT(shards == NULL);
+  shard_count= max(1U, min(shard_count, (uint) QUERY_CACHE_MAX_SHARDS));
+  if (!(shards= new (std::nothrow) Query_cache[shard_count]))
+  {
+    sql_print_error("Could not allocate %u query cache shards, "
+                    "query cache is disabled", shard_count);
+    DBUG_VOID_RETURN;
+  }
+  n_shards= shard_count;
+  for (uint i= 0; i < n_shards; i++)
+  {
+    shards[i].init();
+    shards[i].result_size_limit(query_cache_limit);
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Resize the cache, splitting the requested size evenly between the shards.
+
+  @return the total size actually allocated, 0 if the cache is disabled
+*/
+
+ulong Query_cache_shards::resize(ulong query_cache_size_arg)
+{
+  ulong new_query_cache_size= 0;
+  DBUG_ENTER("Query_cache_shards::resize");
+
+  for (uint i= 0; i < n_shards; i++)
+    new_query_cache_size+= shards[i].resize(query_cache_size_arg / n_shards);
+  query_cache_size= new_query_cache_size;
+  DBUG_RETURN(new_query_cache_size);
+}
+
+
+void Query_cache_shards::result_size_limit(ulong limit)
+{
+  query_cache_limit= limit;
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].result_size_limit(limit);
+}
+
+
+ulong Query_cache_shards::set_min_res_unit(ulong size)
+{
+  for (uint i= 0; i < n_shards; i++)
+    size= shards[i].set_min_res_unit(size);
+  return size;
+}
+
+
+void Query_cache_shards::store_query(THD *thd, TABLE_LIST *tables_used)
+{
+  if (n_shards == 0)
+    return;
+  shard_for_query(thd, thd->query(),
+                  thd->query_length())->store_query(thd, tables_used);
+}
+
+
+int Query_cache_shards::send_result_to_client(THD *thd, char *sql,
+                                              uint query_length)
+{
+  if (n_shards == 0)
+    return 0;
+  return shard_for_query(thd, sql,
+                         query_length)->send_result_to_client(thd, sql,
+                                                              query_length);
+}
+
+
+void Query_cache_shards::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                    my_bool using_transactions)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate(thd, tables_used, using_transactions);
+}
+
+
+void Query_cache_shards::invalidate(CHANGED_TABLE_LIST *tables_used)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate(tables_used);
+}
+
+
+void Query_cache_shards::invalidate_locked_for_write(TABLE_LIST *tables_used)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate_locked_for_write(tables_used);
+}
+
+
+void Query_cache_shards::invalidate(THD *thd, TABLE *table,
+                                    my_bool using_transactions)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate(thd, table, using_transactions);
+}
+
+
+void Query_cache_shards::invalidate(THD *thd, const char *key,
+                                    uint32 key_length,
+                                    my_bool using_transactions)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate(thd, key, key_length, using_transactions);
+}
+
+
+void Query_cache_shards::invalidate(char *db)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate(db);
+}
+
+
+void Query_cache_shards::invalidate_by_MyISAM_filename(const char *filename)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].invalidate_by_MyISAM_filename(filename);
+}
+
+
+void Query_cache_shards::flush()
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].flush();
+}
+
+
+void Query_cache_shards::pack(ulong join_limit, uint iteration_limit)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].pack(join_limit, iteration_limit);
+}
+
+
+void Query_cache_shards::destroy()
+{
+  DBUG_ENTER("Query_cache_shards::destroy");
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].destroy();
+  delete [] shards;
+  shards= NULL;
+  n_shards= 0;
+  query_cache_size= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+void Query_cache_shards::insert(Query_cache_tls *query_cache_tls,
+                                const char *packet, ulong length,
+                                unsigned pkt_nr)
+{
+  if (query_cache_tls->shard)
+    query_cache_tls->shard->insert(query_cache_tls, packet, length, pkt_nr);
+}
+
+
+void Query_cache_shards::end_of_result(THD *thd)
+{
+  if (thd->query_cache_tls.shard)
+    thd->query_cache_tls.shard->end_of_result(thd);
+}
+
+
+void Query_cache_shards::abort(Query_cache_tls *query_cache_tls)
+{
+  if (query_cache_tls->shard)
+    query_cache_tls->shard->abort(query_cache_tls);
+}
+
+
 /*****************************************************************************
    Query_cache methods
 *****************************************************************************/
@@ -1302,7 +1597,8 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0), m_query_cache_is_disabled(FALSE),
+   total_blocks(0), lowmem_prunes(0), misses(0), lock_waits(0),
+   m_query_cache_is_disabled(FALSE),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -1315,6 +1611,10 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   set_if_bigger(min_allocation_unit,min_needed);
   this->min_allocation_unit= ALIGN_SIZE(min_allocation_unit);
   set_if_bigger(this->min_result_data_size,min_allocation_unit);
+  /* Shards are allocated dynamically, start from an empty cache. */
+  make_disabled();
+  my_hash_clear(&queries);
+  my_hash_clear(&tables);
 }
 
 
@@ -1566,6 +1866,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.shard= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1856,13 +2157,13 @@ Query_cache::send_result_to_client(THD *thd, char *sql, uint query_length)
     }
   }
   /*
-    Try to obtain an exclusive lock on the query cache. If the cache is
+    Try to obtain a shared lock on the query cache. If the cache is
     disabled or if a full cache flush is in progress, the attempt to
     get the lock is aborted.
 
-    The 'TRUE' parameter indicate that the lock is allowed to timeout
+    The first 'TRUE' parameter indicate that the lock is allowed to timeout
   */
-  if (try_lock(TRUE))
+  if (try_lock(TRUE, TRUE))
     goto err;
 
   if (query_cache_size == 0)
@@ -2010,7 +2311,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
         DBUG_PRINT("qcache",
                    ("Temporary table detected: '%s.%s'",
                     tmptable->s->db.str, tmptable->s->table_name.str));
-        unlock();
+        unlock_shared();
         /*
           We should not store result of this query because it contain
           temporary tables => assign following variable to make check
@@ -2031,7 +2332,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       DBUG_PRINT("qcache",
 		 ("probably no SELECT access to %s.%s =>  return to normal processing",
 		  table_list.db, table_list.alias));
-      unlock();
+      unlock_shared();
       thd->lex->safe_to_cache_query=0;		// Don't try to cache this
       BLOCK_UNLOCK_RD(query_block);
       DBUG_RETURN(-1);				// Privilege error
@@ -2069,8 +2370,22 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
                      ("Handler require invalidation queries of %s.%s %lu-%lu",
                       table_list.db, table_list.alias,
                       (ulong) engine_data, (ulong) table->engine_data()));
-          invalidate_table_internal(thd, (uchar *) table->db(),
-                                    table->key_length());
+          /*
+            The invalidation needs the exclusive lock. The table block
+            can be freed once the shared lock is released, copy its key.
+          */
+          uchar key[MAX_DBKEY_LENGTH];
+          uint32 key_length= table->key_length();
+          DBUG_ASSERT(key_length <= sizeof(key));
+          memcpy(key, table->db(), key_length);
+          statistic_increment(misses, &queries_list_mutex);
+          unlock_shared();
+          lock();
+          invalidate_table_internal(thd, key, key_length);
+          unlock();
+          DBUG_ASSERT(! thd->transaction_rollback_request);
+          trans_rollback_stmt(thd);
+          goto err;				// Parse query
         }
         else
           thd->lex->safe_to_cache_query= 0;       // Don't try to cache this
@@ -2088,9 +2403,12 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       DBUG_PRINT("qcache", ("handler allow caching %s,%s",
 			    table_list.db, table_list.alias));
   }
+  DEBUG_SYNC(thd, "query_cache_hit_locked");
+  mysql_mutex_lock(&queries_list_mutex);
   move_to_query_list_end(query_block);
   hits++;
-  unlock();
+  mysql_mutex_unlock(&queries_list_mutex);
+  unlock_shared();
 
   /*
     Send cached result to client
@@ -2149,7 +2467,8 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
   DBUG_RETURN(1);				// Result sent to client
 
 err_unlock:
-  unlock();
+  statistic_increment(misses, &queries_list_mutex);
+  unlock_shared();
 err:
   thd->query_plan_flags|= QPLAN_QC_NO;
   MYSQL_QUERY_CACHE_MISS(thd->query());
@@ -2388,7 +2707,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2450,6 +2769,7 @@ void Query_cache::destroy()
     unlock();
 
     mysql_cond_destroy(&COND_cache_status_changed);
+    mysql_mutex_destroy(&queries_list_mutex);
     mysql_mutex_destroy(&structure_guard_mutex);
     initialized = 0;
   }
@@ -2466,9 +2786,12 @@ void Query_cache::init()
   DBUG_ENTER("Query_cache::init");
   mysql_mutex_init(key_structure_guard_mutex,
                    &structure_guard_mutex, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_queries_list_mutex,
+                   &queries_list_mutex, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_COND_cache_status_changed,
                   &COND_cache_status_changed, NULL);
   m_cache_lock_status= Query_cache::UNLOCKED;
+  m_cache_readers= m_cache_writers_waiting= 0;
   initialized = 1;
   /*
     If we explicitly turn off query cache from the command line query cache will
@@ -2477,7 +2800,7 @@ void Query_cache::init()
     be used.
   */
   if (global_system_variables.query_cache_type == 0)
-    query_cache.disable_query_cache();
+    disable_query_cache();
 
   DBUG_VOID_RETURN;
 }
@@ -4129,7 +4452,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4161,7 +4484,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -5197,6 +5520,24 @@ err2:
   return result;
 }
 
+
+
+void Query_cache_shards::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < n_shards; i++)
+    shards[i].wreck(line, message);
+  query_cache_size= 0;
+}
+
+
+my_bool Query_cache_shards::check_integrity(bool not_locked)
+{
+  my_bool result= 0;
+  for (uint i= 0; i < n_shards; i++)
+    result|= shards[i].check_integrity(not_locked);
+  return result;
+}
+
 #endif /* DBUG_OFF */
 
 #endif /*HAVE_QUERY_CACHE*/
@@ -67,6 +67,9 @@ typedef ulonglong sql_mode_t;
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
 
+/* maximal number of independent query cache shards */
+#define QUERY_CACHE_MAX_SHARDS			64
+
 #define TABLE_COUNTER_TYPE uint
 
 struct Query_cache_block;
@@ -287,6 +290,8 @@ public:
   /* statistics */
   ulong free_memory, queries_in_cache, hits, inserts, refused,
     free_memory_blocks, total_blocks, lowmem_prunes;
+  /* lookups that did not find a result, waits for a locked cache */
+  ulong misses, lock_waits;
 
 
 private:
@@ -296,6 +301,12 @@ private:
   mysql_cond_t COND_cache_status_changed;
   enum Cache_lock_status { UNLOCKED, LOCKED_NO_WAIT, LOCKED };
   Cache_lock_status m_cache_lock_status;
+  /*
+    Number of threads holding the cache shared to look up a query, and of
+    threads waiting for the exclusive lock.  New shared lookups wait while
+    an exclusive locker waits, so that hits can not starve it.
+  */
+  uint m_cache_readers, m_cache_writers_waiting;
 
   bool m_query_cache_is_disabled;
 
@@ -319,6 +330,13 @@ protected:
     till the end of a flush operation.
   */
   mysql_mutex_t structure_guard_mutex;
+  /*
+    Lookups hold the cache shared, see try_lock().  The only structure they
+    change is the query list, where a hit moves its query to the end, and
+    they do that under this mutex.  Holders of the exclusive lock do not
+    need it.
+  */
+  mysql_mutex_t queries_list_mutex;
   uchar *cache;					// cache memory
   Query_cache_block *first_block;		// physical location block list
   Query_cache_block *queries_blocks;		// query list (LIFO)
@@ -512,10 +530,95 @@ protected:
 			const char *name);
   my_bool in_blocks(Query_cache_block * point);
 
-  bool try_lock(bool use_timeout= FALSE);
+  bool try_lock(bool use_timeout= FALSE, bool shared= FALSE);
   void lock(void);
   void lock_and_suspend(void);
   void unlock(void);
+  void unlock_shared(void);
+};
+
+
+/**
+  The query cache as seen by the rest of the server.
+
+  The cache is split into a fixed number of independent Query_cache shards,
+  each with its own memory arena and structure_guard_mutex.  Lookups and
+  stores are routed to a shard by a hash of the statement text, so hits on
+  different statements do not serialize on one mutex.  Within a shard,
+  lookups share the cache lock, see Query_cache::try_lock().  Invalidations,
+  flushes and resizes are applied to every shard.  With one shard the
+  behaviour is that of the unsharded cache.
+*/
+
+class Query_cache_shards
+{
+public:
+  /* Info */
+  ulong query_cache_size, query_cache_limit;
+
+private:
+  Query_cache *shards;
+  uint n_shards;
+
+  Query_cache *shard_for_query(THD *thd, const char *query,
+                               size_t query_length);
+
+public:
+  Query_cache_shards();
+
+  bool is_disabled(void)
+  { return n_shards == 0 || shards[0].is_disabled(); }
+
+  /* number of shards and access to them, for statistics */
+  uint shard_count() const { return n_shards; }
+  Query_cache *shard(uint i) { return &shards[i]; }
+  /* sum of a statistics counter over all shards */
+  ulong stat_sum(ulong Query_cache::*counter);
+  /* reset the counters cleared by FLUSH STATUS */
+  void reset_counters();
+
+  /* create the shards and initialize them (mutex) */
+  void init(uint shard_count);
+  /* resize query cache (return real query size, 0 if disabled) */
+  ulong resize(ulong query_cache_size);
+  /* set limit on result size */
+  void result_size_limit(ulong limit);
+  /* set minimal result data allocation unit size */
+  ulong set_min_res_unit(ulong size);
+
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  void invalidate(THD* thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(TABLE_LIST *tables_used);
+  void invalidate(THD* thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+  void invalidate(char *db);
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack(ulong join_limit = QUERY_CACHE_PACK_LIMIT,
+	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
+
+  void destroy();
+
+  /*
+    The writer of a result is bound to the shard which registered the
+    query in store_query(), see Query_cache_tls::shard.
+  */
+  void insert(Query_cache_tls *query_cache_tls,
+              const char *packet,
+              ulong length,
+              unsigned pkt_nr);
+  void end_of_result(THD *thd);
+  void abort(Query_cache_tls *query_cache_tls);
+
+  /* debugging, see Query_cache */
+  void wreck(uint line, const char *message);
+  my_bool check_integrity(bool not_locked);
 };
 
 #ifdef HAVE_QUERY_CACHE
@@ -547,7 +650,7 @@ struct Query_cache_query_flags
 #define query_cache_store_query(A, B) query_cache.store_query(A, B)
 #define query_cache_destroy() query_cache.destroy()
 #define query_cache_result_size_limit(A) query_cache.result_size_limit(A)
-#define query_cache_init() query_cache.init()
+#define query_cache_init() query_cache.init(query_cache_shards)
 #define query_cache_resize(A) query_cache.resize(A)
 #define query_cache_set_min_res_unit(A) query_cache.set_min_res_unit(A)
 #define query_cache_invalidate3(A, B, C) query_cache.invalidate(A, B, C)
@@ -582,5 +685,5 @@ struct Query_cache_query_flags
 #define query_cache_is_cacheable_query(L) 0
 #endif /*HAVE_QUERY_CACHE*/
 
-extern Query_cache query_cache;
+extern Query_cache_shards query_cache;
 #endif
@@ -36,6 +36,7 @@
 #include "sql_base.h"                         // close_temporary_tables
 #include "sql_handler.h"                      // mysql_ha_cleanup
 #include "rpl_rli.h"
+#include "rpl_rli_pdb.h"                       // commit_order_check_deadlock
 #include "rpl_filter.h"
 #include "rpl_record.h"
 #include "rpl_slave.h"
@@ -4523,6 +4524,19 @@ extern "C" int thd_slave_thread(const MYSQL_THD thd)
   return(thd->slave_thread);
 }
 
+/**
+  Called by the storage engine when the transaction of @c self waits for
+  a row lock held by the transaction of @c wait_for.
+*/
+void thd_report_row_lock_wait(THD *self, THD *wait_for)
+{
+#ifdef HAVE_REPLICATION
+  if (self != NULL && wait_for != NULL &&
+      is_mts_worker(self) && is_mts_worker(wait_for))
+    commit_order_check_deadlock(self, wait_for);
+#endif
+}
+
 extern "C" int thd_non_transactional_update(const MYSQL_THD thd)
 {
   return thd->transaction.all.has_modified_non_trans_table();
@@ -4914,6 +4928,12 @@ void THD::inc_status_created_tmp_tables()
 #endif
 }
 
+void THD::inc_status_tmp_table_disk_spills(ulonglong bytes)
+{
+  status_var_increment(status_var.tmp_table_disk_spills);
+  status_var_add(status_var.tmp_table_disk_spill_bytes, bytes);
+}
+
 void THD::inc_status_select_full_join()
 {
   status_var_increment(status_var.select_full_join_count);
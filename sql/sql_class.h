@@ -142,6 +142,8 @@ enum enum_log_warnings_suppress { log_warnings_suppress_1592 };
 enum enum_slave_exec_mode { SLAVE_EXEC_MODE_STRICT,
                             SLAVE_EXEC_MODE_IDEMPOTENT,
                             SLAVE_EXEC_MODE_LAST_BIT };
+enum enum_mts_parallel_type { MTS_PARALLEL_TYPE_DB_NAME,
+                              MTS_PARALLEL_TYPE_LOGICAL_CLOCK };
 enum enum_slave_type_conversions { SLAVE_TYPE_CONVERSIONS_ALL_LOSSY,
                                    SLAVE_TYPE_CONVERSIONS_ALL_NON_LOSSY,
                                    SLAVE_TYPE_CONVERSIONS_ALL_UNSIGNED,
@@ -402,6 +404,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -410,12 +413,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* the query cache shard 'first_query_block' belongs to */
+  Query_cache *shard;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), shard(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -639,6 +644,12 @@ typedef struct system_variables
     'COLUMN_TYPE' field.
   */
   my_bool show_old_temporals;
+
+  /**
+    Reuse the join order of a query block of a prepared statement or a
+    stored program statement in its later executions.
+  */
+  my_bool optimizer_plan_cache;
 } SV;
 
 /** Page fragmentation statistics */
@@ -668,6 +679,12 @@ typedef struct system_status_var
 {
   ulonglong created_tmp_disk_tables;
   ulonglong created_tmp_tables;
+  /* In-memory temporary tables converted to disk, and their size then */
+  ulonglong tmp_table_disk_spills;
+  ulonglong tmp_table_disk_spill_bytes;
+  /* Binlog dump thread reads served from the binlog dump ring, or not */
+  ulonglong binlog_dump_ring_hits;
+  ulonglong binlog_dump_ring_misses;
   ulonglong ha_commit_count;
   ulonglong ha_delete_count;
   ulonglong ha_read_first_count;
@@ -706,6 +723,10 @@ typedef struct system_status_var
   ulonglong filesort_range_count;
   ulonglong filesort_rows;
   ulonglong filesort_scan_count;
+  /* Join orders reused and computed for cacheable query blocks */
+  ulonglong plan_cache_hits;
+  ulonglong plan_cache_misses;
+  ulonglong plan_cache_invalidations;
   /* Prepared statements and binary protocol */
   ulonglong com_stmt_prepare;
   ulonglong com_stmt_reprepare;
@@ -3123,6 +3144,7 @@ public:
   void inc_status_created_tmp_disk_tables();
   void inc_status_created_tmp_files();
   void inc_status_created_tmp_tables();
+  void inc_status_tmp_table_disk_spills(ulonglong bytes);
   void inc_status_select_full_join();
   void inc_status_select_full_range_join();
   void inc_status_select_range();
@@ -5032,13 +5054,21 @@ public:
     that MEMORY tables cannot index BIT columns.
   */
   bool bit_fields_as_long;
+  /**
+    TRUE <=> the GROUP BY or DISTINCT key may be replaced by a key over a
+    hash of the key columns (TABLE::hash_field) when they include BLOBs,
+    so that the table can stay in HEAP. The writer must then call
+    check_unique_constraint() before every write, and must not use the
+    key for lookups.
+  */
+  bool allow_hash_field;
 
   TMP_TABLE_PARAM()
     :copy_field(0), copy_field_end(0), group_parts(0),
      group_length(0), group_null_parts(0), outer_sum_func_count(0),
      using_outer_summary_function(0),
      schema_table(0), precomputed_group_by(0), force_copy_fields(0),
-     skip_create_table(FALSE), bit_fields_as_long(0)
+     skip_create_table(FALSE), bit_fields_as_long(0), allow_hash_field(0)
   {}
   ~TMP_TABLE_PARAM()
   {
@@ -5063,6 +5093,8 @@ public:
   TABLE *table;
 
   select_union() :table(0) {}
+  /* Let a UNION DISTINCT table with BLOBs stay in HEAP, see create_tmp_table */
+  void allow_hash_field() { tmp_table_param.allow_hash_field= true; }
   int prepare(List<Item> &list, SELECT_LEX_UNIT *u);
   bool send_data(List<Item> &items);
   bool send_eof();
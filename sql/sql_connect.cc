@@ -370,6 +370,271 @@ void free_global_client_stats(void)
   my_hash_free(&global_client_stats);
 }
 
+USERSTAT_SHARD userstat_shards[USERSTAT_SHARDS];
+
+void init_userstat_shards(void)
+{
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    mysql_mutex_init(key_LOCK_userstat_shard, &shard->lock,
+                     MY_MUTEX_INIT_FAST);
+    if (my_hash_init(&shard->user_stats, system_charset_info, 16,
+                     0, 0, (my_hash_get_key) get_key_user_stats,
+                     (my_hash_free_key) free_user_stats, 0) ||
+        my_hash_init(&shard->client_stats, system_charset_info, 16,
+                     0, 0, (my_hash_get_key) get_key_user_stats,
+                     (my_hash_free_key) free_user_stats, 0) ||
+        my_hash_init(&shard->thread_stats, &my_charset_bin, 16,
+                     0, 0, (my_hash_get_key) get_key_thread_stats,
+                     (my_hash_free_key) free_thread_stats, 0) ||
+        my_hash_init(&shard->table_stats, system_charset_info, 16,
+                     0, 0, (my_hash_get_key) get_key_table_stats,
+                     (my_hash_free_key) free_table_stats, 0) ||
+        my_hash_init(&shard->index_stats, system_charset_info, 16,
+                     0, 0, (my_hash_get_key) get_key_index_stats,
+                     (my_hash_free_key) free_index_stats, 0))
+    {
+      sql_print_error("Initializing userstat shards failed.");
+      exit(1);
+    }
+  }
+}
+
+void free_userstat_shards(void)
+{
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    my_hash_free(&shard->user_stats);
+    my_hash_free(&shard->client_stats);
+    my_hash_free(&shard->thread_stats);
+    my_hash_free(&shard->table_stats);
+    my_hash_free(&shard->index_stats);
+    mysql_mutex_destroy(&shard->lock);
+  }
+}
+
+// Adds the counters of a shard delta to a global user or client entry.
+static void add_user_stats(USER_STATS *to, const USER_STATS *from)
+{
+  to->connected_time+=       from->connected_time;
+  to->busy_time+=            from->busy_time;
+  to->cpu_time+=             from->cpu_time;
+  to->bytes_received+=       from->bytes_received;
+  to->bytes_sent+=           from->bytes_sent;
+  to->binlog_bytes_written+= from->binlog_bytes_written;
+  to->rows_fetched+=         from->rows_fetched;
+  to->rows_updated+=         from->rows_updated;
+  to->rows_read+=            from->rows_read;
+  to->select_commands+=      from->select_commands;
+  to->update_commands+=      from->update_commands;
+  to->other_commands+=       from->other_commands;
+  to->commit_trans+=         from->commit_trans;
+  to->rollback_trans+=       from->rollback_trans;
+  to->denied_connections+=   from->denied_connections;
+  to->lost_connections+=     from->lost_connections;
+  to->access_denied_errors+= from->access_denied_errors;
+  to->empty_queries+=        from->empty_queries;
+}
+
+// Adds the counters of a shard delta to a global thread entry.
+static void add_thread_stats(THREAD_STATS *to, const THREAD_STATS *from)
+{
+  to->connected_time+=       from->connected_time;
+  to->busy_time+=            from->busy_time;
+  to->cpu_time+=             from->cpu_time;
+  to->bytes_received+=       from->bytes_received;
+  to->bytes_sent+=           from->bytes_sent;
+  to->binlog_bytes_written+= from->binlog_bytes_written;
+  to->rows_fetched+=         from->rows_fetched;
+  to->rows_updated+=         from->rows_updated;
+  to->rows_read+=            from->rows_read;
+  to->select_commands+=      from->select_commands;
+  to->update_commands+=      from->update_commands;
+  to->other_commands+=       from->other_commands;
+  to->commit_trans+=         from->commit_trans;
+  to->rollback_trans+=       from->rollback_trans;
+  to->denied_connections+=   from->denied_connections;
+  to->lost_connections+=     from->lost_connections;
+  to->access_denied_errors+= from->access_denied_errors;
+  to->empty_queries+=        from->empty_queries;
+}
+
+static void merge_user_stats_deltas(HASH *global, HASH *deltas)
+{
+  for (ulong idx= 0; idx < deltas->records; idx++)
+  {
+    const USER_STATS *delta= (USER_STATS *) my_hash_element(deltas, idx);
+    USER_STATS *user_stats;
+
+    // The deltas are only created for existing global entries.
+    if ((user_stats= (USER_STATS *) my_hash_search(global,
+                                                   (uchar *) delta->user,
+                                                   delta->user_len)))
+      add_user_stats(user_stats, delta);
+  }
+  my_hash_reset(deltas);
+}
+
+/*
+  Merges the user, client and thread stats of all the userstat shards
+  into the global hashes.  LOCK_global_user_client_stats must be held.
+*/
+void merge_user_client_stats_shards(void)
+{
+  mysql_mutex_assert_owner(&LOCK_global_user_client_stats);
+
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    mysql_mutex_lock(&shard->lock);
+    merge_user_stats_deltas(&global_user_stats, &shard->user_stats);
+    merge_user_stats_deltas(&global_client_stats, &shard->client_stats);
+    for (ulong idx= 0; idx < shard->thread_stats.records; idx++)
+    {
+      const THREAD_STATS *delta=
+        (THREAD_STATS *) my_hash_element(&shard->thread_stats, idx);
+      THREAD_STATS *thread_stats;
+
+      if ((thread_stats=
+           (THREAD_STATS *) my_hash_search(&global_thread_stats,
+                                           (uchar *) &delta->id,
+                                           sizeof(my_thread_id))))
+        add_thread_stats(thread_stats, delta);
+    }
+    my_hash_reset(&shard->thread_stats);
+    mysql_mutex_unlock(&shard->lock);
+  }
+}
+
+/*
+  Merges the table stats of all the userstat shards into
+  global_table_stats.  LOCK_global_table_stats must be held.
+*/
+void merge_table_stats_shards(void)
+{
+  mysql_mutex_assert_owner(&LOCK_global_table_stats);
+
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    mysql_mutex_lock(&shard->lock);
+    for (ulong idx= 0; idx < shard->table_stats.records; idx++)
+    {
+      const TABLE_STATS *delta=
+        (TABLE_STATS *) my_hash_element(&shard->table_stats, idx);
+      TABLE_STATS *table_stats;
+
+      if ((table_stats=
+           (TABLE_STATS *) my_hash_search(&global_table_stats,
+                                          (uchar *) delta->table,
+                                          delta->table_len)))
+      {
+        table_stats->rows_read+=              delta->rows_read;
+        table_stats->rows_changed+=           delta->rows_changed;
+        table_stats->rows_changed_x_indexes+= delta->rows_changed_x_indexes;
+        continue;
+      }
+      if (!(table_stats= (TABLE_STATS *) my_malloc(sizeof(TABLE_STATS),
+                                                   MYF(MY_WME))))
+      {
+        // Out of memory.
+        sql_print_error("Allocating table stats failed.");
+        break;
+      }
+      memcpy(table_stats, delta, sizeof(TABLE_STATS));
+      if (my_hash_insert(&global_table_stats, (uchar *) table_stats))
+      {
+        // Out of memory.
+        sql_print_error("Inserting table stats failed.");
+        my_free(table_stats);
+        break;
+      }
+    }
+    my_hash_reset(&shard->table_stats);
+    mysql_mutex_unlock(&shard->lock);
+  }
+}
+
+/*
+  Merges the index stats of all the userstat shards into
+  global_index_stats.  LOCK_global_index_stats must be held.
+*/
+void merge_index_stats_shards(void)
+{
+  mysql_mutex_assert_owner(&LOCK_global_index_stats);
+
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    mysql_mutex_lock(&shard->lock);
+    for (ulong idx= 0; idx < shard->index_stats.records; idx++)
+    {
+      const INDEX_STATS *delta=
+        (INDEX_STATS *) my_hash_element(&shard->index_stats, idx);
+      INDEX_STATS *index_stats;
+
+      if ((index_stats=
+           (INDEX_STATS *) my_hash_search(&global_index_stats,
+                                          (uchar *) delta->index,
+                                          delta->index_len)))
+      {
+        index_stats->rows_read+= delta->rows_read;
+        continue;
+      }
+      if (!(index_stats= (INDEX_STATS *) my_malloc(sizeof(INDEX_STATS),
+                                                   MYF(MY_WME))))
+      {
+        // Out of memory.
+        sql_print_error("Allocating index stats failed.");
+        break;
+      }
+      memcpy(index_stats, delta, sizeof(INDEX_STATS));
+      if (my_hash_insert(&global_index_stats, (uchar *) index_stats))
+      {
+        // Out of memory.
+        sql_print_error("Inserting index stats failed.");
+        my_free(index_stats);
+        break;
+      }
+    }
+    my_hash_reset(&shard->index_stats);
+    mysql_mutex_unlock(&shard->lock);
+  }
+}
+
+/*
+  Discards the unmerged stats of the userstat shards selected by the
+  REFRESH_*_STATS bits of 'options', for FLUSH ... STATISTICS.  The
+  matching LOCK_global_* mutexes must be held.
+*/
+void clear_userstat_shards(ulong options)
+{
+  for (uint i= 0; i < USERSTAT_SHARDS; i++)
+  {
+    USERSTAT_SHARD *shard= &userstat_shards[i];
+
+    mysql_mutex_lock(&shard->lock);
+    if (options & REFRESH_USER_STATS)
+      my_hash_reset(&shard->user_stats);
+    if (options & REFRESH_CLIENT_STATS)
+      my_hash_reset(&shard->client_stats);
+    if (options & REFRESH_THREAD_STATS)
+      my_hash_reset(&shard->thread_stats);
+    if (options & REFRESH_TABLE_STATS)
+      my_hash_reset(&shard->table_stats);
+    if (options & REFRESH_INDEX_STATS)
+      my_hash_reset(&shard->index_stats);
+    mysql_mutex_unlock(&shard->lock);
+  }
+}
+
 // 'mysql_system_user' is used for when the user is not defined for a THD.
 static char mysql_system_user[] = "#mysql_system#";
 
@@ -517,7 +782,7 @@ end:
   return return_value;
 }
 
-// Used to update the global user and client stats.
+// Adds the THD stats to the stats of a user or client.
 static void update_global_user_stats_with_user(THD* thd,
                                                USER_STATS* user_stats,
                                                time_t now)
@@ -568,84 +833,174 @@ static void update_global_thread_stats_with_thread(THD* thd,
   thread_stats->empty_queries+=        thd->diff_empty_queries;
 }
 
-// Updates the global stats of a user or client
-void update_global_user_stats(THD* thd, bool create_user, time_t now)
+/*
+  Returns the delta of a user or client in a userstat shard.  If 'global'
+  is not NULL the delta is created when missing, provided that the global
+  entry exists; otherwise the global entry is created if 'create_user' is
+  true.  Called with the shard lock held, and with
+  LOCK_global_user_client_stats held if 'global' is not NULL.
+*/
+static USER_STATS *get_user_stats_delta(HASH *deltas, HASH *global,
+                                        const char *name,
+                                        const char *role_name,
+                                        bool create_user, THD *thd)
 {
-  char* user_string=         get_valid_user_string(thd->main_security_ctx.user);
-  const char* client_string= get_client_host(thd);
-
   USER_STATS* user_stats;
-  THREAD_STATS* thread_stats;
 
-  if (acl_is_utility_user(thd->security_ctx->user,
-                          thd->security_ctx->get_host()->ptr(),
-                          thd->security_ctx->get_ip()->ptr()))
-    return;
+  if ((user_stats= (USER_STATS *) my_hash_search(deltas, (uchar *) name,
+                                                 strlen(name))) ||
+      !global)
+    return user_stats;
 
-  mysql_mutex_lock(&LOCK_global_user_client_stats);
-
-  // Update by user name
-  if ((user_stats = (USER_STATS *) my_hash_search(&global_user_stats,
-                                                  (uchar *) user_string,
-                                                  strlen(user_string))))
+  if (!my_hash_search(global, (uchar *) name, strlen(name)))
   {
-    // Found user.
-    update_global_user_stats_with_user(thd, user_stats, now);
-  }
-  else
-  {
-    // Create the entry
+    // The statement that creates the global entry is not counted in it.
     if (create_user)
-    {
-      increment_count_by_name(user_string, user_string,
-                              &global_user_stats, thd);
-    }
+      increment_count_by_name(name, role_name, global, thd);
+    return NULL;
   }
 
-  // Update by client IP
-  if ((user_stats = (USER_STATS *) my_hash_search(&global_client_stats,
-                                                  (uchar *) client_string,
-                                                  strlen(client_string))))
+  if (!(user_stats= ((USER_STATS *)
+                     my_malloc(sizeof(USER_STATS), MYF(MY_WME | MY_ZEROFILL)))))
+    return NULL; // Out of memory
+
+  init_user_stats(user_stats, name, role_name,
+                  0, 0, 0,   // connections
+                  0, 0, 0,   // time
+                  0, 0, 0,   // bytes sent, received and written
+                  0, 0, 0,   // rows fetched, updated and read
+                  0, 0, 0,   // select, update and other commands
+                  0, 0,      // commit and rollback trans
+                  0, 0,      // denied and lost connections
+                  0,         // access denied errors
+                  0);        // empty queries
+
+  if (my_hash_insert(deltas, (uchar *) user_stats))
   {
-    // Found by client IP
-    update_global_user_stats_with_user(thd, user_stats, now);
+    my_free((char *) user_stats);
+    return NULL; // Out of memory
   }
-  else
+  return user_stats;
+}
+
+/*
+  Returns the delta of a thread in a userstat shard, see
+  get_user_stats_delta().
+*/
+static THREAD_STATS *get_thread_stats_delta(HASH *deltas, HASH *global,
+                                            bool create_user, THD *thd)
+{
+  THREAD_STATS* thread_stats;
+
+  if ((thread_stats= (THREAD_STATS *) my_hash_search(deltas,
+                                                     (uchar *) &thd->thread_id,
+                                                     sizeof(my_thread_id))) ||
+      !global)
+    return thread_stats;
+
+  if (!my_hash_search(global, (uchar *) &thd->thread_id,
+                      sizeof(my_thread_id)))
   {
-    // Create the entry
     if (create_user)
-    {
-      increment_count_by_name(client_string,
-                              user_string,
-                              &global_client_stats, thd);
-    }
+      increment_count_by_id(thd->thread_id, global, thd);
+    return NULL;
+  }
+
+  if (!(thread_stats= ((THREAD_STATS *)
+                       my_malloc(sizeof(THREAD_STATS),
+                                 MYF(MY_WME | MY_ZEROFILL)))))
+    return NULL; // Out of memory
+
+  init_thread_stats(thread_stats, thd->thread_id,
+                    0, 0, 0,   // connections
+                    0, 0, 0,   // time
+                    0, 0, 0,   // bytes sent, received and written
+                    0, 0, 0,   // rows fetched, updated and read
+                    0, 0, 0,   // select, update and other commands
+                    0, 0,      // commit and rollback trans
+                    0, 0,      // denied and lost connections
+                    0,         // access denied errors
+                    0);        // empty queries
+
+  if (my_hash_insert(deltas, (uchar *) thread_stats))
+  {
+    my_free((char *) thread_stats);
+    return NULL; // Out of memory
   }
+  return thread_stats;
+}
+
+/*
+  Updates the stats of a user, client and thread.  The changes go to the
+  userstat shard of the thread and are merged into the global hashes when
+  those are read, so LOCK_global_user_client_stats is only taken here the
+  first time a user, client or thread is seen by the shard since the
+  last merge.
+*/
+void update_global_user_stats(THD* thd, bool create_user, time_t now)
+{
+  char* user_string=         get_valid_user_string(thd->main_security_ctx.user);
+  const char* client_string= get_client_host(thd);
+  USERSTAT_SHARD* shard=     get_userstat_shard(thd->thread_id);
+
+  USER_STATS* user_stats;
+  USER_STATS* client_stats;
+  THREAD_STATS* thread_stats= NULL;
+
+  if (acl_is_utility_user(thd->security_ctx->user,
+                          thd->security_ctx->get_host()->ptr(),
+                          thd->security_ctx->get_ip()->ptr()))
+    return;
+
+  mysql_mutex_lock(&shard->lock);
 
+  user_stats= get_user_stats_delta(&shard->user_stats, NULL, user_string,
+                                   user_string, create_user, thd);
+  client_stats= get_user_stats_delta(&shard->client_stats, NULL,
+                                     client_string, user_string,
+                                     create_user, thd);
   if (opt_thread_statistics)
+    thread_stats= get_thread_stats_delta(&shard->thread_stats, NULL,
+                                         create_user, thd);
+
+  if (!user_stats || !client_stats ||
+      (opt_thread_statistics && !thread_stats))
   {
-    // Update by thread ID
-    if ((thread_stats = (THREAD_STATS *) my_hash_search(&global_thread_stats,
-                                                        (uchar *) &(thd->thread_id),
-                                                        sizeof(my_thread_id))))
-    {
-      // Found by thread ID
-      update_global_thread_stats_with_thread(thd, thread_stats, now);
-    }
-    else
-    {
-      // Create the entry
-      if (create_user)
-      {
-        increment_count_by_id(thd->thread_id,
-                              &global_thread_stats, thd);
-      }
-    }
+    /*
+      The global lock is taken before the shard lock, as in
+      merge_user_client_stats_shards(), which may have reset the shard
+      in between.
+    */
+    mysql_mutex_unlock(&shard->lock);
+    mysql_mutex_lock(&LOCK_global_user_client_stats);
+    mysql_mutex_lock(&shard->lock);
+
+    user_stats= get_user_stats_delta(&shard->user_stats, &global_user_stats,
+                                     user_string, user_string,
+                                     create_user, thd);
+    client_stats= get_user_stats_delta(&shard->client_stats,
+                                       &global_client_stats,
+                                       client_string, user_string,
+                                       create_user, thd);
+    if (opt_thread_statistics)
+      thread_stats= get_thread_stats_delta(&shard->thread_stats,
+                                           &global_thread_stats,
+                                           create_user, thd);
+
+    mysql_mutex_unlock(&LOCK_global_user_client_stats);
   }
 
+  if (user_stats)
+    update_global_user_stats_with_user(thd, user_stats, now);
+  if (client_stats)
+    update_global_user_stats_with_user(thd, client_stats, now);
+  if (thread_stats)
+    update_global_thread_stats_with_thread(thd, thread_stats, now);
+
   thd->last_global_update_time = now;
   thd->reset_diff_stats();
 
-  mysql_mutex_unlock(&LOCK_global_user_client_stats);
+  mysql_mutex_unlock(&shard->lock);
 }
 
 static void clear_stats_concurrent_connections(HASH* stats)
@@ -222,6 +222,7 @@ JOIN::create_intermediate_table(JOIN_TAB *tab, List<Item> *tmp_table_fields,
 
   tab->tmp_table_param= new TMP_TABLE_PARAM(tmp_table_param);
   tab->tmp_table_param->skip_create_table= true;
+  tab->tmp_table_param->allow_hash_field= true;
   TABLE* table= create_tmp_table(thd, tab->tmp_table_param, *tmp_table_fields,
                                tmp_table_group, select_distinct && !group_list,
                                save_sum_fields, select_options, tmp_rows_limit, 
@@ -780,7 +781,7 @@ void setup_tmptable_write_func(JOIN_TAB *tab)
       Note for MyISAM tmp tables: if uniques is true keys won't be
       created.
     */
-    if (table->s->keys && !table->s->uniques)
+    if (table->s->keys && !table->s->uniques && !table->hash_field)
     {
       DBUG_PRINT("info",("Using end_update"));
       op->set_write_func(end_update);
@@ -3009,7 +3010,8 @@ end_write(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
     {
       int error;
       join->found_records++;
-      if ((error=table->file->ha_write_row(table->record[0])))
+      if ((error= check_unique_constraint(table)) ||
+          (error=table->file->ha_write_row(table->record[0])))
       {
         if (!table->file->is_fatal_error(error, HA_CHECK_DUP))
 	  goto end;
@@ -3140,19 +3142,34 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
   if (copy_funcs(join_tab->tmp_table_param->items_to_copy, join->thd))
     DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
 
-  if (!(error=table->file->ha_write_row(table->record[0])))
+  if (!(error= check_unique_constraint(table)) &&
+      !(error=table->file->ha_write_row(table->record[0])))
     join_tab->send_records++;			// New group
+  else if (table->hash_field && error != HA_ERR_FOUND_DUPP_KEY)
+  {
+    /* The HEAP table is full */
+    if (create_myisam_from_heap(join->thd, table,
+                                join_tab->tmp_table_param->start_recinfo,
+                                &join_tab->tmp_table_param->recinfo,
+                                error, FALSE, NULL))
+      DBUG_RETURN(NESTED_LOOP_ERROR);            // Not a table_is_full error
+    join_tab->send_records++;			// New group
+  }
   else
   {
-    if ((int) table->file->get_dup_key(error) < 0)
-    {
-      table->file->print_error(error,MYF(0));	/* purecov: inspected */
-      DBUG_RETURN(NESTED_LOOP_ERROR);            /* purecov: inspected */
-    }
-    if (table->file->ha_rnd_pos(table->record[1], table->file->dup_ref))
+    /* With a hash_field, the group was read by check_unique_constraint() */
+    if (!table->hash_field)
     {
-      table->file->print_error(error,MYF(0));	/* purecov: inspected */
-      DBUG_RETURN(NESTED_LOOP_ERROR);            /* purecov: inspected */
+      if ((int) table->file->get_dup_key(error) < 0)
+      {
+        table->file->print_error(error,MYF(0));	/* purecov: inspected */
+        DBUG_RETURN(NESTED_LOOP_ERROR);          /* purecov: inspected */
+      }
+      if (table->file->ha_rnd_pos(table->record[1], table->file->dup_ref))
+      {
+        table->file->print_error(error,MYF(0));	/* purecov: inspected */
+        DBUG_RETURN(NESTED_LOOP_ERROR);          /* purecov: inspected */
+      }
     }
     restore_record(table,record[1]);
     update_tmptable_sum_func(join->sum_funcs,table);
@@ -3444,8 +3461,8 @@ JOIN_TAB::remove_duplicates()
 
   free_io_cache(table);				// Safety
   table->file->info(HA_STATUS_VARIABLE);
-  if (table->s->db_type() == heap_hton ||
-      (!table->s->blob_fields &&
+  if (!table->s->blob_fields &&
+      (table->s->db_type() == heap_hton ||
        ((ALIGN_SIZE(reclength) + HASH_OVERHEAD) * table->file->stats.records <
 	join->thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, table,
@@ -4281,9 +4298,14 @@ QEP_tmp_table::prepare_tmp_table()
     (void) table->file->extra(HA_EXTRA_WRITE_CACHE);
     empty_record(table);
   }
-  /* If it wasn't already, start index scan for grouping using table index. */
-  if (!table->file->inited && table->group &&
-      join_tab->tmp_table_param->sum_func_count && table->s->keys)
+  /*
+    If it wasn't already, start index scan for grouping using table index,
+    or for the lookups of check_unique_constraint().
+  */
+  if (!table->file->inited &&
+      (table->hash_field ||
+       (table->group && join_tab->tmp_table_param->sum_func_count &&
+        table->s->keys)))
     rc= table->file->ha_index_init(0, 0);
   else
   {
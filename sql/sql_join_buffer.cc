@@ -1915,6 +1915,531 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
   return rc;
 }
 
+
+/* 
+  Check whether an equality can be used to build the hash key
+
+  SYNOPSIS
+    is_hash_join_cond()
+      eq          the equality predicate
+      inner_map   the table map of the joined table
+      outer_map   the tables whose records are accumulated in join buffers
+      hash_cond   OUT the sides of the equality, can be NULL
+
+  DESCRIPTION
+    The function checks whether the equality 'eq' compares a column of the
+    joined table with a column of one of the preceding tables so that two
+    values that are equal for the comparison always get the same hash value.
+    This is guaranteed for integer columns and for character columns when
+    the hash value is calculated with the collation of the comparison.
+    Temporal, decimal and floating point columns are not considered as
+    their comparisons may treat different representations as equal.
+
+  RETURN
+    TRUE   the equality can be used
+    FALSE  otherwise
+*/
+
+static bool is_hash_join_cond(Item_func *eq, table_map inner_map,
+                              table_map outer_map,
+                              JOIN_CACHE_HASH::HASH_JOIN_COND *hash_cond)
+{
+  Item_result res_type[2];
+  Item **args= eq->arguments();
+
+  for (uint i= 0; i < 2; i++)
+  {
+    Item *real_item= args[i]->real_item();
+    if (real_item->type() != Item::FIELD_ITEM)
+      return FALSE;
+    switch (((Item_field *) real_item)->field->real_type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      res_type[i]= INT_RESULT;
+      break;
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+      res_type[i]= STRING_RESULT;
+      break;
+    default:
+      return FALSE;
+    }
+  }
+  if (res_type[0] != res_type[1])
+    return FALSE;
+
+  uint inner_arg;
+  if (args[0]->used_tables() == inner_map)
+    inner_arg= 0;
+  else if (args[1]->used_tables() == inner_map)
+    inner_arg= 1;
+  else
+    return FALSE;
+
+  table_map used_outer= args[1-inner_arg]->used_tables();
+  if (!used_outer || (used_outer & ~outer_map))
+    return FALSE;
+
+  if (hash_cond)
+  {
+    hash_cond->inner_item= args[inner_arg];
+    hash_cond->outer_item= args[1-inner_arg];
+    hash_cond->cs= res_type[0] == STRING_RESULT ?
+                   ((Item_func_eq *) eq)->compare_collation() : NULL;
+  }
+  return TRUE;
+}
+
+
+/* 
+  Collect the equalities usable to join a table with a hash table
+
+  SYNOPSIS
+    find_hash_conds()
+      tab         the joined table
+      cond        the condition to look for equalities in
+      conds       OUT array to store the found equalities in, can be NULL
+      count       the number of equalities already stored in 'conds'
+
+  DESCRIPTION
+    The function looks for the equalities that are conjuncts of 'cond' and
+    that can be used to build the hash key for the records from the join
+    buffer of 'tab'. Conjuncts guarded by the 'not_null_compl' flag of 'tab'
+    are also looked through as the flag is always on when matches for the
+    records from the join buffer are searched for.
+    If 'conds' is NULL the function only counts the found equalities. 
+    At most MAX_REF_PARTS equalities are collected.
+
+  RETURN
+    the number of equalities found including the 'count' ones found before
+*/
+
+uint JOIN_CACHE_HASH::find_hash_conds(JOIN_TAB *tab, Item *cond,
+                                      HASH_JOIN_COND *conds, uint count)
+{
+  if (!cond || count >= MAX_REF_PARTS)
+    return count;
+
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond *) cond)->functype() != Item_func::COND_AND_FUNC)
+      return count;
+    List_iterator<Item> li(*((Item_cond *) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+      count= find_hash_conds(tab, item, conds, count);
+    return count;
+  }
+
+  if (cond->type() != Item::FUNC_ITEM)
+    return count;
+
+  Item_func *func= (Item_func *) cond;
+  switch (func->functype()) {
+  case Item_func::TRIG_COND_FUNC:
+    if (tab->is_first_inner_for_outer_join() &&
+        ((Item_func_trig_cond *) func)->get_trig_var() == &tab->not_null_compl)
+      count= find_hash_conds(tab, func->arguments()[0], conds, count);
+    break;
+  case Item_func::EQ_FUNC:
+    {
+      table_map inner_map= tab->table->map;
+      table_map outer_map= tab->prefix_tables() & ~inner_map & ~PSEUDO_TABLE_BITS;
+      if (is_hash_join_cond(func, inner_map, outer_map,
+                            conds ? conds+count : NULL))
+        count++;
+    }
+    break;
+  default:
+    break;
+  }
+  return count;
+}
+
+
+/* 
+  Initialize a hash join cache       
+
+  SYNOPSIS
+    init()
+
+  DESCRIPTION
+    The function initializes the cache structure. It supposed to be called
+    right after a constructor for the JOIN_CACHE_HASH.
+    Additionally to what JOIN_CACHE_BNL::init does the function collects
+    the equalities the hash values are calculated over, reserves space for
+    the chain header of each record and places the hash table at the end
+    of the join buffer. The number of hash entries is estimated by the
+    maximal number of records that can be put into the buffer.
+
+  RETURN
+    0   initialization with buffer allocations has been succeeded
+    1   otherwise
+*/
+
+int JOIN_CACHE_HASH::init()
+{
+  int rc;
+  DBUG_ENTER("JOIN_CACHE_HASH::init");
+
+  hash_table= 0;
+
+  if ((rc= JOIN_CACHE_BNL::init()))
+    DBUG_RETURN(rc);
+
+  hash_conds= (HASH_JOIN_COND *) sql_alloc(sizeof(HASH_JOIN_COND) *
+                                           MAX_REF_PARTS);
+  if (!hash_conds)
+    DBUG_RETURN(1);
+  hash_cond_count= find_hash_conds(join_tab, join_tab->condition(),
+                                   hash_conds, 0);
+  if (!hash_cond_count)
+    DBUG_RETURN(1);
+
+  /* Take into account the chain header of each record */
+  hash_node_length= get_size_of_rec_offset()+sizeof(uint32);
+  pack_length+= hash_node_length;
+  pack_length_with_blob_ptrs+= hash_node_length;
+
+  /*
+    One hash entry per record that can be put into the buffer: this keeps
+    the chains short and leaves room for at least one record.
+  */
+  hash_entries= max(1U, (uint) (buff_size / (pack_length+
+                                             get_size_of_rec_offset())));
+
+  /* Initialize the hash table */
+  hash_table= buff + (buff_size-hash_entries*get_size_of_rec_offset());
+  cleanup_hash_table();
+
+  DBUG_RETURN(0);
+}
+
+
+/* 
+  Reset the JOIN_CACHE_HASH buffer for reading/writing
+
+  SYNOPSIS
+    reset_cache()
+      for_writing  if it's TRUE the function reset the buffer for writing
+
+  DESCRIPTION
+    Additionally to what the default implementation does this function
+    cleans up the hash table when the buffer is reset for writing.
+    
+  RETURN
+    none
+*/
+
+void JOIN_CACHE_HASH::reset_cache(bool for_writing)
+{
+  this->JOIN_CACHE::reset_cache(for_writing);
+  if (for_writing && hash_table)
+    cleanup_hash_table();
+}
+
+
+/* 
+  Clean up the hash table of the join buffer
+
+  SYNOPSIS
+    cleanup_hash_table()
+
+  DESCRIPTION
+    The function removes all chains from the hash table. 
+
+  RETURN
+    none  
+*/
+
+void JOIN_CACHE_HASH::cleanup_hash_table()
+{
+  memset(hash_table, 0, (buff+buff_size)-hash_table);
+}
+
+
+/* 
+  Calculate the hash value over one side of the hash join equalities
+
+  SYNOPSIS
+    calc_hash()
+      outer       TRUE  - use the sides over the buffered tables
+                  FALSE - use the sides over the joined table
+      hash_val    OUT the calculated hash value
+
+  DESCRIPTION
+    The function evaluates the chosen sides of all equalities from
+    'hash_conds' over the current contents of the record buffers and
+    calculates the hash value for them. Character values are hashed with
+    the collation of the comparison, so that strings that are equal for
+    the comparison get the same hash value.
+
+  RETURN
+    TRUE   one of the values is NULL, the record cannot have any match
+    FALSE  otherwise
+*/
+
+bool JOIN_CACHE_HASH::calc_hash(bool outer, ulong *hash_val)
+{
+  ulong nr1= 1;
+  ulong nr2= 4;
+  HASH_JOIN_COND *cond= hash_conds;
+  HASH_JOIN_COND *cond_end= hash_conds+hash_cond_count;
+
+  for ( ; cond < cond_end; cond++)
+  {
+    Item *item= outer ? cond->outer_item : cond->inner_item;
+    if (cond->cs)
+    {
+      StringBuffer<MAX_FIELD_WIDTH> tmp(cond->cs);
+      String *str= item->val_str(&tmp);
+      if (item->null_value)
+        return TRUE;
+      cond->cs->coll->hash_sort(cond->cs, (const uchar *) str->ptr(),
+                                str->length(), &nr1, &nr2);
+    }
+    else
+    {
+      uchar buf[8];
+      longlong val= item->val_int();
+      if (item->null_value)
+        return TRUE;
+      int8store(buf, val);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buf, sizeof(buf),
+                                     &nr1, &nr2);
+    }
+  }
+  *hash_val= nr1;
+  return FALSE;
+}
+
+
+/* 
+  Add a record into the JOIN_CACHE_HASH buffer
+
+  SYNOPSIS
+    put_record_in_cache()
+
+  DESCRIPTION
+    This implementation of the virtual function put_record writes the next
+    matching record into the join buffer of the JOIN_CACHE_HASH class
+    prepending it with the chain header. Then it calculates the hash value
+    of the record and adds the record to the end of the chain of the
+    corresponding hash entry. The record is not added to any chain if one
+    of its values the hash value is calculated over is NULL.
+    
+  RETURN
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer,
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_HASH::put_record_in_cache()
+{
+  ulong hash_val;
+  uchar *node= pos+get_size_of_rec_offset();
+  pos+= hash_node_length;
+
+  // Write record to join buffer
+  bool is_full= JOIN_CACHE::put_record_in_cache();
+
+  if (calc_hash(TRUE, &hash_val))
+    return is_full;
+
+  int4store(node, (uint32) hash_val);
+  uchar *entry= get_hash_entry(hash_val);
+  ulong last_ofs= get_offset(get_size_of_rec_offset(), entry);
+  if (last_ofs)
+  {
+    /* rec->next_rec= last_rec->next_rec; last_rec->next_rec= rec */
+    uchar *last_node= buff+last_ofs;
+    store_rec_ref(node, get_rec_ref(last_node));
+    store_rec_ref(last_node, node);
+  }
+  else
+    store_rec_ref(node, node);
+  store_offset(get_size_of_rec_offset(), entry, (ulong) (node-buff));
+  return is_full;
+}
+
+
+/*
+  Read the next record from the JOIN_CACHE_HASH buffer
+
+  SYNOPSIS
+    get_record()
+
+  DESCRIPTION
+    Additionally to what the default implementation of the virtual 
+    function get_record does this implementation skips the chain header
+    of the record.
+
+  RETURN
+    TRUE  - there are no more records to read from the join buffer
+    FALSE - otherwise
+*/
+
+bool JOIN_CACHE_HASH::get_record()
+{ 
+  pos+= hash_node_length;
+  return this->JOIN_CACHE::get_record();
+}
+
+
+/* 
+  Skip record from the JOIN_CACHE_HASH join buffer if its match flag is on
+
+  SYNOPSIS
+    skip_record_if_match()
+
+  DESCRIPTION
+    This implementation of the virtual function skip_record_if_match does
+    the same as the default implementation does, but it takes into account
+    the chain header of the record.
+
+  RETURN
+    TRUE  - the match flag is on and the record has been skipped
+    FALSE - the match flag is off 
+*/
+
+bool JOIN_CACHE_HASH::skip_record_if_match()
+{
+  uchar *save_pos= pos;
+  pos+= hash_node_length;
+  if (!this->JOIN_CACHE::skip_record_if_match())
+  {
+    pos= save_pos;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Using a hash table find matches from the next table for records from
+  the join buffer
+
+  SYNOPSIS
+    join_matching_records()
+      skip_last    do not look for matches for the last partial join record 
+
+  DESCRIPTION
+    The function retrieves all rows of the join_tab table the same way
+    JOIN_CACHE_BNL::join_matching_records does. For each row it calculates
+    the hash value over the equalities from 'hash_conds' and then checks
+    only the records from the chain of the corresponding hash entry. 
+    The records from the chain are visited in the order they were put into
+    the join buffer, so the matches are produced in the same order as
+    with the BNL algorithm.  
+
+  RETURN
+    return one of enum_nested_loop_state.
+*/ 
+
+enum_nested_loop_state JOIN_CACHE_HASH::join_matching_records(bool skip_last)
+{
+  int error;
+  READ_RECORD *info;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  SQL_SELECT *select= join_tab->cache_select;
+
+  join_tab->table->null_row= 0;
+
+  /* Return at once if there are no records in the join buffer */
+  if (!records)     
+    return NESTED_LOOP_OK;   
+ 
+  if (skip_last)     
+    put_record_in_cache();     
+ 
+  if (join_tab->use_quick == QS_DYNAMIC_RANGE && join_tab->select->quick)
+    /* A dynamic range access was used last. Clean up after it */
+    join_tab->select->set_quick(NULL);
+
+  /* Start retrieving all records of the joined table */
+  if ((error= (*join_tab->read_first_record)(join_tab))) 
+    return error < 0 ? NESTED_LOOP_OK : NESTED_LOOP_ERROR;
+
+  info= &join_tab->read_record;
+  do
+  {
+    if (join_tab->keep_current_rowid)
+      join_tab->table->file->position(join_tab->table->record[0]);
+
+    if (join->thd->killed)
+    {
+      /* The user has aborted the execution of the query */
+      join->thd->send_kill_message();
+      return NESTED_LOOP_KILLED;
+    }
+    
+    /* 
+      Do not look for matches if the last read record of the joined table
+      does not meet the conditions that have been pushed to this table
+    */
+    if (rc == NESTED_LOOP_OK)
+    {
+      bool skip_record;
+      ulong hash_val;
+      bool consider_record= (!select || 
+                             (!select->skip_record(join->thd, &skip_record) &&
+                              !skip_record));
+      if (select && join->thd->is_error())
+        return NESTED_LOOP_ERROR;
+      /* A row with a NULL value in a hash column cannot match any record */
+      if (consider_record && !calc_hash(FALSE, &hash_val))
+      {
+        ulong last_ofs= get_offset(get_size_of_rec_offset(),
+                                   get_hash_entry(hash_val));
+        if (!last_ofs)
+          continue;
+        uchar *last_node= buff+last_ofs;
+        uchar *node= last_node;
+        /* Read the records from the chain and look for matches */
+        do
+        {
+          node= get_rec_ref(node);
+          if (uint4korr(node) != (uint32) hash_val)
+            continue;
+          uchar *rec_ptr= get_node_rec(node);
+          if (skip_last && rec_ptr == last_rec_pos)
+            continue;
+          /* 
+            If only the first match is needed and it has been already found
+            for the record from the join buffer then the record is skipped.
+          */
+          if (check_only_first_match && get_match_flag_by_pos(rec_ptr))
+            continue;
+          curr_rec_pos= rec_ptr;
+          get_record_by_pos(rec_ptr);
+          rc= generate_full_extensions(rec_ptr);
+          if (rc != NESTED_LOOP_OK)
+            return rc;
+        } while (node != last_node);
+      }
+    }
+  } while (!(error= info->read_record(info)));
+
+  if (error > 0)				// Fatal error
+    return NESTED_LOOP_ERROR; 
+
+  if (skip_last)
+  {
+    /* 
+      Leave the read position at the last record as the BNL scan does
+      for the caller to restore it.
+    */
+    reset_cache(false);
+    for (uint cnt= records - 1; cnt; cnt--)
+      get_record();
+  }
+  return rc;
+}
+
      
 /*
   Set match flag for a record in join buffer if it has not been set yet    
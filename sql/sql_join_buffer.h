@@ -496,9 +496,11 @@ public:
   }
 
   /** Bits describing cache's type @sa setup_join_buffering() */
-  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4};
+  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4,
+        ALG_HASH= 8};
 
   friend class JOIN_CACHE_BNL;
+  friend class JOIN_CACHE_HASH;
   friend class JOIN_CACHE_BKA;
   friend class JOIN_CACHE_BKA_UNIQUE;
 };
@@ -521,6 +523,136 @@ public:
 
 };
 
+/*
+  The class JOIN_CACHE_HASH supports a variant of the BNL join algorithm
+  for join conditions that contain equalities between columns of the
+  joined table and columns of the tables whose records are accumulated
+  in the join buffer. Instead of matching every row of the joined table
+  against every record from the join buffer, the records are linked into
+  chains by the hash value calculated over their sides of the equalities.
+  A row of the joined table is then only matched against the records from
+  the chain its own hash value points to.
+  The hash table is placed at the very end of the join buffer. Each entry
+  of it refers to the last record of a circular chain of records having
+  the same hash index. Any record representation in the buffer starts with
+  a reference to the next record in its chain followed by the full hash
+  value of the record:
+    struct st_join_cache_hash_node {
+      cache_ref *next_rec; // offset from the beginning of the buffer
+      uint32 hash_value;
+    }
+  Records with a NULL value in any of their equality columns cannot match
+  anything and are not linked into any chain, yet they are still stored
+  in the buffer to get null complemented rows for outer joins.
+  As with BNL, when the buffer is full all matches for the records in it
+  are generated with one scan of the joined table after which the buffer
+  is refilled, so the memory used never exceeds join_buffer_size.
+*/
+
+class JOIN_CACHE_HASH :public JOIN_CACHE_BNL
+{
+public:
+
+  /* An equality usable to build the hash key */
+  typedef struct st_hash_join_cond
+  {
+    /* The side of the equality evaluated over the buffered records */
+    Item *outer_item;
+    /* The side of the equality evaluated over the rows of join_tab */
+    Item *inner_item;
+    /* Collation used for the comparison, NULL for integer comparisons */
+    const CHARSET_INFO *cs;
+  } HASH_JOIN_COND;
+
+private:
+
+  /* Equalities the hash values are calculated over */
+  HASH_JOIN_COND *hash_conds;
+  /* Number of elements in hash_conds */
+  uint hash_cond_count;
+
+  /* The beginning of the hash table in the join buffer */
+  uchar *hash_table;
+  /* Number of entries in the hash table */
+  uint hash_entries;
+
+  /* Length of the chain header prepended to every record */
+  uint hash_node_length;
+
+  /*
+    Reserve space for the chain header of a record and for one hash entry
+    so that at least one record always fits into the join buffer.
+  */
+  uint aux_buffer_min_size() const
+  {
+    return 2*sizeof(ulonglong)+sizeof(uint32);
+  }
+
+  /* Calculate the hash value over one side of the equalities */
+  bool calc_hash(bool outer, ulong *hash_val);
+
+  void cleanup_hash_table();
+
+  /* Get the hash table entry for the hash value hash_val */
+  uchar *get_hash_entry(ulong hash_val)
+  {
+    return hash_table+get_size_of_rec_offset()*(hash_val % hash_entries);
+  }
+
+  /* 
+    Get the position of the first field of the record whose chain header
+    has its hash value at the position node.
+  */
+  uchar *get_node_rec(uchar *node)
+  {
+    return node+sizeof(uint32)+
+           (with_length ? get_size_of_rec_length() : 0)+
+           (prev_cache ? prev_cache->get_size_of_rec_offset() : 0);
+  }
+
+protected:
+
+  /* 
+    Calculate how much space in the buffer would not be occupied by
+    records and the hash table.
+  */ 
+  ulong rem_space() 
+  { 
+    return static_cast<ulong>(
+      std::max<long>(hash_table-end_pos-aux_buff_size, 0L)
+    );
+  }
+
+  /* Skip record from JOIN_CACHE_HASH buffer if its match flag is on */
+  bool skip_record_if_match();
+
+  /* Using the hash table find matches for records from join buffer */
+  enum_nested_loop_state join_matching_records(bool skip_last);
+
+  /* Add a record into the JOIN_CACHE_HASH buffer */
+  bool put_record_in_cache();
+
+public:
+
+  JOIN_CACHE_HASH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev)
+    : JOIN_CACHE_BNL(j, tab, prev), hash_conds(NULL), hash_cond_count(0),
+      hash_table(NULL), hash_entries(0), hash_node_length(0)
+  {}
+
+  /* Initialize the hash join cache */       
+  int init();
+
+  /* Reset the JOIN_CACHE_HASH buffer for reading/writing */
+  void reset_cache(bool for_writing);
+
+  /* Read the next record from the JOIN_CACHE_HASH buffer */
+  bool get_record();
+
+  /* Collect the equalities of cond usable to join tab with a hash table */
+  static uint find_hash_conds(JOIN_TAB *tab, Item *cond,
+                              HASH_JOIN_COND *conds, uint count);
+};
+
 class JOIN_CACHE_BKA :public JOIN_CACHE
 {
 protected:
@@ -38,6 +38,7 @@ class sp_head;
 class sp_name;
 class sp_instr;
 class sp_pcontext;
+class Cached_plan;
 class st_alter_tablespace;
 class partition_info;
 class Event_parse_data;
@@ -718,6 +719,13 @@ public:
   List<Item_func_match> *ftfunc_list;
   List<Item_func_match> ftfunc_list_alloc;
   JOIN *join; /* after JOIN::prepare it is pointer to corresponding JOIN */
+  /**
+    Join order kept across executions of a prepared statement or stored
+    program statement when optimizer_plan_cache is on, or NULL. Lives on
+    the statement MEM_ROOT, so it goes away when the statement is
+    reprepared after a metadata change.
+  */
+  Cached_plan *cached_plan;
   List<TABLE_LIST> top_join_list; /* join list of the top level          */
   List<TABLE_LIST> *join_list;    /* list for the currently parsed join  */
   TABLE_LIST *embedding;          /* table embedding to the above list   */
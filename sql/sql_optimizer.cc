@@ -39,6 +39,7 @@
 #include "lock.h"
 #include "abstract_query_plan.h"
 #include "opt_explain_format.h"  // Explain_format_flags
+#include "histogram.h"           // histogram_selectivity
 
 #include <algorithm>
 using std::max;
@@ -3718,12 +3719,36 @@ const_table_extraction_done:
                             1, &error);
         if (!select)
           goto error;
+        /*
+          With a cached plan only the indexes of the cached access path
+          are analyzed, as long as their estimate stays about the same.
+        */
+        Cached_plan *const plan= Cached_plan::usable_for_ranges(thd, join);
+        key_map keys(s->const_keys);
+        const bool restricted=
+          plan && plan->range_keys(s - stat, s->const_keys, &keys);
         records= get_quick_record_count(thd, select, s->table,
-                                        &s->const_keys, join->row_limit);
+                                        &keys, join->row_limit);
 
         if (records == 0 && thd->is_fatal_error)
           DBUG_RETURN(true);
 
+        if (restricted)
+        {
+          const bool kept=
+            plan->keep_range(thd, s - stat, select->quick, records);
+          trace_table.add_alnum("cached_range_access",
+                                kept ? "reused" : "rejected");
+          if (!kept)
+          {
+            Opt_trace_object trace_all(trace, "analyzing_all_indexes");
+            records= get_quick_record_count(thd, select, s->table,
+                                            &s->const_keys, join->row_limit);
+            if (records == 0 && thd->is_fatal_error)
+              DBUG_RETURN(true);
+          }
+        }
+
         s->quick= select->quick;
         s->needed_reg= select->needed_reg;
         select->quick= 0;
@@ -3773,6 +3798,21 @@ const_table_extraction_done:
         Opt_trace_object(trace, "table_scan").
           add("rows", s->found_records).
           add("cost", s->read_time);
+
+      /*
+        Estimate which fraction of the rows satisfy the conditions on
+        non-indexed columns, with the same restrictions as range analysis.
+      */
+      if (s->type != JT_CONST &&
+          (!tl->embedding || tl->embedding->sj_on_expr))
+      {
+        s->histogram_selectivity=
+          histogram_selectivity(thd, s->table,
+                                *s->on_expr_ref ? *s->on_expr_ref : conds,
+                                &s->histograms_used);
+        if (s->histograms_used)
+          trace_table.add("histogram_selectivity", s->histogram_selectivity);
+      }
     }
   }
 
@@ -9769,13 +9809,13 @@ bool JOIN::compare_costs_of_subquery_strategies(
         /*
           Subquery is attached to a certain 'pos', pos[-1].prefix_record_count
           is the number of times we'll start a loop accessing 'pos'; each such
-          loop will read pos->records_read records of 'pos', so subquery will
-          be evaluated pos[-1].prefix_record_count * pos->records_read times.
+          loop will produce pos->fanout() records of 'pos', so subquery will
+          be evaluated pos[-1].prefix_record_count * pos->fanout() times.
           Exceptions:
           - if 'pos' is first, use 1 instead of pos[-1].prefix_record_count
           - if 'pos' is first of a sjerialization-mat nest, same.
 
-          If in a sj-materialization nest, pos->records_read and
+          If in a sj-materialization nest, pos->fanout() and
           pos[-1].prefix_record_count are of the "nest materialization" plan
           (copied back in fix_semijoin_strategies()), which is
           appropriate as it corresponds to evaluations of our subquery.
@@ -9784,7 +9824,7 @@ bool JOIN::compare_costs_of_subquery_strategies(
         DBUG_ASSERT((int)idx >= 0 && idx < parent_join->tables);
         trace_parent.add("subq_attached_to_table", true);
         trace_parent.add_utf8_table(parent_join->join_tab[idx].table);
-        parent_fanout= parent_join->join_tab[idx].position->records_read;
+        parent_fanout= parent_join->join_tab[idx].position->fanout();
         if ((idx > parent_join->const_tables) &&
             !sj_is_materialize_strategy(parent_join
                                         ->join_tab[idx].position->sj_strategy))
@@ -1153,10 +1153,11 @@ bool Optimize_table_order::choose_table_order()
                Opt_trace_context::GREEDY_SEARCH);
   if (straight_join)
     optimize_straight_join(join_tables);
-  else
+  else if (!use_cached_plan(join_tables))
   {
     if (greedy_search(join_tables))
       DBUG_RETURN(true);
+    store_cached_plan();
   }
 
   // Remaining part of this function not needed when processing semi-join nests.
@@ -1275,7 +1276,7 @@ void Optimize_table_order::optimize_straight_join(table_map join_tables)
                      position, &loose_scan_pos);
 
     /* compute the cost of the new plan extended with 's' */
-    record_count*= position->records_read;
+    record_count*= position->fanout();
     read_time+=    position->read_time;
     read_time+=    record_count * ROW_EVALUATE_COST;
     position->set_prefix_costs(read_time, record_count);
@@ -1310,6 +1311,318 @@ void Optimize_table_order::optimize_straight_join(table_map join_tables)
 }
 
 
+/**
+  Check whether two fanout estimates of a table are close enough for a
+  cached join order to remain the one the search would choose: within a
+  factor of two, counting one extra row so that estimates of a few rows
+  may vary more.
+*/
+
+static bool similar_fanout(double cached, double current)
+{
+  const double a= cached + 1.0;
+  const double b= current + 1.0;
+  return a <= 2.0 * b && b <= 2.0 * a;
+}
+
+
+/**
+  Check whether the join order of the query block may be kept in
+  st_select_lex::cached_plan: it must be a complete plan with at least
+  one non-constant table, for a prepared statement or stored program
+  statement, whose query blocks are optimized again at each execution.
+  A single table has no order to search, but its range access is kept.
+*/
+
+bool Optimize_table_order::plan_is_cacheable() const
+{
+  return thd->variables.optimizer_plan_cache &&
+         emb_sjm_nest == NULL && join->allow_outer_refs &&
+         join->tables > join->const_tables &&
+         !thd->stmt_arena->is_conventional();
+}
+
+
+/**
+  Try to reuse the join order cached for the query block by a previous
+  execution instead of searching for one.
+
+    The cached order is rejected if the constant tables or the optimizer
+    settings changed. Otherwise the access methods are computed again in
+    the cached order with optimize_straight_join(), so that they reflect
+    the current statistics and parameter values, and the order is kept
+    only if every table gets the same index and about the same fanout as
+    when the order was chosen. A different index or fanout means that the
+    search could pick another order, and the caller searches again.
+
+    Changes of table metadata need no check here: the Reprepare_observer
+    makes the statement be prepared again, with new query blocks.
+
+  @param join_tables   set of the tables to order
+
+  @return true if the cached order was used and join->best_positions is
+          set, false if the caller must search for a join order
+*/
+
+bool Optimize_table_order::use_cached_plan(table_map join_tables)
+{
+  if (!plan_is_cacheable())
+    return false;
+
+  Cached_plan *const plan= join->select_lex->cached_plan;
+  const uint n_tables= join->tables - join->const_tables;
+
+  if (plan == NULL ||
+      plan->tables != join->tables ||
+      plan->const_tables != join->const_tables ||
+      plan->const_table_map != join->const_table_map ||
+      plan->optimizer_switch != thd->variables.optimizer_switch ||
+      plan->search_depth != thd->variables.optimizer_search_depth ||
+      plan->prune_level != thd->variables.optimizer_prune_level)
+  {
+    status_var_increment(thd->status_var.plan_cache_misses);
+    return false;
+  }
+
+  JOIN_TAB **const order= join->best_ref + join->const_tables;
+  JOIN_TAB *saved_order[MAX_TABLES];
+
+  memcpy(saved_order, order, sizeof(JOIN_TAB*) * n_tables);
+  for (uint i= 0; i < n_tables; i++)
+    order[i]= join->join_tab + plan->order[i].tab_idx;
+
+  optimize_straight_join(join_tables);
+
+  bool reused= true;
+  for (uint i= 0; i < n_tables && reused; i++)
+  {
+    const POSITION *const pos= join->best_positions + join->const_tables + i;
+    const Cached_plan::Table_plan *const cached= plan->order + i;
+
+    reused= (pos->key ? pos->key->key : MAX_KEY) == cached->key &&
+            pos->sj_strategy == cached->sj_strategy &&
+            similar_fanout(cached->fanout, pos->fanout());
+  }
+
+  Opt_trace_object(&thd->opt_trace).
+    add_alnum("cached_plan", reused ? "reused" : "rejected");
+
+  if (reused)
+  {
+    plan->ranges_restricted= false;
+    status_var_increment(thd->status_var.plan_cache_hits);
+    return true;
+  }
+
+  /* Start the search from the state optimize_straight_join() started in */
+  memcpy(order, saved_order, sizeof(JOIN_TAB*) * n_tables);
+  reset_nj_counters(join->join_list);
+  cur_embedding_map= 0;
+
+  status_var_increment(thd->status_var.plan_cache_invalidations);
+  status_var_increment(thd->status_var.plan_cache_misses);
+  return false;
+}
+
+
+/**
+  Remember the join order found by greedy_search() in
+  st_select_lex::cached_plan for the next executions of the statement.
+  The cache is allocated on the statement MEM_ROOT, once for the query
+  block, and overwritten when the order is searched again.
+*/
+
+void Optimize_table_order::store_cached_plan()
+{
+  if (!plan_is_cacheable())
+    return;
+
+  MEM_ROOT *const mem_root= thd->stmt_arena->mem_root;
+  const uint n_tables= join->tables - join->const_tables;
+  Cached_plan *plan= join->select_lex->cached_plan;
+
+  if (plan == NULL)
+  {
+    if (!(plan= new (mem_root) Cached_plan))
+      return;
+    plan->alloced= 0;
+    plan->order= NULL;
+    plan->ranges_restricted= false;
+    join->select_lex->cached_plan= plan;
+  }
+
+  if (plan->alloced < n_tables)
+  {
+    Cached_plan::Table_plan *order= static_cast<Cached_plan::Table_plan*>(
+      alloc_root(mem_root, sizeof(Cached_plan::Table_plan) * n_tables));
+    if (order == NULL)
+    {
+      join->select_lex->cached_plan= NULL;
+      return;
+    }
+    plan->order= order;
+    plan->alloced= n_tables;
+  }
+
+  plan->tables= join->tables;
+  plan->const_tables= join->const_tables;
+  plan->const_table_map= join->const_table_map;
+  plan->optimizer_switch= thd->variables.optimizer_switch;
+  plan->search_depth= thd->variables.optimizer_search_depth;
+  plan->prune_level= thd->variables.optimizer_prune_level;
+
+  for (uint i= 0; i < n_tables; i++)
+  {
+    const POSITION *const pos= join->best_positions + join->const_tables + i;
+    Cached_plan::Table_plan *const cached= plan->order + i;
+
+    cached->tab_idx= pos->table - join->join_tab;
+    cached->key= pos->key ? pos->key->key : MAX_KEY;
+    cached->sj_strategy= pos->sj_strategy;
+    cached->fanout= pos->fanout();
+
+    QUICK_SELECT_I *const quick= pos->table->quick;
+    cached->quick_key= quick ? quick->index : MAX_KEY;
+    cached->range_rows= pos->table->found_records;
+    const TABLE *const table= pos->table->table;
+    cached->cond_key= MAX_KEY;
+    for (uint key= 0; key < table->s->keys; key++)
+    {
+      if (table->quick_keys.is_set(key) &&
+          (cached->cond_key == MAX_KEY ||
+           table->quick_rows[key] < table->quick_rows[cached->cond_key]))
+        cached->cond_key= key;
+    }
+    cached->range_cached= !plan->ranges_restricted &&
+      (quick == NULL || quick->get_type() == QUICK_SELECT_I::QS_TYPE_RANGE);
+  }
+  plan->ranges_restricted= false;
+}
+
+
+/**
+  Return the plan cached for the query block of the join if the range
+  analysis of the current execution may use it, or NULL. The plan must
+  be for the same tables, constant tables and optimizer settings.
+  Called by make_join_statistics() before the join order is chosen.
+*/
+
+Cached_plan *Cached_plan::usable_for_ranges(THD *thd, JOIN *join)
+{
+  Cached_plan *const plan= join->select_lex->cached_plan;
+
+  if (!thd->variables.optimizer_plan_cache ||
+      thd->stmt_arena->is_conventional() ||
+      plan == NULL ||
+      plan->tables != join->tables ||
+      plan->const_table_map != join->const_table_map ||
+      plan->optimizer_switch != thd->variables.optimizer_switch ||
+      plan->search_depth != thd->variables.optimizer_search_depth ||
+      plan->prune_level != thd->variables.optimizer_prune_level)
+    return NULL;
+  return plan;
+}
+
+
+/**
+  Find the cached access path of a table.
+
+  @param tab_idx   index of the table in JOIN::join_tab
+
+  @return the cached access path, or NULL if the table was constant
+*/
+
+const Cached_plan::Table_plan *Cached_plan::table_plan(uint tab_idx) const
+{
+  for (uint i= 0; i < tables - const_tables; i++)
+  {
+    if (order[i].tab_idx == tab_idx)
+      return order + i;
+  }
+  return NULL;
+}
+
+
+/**
+  Restrict the range analysis of a table to the indexes of its cached
+  range and ref accesses, and to the index with the lowest estimate,
+  which limits the rows of a table scan.
+
+  The conditions of a prepared statement usually allow the same indexes
+  at every execution, and range analysis estimates the rows of each of
+  them, which costs an index dive per range. With a cached access path
+  only the indexes that the previous execution chose are estimated
+  again. keep_range() then checks the estimate.
+
+  @param tab_idx      index of the table in JOIN::join_tab
+  @param const_keys   indexes range analysis could use, JOIN_TAB::const_keys
+  @param[out] keys    indexes to analyze
+
+  @return true if keys is set, false if every index must be analyzed
+*/
+
+bool Cached_plan::range_keys(uint tab_idx, const key_map &const_keys,
+                             key_map *keys)
+{
+  const Table_plan *const cached= table_plan(tab_idx);
+  if (cached == NULL || !cached->range_cached)
+    return false;
+
+  keys->clear_all();
+  if (cached->quick_key != MAX_KEY)
+    keys->set_bit(cached->quick_key);
+  if (cached->key != MAX_KEY)
+    keys->set_bit(cached->key);
+  if (cached->cond_key != MAX_KEY)
+    keys->set_bit(cached->cond_key);
+  keys->intersect(const_keys);
+  if (keys->is_clear_all())
+    return false;
+
+  ranges_restricted= true;
+  return true;
+}
+
+
+/**
+  Check the result of a range analysis restricted by range_keys().
+
+  The cached access path is kept if range analysis finds a range
+  access on the same index, or none if none was cached, and its row
+  estimate for the current parameter values is within a factor of two
+  of the cached one. Otherwise the other indexes could now be better:
+  the cached plan is invalidated, and the caller analyzes every index.
+
+  @param tab_idx   index of the table in JOIN::join_tab
+  @param quick     range access found, or NULL
+  @param records   rows estimated for the range access
+
+  @return true if the cached access path is kept
+*/
+
+bool Cached_plan::keep_range(THD *thd, uint tab_idx, QUICK_SELECT_I *quick,
+                             ha_rows records)
+{
+  const Table_plan *const cached= table_plan(tab_idx);
+  bool keep;
+
+  if (quick == NULL)
+    keep= cached->quick_key == MAX_KEY;
+  else
+    keep= quick->get_type() == QUICK_SELECT_I::QS_TYPE_RANGE &&
+          quick->index == cached->quick_key &&
+          similar_fanout(rows2double(cached->range_rows),
+                         rows2double(records));
+
+  if (!keep)
+  {
+    tables= 0;
+    status_var_increment(thd->status_var.plan_cache_invalidations);
+  }
+  return keep;
+}
+
+
 /**
   Check whether a semijoin materialization strategy is allowed for
   the current (semi)join table order.
@@ -1546,7 +1859,7 @@ bool Optimize_table_order::greedy_search(table_map remaining_tables)
     join->best_ref[idx]= best_table;
 
     /* compute the cost of the new plan extended with 'best_table' */
-    record_count*= join->positions[idx].records_read;
+    record_count*= join->positions[idx].fanout();
     read_time+=    join->positions[idx].read_time
                    + record_count * ROW_EVALUATE_COST;
 
@@ -1592,7 +1905,7 @@ void get_partial_join_cost(JOIN *join, uint n_tables, double *read_time_arg,
   {
     if (join->best_positions[i].records_read)
     {
-      record_count *= join->best_positions[i].records_read;
+      record_count *= join->best_positions[i].fanout();
       read_time += join->best_positions[i].read_time
                    + record_count * ROW_EVALUATE_COST;
     }
@@ -1860,7 +2173,7 @@ bool Optimize_table_order::best_extension_by_limited_search(
                        position, &loose_scan_pos);
 
       /* Compute the cost of extending the plan with 's' */
-      current_record_count= record_count * position->records_read;
+      current_record_count= record_count * position->fanout();
       current_read_time=    read_time
                             + position->read_time
                             + current_record_count * ROW_EVALUATE_COST;
@@ -2212,7 +2525,7 @@ table_map Optimize_table_order::eq_ref_extension_by_limited_search(
       const bool added_to_eq_ref_extension=
         position->key  &&
         position->read_time    == (position-1)->read_time &&
-        position->records_read == (position-1)->records_read;
+        position->fanout()     == (position-1)->fanout();
       trace_one_table.add("added_to_eq_ref_extension",
                           added_to_eq_ref_extension);
       if (added_to_eq_ref_extension)
@@ -2220,7 +2533,7 @@ table_map Optimize_table_order::eq_ref_extension_by_limited_search(
         double current_record_count, current_read_time;
 
         /* Add the cost of extending the plan with 's' */
-        current_record_count= record_count * position->records_read;
+        current_record_count= record_count * position->fanout();
         current_read_time=    read_time
                               + position->read_time
                               + current_record_count * ROW_EVALUATE_COST;
@@ -2390,8 +2703,8 @@ prev_record_reads(JOIN *join, uint idx, table_map found_ref)
           is an inprecise estimate and adding 1 (or, in the worst case,
           #max_nested_outer_joins=64-1) will not make it any more precise.
       */
-      if (pos->records_read > DBL_EPSILON)
-        found*= pos->records_read;
+      if (pos->fanout() > DBL_EPSILON)
+        found*= pos->fanout();
     }
   }
   return found;
@@ -2835,7 +3148,7 @@ bool Optimize_table_order::semijoin_firstmatch_loosescan_access_paths(
       if (i == first_tab && loosescan)  // Use loose scan position
       {
         *dst_pos= loose_scan_pos;
-        const double rows= rowcount * dst_pos->records_read;
+        const double rows= rowcount * dst_pos->fanout();
         dst_pos->set_prefix_costs(cost + dst_pos->read_time +
                                   rows * ROW_EVALUATE_COST,
                                   rows);
@@ -2858,9 +3171,9 @@ bool Optimize_table_order::semijoin_firstmatch_loosescan_access_paths(
     remaining_tables&= ~tab->table->map;
 
     if (tab->emb_sj_nest)
-      inner_fanout*= pos->records_read;
+      inner_fanout*= pos->fanout();
     else 
-      outer_fanout*= pos->records_read;
+      outer_fanout*= pos->fanout();
 
     cost+= pos->read_time +
            rowcount * inner_fanout * outer_fanout * ROW_EVALUATE_COST;
@@ -2950,7 +3263,7 @@ void Optimize_table_order::semijoin_mat_scan_access_paths(
     best_access_path(tab, remaining_tables, i, false,
                      rowcount * inner_fanout * outer_fanout, dst_pos, &dummy);
     remaining_tables&= ~tab->table->map;
-    outer_fanout*= dst_pos->records_read;
+    outer_fanout*= dst_pos->fanout();
     cost+= dst_pos->read_time +
            rowcount * inner_fanout * outer_fanout * ROW_EVALUATE_COST;
   }
@@ -3073,7 +3386,7 @@ void Optimize_table_order::semijoin_dupsweedout_access_paths(
   {
     const POSITION *const p= join->positions + j;
     if (p->table->emb_sj_nest)
-      inner_fanout*= p->records_read;
+      inner_fanout*= p->fanout();
     else
     {
       /*
@@ -3085,11 +3398,11 @@ void Optimize_table_order::semijoin_dupsweedout_access_paths(
       if (inner_fanout > 1.0)
       {
         // Absorb inner fanout into the outer fanout:
-        outer_fanout*= inner_fanout * p->records_read;
+        outer_fanout*= inner_fanout * p->fanout();
         inner_fanout= 1.0;
       }
       else
-        outer_fanout*= p->records_read;
+        outer_fanout*= p->fanout();
       rowsize+= p->table->table->file->ref_length;
     }
     cost+= p->read_time +
@@ -25,6 +25,75 @@
 
 class Opt_trace_object;
 
+/**
+  The join order chosen for a query block of a prepared statement or a
+  stored program statement, remembered in st_select_lex::cached_plan so
+  that later executions can skip the search for it.
+
+  A cached join order is reused only if the query block has the same
+  constant tables and optimizer settings as when it was chosen, and if
+  recomputing the access methods in this order with the current
+  statistics and parameter values gives the same index and about the
+  same fanout for every table. @see Optimize_table_order::use_cached_plan()
+
+  The range access found for each table is cached too. Later executions
+  estimate only the indexes of the cached range and ref accesses for the
+  current parameter values, instead of every index the conditions could
+  use. @see Cached_plan::range_keys()
+*/
+class Cached_plan : public Sql_alloc
+{
+public:
+  /** Place of one non-constant table in the join order */
+  struct Table_plan
+  {
+    uint tab_idx;           ///< Index of the table in JOIN::join_tab
+    uint key;               ///< Index used for ref access, MAX_KEY if none
+    uint sj_strategy;       ///< Semi-join strategy, see POSITION
+    double fanout;          ///< Estimated fanout, see POSITION::fanout()
+    /**
+      Index of the range access found by range analysis, MAX_KEY if
+      there was none. Only meaningful if range_cached is set.
+    */
+    uint quick_key;
+    /**
+      Index with the lowest row estimate of range analysis, which sets
+      TABLE::quick_condition_rows, MAX_KEY if none.
+    */
+    uint cond_key;
+    /** Rows estimated by range analysis, see JOIN_TAB::found_records */
+    ha_rows range_rows;
+    /**
+      Whether the range analysis of the table may be restricted to the
+      cached indexes: false if it found an access that is not a range
+      scan of one index, such as an index merge.
+    */
+    bool range_cached;
+  };
+
+  uint tables;                  ///< JOIN::tables
+  uint const_tables;            ///< JOIN::const_tables
+  uint alloced;                 ///< Number of elements in order
+  table_map const_table_map;    ///< JOIN::const_table_map
+  ulonglong optimizer_switch;   ///< Optimizer settings of the search
+  ulong search_depth;
+  ulong prune_level;
+  Table_plan *order;            ///< Non-constant tables in join order
+  /**
+    Set when the range analysis of the current execution was restricted
+    to the cached indexes. A join order searched again in that execution
+    is cached without its range accesses, so that the next execution
+    analyzes every index.
+  */
+  bool ranges_restricted;
+
+  static Cached_plan *usable_for_ranges(THD *thd, JOIN *join);
+  const Table_plan *table_plan(uint tab_idx) const;
+  bool range_keys(uint tab_idx, const key_map &const_keys, key_map *keys);
+  bool keep_range(THD *thd, uint tab_idx, QUICK_SELECT_I *quick,
+                  ha_rows records);
+};
+
 /**
   This class determines the optimal join order for tables within
   a basic query block, ie a query specification clause, possibly extended
@@ -101,6 +170,9 @@ private:
   void backout_nj_state(const table_map remaining_tables,
                         const JOIN_TAB *tab);
   void optimize_straight_join(table_map join_tables);
+  bool plan_is_cacheable() const;
+  bool use_cached_plan(table_map join_tables);
+  void store_cached_plan();
   bool greedy_search(table_map remaining_tables);
   bool best_extension_by_limited_search(table_map remaining_tables,
                                         uint idx,
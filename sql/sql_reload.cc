@@ -364,6 +364,7 @@ bool reload_acl_and_cache(THD *thd, unsigned long options,
     mysql_mutex_lock(&LOCK_global_table_stats);
     free_global_table_stats();
     init_global_table_stats();
+    clear_userstat_shards(REFRESH_TABLE_STATS);
     mysql_mutex_unlock(&LOCK_global_table_stats);
   }
   if (options & REFRESH_INDEX_STATS)
@@ -371,6 +372,7 @@ bool reload_acl_and_cache(THD *thd, unsigned long options,
     mysql_mutex_lock(&LOCK_global_index_stats);
     free_global_index_stats();
     init_global_index_stats();
+    clear_userstat_shards(REFRESH_INDEX_STATS);
     mysql_mutex_unlock(&LOCK_global_index_stats);
   }
   if (options & (REFRESH_USER_STATS | REFRESH_CLIENT_STATS | REFRESH_THREAD_STATS))
@@ -391,6 +393,8 @@ bool reload_acl_and_cache(THD *thd, unsigned long options,
       free_global_thread_stats();
       init_global_thread_stats();
     }
+    clear_userstat_shards(options & (REFRESH_USER_STATS | REFRESH_CLIENT_STATS |
+                                     REFRESH_THREAD_STATS));
     mysql_mutex_unlock(&LOCK_global_user_client_stats);
   }
 #endif
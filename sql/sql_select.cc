@@ -2330,7 +2330,9 @@ void revise_cache_usage(JOIN_TAB *join_tab)
     If block_nested_loop is turned on, and if all other criteria for using
     join buffering is fulfilled (see below), then join buffer is used 
     for any join operation (inner join, outer join, semi-join) with 'JT_ALL' 
-    access method.  In that case, a JOIN_CACHE_BNL object is always employed.
+    access method.  In that case, a JOIN_CACHE_BNL object is employed, unless
+    hash_join is also on and the join condition contains equalities usable
+    to build a hash key, then a JOIN_CACHE_HASH object is employed instead.
 
     If an index is used to access rows of the joined table and batched_key_access
     is on, then a JOIN_CACHE_BKA object is employed. (Unless debug flag,
@@ -2385,6 +2387,9 @@ static bool setup_join_buffering(JOIN_TAB *tab, JOIN *join,
   JOIN_CACHE *prev_cache;
   const bool bnl_on= join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BNL);
   const bool bka_on= join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BKA);
+  const bool hash_on=
+    join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN);
+  bool use_hash;
   const uint tableno= tab - join->join_tab;
   const uint tab_sj_strategy= tab->get_sj_strategy();
   bool use_bka_unique= false;
@@ -2513,13 +2518,22 @@ static bool setup_join_buffering(JOIN_TAB *tab, JOIN *join,
       goto no_join_cache;
     }
 
+    /*
+      Build a hash table over the join buffer if the join condition has
+      equalities between this table and the buffered ones.
+    */
+    use_hash= hash_on &&
+              JOIN_CACHE_HASH::find_hash_conds(tab, tab->condition(),
+                                               NULL, 0) > 0;
     if ((options & SELECT_DESCRIBE) ||
-        ((tab->op= new JOIN_CACHE_BNL(join, tab, prev_cache)) &&
+        ((tab->op= use_hash ? new JOIN_CACHE_HASH(join, tab, prev_cache) :
+                              new JOIN_CACHE_BNL(join, tab, prev_cache)) &&
          !tab->op->init()))
     {
       *icp_other_tables_ok= FALSE;
       DBUG_ASSERT(might_do_join_buffering(join_buffer_alg(join->thd), tab));
-      tab->use_join_cache= JOIN_CACHE::ALG_BNL;
+      tab->use_join_cache= use_hash ? JOIN_CACHE::ALG_HASH :
+                                      JOIN_CACHE::ALG_BNL;
       return false;
     }
     goto no_join_cache;
@@ -5544,7 +5558,7 @@ test_if_cheaper_ordering(const JOIN_TAB *tab, ORDER *order, TABLE *table,
     read_time= tab->position->read_time;
     for (const JOIN_TAB *jt= tab + 1;
          jt < join->join_tab + join->primary_tables; jt++)
-      fanout*= jt->position->records_read; // fanout is always >= 1
+      fanout*= jt->position->fanout();
   }
   else
     read_time= table->file->scan_time();
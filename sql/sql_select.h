@@ -488,6 +488,7 @@ typedef struct st_position : public Sql_alloc
     prefix_cost.add_io(read_time_arg);
     prefix_record_count= row_count_arg;
   }
+  inline double fanout() const;
 } POSITION;
 
 
@@ -622,6 +623,14 @@ public:
     E(#records) is in found_records.
   */
   ha_rows       read_time;
+  /**
+    Estimated fraction of the rows that satisfy the conditions on the
+    non-indexed columns of this table, taken from column histograms.
+    1.0 when no histogram applies, @see histogram_selectivity().
+  */
+  double        histogram_selectivity;
+  /** Columns whose histograms were used, for EXPLAIN, or NULL */
+  const char    *histograms_used;
   /**
     The set of tables that this table depends on. Used for outer join and
     straight join dependencies.
@@ -927,6 +936,8 @@ st_join_table::st_join_table()
     records(0),
     found_records(0),
     read_time(0),
+    histogram_selectivity(1.0),
+    histograms_used(NULL),
 
     dependent(0),
     key_dependent(0),
@@ -985,6 +996,19 @@ st_join_table::st_join_table()
   memset(&read_record, 0, sizeof(read_record));
 }
 
+
+/**
+  The number of rows that the partial plan grows by per row of the
+  prefix: the rows read by the access method, scaled down by the
+  histogram estimate of the conditions on non-indexed columns.
+  records_read itself stays the row count of the access method, which
+  the pruning heuristics of the greedy search rely on.
+*/
+inline double st_position::fanout() const
+{
+  return records_read * table->histogram_selectivity;
+}
+
 /**
   "Less than" comparison function object used to compare two JOIN_TAB
   objects based on a number of factors in this order:
@@ -56,6 +56,13 @@
 #include "sql_tmp_table.h" // Tmp tables
 #include "sql_optimizer.h" // JOIN
 #include "global_threads.h"
+#include "sql_cache.h"     // query_cache
+#include "threadpool.h"    // tp_get_group_stats
+#ifdef HAVE_REPLICATION
+#include "rpl_mi.h"        // Master_info
+#include "rpl_rli_pdb.h"   // Slave_worker
+#include "rpl_slave.h"     // active_mi
+#endif
 #include "my_default.h"
 
 #include <algorithm>
@@ -2937,6 +2944,7 @@ int fill_schema_user_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   // Pattern matching on the client IP is supported.
 
   mysql_mutex_lock(&LOCK_global_user_client_stats);
+  merge_user_client_stats_shards();
   int result= send_user_stats(thd, &global_user_stats, table);
   mysql_mutex_unlock(&LOCK_global_user_client_stats);
   if (result)
@@ -2977,6 +2985,7 @@ int fill_schema_client_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   // Pattern matching on the client IP is supported.
 
   mysql_mutex_lock(&LOCK_global_user_client_stats);
+  merge_user_client_stats_shards();
   int result= send_user_stats(thd, &global_client_stats, table);
   mysql_mutex_unlock(&LOCK_global_user_client_stats);
   if (result)
@@ -3002,6 +3011,7 @@ int fill_schema_thread_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   // Pattern matching on the client IP is supported.
 
   mysql_mutex_lock(&LOCK_global_user_client_stats);
+  merge_user_client_stats_shards();
   int result= send_thread_stats(thd, &global_thread_stats, table);
   mysql_mutex_unlock(&LOCK_global_user_client_stats);
   if (result)
@@ -3015,6 +3025,128 @@ int fill_schema_thread_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   DBUG_RETURN(1);
 }
 
+/**
+  Fill INFORMATION_SCHEMA.QUERY_CACHE_SHARDS with the statistics of every
+  query cache shard.  The counters are read without the shard locks, like
+  the Qcache_% status variables.
+*/
+
+int fill_query_cache_shards(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  DBUG_ENTER("fill_query_cache_shards");
+#ifdef HAVE_QUERY_CACHE
+  TABLE *table= tables->table;
+
+  for (uint i= 0; i < query_cache.shard_count(); i++)
+  {
+    Query_cache *shard= query_cache.shard(i);
+
+    restore_record(table, s->default_values);
+    table->field[0]->store(i, true);
+    table->field[1]->store(shard->query_cache_size, true);
+    table->field[2]->store(shard->free_memory, true);
+    table->field[3]->store(shard->queries_in_cache, true);
+    table->field[4]->store(shard->hits, true);
+    table->field[5]->store(shard->misses, true);
+    table->field[6]->store(shard->inserts, true);
+    table->field[7]->store(shard->refused, true);
+    table->field[8]->store(shard->lowmem_prunes, true);
+    table->field[9]->store(shard->lock_waits, true);
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
+  }
+#endif
+  DBUG_RETURN(0);
+}
+
+/**
+  Fill INFORMATION_SCHEMA.SLAVE_WORKER_STATISTICS with the statistics of
+  the Workers of a running multi-threaded slave.  The counters are read
+  without the Worker locks; run_lock keeps the Workers from going away.
+*/
+
+int fill_slave_worker_stats(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  DBUG_ENTER("fill_slave_worker_stats");
+  int error= 0;
+#ifdef HAVE_REPLICATION
+  TABLE *table= tables->table;
+
+  if (check_global_access(thd, SUPER_ACL | REPL_CLIENT_ACL))
+    DBUG_RETURN(1);
+
+  mysql_mutex_lock(&LOCK_active_mi);
+  if (active_mi != NULL && active_mi->rli != NULL)
+  {
+    Relay_log_info *rli= active_mi->rli;
+
+    mysql_mutex_lock(&rli->run_lock);
+    for (uint i= 0; i < rli->workers.elements && !error; i++)
+    {
+      Slave_worker *w;
+      get_dynamic(&rli->workers, (uchar*) &w, i);
+      THD *w_thd= w->info_thd;
+
+      restore_record(table, s->default_values);
+      table->field[0]->store(w->id, true);
+      table->field[1]->store(w_thd ? w_thd->thread_id : 0, true);
+      table->field[2]->store(w->groups_done, true);
+      table->field[3]->store(w->events_done, true);
+      table->field[4]->store(w->busy_time, true);
+      table->field[5]->store(w->idle_time, true);
+      table->field[6]->store(w->wq_empty_waits, true);
+      table->field[7]->store(w->commit_order_waits, true);
+      table->field[8]->store(w->commit_order_wait_time, true);
+      table->field[9]->store(w->commit_order_retries, true);
+      error= schema_table_store_record(thd, table);
+    }
+    mysql_mutex_unlock(&rli->run_lock);
+  }
+  mysql_mutex_unlock(&LOCK_active_mi);
+#endif
+  DBUG_RETURN(error);
+}
+
+/**
+  Fill INFORMATION_SCHEMA.THREAD_POOL_GROUPS with the statistics of every
+  thread group.  The table is empty unless thread_handling is
+  pool-of-threads.
+*/
+
+int fill_thread_pool_groups(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  DBUG_ENTER("fill_thread_pool_groups");
+#ifdef HAVE_POOL_OF_THREADS
+  TABLE *table= tables->table;
+  TP_GROUP_STATS *stats;
+  uint count;
+
+  if (!(stats= (TP_GROUP_STATS *) thd->alloc(sizeof(TP_GROUP_STATS) *
+                                             MAX_THREAD_GROUPS)))
+    DBUG_RETURN(1);
+
+  count= tp_get_group_stats(stats);
+  for (uint i= 0; i < count; i++)
+  {
+    restore_record(table, s->default_values);
+    table->field[0]->store(stats[i].group_id, true);
+    table->field[1]->store(stats[i].connections, true);
+    table->field[2]->store(stats[i].threads, true);
+    table->field[3]->store(stats[i].active_threads, true);
+    table->field[4]->store(stats[i].waiting_threads, true);
+    table->field[5]->store(stats[i].queue_length, true);
+    table->field[6]->store(stats[i].high_prio_queue_length, true);
+    table->field[7]->store(stats[i].has_listener, true);
+    table->field[8]->store(stats[i].is_stalled, true);
+    table->field[9]->store(stats[i].steals, true);
+    table->field[10]->store(stats[i].stolen, true);
+    if (schema_table_store_record(thd, table))
+      DBUG_RETURN(1);
+  }
+#endif
+  DBUG_RETURN(0);
+}
+
 // Sends the global table stats back to the client.
 int fill_schema_table_stats(THD* thd, TABLE_LIST* tables, Item* cond)
 {
@@ -3023,6 +3155,7 @@ int fill_schema_table_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   char *table_full_name, *table_schema;
 
   mysql_mutex_lock(&LOCK_global_table_stats);
+  merge_table_stats_shards();
   for (uint i = 0; i < global_table_stats.records; ++i)
   {
     restore_record(table, s->default_values);
@@ -3067,6 +3200,7 @@ int fill_schema_index_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   char *index_full_name, *table_schema, *table_name;
 
   mysql_mutex_lock(&LOCK_global_index_stats);
+  merge_index_stats_shards();
   for (uint i = 0; i < global_index_stats.records; ++i)
   {
     restore_record(table, s->default_values);
@@ -8838,6 +8972,81 @@ ST_FIELD_INFO thread_stats_fields_info[]=
   {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
 };
 
+ST_FIELD_INFO query_cache_shards_fields_info[]=
+{
+  {"SHARD_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"SIZE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"FREE_MEMORY", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"QUERIES_IN_CACHE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"HITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"MISSES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"INSERTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"NOT_CACHED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"LOWMEM_PRUNES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"LOCK_WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+ST_FIELD_INFO slave_worker_stats_fields_info[]=
+{
+  {"WORKER_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"THREAD_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"GROUPS_APPLIED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"EVENTS_APPLIED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BUSY_TIME", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"IDLE_TIME", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"EVENT_WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"COMMIT_ORDER_WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"COMMIT_ORDER_WAIT_TIME", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+   0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"COMMIT_ORDER_RETRIES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+   0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+ST_FIELD_INFO thread_pool_groups_fields_info[]=
+{
+  {"GROUP_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"CONNECTIONS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"THREADS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"ACTIVE_THREADS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"WAITING_THREADS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"QUEUE_LENGTH", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"HIGH_PRIO_QUEUE_LENGTH", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+   0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"HAS_LISTENER", 1, MYSQL_TYPE_TINY, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"IS_STALLED", 1, MYSQL_TYPE_TINY, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"STEALS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"STOLEN", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
 ST_FIELD_INFO table_stats_fields_info[]=
 {
   {"TABLE_SCHEMA", NAME_LEN, MYSQL_TYPE_STRING, 0, 0, "Table_schema",
@@ -9115,6 +9324,8 @@ ST_SCHEMA_TABLE schema_tables[]=
   {"PROFILING", query_profile_statistics_info, create_schema_table,
     fill_query_profile_statistics_info, make_profile_table_for_show, 
     NULL, -1, -1, false, 0},
+  {"QUERY_CACHE_SHARDS", query_cache_shards_fields_info, create_schema_table,
+   fill_query_cache_shards, 0, 0, -1, -1, 0, 0},
   {"REFERENTIAL_CONSTRAINTS", referential_constraints_fields_info,
    create_schema_table, get_all_tables, 0, get_referential_constraints_record,
    1, 9, 0, OPTIMIZE_I_S_TABLE|OPEN_TABLE_ONLY},
@@ -9128,6 +9339,8 @@ ST_SCHEMA_TABLE schema_tables[]=
    fill_status, make_old_format, 0, 0, -1, 0, 0},
   {"SESSION_VARIABLES", variables_fields_info, create_schema_table,
    fill_variables, make_old_format, 0, 0, -1, 0, 0},
+  {"SLAVE_WORKER_STATISTICS", slave_worker_stats_fields_info,
+   create_schema_table, fill_slave_worker_stats, 0, 0, -1, -1, 0, 0},
   {"STATISTICS", stat_fields_info, create_schema_table, 
    get_all_tables, make_old_format, get_schema_stat_record, 1, 2, 0,
    OPEN_TABLE_ONLY|OPTIMIZE_I_S_TABLE},
@@ -9150,6 +9363,8 @@ ST_SCHEMA_TABLE schema_tables[]=
   {"TEMPORARY_TABLES", temporary_table_fields_info, create_schema_table,
    fill_temporary_tables, make_temporary_tables_old_format, 0, 2, 3, 0,
    OPEN_TABLE_ONLY|OPTIMIZE_I_S_TABLE},
+  {"THREAD_POOL_GROUPS", thread_pool_groups_fields_info, create_schema_table,
+   fill_thread_pool_groups, 0, 0, -1, -1, 0, 0},
   {"THREAD_STATISTICS", thread_stats_fields_info, create_schema_table,
     fill_schema_thread_stats, make_old_format, 0, -1, -1, 0, 0},
   {"TRIGGERS", triggers_fields_info, create_schema_table,
@@ -55,6 +55,7 @@
 #include "datadict.h"  // dd_frm_type()
 #include "sql_resolver.h"              // setup_order, fix_inner_refs
 #include "table_cache.h"
+#include "histogram.h"                 // histograms_drop_table
 #include <mysql/psi/mysql_table.h>
 #include "mysql.h"			// in_bootstrap & opt_noacl
 
@@ -2701,6 +2702,7 @@ int mysql_rm_table_no_locks(THD *thd, TABLE_LIST *tables, bool if_exists,
           non_tmp_table_deleted= TRUE;
           new_error= Table_triggers_list::drop_all_triggers(thd, db,
                                                             table->table_name);
+          histograms_drop_table(thd, db, table->table_name);
         }
         error|= new_error;
       }
@@ -8208,6 +8210,9 @@ simple_rename_or_index_change(THD *thd, TABLE_LIST *table_list,
 
   if (!error)
   {
+    if (alter_ctx->is_table_renamed())
+      histograms_rename_table(thd, alter_ctx->db, alter_ctx->table_name,
+                              alter_ctx->new_db, alter_ctx->new_name);
     error= write_bin_log(thd, TRUE, thd->query(), thd->query_length());
     if (!error)
       my_ok(thd);
@@ -8499,6 +8504,8 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   }
 
   Alter_table_ctx alter_ctx(thd, table_list, tables_opened, new_db, new_name);
+  Histogram_alter *histogram_changes= NULL;
+  uint histogram_change_count= 0;
 
   /*
     Add old and new (if any) databases to the list of accessed databases
@@ -8899,6 +8906,11 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   /* Remember that we have not created table in storage engine yet. */
   bool no_ha_table= true;
 
+  if (table->s->tmp_table == NO_TMP_TABLE &&
+      histograms_prepare_alter(thd, table, alter_info, &histogram_changes,
+                               &histogram_change_count))
+    goto err_new_table_cleanup;
+
   if (alter_info->requested_algorithm != Alter_info::ALTER_TABLE_ALGORITHM_COPY)
   {
     Alter_inplace_info ha_alter_info(create_info, alter_info,
@@ -9335,6 +9347,10 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
 
 end_inplace:
 
+  histograms_alter_table(thd, alter_ctx.db, alter_ctx.table_name,
+                         alter_ctx.new_db, alter_ctx.new_name,
+                         histogram_changes, histogram_change_count);
+
   if (thd->locked_tables_list.reopen_tables(thd))
     goto err_with_mdl;
 
@@ -413,6 +413,82 @@ static void setup_tmp_table_column_bitmaps(TABLE *table, uchar *bitmaps)
 }
 
 
+/**
+  Check whether a temporary table with BLOB columns can be kept in the
+  HEAP engine.
+
+  HEAP stores BLOBs in chained chunks of its variable-size dataspace,
+  but it can neither index them nor place them in front of the key
+  columns of the row.
+
+  @param group        Group key of the table, NULL if none
+  @param distinct     TRUE if the table has a unique key over all columns
+  @param blob_field   Array of the field numbers of BLOB columns
+  @param blob_count   Number of elements in blob_field
+
+  @return TRUE if the table can be created in HEAP, FALSE otherwise
+*/
+
+static bool heap_tmp_table_can_store_blobs(ORDER *group, bool distinct,
+                                           const uint *blob_field,
+                                           uint blob_count)
+{
+  uint key_fields_end= 0;
+
+  if (distinct)
+    return false;
+  for (ORDER *cur_group= group; cur_group; cur_group= cur_group->next)
+  {
+    Field *field= (*cur_group->item)->get_tmp_table_field();
+    if (field == NULL || field->flags & BLOB_FLAG)
+      return false;
+    set_if_bigger(key_fields_end, (uint) field->field_index + 1);
+  }
+  for (uint i= 0; i < blob_count; i++)
+  {
+    if (blob_field[i] < key_fields_end)
+      return false;
+  }
+  return true;
+}
+
+
+/**
+  Check whether the keys of a HEAP temporary table with BLOB columns can
+  be created by HEAP. Keys may be added after create_tmp_table(), e.g.
+  for materialized derived tables, and then refer to columns that follow
+  a BLOB.
+
+  @param table   HEAP temporary table, not yet instantiated
+
+  @return TRUE if HEAP can create the keys, FALSE otherwise
+*/
+
+static bool heap_tmp_table_keys_fit_blobs(const TABLE *table)
+{
+  const TABLE_SHARE *share= table->s;
+  uint key_fields_end= 0;
+
+  for (uint i= 0; i < share->keys; i++)
+  {
+    const KEY *key= table->key_info + i;
+    for (uint j= 0; j < key->user_defined_key_parts; j++)
+    {
+      const Field *field= key->key_part[j].field;
+      if (field->flags & BLOB_FLAG)
+        return false;
+      set_if_bigger(key_fields_end, (uint) field->field_index + 1);
+    }
+  }
+  for (uint i= 0; i < share->blob_fields; i++)
+  {
+    if (share->blob_field[i] < key_fields_end)
+      return false;
+  }
+  return true;
+}
+
+
 /**
   Create a temp table according to a field list.
 
@@ -553,23 +629,24 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   
   init_sql_alloc(&own_root, TABLE_ALLOC_BLOCK_SIZE, 0);
 
+  /* One more field is reserved for a possible hash_field */
   if (!multi_alloc_root(&own_root,
                         &table, sizeof(*table),
                         &share, sizeof(*share),
-                        &reg_field, sizeof(Field*) * (field_count+1),
-                        &default_field, sizeof(Field*) * (field_count),
+                        &reg_field, sizeof(Field*) * (field_count+2),
+                        &default_field, sizeof(Field*) * (field_count+1),
                         &blob_field, sizeof(uint)*(field_count+1),
-                        &from_field, sizeof(Field*)*field_count,
+                        &from_field, sizeof(Field*)*(field_count+1),
                         &copy_func, sizeof(*copy_func)*(copy_func_count+1),
                         &param->keyinfo, sizeof(*param->keyinfo),
                         &key_part_info,
                         sizeof(*key_part_info)*(param->group_parts+1),
                         &param->start_recinfo,
-                        sizeof(*param->recinfo)*(field_count*2+4),
+                        sizeof(*param->recinfo)*(field_count*2+6),
                         &tmpname, (uint) strlen(path)+1,
                         &group_buff, (group && ! using_unique_constraint ?
                                       param->group_length : 0),
-                        &bitmaps, bitmap_buffer_size(field_count)*2,
+                        &bitmaps, bitmap_buffer_size(field_count+1)*2,
                         NullS))
   {
     if (temp_pool_slot != MY_BIT_NONE)
@@ -589,9 +666,9 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   /* make table according to fields */
 
   memset(table, 0, sizeof(*table));
-  memset(reg_field, 0, sizeof(Field*)*(field_count+1));
-  memset(default_field, 0, sizeof(Field*) * (field_count));
-  memset(from_field, 0, sizeof(Field*)*field_count);
+  memset(reg_field, 0, sizeof(Field*)*(field_count+2));
+  memset(default_field, 0, sizeof(Field*) * (field_count+1));
+  memset(from_field, 0, sizeof(Field*)*(field_count+1));
 
   table->mem_root= own_root;
   mem_root_save= thd->mem_root;
@@ -803,14 +880,61 @@ update_hidden:
   }
   DBUG_ASSERT(fieldnr == (uint) (reg_field - table->field));
   DBUG_ASSERT(field_count >= (uint) (reg_field - table->field));
+
+  /*
+    HEAP cannot index BLOBs, nor store them in front of the key columns.
+    If the writer can check uniqueness itself (see check_unique_constraint),
+    a GROUP BY or DISTINCT key that would need one is replaced by a
+    non-unique key over a hash of the key columns, stored in a hidden
+    column in front of all the others. Otherwise the table goes to MyISAM,
+    which has unique constraints over BLOBs.
+  */
+  if (param->allow_hash_field && blob_count && !param->schema_table &&
+      (group || (distinct && fieldnr != param->hidden_field_count)) &&
+      (using_unique_constraint ||
+       !heap_tmp_table_can_store_blobs(group, distinct, share->blob_field,
+                                       blob_count)) &&
+      !(thd->variables.big_tables && !(select_options & SELECT_SMALL_RESULT)) &&
+      !(select_options & TMP_TABLE_FORCE_MYISAM))
+  {
+    Field *field= new Field_longlong(sizeof(ulonglong), false, "<hash_field>",
+                                     true);
+    if (!field)
+      goto err;                                 /* purecov: inspected */
+    field->init(table);
+    memmove(table->field + 1, table->field, sizeof(Field*) * fieldnr);
+    memmove(from_field + 1, from_field, sizeof(Field*) * fieldnr);
+    memmove(default_field + 1, default_field, sizeof(Field*) * fieldnr);
+    table->field[0]= field;
+    from_field[0]= default_field[0]= NULL;
+    for (i= 0; i <= fieldnr; i++)
+      table->field[i]->field_index= i;
+    for (uint *blob= share->blob_field; blob < blob_field; blob++)
+      (*blob)++;
+    reg_field++;
+    fieldnr++;
+    reclength+= field->pack_length();
+    param->hidden_field_count++;
+    table->hash_field= field;
+    using_unique_constraint= false;
+  }
+  table->hidden_field_count= param->hidden_field_count;
   field_count= fieldnr;
   *reg_field= 0;
   *blob_field= 0;				// End marker
   share->fields= field_count;
 
-  /* If result table is small; use a heap */
+  /*
+    If result table is small; use a heap. Tables with BLOBs stay in memory
+    too, as long as no key has to cover a BLOB column. INFORMATION_SCHEMA
+    tables keep MyISAM for those, as the engine is shown by SHOW CREATE.
+  */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint
+  if ((blob_count && !table->hash_field &&
+       (param->schema_table ||
+        !heap_tmp_table_can_store_blobs(group, distinct, share->blob_field,
+                                        blob_count)))
+      || using_unique_constraint
       || (thd->variables.big_tables && !(select_options & SELECT_SMALL_RESULT))
       || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
@@ -837,7 +961,7 @@ update_hidden:
     goto err;
   }
 
-  if (!using_unique_constraint)
+  if (!using_unique_constraint && !table->hash_field)
     reclength+= group_null_items;	// null flag is stored separately
 
   share->blob_fields= blob_count;
@@ -906,7 +1030,8 @@ update_hidden:
 
     if (!(field->flags & NOT_NULL_FLAG))
     {
-      if (field->flags & GROUP_FLAG && !using_unique_constraint)
+      if (field->flags & GROUP_FLAG && !using_unique_constraint &&
+          !table->hash_field)
       {
 	/*
 	  We have to reserve one byte here for NULL bits,
@@ -1017,7 +1142,36 @@ update_hidden:
   keyinfo= param->keyinfo;
   keyinfo->table= table;
 
-  if (group)
+  if (table->hash_field)
+  {
+    DBUG_PRINT("info",("Creating hash key in temporary table"));
+    if (group)
+    {
+      table->group= group;
+      param->group_buff= group_buff;
+      /* The group columns are compared by check_unique_constraint() */
+      for (ORDER *cur_group= group; cur_group; cur_group= cur_group->next)
+      {
+        cur_group->field= (*cur_group->item)->get_tmp_table_field();
+        DBUG_ASSERT(cur_group->field->table == table);
+        cur_group->buff= NULL;
+      }
+    }
+    else
+      table->distinct= 1;
+    share->keys= 1;
+    table->key_info= share->key_info= keyinfo;
+    keyinfo->key_part= key_part_info;
+    key_part_info->init_from_field(table->hash_field);
+    keyinfo->actual_flags= keyinfo->flags= 0;
+    keyinfo->usable_key_parts= keyinfo->user_defined_key_parts=
+      keyinfo->actual_key_parts= 1;
+    keyinfo->key_length= key_part_info->store_length;
+    keyinfo->rec_per_key= 0;
+    keyinfo->algorithm= HA_KEY_ALG_UNDEF;
+    keyinfo->name= (char*) "<hash_key>";
+  }
+  else if (group)
   {
     DBUG_PRINT("info",("Creating group key in temporary table"));
     table->group=group;				/* Table is grouped by key */
@@ -1071,7 +1225,8 @@ update_hidden:
     keyinfo->actual_flags= keyinfo->flags;
   }
 
-  if (distinct && field_count != param->hidden_field_count)
+  if (distinct && field_count != param->hidden_field_count &&
+      !table->hash_field)
   {
     /*
       Create an unique key or an unique constraint over all columns
@@ -1837,6 +1992,23 @@ bool instantiate_tmp_table(TABLE *table, KEY *keyinfo,
                            ulonglong options, my_bool big_tables,
                            Opt_trace_context *trace)
 {
+  if (table->s->db_type() == heap_hton && table->s->blob_fields &&
+      !heap_tmp_table_keys_fit_blobs(table))
+  {
+    /* Keys were added that HEAP can not create; use MyISAM instead */
+    TABLE_SHARE *share= table->s;
+    handler *file= get_new_handler(share, &table->mem_root, myisam_hton);
+    if (!file || file->set_ha_share_ref(&share->ha_share))
+    {
+      delete file;
+      return TRUE;
+    }
+    delete table->file;
+    table->file= file;
+    plugin_unlock(0, share->db_plugin);
+    share->db_plugin= ha_lock_engine(0, myisam_hton);
+  }
+
   if (table->s->db_type() == myisam_hton)
   {
     if (create_myisam_tmp_table(table, keyinfo, start_recinfo, recinfo,
@@ -1861,6 +2033,158 @@ bool instantiate_tmp_table(TABLE *table, KEY *keyinfo,
   return FALSE;
 }
 
+
+/**
+  Add the value of a field of record[0] to a hash of the record.
+
+  Strings are hashed by their collation, so that values equal under
+  Field::cmp() hash the same, as MyISAM unique constraints do.
+*/
+
+static void unique_hash(Field *field, ulong *nr, ulong *nr2)
+{
+  const CHARSET_INFO *cs= &my_charset_bin;
+  uchar *pos= field->ptr;
+  uint length= field->pack_length();
+
+  if (field->is_null())
+  {
+    /* Make NULL hash differently from an empty string or 0 */
+    *nr^= (*nr << 1) | 1;
+    return;
+  }
+  if (field->flags & BLOB_FLAG)
+  {
+    Field_blob *blob= static_cast<Field_blob*>(field);
+    blob->get_ptr(&pos);
+    length= blob->get_length();
+  }
+  else if (field->real_type() == MYSQL_TYPE_VARCHAR)
+  {
+    Field_varstring *varstring= static_cast<Field_varstring*>(field);
+    pos+= varstring->length_bytes;
+    length= varstring->data_length();
+  }
+  switch (field->key_type()) {
+  case HA_KEYTYPE_TEXT:
+  case HA_KEYTYPE_VARTEXT1:
+  case HA_KEYTYPE_VARTEXT2:
+    cs= field->charset();
+    break;
+  default:
+    break;
+  }
+  cs->coll->hash_sort(cs, pos, length, nr, nr2);
+}
+
+
+/**
+  Compare a field of record[0] with the same field of record[1].
+
+  @return true if the values differ
+*/
+
+static bool unique_field_differs(Field *field, my_ptrdiff_t diff)
+{
+  bool is_null= field->is_null();
+
+  if (is_null || field->is_null(diff))
+    return is_null != field->is_null(diff);
+  return field->cmp(field->ptr, field->ptr + diff) != 0;
+}
+
+
+/**
+  Check that the row in record[0] of a temporary table with a hash_field
+  is not a duplicate of a row of the table, before it is written.
+
+  The hash of the GROUP BY columns, or of the visible columns of a DISTINCT
+  table, is stored into the hash_field of record[0]. The rows with the same
+  hash are then read into record[1] and compared column by column.
+
+  @param table  Temporary table, record[0] holds the row to write
+
+  @retval 0                      The row is unique, or the table has no
+                                 hash_field, or its key is disabled (the
+                                 UNION ALL part after a UNION DISTINCT)
+  @retval HA_ERR_FOUND_DUPP_KEY  A row with the same key values exists. It
+                                 is in record[1], and the handler is
+                                 positioned on it
+  @retval other                  Handler error
+*/
+
+int check_unique_constraint(TABLE *table)
+{
+  ulong nr= 1, nr2= 4;
+  const my_ptrdiff_t diff= table->record[1] - table->record[0];
+  bool index_opened= false;
+  int error;
+  DBUG_ENTER("check_unique_constraint");
+
+  if (!table->hash_field || table->file->indexes_are_disabled())
+    DBUG_RETURN(0);
+
+  if (table->group)
+  {
+    for (ORDER *group= table->group; group; group= group->next)
+      unique_hash(group->field, &nr, &nr2);
+  }
+  else
+  {
+    for (Field **field= table->field + table->hidden_field_count; *field;
+         field++)
+      unique_hash(*field, &nr, &nr2);
+  }
+  table->hash_field->store((longlong) nr, true);
+
+  /* UNION tables are only written, open the key for this lookup */
+  DBUG_ASSERT(table->file->inited != handler::RND);
+  if (table->file->inited == handler::NONE)
+  {
+    if ((error= table->file->ha_index_init(0, false)))
+      DBUG_RETURN(error);
+    index_opened= true;
+  }
+
+  error= table->file->ha_index_read_map(table->record[1],
+                                        table->hash_field->ptr,
+                                        HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+  while (!error)
+  {
+    bool differs= false;
+    if (table->group)
+    {
+      for (ORDER *group= table->group; group && !differs; group= group->next)
+        differs= unique_field_differs(group->field, diff);
+    }
+    else
+    {
+      for (Field **field= table->field + table->hidden_field_count;
+           *field && !differs; field++)
+        differs= unique_field_differs(*field, diff);
+    }
+    if (!differs)
+    {
+      error= HA_ERR_FOUND_DUPP_KEY;
+      break;
+    }
+    error= table->file->ha_index_next_same(table->record[1],
+                                           table->hash_field->ptr,
+                                           table->hash_field->pack_length());
+  }
+  if (error == HA_ERR_KEY_NOT_FOUND || error == HA_ERR_END_OF_FILE)
+    error= 0;
+
+  if (index_opened)
+  {
+    int end_error= table->file->ha_index_end();
+    if (!error)
+      error= end_error;
+  }
+  DBUG_RETURN(error);
+}
+
+
 void
 free_tmp_table(THD *thd, TABLE *entry)
 {
@@ -1953,7 +2277,7 @@ bool create_myisam_from_heap(THD *thd, TABLE *table,
   TABLE new_table;
   TABLE_SHARE share;
   const char *save_proc_info;
-  int write_err;
+  int write_err, read_err;
   DBUG_ENTER("create_myisam_from_heap");
 
   if (table->s->db_type() != heap_hton || 
@@ -2039,8 +2363,12 @@ bool create_myisam_from_heap(THD *thd, TABLE *table,
     is safe as this is a temporary MyISAM table without timestamp/autoincrement
     or partitioning.
   */
-  while (!table->file->ha_rnd_next(new_table.record[1]))
+  while (!(read_err= table->file->ha_rnd_next(new_table.record[1])) ||
+         read_err == HA_ERR_RECORD_DELETED)
   {
+    /* HEAP tables with BLOBs report their continuation chunks as deleted */
+    if (read_err)
+      continue;
     write_err= new_table.file->ha_write_row(new_table.record[1]);
     DBUG_EXECUTE_IF("raise_error", write_err= HA_ERR_FOUND_DUPP_KEY ;);
     if (write_err)
@@ -2061,6 +2389,11 @@ bool create_myisam_from_heap(THD *thd, TABLE *table,
       *is_duplicate= FALSE;
   }
 
+  /* Account for the memory that was moved to disk */
+  table->file->info(HA_STATUS_VARIABLE);
+  thd->inc_status_tmp_table_disk_spills(table->file->stats.data_file_length +
+                                        table->file->stats.index_file_length);
+
   /* remove heap table and change to use myisam table */
   (void) table->file->ha_rnd_end();
   (void) table->file->ha_close();              // This deletes the table !
@@ -53,6 +53,7 @@ Note: YYTHD is passed as an argument to yyparse(), and subsequently to yylex().
 #include "sql_alter.h"                         // Sql_cmd_alter_table*
 #include "sql_truncate.h"                      // Sql_cmd_truncate_table
 #include "sql_admin.h"                         // Sql_cmd_analyze/Check..._table
+#include "histogram.h"                          // HISTOGRAM_DEFAULT_BUCKETS
 #include "sql_partition_admin.h"               // Sql_cmd_alter_table_*_part.
 #include "sql_handler.h"                       // Sql_cmd_handler_*
 #include "sql_signal.h"
@@ -1098,6 +1099,7 @@ bool my_yyoverflow(short **a, YYSTYPE **b, ulong *yystacksize);
 %token  BOOL_SYM
 %token  BOTH                          /* SQL-2003-R */
 %token  BTREE_SYM
+%token  BUCKETS_SYM
 %token  BY                            /* SQL-2003-R */
 %token  BYTE_SYM
 %token  CACHE_SYM
@@ -1267,6 +1269,7 @@ bool my_yyoverflow(short **a, YYSTYPE **b, ulong *yystacksize);
 %token  HELP_SYM
 %token  HEX_NUM
 %token  HIGH_PRIORITY
+%token  HISTOGRAM_SYM
 %token  HOST_SYM
 %token  HOSTS_SYM
 %token  HOUR_MICROSECOND_SYM
@@ -1768,6 +1771,7 @@ bool my_yyoverflow(short **a, YYSTYPE **b, ulong *yystacksize);
         ws_level_flag_desc ws_level_flag_reverse ws_level_flags
         opt_ws_levels ws_level_list ws_level_list_item ws_level_number
         ws_level_range ws_level_list_or_range  
+        opt_histogram_buckets
 
 %type <ulonglong_number>
         ulonglong_num real_ulonglong_num size_number
@@ -1874,7 +1878,7 @@ bool my_yyoverflow(short **a, YYSTYPE **b, ulong *yystacksize);
         show describe load alter optimize keycache preload flush
         reset purge begin commit rollback savepoint release
         slave master_def master_defs master_file_def slave_until_opts
-        repair analyze check start checksum
+        repair analyze opt_histogram check start checksum
         field_list field_list_item field_spec kill column_def key_def
         keycache_list keycache_list_or_parts assign_to_keycache
         assign_to_keycache_parts
@@ -8513,6 +8517,31 @@ analyze:
             if (lex->m_sql_cmd == NULL)
               MYSQL_YYABORT;
           }
+          opt_histogram
+          {}
+        ;
+
+opt_histogram:
+          /* empty */ {}
+        | UPDATE_SYM HISTOGRAM_SYM ON using_list opt_histogram_buckets
+          {
+            Sql_cmd_analyze_table *cmd=
+              static_cast<Sql_cmd_analyze_table*>(Lex->m_sql_cmd);
+            cmd->set_histogram_command(Sql_cmd_analyze_table::HISTOGRAM_UPDATE,
+                                       $4, $5);
+          }
+        | DROP HISTOGRAM_SYM ON using_list
+          {
+            Sql_cmd_analyze_table *cmd=
+              static_cast<Sql_cmd_analyze_table*>(Lex->m_sql_cmd);
+            cmd->set_histogram_command(Sql_cmd_analyze_table::HISTOGRAM_DROP,
+                                       $4, 0);
+          }
+        ;
+
+opt_histogram_buckets:
+          /* empty */ { $$= HISTOGRAM_DEFAULT_BUCKETS; }
+        | WITH ulong_num BUCKETS_SYM { $$= $2; }
         ;
 
 binlog_base64_event:
@@ -14440,6 +14469,7 @@ keyword_sp:
         | BOOL_SYM                 {}
         | BOOLEAN_SYM              {}
         | BTREE_SYM                {}
+        | BUCKETS_SYM              {}
         | CASCADED                 {}
         | CATALOG_NAME_SYM         {}
         | CHAIN_SYM                {}
@@ -14523,6 +14553,7 @@ keyword_sp:
         | GRANTS                   {}
         | GLOBAL_SYM               {}
         | HASH_SYM                 {}
+        | HISTOGRAM_SYM            {}
         | HOSTS_SYM                {}
         | HOUR_SYM                 {}
         | IDENTIFIED_SYM           {}
@@ -627,6 +627,32 @@ static Sys_var_ulong Sys_binlog_stmt_cache_size(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_binlog_stmt_cache_size));
 
+static bool fix_binlog_dump_ring_size(sys_var *self, THD *thd,
+                                      enum_var_type type)
+{
+  if (!opt_bin_log)
+    return false;
+  if (binlog_dump_ring.resize(opt_binlog_dump_ring_size))
+  {
+    my_error(ER_OUTOFMEMORY, MYF(ME_FATALERROR),
+             (int) opt_binlog_dump_ring_size);
+    return true;
+  }
+  return false;
+}
+
+static Sys_var_ulong Sys_binlog_dump_ring_size(
+       "binlog_dump_ring_size",
+       "The size of the in-memory ring of the most recently written binary "
+       "log events that binlog dump threads read from instead of the binary "
+       "log file. Dump threads that fall behind the ring read the file. "
+       "0 disables the ring",
+       GLOBAL_VAR(opt_binlog_dump_ring_size),
+       CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, ULONG_MAX), DEFAULT(0), BLOCK_SIZE(IO_SIZE),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_binlog_dump_ring_size));
+
 static Sys_var_int32 Sys_binlog_max_flush_queue_time(
        "binlog_max_flush_queue_time",
        "The maximum time that the binary log group commit will keep reading"
@@ -2226,6 +2252,14 @@ static Sys_var_ulong Sys_optimizer_search_depth(
        SESSION_VAR(optimizer_search_depth), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, MAX_TABLES+1), DEFAULT(MAX_TABLES+1), BLOCK_SIZE(1));
 
+static Sys_var_mybool Sys_optimizer_plan_cache(
+       "optimizer_plan_cache",
+       "Reuse the join order and the range accesses chosen for a query "
+       "block of a prepared statement or a stored program statement in its "
+       "later executions, as long as the table statistics and the access "
+       "methods chosen for the current parameter values do not change them",
+       SESSION_VAR(optimizer_plan_cache), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static const char *optimizer_switch_names[]=
 {
   "index_merge", "index_merge_union", "index_merge_sort_union",
@@ -2236,7 +2270,7 @@ static const char *optimizer_switch_names[]=
   "materialization", "semijoin", "loosescan", "firstmatch",
   "subquery_materialization_cost_based",
 #endif
-  "use_index_extensions", "default", NullS
+  "use_index_extensions", "hash_join", "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
 static bool fix_optimizer_switch(sys_var *self, THD *thd,
@@ -2258,8 +2292,8 @@ static Sys_var_flagset Sys_optimizer_switch(
        ", materialization, semijoin, loosescan, firstmatch,"
        " subquery_materialization_cost_based"
 #endif
-       ", block_nested_loop, batched_key_access, use_index_extensions"
-       "} and val is one of {on, off, default}",
+       ", block_nested_loop, batched_key_access, use_index_extensions,"
+       " hash_join} and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(NULL),
@@ -2735,11 +2769,26 @@ static Sys_var_mybool Sys_query_cache_strip_comments(
        GLOBAL_VAR(opt_query_cache_strip_comments), CMD_LINE(OPT_ARG),
        DEFAULT(FALSE));
 
+static bool fix_query_cache_limit(sys_var *self, THD *thd, enum_var_type type)
+{
+  query_cache.result_size_limit(query_cache.query_cache_limit);
+  return false;
+}
 static Sys_var_ulong Sys_query_cache_limit(
        "query_cache_limit",
        "Don't cache results that are bigger than this",
        GLOBAL_VAR(query_cache.query_cache_limit), CMD_LINE(REQUIRED_ARG),
-       VALID_RANGE(0, ULONG_MAX), DEFAULT(1024*1024), BLOCK_SIZE(1));
+       VALID_RANGE(0, ULONG_MAX), DEFAULT(1024*1024), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_query_cache_limit));
+
+static Sys_var_uint Sys_query_cache_shards(
+       "query_cache_shards",
+       "Number of independent shards the query cache is split into. Each "
+       "shard gets an equal part of query_cache_size and its own lock, "
+       "statements are assigned to a shard by a hash of their text",
+       READ_ONLY GLOBAL_VAR(query_cache_shards), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, QUERY_CACHE_MAX_SHARDS), DEFAULT(1), BLOCK_SIZE(1));
 
 static bool fix_qcache_min_res_unit(sys_var *self, THD *thd, enum_var_type type)
 {
@@ -3351,6 +3400,15 @@ static Sys_var_enum Sys_threadpool_high_prio_mode(
   SESSION_VAR(threadpool_high_prio_mode), CMD_LINE(REQUIRED_ARG),
   threadpool_high_prio_mode_names, DEFAULT(TP_HIGH_PRIO_MODE_TRANSACTIONS));
 
+#ifdef HAVE_LIBNUMA
+static Sys_var_mybool Sys_threadpool_numa_affinity(
+  "thread_pool_numa_affinity",
+  "Spread the thread groups over the NUMA nodes, and run the worker threads "
+  "of each group on the CPUs of its node.",
+  READ_ONLY GLOBAL_VAR(threadpool_numa_affinity), CMD_LINE(OPT_ARG),
+  DEFAULT(FALSE));
+#endif
+
 #endif /* !WIN32 */
 static Sys_var_uint Sys_threadpool_max_threads(
   "thread_pool_max_threads",
@@ -4705,6 +4763,27 @@ static Sys_var_ulong Sys_slave_parallel_workers(
        GLOBAL_VAR(opt_mts_slave_parallel_workers), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, MTS_MAX_WORKERS), DEFAULT(0), BLOCK_SIZE(1));
 
+static const char *mts_parallel_type_names[]= {"DATABASE", "LOGICAL_CLOCK", 0};
+static Sys_var_enum Sys_mts_parallel_type(
+       "slave_parallel_type",
+       "Specifies how the Multi-threaded slave distributes transactions "
+       "to the worker threads. DATABASE (default) applies transactions "
+       "updating different databases in parallel. LOGICAL_CLOCK applies "
+       "transactions in parallel when they were committing concurrently "
+       "on the master, which requires GTID_MODE=ON on the master. Takes "
+       "effect at the next start of the slave SQL thread",
+       GLOBAL_VAR(opt_mts_parallel_type), CMD_LINE(REQUIRED_ARG),
+       mts_parallel_type_names, DEFAULT(MTS_PARALLEL_TYPE_DB_NAME));
+
+static Sys_var_mybool Sys_slave_preserve_commit_order(
+       "slave_preserve_commit_order",
+       "Force the Multi-threaded slave to commit transactions in the "
+       "same order as in the relay log. Requires log_bin and "
+       "log_slave_updates. Takes effect at the next start of the slave "
+       "SQL thread",
+       GLOBAL_VAR(opt_slave_preserve_commit_order), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 static Sys_var_ulonglong Sys_mts_pending_jobs_size_max(
        "slave_pending_jobs_size_max",
        "Max size of Slave Worker queues holding yet not applied events."
@@ -3828,9 +3828,10 @@ void TABLE::init(THD *thd, TABLE_LIST *tl)
       item_list          a pointer to an empty list used to store items
 
   DESCRIPTION
-    Create Item_field object for each column in the table and
-    initialize it with the corresponding Field. New items are
-    created in the current THD memory root.
+    Create Item_field object for each column in the table, but the
+    hidden columns of an internal temporary table, and initialize it
+    with the corresponding Field. New items are created in the current
+    THD memory root.
 
   RETURN VALUE
     0                    success
@@ -3843,7 +3844,7 @@ bool TABLE::fill_item_list(List<Item> *item_list) const
     All Item_field's created using a direct pointer to a field
     are fixed in Item_field constructor.
   */
-  for (Field **ptr= field; *ptr; ptr++)
+  for (Field **ptr= field + hidden_field_count; *ptr; ptr++)
   {
     Item_field *item= new Item_field(*ptr);
     if (!item || item_list->push_back(item))
@@ -3870,7 +3871,7 @@ bool TABLE::fill_item_list(List<Item> *item_list) const
 void TABLE::reset_item_list(List<Item> *item_list) const
 {
   List_iterator_fast<Item> it(*item_list);
-  for (Field **ptr= field; *ptr; ptr++)
+  for (Field **ptr= field + hidden_field_count; *ptr; ptr++)
   {
     Item_field *item_field= (Item_field*) it++;
     DBUG_ASSERT(item_field != 0);
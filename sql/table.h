@@ -1072,6 +1072,14 @@ public:
   /* Position in thd->locked_table_list under LOCK TABLES */
   TABLE_LIST *pos_in_locked_tables;
   ORDER		*group;
+  /*
+    Hidden first column of an internal temporary table holding a hash of
+    its GROUP BY or DISTINCT columns, for engines that cannot index them.
+    @see check_unique_constraint()
+  */
+  Field         *hash_field;
+  /* Number of hidden columns in front of an internal temporary table */
+  uint          hidden_field_count;
   const char	*alias;            	  /* alias or table name */
   uchar		*null_flags;
   my_bitmap_map	*bitmap_init_value;
@@ -28,6 +28,9 @@ extern uint threadpool_size; /* Number of parallel executing threads */
 extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall checks*/
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
+#ifdef HAVE_LIBNUMA
+extern my_bool threadpool_numa_affinity; /* Bind thread groups to NUMA nodes */
+#endif
 
 /* Possible values for thread_pool_high_prio_mode */
 extern const char *threadpool_high_prio_mode_names[];
@@ -52,6 +55,27 @@ extern void tp_end(void);
 /* Used in SHOW for threadpool_idle_thread_count */
 extern int  tp_get_idle_thread_count();
 
+/*
+  Statistics of a thread group, shown in INFORMATION_SCHEMA.THREAD_POOL_GROUPS
+*/
+struct TP_GROUP_STATS
+{
+  uint group_id;
+  int connections;
+  int threads;
+  int active_threads;
+  int waiting_threads;          /* between thd_wait_begin() and _end() */
+  uint queue_length;
+  uint high_prio_queue_length;
+  bool has_listener;
+  bool is_stalled;
+  ulonglong steals;             /* events taken from other groups */
+  ulonglong stolen;             /* events taken by other groups */
+};
+
+/* Fill stats[MAX_THREAD_GROUPS], return the number of groups */
+extern uint tp_get_group_stats(TP_GROUP_STATS *stats);
+
 /*
   Threadpool statistics
 */
@@ -35,6 +35,9 @@ uint threadpool_size;
 uint threadpool_stall_limit;
 uint threadpool_max_threads;
 uint threadpool_oversubscribe;
+#ifdef HAVE_LIBNUMA
+my_bool threadpool_numa_affinity;
+#endif
 
 /* Stats */
 TP_STATISTICS tp_stats;
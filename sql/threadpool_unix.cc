@@ -28,6 +28,9 @@
 #include <global_threads.h>
 #include <mysql/thread_pool_priv.h>             // thd_is_transaction_active()
 #include <time.h>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
 #ifdef __linux__
 #include <sys/epoll.h>
 typedef struct epoll_event native_event;
@@ -105,6 +108,8 @@ struct worker_thread_t
   
   mysql_cond_t  cond;
   bool          woken;
+  /* Group whose event this thread is handling, if stolen, see steal_event() */
+  thread_group_t *lent_to;
 };
 
 typedef I_P_List<worker_thread_t, I_P_List_adapter<worker_thread_t,
@@ -131,15 +136,129 @@ typedef I_P_List<connection_t,
                      I_P_List_adapter<connection_t,
                                       &connection_t::next_in_queue,
                                       &connection_t::prev_in_queue>,
-                     I_P_List_null_counter,
+                     I_P_List_counter,
                      I_P_List_fast_push_back<connection_t> >
 connection_queue_t;
 
+/**
+  Queue of connections with pending events of a thread group.
+
+  Connections are queued and dequeued without the group mutex, in a
+  bounded ring of cells with sequence numbers: a position is claimed
+  with a compare-and-swap, and the sequence number of its cell tells
+  whether it holds a connection yet, or is free again. Several
+  workers can dequeue while the listener and other threads enqueue.
+
+  When the ring is full, connections wait in an overflow list under the
+  group mutex, and move to the ring, in order, when it has room again.
+*/
+
+class event_queue_t
+{
+  static const uint ring_size= 256;             /* power of two */
+
+  struct cell_t
+  {
+    volatile int64 seq;
+    connection_t *connection;
+  };
+
+  cell_t ring[ring_size];
+  volatile int64 head;                          /* next position to dequeue */
+  volatile int64 tail;                          /* next position to enqueue */
+  /* Connections that did not fit into the ring, group mutex */
+  connection_queue_t overflow;
+
+public:
+  event_queue_t() : head(0), tail(0)
+  {
+    for (uint i= 0; i < ring_size; i++)
+      ring[i].seq= i;
+  }
+
+  /* Enqueue without the group mutex, false if the ring is full */
+  bool push(connection_t *c)
+  {
+    int64 pos= my_atomic_load64(&tail);
+    for (;;)
+    {
+      cell_t *cell= &ring[pos & (ring_size - 1)];
+      int64 diff= my_atomic_load64(&cell->seq) - pos;
+      if (diff == 0)
+      {
+        if (my_atomic_cas64(&tail, &pos, pos + 1))
+        {
+          cell->connection= c;
+          my_atomic_store64(&cell->seq, pos + 1);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos= my_atomic_load64(&tail);
+    }
+  }
+
+  /* Dequeue without the group mutex, NULL if the ring is empty */
+  connection_t *pop()
+  {
+    int64 pos= my_atomic_load64(&head);
+    for (;;)
+    {
+      cell_t *cell= &ring[pos & (ring_size - 1)];
+      int64 diff= my_atomic_load64(&cell->seq) - (pos + 1);
+      if (diff == 0)
+      {
+        if (my_atomic_cas64(&head, &pos, pos + 1))
+        {
+          connection_t *c= cell->connection;
+          my_atomic_store64(&cell->seq, pos + ring_size);
+          return c;
+        }
+      }
+      else if (diff < 0)
+        return NULL;
+      else
+        pos= my_atomic_load64(&head);
+    }
+  }
+
+  /* Enqueue with the group mutex held, behind the overflowing connections */
+  void push_back(connection_t *c)
+  {
+    connection_t *first;
+    while ((first= overflow.front()) && push(first))
+      overflow.remove(first);
+    if (!overflow.is_empty() || !push(c))
+      overflow.push_back(c);
+  }
+
+  /* Dequeue with the group mutex held, from the overflow once ring is empty */
+  connection_t *pop_front()
+  {
+    connection_t *c= pop();
+    if (!c && (c= overflow.front()))
+      overflow.remove(c);
+    return c;
+  }
+
+  /* Number of queued connections, a snapshot without the group mutex */
+  uint elements() const
+  {
+    return (uint) (my_atomic_load64(const_cast<volatile int64 *>(&tail)) -
+                   my_atomic_load64(const_cast<volatile int64 *>(&head))) +
+           overflow.elements();
+  }
+
+  bool is_empty() const { return elements() == 0; }
+};
+
 struct thread_group_t 
 {
   mysql_mutex_t mutex;
-  connection_queue_t queue;
-  connection_queue_t high_prio_queue;
+  event_queue_t queue;
+  event_queue_t high_prio_queue;
   worker_list_t waiting_threads; 
   worker_thread_t *listener;
   pthread_attr_t *pthread_attr;
@@ -148,11 +267,18 @@ struct thread_group_t
   int  active_thread_count;
   int  connection_count;
   int  waiting_thread_count;
+  /* Threads of this group handling events of other groups, see steal_event() */
+  int  lent_thread_count;
   /* Stats for the deadlock detection timer routine.*/
   int io_event_count;
-  int queue_event_count;
+  volatile int32 queue_event_count;
+  /* Events this group took from other groups / other groups took from it */
+  ulonglong steal_count;
+  ulonglong stolen_count;
   ulonglong last_thread_creation_time;
   int  shutdown_pipe[2];
+  /* NUMA node the workers run on, -1 if any, see thread_pool_numa_affinity */
+  int  numa_node;
   bool shutdown;
   bool stalled;
   
@@ -187,6 +313,8 @@ static int  wake_or_create_thread(thread_group_t *thread_group);
 static int  create_worker(thread_group_t *thread_group);
 static void *worker_main(void *param);
 static void check_stall(thread_group_t *thread_group);
+static int  wake_thief(thread_group_t *thread_group);
+static void thread_group_destroy(thread_group_t *thread_group);
 static void connection_abort(connection_t *connection);
 void tp_post_kill_notification(THD *thd);
 static void set_wait_timeout(connection_t *connection);
@@ -458,28 +586,229 @@ inline bool connection_is_high_prio(const connection_t *c)
 
 } // namespace
 
-/* Dequeue element from a workqueue */
+/*
+  Dequeue element from a workqueue.
+
+  The queues need no lock: without the group mutex, only the connections
+  in the rings are seen, see event_queue_t. With the mutex held, the
+  overflowing ones are taken too.
+*/
 
-static connection_t *queue_get(thread_group_t *thread_group)
+static connection_t *queue_get(thread_group_t *thread_group, bool locked)
 {
   DBUG_ENTER("queue_get");
-  thread_group->queue_event_count++;
+  my_atomic_add32(&thread_group->queue_event_count, 1);
   connection_t *c;
 
-  if ((c= thread_group->high_prio_queue.front()))
-  {
-    thread_group->high_prio_queue.remove(c);
-  }
+  c= locked ? thread_group->high_prio_queue.pop_front() :
+              thread_group->high_prio_queue.pop();
   /*
     Don't pick events from the low priority queue if there are too many
     active + waiting threads.
   */
-  else if (!too_many_busy_threads(thread_group) &&
-           (c= thread_group->queue.front()))
+  if (!c && !too_many_busy_threads(thread_group))
+    c= locked ? thread_group->queue.pop_front() : thread_group->queue.pop();
+  DBUG_RETURN(c);  
+}
+
+
+/*
+  Check whether a group may have events to steal, without locking it. Used
+  to skip groups before trying their mutex: a group has either queued
+  events, or its threads are all busy and nobody listens to its network
+  events.
+*/
+
+static inline bool has_queued_events(thread_group_t *tg)
+{
+  return tg->high_prio_queue.elements() || tg->queue.elements();
+}
+
+static inline bool may_steal_from(thread_group_t *tg)
+{
+  return has_queued_events(tg) ||
+    (!tg->listener && tg->active_thread_count && tg->connection_count);
+}
+
+
+/*
+  Other groups are probed in two passes, see steal_event(): in the first
+  pass only those of the same NUMA node, in the second the others. Without
+  thread_pool_numa_affinity, all groups are in the first pass.
+*/
+
+static inline bool probe_in_pass(thread_group_t *tg, thread_group_t *other,
+                                 uint pass)
+{
+  return (tg->numa_node == other->numa_node) == (pass == 0);
+}
+
+
+/**
+  Take a queued event from another group.
+
+  Connections are bound to a group, so a group that got more busy connections
+  than the others queues events while idle workers of other groups sleep.
+  Before going to sleep, a worker with nothing to do in its own group looks
+  for a group whose queue is not empty and handles one of its events, high
+  priority ones first. Low priority events are only taken if the thief's own
+  group is not too busy, as in queue_get(). If all threads of the other group
+  are busy and none of them listens, the thief picks a single network event
+  of that group, the same way get_event() does for its own group.
+
+  Groups are probed starting at the next one, those of the thief's NUMA
+  node first, and only with trylock: a thief holds its own group mutex and
+  must neither wait for a busy group nor deadlock with another thief.
+
+  While it handles the stolen event, the thief is lent to the victim: it is
+  counted as an active thread of the victim, so that thd_wait_begin() and
+  thd_wait_end() for the stolen connection, which act on the connection's
+  group, keep the counters consistent. return_lent_thread() brings it back.
+
+  @param current_thread - current worker thread
+  @param thread_group - group of the current worker, its mutex must be held
+
+  @return connection with pending event, or NULL if there was nothing to steal
+*/
+
+static connection_t *steal_event(worker_thread_t *current_thread,
+                                 thread_group_t *thread_group)
+{
+  DBUG_ENTER("steal_event");
+  mysql_mutex_assert_owner(&thread_group->mutex);
+  uint group_no= (uint) (thread_group - all_groups);
+  uint count= group_count;
+
+  for (uint i= 1; i < 2 * count; i++)
   {
-    thread_group->queue.remove(c);
+    if (i == count)
+      continue;
+    thread_group_t *victim= &all_groups[(group_no + i) % count];
+
+    if (!probe_in_pass(thread_group, victim, i / count) ||
+        !may_steal_from(victim))
+      continue;
+
+    if (mysql_mutex_trylock(&victim->mutex) != 0)
+      continue;
+
+    connection_t *c= NULL;
+    if (!victim->shutdown)
+    {
+      c= victim->high_prio_queue.pop_front();
+      if (!c && !too_many_busy_threads(thread_group))
+        c= victim->queue.pop_front();
+      if (!c && !victim->listener)
+      {
+        native_event nev;
+        if (io_poll_wait(victim->pollfd, &nev, 1, 0) == 1)
+        {
+          victim->io_event_count++;
+          c= (connection_t *) native_event_get_userdata(&nev);
+          if (connection_is_high_prio(c))
+            c->tickets--;
+          else if (too_many_busy_threads(thread_group))
+          {
+            c->tickets= c->thd->variables.threadpool_high_prio_tickets;
+            victim->queue.push_back(c);
+            c= NULL;
+          }
+        }
+      }
+    }
+
+    if (c)
+    {
+      my_atomic_add32(&victim->queue_event_count, 1);
+      victim->stalled= false;
+      victim->stolen_count++;
+      /* Lend the current thread to the victim. */
+      victim->thread_count++;
+      victim->active_thread_count++;
+      mysql_mutex_unlock(&victim->mutex);
+
+      thread_group->steal_count++;
+      thread_group->active_thread_count--;
+      thread_group->lent_thread_count++;
+      current_thread->lent_to= victim;
+      DBUG_RETURN(c);
+    }
+
+    mysql_mutex_unlock(&victim->mutex);
   }
-  DBUG_RETURN(c);  
+
+  DBUG_RETURN(NULL);
+}
+
+
+/**
+  Return a worker that handled a stolen event to its own group.
+*/
+
+static void return_lent_thread(worker_thread_t *current_thread)
+{
+  thread_group_t *victim= current_thread->lent_to;
+  thread_group_t *thread_group= current_thread->thread_group;
+  bool last_thread;
+
+  current_thread->lent_to= NULL;
+
+  mysql_mutex_lock(&victim->mutex);
+  victim->thread_count--;
+  victim->active_thread_count--;
+  last_thread= ((victim->thread_count == 0) && victim->shutdown);
+  mysql_mutex_unlock(&victim->mutex);
+
+  /* Same as in worker_main(), the last thread destroys a closed group. */
+  if (last_thread)
+    thread_group_destroy(victim);
+
+  mysql_mutex_lock(&thread_group->mutex);
+  thread_group->lent_thread_count--;
+  thread_group->active_thread_count++;
+  mysql_mutex_unlock(&thread_group->mutex);
+}
+
+
+/**
+  Wake an idle worker of another group, so that it steals from this group.
+
+  Called when events are queued in a group that has no idle thread to wake.
+  Only idle groups (no active threads and nothing queued) are disturbed,
+  those of the same NUMA node first.
+  thread_group->mutex must be held, other groups are only trylocked.
+
+  @return 0 if a thread was woken, 1 otherwise
+*/
+
+static int wake_thief(thread_group_t *thread_group)
+{
+  DBUG_ENTER("wake_thief");
+  uint group_no= (uint) (thread_group - all_groups);
+  uint count= group_count;
+
+  for (uint i= 1; i < 2 * count; i++)
+  {
+    if (i == count)
+      continue;
+    thread_group_t *tg= &all_groups[(group_no + i) % count];
+
+    if (!probe_in_pass(thread_group, tg, i / count) ||
+        tg->waiting_threads.is_empty() || tg->active_thread_count)
+      continue;
+
+    if (mysql_mutex_trylock(&tg->mutex) != 0)
+      continue;
+
+    int err= 1;
+    if (!tg->shutdown && !tg->active_thread_count && !has_queued_events(tg))
+      err= wake_thread(tg);
+    mysql_mutex_unlock(&tg->mutex);
+
+    if (!err)
+      DBUG_RETURN(0);
+  }
+  DBUG_RETURN(1);
 }
 
 
@@ -663,14 +992,15 @@ void check_stall(thread_group_t *thread_group)
     do wait and indicate that via thd_wait_begin/end callbacks, thread creation
     will be faster.
   */
-  if (!thread_group->queue_event_count && !queues_are_empty(thread_group))
+  if (!my_atomic_load32(&thread_group->queue_event_count) &&
+      !queues_are_empty(thread_group))
   {
     thread_group->stalled= true;
     wake_or_create_thread(thread_group);
   }
   
   /* Reset queue event count */
-  thread_group->queue_event_count= 0;
+  my_atomic_store32(&thread_group->queue_event_count, 0);
   
   mysql_mutex_unlock(&thread_group->mutex);
 }
@@ -837,6 +1167,14 @@ static connection_t * listener(worker_thread_t *current_thread,
         }
       }
     }
+    else
+    {
+      /*
+        The queued events wait for the active threads of the group. Let an
+        idle worker of another group take them instead, see steal_event().
+      */
+      wake_thief(thread_group);
+    }
     mysql_mutex_unlock(&thread_group->mutex);
   }
 
@@ -992,6 +1330,7 @@ static int thread_group_init(thread_group_t *thread_group,
   thread_group->pthread_attr = thread_attr;
   mysql_mutex_init(key_group_mutex, &thread_group->mutex, NULL);
   thread_group->pollfd= -1;
+  thread_group->numa_node= -1;
   thread_group->shutdown_pipe[0]= -1;
   thread_group->shutdown_pipe[1]= -1;
   DBUG_RETURN(0);
@@ -1101,9 +1440,17 @@ static void queue_put(thread_group_t *thread_group, connection_t *connection)
 {
   DBUG_ENTER("queue_put");
 
-  mysql_mutex_lock(&thread_group->mutex);
   connection->tickets= connection->thd->variables.threadpool_high_prio_tickets;
-  thread_group->queue.push_back(connection);
+  /*
+    The connection is queued without the mutex, unless the ring is full.
+    The mutex is taken after it is queued, so that a worker that found the
+    queue empty is already waiting and gets woken.
+  */
+  bool queued= thread_group->queue.push(connection);
+
+  mysql_mutex_lock(&thread_group->mutex);
+  if (!queued)
+    thread_group->queue.push_back(connection);
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
@@ -1139,6 +1486,18 @@ static connection_t *get_event(worker_thread_t *current_thread,
   connection_t *connection = NULL;
   int err=0;
 
+  /*
+    Take a queued event without the group mutex. The current thread stays
+    active, so the counters of the group do not change. The mutex is only
+    needed to become the listener, to pick a network event or to sleep.
+  */
+  if (!thread_group->shutdown && !too_many_active_threads(thread_group) &&
+      (connection= queue_get(thread_group, false)))
+  {
+    thread_group->stalled= false;
+    DBUG_RETURN(connection);
+  }
+
   mysql_mutex_lock(&thread_group->mutex);
   DBUG_ASSERT(thread_group->active_thread_count >= 0);
 
@@ -1151,7 +1510,7 @@ static connection_t *get_event(worker_thread_t *current_thread,
     /* Check if queue is not empty */
     if (!oversubscribed)
     {
-      connection = queue_get(thread_group);
+      connection = queue_get(thread_group, true);
       if(connection)
         break;
     }
@@ -1208,10 +1567,15 @@ static connection_t *get_event(worker_thread_t *current_thread,
 
         if (connection)
         {
-          thread_group->queue_event_count++;
+          my_atomic_add32(&thread_group->queue_event_count, 1);
           break;
         }
       }
+
+      /* Nothing to do in our group, help an overloaded one. */
+      connection= steal_event(current_thread, thread_group);
+      if (connection)
+        break;
     }
 
     /* And now, finally sleep */ 
@@ -1603,12 +1967,18 @@ static void *worker_main(void *param)
   mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
   this_thread.thread_group= thread_group;
   this_thread.event_count=0;
+  this_thread.lent_to= NULL;
 
 #ifdef HAVE_PSI_THREAD_INTERFACE
     PSI_THREAD_CALL(set_thread_user_host)
       (NULL, 0, NULL, 0);
 #endif
 
+#ifdef HAVE_LIBNUMA
+  if (thread_group->numa_node >= 0)
+    numa_run_on_node(thread_group->numa_node);
+#endif
+
   /* Run event loop */
   for(;;)
   {
@@ -1620,6 +1990,8 @@ static void *worker_main(void *param)
       break;
     this_thread.event_count++;
     handle_event(connection);
+    if (this_thread.lent_to)
+      return_lent_thread(&this_thread);
   }
 
   /* Thread shutdown: cleanup per-worker-thread structure. */
@@ -1640,16 +2012,68 @@ static void *worker_main(void *param)
 }
 
 
+#ifdef HAVE_LIBNUMA
+/**
+  Spread the thread groups round robin over the NUMA nodes that have CPUs,
+  for thread_pool_numa_affinity. The workers of a group run on the CPUs of
+  its node, and steal events from the groups of the same node first.
+*/
+
+static void bind_groups_to_numa_nodes()
+{
+  int nodes[MAX_THREAD_GROUPS];
+  uint node_count= 0;
+
+  if (numa_available() < 0)
+  {
+    sql_print_warning("Threadpool: NUMA is not available, "
+                      "thread_pool_numa_affinity is ignored");
+    return;
+  }
+
+  struct bitmask *cpus= numa_allocate_cpumask();
+  for (int node= 0;
+       node <= numa_max_node() && node_count < MAX_THREAD_GROUPS; node++)
+  {
+    if (numa_bitmask_isbitset(numa_all_nodes_ptr, node) &&
+        numa_node_to_cpus(node, cpus) == 0 &&
+        numa_bitmask_weight(cpus) > 0)
+      nodes[node_count++]= node;
+  }
+  numa_free_cpumask(cpus);
+
+  if (node_count == 0)
+    return;
+
+  for (uint i= 0; i < array_elements(all_groups); i++)
+    all_groups[i].numa_node= nodes[i % node_count];
+  sql_print_information("Threadpool: thread groups are spread over %u NUMA "
+                        "node(s)", node_count);
+}
+#endif
+
+
 bool tp_init()
 {
   DBUG_ENTER("tp_init");
   threadpool_started= true;
   scheduler_init();
 
+#ifdef HAVE_PSI_INTERFACE
+  /* Before the group mutexes are created with the keys */
+  PSI_register(mutex);
+  PSI_register(cond);
+  PSI_register(thread);
+#endif
+
   for(uint i=0; i < array_elements(all_groups); i++)
   {
     thread_group_init(&all_groups[i], get_connection_attrib());  
   }
+#ifdef HAVE_LIBNUMA
+  if (threadpool_numa_affinity)
+    bind_groups_to_numa_nodes();
+#endif
   tp_set_threadpool_size(threadpool_size);
   if(group_count == 0)
   {
@@ -1657,11 +2081,6 @@ bool tp_init()
     sql_print_error("Can't set threadpool size to %d",threadpool_size);
     DBUG_RETURN(1);
   }
-#ifdef HAVE_PSI_INTERFACE
-  PSI_register(mutex);
-  PSI_register(cond);
-  PSI_register(thread);
-#endif
   
   pool_timer.tick_interval= threadpool_stall_limit;
   start_timer(&pool_timer);
@@ -1743,12 +2162,50 @@ int tp_get_idle_thread_count()
       i< array_elements(all_groups) && (all_groups[i].pollfd >= 0); 
       i++)
   {
-    sum+= (all_groups[i].thread_count - all_groups[i].active_thread_count);
+    sum+= (all_groups[i].thread_count - all_groups[i].active_thread_count
+           - all_groups[i].lent_thread_count);
   }
   return sum;
 }
 
 
+/**
+ Collect statistics of every thread group in use.
+
+ Each group is locked while its counters are copied, so that they are
+ consistent with each other.
+*/
+
+uint tp_get_group_stats(TP_GROUP_STATS *stats)
+{
+  uint count= 0;
+
+  if (!threadpool_started)
+    return 0;
+
+  for (uint i= 0; i < group_count; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    TP_GROUP_STATS *st= &stats[count++];
+
+    mysql_mutex_lock(&group->mutex);
+    st->group_id= i;
+    st->connections= group->connection_count;
+    st->threads= group->thread_count;
+    st->active_threads= group->active_thread_count;
+    st->waiting_threads= group->waiting_thread_count;
+    st->queue_length= group->queue.elements();
+    st->high_prio_queue_length= group->high_prio_queue.elements();
+    st->has_listener= (group->listener != NULL);
+    st->is_stalled= group->stalled;
+    st->steals= group->steal_count;
+    st->stolen= group->stolen_count;
+    mysql_mutex_unlock(&group->mutex);
+  }
+  return count;
+}
+
+
 /* Report threadpool problems */
 
 /** 
@@ -761,3 +761,9 @@ int tp_get_idle_thread_count()
   return 0;
 }
 
+uint tp_get_group_stats(TP_GROUP_STATS *stats)
+{
+  /* The OS thread pool has no thread groups. */
+  return 0;
+}
+
@@ -397,6 +397,16 @@ int ha_heap::rnd_pos(uchar * buf, uchar *pos)
   return error;
 }
 
+int ha_heap::restart_rnd_next(uchar *buf, uchar *pos)
+{
+  int error;
+  HEAP_PTR heap_position;
+  memcpy(&heap_position, pos, sizeof(HEAP_PTR));
+  error= heap_scan_restart(file, buf, heap_position);
+  table->status=error ? STATUS_NOT_FOUND: 0;
+  return error;
+}
+
 void ha_heap::position(const uchar *record)
 {
   *(HEAP_PTR*) ref= heap_position(file);	// Ref is aligned
@@ -337,6 +337,7 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->fixed_data_length= fixed_data_length;
     share->fixed_column_count= fixed_column_count;
     share->blobs= create_info->blobs;
+    share->internal_table= create_info->internal_table;
 
     share->recordspace.chunk_length= chunk_length;
     share->recordspace.chunk_dataspace_length= chunk_dataspace_length;
@@ -468,7 +469,7 @@ void heap_drop_table(HP_INFO *info)
 
 void hp_free(HP_SHARE *share)
 {
-  if (share->open_list.data)                    /* If not internal table */
+  if (!share->internal_table)
     heap_share_list= list_delete(heap_share_list, &share->open_list);
   hp_clear(share);			/* Remove blocks from memory */
   thr_lock_delete(&share->lock);
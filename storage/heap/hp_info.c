@@ -20,6 +20,7 @@
 
 uchar *heap_position(HP_INFO *info)
 {
+  info->position_record= info->current_record;  /* For heap_scan_restart() */
   return ((info->update & HA_STATE_AKTIV) ? info->current_ptr :
 	  (HEAP_PTR) 0);
 }
@@ -43,6 +43,7 @@ HP_INFO *heap_open_from_share(HP_SHARE *share, int mode)
   info->recbuf= (uchar*) (info->lastkey + share->max_key_length);
   info->mode= mode;
   info->current_record= (ulong) ~0L;		/* No current record */
+  info->position_record= (ulong) ~0L;
   info->lastinx= info->errkey= -1;
 #ifndef DBUG_OFF
   info->opt_flag= READ_CHECK_USED;		/* Check when changing */
@@ -64,3 +64,40 @@ int heap_scan(register HP_INFO *info, uchar *record)
   info->current_hash_ptr=0;			/* Can't use read_next */
   DBUG_RETURN(0);
 } /* heap_scan */
+
+
+/*
+  Read the record at pos and continue the table scan after it.
+  pos is normally the position taken last during the scan, whose chunk
+  number heap_position() remembered; other positions are searched for.
+  Returns the same values as heap_scan().
+*/
+
+int heap_scan_restart(HP_INFO *info, uchar *record, uchar *pos)
+{
+  HP_SHARE *share=info->s;
+  ulong chunk;
+  DBUG_ENTER("heap_scan_restart");
+
+  if (info->position_record < share->recordspace.chunk_count)
+  {
+    hp_find_record(info, info->position_record);
+    if (info->current_ptr == pos)
+    {
+      info->current_record= info->position_record;
+      DBUG_RETURN(heap_rrnd(info, record, pos));
+    }
+  }
+
+  for (chunk= 0; chunk < share->recordspace.chunk_count; chunk++)
+  {
+    hp_find_record(info, chunk);
+    if (info->current_ptr == pos)
+    {
+      info->current_record= chunk;
+      DBUG_RETURN(heap_rrnd(info, record, pos));
+    }
+  }
+  info->update= 0;
+  DBUG_RETURN(my_errno= HA_ERR_END_OF_FILE);
+} /* heap_scan_restart */
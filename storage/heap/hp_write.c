@@ -54,6 +54,20 @@ int heap_write(HP_INFO *info, const uchar *record)
 
   hp_get_encoded_data_length(share, record, &chunk_count);
 
+  /*
+    A row with BLOBs can span many chunks; do not let a single row take
+    an internal temporary table past max_table_size, so that it gets
+    converted to disk instead.
+  */
+  if (share->blobs && share->internal_table &&
+      share->recordspace.total_data_length + share->index_length +
+      (ulonglong) chunk_count * share->recordspace.chunk_length >
+      share->max_table_size)
+  {
+    my_errno= HA_ERR_RECORD_FILE_FULL;
+    DBUG_RETURN(my_errno);
+  }
+
   if (!(pos= hp_allocate_chunkset(&share->recordspace, chunk_count)))
     DBUG_RETURN(my_errno);
   share->changed=1;
@@ -532,9 +532,7 @@ btr_cur_search_to_nth_level(
 # ifdef UNIV_SEARCH_PERF_STAT
 	info->n_searches++;
 # endif
-	if (rw_lock_get_writer(btr_search_get_latch(cursor->index)) ==
-	    RW_LOCK_NOT_LOCKED
-	    && latch_mode <= BTR_MODIFY_LEAF
+	if (latch_mode <= BTR_MODIFY_LEAF
 	    && info->last_hash_succ
 	    && !estimate
 # ifdef PAGE_CUR_LE_OR_EXTENDS
@@ -70,7 +70,9 @@ protect: (1) positions of records on those pages where a hash index from the
 corresponding AHI partition has been built.
 NOTE: They do not protect values of non-ordering fields within a record from
 being updated in-place! We can use fact (1) to perform unique searches to
-indexes. */
+indexes.
+The latches are only needed to modify a partition: btr_search_guess_on_hash()
+searches it without a latch, see ha_read_enter(). */
 
 UNIV_INTERN prio_rw_lock_t*	btr_search_latch_arr;
 
@@ -201,6 +203,8 @@ btr_search_sys_create(
 		btr_search_sys->hash_tables[i]
 			= ib_create(hash_size, 0, MEM_HEAP_FOR_BTR_SEARCH, 0);
 
+		ha_readers_create(btr_search_sys->hash_tables[i]);
+
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 		btr_search_sys->hash_tables[i]->adaptive = TRUE;
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
@@ -222,6 +226,8 @@ btr_search_sys_free(void)
 
 		mem_heap_free(btr_search_sys->hash_tables[i]->heap);
 
+		ha_readers_free(btr_search_sys->hash_tables[i]);
+
 		hash_table_free(btr_search_sys->hash_tables[i]);
 
 	}
@@ -292,9 +298,10 @@ btr_search_disable(void)
 	/* Set all block->index = NULL. */
 	buf_pool_clear_hash_index();
 
-	/* Clear the adaptive hash index. */
+	/* Clear the adaptive hash index. This waits for the searches
+	which may still see the nodes before their memory is freed. */
 	for (i = 0; i < btr_search_index_num; i++) {
-		hash_table_clear(btr_search_sys->hash_tables[i]);
+		ha_remove_all_nodes(btr_search_sys->hash_tables[i]);
 		mem_heap_empty(btr_search_sys->hash_tables[i]->heap);
 	}
 
@@ -911,8 +918,10 @@ btr_search_guess_on_hash(
 {
 	buf_pool_t*	buf_pool;
 	buf_block_t*	block;
+	hash_table_t*	table;
 	const rec_t*	rec;
 	ulint		fold;
+	ulint		ticket = 0;
 	index_id_t	index_id;
 #ifdef notdefined
 	btr_cur_t	cursor2;
@@ -950,39 +959,68 @@ btr_search_guess_on_hash(
 	cursor->fold = fold;
 	cursor->flag = BTR_CUR_HASH;
 
+	table = btr_search_get_hash_table(index);
+
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(btr_search_get_latch(index));
+		/* Search without the latch: the nodes we see are not
+		reused before ha_read_exit(), but the record they point
+		to may be moved or purged, and its block even be freed,
+		as soon as the node has been removed. */
+		ticket = ha_read_enter(table);
 
 		if (UNIV_UNLIKELY(!btr_search_enabled)) {
 			goto failure_unlock;
 		}
+	} else {
+		ut_ad(rw_lock_get_writer(btr_search_get_latch(index))
+		      != RW_LOCK_EX);
+		ut_ad(rw_lock_get_reader_count(btr_search_get_latch(index))
+		      > 0);
 	}
 
-	ut_ad(rw_lock_get_writer(btr_search_get_latch(index)) != RW_LOCK_EX);
-	ut_ad(rw_lock_get_reader_count(btr_search_get_latch(index)) > 0);
-
-	rec = (rec_t*) ha_search_and_get_data(
-		btr_search_get_hash_table(index), fold);
+	rec = (rec_t*) ha_search_and_get_data(table, fold);
 
 	if (UNIV_UNLIKELY(!rec)) {
 		goto failure_unlock;
 	}
 
-	block = buf_block_align(rec);
+	block = buf_block_from_ahi(rec);
 
 	if (UNIV_LIKELY(!has_search_latch)) {
 
+		DEBUG_SYNC_C("btr_search_guess_on_hash_unlatched");
+
+		/* This fails unless the block still holds a file page.
+		We make the block young below if needed. */
 		if (UNIV_UNLIKELY(
 			    !buf_page_get_known_nowait(latch_mode, block,
-						       BUF_MAKE_YOUNG,
+						       BUF_KEEP_OLD,
 						       __FILE__, __LINE__,
 						       mtr))) {
 			goto failure_unlock;
 		}
 
-		rw_lock_s_unlock(btr_search_get_latch(index));
+		/* Records of a page are only moved, and hash nodes
+		pointing to them only removed, while the page is
+		x-latched or the block is being freed. Now that we have
+		latched the page, if the node still points to the record,
+		the record is valid. */
+		if (UNIV_UNLIKELY(ha_search_and_get_data(table, fold)
+				  != rec)) {
+			ha_read_exit(table, ticket);
+
+			btr_leaf_page_release(block, latch_mode, mtr);
+
+			goto failure;
+		}
+
+		ha_read_exit(table, ticket);
 
 		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
+
+#if defined UNIV_DEBUG_FILE_ACCESSES || defined UNIV_DEBUG
+		ut_a(!block->page.file_page_was_freed);
+#endif /* UNIV_DEBUG_FILE_ACCESSES || UNIV_DEBUG */
 	}
 
 	if (UNIV_UNLIKELY(buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE)) {
@@ -1077,7 +1115,7 @@ btr_search_guess_on_hash(
 	/*-------------------------------------------*/
 failure_unlock:
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_unlock(btr_search_get_latch(index));
+		ha_read_exit(table, ticket);
 	}
 failure:
 	cursor->flag = BTR_CUR_HASH_FAIL;
@@ -1557,6 +1557,38 @@ buf_pool_init(
 		}
 	}
 
+	if (srv_use_io_uring) {
+		/* Let the page reads and writes use the chunks as
+		fixed io_uring buffers. */
+		ulint	n_chunks = 0;
+
+		for (i = 0; i < n_instances; i++) {
+			n_chunks += buf_pool_ptr[i].n_chunks;
+		}
+
+		void**	mem = static_cast<void**>(
+			mem_alloc(n_chunks * sizeof *mem));
+		ulint*	mem_size = static_cast<ulint*>(
+			mem_alloc(n_chunks * sizeof *mem_size));
+
+		n_chunks = 0;
+
+		for (i = 0; i < n_instances; i++) {
+			const buf_pool_t*	buf_pool = &buf_pool_ptr[i];
+
+			for (ulint j = 0; j < buf_pool->n_chunks; j++) {
+				mem[n_chunks] = buf_pool->chunks[j].mem;
+				mem_size[n_chunks] = buf_pool->chunks[j].mem_size;
+				n_chunks++;
+			}
+		}
+
+		os_aio_register_buffers(mem, mem_size, n_chunks);
+
+		mem_free(mem);
+		mem_free(mem_size);
+	}
+
 	buf_pool_set_sizes();
 	buf_LRU_old_ratio_update(100 * 3/ 8, FALSE);
 
@@ -2528,6 +2560,53 @@ buf_block_align(
 	return(NULL);
 }
 
+/*******************************************************************//**
+Gets the block to whose frame a pointer found in the adaptive hash index
+is pointing to. Unlike buf_block_align(), this does not assume anything
+about the state of the block: as the adaptive hash index is searched
+without a latch, the block may have been freed or reused meanwhile.
+@return	pointer to block, never NULL */
+UNIV_INTERN
+buf_block_t*
+buf_block_from_ahi(
+/*===============*/
+	const byte*	ptr)	/*!< in: pointer to a frame */
+{
+	ulint	i;
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_chunk_t*	chunk;
+		ulint		j;
+
+		/* The chunks remain constant after buf_pool_init(). */
+		for (chunk = buf_pool->chunks, j = buf_pool->n_chunks;
+		     j--; chunk++) {
+			ulint	offs;
+
+			if (ptr < chunk->blocks->frame) {
+
+				continue;
+			}
+
+			offs = (ptr - chunk->blocks->frame)
+				>> UNIV_PAGE_SIZE_SHIFT;
+
+			if (offs < chunk->size) {
+				buf_block_t*	block = &chunk->blocks[offs];
+
+				ut_ad(block->frame == page_align(ptr));
+
+				return(block);
+			}
+		}
+	}
+
+	/* The block should always be found. */
+	ut_error;
+	return(NULL);
+}
+
 /********************************************************************//**
 Find out if a pointer belongs to a buf_block_t. It can be a pointer to
 the buf_block_t itself or a member of it. This functions checks one of
@@ -3204,6 +3283,19 @@ got_block:
 
 		buf_page_set_accessed(&fix_block->page);
 
+		buf_block_mutex_exit(fix_block);
+	} else if (ut_rnd_gen_next_ulint(buf_pool->stat.n_page_gets)
+		   % BUF_ACCESS_COUNT_SAMPLE == 0) {
+		/* Sample the repeated accesses, so that hot pages do not
+		take their block mutex on every access. The page get
+		counter is scrambled, so that a page whose accesses recur
+		at a fixed distance in the stream of page gets is not
+		always or never sampled. */
+		buf_block_mutex_enter(fix_block);
+
+		buf_page_inc_access_count(&fix_block->page,
+					  BUF_ACCESS_COUNT_SAMPLE);
+
 		buf_block_mutex_exit(fix_block);
 	}
 
@@ -3421,21 +3513,25 @@ buf_page_get_known_nowait(
 
 	mutex_enter(&block->mutex);
 
-	if (buf_block_get_state(block) == BUF_BLOCK_REMOVE_HASH) {
+	if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE) {
 		/* Another thread is just freeing the block from the LRU list
-		of the buffer pool: do not try to access this page; this
-		attempt to access the page can only come through the hash
-		index because when the buffer block state is ..._REMOVE_HASH,
-		we have already removed it from the page address hash table
-		of the buffer pool. */
+		of the buffer pool, or has already freed it: do not try to
+		access this page; this attempt to access the page can only
+		come through the adaptive hash index, which is searched
+		without a latch, because when the buffer block state is
+		..._REMOVE_HASH, we have already removed it from the page
+		address hash table of the buffer pool. */
+
+		ut_ad(buf_block_get_state(block) == BUF_BLOCK_REMOVE_HASH
+		      || buf_block_get_state(block) == BUF_BLOCK_NOT_USED
+		      || buf_block_get_state(block) == BUF_BLOCK_READY_FOR_USE
+		      || buf_block_get_state(block) == BUF_BLOCK_MEMORY);
 
 		mutex_exit(&block->mutex);
 
 		return(FALSE);
 	}
 
-	ut_a(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
-
 	buf_block_buf_fix_inc(block, file, line);
 
 	buf_page_set_accessed(&block->page);
@@ -3610,6 +3706,7 @@ buf_page_init_low(
 	bpage->buf_fix_count = 0;
 	bpage->freed_page_clock = 0;
 	bpage->access_time = 0;
+	bpage->access_count = 0;
 	bpage->newest_modification = 0;
 	bpage->oldest_modification = 0;
 	HASH_INVALIDATE(bpage, hash);
@@ -39,8 +39,9 @@ Created 2011/12/19
 #ifndef UNIV_HOTBACKUP
 
 #ifdef UNIV_PFS_MUTEX
-/* Key to register the mutex with performance schema */
+/* Keys to register the mutexes with performance schema */
 UNIV_INTERN mysql_pfs_key_t	buf_dblwr_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	buf_dblwr_shard_mutex_key;
 #endif /* UNIV_PFS_RWLOCK */
 
 /** The doublewrite buffer */
@@ -99,6 +100,25 @@ buf_dblwr_get(
 	return(buf_block_get_frame(block) + TRX_SYS_DOUBLEWRITE);
 }
 
+/********************************************************************//**
+Gets the doublewrite shard used by the batch flushes of a buffer pool
+instance.
+@return	doublewrite shard */
+UNIV_INLINE
+buf_dblwr_shard_t*
+buf_dblwr_get_shard(
+/*================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+{
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+	ut_ad(buf_dblwr->n_shards == 2 * srv_buf_pool_instances);
+
+	return(&buf_dblwr->shards[2 * buf_pool_index(buf_pool)
+				  + (flush_type == BUF_FLUSH_LIST)]);
+}
+
 /********************************************************************//**
 Flush a batch of writes to the datafiles that have already been
 written to the dblwr buffer on disk. */
@@ -119,6 +139,122 @@ buf_dblwr_sync_datafiles()
 	fil_flush_file_spaces(FIL_TABLESPACE);
 }
 
+/****************************************************************//**
+Creates the doublewrite shards and opens the parallel doublewrite file,
+creating or extending it as needed. The pages already in the file are
+left in place, as they may still be needed by crash recovery. */
+static
+void
+buf_dblwr_init_shards(void)
+/*=======================*/
+{
+	const char*	path = srv_parallel_doublewrite_path;
+	const ulint	shard_size = srv_doublewrite_batch_size
+		* UNIV_PAGE_SIZE;
+	os_offset_t	file_size;
+	os_offset_t	size;
+	ibool		exists;
+	ibool		success;
+	os_file_type_t	type;
+
+	buf_dblwr->n_shards = 2 * srv_buf_pool_instances;
+
+	buf_dblwr->shards = static_cast<buf_dblwr_shard_t*>(
+		mem_zalloc(buf_dblwr->n_shards * sizeof(buf_dblwr_shard_t)));
+
+	for (ulint i = 0; i < buf_dblwr->n_shards; i++) {
+		buf_dblwr_shard_t*	shard = &buf_dblwr->shards[i];
+
+		mutex_create(buf_dblwr_shard_mutex_key,
+			     &shard->mutex, SYNC_DOUBLEWRITE);
+
+		shard->b_event = os_event_create();
+		shard->offset = (os_offset_t) i * shard_size;
+
+		shard->write_buf_unaligned = static_cast<byte*>(
+			ut_malloc((1 + srv_doublewrite_batch_size)
+				  * UNIV_PAGE_SIZE));
+
+		shard->write_buf = static_cast<byte*>(
+			ut_align(shard->write_buf_unaligned,
+				 UNIV_PAGE_SIZE));
+
+		shard->buf_block_arr = static_cast<buf_page_t**>(
+			mem_zalloc(srv_doublewrite_batch_size
+				   * sizeof(void*)));
+	}
+
+	if (!os_file_status(path, &exists, &type)) {
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot access the parallel doublewrite file %s. "
+			"Cannot continue operation.", path);
+
+		exit(EXIT_FAILURE);
+	}
+
+	buf_dblwr->shard_file = os_file_create(
+		innodb_file_data_key, path,
+		exists ? OS_FILE_OPEN : OS_FILE_CREATE,
+		OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+	if (!success) {
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot %s the parallel doublewrite file %s. "
+			"Cannot continue operation.",
+			exists ? "open" : "create", path);
+
+		exit(EXIT_FAILURE);
+	}
+
+	file_size = (os_offset_t) buf_dblwr->n_shards * shard_size;
+	size = exists ? os_file_get_size(buf_dblwr->shard_file) : 0;
+
+	if (size == (os_offset_t) -1) {
+		size = 0;
+	}
+
+	if (size < file_size) {
+		/* Extend the file with zeroes, one shard worth at a
+		time. Whatever is already in it is left intact. */
+		byte*	zeroes = buf_dblwr->shards[0].write_buf;
+
+		memset(zeroes, 0, shard_size);
+
+		for (size -= size % UNIV_PAGE_SIZE; size < file_size;
+		     size += shard_size) {
+
+			ulint	len = shard_size;
+
+			if (file_size - size < shard_size) {
+				len = (ulint) (file_size - size);
+			}
+
+			success = os_file_write(path, buf_dblwr->shard_file,
+						zeroes, size, len);
+
+			if (!success) {
+
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"Cannot extend the parallel "
+					"doublewrite file %s to " UINT64PF
+					" bytes. Cannot continue operation.",
+					path, file_size);
+
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		os_file_flush(buf_dblwr->shard_file);
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Using %lu doublewrite shards of %lu pages in %s",
+		(ulong) buf_dblwr->n_shards,
+		(ulong) srv_doublewrite_batch_size, path);
+}
+
 /****************************************************************//**
 Creates or initialializes the doublewrite buffer at a database start. */
 static
@@ -134,22 +270,19 @@ buf_dblwr_init(
 		mem_zalloc(sizeof(buf_dblwr_t)));
 
 	/* There are two blocks of same size in the doublewrite
-	buffer. */
+	buffer. Batch flushes go to the shards in the parallel
+	doublewrite file, so all of its pages are available for
+	single page flushes. */
 	buf_size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
 
-	/* There must be atleast one buffer for single page writes
-	and one buffer for batch writes. */
-	ut_a(srv_doublewrite_batch_size > 0
-	     && srv_doublewrite_batch_size < buf_size);
+	/* A shard must be able to hold at least one page. */
+	ut_a(srv_doublewrite_batch_size > 0);
 
 	mutex_create(buf_dblwr_mutex_key,
 		     &buf_dblwr->mutex, SYNC_DOUBLEWRITE);
 
-	buf_dblwr->b_event = os_event_create();
 	buf_dblwr->s_event = os_event_create();
-	buf_dblwr->first_free = 0;
 	buf_dblwr->s_reserved = 0;
-	buf_dblwr->b_reserved = 0;
 
 	buf_dblwr->block1 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK1);
@@ -168,6 +301,10 @@ buf_dblwr_init(
 
 	buf_dblwr->buf_block_arr = static_cast<buf_page_t**>(
 		mem_zalloc(buf_size * sizeof(void*)));
+
+	if (srv_use_doublewrite_buf && !srv_read_only_mode) {
+		buf_dblwr_init_shards();
+	}
 }
 
 /****************************************************************//**
@@ -346,6 +483,69 @@ start_again:
 	goto start_again;
 }
 
+/****************************************************************//**
+Reads the pages of the parallel doublewrite file into memory, so that
+crash recovery can restore half-written pages from any shard. */
+static
+void
+buf_dblwr_load_shard_pages(
+/*=======================*/
+	recv_dblwr_t&	recv_dblwr)	/*!< in/out: doublewrite pages
+					for recovery */
+{
+	const char*	path = srv_parallel_doublewrite_path;
+	pfs_os_file_t	file;
+	os_offset_t	size;
+	ibool		exists;
+	ibool		success;
+	os_file_type_t	type;
+
+	if (!os_file_status(path, &exists, &type) || !exists) {
+		return;
+	}
+
+	file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, path, OS_FILE_OPEN,
+		OS_FILE_READ_ONLY, &success);
+
+	if (!success) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Cannot open the parallel doublewrite file %s, "
+			"pages in it will not be recovered", path);
+		return;
+	}
+
+	size = os_file_get_size(file);
+
+	if (size != (os_offset_t) -1 && size >= UNIV_PAGE_SIZE) {
+
+		ulint	n_pages = (ulint) (size / UNIV_PAGE_SIZE);
+		byte*	unaligned_buf;
+		byte*	buf;
+
+		unaligned_buf = static_cast<byte*>(
+			ut_malloc((1 + n_pages) * UNIV_PAGE_SIZE));
+
+		buf = static_cast<byte*>(
+			ut_align(unaligned_buf, UNIV_PAGE_SIZE));
+
+		os_file_read(file, buf, 0, n_pages * UNIV_PAGE_SIZE);
+
+		/* The buffer is freed together with the page list */
+		recv_dblwr.bufs.push_back(unaligned_buf);
+
+		for (ulint i = 0; i < n_pages; i++) {
+			byte*	page = buf + i * UNIV_PAGE_SIZE;
+
+			if (!buf_page_is_zeroes(page, 0)) {
+				recv_dblwr.add(page);
+			}
+		}
+	}
+
+	os_file_close(file);
+}
+
 /****************************************************************//**
 At a database startup initializes the doublewrite buffer memory structure if
 we already have a doublewrite buffer created in the data files. If we are
@@ -464,12 +664,57 @@ buf_dblwr_init_or_load_pages(
 		os_file_flush(file);
 	}
 
+	if (load_corrupt_pages) {
+		buf_dblwr_load_shard_pages(recv_dblwr);
+	}
+
 leave_func:
 	ut_free(unaligned_read_buf);
 }
 
 /****************************************************************//**
-Process the double write buffer pages. */
+Finds the most recent copy of a page in the doublewrite pages that is
+not corrupt. A page can have copies in several doublewrite shards and in
+the single page flush slots; the older ones are stale.
+@return	page copy with the highest LSN, or NULL if there is none */
+static
+byte*
+buf_dblwr_find_good_copy(
+/*=====================*/
+	recv_dblwr_t&	recv_dblwr,	/*!< in: doublewrite pages */
+	ulint		space_id,	/*!< in: tablespace id */
+	ulint		page_no,	/*!< in: page number */
+	ulint		zip_size)	/*!< in: compressed page size, or 0 */
+{
+	byte*	result = NULL;
+	lsn_t	max_lsn = 0;
+
+	for (std::list<byte*>::iterator i = recv_dblwr.pages.begin();
+	     i != recv_dblwr.pages.end(); ++i) {
+
+		byte*	page = *i;
+
+		if (mach_read_from_4(page + FIL_PAGE_OFFSET) != page_no
+		    || mach_read_from_4(page + FIL_PAGE_SPACE_ID) != space_id
+		    || buf_page_is_zeroes(page, zip_size)
+		    || buf_page_is_corrupted(true, page, zip_size)) {
+			continue;
+		}
+
+		lsn_t	page_lsn = mach_read_from_8(page + FIL_PAGE_LSN);
+
+		if (result == NULL || page_lsn > max_lsn) {
+			result = page;
+			max_lsn = page_lsn;
+		}
+	}
+
+	return(result);
+}
+
+/****************************************************************//**
+Process the double write buffer pages of the system tablespace and of
+all the shards of the parallel doublewrite file. */
 void
 buf_dblwr_process()
 /*===============*/
@@ -520,6 +765,8 @@ buf_dblwr_process()
 
 			if (buf_page_is_corrupted(true, read_buf, zip_size)) {
 
+				byte*	good_page;
+
 				fprintf(stderr,
 					"InnoDB: Database page"
 					" corruption or a failed\n"
@@ -529,8 +776,11 @@ buf_dblwr_process()
 					" the doublewrite buffer.\n",
 					(ulong) space_id, (ulong) page_no);
 
-				if (buf_page_is_corrupted(true,
-							  page, zip_size)) {
+				good_page = buf_dblwr_find_good_copy(
+					recv_dblwr, space_id, page_no,
+					zip_size);
+
+				if (good_page == NULL) {
 					fprintf(stderr,
 						"InnoDB: Dump of the page:\n");
 					buf_page_print(
@@ -566,7 +816,7 @@ buf_dblwr_process()
 				fil_io(OS_FILE_WRITE, true, space_id,
 				       zip_size, page_no, 0,
 				       zip_size ? zip_size : UNIV_PAGE_SIZE,
-				       page, NULL);
+				       good_page, NULL);
 
 				ib_logf(IB_LOG_LEVEL_INFO,
 					"Recovered the page from"
@@ -574,9 +824,11 @@ buf_dblwr_process()
 
 			} else if (buf_page_is_zeroes(read_buf, zip_size)) {
 
-				if (!buf_page_is_zeroes(page, zip_size)
-				    && !buf_page_is_corrupted(true, page,
-							      zip_size)) {
+				byte*	good_page = buf_dblwr_find_good_copy(
+					recv_dblwr, space_id, page_no,
+					zip_size);
+
+				if (good_page != NULL) {
 
 					/* Database page contained only
 					zeroes, while a valid copy is
@@ -586,7 +838,7 @@ buf_dblwr_process()
 					       zip_size, page_no, 0,
 					       zip_size ? zip_size
 							: UNIV_PAGE_SIZE,
-					       page, NULL);
+					       good_page, NULL);
 				}
 			}
 		}
@@ -606,9 +858,25 @@ buf_dblwr_free(void)
 	/* Free the double write data structures. */
 	ut_a(buf_dblwr != NULL);
 	ut_ad(buf_dblwr->s_reserved == 0);
-	ut_ad(buf_dblwr->b_reserved == 0);
 
-	os_event_free(buf_dblwr->b_event);
+	for (ulint i = 0; i < buf_dblwr->n_shards; i++) {
+		buf_dblwr_shard_t*	shard = &buf_dblwr->shards[i];
+
+		ut_ad(shard->b_reserved == 0);
+
+		os_event_free(shard->b_event);
+		ut_free(shard->write_buf_unaligned);
+		mem_free(shard->buf_block_arr);
+		mutex_free(&shard->mutex);
+	}
+
+	if (buf_dblwr->n_shards > 0) {
+		os_file_close(buf_dblwr->shard_file);
+		mem_free(buf_dblwr->shards);
+		buf_dblwr->shards = NULL;
+		buf_dblwr->n_shards = 0;
+	}
+
 	os_event_free(buf_dblwr->s_event);
 	ut_free(buf_dblwr->write_buf_unaligned);
 	buf_dblwr->write_buf_unaligned = NULL;
@@ -640,35 +908,40 @@ buf_dblwr_update(
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
-		mutex_enter(&buf_dblwr->mutex);
+		{
+			buf_dblwr_shard_t*	shard = buf_dblwr_get_shard(
+				buf_pool_from_bpage(bpage), flush_type);
 
-		ut_ad(buf_dblwr->batch_running);
-		ut_ad(buf_dblwr->b_reserved > 0);
-		ut_ad(buf_dblwr->b_reserved <= buf_dblwr->first_free);
+			mutex_enter(&shard->mutex);
 
-		buf_dblwr->b_reserved--;
+			ut_ad(shard->batch_running);
+			ut_ad(shard->b_reserved > 0);
+			ut_ad(shard->b_reserved <= shard->first_free);
 
-		if (buf_dblwr->b_reserved == 0) {
-			mutex_exit(&buf_dblwr->mutex);
-			/* This will finish the batch. Sync data files
-			to the disk. */
-			fil_flush_file_spaces(FIL_TABLESPACE);
-			mutex_enter(&buf_dblwr->mutex);
+			shard->b_reserved--;
 
-			/* We can now reuse the doublewrite memory buffer: */
-			buf_dblwr->first_free = 0;
-			buf_dblwr->batch_running = false;
-			os_event_set(buf_dblwr->b_event);
-		}
+			if (shard->b_reserved == 0) {
+				mutex_exit(&shard->mutex);
+				/* This will finish the batch. Sync data
+				files to the disk. */
+				fil_flush_file_spaces(FIL_TABLESPACE);
+				mutex_enter(&shard->mutex);
 
-		mutex_exit(&buf_dblwr->mutex);
+				/* We can now reuse the shard: */
+				shard->first_free = 0;
+				shard->batch_running = false;
+				os_event_set(shard->b_event);
+			}
+
+			mutex_exit(&shard->mutex);
+		}
 		break;
 	case BUF_FLUSH_SINGLE_PAGE:
 		{
 			const ulint size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
 			ulint i;
 			mutex_enter(&buf_dblwr->mutex);
-			for (i = srv_doublewrite_batch_size; i < size; ++i) {
+			for (i = 0; i < size; ++i) {
 				if (buf_dblwr->buf_block_arr[i] == bpage) {
 					buf_dblwr->s_reserved--;
 					buf_dblwr->buf_block_arr[i] = NULL;
@@ -822,12 +1095,17 @@ and also when we may have to wait for a page latch! Otherwise a deadlock
 of threads can occur. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void)
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose shard to flush */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 {
-	byte*		write_buf;
-	ulint		first_free;
-	ulint		len;
+	buf_dblwr_shard_t*	shard;
+	byte*			write_buf;
+	ulint			first_free;
+	ibool			success;
 
 	if (!srv_use_doublewrite_buf || buf_dblwr == NULL) {
 		/* Sync the writes to the disk. */
@@ -835,53 +1113,52 @@ buf_dblwr_flush_buffered_writes(void)
 		return;
 	}
 
+	shard = buf_dblwr_get_shard(buf_pool, flush_type);
+
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	/* Write first to doublewrite buffer blocks. We use synchronous
-	aio and thus know that file write has been completed when the
+	/* Write first to the doublewrite shard. We use synchronous
+	i/o and thus know that file write has been completed when the
 	control returns. */
 
-	if (buf_dblwr->first_free == 0) {
+	if (shard->first_free == 0) {
 
-		mutex_exit(&buf_dblwr->mutex);
+		mutex_exit(&shard->mutex);
 
 		return;
 	}
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 		/* Another thread is running the batch right now. Wait
 		for it to finish. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		ib_int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	ut_a(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
+	ut_a(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
 
-	/* Disallow anyone else to post to doublewrite buffer or to
-	start another batch of flushing. */
-	buf_dblwr->batch_running = true;
-	first_free = buf_dblwr->first_free;
+	/* Disallow anyone else to post to this shard or to start
+	another batch of flushing from it. */
+	shard->batch_running = true;
+	first_free = shard->first_free;
 
-	/* Now safe to release the mutex. Note that though no other
-	thread is allowed to post to the doublewrite batch flushing
-	but any threads working on single page flushes are allowed
-	to proceed. */
-	mutex_exit(&buf_dblwr->mutex);
+	/* Now safe to release the mutex. */
+	mutex_exit(&shard->mutex);
 
-	write_buf = buf_dblwr->write_buf;
+	write_buf = shard->write_buf;
 
 	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
+	     i < first_free;
 	     len2 += UNIV_PAGE_SIZE, i++) {
 
 		const buf_block_t*	block;
 
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
+		block = (buf_block_t*) shard->buf_block_arr[i];
 
 		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
 		    || block->page.zip.data) {
@@ -899,57 +1176,32 @@ try_again:
 		buf_dblwr_check_page_lsn(write_buf + len2);
 	}
 
-	/* Write out the first block of the doublewrite buffer */
-	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
-		     buf_dblwr->first_free) * UNIV_PAGE_SIZE;
-
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block1, 0, len,
-	       (void*) write_buf, NULL);
-
-	if (buf_dblwr->first_free <= TRX_SYS_DOUBLEWRITE_BLOCK_SIZE) {
-		/* No unwritten pages in the second block. */
-		goto flush;
-	}
-
-	/* Write out the second block of the doublewrite buffer. */
-	len = (buf_dblwr->first_free - TRX_SYS_DOUBLEWRITE_BLOCK_SIZE)
-	       * UNIV_PAGE_SIZE;
-
-	write_buf = buf_dblwr->write_buf
-		    + TRX_SYS_DOUBLEWRITE_BLOCK_SIZE * UNIV_PAGE_SIZE;
+	/* Write out the shard in one go and flush it to disk */
+	success = os_file_write(srv_parallel_doublewrite_path,
+				buf_dblwr->shard_file, write_buf,
+				shard->offset, first_free * UNIV_PAGE_SIZE);
+	ut_a(success);
 
-	fil_io(OS_FILE_WRITE, true, TRX_SYS_SPACE, 0,
-	       buf_dblwr->block2, 0, len,
-	       (void*) write_buf, NULL);
-
-flush:
 	/* increment the doublewrite flushed pages counter */
-	srv_stats.dblwr_pages_written.add(buf_dblwr->first_free);
+	srv_stats.dblwr_pages_written.add(first_free);
 	srv_stats.dblwr_writes.inc();
 
-	/* Now flush the doublewrite buffer data to disk */
-	fil_flush(TRX_SYS_SPACE);
+	success = os_file_flush(buf_dblwr->shard_file);
+	ut_a(success);
 
 	/* We know that the writes have been flushed to disk now
-	and in recovery we will find them in the doublewrite buffer
-	blocks. Next do the writes to the intended positions. */
-
-	/* Up to this point first_free and buf_dblwr->first_free are
-	same because we have set the buf_dblwr->batch_running flag
-	disallowing any other thread to post any request but we
-	can't safely access buf_dblwr->first_free in the loop below.
-	This is so because it is possible that after we are done with
-	the last iteration and before we terminate the loop, the batch
-	gets finished in the IO helper thread and another thread posts
-	a new batch setting buf_dblwr->first_free to a higher value.
-	If this happens and we are using buf_dblwr->first_free in the
-	loop termination condition then we'll end up dispatching
-	the same block twice from two different threads. */
-	ut_ad(first_free == buf_dblwr->first_free);
+	and in recovery we will find them in the doublewrite shard.
+	Next do the writes to the intended positions.
+
+	We can't safely access shard->first_free in the loop below:
+	after the last iteration and before the loop terminates the
+	batch may get finished in the IO helper thread and another
+	thread may post a new batch setting shard->first_free to a
+	higher value. We would then dispatch the same block twice. */
+	ut_ad(first_free == shard->first_free);
 	for (ulint i = 0; i < first_free; i++) {
 		buf_dblwr_write_block_to_datafile(
-			buf_dblwr->buf_block_arr[i], false);
+			shard->buf_block_arr[i], false);
 	}
 
 	/* Wake possible simulated aio thread to actually post the
@@ -960,44 +1212,47 @@ flush:
 }
 
 /********************************************************************//**
-Posts a buffer page for writing. If the doublewrite memory buffer is
-full, calls buf_dblwr_flush_buffered_writes and waits for for free
-space to appear. */
+Posts a buffer page for writing to the doublewrite shard of its buffer
+pool instance and flush type. If the shard is full, calls
+buf_dblwr_flush_buffered_writes and waits for free space to appear. */
 UNIV_INTERN
 void
 buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
+	ulint			zip_size;
+	buf_pool_t*		buf_pool = buf_pool_from_bpage(bpage);
+	buf_flush_t		flush_type = buf_page_get_flush_type(bpage);
+	buf_dblwr_shard_t*	shard;
 
 	ut_a(buf_page_in_file(bpage));
-	ut_ad(!mutex_own(&buf_pool_from_bpage(bpage)->LRU_list_mutex));
+	ut_ad(!mutex_own(&buf_pool->LRU_list_mutex));
+
+	shard = buf_dblwr_get_shard(buf_pool, flush_type);
 
 try_again:
-	mutex_enter(&buf_dblwr->mutex);
+	mutex_enter(&shard->mutex);
 
-	ut_a(buf_dblwr->first_free <= srv_doublewrite_batch_size);
+	ut_a(shard->first_free <= srv_doublewrite_batch_size);
 
-	if (buf_dblwr->batch_running) {
+	if (shard->batch_running) {
 
-		/* This not nearly as bad as it looks. There is only
-		page_cleaner thread which does background flushing
-		in batches therefore it is unlikely to be a contention
-		point. The only exception is when a user thread is
-		forced to do a flush batch because of a sync
-		checkpoint. */
-		ib_int64_t	sig_count = os_event_reset(buf_dblwr->b_event);
-		mutex_exit(&buf_dblwr->mutex);
+		/* Only one batch of a given flush type can run in a
+		buffer pool instance at a time, so this mostly happens
+		when a user thread is forced to do a flush batch
+		because of a sync checkpoint. */
+		ib_int64_t	sig_count = os_event_reset(shard->b_event);
+		mutex_exit(&shard->mutex);
 
-		os_event_wait_low(buf_dblwr->b_event, sig_count);
+		os_event_wait_low(shard->b_event, sig_count);
 		goto try_again;
 	}
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		goto try_again;
 	}
@@ -1007,40 +1262,40 @@ try_again:
 	if (zip_size) {
 		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
 		/* Copy the compressed page and clear the rest. */
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free,
 		       bpage->zip.data, zip_size);
-		memset(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free
+		memset(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free
 		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
 	} else {
 		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
 		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
 				   UNIV_PAGE_SIZE);
 
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
+		memcpy(shard->write_buf
+		       + UNIV_PAGE_SIZE * shard->first_free,
 		       ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
 	}
 
-	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
+	shard->buf_block_arr[shard->first_free] = bpage;
 
-	buf_dblwr->first_free++;
-	buf_dblwr->b_reserved++;
+	shard->first_free++;
+	shard->b_reserved++;
 
-	ut_ad(!buf_dblwr->batch_running);
-	ut_ad(buf_dblwr->first_free == buf_dblwr->b_reserved);
-	ut_ad(buf_dblwr->b_reserved <= srv_doublewrite_batch_size);
+	ut_ad(!shard->batch_running);
+	ut_ad(shard->first_free == shard->b_reserved);
+	ut_ad(shard->b_reserved <= srv_doublewrite_batch_size);
 
-	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
-		mutex_exit(&(buf_dblwr->mutex));
+	if (shard->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&shard->mutex);
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		return;
 	}
 
-	mutex_exit(&(buf_dblwr->mutex));
+	mutex_exit(&shard->mutex);
 }
 
 /********************************************************************//**
@@ -1068,12 +1323,11 @@ buf_dblwr_write_single_page(
 	ut_a(srv_use_doublewrite_buf);
 	ut_a(buf_dblwr != NULL);
 
-	/* total number of slots available for single page flushes
-	starts from srv_doublewrite_batch_size to the end of the
-	buffer. */
+	/* Batch flushes go to the doublewrite shards, so all the
+	slots of the doublewrite buffer are available for single
+	page flushes. */
 	size = 2 * TRX_SYS_DOUBLEWRITE_BLOCK_SIZE;
-	ut_a(size > srv_doublewrite_batch_size);
-	n_slots = size - srv_doublewrite_batch_size;
+	n_slots = size;
 
 	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
 
@@ -1102,7 +1356,7 @@ retry:
 		goto retry;
 	}
 
-	for (i = srv_doublewrite_batch_size; i < size; ++i) {
+	for (i = 0; i < size; ++i) {
 
 		if (!buf_dblwr->in_use[i]) {
 			break;
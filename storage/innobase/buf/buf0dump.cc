@@ -68,6 +68,27 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
 #define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
 
+/* A buffer pool dump entry: a page and the number of times it had been
+accessed in the buffer pool when the dump was taken. The dump file keeps
+its "space,page" lines, so that older versions can still load it. The
+access counts go to a separate file, see BUF_DUMP_COUNT_SUFFIX; pages
+without a count load with a zero count. */
+struct buf_dump_entry_t {
+	buf_dump_t	page;		/*!< space id and page number */
+	ulint		n_access;	/*!< buf_page_t::access_count */
+};
+
+/* Suffix of the file that stores the access counts next to the dump file,
+as "space,page,count" lines in the order of the dump file. */
+#define BUF_DUMP_COUNT_SUFFIX	".count"
+
+/* Number of pages that buf_load() sorts on space_no, page_no and issues
+reads for in one go. The dump is loaded in batches in the order of
+decreasing access count, so a smaller batch gets the hottest pages in
+sooner, while a larger one gives more adjacent pages to merge into
+multi-page reads. */
+#define BUF_LOAD_BATCH_SIZE	8192
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -186,6 +207,41 @@ get_buf_dump_dir()
 	return(dump_dir);
 }
 
+/*****************************************************************//**
+Replace a file with a completely written temporary file. If any errors
+occur then the value of innodb_buffer_pool_dump_status will be set
+accordingly and the temporary file is left to exist.
+@return true on success */
+static
+bool
+buf_dump_replace_file(
+/*==================*/
+	const char*	tmp_filename,	/*!< in: file that was written */
+	const char*	full_filename)	/*!< in: file to replace */
+{
+	int	ret;
+
+	ret = unlink(full_filename);
+	if (ret != 0 && errno != ENOENT) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot delete '%s': %s",
+				full_filename, strerror(errno));
+		return(false);
+	}
+	/* else */
+
+	ret = rename(tmp_filename, full_filename);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot rename '%s' to '%s': %s",
+				tmp_filename, full_filename,
+				strerror(errno));
+		return(false);
+	}
+
+	return(true);
+}
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -203,8 +259,11 @@ buf_dump(
 
 	char	full_filename[OS_FILE_MAX_PATH];
 	char	tmp_filename[OS_FILE_MAX_PATH];
+	char	count_filename[OS_FILE_MAX_PATH];
+	char	tmp_count_filename[OS_FILE_MAX_PATH];
 	char	now[32];
 	FILE*	f;
+	FILE*	fc;
 	ulint	i;
 	int	ret;
 
@@ -215,6 +274,12 @@ buf_dump(
 	ut_snprintf(tmp_filename, sizeof(tmp_filename),
 		    "%s.incomplete", full_filename);
 
+	ut_snprintf(count_filename, sizeof(count_filename),
+		    "%s" BUF_DUMP_COUNT_SUFFIX, full_filename);
+
+	ut_snprintf(tmp_count_filename, sizeof(tmp_count_filename),
+		    "%s.incomplete", count_filename);
+
 	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
 			full_filename);
 
@@ -227,11 +292,21 @@ buf_dump(
 	}
 	/* else */
 
+	fc = fopen(tmp_count_filename, "w");
+	if (fc == NULL) {
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot open '%s' for writing: %s",
+				tmp_count_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
 	/* walk through each buffer pool */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
 		const buf_page_t*	bpage;
-		buf_dump_t*		dump;
+		buf_dump_entry_t*	dump;
 		ulint			n_pages;
 		ulint			j;
 
@@ -249,12 +324,13 @@ buf_dump(
 			continue;
 		}
 
-		dump = static_cast<buf_dump_t*>(
+		dump = static_cast<buf_dump_entry_t*>(
 			ut_malloc(n_pages * sizeof(*dump))) ;
 
 		if (dump == NULL) {
 			mutex_exit(&buf_pool->LRU_list_mutex);
 			fclose(f);
+			fclose(fc);
 			buf_dump_status(STATUS_ERR,
 					"Cannot allocate " ULINTPF " bytes: %s",
 					(ulint) (n_pages * sizeof(*dump)),
@@ -269,8 +345,11 @@ buf_dump(
 
 			ut_a(buf_page_in_file(bpage));
 
-			dump[j] = BUF_DUMP_CREATE(buf_page_get_space(bpage),
-						  buf_page_get_page_no(bpage));
+			dump[j].page = BUF_DUMP_CREATE(
+				buf_page_get_space(bpage),
+				buf_page_get_page_no(bpage));
+			/* A heuristic read without the block mutex */
+			dump[j].n_access = bpage->access_count;
 		}
 
 		ut_a(j == n_pages);
@@ -278,15 +357,27 @@ buf_dump(
 		mutex_exit(&buf_pool->LRU_list_mutex);
 
 		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
-			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
-				      BUF_DUMP_SPACE(dump[j]),
-				      BUF_DUMP_PAGE(dump[j]));
-			if (ret < 0) {
+			const char*	failed = NULL;
+
+			if (fprintf(f, ULINTPF "," ULINTPF "\n",
+				    BUF_DUMP_SPACE(dump[j].page),
+				    BUF_DUMP_PAGE(dump[j].page)) < 0) {
+				failed = tmp_filename;
+			} else if (fprintf(fc, ULINTPF "," ULINTPF ","
+					   ULINTPF "\n",
+					   BUF_DUMP_SPACE(dump[j].page),
+					   BUF_DUMP_PAGE(dump[j].page),
+					   dump[j].n_access) < 0) {
+				failed = tmp_count_filename;
+			}
+
+			if (failed != NULL) {
 				ut_free(dump);
 				fclose(f);
+				fclose(fc);
 				buf_dump_status(STATUS_ERR,
 						"Cannot write to '%s': %s",
-						tmp_filename, strerror(errno));
+						failed, strerror(errno));
 				/* leave tmp_filename to exist */
 				return;
 			}
@@ -305,32 +396,29 @@ buf_dump(
 		ut_free(dump);
 	}
 
-	ret = fclose(f);
+	ret = fclose(fc);
 	if (ret != 0) {
+		fclose(f);
 		buf_dump_status(STATUS_ERR,
 				"Cannot close '%s': %s",
-				tmp_filename, strerror(errno));
+				tmp_count_filename, strerror(errno));
 		return;
 	}
 	/* else */
 
-	ret = unlink(full_filename);
-	if (ret != 0 && errno != ENOENT) {
+	ret = fclose(f);
+	if (ret != 0) {
 		buf_dump_status(STATUS_ERR,
-				"Cannot delete '%s': %s",
-				full_filename, strerror(errno));
-		/* leave tmp_filename to exist */
+				"Cannot close '%s': %s",
+				tmp_filename, strerror(errno));
 		return;
 	}
 	/* else */
 
-	ret = rename(tmp_filename, full_filename);
-	if (ret != 0) {
-		buf_dump_status(STATUS_ERR,
-				"Cannot rename '%s' to '%s': %s",
-				tmp_filename, full_filename,
-				strerror(errno));
-		/* leave tmp_filename to exist */
+	/* The counts are replaced first: a load that finds a count file
+	of another dump ignores it, see buf_load_read_counts(). */
+	if (!buf_dump_replace_file(tmp_count_filename, count_filename)
+	    || !buf_dump_replace_file(tmp_filename, full_filename)) {
 		return;
 	}
 	/* else */
@@ -344,39 +432,133 @@ buf_dump(
 }
 
 /*****************************************************************//**
-Compare two buffer pool dump entries, used to sort the dump on
-space_no,page_no before loading in order to increase the chance for
-sequential IO.
+Compare two buffer pool dump entries on space_no, page_no, used to sort
+a batch of the dump before loading it in order to increase the chance
+for sequential IO.
 @return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
 static
 lint
-buf_dump_cmp(
-/*=========*/
-	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
-	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
+buf_load_cmp_page(
+/*==============*/
+	const buf_dump_entry_t&	d1,	/*!< in: buffer pool dump entry 1 */
+	const buf_dump_entry_t&	d2)	/*!< in: buffer pool dump entry 2 */
 {
-	if (d1 < d2) {
+	if (d1.page < d2.page) {
 		return(-1);
-	} else if (d1 == d2) {
+	} else if (d1.page == d2.page) {
 		return(0);
 	} else {
 		return(1);
 	}
 }
 
+/*****************************************************************//**
+Compare two buffer pool dump entries on the access count, most accessed
+first, and then on space_no, page_no. Used to decide the order in which
+the pages are loaded.
+@return -1/0/1 if entry 1 is to be loaded before/together with/after
+entry 2 */
+static
+lint
+buf_load_cmp_priority(
+/*==================*/
+	const buf_dump_entry_t&	d1,	/*!< in: buffer pool dump entry 1 */
+	const buf_dump_entry_t&	d2)	/*!< in: buffer pool dump entry 2 */
+{
+	if (d1.n_access > d2.n_access) {
+		return(-1);
+	} else if (d1.n_access < d2.n_access) {
+		return(1);
+	}
+
+	return(buf_load_cmp_page(d1, d2));
+}
+
 /*****************************************************************//**
 Sort a buffer pool dump on space_no, page_no. */
 static
 void
-buf_dump_sort(
-/*==========*/
-	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
-	buf_dump_t*	tmp,	/*!< in/out: temp storage */
-	ulint		low,	/*!< in: lowest index (inclusive) */
-	ulint		high)	/*!< in: highest index (non-inclusive) */
+buf_load_sort_page(
+/*===============*/
+	buf_dump_entry_t*	dump,	/*!< in/out: buffer pool dump
+					to sort */
+	buf_dump_entry_t*	tmp,	/*!< in/out: temp storage */
+	ulint			low,	/*!< in: lowest index (inclusive) */
+	ulint			high)	/*!< in: highest index
+					(non-inclusive) */
+{
+	UT_SORT_FUNCTION_BODY(buf_load_sort_page, dump, tmp, low, high,
+			      buf_load_cmp_page);
+}
+
+/*****************************************************************//**
+Sort a buffer pool dump in the order of loading, see
+buf_load_cmp_priority(). */
+static
+void
+buf_load_sort_priority(
+/*===================*/
+	buf_dump_entry_t*	dump,	/*!< in/out: buffer pool dump
+					to sort */
+	buf_dump_entry_t*	tmp,	/*!< in/out: temp storage */
+	ulint			low,	/*!< in: lowest index (inclusive) */
+	ulint			high)	/*!< in: highest index
+					(non-inclusive) */
+{
+	UT_SORT_FUNCTION_BODY(buf_load_sort_priority, dump, tmp, low, high,
+			      buf_load_cmp_priority);
+}
+
+/*****************************************************************//**
+Read the access counts of a buffer pool dump from the file that
+buf_dump() writes next to it. The counts are only used if the file
+lists the same pages in the same order as the dump; otherwise, and if
+there is no count file, all the counts are left at zero. */
+static
+void
+buf_load_read_counts(
+/*=================*/
+	buf_dump_entry_t*	dump,		/*!< in/out: buffer pool dump */
+	ulint			dump_n,		/*!< in: number of entries */
+	const char*		count_filename)	/*!< in: count file */
 {
-	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
-			      buf_dump_cmp);
+	FILE*	f;
+	ulint	i;
+	ulint	space_id;
+	ulint	page_no;
+	ulint	n_access;
+
+	f = fopen(count_filename, "r");
+	if (f == NULL) {
+		/* A dump written by an older version */
+		return;
+	}
+
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+		if (fscanf(f, ULINTPF "," ULINTPF "," ULINTPF,
+			   &space_id, &page_no, &n_access) != 3
+		    || space_id > ULINT32_MASK || page_no > ULINT32_MASK
+		    || BUF_DUMP_CREATE(space_id, page_no) != dump[i].page) {
+			break;
+		}
+
+		dump[i].n_access = n_access;
+	}
+
+	fclose(f);
+
+	if (i < dump_n) {
+		for (i = 0; i < dump_n; i++) {
+			dump[i].n_access = 0;
+		}
+
+		if (!SHUTTING_DOWN()) {
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"'%s' does not match the buffer pool dump, "
+				"loading the pages without their access "
+				"counts", count_filename);
+		}
+	}
 }
 
 /*****************************************************************//**
@@ -390,17 +572,19 @@ void
 buf_load()
 /*======*/
 {
-	char		full_filename[OS_FILE_MAX_PATH];
-	char		now[32];
-	FILE*		f;
-	buf_dump_t*	dump;
-	buf_dump_t*	dump_tmp;
-	ulint		dump_n;
-	ulint		total_buffer_pools_pages;
-	ulint		i;
-	ulint		space_id;
-	ulint		page_no;
-	int		fscanf_ret;
+	char			full_filename[OS_FILE_MAX_PATH];
+	char			count_filename[OS_FILE_MAX_PATH];
+	char			now[32];
+	FILE*			f;
+	buf_dump_entry_t*	dump;
+	buf_dump_entry_t*	dump_tmp;
+	ulint			dump_n;
+	ulint			total_buffer_pools_pages;
+	ulint			i;
+	ulint			j;
+	ulint			space_id;
+	ulint			page_no;
+	int			fscanf_ret;
 
 	/* Ignore any leftovers from before */
 	buf_load_abort_flag = FALSE;
@@ -409,6 +593,9 @@ buf_load()
 		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
 		    srv_buf_dump_filename);
 
+	ut_snprintf(count_filename, sizeof(count_filename),
+		    "%s" BUF_DUMP_COUNT_SUFFIX, full_filename);
+
 	buf_load_status(STATUS_NOTICE,
 			"Loading buffer pool(s) from %s", full_filename);
 
@@ -445,16 +632,11 @@ buf_load()
 		return;
 	}
 
-	/* If dump is larger than the buffer pool(s), then we ignore the
-	extra trailing. This could happen if a dump is made, then buffer
-	pool is shrunk and then load it attempted. */
-	total_buffer_pools_pages = buf_pool_get_n_pages()
-		* srv_buf_pool_instances;
-	if (dump_n > total_buffer_pools_pages) {
-		dump_n = total_buffer_pools_pages;
-	}
-
-	dump = static_cast<buf_dump_t*>(ut_malloc(dump_n * sizeof(*dump)));
+	/* The whole dump is read in, even if it is larger than the
+	buffer pool(s), so that the most accessed pages are the ones
+	that get loaded. */
+	dump = static_cast<buf_dump_entry_t*>(
+		ut_malloc(dump_n * sizeof(*dump)));
 
 	if (dump == NULL) {
 		fclose(f);
@@ -465,7 +647,7 @@ buf_load()
 		return;
 	}
 
-	dump_tmp = static_cast<buf_dump_t*>(
+	dump_tmp = static_cast<buf_dump_entry_t*>(
 		ut_malloc(dump_n * sizeof(*dump_tmp)));
 
 	if (dump_tmp == NULL) {
@@ -481,6 +663,7 @@ buf_load()
 	rewind(f);
 
 	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+
 		fscanf_ret = fscanf(f, ULINTPF "," ULINTPF,
 				    &space_id, &page_no);
 
@@ -515,7 +698,8 @@ buf_load()
 			return;
 		}
 
-		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
+		dump[i].page = BUF_DUMP_CREATE(space_id, page_no);
+		dump[i].n_access = 0;
 	}
 
 	/* Set dump_n to the actual number of initialized elements,
@@ -527,6 +711,7 @@ buf_load()
 
 	if (dump_n == 0) {
 		ut_free(dump);
+		ut_free(dump_tmp);
 		ut_sprintf_timestamp(now);
 		buf_load_status(STATUS_NOTICE,
 				"Buffer pool(s) load completed at %s "
@@ -535,29 +720,60 @@ buf_load()
 	}
 
 	if (!SHUTTING_DOWN()) {
-		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+		buf_load_read_counts(dump, dump_n, count_filename);
 	}
 
-	ut_free(dump_tmp);
+	if (!SHUTTING_DOWN()) {
+		buf_load_sort_priority(dump, dump_tmp, 0, dump_n);
+	}
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	/* If dump is larger than the buffer pool(s), then we ignore the
+	least accessed pages. This could happen if a dump is made, then
+	buffer pool is shrunk and then load it attempted. */
+	total_buffer_pools_pages = buf_pool_get_n_pages()
+		* srv_buf_pool_instances;
+	if (dump_n > total_buffer_pools_pages) {
+		dump_n = total_buffer_pools_pages;
+	}
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
+	/* Load the pages in batches, most accessed first. Within a batch
+	the reads are issued on space_no, page_no order and buffered, then
+	submitted together: adjacent pages end up in the same aio segment
+	and get merged into larger reads, while the segments are served by
+	the i/o handler threads in parallel. */
+	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i = j) {
+		ulint	batch_end = ut_min(i + BUF_LOAD_BATCH_SIZE, dump_n);
 
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
-		}
+		buf_load_sort_page(dump, dump_tmp, i, batch_end);
+
+		for (j = i; j < batch_end; j++) {
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
+			buf_read_page_async(BUF_DUMP_SPACE(dump[j].page),
+					    BUF_DUMP_PAGE(dump[j].page),
+					    true);
+
+			if (j % 64 == 63) {
+				os_aio_simulated_wake_handler_threads();
+			}
+
+			if (j % 128 == 0) {
+				buf_load_status(STATUS_INFO,
+						"Loaded " ULINTPF "/" ULINTPF
+						" pages", j + 1, dump_n);
+			}
+
+			if (buf_load_abort_flag || SHUTTING_DOWN()) {
+				break;
+			}
 		}
 
+		os_aio_dispatch_read_array_submit();
+		os_aio_simulated_wake_handler_threads();
+
 		if (buf_load_abort_flag) {
 			buf_load_abort_flag = FALSE;
 			ut_free(dump);
+			ut_free(dump_tmp);
 			buf_load_status(
 				STATUS_NOTICE,
 				"Buffer pool(s) load aborted on request");
@@ -566,6 +782,7 @@ buf_load()
 	}
 
 	ut_free(dump);
+	ut_free(dump_tmp);
 
 	ut_sprintf_timestamp(now);
 
@@ -59,9 +59,12 @@ need to protect it by a mutex. It is only ever read by the thread
 doing the shutdown */
 UNIV_INTERN ibool buf_page_cleaner_is_active = FALSE;
 
-/** Flag indicating if the lru_manager is in active state. */
+/** Flag indicating if any of the lru_manager threads is in active state. */
 UNIV_INTERN bool buf_lru_manager_is_active = false;
 
+/** Number of lru_manager threads which are in active state. */
+static ulint buf_lru_manager_running_threads = 0;
+
 #ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
 UNIV_INTERN mysql_pfs_key_t buf_lru_manager_thread_key;
@@ -1079,7 +1082,8 @@ buf_flush_page(
 			/* avoiding deadlock possibility involves doublewrite
 			buffer, should flush it, because it might hold the
 			another block->lock. */
-			buf_dblwr_flush_buffered_writes();
+			buf_dblwr_flush_buffered_writes(buf_pool,
+							BUF_FLUSH_LIST);
 
 			rw_lock_s_lock_gen(rw_lock, BUF_IO_WRITE);
                 }
@@ -1827,10 +1831,6 @@ buf_flush_common(
 	buf_flush_t	flush_type,	/*!< in: type of flush */
 	ulint		page_count)	/*!< in: number of pages flushed */
 {
-	if (page_count) {
-		buf_dblwr_flush_buffered_writes();
-	}
-
 	ut_a(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
 #ifdef UNIV_DEBUG
@@ -1881,9 +1881,17 @@ void
 buf_flush_end(
 /*==========*/
 	buf_pool_t*	buf_pool,	/*!< buffer pool instance */
-	buf_flush_t	flush_type)	/*!< in: BUF_FLUSH_LRU
+	buf_flush_t	flush_type,	/*!< in: BUF_FLUSH_LRU
 					or BUF_FLUSH_LIST */
+	ulint		page_count)	/*!< in: number of pages flushed */
 {
+	if (page_count) {
+		/* Write out the doublewrite shard of this instance and
+		flush type while no other batch of the same type can
+		start posting to it. */
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
+	}
+
 	mutex_enter(&buf_pool->flush_state_mutex);
 
 	buf_pool->init_flush[flush_type] = FALSE;
@@ -1962,7 +1970,7 @@ buf_flush_LRU(
 
 	buf_flush_batch(buf_pool, BUF_FLUSH_LRU, min_n, 0, limited_scan, n);
 
-	buf_flush_end(buf_pool, BUF_FLUSH_LRU);
+	buf_flush_end(buf_pool, BUF_FLUSH_LRU, n->flushed);
 
 	buf_flush_common(BUF_FLUSH_LRU, n->flushed);
 
@@ -1971,63 +1979,63 @@ buf_flush_LRU(
 
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
-all buffer pool instances.
+a subset of buffer pool instances: first_instance, first_instance + step,
+first_instance + 2 * step, ...
 NOTE: The calling thread is not allowed to own any latches on pages!
 @return true if a batch was queued successfully for each buffer pool
-instance. false if another batch of same type was already running in
-at least one of the buffer pool instance */
-UNIV_INTERN
+instance of the subset. false if another batch of same type was already
+running in at least one of the buffer pool instances */
+static
 bool
-buf_flush_list(
-/*===========*/
+buf_flush_list_instances(
+/*=====================*/
 	ulint		min_n,		/*!< in: wished minimum mumber of blocks
-					flushed (it is not guaranteed that the
-					actual number is that big, though) */
+					flushed per buffer pool instance, or
+					ULINT_MAX for no limit */
 	lsn_t		lsn_limit,	/*!< in the case BUF_FLUSH_LIST all
 					blocks whose oldest_modification is
 					smaller than this should be flushed
 					(if their number does not exceed
 					min_n), otherwise ignored */
+	ulint		first_instance,	/*!< in: first buffer pool instance
+					to flush */
+	ulint		step,		/*!< in: distance between the buffer
+					pool instances to flush */
 	ulint*		n_processed)	/*!< out: the number of pages
 					which were processed is passed
 					back to caller. Ignored if NULL */
-
 {
 	ulint		i;
 
 	ulint		requested_pages[MAX_BUFFER_POOLS];
 	bool		active_instance[MAX_BUFFER_POOLS];
-	ulint		remaining_instances = srv_buf_pool_instances;
+	ulint		remaining_instances = 0;
 	bool		timeout = false;
 	ulint		flush_start_time = 0;
 
-	for (i = 0; i < srv_buf_pool_instances; i++) {
+	ut_ad(step > 0);
+
+	for (i = first_instance; i < srv_buf_pool_instances; i += step) {
 		requested_pages[i] = 0;
 		active_instance[i] = true;
+		remaining_instances++;
 	}
 
 	if (n_processed) {
 		*n_processed = 0;
 	}
 
-	if (min_n != ULINT_MAX) {
-		/* Ensure that flushing is spread evenly amongst the
-		buffer pool instances. When min_n is ULINT_MAX
-		we need to flush everything up to the lsn limit
-		so no limit here. */
-		min_n = (min_n + srv_buf_pool_instances - 1)
-			 / srv_buf_pool_instances;
-		if (lsn_limit != LSN_MAX) {
-			flush_start_time = ut_time_ms();
-		}
+	if (min_n != ULINT_MAX && lsn_limit != LSN_MAX) {
+		flush_start_time = ut_time_ms();
 	}
 
-	/* Flush to lsn_limit in all buffer pool instances */
+	/* Flush to lsn_limit in all buffer pool instances of the subset */
 	while (remaining_instances && !timeout) {
 
 		ulint flush_common_batch = 0;
 
-		for (i = 0; i < srv_buf_pool_instances; i++) {
+		for (i = first_instance; i < srv_buf_pool_instances;
+		     i += step) {
 
 			if (flush_start_time
 			    && (ut_time_ms() - flush_start_time
@@ -2059,7 +2067,8 @@ buf_flush_list(
 						chunk_size, lsn_limit, false,
 						&n);
 
-				buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+				buf_flush_end(buf_pool, BUF_FLUSH_LIST,
+					      n.flushed);
 
 				flush_common_batch += n.flushed;
 
@@ -2091,13 +2100,55 @@ buf_flush_list(
 
 	/* If we haven't flushed all the instances due to timeout or a repeat
 	failure to start a flush, return failure */
-	for (i = 0; i < srv_buf_pool_instances; i++) {
-		if (active_instance[i]) {
-			return(false);
-		}
+	return(remaining_instances == 0);
+}
+
+/*******************************************************************//**
+Returns the number of pages to flush from each buffer pool instance so that
+flushing min_n pages in total is spread evenly amongst the instances.
+@return per instance page count, ULINT_MAX if min_n is ULINT_MAX */
+static
+ulint
+buf_flush_list_per_instance(
+/*========================*/
+	ulint	min_n)	/*!< in: wished minimum number of blocks flushed
+			in total */
+{
+	if (min_n == ULINT_MAX) {
+		/* We need to flush everything up to the lsn limit so
+		no limit here. */
+		return(ULINT_MAX);
 	}
 
-	return(true);
+	return((min_n + srv_buf_pool_instances - 1) / srv_buf_pool_instances);
+}
+
+/*******************************************************************//**
+This utility flushes dirty blocks from the end of the flush list of
+all buffer pool instances.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return true if a batch was queued successfully for each buffer pool
+instance. false if another batch of same type was already running in
+at least one of the buffer pool instance */
+UNIV_INTERN
+bool
+buf_flush_list(
+/*===========*/
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	lsn_t		lsn_limit,	/*!< in the case BUF_FLUSH_LIST all
+					blocks whose oldest_modification is
+					smaller than this should be flushed
+					(if their number does not exceed
+					min_n), otherwise ignored */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed is passed
+					back to caller. Ignored if NULL */
+
+{
+	return(buf_flush_list_instances(buf_flush_list_per_instance(min_n),
+					lsn_limit, 0, 1, n_processed));
 }
 
 /******************************************************************//**
@@ -2205,16 +2256,20 @@ buf_flush_single_page_from_LRU(
 }
 
 /*********************************************************************//**
-Clears up tail of the LRU lists:
+Clears up tail of the LRU lists of a subset of buffer pool instances:
+first_instance, first_instance + step, first_instance + 2 * step, ...
 * Put replaceable pages at the tail of LRU to the free list
 * Flush dirty pages at the tail of LRU to the disk
 The depth to which we scan each buffer pool is controlled by dynamic
 config parameter innodb_LRU_scan_depth.
 @return number of flushed and evicted pages */
-UNIV_INTERN
+static
 ulint
-buf_flush_LRU_tail(void)
-/*====================*/
+buf_flush_LRU_tail_instances(
+/*=========================*/
+	ulint	first_instance,	/*!< in: first buffer pool instance */
+	ulint	step)		/*!< in: distance between the buffer pool
+				instances to clean */
 {
 	ulint	total_flushed = 0;
 	ulint	total_evicted = 0;
@@ -2224,12 +2279,14 @@ buf_flush_LRU_tail(void)
 	bool	active_instance[MAX_BUFFER_POOLS];
 	bool	limited_scan[MAX_BUFFER_POOLS];
 	ulint	previous_evicted[MAX_BUFFER_POOLS];
-	ulint	remaining_instances = srv_buf_pool_instances;
+	ulint	remaining_instances = 0;
 	ulint	lru_chunk_size = srv_cleaner_lru_chunk_size;
 	ulint	free_list_lwm = srv_LRU_scan_depth / 100
 		* srv_cleaner_free_list_lwm;
 
-	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+	ut_ad(step > 0);
+
+	for (ulint i = first_instance; i < srv_buf_pool_instances; i += step) {
 
 		const buf_pool_t* buf_pool = buf_pool_from_array(i);
 
@@ -2239,6 +2296,7 @@ buf_flush_LRU_tail(void)
 		active_instance[i] = true;
 		limited_scan[i] = true;
 		previous_evicted[i] = 0;
+		remaining_instances++;
 	}
 
 	while (remaining_instances) {
@@ -2248,7 +2306,8 @@ buf_flush_LRU_tail(void)
 			break;
 		}
 
-		for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		for (ulint i = first_instance; i < srv_buf_pool_instances;
+		     i += step) {
 
 			if (!active_instance[i]) {
 				continue;
@@ -2316,9 +2375,27 @@ buf_flush_LRU_tail(void)
 			MONITOR_LRU_BATCH_PAGES,
 			total_flushed);
 	}
+
+	MONITOR_INC_VALUE(MONITOR_LRU_WORKER_TIME, ut_time_ms() - start_time);
+
 	return(total_flushed + total_evicted);
 }
 
+/*********************************************************************//**
+Clears up tail of the LRU lists of all buffer pool instances:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan each buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth.
+@return number of flushed and evicted pages */
+UNIV_INTERN
+ulint
+buf_flush_LRU_tail(void)
+/*====================*/
+{
+	return(buf_flush_LRU_tail_instances(0, 1));
+}
+
 /*********************************************************************//**
 Wait for any possible LRU flushes that are in progress to end. */
 UNIV_INTERN
@@ -2344,8 +2421,135 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
+/** Page cleaner worker slot.  The worker of slot i owns the buffer pool
+instances i, i + srv_n_page_cleaners, i + 2 * srv_n_page_cleaners, ... and
+flushes their flush lists on the coordinator request.  Slot 0 belongs to the
+coordinator, which does its own share of the work. */
+struct page_cleaner_slot_t {
+	os_event_t	event;		/*!< set by the coordinator when a
+					flush list request is posted */
+	ulint		n_flushed;	/*!< out: number of pages flushed
+					for the last request */
+	bool		success;	/*!< out: false if a batch could not
+					be started for some instance */
+	ulint		flush_time;	/*!< out: time in ms spent on the last
+					request */
+};
+
+/** Page cleaner coordinator state */
+struct page_cleaner_t {
+	os_event_t		is_finished;	/*!< set when all the slots
+						have finished the last
+						request */
+	ulint			n_slots;	/*!< number of slots, equal to
+						srv_n_page_cleaners */
+	volatile ulint		n_slots_finished;/*!< number of slots which
+						have finished the last
+						request */
+	volatile ulint		n_workers;	/*!< number of worker
+						threads which have not
+						exited yet */
+	volatile bool		is_running;	/*!< false if the workers
+						must exit */
+	ulint			min_n;		/*!< request: pages to flush
+						per instance */
+	lsn_t			lsn_limit;	/*!< request: LSN limit */
+	page_cleaner_slot_t	slots[SRV_MAX_N_PAGE_CLEANERS];
+};
+
+/** The page cleaner coordinator state, NULL if the page cleaner has not been
+initialized. */
+static page_cleaner_t*	page_cleaner = NULL;
+
+/******************************************************************//**
+Initialize the page cleaner coordinator state.  Must be called before the
+page cleaner coordinator and worker threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_ad(page_cleaner == NULL);
+	ut_ad(srv_n_page_cleaners >= 1);
+	ut_ad(srv_n_page_cleaners <= srv_buf_pool_instances);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	page_cleaner->is_finished = os_event_create();
+	page_cleaner->n_slots = srv_n_page_cleaners;
+	page_cleaner->n_workers = srv_n_page_cleaners - 1;
+	page_cleaner->is_running = true;
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		page_cleaner->slots[i].event = os_event_create();
+	}
+}
+
+/******************************************************************//**
+Stop the page cleaner worker threads, wait for them to exit and free the
+page cleaner coordinator state.  Called by the coordinator thread. */
+static
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	ut_ad(page_cleaner != NULL);
+
+	page_cleaner->is_running = false;
+	os_wmb;
+
+	for (ulint i = 1; i < page_cleaner->n_slots; i++) {
+		os_event_set(page_cleaner->slots[i].event);
+	}
+
+	os_rmb;
+	while (page_cleaner->n_workers > 0) {
+		os_thread_sleep(10000);
+		os_rmb;
+	}
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+		os_event_free(page_cleaner->slots[i].event);
+	}
+
+	os_event_free(page_cleaner->is_finished);
+
+	mem_free(page_cleaner);
+	page_cleaner = NULL;
+}
+
+/******************************************************************//**
+Do the flush list flushing part of the currently posted coordinator request
+for the buffer pool instances owned by a page cleaner slot. */
+static
+void
+page_cleaner_flush_slot(
+/*====================*/
+	ulint	slot_no)	/*!< in: page cleaner slot number */
+{
+	page_cleaner_slot_t*	slot = &page_cleaner->slots[slot_no];
+	ulint			start_time = ut_time_ms();
+
+	slot->success = buf_flush_list_instances(
+		page_cleaner->min_n, page_cleaner->lsn_limit,
+		slot_no, page_cleaner->n_slots, &slot->n_flushed);
+
+	slot->flush_time = ut_time_ms() - start_time;
+
+	os_wmb;
+
+	if (os_atomic_increment_ulint(&page_cleaner->n_slots_finished, 1)
+	    == page_cleaner->n_slots) {
+
+		os_event_set(page_cleaner->is_finished);
+	}
+}
+
 /*********************************************************************//**
-Flush a batch of dirty pages from the flush list
+Flush a batch of dirty pages from the flush list.  If there are several
+page cleaner slots, the batch is split between them by buffer pool instance
+and the coordinator waits for all the workers to finish.
 @return number of pages flushed, 0 if no page is flushed or if another
 flush_list type batch is running */
 static
@@ -2359,7 +2563,59 @@ page_cleaner_do_flush_batch(
 {
 	ulint n_flushed;
 
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
+	if (page_cleaner->n_slots == 1) {
+
+		ulint	start_time = ut_time_ms();
+
+		buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
+
+		ulint	flush_time = ut_time_ms() - start_time;
+
+		MONITOR_INC_VALUE(MONITOR_FLUSH_WORKER_TIME, flush_time);
+		MONITOR_SET(MONITOR_FLUSH_WORKER_MAX_TIME, flush_time);
+
+		return(n_flushed);
+	}
+
+	page_cleaner->min_n = buf_flush_list_per_instance(n_to_flush);
+	page_cleaner->lsn_limit = lsn_limit;
+	page_cleaner->n_slots_finished = 0;
+
+	ib_int64_t	sig_count = os_event_reset(page_cleaner->is_finished);
+
+	os_wmb;
+
+	for (ulint i = 1; i < page_cleaner->n_slots; i++) {
+		os_event_set(page_cleaner->slots[i].event);
+	}
+
+	page_cleaner_flush_slot(0);
+
+	ulint	wait_start_time = ut_time_ms();
+
+	os_event_wait_low(page_cleaner->is_finished, sig_count);
+
+	MONITOR_INC_VALUE(MONITOR_FLUSH_COORDINATOR_WAIT_TIME,
+			  ut_time_ms() - wait_start_time);
+
+	os_rmb;
+
+	ulint	total_time = 0;
+	ulint	max_time = 0;
+
+	n_flushed = 0;
+
+	for (ulint i = 0; i < page_cleaner->n_slots; i++) {
+
+		const page_cleaner_slot_t*	slot = &page_cleaner->slots[i];
+
+		n_flushed += slot->n_flushed;
+		total_time += slot->flush_time;
+		max_time = ut_max(max_time, slot->flush_time);
+	}
+
+	MONITOR_INC_VALUE(MONITOR_FLUSH_WORKER_TIME, total_time);
+	MONITOR_SET(MONITOR_FLUSH_WORKER_MAX_TIME, max_time);
 
 	return(n_flushed);
 }
@@ -2592,17 +2848,20 @@ page_cleaner_sleep_if_needed(
 }
 
 /*********************************************************************//**
-Returns the aggregate free list length over all buffer pool instances.
+Returns the aggregate free list length over the buffer pool instances owned
+by a page cleaner slot.
 @return total free list length. */
 MY_ATTRIBUTE((warn_unused_result))
 static
 ulint
-buf_get_total_free_list_length(void)
-/*================================*/
+buf_get_total_free_list_length(
+/*===========================*/
+	ulint	slot_no)	/*!< in: page cleaner slot number */
 {
 	ulint result = 0;
 
-	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+	for (ulint i = slot_no; i < srv_buf_pool_instances;
+	     i += srv_n_page_cleaners) {
 
 		result += UT_LIST_GET_LEN(buf_pool_from_array(i)->free);
 	}
@@ -2610,16 +2869,19 @@ buf_get_total_free_list_length(void)
 	return result;
 }
 
-/** Returns the aggregate LRU list length over all buffer pool instances.
+/** Returns the aggregate LRU list length over the buffer pool instances owned
+by a page cleaner slot.
 @return total LRU list length. */
 MY_ATTRIBUTE((warn_unused_result))
 static
 ulint
-buf_get_total_LRU_list_length(void)
+buf_get_total_LRU_list_length(
+	ulint	slot_no)	/*!< in: page cleaner slot number */
 {
         ulint result = 0;
 
-        for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+        for (ulint i = slot_no; i < srv_buf_pool_instances;
+	     i += srv_n_page_cleaners) {
 
                 result += UT_LIST_GET_LEN(buf_pool_from_array(i)->LRU);
         }
@@ -2636,12 +2898,16 @@ page_cleaner_adapt_lru_sleep_time(
 /*==============================*/
 	ulint*	lru_sleep_time,	/*!< in/out: desired page cleaner thread sleep
 				time for LRU flushes  */
-	ulint	lru_n_flushed) /*!< in: number of flushed in previous batch */
+	ulint	lru_n_flushed,	/*!< in: number of flushed in previous batch */
+	ulint	slot_no)	/*!< in: page cleaner slot number */
 
 {
-        ulint free_len = buf_get_total_free_list_length();
-        ulint max_free_len = ut_min(buf_get_total_LRU_list_length(),
-                        srv_LRU_scan_depth * srv_buf_pool_instances);
+	ulint n_instances = (srv_buf_pool_instances - slot_no
+			     + srv_n_page_cleaners - 1)
+		/ srv_n_page_cleaners;
+        ulint free_len = buf_get_total_free_list_length(slot_no);
+        ulint max_free_len = ut_min(buf_get_total_LRU_list_length(slot_no),
+                        srv_LRU_scan_depth * n_instances);
 
 	if (free_len < max_free_len / 100 && lru_n_flushed) {
 
@@ -2689,8 +2955,9 @@ page_cleaner_adapt_flush_sleep_time(void)
 }
 
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pool flush lists. As of now we'll have only one instance of this thread.
+page_cleaner coordinator thread tasked with flushing dirty pages from the
+buffer pool flush lists. It decides how much to flush and splits the work
+between itself and the page cleaner worker threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -2712,9 +2979,9 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	pfs_register_thread(buf_page_cleaner_thread_key);
 #endif /* UNIV_PFS_THREAD */
 
-	srv_cleaner_tid = os_thread_get_tid();
+	srv_cleaner_tids[0] = os_thread_get_tid();
 
-	os_thread_set_priority(srv_cleaner_tid, srv_sched_priority_cleaner);
+	os_thread_set_priority(srv_cleaner_tids[0], srv_sched_priority_cleaner);
 
 #ifdef UNIV_DEBUG_THREAD_CREATION
 	fprintf(stderr, "InnoDB: page_cleaner thread running, id %lu\n",
@@ -2846,6 +3113,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	/* We have lived our life. Time to die. */
 
 thread_exit:
+	buf_flush_page_cleaner_close();
+
 	buf_page_cleaner_is_active = FALSE;
 
 	my_thread_end();
@@ -2856,30 +3125,92 @@ thread_exit:
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+page_cleaner worker thread tasked with flushing the flush lists of the buffer
+pool instances owned by its slot on the page_cleaner coordinator requests.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg)	/*!< in: a pointer to the page cleaner slot
+			number */
+{
+	ulint			slot_no = *static_cast<ulint*>(arg);
+	page_cleaner_slot_t*	slot = &page_cleaner->slots[slot_no];
+
+	my_thread_init();
+
+	ut_ad(!srv_read_only_mode);
+	ut_ad(slot_no > 0);
+	ut_ad(slot_no < page_cleaner->n_slots);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	srv_cleaner_tids[slot_no] = os_thread_get_tid();
+
+	os_thread_set_priority(srv_cleaner_tids[slot_no],
+			       srv_sched_priority_cleaner);
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: page_cleaner worker thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	for (;;) {
+
+		os_event_wait(slot->event);
+
+		os_rmb;
+		if (!page_cleaner->is_running) {
+			break;
+		}
+
+		os_event_reset(slot->event);
+
+		srv_current_thread_priority = srv_cleaner_thread_priority;
+
+		page_cleaner_flush_slot(slot_no);
+	}
+
+	os_atomic_decrement_ulint(&page_cleaner->n_workers, 1);
+
+	my_thread_end();
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /******************************************************************//**
 lru_manager thread tasked with performing LRU flushes and evictions to refill
-the buffer pool free lists.  As of now we'll have only one instance of this
-thread.
+the free lists of the buffer pool instances owned by its page cleaner slot.
+There is one instance of this thread per page cleaner slot.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
 DECLARE_THREAD(buf_flush_lru_manager_thread)(
 /*==========================================*/
-	void*	arg MY_ATTRIBUTE((unused)))
-			/*!< in: a dummy parameter required by
-			os_thread_create */
+	void*	arg)	/*!< in: a pointer to the page cleaner slot
+			number */
 {
+	ulint	slot_no = *static_cast<ulint*>(arg);
 	ulint	next_loop_time = ut_time_ms() + 1000;
 	ulint	lru_sleep_time = srv_cleaner_max_lru_time;
 	ulint	lru_n_flushed = 1;
 
+	ut_ad(slot_no < srv_n_page_cleaners);
+
 #ifdef UNIV_PFS_THREAD
 	pfs_register_thread(buf_lru_manager_thread_key);
 #endif /* UNIV_PFS_THREAD */
 
-	srv_lru_manager_tid = os_thread_get_tid();
+	srv_lru_manager_tids[slot_no] = os_thread_get_tid();
 
-	os_thread_set_priority(srv_lru_manager_tid,
+	os_thread_set_priority(srv_lru_manager_tids[slot_no],
 			       srv_sched_priority_cleaner);
 
 #ifdef UNIV_DEBUG_THREAD_CREATION
@@ -2887,6 +3218,7 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 		os_thread_pf(os_thread_get_curr_id()));
 #endif /* UNIV_DEBUG_THREAD_CREATION */
 
+	os_atomic_increment_ulint(&buf_lru_manager_running_threads, 1);
 	buf_lru_manager_is_active = true;
 	os_wmb;
 
@@ -2899,14 +3231,20 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 
 		page_cleaner_sleep_if_needed(next_loop_time);
 
-		page_cleaner_adapt_lru_sleep_time(&lru_sleep_time, lru_n_flushed);
+		page_cleaner_adapt_lru_sleep_time(&lru_sleep_time, lru_n_flushed,
+						  slot_no);
 
 		next_loop_time = ut_time_ms() + lru_sleep_time;
 
-		lru_n_flushed = buf_flush_LRU_tail();
+		lru_n_flushed = buf_flush_LRU_tail_instances(
+			slot_no, srv_n_page_cleaners);
 	}
 
-	buf_lru_manager_is_active = false;
+	if (os_atomic_decrement_ulint(&buf_lru_manager_running_threads, 1)
+	    == 0) {
+
+		buf_lru_manager_is_active = false;
+	}
 	os_wmb;
 
 	/* We count the number of threads in os_thread_exit(). A created
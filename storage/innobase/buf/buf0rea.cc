@@ -494,7 +494,11 @@ ibool
 buf_read_page_async(
 /*================*/
 	ulint	space,	/*!< in: space id */
-	ulint	offset)	/*!< in: page number */
+	ulint	offset,	/*!< in: page number */
+	bool	should_buffer)	/*!< in: whether to buffer the aio
+				request. The caller must submit the
+				buffered requests with
+				os_aio_dispatch_read_array_submit() */
 {
 	ulint		zip_size;
 	ib_int64_t	tablespace_version;
@@ -513,7 +517,8 @@ buf_read_page_async(
 				  | OS_AIO_SIMULATED_WAKE_LATER
 				  | BUF_READ_IGNORE_NONEXISTENT_PAGES,
 				  space, zip_size, FALSE,
-				  tablespace_version, offset, NULL, false);
+				  tablespace_version, offset, NULL,
+				  should_buffer);
 	srv_stats.buf_pool_reads.add(count);
 
 	/* We do not increment number of I/O operations used for LRU policy
@@ -2723,6 +2723,86 @@ fil_close_tablespace(
 	return(err);
 }
 
+#ifndef UNIV_HOTBACKUP
+/*******************************************************************//**
+Truncates an undo tablespace to the given size. The pages of the
+tablespace are discarded from the buffer pool without writing them, and the
+data file is cut and zero-filled up to the new size. The caller must make
+sure that nobody accesses the tablespace meanwhile, and must create a new
+file space header afterwards.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_truncate_undo_tablespace(
+/*=========================*/
+	ulint	id,	/*!< in: undo tablespace id */
+	ulint	size)	/*!< in: new size in pages */
+{
+	char*		path = 0;
+	fil_space_t*	space = 0;
+	fil_node_t*	node;
+	bool		success;
+
+	ut_ad(!srv_read_only_mode);
+
+	dberr_t		err = fil_check_pending_operations(id, &space, &path);
+
+	if (err != DB_SUCCESS) {
+		return(err);
+	}
+
+	ut_a(space);
+	ut_a(UT_LIST_GET_LEN(space->chain) == 1);
+
+	/* The undo logs of the tablespace have all been purged and
+	space->stop_new_ops keeps read-ahead away, so the pages can be
+	thrown away. */
+
+	buf_LRU_flush_or_remove_pages(id, BUF_REMOVE_ALL_NO_WRITE, 0);
+
+	mutex_enter(&fil_system->mutex);
+
+	node = UT_LIST_GET_FIRST(space->chain);
+
+	if (!fil_node_prepare_for_io(node, fil_system, space)) {
+		space->stop_new_ops = FALSE;
+		mutex_exit(&fil_system->mutex);
+		mem_free(path);
+
+		return(DB_ERROR);
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	success = os_file_set_eof_at(node->handle, 0)
+		&& os_file_set_size(node->name, node->handle,
+				    (os_offset_t) size * UNIV_PAGE_SIZE)
+		&& os_file_flush(node->handle);
+
+	mutex_enter(&fil_system->mutex);
+
+	if (success) {
+		space->size = node->size = size;
+	} else {
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Could not truncate undo tablespace '%s' to %lu pages",
+			path, size);
+
+		err = DB_ERROR;
+	}
+
+	fil_node_complete_io(node, fil_system, OS_FILE_WRITE);
+
+	space->stop_new_ops = FALSE;
+
+	mutex_exit(&fil_system->mutex);
+
+	mem_free(path);
+
+	return(err);
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /*******************************************************************//**
 Deletes a single-table tablespace. The tablespace must be cached in the
 memory cache.
@@ -5909,7 +5989,7 @@ fil_aio_wait(
 #ifdef WIN_ASYNC_IO
 		ret = os_aio_windows_handle(
 			segment, 0, &fil_node, &message, &type, &space_id);
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
 		ret = os_aio_linux_handle(
 			segment, &fil_node, &message, &type, &space_id);
 #else
@@ -5955,6 +6035,164 @@ fil_aio_wait(
 }
 #endif /* UNIV_HOTBACKUP */
 
+/********************************************************************//**
+Records that the writes to a file node that were made before the flush
+started are on disk, and removes the space from the unflushed spaces if
+none of its nodes has unflushed writes left. The caller must hold
+fil_system->mutex. */
+static
+void
+fil_node_complete_flush(
+/*====================*/
+	fil_node_t*	node,		/*!< in/out: flushed file node */
+	ib_int64_t	old_mod_counter)/*!< in: modification counter of the
+					node when the flush started */
+{
+	fil_space_t*	space = node->space;
+
+	ut_ad(mutex_own(&fil_system->mutex));
+
+	if (node->flush_counter < old_mod_counter) {
+		node->flush_counter = old_mod_counter;
+
+		if (space->is_in_unflushed_spaces
+		    && fil_space_is_flushed(space)) {
+
+			space->is_in_unflushed_spaces = false;
+
+			UT_LIST_REMOVE(
+				unflushed_spaces,
+				fil_system->unflushed_spaces,
+				space);
+		}
+	}
+}
+
+/********************************************************************//**
+Flushes the file nodes that have unflushed writes and no flush in progress
+with one os_file_flush_files() call, so that the fsync requests are in
+flight at the same time. The nodes are taken from one space or from all
+the unflushed spaces of a type. Nodes that another thread is flushing are
+skipped and left to fil_flush(). The caller must hold fil_system->mutex;
+it is released while the files are flushed. */
+static
+void
+fil_flush_batch(
+/*============*/
+	fil_space_t*	only_space,	/*!< in: space to flush, or NULL to
+					flush all the unflushed spaces of
+					the given type */
+	ulint		purpose)	/*!< in: FIL_TABLESPACE, FIL_LOG */
+{
+	fil_node_t**	nodes = NULL;
+	ib_int64_t*	old_mod_counters = NULL;
+	pfs_os_file_t*	files = NULL;
+	ulint		n_nodes = 0;
+
+	ut_ad(mutex_own(&fil_system->mutex));
+
+	/* Count the nodes in the first pass and collect them in the
+	second one. */
+	for (ulint pass = 0; pass < 2; pass++) {
+
+		if (pass == 1) {
+			if (n_nodes < 2) {
+				/* Nothing to gain from a batch. */
+				return;
+			}
+
+			nodes = static_cast<fil_node_t**>(
+				mem_alloc(n_nodes * sizeof *nodes));
+			old_mod_counters = static_cast<ib_int64_t*>(
+				mem_alloc(n_nodes * sizeof *old_mod_counters));
+			files = static_cast<pfs_os_file_t*>(
+				mem_alloc(n_nodes * sizeof *files));
+
+			n_nodes = 0;
+		}
+
+		for (fil_space_t* space = only_space
+			     ? only_space
+			     : UT_LIST_GET_FIRST(fil_system->unflushed_spaces);
+		     space != NULL;
+		     space = only_space
+			     ? NULL
+			     : UT_LIST_GET_NEXT(unflushed_spaces, space)) {
+
+			if (!only_space
+			    && (space->purpose != purpose
+				|| space->stop_new_ops
+				|| fil_buffering_disabled(space))) {
+
+				continue;
+			}
+
+			for (fil_node_t* node = UT_LIST_GET_FIRST(space->chain);
+			     node != NULL;
+			     node = UT_LIST_GET_NEXT(chain, node)) {
+
+				if (node->modification_counter
+				    <= node->flush_counter
+				    || node->n_pending_flushes > 0
+				    || !node->open) {
+
+					continue;
+				}
+
+				if (pass == 1) {
+					nodes[n_nodes] = node;
+					old_mod_counters[n_nodes]
+						= node->modification_counter;
+					files[n_nodes] = node->handle;
+
+					/* Prevent dropping of the space
+					and closing of the file while we
+					are flushing */
+					space->n_pending_flushes++;
+					node->n_pending_flushes++;
+
+					if (purpose == FIL_TABLESPACE) {
+						fil_n_pending_tablespace_flushes++;
+					} else {
+						fil_n_pending_log_flushes++;
+						fil_n_log_flushes++;
+					}
+				}
+
+				n_nodes++;
+			}
+		}
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	os_file_flush_files(files, n_nodes);
+
+	mutex_enter(&fil_system->mutex);
+
+	for (ulint i = 0; i < n_nodes; i++) {
+		fil_node_t*	node = nodes[i];
+
+		os_event_set(node->sync_event);
+
+		node->n_pending_flushes--;
+
+		fil_node_complete_flush(node, old_mod_counters[i]);
+
+		if (purpose == FIL_TABLESPACE) {
+			fil_n_pending_tablespace_flushes--;
+		} else {
+			fil_n_pending_log_flushes--;
+		}
+
+		node->space->n_pending_flushes--;
+	}
+
+	mem_free(nodes);
+	mem_free(old_mod_counters);
+	mem_free(files);
+}
+
 /**********************************************************************//**
 Flushes to disk possible writes cached by the OS. If the space does not exist
 or is being dropped, does not do anything. */
@@ -6004,6 +6242,13 @@ fil_flush(
 
 	space->n_pending_flushes++;	/*!< prevent dropping of the space while
 					we are flushing */
+
+	if (srv_use_io_uring) {
+		/* Flush the files of a multi-file space, for example
+		the redo log group, at the same time */
+		fil_flush_batch(space, space->purpose);
+	}
+
 	for (node = UT_LIST_GET_FIRST(space->chain);
 	     node != NULL;
 	     node = UT_LIST_GET_NEXT(chain, node)) {
@@ -6066,20 +6311,7 @@ retry:
 
 		node->n_pending_flushes--;
 skip_flush:
-		if (node->flush_counter < old_mod_counter) {
-			node->flush_counter = old_mod_counter;
-
-			if (space->is_in_unflushed_spaces
-			    && fil_space_is_flushed(space)) {
-
-				space->is_in_unflushed_spaces = false;
-
-				UT_LIST_REMOVE(
-					unflushed_spaces,
-					fil_system->unflushed_spaces,
-					space);
-			}
-		}
+		fil_node_complete_flush(node, old_mod_counter);
 
 		if (space->purpose == FIL_TABLESPACE) {
 			fil_n_pending_tablespace_flushes--;
@@ -6109,6 +6341,13 @@ fil_flush_file_spaces(
 
 	mutex_enter(&fil_system->mutex);
 
+	if (srv_use_io_uring) {
+		/* Have the fsync requests of all the spaces in flight at
+		the same time. fil_flush() below only needs to deal with
+		the files that were being flushed by other threads. */
+		fil_flush_batch(NULL, purpose);
+	}
+
 	n_space_ids = UT_LIST_GET_LEN(fil_system->unflushed_spaces);
 	if (n_space_ids == 0) {
 
@@ -34,6 +34,8 @@ Created 8/22/1994 Heikki Tuuri
 #endif /* UNIV_DEBUG */
 # include "btr0sea.h"
 #include "page0page.h"
+#include "srv0srv.h"
+#include "ut0rnd.h"
 
 /*************************************************************//**
 Creates a hash table with at least n array cells.  The actual number
@@ -249,8 +251,14 @@ ha_insert_for_fold_func(
 
 	/* We have to allocate a new chain node */
 
-	node = static_cast<ha_node_t*>(
-		mem_heap_alloc(hash_get_heap(table, fold), sizeof(ha_node_t)));
+	if (table->readers != NULL && table->readers->free_nodes != NULL) {
+		node = table->readers->free_nodes;
+		table->readers->free_nodes = node->next;
+	} else {
+		node = static_cast<ha_node_t*>(
+			mem_heap_alloc(hash_get_heap(table, fold),
+				       sizeof(ha_node_t)));
+	}
 
 	if (node == NULL) {
 		/* It was a btr search type memory heap and at the moment
@@ -273,6 +281,10 @@ ha_insert_for_fold_func(
 
 	node->next = NULL;
 
+	/* Readers which do not hold the latch must not see the node
+	before it is initialized. */
+	os_wmb;
+
 	prev_node = static_cast<ha_node_t*>(cell->node);
 
 	if (prev_node == NULL) {
@@ -292,6 +304,174 @@ ha_insert_for_fold_func(
 	return(TRUE);
 }
 
+/*************************************************************//**
+Waits until all the readers of a hash table which might have started
+before the call have finished. */
+static
+void
+ha_readers_wait(
+/*============*/
+	ha_readers_t*	readers)	/*!< in/out: readers of the table */
+{
+	ulint	parity;
+	ulint	i;
+
+	/* Make the readers that start from now on use the other counters
+	of the slots. Only the readers that started before can increment
+	the counters we are waiting on; ha_read_enter() backs off if it
+	notices that the epoch changed. */
+
+#ifdef HAVE_ATOMIC_BUILTINS
+	parity = os_atomic_increment_ulint(&readers->epoch, 1) & 1;
+#else /* HAVE_ATOMIC_BUILTINS */
+	os_fast_mutex_lock(&readers->mutex);
+	parity = ++readers->epoch & 1;
+	os_fast_mutex_unlock(&readers->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	parity ^= 1;
+
+	for (i = 0; i < HA_N_READER_SLOTS; i++) {
+		ulint	n_rounds = 0;
+
+		for (;;) {
+			ulint	n_readers;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+			n_readers = readers->slots[i].n_readers[parity];
+#else /* HAVE_ATOMIC_BUILTINS */
+			os_fast_mutex_lock(&readers->mutex);
+			n_readers = readers->slots[i].n_readers[parity];
+			os_fast_mutex_unlock(&readers->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+			if (n_readers == 0) {
+				break;
+			}
+
+			/* The readers only look up a few nodes and
+			try to latch a page without waiting. */
+
+			if (n_rounds++ < SYNC_SPIN_ROUNDS) {
+				ut_delay(ut_rnd_interval(
+						 0, srv_spin_wait_delay));
+			} else {
+				os_thread_yield();
+			}
+		}
+	}
+
+	/* Do not let the caller reuse the nodes before we have seen the
+	counters drop. */
+	os_rmb;
+}
+
+/*************************************************************//**
+Makes the nodes which have been removed from the chains of a hash table
+free for reuse, once no reader can see them anymore. */
+static
+void
+ha_reclaim_removed_nodes(
+/*=====================*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ha_readers_t*	readers = table->readers;
+	ulint		i;
+
+	DEBUG_SYNC_C("ha_reclaim_removed_nodes");
+
+	ha_readers_wait(readers);
+
+	for (i = 0; i < readers->n_removed; i++) {
+		ha_node_t*	node = readers->removed[i];
+
+		node->next = readers->free_nodes;
+		readers->free_nodes = node;
+	}
+
+	readers->n_removed = 0;
+}
+
+/*************************************************************//**
+Allows searching a hash table without holding the latch which protects
+its modifications, see ha_read_enter(). Chain nodes removed from such a
+table are not freed or moved at once, but reused in batches when no
+reader can see them anymore. */
+UNIV_INTERN
+void
+ha_readers_create(
+/*==============*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ha_readers_t*	readers;
+
+	ut_ad(table->magic_n == HASH_TABLE_MAGIC_N);
+	ut_ad(table->readers == NULL);
+	/* Nodes are removed from a single heap which is never compacted
+	while the table is searched without a latch. */
+	ut_ad(table->heaps == NULL);
+
+	readers = static_cast<ha_readers_t*>(
+		mem_zalloc(sizeof(ha_readers_t)));
+
+#ifndef HAVE_ATOMIC_BUILTINS
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &readers->mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS */
+
+	table->readers = readers;
+}
+
+/*************************************************************//**
+Frees the reader registration created by ha_readers_create(). */
+UNIV_INTERN
+void
+ha_readers_free(
+/*============*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ha_readers_t*	readers = table->readers;
+
+#ifdef UNIV_DEBUG
+	for (ulint i = 0; i < HA_N_READER_SLOTS; i++) {
+		ut_ad(readers->slots[i].n_readers[0] == 0);
+		ut_ad(readers->slots[i].n_readers[1] == 0);
+	}
+#endif /* UNIV_DEBUG */
+
+#ifndef HAVE_ATOMIC_BUILTINS
+	os_fast_mutex_free(&readers->mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS */
+
+	mem_free(readers);
+	table->readers = NULL;
+}
+
+/*************************************************************//**
+Removes all nodes from a hash table. If the table is searched without a
+latch, waits until no reader can see the removed nodes anymore, so that
+the caller can free the memory heap of the nodes. */
+UNIV_INTERN
+void
+ha_remove_all_nodes(
+/*================*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ut_ad(table->magic_n == HASH_TABLE_MAGIC_N);
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(!table->adaptive || ha_assert_btr_x_locked(table));
+#endif /* UNIV_SYNC_DEBUG */
+
+	hash_table_clear(table);
+
+	if (table->readers != NULL) {
+		ha_readers_wait(table->readers);
+
+		/* The nodes are gone with the heap. */
+		table->readers->n_removed = 0;
+		table->readers->free_nodes = NULL;
+	}
+}
+
 /***********************************************************//**
 Deletes a hash node. */
 UNIV_INTERN
@@ -315,6 +495,39 @@ ha_delete_hash_node(
 	}
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 
+	if (table->readers != NULL) {
+		hash_cell_t*	cell;
+		ha_node_t*	node;
+
+		/* Unlink the node but do not touch it: a reader may be
+		positioned on it and go on along del_node->next. */
+
+		cell = hash_get_nth_cell(
+			table, hash_calc_hash(del_node->fold, table));
+
+		if (cell->node == del_node) {
+			cell->node = del_node->next;
+		} else {
+			node = static_cast<ha_node_t*>(cell->node);
+
+			while (node->next != del_node) {
+				node = node->next;
+				ut_a(node);
+			}
+
+			node->next = del_node->next;
+		}
+
+		table->readers->removed[table->readers->n_removed++]
+			= del_node;
+
+		if (table->readers->n_removed == HA_RECLAIM_BATCH) {
+			ha_reclaim_removed_nodes(table);
+		}
+
+		return;
+	}
+
 	HASH_DELETE_AND_COMPACT(ha_node_t, next, table, del_node);
 }
 
@@ -317,6 +317,7 @@ hash_create(
 	table->n_sync_obj = 0;
 	table->sync_obj.mutexes = NULL;
 	table->heaps = NULL;
+	table->readers = NULL;
 #endif /* !UNIV_HOTBACKUP */
 	table->heap = NULL;
 	ut_d(table->magic_n = HASH_TABLE_MAGIC_N);
@@ -391,9 +391,10 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&sync_thread_mutex_key, "sync_thread_mutex", 0},
 #  endif /* UNIV_SYNC_DEBUG */
 	{&buf_dblwr_mutex_key, "buf_dblwr_mutex", 0},
+	{&buf_dblwr_shard_mutex_key, "buf_dblwr_shard_mutex", 0},
 	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
-	{&lock_sys_mutex_key, "lock_mutex", 0},
+	{&lock_sys_rec_mutex_key, "lock_rec_mutex", 0},
 	{&lock_sys_wait_mutex_key, "lock_wait_mutex", 0},
 	{&trx_mutex_key, "trx_mutex", 0},
 	{&srv_sys_tasks_mutex_key, "srv_threads_mutex", 0},
@@ -438,6 +439,7 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	{&trx_purge_latch_key, "trx_purge_latch", 0},
 	{&index_tree_rw_lock_key, "index_tree_rw_lock", 0},
 	{&index_online_log_key, "index_online_log", 0},
+	{&lock_sys_latch_key, "lock_sys_latch", 0},
 	{&dict_table_stats_key, "dict_table_stats", 0},
 	{&hash_table_rw_lock_key, "hash_table_locks", 0}
 };
@@ -458,6 +460,9 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
 	{&buf_lru_manager_thread_key, "lru_manager_thread", 0},
 	{&recv_writer_thread_key, "recv_writer_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0},
 	{&srv_log_tracking_thread_key, "srv_redo_log_follow_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
@@ -948,6 +953,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_purge_trx_id,		  SHOW_LONGLONG},
   {"purge_undo_no",
   (char*) &export_vars.innodb_purge_undo_no,		  SHOW_LONGLONG},
+  {"recovery_apply_time",
+  (char*) &export_vars.innodb_recovery_apply_time,	  SHOW_LONG},
+  {"recovery_bytes_applied",
+  (char*) &export_vars.innodb_recovery_bytes_applied,	  SHOW_LONG},
+  {"recovery_pages_applied",
+  (char*) &export_vars.innodb_recovery_pages_applied,	  SHOW_LONG},
   {"row_lock_current_waits",
   (char*) &export_vars.innodb_row_lock_current_waits,	  SHOW_LONG},
   {"current_row_locks",
@@ -984,6 +995,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_truncated_status_writes,	  SHOW_LONG},
   {"available_undo_logs",
   (char*) &export_vars.innodb_available_undo_logs,        SHOW_LONG},
+  {"undo_truncations",
+  (char*) &export_vars.innodb_undo_truncations,		  SHOW_LONG},
+  {"undo_truncated_bytes",
+  (char*) &export_vars.innodb_undo_truncated_bytes,	  SHOW_LONGLONG},
 #ifdef UNIV_DEBUG
   {"purge_trx_id_age",
   (char*) &export_vars.innodb_purge_trx_id_age,           SHOW_LONG},
@@ -1563,6 +1578,19 @@ thd_is_replication_slave_thread(
 	return((ibool) thd_slave_thread(thd));
 }
 
+/******************************************************************//**
+Reports that the transaction of a thread waits for a row lock held by the
+transaction of another thread. */
+UNIV_INTERN
+void
+thd_report_wait_for(
+/*================*/
+	THD*	thd,		/*!< in: thread handle of the waiting trx */
+	THD*	other_thd)	/*!< in: thread handle of the lock holder */
+{
+	thd_report_row_lock_wait(thd, other_thd);
+}
+
 /******************************************************************//**
 Gets information on the durability property requested by thread.
 Used when writing either a prepare or commit record to the log
@@ -16073,6 +16101,31 @@ innodb_adaptive_hash_index_update(
 	}
 }
 
+/****************************************************************//**
+Update the system variable innodb_undo_log_truncate using the "saved"
+value. The purge coordinator is suspended while there is nothing to
+purge, so it is woken up to truncate the undo tablespaces that have
+already grown too large. This function is registered as a callback with
+MySQL. */
+static
+void
+innodb_undo_log_truncate_update(
+/*============================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to
+						system variable */
+	void*				var_ptr,/*!< out: where the
+						formal string goes */
+	const void*			save)	/*!< in: immediate result
+						from check function */
+{
+	srv_undo_log_truncate = *(my_bool*) save;
+
+	if (srv_undo_log_truncate && !srv_read_only_mode) {
+		srv_wake_purge_thread_if_not_active();
+	}
+}
+
 /****************************************************************//**
 Update the system variable innodb_cmp_per_index using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -16991,39 +17044,52 @@ innodb_sched_priority_cleaner_update(
 	ulint	priority = *static_cast<const ulint *>(save);
 	ulint	actual_priority;
 
-	/* Set the priority for the LRU manager thread */
+	/* Set the priority for the LRU manager threads */
 	ut_ad(buf_lru_manager_is_active);
-	actual_priority = os_thread_set_priority(srv_lru_manager_tid,
-						 priority);
-	if (UNIV_UNLIKELY(actual_priority != priority)) {
+	for (ulint i = 0; i < srv_n_page_cleaners; i++) {
 
-		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
-				    ER_WRONG_ARGUMENTS,
-				    "Failed to set the LRU manager thread "
-				    "priority to %lu,  "
-				    "the current priority is %lu", priority,
-				    actual_priority);
-	} else {
+		actual_priority = os_thread_set_priority(
+			srv_lru_manager_tids[i], priority);
+		if (UNIV_UNLIKELY(actual_priority != priority)) {
+
+			push_warning_printf(thd,
+					    Sql_condition::WARN_LEVEL_WARN,
+					    ER_WRONG_ARGUMENTS,
+					    "Failed to set the LRU manager "
+					    "thread priority to %lu,  "
+					    "the current priority is %lu",
+					    priority, actual_priority);
+			break;
+		}
+	}
+
+	if (actual_priority == priority) {
 
 		srv_sched_priority_cleaner = priority;
 	}
 
-	/* Set the priority for the page cleaner thread */
+	/* Set the priority for the page cleaner threads */
 	if (srv_read_only_mode) {
 
 		return;
 	}
 
 	ut_ad(buf_page_cleaner_is_active);
-	actual_priority = os_thread_set_priority(srv_cleaner_tid, priority);
-	if (UNIV_UNLIKELY(actual_priority != priority)) {
+	for (ulint i = 0; i < srv_n_page_cleaners; i++) {
 
-		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
-				    ER_WRONG_ARGUMENTS,
-				    "Failed to set the page cleaner thread "
-				    "priority to %lu,  "
-				    "the current priority is %lu", priority,
-				    actual_priority);
+		actual_priority = os_thread_set_priority(srv_cleaner_tids[i],
+							 priority);
+		if (UNIV_UNLIKELY(actual_priority != priority)) {
+
+			push_warning_printf(thd,
+					    Sql_condition::WARN_LEVEL_WARN,
+					    ER_WRONG_ARGUMENTS,
+					    "Failed to set the page cleaner "
+					    "thread priority to %lu,  "
+					    "the current priority is %lu",
+					    priority, actual_priority);
+			return;
+		}
 	}
 }
 
@@ -17755,6 +17821,14 @@ static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_STR(parallel_doublewrite_path,
+  srv_parallel_doublewrite_path,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Path to the parallel doublewrite file, which holds a doublewrite shard "
+  "per buffer pool instance and flush type. A relative path is relative "
+  "to the data directory.",
+  NULL, NULL, "xb_doublewrite");
+
 static MYSQL_SYSVAR_BOOL(stats_include_delete_marked,
   srv_stats_include_delete_marked,
   PLUGIN_VAR_OPCMDARG,
@@ -17819,6 +17893,16 @@ static MYSQL_SYSVAR_ULONG(purge_batch_size, srv_purge_batch_size,
   1,			/* Minimum value */
   5000, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(purge_rseg_truncate_frequency,
+  srv_purge_rseg_truncate_frequency,
+  PLUGIN_VAR_OPCMDARG,
+  "Purge truncates the history of the rollback segments, and checks whether"
+  " an undo tablespace can be truncated, on every Nth purge batch.",
+  NULL, NULL,
+  TRX_SYS_N_RSEGS,	/* Default setting */
+  1,			/* Minimum value */
+  TRX_SYS_N_RSEGS, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Purge threads can be from 1 to 32. Default is 1.",
@@ -18166,6 +18250,16 @@ static MYSQL_SYSVAR_BOOL(priority_master, srv_master_thread_priority,
 
 #endif /* UNIV_LINUX */
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Page cleaner threads can be from 1 to 64. Each page cleaner thread, "
+  "together with its LRU manager thread, flushes a subset of the buffer pool "
+  "instances. Capped at innodb_buffer_pool_instances. Default is 1.",
+  NULL, NULL,
+  1,			/* Default setting */
+  1,			/* Minimum value */
+  SRV_MAX_N_PAGE_CLEANERS, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(cleaner_max_lru_time, srv_cleaner_max_lru_time,
   PLUGIN_VAR_RQCMDARG,
   "The maximum time limit for a single LRU tail flush iteration by the page "
@@ -18355,6 +18449,14 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(sort_threads, srv_sort_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads sorting and loading non-unique secondary indexes in "
+  "parallel when several indexes are created by one ALTER TABLE, or merging "
+  "the sorted runs of a single non-unique secondary index in parallel. Each "
+  "thread uses 3 * innodb_sort_buffer_size bytes of memory.",
+  NULL, NULL, 4, 1, 64, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -18387,6 +18489,15 @@ static MYSQL_SYSVAR_ULONG(force_recovery_crash, srv_force_recovery_crash,
   NULL, NULL, 0, 0, 10, 0);
 #endif /* !DBUG_OFF */
 
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_n_recv_apply_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads applying redo log records to pages during crash "
+  "recovery, from 1 to 64. Default is 4.",
+  NULL, NULL,
+  4,				/* Default setting */
+  1,				/* Minimum value */
+  SRV_MAX_N_RECV_APPLY_THREADS, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(page_size, srv_page_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Page size to use for all InnoDB tablespaces.",
@@ -18398,6 +18509,20 @@ static MYSQL_SYSVAR_LONG(log_buffer_size, innobase_log_buffer_size,
   "The size of the buffer which InnoDB uses to write log to the log files on disk.",
   NULL, NULL, 8*1024*1024L, 256*1024L, LONG_MAX, 1024);
 
+static MYSQL_SYSVAR_BOOL(log_writer_threads, srv_log_writer_threads,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Write and flush the redo log in dedicated log writer and log flusher "
+  "threads. Committing threads then only wait for them, and one log fsync "
+  "releases all the transactions it has made durable (disabled by default).",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONG(log_wait_spin_rounds, srv_log_wait_spin_rounds,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of spin rounds a thread waiting for the log writer or log flusher "
+  "thread does before it sleeps (100 by default). Only used with "
+  "innodb_log_writer_threads.",
+  NULL, NULL, 100L, 0L, 100000L, 0);
+
 static MYSQL_SYSVAR_LONGLONG(log_file_size, innobase_log_file_size,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Size of each log file in a log group.",
@@ -18485,6 +18610,20 @@ static MYSQL_SYSVAR_ULONG(undo_tablespaces, srv_undo_tablespaces,
   0L,			/* Minimum value */
   126L, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_BOOL(undo_log_truncate, srv_undo_log_truncate,
+  PLUGIN_VAR_OPCMDARG,
+  "Truncate undo tablespaces that grow larger than innodb_max_undo_log_size"
+  " once purge has drained them.",
+  NULL, innodb_undo_log_truncate_update, FALSE);
+
+static MYSQL_SYSVAR_ULONGLONG(max_undo_log_size, srv_max_undo_log_size,
+  PLUGIN_VAR_OPCMDARG,
+  "Size in bytes above which an undo tablespace is marked for truncation.",
+  NULL, NULL,
+  1024 * 1024 * 1024L,	/* Default setting */
+  10 * 1024 * 1024L,	/* Minimum value */
+  ~0ULL, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(undo_logs, srv_undo_logs,
   PLUGIN_VAR_OPCMDARG,
   "Number of undo logs to use.",
@@ -18530,6 +18669,12 @@ static MYSQL_SYSVAR_BOOL(use_native_aio, srv_use_native_aio,
   "Use native AIO if supported on this platform.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(use_io_uring, srv_use_io_uring,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Submit native AIO through io_uring instead of libaio if supported "
+  "by the kernel. Has no effect unless innodb_use_native_aio is enabled.",
+  NULL, NULL, FALSE);
+
 #ifdef HAVE_LIBNUMA
 static MYSQL_SYSVAR_BOOL(numa_interleave, srv_numa_interleave,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
@@ -18810,6 +18955,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(parallel_doublewrite_path),
   MYSQL_SYSVAR(stats_include_delete_marked),
   MYSQL_SYSVAR(api_enable_binlog),
   MYSQL_SYSVAR(api_enable_mdl),
@@ -18831,6 +18977,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #ifndef DBUG_OFF
   MYSQL_SYSVAR(force_recovery_crash),
 #endif /* !DBUG_OFF */
+  MYSQL_SYSVAR(recovery_apply_threads),
   MYSQL_SYSVAR(ft_cache_size),
   MYSQL_SYSVAR(ft_total_cache_size),
   MYSQL_SYSVAR(ft_result_cache_limit),
@@ -18850,6 +18997,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_LOG_ARCHIVE */
   MYSQL_SYSVAR(page_size),
   MYSQL_SYSVAR(log_buffer_size),
+  MYSQL_SYSVAR(log_writer_threads),
+  MYSQL_SYSVAR(log_wait_spin_rounds),
   MYSQL_SYSVAR(log_file_size),
   MYSQL_SYSVAR(log_files_in_group),
   MYSQL_SYSVAR(log_group_home_dir),
@@ -18886,6 +19035,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(sort_threads),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -18901,6 +19051,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(version),
   MYSQL_SYSVAR(use_sys_malloc),
   MYSQL_SYSVAR(use_native_aio),
+  MYSQL_SYSVAR(use_io_uring),
 #ifdef HAVE_LIBNUMA
   MYSQL_SYSVAR(numa_interleave),
 #endif // HAVE_LIBNUMA
@@ -18924,6 +19075,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
   MYSQL_SYSVAR(purge_batch_size),
+  MYSQL_SYSVAR(purge_rseg_truncate_frequency),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(purge_run_now),
   MYSQL_SYSVAR(purge_stop_now),
@@ -18946,6 +19098,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(priority_cleaner),
   MYSQL_SYSVAR(priority_master),
 #endif /* UNIV_LINUX */
+  MYSQL_SYSVAR(page_cleaners),
   MYSQL_SYSVAR(cleaner_max_lru_time),
   MYSQL_SYSVAR(cleaner_max_flush_time),
   MYSQL_SYSVAR(cleaner_flush_chunk_size),
@@ -18965,6 +19118,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(rollback_segments),
   MYSQL_SYSVAR(undo_directory),
   MYSQL_SYSVAR(undo_tablespaces),
+  MYSQL_SYSVAR(undo_log_truncate),
+  MYSQL_SYSVAR(max_undo_log_size),
   MYSQL_SYSVAR(sync_array_size),
   MYSQL_SYSVAR(compression_failure_threshold_pct),
   MYSQL_SYSVAR(compression_pad_pct_max),
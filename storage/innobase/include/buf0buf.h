@@ -76,6 +76,11 @@ Created 11/5/1995 Heikki Tuuri
 					/*!< The maximum number of buffer
 					pools that can be defined */
 
+#define BUF_ACCESS_COUNT_SAMPLE	64	/*!< buf_page_get_gen() samples
+					about one in this many repeated
+					page accesses and adds this many to
+					buf_page_t::access_count for it */
+
 #define BUF_POOL_WATCH_SIZE		(srv_n_purge_threads + 1)
 					/*!< Maximum number of concurrent
 					buffer pool watches */
@@ -1038,6 +1043,15 @@ buf_page_set_accessed(
 	buf_page_t*	bpage)		/*!< in/out: control block */
 	MY_ATTRIBUTE((nonnull));
 /*********************************************************************//**
+Adds accesses to the access count of a block. */
+UNIV_INLINE
+void
+buf_page_inc_access_count(
+/*======================*/
+	buf_page_t*	bpage,		/*!< in/out: control block */
+	ulint		n)		/*!< in: number of accesses */
+	MY_ATTRIBUTE((nonnull));
+/*********************************************************************//**
 Gets the buf_block_t handle of a buffered file block if an uncompressed
 page frame exists, or NULL. Note: even though bpage is not declared a
 const we don't update its value. It is safe to make this pure.
@@ -1142,6 +1156,17 @@ buf_block_t*
 buf_block_align(
 /*============*/
 	const byte*	ptr);	/*!< in: pointer to a frame */
+/*******************************************************************//**
+Gets the block to whose frame a pointer found in the adaptive hash index
+is pointing to. Unlike buf_block_align(), this does not assume anything
+about the state of the block: as the adaptive hash index is searched
+without a latch, the block may have been freed or reused meanwhile.
+@return	pointer to block, never NULL */
+UNIV_INTERN
+buf_block_t*
+buf_block_from_ahi(
+/*===============*/
+	const byte*	ptr);	/*!< in: pointer to a frame */
 /********************************************************************//**
 Find out if a pointer belongs to a buf_block_t. It can be a pointer to
 the buf_block_t itself or a member of it
@@ -1633,6 +1658,20 @@ struct buf_page_t{
 					0 if the block was never accessed
 					in the buffer pool. Protected by
 					block mutex */
+	unsigned	access_count;	/*!< number of accesses to the
+					block since it was read into the
+					buffer pool, saturating. This is a
+					statistical estimate: the first
+					access and the optimistic gets count
+					one each, while the repeated accesses
+					in buf_page_get_gen() are sampled,
+					see BUF_ACCESS_COUNT_SAMPLE. Its
+					expected value is the number of
+					accesses, but a page accessed a few
+					dozen times may be off by a multiple
+					of BUF_ACCESS_COUNT_SAMPLE. Only used
+					for ordering buffer pool loads.
+					Protected by block mutex */
 	ibool		is_corrupt;
 # if defined UNIV_DEBUG_FILE_ACCESSES || defined UNIV_DEBUG
 	ibool		file_page_was_freed;
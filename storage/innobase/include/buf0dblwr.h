@@ -30,6 +30,7 @@ Created 2011/12/19 Inaam Rana
 #include "ut0byte.h"
 #include "log0log.h"
 #include "log0recv.h"
+#include "os0file.h"
 
 #ifndef UNIV_HOTBACKUP
 
@@ -89,9 +90,9 @@ buf_dblwr_page_inside(
 /*==================*/
 	ulint	page_no);	/*!< in: page number */
 /********************************************************************//**
-Posts a buffer page for writing. If the doublewrite memory buffer is
-full, calls buf_dblwr_flush_buffered_writes and waits for for free
-space to appear. */
+Posts a buffer page for writing to the doublewrite shard of its buffer
+pool instance and flush type. If the shard is full, calls
+buf_dblwr_flush_buffered_writes and waits for free space to appear. */
 UNIV_INTERN
 void
 buf_dblwr_add_to_batch(
@@ -105,8 +106,12 @@ and also when we may have to wait for a page latch! Otherwise a deadlock
 of threads can occur. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void);
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose shard to flush */
+	buf_flush_t		flush_type);	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 /********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
@@ -122,19 +127,42 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync);	/*!< in: true if sync IO requested */
 
-/** Doublewrite control struct */
-struct buf_dblwr_t{
-	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
-				field and write_buf */
-	ulint		block1;	/*!< the page number of the first
-				doublewrite block (64 pages) */
-	ulint		block2;	/*!< page number of the second block */
+/** Doublewrite shard. Batch flushes (LRU and flush list) of each buffer
+pool instance go through a shard of their own: a region of
+srv_doublewrite_batch_size pages in the parallel doublewrite file with
+its own write buffer and mutex, so that the flushes of different
+instances and flush types do not serialize on each other. */
+struct buf_dblwr_shard_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the first_free,
+				b_reserved and batch_running fields
+				and write_buf */
+	os_offset_t	offset;	/*!< byte offset of the shard in the
+				parallel doublewrite file */
 	ulint		first_free;/*!< first free position in write_buf
 				measured in units of UNIV_PAGE_SIZE */
 	ulint		b_reserved;/*!< number of slots currently reserved
 				for batch flush. */
 	os_event_t	b_event;/*!< event where threads wait for a
 				batch flush to end. */
+	bool		batch_running;/*!< set to TRUE if currently a batch
+				is being written from the shard. */
+	byte*		write_buf;/*!< write buffer used in writing to the
+				shard, aligned to an address divisible
+				by UNIV_PAGE_SIZE */
+	byte*		write_buf_unaligned;/*!< pointer to write_buf,
+				but unaligned */
+	buf_page_t**	buf_block_arr;/*!< array to store pointers to
+				the buffer blocks which have been
+				cached to write_buf */
+};
+
+/** Doublewrite control struct */
+struct buf_dblwr_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the single page
+				flush slots and write_buf */
+	ulint		block1;	/*!< the page number of the first
+				doublewrite block (64 pages) */
+	ulint		block2;	/*!< page number of the second block */
 	ulint		s_reserved;/*!< number of slots currently
 				reserved for single page flushes. */
 	os_event_t	s_event;/*!< event where threads wait for a
@@ -142,9 +170,6 @@ struct buf_dblwr_t{
 	bool*		in_use;	/*!< flag used to indicate if a slot is
 				in use. Only used for single page
 				flushes. */
-	bool		batch_running;/*!< set to TRUE if currently a batch
-				is being written from the doublewrite
-				buffer. */
 	byte*		write_buf;/*!< write buffer used in writing to the
 				doublewrite buffer, aligned to an
 				address divisible by UNIV_PAGE_SIZE
@@ -154,6 +179,11 @@ struct buf_dblwr_t{
 	buf_page_t**	buf_block_arr;/*!< array to store pointers to
 				the buffer blocks which have been
 				cached to write_buf */
+	pfs_os_file_t	shard_file;/*!< the parallel doublewrite file */
+	ulint		n_shards;/*!< number of shards, two per buffer
+				pool instance; 0 if the parallel
+				doublewrite file is not used */
+	buf_dblwr_shard_t* shards;/*!< array of n_shards shards */
 };
 
 
@@ -177,8 +177,16 @@ buf_flush_ready_for_replace(
 	buf_page_t*	bpage);	/*!< in: buffer control block, must be
 				buf_page_in_file(bpage) and in the LRU list */
 /******************************************************************//**
-page_cleaner thread tasked with flushing dirty pages from the buffer
-pool flush lists. As of now we'll have only one instance of this thread.
+Initialize the page cleaner coordinator state.  Must be called before the
+page cleaner coordinator and worker threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void);
+/*=============================*/
+/******************************************************************//**
+page_cleaner coordinator thread tasked with flushing dirty pages from the
+buffer pool flush lists. It decides how much to flush and splits the work
+between itself and the page cleaner worker threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -187,16 +195,26 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	void*	arg);		/*!< in: a dummy parameter required by
 				os_thread_create */
 /******************************************************************//**
+page_cleaner worker thread tasked with flushing the flush lists of the buffer
+pool instances owned by its slot on the page_cleaner coordinator requests.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg);		/*!< in: a pointer to the page cleaner
+				slot number */
+/******************************************************************//**
 lru_manager thread tasked with performing LRU flushes and evictions to refill
-the buffer pool free lists.  As of now we'll have only one instance of this
-thread.
+the free lists of the buffer pool instances owned by its page cleaner slot.
+There is one instance of this thread per page cleaner slot.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
 DECLARE_THREAD(buf_flush_lru_manager_thread)(
 /*=========================================*/
-	void*	arg);		/*!< in: a dummy parameter required by
-				os_thread_create */
+	void*	arg);		/*!< in: a pointer to the page cleaner
+				slot number */
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
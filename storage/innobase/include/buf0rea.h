@@ -54,7 +54,11 @@ ibool
 buf_read_page_async(
 /*================*/
 	ulint	space,	/*!< in: space id */
-	ulint	offset);/*!< in: page number */
+	ulint	offset,	/*!< in: page number */
+	bool	should_buffer);	/*!< in: whether to buffer the aio
+				request. The caller must submit the
+				buffered requests with
+				os_aio_dispatch_read_array_submit() */
 /********************************************************************//**
 Applies a random read-ahead in buf_pool if there are at least a threshold
 value of accessed pages from the random read-ahead area. Does not read any
@@ -1180,7 +1180,7 @@ struct dict_table_t{
 	const trx_t*	autoinc_trx;
 				/*!< The transaction that currently holds the
 				the AUTOINC lock on this table.
-				Protected by lock_sys->mutex. */
+				Protected by lock_sys->latch. */
 	fts_t*		fts;	/* FTS specific state variables */
 				/* @} */
 	/*----------------------*/
@@ -1196,7 +1196,10 @@ struct dict_table_t{
 				/*!< Count of the number of record locks on
 				this table. We use this to determine whether
 				we can evict the table from the dictionary
-				cache. It is protected by lock_sys->mutex. */
+				cache. It is protected by lock_sys->latch
+				and updated atomically, because record
+				locks can be created and discarded under
+				the s-latch. */
 	ulint		n_ref_count;
 				/*!< count of how many handles are opened
 				to this table; dropping of the table is
@@ -1205,7 +1208,7 @@ struct dict_table_t{
 				open handles at drop */
 	UT_LIST_BASE_NODE_T(lock_t)
 			locks;	/*!< list of locks on the table; protected
-				by lock_sys->mutex */
+				by lock_sys->latch */
 	ibool		is_corrupt;
 #endif /* !UNIV_HOTBACKUP */
 
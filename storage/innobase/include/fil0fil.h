@@ -470,6 +470,19 @@ fil_close_tablespace(
 	ulint	id);	/*!< in: space id */
 #ifndef UNIV_HOTBACKUP
 /*******************************************************************//**
+Truncates an undo tablespace to the given size. The pages of the
+tablespace are discarded from the buffer pool without writing them, and the
+data file is cut and zero-filled up to the new size. The caller must make
+sure that nobody accesses the tablespace meanwhile, and must create a new
+file space header afterwards.
+@return	DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+fil_truncate_undo_tablespace(
+/*=========================*/
+	ulint	id,	/*!< in: undo tablespace id */
+	ulint	size);	/*!< in: new size in pages */
+/*******************************************************************//**
 Discards a single-table tablespace. The tablespace must be cached in the
 memory cache. Discarding is like deleting a tablespace, but
 
@@ -32,6 +32,10 @@ Created 8/18/1994 Heikki Tuuri
 #include "page0types.h"
 #include "buf0types.h"
 #include "rem0types.h"
+#ifndef UNIV_HOTBACKUP
+# include "os0sync.h"
+# include "ut0counter.h"
+#endif /* !UNIV_HOTBACKUP */
 
 /*************************************************************//**
 Looks for an element in a hash table.
@@ -218,6 +222,52 @@ ha_print_info(
 /*==========*/
 	FILE*		file,	/*!< in: file where to print */
 	hash_table_t*	table);	/*!< in: hash table */
+/*************************************************************//**
+Allows searching a hash table without holding the latch which protects
+its modifications, see ha_read_enter(). Chain nodes removed from such a
+table are not freed or moved at once, but reused in batches when no
+reader can see them anymore. */
+UNIV_INTERN
+void
+ha_readers_create(
+/*==============*/
+	hash_table_t*	table);	/*!< in/out: hash table */
+/*************************************************************//**
+Frees the reader registration created by ha_readers_create(). */
+UNIV_INTERN
+void
+ha_readers_free(
+/*============*/
+	hash_table_t*	table);	/*!< in/out: hash table */
+/*************************************************************//**
+Removes all nodes from a hash table. If the table is searched without a
+latch, waits until no reader can see the removed nodes anymore, so that
+the caller can free the memory heap of the nodes. */
+UNIV_INTERN
+void
+ha_remove_all_nodes(
+/*================*/
+	hash_table_t*	table);	/*!< in/out: hash table */
+/*************************************************************//**
+Registers a reader which is going to search a hash table without
+holding its latch. Until the matching ha_read_exit(), the chain nodes
+which the reader may see are not freed or reused, and the data they
+point to is not freed either: it is up to the caller to validate the
+data when it needs more than the pointer itself.
+@return	ticket to pass to ha_read_exit() */
+UNIV_INLINE
+ulint
+ha_read_enter(
+/*==========*/
+	hash_table_t*	table);	/*!< in: hash table */
+/*************************************************************//**
+Unregisters a reader registered by ha_read_enter(). */
+UNIV_INLINE
+void
+ha_read_exit(
+/*=========*/
+	hash_table_t*	table,	/*!< in: hash table */
+	ulint		ticket);/*!< in: return value of ha_read_enter() */
 #endif /* !UNIV_HOTBACKUP */
 
 /** The hash table external chain node */
@@ -230,6 +280,53 @@ struct ha_node_t {
 	ulint		fold;	/*!< fold value for the data */
 };
 
+#ifndef UNIV_HOTBACKUP
+/** Number of slots over which the readers of a hash table that is
+searched without a latch are spread */
+#define HA_N_READER_SLOTS	32
+
+/** Number of chain nodes removed from a hash table searched without a
+latch which are collected before they are reclaimed for reuse */
+#define HA_RECLAIM_BATCH	256
+
+/** Reader slot of a hash table searched without a latch. A reader
+increments one of the two counters when it starts and decrements it when
+it is done; which counter is chosen by the parity of ha_readers_t::epoch
+when the reader starts. */
+struct ha_reader_slot_t {
+	volatile ulint	n_readers[2];	/*!< number of active readers */
+	byte		pad[CACHE_LINE_SIZE - 2 * sizeof(ulint)];
+					/*!< keep the slots on separate
+					cache lines */
+};
+
+/** The readers of a hash table searched without a latch, and the nodes
+which may still be seen by them. The fields other than the counters are
+protected by the latch which protects the modifications of the table. */
+struct ha_readers_t {
+	byte		pad1[CACHE_LINE_SIZE];
+					/*!< padding against false sharing */
+	volatile ulint	epoch;		/*!< incremented before waiting for
+					the readers which started before; its
+					parity selects the counter of a slot
+					which new readers increment */
+	byte		pad2[CACHE_LINE_SIZE];
+					/*!< padding against false sharing */
+	ha_reader_slot_t slots[HA_N_READER_SLOTS];
+					/*!< reader slots, chosen by the cpu
+					or the thread of the reader */
+	ha_node_t*	removed[HA_RECLAIM_BATCH];
+					/*!< nodes removed from their chains
+					which readers may still see */
+	ulint		n_removed;	/*!< number of nodes in removed */
+	ha_node_t*	free_nodes;	/*!< reclaimed nodes which are free
+					for reuse, linked through next */
+#ifndef HAVE_ATOMIC_BUILTINS
+	os_fast_mutex_t	mutex;		/*!< protects epoch and slots */
+#endif /* !HAVE_ATOMIC_BUILTINS */
+};
+#endif /* !UNIV_HOTBACKUP */
+
 #ifdef UNIV_DEBUG
 /********************************************************************//**
 Assert that the synchronization object in a hash operation involving
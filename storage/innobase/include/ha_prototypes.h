@@ -132,6 +132,18 @@ thd_is_replication_slave_thread(
 /*============================*/
 	THD*	thd);	/*!< in: thread handle */
 
+/******************************************************************//**
+Reports that the transaction of a thread waits for a row lock held by the
+transaction of another thread. A replication slave preserving the commit
+order uses this to find a group which holds a lock that a preceding group
+waits for. */
+UNIV_INTERN
+void
+thd_report_wait_for(
+/*================*/
+	THD*	thd,		/*!< in: thread handle of the waiting trx */
+	THD*	other_thd);	/*!< in: thread handle of the lock holder */
+
 /******************************************************************//**
 Gets information on the durability property requested by thread.
 Used when writing either a prepare or commit record to the log
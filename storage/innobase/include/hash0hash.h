@@ -35,6 +35,7 @@ Created 5/20/1997 Heikki Tuuri
 
 struct hash_table_t;
 struct hash_cell_t;
+struct ha_readers_t;
 
 typedef void*	hash_node_t;
 
@@ -561,6 +562,9 @@ struct hash_table_t {
 					can be allocated from these memory
 					heaps; there are then n_mutexes
 					many of these heaps */
+	ha_readers_t*		readers;/*!< if this is non-NULL, the
+					table is searched without a latch,
+					see ha_readers_create() */
 #endif /* !UNIV_HOTBACKUP */
 	mem_heap_t*		heap;
 #ifdef UNIV_DEBUG
@@ -36,6 +36,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "lock0types.h"
 #include "read0types.h"
 #include "hash0hash.h"
+#include "sync0rw.h"
 #include "srv0srv.h"
 #include "ut0vec.h"
 
@@ -543,6 +544,14 @@ lock_rec_hash(
 /*==========*/
 	ulint	space,	/*!< in: space */
 	ulint	page_no);/*!< in: page number */
+/*********************************************************************//**
+Gets the mutex protecting a cell of the record lock hash table.
+@return	mutex of the lock_sys->rec_hash cell */
+UNIV_INLINE
+ib_mutex_t*
+lock_rec_hash_get_mutex(
+/*====================*/
+	ulint	hash);	/*!< in: hash value from lock_rec_hash() */
 
 /**********************************************************************//**
 Looks for a set bit in a record lock bitmap. Returns ULINT_UNDEFINED,
@@ -647,7 +656,7 @@ lock_print_info_all_transactions(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys->mutex. */
+The caller must be holding lock_sys->latch. */
 UNIV_INTERN
 ulint
 lock_number_of_rows_locked(
@@ -919,13 +928,29 @@ struct lock_op_t{
 	enum lock_mode	mode;	/*!< lock mode */
 };
 
+/** Number of mutexes protecting the cells of lock_sys->rec_hash;
+must be a power of 2 */
+#define LOCK_REC_HASH_N_MUTEXES	256
+
 /** The lock system struct */
 struct lock_sys_t{
-	ib_mutex_t	mutex;			/*!< Mutex protecting the
-						locks */
+	rw_lock_t	latch;			/*!< Latch protecting the
+						locks. An x-latch protects
+						all of the lock system. An
+						s-latch together with the
+						rec_mutexes[] entry of a
+						rec_hash cell protects the
+						record locks in that cell */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
-	ulint		rec_num;
+	ib_mutex_t*	rec_mutexes;		/*!< Mutexes protecting the
+						cells of rec_hash under an
+						s-latch on lock_sys->latch;
+						cell i is protected by
+						rec_mutexes[i %
+						LOCK_REC_HASH_N_MUTEXES] */
+	ulint		rec_num;		/*!< number of record locks;
+						updated atomically */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -940,7 +965,7 @@ struct lock_sys_t{
 						/*!< TRUE if rollback of all
 						recovered transactions is
 						complete. Protected by
-						lock_sys->mutex */
+						lock_sys->latch */
 
 	ulint		n_lock_max_wait_time;	/*!< Max wait time */
 
@@ -956,22 +981,49 @@ struct lock_sys_t{
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
+/** Test if lock_sys->latch can be x-latched without waiting.
+@return 0 if the latch was acquired */
+#define lock_mutex_enter_nowait()				\
+	(!rw_lock_x_lock_nowait(&lock_sys->latch))
 
-/** Test if lock_sys->mutex is owned. */
-#define lock_mutex_own() mutex_own(&lock_sys->mutex)
+/** Test if lock_sys->latch is x-latched by the current thread. */
+#define lock_mutex_own()					\
+	(rw_lock_get_writer(&lock_sys->latch) == RW_LOCK_EX	\
+	 && os_thread_eq(lock_sys->latch.writer_thread,		\
+			 os_thread_get_curr_id()))
 
-/** Acquire the lock_sys->mutex. */
+/** Acquire the lock_sys->latch in exclusive mode. */
 #define lock_mutex_enter() do {			\
-	mutex_enter(&lock_sys->mutex);		\
+	rw_lock_x_lock(&lock_sys->latch);	\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release the exclusive lock_sys->latch. */
 #define lock_mutex_exit() do {			\
-	mutex_exit(&lock_sys->mutex);		\
+	rw_lock_x_unlock(&lock_sys->latch);	\
 } while (0)
 
+/** Acquire the lock_sys->latch in shared mode. Record locks may then be
+accessed only while also holding the mutex of their rec_hash cell. */
+#define lock_sys_s_enter() do {			\
+	rw_lock_s_lock(&lock_sys->latch);	\
+} while (0)
+
+/** Release the shared lock_sys->latch. */
+#define lock_sys_s_exit() do {			\
+	rw_lock_s_unlock(&lock_sys->latch);	\
+} while (0)
+
+/** Test if the mutex of a lock_sys->rec_hash cell is owned. */
+#define lock_rec_hash_own(hash)					\
+	mutex_own(lock_rec_hash_get_mutex(hash))
+
+/** Test if the locks on a page can be accessed by the current thread,
+that is, either lock_sys->latch is x-latched or the rec_hash cell of the
+page is protected by its mutex. */
+#define lock_rec_page_own(space, page_no)			\
+	(lock_mutex_own()					\
+	 || lock_rec_hash_own(lock_rec_hash(space, page_no)))
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() mutex_own(&lock_sys->wait_mutex)
 
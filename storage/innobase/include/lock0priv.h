@@ -58,7 +58,8 @@ struct lock_rec_t {
 					lock struct */
 };
 
-/** Lock struct; protected by lock_sys->mutex */
+/** Lock struct; protected by lock_sys->latch, record locks also by
+the mutex of their lock_sys->rec_hash cell */
 struct lock_t {
 	trx_t*		trx;		/*!< transaction owning the
 					lock */
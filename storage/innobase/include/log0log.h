@@ -71,11 +71,20 @@ typedef ulint (*log_checksum_func_t)(const byte* log_block);
 log_sys->mutex. */
 extern log_checksum_func_t log_checksum_algorithm_ptr;
 
+/** Maximum number of log blocks whose CRC32 checksums are calculated in
+one batch, see log_blocks_calc_checksums_crc32() */
+#define LOG_CHECKSUM_BATCH	48
+
 /** Wait modes for log_write_up_to @{ */
 #define LOG_NO_WAIT		91
 #define LOG_WAIT_ONE_GROUP	92
 #define	LOG_WAIT_ALL_GROUPS	93
 /* @} */
+/** Number of events in each of log_sys->write_events and
+log_sys->flush_events on which threads wait for the dedicated log writer
+and log flusher threads; the event is picked by the log block number of
+the lsn waited for */
+#define LOG_N_WAIT_EVENTS	1024
 /** Maximum number of log groups in log_group_t::checkpoint_buf */
 #define LOG_MAX_N_GROUPS	32
 
@@ -229,6 +238,43 @@ log_write_up_to(
 	ibool	flush_to_disk);
 			/*!< in: TRUE if we want the written log
 			also to be flushed to disk */
+/******************************************************************//**
+Starts the dedicated log writer and log flusher threads which take over the
+log file writes and fsyncs from log_write_up_to() callers. Called at
+startup when innodb_log_writer_threads is set. */
+UNIV_INTERN
+void
+log_writer_threads_start(void);
+/*==========================*/
+/******************************************************************//**
+Stops the dedicated log writer and log flusher threads and waits for them
+to exit. After this the log writes are done again by the threads calling
+log_write_up_to(). */
+UNIV_INTERN
+void
+log_writer_threads_stop(void);
+/*=========================*/
+/******************************************************************//**
+log_writer thread which writes the log buffer to the log files on behalf of
+the threads waiting in log_write_up_to().
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg);		/*!< in: a dummy parameter required by
+				os_thread_create */
+/******************************************************************//**
+log_flusher thread which flushes the written log to disk on behalf of the
+threads waiting in log_write_up_to(). One fsync releases all the threads
+which have committed up to the flushed lsn.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg);		/*!< in: a dummy parameter required by
+				os_thread_create */
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -912,6 +958,45 @@ struct log_t{
 					but NOTE that to set or reset this
 					event, the thread MUST own the log
 					mutex! */
+	/** Fields of the dedicated log writer and log flusher threads
+	(innodb_log_writer_threads) @{ */
+	volatile bool	writer_threads_active;
+					/*!< true while the log writer and
+					log flusher threads do the log file
+					i/o; log_write_up_to() then waits for
+					them instead of writing itself */
+	volatile bool	writer_threads_stop;
+					/*!< set by log_writer_threads_stop()
+					to make the threads exit */
+	ulint		n_writer_threads;/*!< number of running log writer
+					and log flusher threads; protected
+					by mutex */
+	os_event_t	writer_event;	/*!< set to wake up the log writer
+					thread when there is log to write */
+	os_event_t	flusher_event;	/*!< set to wake up the log flusher
+					thread when there is log to flush */
+	lsn_t		flush_requested_lsn;
+					/*!< highest lsn which a thread has
+					asked the log flusher to flush to
+					disk; the log flusher flushes all the
+					written log after every write anyway
+					when innodb_flush_log_at_trx_commit=1.
+					Protected by mutex */
+	os_event_t*	write_events;	/*!< LOG_N_WAIT_EVENTS events set by
+					the log writer when written_to_all_lsn
+					advances over the log blocks mapped
+					to them; NULL if the threads are not
+					used */
+	os_event_t*	flush_events;	/*!< LOG_N_WAIT_EVENTS events set when
+					flushed_to_disk_lsn advances over the
+					log blocks mapped to them; NULL if the
+					threads are not used */
+	ulint		n_flush_waits;	/*!< number of log_write_up_to() calls
+					which had to wait for a log flush;
+					updated atomically */
+	ulint		n_flusher_fsyncs;/*!< number of fsyncs done by the log
+					flusher thread */
+	/* @} */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
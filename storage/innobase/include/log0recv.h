@@ -379,9 +379,11 @@ struct recv_dblwr_t {
 
 	std::list<byte *> pages; /* Pages from double write buffer */
 
-	void operator() () {
-		pages.clear();
-	}
+	std::list<byte *> bufs;	/* Memory holding the pages read from
+				the parallel doublewrite file, freed
+				together with the page list */
+
+	void operator() ();
 };
 
 /** Recovery system data structure */
@@ -502,6 +504,16 @@ use these free frames to read in pages when we start applying the
 log records to the database. */
 extern ulint	recv_n_pool_free_frames;
 
+/** Number of pages to which redo log records have been applied during
+crash recovery */
+extern ulint	recv_n_pages_applied;
+/** Total length of the redo log records that have been applied to pages
+during crash recovery, in bytes */
+extern ulint	recv_n_bytes_applied;
+/** Time spent in redo log record application batches during crash
+recovery, in microseconds */
+extern ib_uint64_t	recv_apply_time_us;
+
 #ifndef UNIV_NONINL
 #include "log0recv.ic"
 #endif
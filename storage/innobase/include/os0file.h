@@ -72,6 +72,12 @@ extern ulint	os_n_pending_writes;
 
 #endif
 
+#if defined(LINUX_NATIVE_AIO) || defined(LINUX_IO_URING)
+/** Linux native aio is done through libaio or io_uring. Which one is
+used is decided at run-time, see srv_use_io_uring. */
+#define LINUX_ASYNC_IO
+#endif
+
 /** File offset in bytes */
 typedef ib_uint64_t os_offset_t;
 #ifdef __WIN__
@@ -1542,7 +1548,7 @@ innobase_mysql_tmpfile(
 #endif /* !UNIV_HOTBACKUP */
 
 
-#if defined(LINUX_NATIVE_AIO)
+#if defined(LINUX_ASYNC_IO)
 /**************************************************************************
 This function is only used in Linux native asynchronous i/o.
 Waits for an aio operation to complete. This function is used to wait the
@@ -1568,13 +1574,37 @@ os_aio_linux_handle(
 				restart the operation. */
 	ulint*	type,		/*!< out: OS_FILE_WRITE or ..._READ */
 	ulint*	space_id);
-#endif /* LINUX_NATIVE_AIO */
+#endif /* LINUX_ASYNC_IO */
 
 /** Submit buffered AIO requests on the given segment to the kernel. */
 UNIV_INTERN
 void
 os_aio_dispatch_read_array_submit();
 
+/***********************************************************************//**
+Registers memory areas, normally the buffer pool chunks, as fixed buffers
+with the io_uring instances of the aio arrays. Must be called once after
+os_aio_init() and before any asynchronous i/o on the areas is posted. Does
+nothing unless io_uring is used. */
+UNIV_INTERN
+void
+os_aio_register_buffers(
+/*====================*/
+	void* const*	mem,	/*!< in: start addresses of the areas */
+	const ulint*	size,	/*!< in: sizes of the areas in bytes */
+	ulint		n);	/*!< in: number of areas */
+
+/***********************************************************************//**
+Flushes the write buffers of a set of files to the disk. With io_uring the
+fsync requests of all the files are in flight at the same time, otherwise
+the files are flushed one by one with os_file_flush(). */
+UNIV_INTERN
+void
+os_file_flush_files(
+/*================*/
+	pfs_os_file_t*	files,	/*!< in: files to flush */
+	ulint		n);	/*!< in: number of files */
+
 #ifndef UNIV_NONINL
 #include "os0file.ic"
 #endif
@@ -93,6 +93,25 @@ read_view_remove(
 	bool		own_mutex);	/*!< in: true if caller owns the
 					trx_sys_t::mutex */
 /*********************************************************************//**
+Closes a read view without removing it from the trx_sys->view_list. The
+view is ignored by purge and can be reopened by read_view_open_now() without
+acquiring trx_sys->mutex if no read-write transaction has started or
+finished since it was created. */
+UNIV_INLINE
+void
+read_view_close_lazy(
+/*=================*/
+	read_view_t*	view);		/*!< in: read view, can be 0 */
+/*********************************************************************//**
+Returns the oldest read view in the trx_sys->view_list which has not been
+closed by read_view_close_lazy(). The closed views which can not be reopened
+any more are removed from the list on the way, so that they are skipped once.
+@return oldest open read view or NULL */
+UNIV_INLINE
+read_view_t*
+read_view_get_oldest(void);
+/*======================*/
+/*********************************************************************//**
 Frees memory allocated by a read view. */
 UNIV_INTERN
 void
@@ -195,6 +214,14 @@ struct read_view_t{
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
+	ulint		descr_version;
+				/*!< Value of trx_sys->descr_version when
+				the view was opened */
+	volatile ulint	state;	/*!< VIEW_OPEN, VIEW_CLOSED or
+				VIEW_UNLINKED. Only changed by the thread
+				owning the view, except for VIEW_CLOSED to
+				VIEW_UNLINKED which is done under
+				trx_sys->mutex by read_view_get_oldest() */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
 };
@@ -211,6 +238,16 @@ struct read_view_t{
 					read view was created. */
 /* @} */
 
+/** Read view states @{ */
+#define VIEW_OPEN		0	/*!< Open read view, in the
+					trx_sys->view_list */
+#define VIEW_CLOSED		1	/*!< Closed by read_view_close_lazy(),
+					still in the trx_sys->view_list */
+#define VIEW_UNLINKED		2	/*!< Closed and out of date: removed
+					from the trx_sys->view_list, it has to
+					be rebuilt under trx_sys->mutex */
+/* @} */
+
 /** Implement InnoDB framework to support consistent read views in
 cursors. This struct holds both heap where consistent read view
 is allocated and pointer to a read view. */
@@ -372,7 +372,10 @@ row_merge_sort(
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	int*			tmpfd)	/*!< in/out: temporary file handle */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint			n_threads)/*!< in: number of threads
+					merging the runs of each pass,
+					1 for none */
 	MY_ATTRIBUTE((nonnull));
 /*********************************************************************//**
 Allocate a sort buffer.
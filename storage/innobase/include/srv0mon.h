@@ -191,12 +191,16 @@ enum monitor_id_t {
 	MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 	MONITOR_FLUSH_BACKGROUND_COUNT,
 	MONITOR_FLUSH_BACKGROUND_PAGES,
+	MONITOR_FLUSH_WORKER_TIME,
+	MONITOR_FLUSH_WORKER_MAX_TIME,
+	MONITOR_FLUSH_COORDINATOR_WAIT_TIME,
 	MONITOR_LRU_BATCH_SCANNED,
 	MONITOR_LRU_BATCH_SCANNED_NUM_CALL,
 	MONITOR_LRU_BATCH_SCANNED_PER_CALL,
 	MONITOR_LRU_BATCH_TOTAL_PAGE,
 	MONITOR_LRU_BATCH_COUNT,
 	MONITOR_LRU_BATCH_PAGES,
+	MONITOR_LRU_WORKER_TIME,
 	MONITOR_LRU_SINGLE_FLUSH_SCANNED,
 	MONITOR_LRU_SINGLE_FLUSH_SCANNED_NUM_CALL,
 	MONITOR_LRU_SINGLE_FLUSH_SCANNED_PER_CALL,
@@ -261,6 +265,7 @@ enum monitor_id_t {
 	MONITOR_TRX_RW_COMMIT,
 	MONITOR_TRX_RO_COMMIT,
 	MONITOR_TRX_NL_RO_COMMIT,
+	MONITOR_TRX_READ_VIEW_REUSE,
 	MONITOR_TRX_COMMIT_UNDO,
 	MONITOR_TRX_ROLLBACK,
 	MONITOR_TRX_ROLLBACK_SAVEPOINT,
@@ -297,6 +302,10 @@ enum monitor_id_t {
 	MONITOR_OVLD_LOG_WAITS,
 	MONITOR_OVLD_LOG_WRITE_REQUEST,
 	MONITOR_OVLD_LOG_WRITES,
+	MONITOR_LOG_FLUSHER_FSYNCS,
+	MONITOR_LOG_FLUSHER_WAITS,
+	MONITOR_LOG_FLUSHER_AVG_GROUP_SIZE,
+	MONITOR_LOG_WAIT_SPIN_HITS,
 
 	/* Page Manager related counters */
 	MONITOR_MODULE_PAGE,
@@ -238,6 +238,9 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Number of threads sorting and loading secondary indexes, or merging
+the runs of one secondary index, in parallel in index creation */
+extern ulong	srv_sort_threads;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -246,6 +249,9 @@ OS (provided we compiled Innobase with it in), otherwise we will
 use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 extern my_bool	srv_use_native_aio;
+/* If this flag is TRUE and native aio is used on Linux, then the
+asynchronous i/o is submitted through io_uring instead of libaio */
+extern my_bool	srv_use_io_uring;
 extern my_bool	srv_numa_interleave;
 #ifdef __WIN__
 extern ibool	srv_use_native_conditions;
@@ -264,6 +270,13 @@ extern ulint	srv_undo_tablespaces_open;
 /* The number of undo segments to use */
 extern ulong	srv_undo_logs;
 
+/** Whether undo tablespaces larger than srv_max_undo_log_size are
+truncated by purge. */
+extern my_bool	srv_undo_log_truncate;
+
+/** Size in bytes above which an undo tablespace is truncated. */
+extern ulonglong	srv_max_undo_log_size;
+
 extern ulint	srv_n_data_files;
 extern char**	srv_data_file_names;
 extern ulint*	srv_data_file_sizes;
@@ -328,6 +341,20 @@ extern ulint	srv_lock_table_size;
 
 extern ulint	srv_foreground_preflush;/*!< Query thread preflush algorithm */
 
+extern ulong	srv_n_page_cleaners;	/*!< number of page cleaner and
+					LRU manager threads */
+
+extern ulong	srv_n_recv_apply_threads;/*!< number of threads applying
+					redo log records in crash recovery */
+
+extern my_bool	srv_log_writer_threads;	/*!< whether the log is written and
+					flushed by the dedicated log writer
+					and log flusher threads */
+
+extern ulong	srv_log_wait_spin_rounds;/*!< number of rounds a thread spins
+					waiting for the log writer or log
+					flusher thread before it sleeps */
+
 extern ulint	srv_cleaner_max_lru_time;/*!< the maximum time limit for a
 					single LRU tail flush iteration by the
 					page cleaner thread */
@@ -426,6 +453,7 @@ extern my_bool			srv_stats_auto_recalc;
 extern my_bool			srv_stats_include_delete_marked;
 
 extern ibool	srv_use_doublewrite_buf;
+extern char*	srv_parallel_doublewrite_path;
 extern ulong	srv_doublewrite_batch_size;
 extern ibool	srv_use_atomic_writes;
 #ifdef HAVE_POSIX_FALLOCATE
@@ -493,6 +521,11 @@ extern ibool	srv_priority_boost;
 extern ulint	srv_truncated_status_writes;
 extern ulint	srv_available_undo_logs;
 
+/** Number of undo tablespace truncations */
+extern ulint		srv_undo_truncations;
+/** Bytes reclaimed by undo tablespace truncations */
+extern ib_uint64_t	srv_undo_truncated_bytes;
+
 extern ulint	srv_column_compressed;
 extern ulint	srv_column_decompressed;
 
@@ -535,16 +568,22 @@ extern ib_mutex_t	server_mutex;
 
 #define SRV_MAX_N_PURGE_THREADS 32
 
+/** Maximum number of page cleaner threads, equal to MAX_BUFFER_POOLS */
+#define SRV_MAX_N_PAGE_CLEANERS 64
+
+/** Maximum number of threads applying redo log records in crash recovery */
+#define SRV_MAX_N_RECV_APPLY_THREADS 64
+
 /* Array of English strings describing the current state of an
 i/o handler thread */
 extern const char* srv_io_thread_op_info[];
 extern const char* srv_io_thread_function[];
 
-/* The tid of the cleaner thread */
-extern os_tid_t	srv_cleaner_tid;
+/* The tids of the page cleaner coordinator (0) and worker threads */
+extern os_tid_t	srv_cleaner_tids[];
 
-/* The tid of the LRU manager thread */
-extern os_tid_t srv_lru_manager_tid;
+/* The tids of the LRU manager threads */
+extern os_tid_t srv_lru_manager_tids[];
 
 /* The tids of the purge threads */
 extern os_tid_t srv_purge_tids[];
@@ -585,6 +624,9 @@ extern ulong srv_n_purge_threads;
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* purge truncates the history of the rollback segments on every Nth batch */
+extern ulong srv_purge_rseg_truncate_frequency;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
@@ -624,6 +666,9 @@ extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
 extern mysql_pfs_key_t	srv_log_tracking_thread_key;
 
 /* This macro register the current thread and its key with performance
@@ -1087,9 +1132,15 @@ struct export_var_t{
 	ulint innodb_rows_inserted;		/*!< srv_n_rows_inserted */
 	ulint innodb_rows_updated;		/*!< srv_n_rows_updated */
 	ulint innodb_rows_deleted;		/*!< srv_n_rows_deleted */
+	ulint innodb_recovery_pages_applied;	/*!< recv_n_pages_applied */
+	ulint innodb_recovery_bytes_applied;	/*!< recv_n_bytes_applied */
+	ulint innodb_recovery_apply_time;	/*!< recv_apply_time_us
+						/ 1000 */
 	ulint innodb_num_open_files;		/*!< fil_n_file_opened */
 	ulint innodb_truncated_status_writes;	/*!< srv_truncated_status_writes */
 	ulint innodb_available_undo_logs;       /*!< srv_available_undo_logs */
+	ulint innodb_undo_truncations;		/*!< srv_undo_truncations */
+	ib_int64_t innodb_undo_truncated_bytes;	/*!< srv_undo_truncated_bytes */
 	ulint innodb_read_views_memory;		/*!< srv_read_views_memory */
 	ulint innodb_descriptors_memory;	/*!< srv_descriptors_memory */
 	ib_int64_t innodb_s_lock_os_waits;
@@ -1143,6 +1194,7 @@ struct srv_slot_t{
 #else /* !UNIV_HOTBACKUP */
 # define srv_use_adaptive_hash_indexes		FALSE
 # define srv_use_native_aio			FALSE
+# define srv_use_io_uring			FALSE
 # define srv_numa_interleave			FALSE
 # define srv_force_recovery			0UL
 # define srv_set_io_thread_op_info(t,info)	((void) 0)
@@ -142,6 +142,9 @@ extern	ibool	srv_start_raw_disk_in_use;
 /** Undo tablespaces starts with space_id. */
 extern	ulint	srv_undo_space_id_start;
 
+/** Default undo tablespace size in UNIV_PAGEs count (10MB). */
+extern	const ulint	SRV_UNDO_TABLESPACE_SIZE_IN_PAGES;
+
 /** Shutdown state */
 enum srv_shutdown_state {
 	SRV_SHUTDOWN_NONE = 0,	/*!< Database running normally */
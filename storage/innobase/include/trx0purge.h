@@ -90,6 +90,58 @@ trx_purge(
 	ulint	limit,			/*!< in: the maximum number of
 					records to purge in one batch */
 	bool	truncate);		/*!< in: truncate history if true */
+/********************************************************************//**
+Truncates the undo tablespaces that have grown too large. An undo
+tablespace larger than innodb_max_undo_log_size is first marked, so that
+no new transactions use it, and truncated once purge has freed all its
+undo logs. Does nothing unless innodb_undo_log_truncate is set. */
+UNIV_INTERN
+void
+trx_purge_truncate_undo_tablespaces(void);
+/*=====================================*/
+/********************************************************************//**
+Checks whether an undo tablespace is being drained for truncation.
+@return	true if an undo tablespace is marked for truncation */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_is_pending(void);
+/*====================================*/
+/********************************************************************//**
+Checks at startup whether the truncation of an undo tablespace was
+interrupted. Such a tablespace is recreated empty before the redo log is
+applied, and its redo log records are skipped.
+@return	true if the undo tablespace must be recreated */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_was_interrupted(
+/*====================================*/
+	ulint	space_id);	/*!< in: undo tablespace id */
+/********************************************************************//**
+Checks whether the redo log records of a tablespace must be skipped
+because the tablespace is an undo tablespace whose interrupted truncation
+is completed at startup.
+@return	true if the tablespace is recreated at startup */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_is_recreated(
+/*=================================*/
+	ulint	space_id);	/*!< in: tablespace id */
+/********************************************************************//**
+Rebuilds the file space and rollback segment headers of the undo
+tablespaces whose truncation was interrupted. Must be called after the
+redo log scan and before the rollback segments are loaded. */
+UNIV_INTERN
+void
+trx_purge_undo_truncate_recover(void);
+/*=================================*/
+/********************************************************************//**
+Finishes the recovery of interrupted undo tablespace truncations by making
+the rebuilt tablespaces durable and removing their marker files. Must be
+called after the redo log has been applied. */
+UNIV_INTERN
+void
+trx_purge_undo_truncate_recover_finish(void);
+/*========================================*/
 /*******************************************************************//**
 Stop purge and wait for it to stop, move to PURGE_STATE_STOP. */
 UNIV_INTERN
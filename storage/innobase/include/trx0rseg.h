@@ -124,6 +124,20 @@ trx_rseg_mem_free(
 /*==============*/
 	trx_rseg_t*	rseg);		/*!< in, own: instance to free */
 
+/*********************************************************************//**
+Reinitializes an undo tablespace that has been truncated to the given size:
+writes a new file space header and recreates the headers of the rollback
+segments that the trx system header places in the tablespace. The memory
+objects of those rollback segments, if they exist already, are reset to
+match. Purge must have processed all the undo logs of the rollback
+segments: the logs still in their history lists are discarded. */
+UNIV_INTERN
+void
+trx_rseg_undo_tablespace_reinit(
+/*============================*/
+	ulint	space,		/*!< in: undo tablespace id */
+	ulint	size);		/*!< in: size of the tablespace in pages */
+
 /*********************************************************************
 Creates a rollback segment. */
 UNIV_INTERN
@@ -189,6 +203,13 @@ struct trx_rseg_t{
 					yet purged log */
 	ibool		last_del_marks;	/*!< TRUE if the last not yet purged log
 					needs purging */
+	/*--------------------------------------------------------*/
+	ulint		trx_ref_count;	/*!< number of transactions that have
+					been assigned this rollback segment */
+	bool		skip_allocation;/*!< true if the undo tablespace of
+					this rollback segment is going to be
+					truncated: no new transactions are
+					assigned to it */
 };
 
 /** For prioritising the rollback segments for purge. */
@@ -224,7 +224,7 @@ trx_read_trx_id(
 Looks for the trx instance with the given id in the rw trx_list.
 The caller must be holding trx_sys->mutex.
 @return	the trx handle or NULL if not found;
-the pointer must not be dereferenced unless lock_sys->mutex was
+the pointer must not be dereferenced unless lock_sys->latch was
 acquired before calling this function and is still being held */
 UNIV_INLINE
 trx_t*
@@ -244,9 +244,9 @@ trx_rw_min_trx_id(void);
 /****************************************************************//**
 Returns pointer to a transaction instance if a rw transaction with the given id
 is active. Caller must hold trx_sys->mutex. If the caller is not holding
-lock_sys->mutex, the transaction may already have been committed.
+lock_sys->latch, the transaction may already have been committed.
 @return transaction instance if active, or NULL;
-the pointer must not be dereferenced unless lock_sys->mutex was
+the pointer must not be dereferenced unless lock_sys->latch was
 acquired before calling this function and is still being held */
 UNIV_INLINE
 trx_t*
@@ -257,7 +257,7 @@ trx_rw_get_active_trx_by_id(
 					that will be set if corrupt */
 /****************************************************************//**
 Checks if a rw transaction with the given id is active. Caller must hold
-trx_sys->mutex. If the caller is not holding lock_sys->mutex, the
+trx_sys->mutex. If the caller is not holding lock_sys->latch, the
 transaction may already have been committed.
 @return	true if rw transaction it with a given id is active. */
 UNIV_INLINE
@@ -269,7 +269,7 @@ trx_rw_is_active_low(
 					that will be set if corrupt */
 /****************************************************************//**
 Checks if a rw transaction with the given id is active. If the caller is
-not holding lock_sys->mutex, the transaction may already have been
+not holding lock_sys->latch, the transaction may already have been
 committed.
 @return	true if rw transaction it with a given id is active. */
 UNIV_INLINE
@@ -651,6 +651,13 @@ struct trx_sys_t{
 					descr_n_used */
 	ulint		descr_n_used;	/*!< Number of used elements in the
 					descriptors array. */
+	ulint		descr_version;	/*!< Incremented each time a
+					descriptor is reserved or released,
+					i.e. each time a read-write
+					transaction starts or finishes.
+					Modified under the mutex, can be read
+					without it to check if a closed read
+					view is still up to date */
 	char		pad3[64];	/*!< Ensure descriptors do not share
 					cache line with other fields */
 #ifdef UNIV_DEBUG
@@ -383,9 +383,14 @@ static lock_stack_t*	lock_stack;
 static const ulint	lock_types = UT_ARR_SIZE(lock_compatibility_matrix);
 #endif /* UNIV_DEBUG */
 
+#ifdef UNIV_PFS_RWLOCK
+/* Key to register rw-lock with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_latch_key;
+#endif /* UNIV_PFS_RWLOCK */
+
 #ifdef UNIV_PFS_MUTEX
 /* Key to register mutex with performance schema */
-UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	lock_sys_rec_mutex_key;
 /* Key to register mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
@@ -608,7 +613,7 @@ lock_sys_create(
 
 	lock_sys->last_slot = lock_sys->waiting_threads;
 
-	mutex_create(lock_sys_mutex_key, &lock_sys->mutex, SYNC_LOCK_SYS);
+	rw_lock_create(lock_sys_latch_key, &lock_sys->latch, SYNC_LOCK_SYS);
 
 	mutex_create(lock_sys_wait_mutex_key,
 		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
@@ -618,6 +623,14 @@ lock_sys_create(
 	lock_sys->rec_hash = hash_create(n_cells);
 	lock_sys->rec_num = 0;
 
+	lock_sys->rec_mutexes = static_cast<ib_mutex_t*>(
+		mem_zalloc(LOCK_REC_HASH_N_MUTEXES * sizeof(ib_mutex_t)));
+
+	for (ulint i = 0; i < LOCK_REC_HASH_N_MUTEXES; i++) {
+		mutex_create(lock_sys_rec_mutex_key,
+			     &lock_sys->rec_mutexes[i], SYNC_LOCK_REC_HASH);
+	}
+
 	if (!srv_read_only_mode) {
 		lock_latest_err_file = os_file_create_tmpfile(NULL);
 		ut_a(lock_latest_err_file);
@@ -638,7 +651,13 @@ lock_sys_close(void)
 
 	hash_table_free(lock_sys->rec_hash);
 
-	mutex_free(&lock_sys->mutex);
+	for (ulint i = 0; i < LOCK_REC_HASH_N_MUTEXES; i++) {
+		mutex_free(&lock_sys->rec_mutexes[i]);
+	}
+
+	mem_free(lock_sys->rec_mutexes);
+
+	rw_lock_free(&lock_sys->latch);
 	mutex_free(&lock_sys->wait_mutex);
 
 	os_event_free(lock_sys->timeout_event);
@@ -725,7 +744,7 @@ lock_get_src_table(
 	Other transactions could want to convert one of our implicit
 	record locks to an explicit one. For that, they would need our
 	trx mutex. Waiting locks can be removed while only holding
-	lock_sys->mutex, but this is a running transaction and cannot
+	lock_sys->latch, but this is a running transaction and cannot
 	thus be holding any waiting locks. */
 	trx_mutex_enter(trx);
 
@@ -1166,12 +1185,13 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
 	page_no = lock->un_member.rec_lock.page_no;
 
+	ut_ad(lock_rec_page_own(space, page_no));
+
 	for (;;) {
 		lock = static_cast<const lock_t*>(HASH_GET_NEXT(hash, lock));
 
@@ -1215,7 +1235,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(space, page_no));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1267,10 +1287,10 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
-
 	hash = buf_block_get_lock_hash_val(block);
 
+	ut_ad(lock_mutex_own() || lock_rec_hash_own(hash));
+
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST( lock_sys->rec_hash, hash));
 	     lock != NULL;
@@ -1762,7 +1782,7 @@ lock_rec_other_trx_holds_expl(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys->mutex. */
+The caller must be holding lock_sys->latch. */
 UNIV_INTERN
 ulint
 lock_number_of_rows_locked(
@@ -1822,7 +1842,6 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1834,6 +1853,14 @@ lock_rec_create(
 	page_no	= buf_block_get_page_no(block);
 	page = block->frame;
 
+	/* Unless lock_sys->latch is x-latched, other threads may be
+	creating or discarding locks in other rec_hash cells at the same
+	time. Therefore the lock counters are updated atomically. */
+	ut_ad(lock_rec_page_own(space, page_no));
+	/* A waiting lock request can only be enqueued when holding the
+	x-latch, because of the deadlock check. */
+	ut_ad(!(type_mode & LOCK_WAIT) || lock_mutex_own());
+
 	btr_assert_not_corrupted(block, index);
 
 	/* If rec is the supremum record, then we reset the gap and
@@ -1870,14 +1897,14 @@ lock_rec_create(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
-	index->table->n_rec_locks++;
+	os_atomic_increment_ulint(&index->table->n_rec_locks, 1);
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
 	HASH_INSERT(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), lock);
 
-	lock_sys->rec_num++;
+	os_atomic_increment_ulint(&lock_sys->rec_num, 1);
 
 	if (!caller_owns_trx_mutex) {
 		trx_mutex_enter(trx);
@@ -1895,12 +1922,41 @@ lock_rec_create(
 		trx_mutex_exit(trx);
 	}
 
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 
 	return(lock);
 }
 
+/*********************************************************************//**
+Reports the transactions which hold the locks a waiting record lock
+request waits for, see thd_report_wait_for(). */
+static
+void
+lock_rec_report_waits(
+/*==================*/
+	const lock_t*		wait_lock,/*!< in: waiting lock request */
+	const buf_block_t*	block,	/*!< in: buffer block containing
+					the record */
+	ulint			heap_no)/*!< in: heap number of the record */
+{
+	ut_ad(lock_mutex_own());
+	ut_ad(lock_get_wait(wait_lock));
+
+	for (const lock_t* lock = lock_rec_get_first(block, heap_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next_const(heap_no, lock)) {
+
+		if (lock != wait_lock
+		    && lock->trx->mysql_thd != NULL
+		    && lock_has_to_wait(wait_lock, lock)) {
+
+			thd_report_wait_for(wait_lock->trx->mysql_thd,
+					    lock->trx->mysql_thd);
+		}
+	}
+}
+
 /*********************************************************************//**
 Enqueues a waiting request for a lock which cannot be granted immediately.
 Checks for deadlocks.
@@ -2026,6 +2082,14 @@ lock_rec_enqueue_waiting(
 	}
 #endif /* UNIV_DEBUG */
 
+	/* A slave preserving the commit order must not let a preceding
+	transaction wait for one which commits after it. */
+	if (trx->mysql_thd != NULL
+	    && thd_is_replication_slave_thread(trx->mysql_thd)) {
+
+		lock_rec_report_waits(lock, block, heap_no);
+	}
+
 	MONITOR_INC(MONITOR_LOCKREC_WAIT);
 
 	return(DB_LOCK_WAIT);
@@ -2150,7 +2214,9 @@ there are no explicit locks on the page, or there is just one lock, owned
 by this transaction, and of the right type_mode. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case of
-a page supremum record, a gap type lock.
+a page supremum record, a gap type lock. The caller must hold either the
+x-latch on lock_sys->latch, or the s-latch and the mutex of the rec_hash
+cell of the page.
 @return whether the locking succeeded */
 UNIV_INLINE
 enum lock_rec_req_status
@@ -2173,7 +2239,8 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_mutex_own()
+	      || lock_rec_hash_own(buf_block_get_lock_hash_val(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2305,7 +2372,10 @@ Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The common cases are handled
+under the s-latch on lock_sys->latch and the mutex of the rec_hash cell of
+the page only, so that transactions locking records on different pages do
+not serialize on lock_sys->latch. Everything else is done under the x-latch.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
 or DB_QUE_THR_SUSPENDED */
 static
@@ -2325,11 +2395,11 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
-	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
-	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
+	ib_mutex_t*		hash_mutex;
+	enum lock_rec_req_status status;
+	dberr_t			err;
+
+	ut_ad(!lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) == LOCK_S
 	      || (LOCK_MODE_MASK & mode) == LOCK_X);
 	ut_ad(mode - (LOCK_MODE_MASK & mode) == LOCK_GAP
@@ -2339,14 +2409,33 @@ lock_rec_lock(
 
 	/* We try a simplified and faster subroutine for the most
 	common cases */
-	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	hash_mutex = lock_rec_hash_get_mutex(
+		buf_block_get_lock_hash_val(block));
+
+	lock_sys_s_enter();
+	mutex_enter(hash_mutex);
+
+	status = lock_rec_lock_fast(impl, mode, block, heap_no, index, thr);
+
+	mutex_exit(hash_mutex);
+	lock_sys_s_exit();
+
+	switch (status) {
 	case LOCK_REC_SUCCESS:
 		return(DB_SUCCESS);
 	case LOCK_REC_SUCCESS_CREATED:
 		return(DB_SUCCESS_LOCKED_REC);
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, mode, block,
-					  heap_no, index, thr));
+		DEBUG_SYNC_C("lock_rec_lock_before_slow");
+
+		lock_mutex_enter();
+
+		err = lock_rec_lock_slow(impl, mode, block,
+					 heap_no, index, thr);
+
+		lock_mutex_exit();
+
+		return(err);
 	}
 
 	ut_error;
@@ -2399,7 +2488,7 @@ lock_rec_has_to_wait_in_queue(
 
 /*************************************************************//**
 Grants a lock to a waiting lock request and releases the waiting transaction.
-The caller must hold lock_sys->mutex but not lock->trx->mutex. */
+The caller must hold lock_sys->latch but not lock->trx->mutex. */
 static
 void
 lock_grant(
@@ -2558,7 +2647,6 @@ lock_rec_discard(
 	ulint		page_no;
 	trx_lock_t*	trx_lock;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 
 	trx_lock = &in_lock->trx->lock;
@@ -2566,16 +2654,18 @@ lock_rec_discard(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	ut_ad(lock_rec_page_own(space, page_no));
+
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
-	lock_sys->rec_num--;
+	os_atomic_decrement_ulint(&lock_sys->rec_num, 1);
 
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 }
 
 /*************************************************************//**
@@ -3618,7 +3708,7 @@ lock_deadlock_lock_print(
 	}
 }
 
-/** Used in deadlock tracking. Protected by lock_sys->mutex. */
+/** Used in deadlock tracking. Protected by lock_sys->latch. */
 static ib_uint64_t	lock_mark_counter = 0;
 
 /** Check if the search is too deep. */
@@ -4764,6 +4854,65 @@ lock_release(
 	mem_heap_empty(trx->lock.lock_heap);
 }
 
+/*********************************************************************//**
+Releases the record locks of a committing transaction that no other
+transaction is waiting for, without acquiring the x-latch on
+lock_sys->latch. The locks on pages with waiting lock requests are left
+to lock_release(), which must grant the waiting requests. */
+static
+void
+lock_rec_release_unqueued(
+/*======================*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	lock_t*		lock;
+	lock_t*		next_lock;
+
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
+
+	for (lock = UT_LIST_GET_FIRST(trx->lock.trx_locks);
+	     lock != NULL;
+	     lock = next_lock) {
+
+		const lock_t*	other_lock;
+		ulint		space;
+		ulint		page_no;
+		ib_mutex_t*	hash_mutex;
+
+		next_lock = UT_LIST_GET_NEXT(trx_locks, lock);
+
+		if (lock_get_type_low(lock) != LOCK_REC) {
+			continue;
+		}
+
+		ut_ad(!lock_get_wait(lock));
+
+		space = lock->un_member.rec_lock.space;
+		page_no = lock->un_member.rec_lock.page_no;
+
+		hash_mutex = lock_rec_hash_get_mutex(
+			lock_rec_hash(space, page_no));
+
+		mutex_enter(hash_mutex);
+
+		for (other_lock = lock_rec_get_first_on_page_addr(
+				space, page_no);
+		     other_lock != NULL && !lock_get_wait(other_lock);
+		     other_lock = lock_rec_get_next_on_page_const(
+			     other_lock)) {
+			/* Look for a waiting lock request */
+		}
+
+		if (other_lock == NULL) {
+			lock_rec_discard(lock);
+		}
+
+		mutex_exit(hash_mutex);
+	}
+}
+
 /* True if a lock mode is S or X */
 #define IS_LOCK_S_OR_X(lock) \
 	(lock_get_mode(lock) == LOCK_S \
@@ -4899,7 +5048,7 @@ lock_remove_recovered_trx_record_locks(
 			continue;
 		}
 
-		/* Because we are holding the lock_sys->mutex,
+		/* Because we are holding the lock_sys->latch,
 		implicit locks cannot be converted to explicit ones
 		while we are scanning the explicit locks. */
 
@@ -5323,7 +5472,7 @@ lock_print_info_all_transactions(
 	}
 
 loop:
-	/* Since we temporarily release lock_sys->mutex and
+	/* Since we temporarily release lock_sys->latch and
 	trx_sys->mutex when reading a database page in below,
 	variable trx may be obsolete now and we must loop
 	through the trx list to get probably the same trx,
@@ -5562,7 +5711,7 @@ lock_table_queue_validate(
 		/* lock->trx->state cannot change from or to NOT_STARTED
 		while we are holding the trx_sys->mutex. It may change
 		from ACTIVE to PREPARED, but it may not change to
-		COMMITTED, because we are holding the lock_sys->mutex. */
+		COMMITTED, because we are holding the lock_sys->latch. */
 		ut_ad(trx_assert_started(lock->trx));
 
 		if (!lock_get_wait(lock)) {
@@ -5650,7 +5799,7 @@ lock_rec_queue_validate(
 
 		ut_ad(lock_mutex_own());
 		/* trx_id cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (trx_desc != NULL
 		    && lock_rec_other_has_expl_req(LOCK_S, 0, LOCK_WAIT,
@@ -6159,7 +6308,7 @@ lock_rec_convert_impl_to_expl(
 		mutex_exit(&trx_sys->mutex);
 
 		/* trx_id cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (impl_trx_desc != NULL
 		    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP, block,
@@ -6228,16 +6377,10 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
-	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
-
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6292,16 +6435,10 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
-	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
-
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 #ifdef UNIV_DEBUG
 	{
@@ -6400,19 +6537,10 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
-	ut_ad(mode != LOCK_X
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
-	ut_ad(mode != LOCK_S
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
-
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6481,19 +6609,10 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
-	ut_ad(mode != LOCK_X
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
-	ut_ad(mode != LOCK_S
-	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
-
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6935,11 +7054,13 @@ lock_trx_release_locks(
 	}
 
 	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-	is protected by both the lock_sys->mutex and the trx->mutex.
+	is protected by both the lock_sys->latch and the trx->mutex.
+	Other threads only look at the state of a transaction other than
+	their own while holding the x-latch, so the s-latch suffices here.
 	We also lock trx_sys->mutex, because state transition to
 	TRX_STATE_COMMITTED_IN_MEMORY must be atomic with removing trx
 	from the descriptors array. */
-	lock_mutex_enter();
+	lock_sys_s_enter();
 	mutex_enter(&trx_sys->mutex);
 	trx_mutex_enter(trx);
 
@@ -6980,9 +7101,29 @@ lock_trx_release_locks(
 
 	mutex_exit(&trx_sys->mutex);
 
-	lock_release(trx);
+	lock_rec_release_unqueued(trx);
 
-	lock_mutex_exit();
+	lock_sys_s_exit();
+
+	DEBUG_SYNC_C("lock_trx_release_locks_unqueued");
+
+	/* Now that the transaction is committed in memory, no other
+	thread can create locks on its behalf any more. */
+
+	if (UT_LIST_GET_LEN(trx->lock.trx_locks) > 0) {
+
+		lock_mutex_enter();
+
+		lock_release(trx);
+
+		lock_mutex_exit();
+	} else {
+		ut_a(ib_vector_is_empty(trx->autoinc_locks));
+
+		ib_vector_reset(trx->lock.table_locks);
+
+		mem_heap_empty(trx->lock.lock_heap);
+	}
 }
 
 /*********************************************************************//**
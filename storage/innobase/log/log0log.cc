@@ -96,6 +96,11 @@ UNIV_INTERN mysql_pfs_key_t	log_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	log_do_write = TRUE;
 #endif /* UNIV_DEBUG */
@@ -971,6 +976,17 @@ log_init(void)
 
 	os_event_set(log_sys->one_flushed_event);
 
+	log_sys->writer_threads_active = false;
+	log_sys->writer_threads_stop = false;
+	log_sys->n_writer_threads = 0;
+	log_sys->writer_event = NULL;
+	log_sys->flusher_event = NULL;
+	log_sys->flush_requested_lsn = 0;
+	log_sys->write_events = NULL;
+	log_sys->flush_events = NULL;
+	log_sys->n_flush_waits = 0;
+	log_sys->n_flusher_fsyncs = 0;
+
 	/*----------------------------*/
 
 	log_sys->next_checkpoint_no = 0;
@@ -1371,6 +1387,51 @@ log_block_store_checksum(
 	log_block_set_checksum(block, log_block_calc_checksum(block));
 }
 
+/******************************************************//**
+Stores the checksums of consecutive log blocks to their trailer fields
+before writing them to a log file. CRC32 checksums are calculated in
+batches. */
+static
+void
+log_blocks_store_checksums(
+/*=======================*/
+	byte*	buf,		/*!< in/out: log blocks */
+	ulint	n_blocks)	/*!< in: number of log blocks */
+{
+	ulint	i;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	if (srv_log_checksum_algorithm != SRV_CHECKSUM_ALGORITHM_CRC32
+	    && srv_log_checksum_algorithm
+	    != SRV_CHECKSUM_ALGORITHM_STRICT_CRC32) {
+
+		for (i = 0; i < n_blocks; i++) {
+			log_block_store_checksum(
+				buf + i * OS_FILE_LOG_BLOCK_SIZE);
+		}
+
+		return;
+	}
+
+	while (n_blocks > 0) {
+		ib_uint32_t	checksums[LOG_CHECKSUM_BATCH];
+		ulint		n = ut_min(n_blocks,
+					   (ulint) LOG_CHECKSUM_BATCH);
+
+		log_blocks_calc_checksums_crc32(buf, n, checksums);
+
+		for (i = 0; i < n; i++) {
+			log_block_set_checksum(
+				buf + i * OS_FILE_LOG_BLOCK_SIZE,
+				checksums[i]);
+		}
+
+		buf += n * OS_FILE_LOG_BLOCK_SIZE;
+		n_blocks -= n;
+	}
+}
+
 /******************************************************//**
 Writes a buffer to a log file group. */
 UNIV_INTERN
@@ -1392,7 +1453,9 @@ log_group_write_buf(
 	ulint		write_len;
 	ibool		write_header;
 	lsn_t		next_offset;
+#ifdef UNIV_DEBUG
 	ulint		i;
+#endif /* UNIV_DEBUG */
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 	ut_ad(!recv_no_log_write);
@@ -1464,9 +1527,7 @@ loop:
 	/* Calculate the checksums for each log block and write them to
 	the trailer fields of the log blocks */
 
-	for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
-		log_block_store_checksum(buf + i * OS_FILE_LOG_BLOCK_SIZE);
-	}
+	log_blocks_store_checksums(buf, write_len / OS_FILE_LOG_BLOCK_SIZE);
 
 	if (log_do_write) {
 		log_sys->n_log_ios++;
@@ -1500,14 +1561,14 @@ loop:
 }
 
 /******************************************************//**
-This function is called, e.g., when a transaction wants to commit. It checks
-that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
-UNIV_INTERN
+Writes the log buffer to the log files in the calling thread. It checks
+that the log has been written to the log file up to the given lsn. If there
+is a flush running, it waits and checks if the flush flushed enough. If not,
+starts a new flush. */
+static
 void
-log_write_up_to(
-/*============*/
+log_write_up_to_low(
+/*================*/
 	lsn_t	lsn,	/*!< in: log sequence number up to which
 			the log should be written,
 			LSN_MAX if not specified */
@@ -1527,15 +1588,6 @@ log_write_up_to(
 #endif /* UNIV_DEBUG */
 	ulint		unlock;
 
-	ut_ad(!srv_read_only_mode);
-
-	if (recv_no_ibuf_operations) {
-		/* Recovery is running and no operations on the log files are
-		allowed yet (the variable name .._no_ibuf_.. is misleading) */
-
-		return;
-	}
-
 loop:
 #ifdef UNIV_DEBUG
 	loop_count++;
@@ -1732,6 +1784,422 @@ do_waits:
 	}
 }
 
+/******************************************************//**
+Returns the event on which a thread waits for the log writer or the log
+flusher thread to advance past the given lsn.
+@return wait event */
+UNIV_INLINE
+os_event_t
+log_wait_event_get(
+/*===============*/
+	os_event_t*	events,	/*!< in: log_sys->write_events or
+				log_sys->flush_events */
+	lsn_t		lsn)	/*!< in: lsn waited for */
+{
+	return(events[(lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_N_WAIT_EVENTS]);
+}
+
+/******************************************************//**
+Wakes up the threads waiting for an lsn in the range (old_lsn, new_lsn]
+on log_sys->write_events or log_sys->flush_events. */
+static
+void
+log_wake_waiters(
+/*=============*/
+	os_event_t*	events,	/*!< in: log_sys->write_events or
+				log_sys->flush_events */
+	lsn_t		old_lsn,/*!< in: the lsn reached before */
+	lsn_t		new_lsn)/*!< in: the lsn reached now */
+{
+	ib_uint64_t	first_block;
+	ib_uint64_t	last_block;
+
+	if (new_lsn <= old_lsn) {
+		return;
+	}
+
+	first_block = old_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	last_block = new_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	if (last_block - first_block >= LOG_N_WAIT_EVENTS) {
+		first_block = 0;
+		last_block = LOG_N_WAIT_EVENTS - 1;
+	}
+
+	for (ib_uint64_t block = first_block; block <= last_block; block++) {
+		os_event_set(events[block % LOG_N_WAIT_EVENTS]);
+	}
+}
+
+/******************************************************//**
+Asks the log flusher thread to flush the log to disk at least up to the
+given lsn. */
+static
+void
+log_request_flush(
+/*==============*/
+	lsn_t	lsn)	/*!< in: lsn to flush up to */
+{
+	if (log_sys->flush_requested_lsn < lsn) {
+		mutex_enter(&log_sys->mutex);
+
+		if (log_sys->flush_requested_lsn < lsn) {
+			log_sys->flush_requested_lsn = lsn;
+		}
+
+		mutex_exit(&log_sys->mutex);
+	}
+
+	if (log_sys->written_to_all_lsn >= lsn) {
+		/* The log writer will not wake up the flusher for this
+		lsn any more */
+		os_event_set(log_sys->flusher_event);
+	}
+}
+
+/******************************************************//**
+Waits until the dedicated log writer, or the log flusher if flush_to_disk
+is set, has advanced past the given lsn. The thread first spins for
+innodb_log_wait_spin_rounds rounds and then waits on the event of the log
+block of lsn, so that one write or fsync only wakes up the threads which
+it has released.
+@return false if the log threads were stopped before lsn was reached */
+static
+bool
+log_wait_for_writer_threads(
+/*========================*/
+	lsn_t	lsn,		/*!< in: lsn to wait for */
+	ibool	flush_to_disk)	/*!< in: TRUE if lsn must also be
+				flushed to disk */
+{
+	const volatile lsn_t*	reached_lsn;
+	os_event_t		event;
+
+	reached_lsn = flush_to_disk
+		? &log_sys->flushed_to_disk_lsn
+		: &log_sys->written_to_all_lsn;
+
+	if (*reached_lsn >= lsn) {
+		return(true);
+	}
+
+	if (flush_to_disk) {
+		os_atomic_increment_ulint(&log_sys->n_flush_waits, 1);
+		MONITOR_ATOMIC_INC(MONITOR_LOG_FLUSHER_WAITS);
+
+		log_request_flush(lsn);
+	}
+
+	if (log_sys->write_lsn < lsn) {
+		os_event_set(log_sys->writer_event);
+	}
+
+	for (ulint i = 0; i < srv_log_wait_spin_rounds; i++) {
+
+		if (*reached_lsn >= lsn) {
+			MONITOR_ATOMIC_INC(MONITOR_LOG_WAIT_SPIN_HITS);
+			return(true);
+		}
+
+		ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+	}
+
+	event = log_wait_event_get(flush_to_disk
+				   ? log_sys->flush_events
+				   : log_sys->write_events, lsn);
+
+	for (;;) {
+		ib_int64_t	sig_count = os_event_reset(event);
+
+		if (*reached_lsn >= lsn) {
+			return(true);
+		}
+
+		if (!log_sys->writer_threads_active) {
+			return(false);
+		}
+
+		if (os_event_wait_time_low(event, 100000, sig_count)
+		    == OS_SYNC_TIME_EXCEEDED) {
+
+			/* Should not happen, but make sure that a request
+			is not lost because a wake up was missed */
+
+			if (flush_to_disk) {
+				log_request_flush(lsn);
+			}
+
+			os_event_set(log_sys->writer_event);
+		}
+	}
+}
+
+/******************************************************//**
+This function is called, e.g., when a transaction wants to commit. It checks
+that the log has been written to the log file up to the last log entry written
+by the transaction. If there is a flush running, it waits and checks if the
+flush flushed enough. If not, starts a new flush. If the dedicated log writer
+and log flusher threads are running, the calling thread instead wakes them up
+and waits for them. */
+UNIV_INTERN
+void
+log_write_up_to(
+/*============*/
+	lsn_t	lsn,	/*!< in: log sequence number up to which
+			the log should be written,
+			LSN_MAX if not specified */
+	ulint	wait,	/*!< in: LOG_NO_WAIT, LOG_WAIT_ONE_GROUP,
+			or LOG_WAIT_ALL_GROUPS */
+	ibool	flush_to_disk)
+			/*!< in: TRUE if we want the written log
+			also to be flushed to disk */
+{
+	ut_ad(!srv_read_only_mode);
+
+	if (recv_no_ibuf_operations) {
+		/* Recovery is running and no operations on the log files are
+		allowed yet (the variable name .._no_ibuf_.. is misleading) */
+
+		return;
+	}
+
+	if (log_sys->writer_threads_active) {
+
+		if (lsn == LSN_MAX) {
+			mutex_enter(&log_sys->mutex);
+			lsn = log_sys->lsn;
+			mutex_exit(&log_sys->mutex);
+		}
+
+		if (wait == LOG_NO_WAIT) {
+			if (flush_to_disk) {
+				log_request_flush(lsn);
+			}
+
+			os_event_set(log_sys->writer_event);
+
+			return;
+		}
+
+		if (log_wait_for_writer_threads(lsn, flush_to_disk)) {
+
+			return;
+		}
+
+		/* The log threads were stopped: do the write ourselves */
+	}
+
+	log_write_up_to_low(lsn, wait, flush_to_disk);
+}
+
+/******************************************************************//**
+log_writer thread which writes the log buffer to the log files on behalf of
+the threads waiting in log_write_up_to().
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	my_thread_init();
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (!log_sys->writer_threads_stop) {
+		ib_int64_t	sig_count;
+		lsn_t		old_written_lsn;
+		lsn_t		old_flushed_lsn;
+
+		sig_count = os_event_reset(log_sys->writer_event);
+
+		old_written_lsn = log_sys->written_to_all_lsn;
+
+		if (log_sys->lsn <= old_written_lsn) {
+			os_event_wait_time_low(log_sys->writer_event,
+					       100000, sig_count);
+			continue;
+		}
+
+		old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		log_write_up_to_low(LSN_MAX, LOG_WAIT_ALL_GROUPS, FALSE);
+
+		log_wake_waiters(log_sys->write_events, old_written_lsn,
+				 log_sys->written_to_all_lsn);
+
+		if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC
+		    || srv_unix_file_flush_method == SRV_UNIX_ALL_O_DIRECT) {
+			/* The write also flushed the log to disk */
+			log_wake_waiters(log_sys->flush_events,
+					 old_flushed_lsn,
+					 log_sys->flushed_to_disk_lsn);
+		}
+
+		if (log_sys->flush_requested_lsn
+		    > log_sys->flushed_to_disk_lsn) {
+			os_event_set(log_sys->flusher_event);
+		}
+	}
+
+	mutex_enter(&log_sys->mutex);
+	log_sys->n_writer_threads--;
+	mutex_exit(&log_sys->mutex);
+
+	my_thread_end();
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+log_flusher thread which flushes the written log to disk on behalf of the
+threads waiting in log_write_up_to(). One fsync releases all the threads
+which have committed up to the flushed lsn.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	my_thread_init();
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	while (!log_sys->writer_threads_stop) {
+		ib_int64_t	sig_count;
+		lsn_t		flush_lsn;
+		lsn_t		old_flushed_lsn;
+		log_group_t*	group;
+
+		sig_count = os_event_reset(log_sys->flusher_event);
+
+		mutex_enter(&log_sys->mutex);
+
+		flush_lsn = log_sys->written_to_all_lsn;
+		old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (flush_lsn <= old_flushed_lsn
+		    || log_sys->flush_requested_lsn <= old_flushed_lsn) {
+
+			mutex_exit(&log_sys->mutex);
+
+			os_event_wait_time_low(log_sys->flusher_event,
+					       100000, sig_count);
+			continue;
+		}
+
+		group = UT_LIST_GET_FIRST(log_sys->log_groups);
+
+		mutex_exit(&log_sys->mutex);
+
+		fil_flush(group->space_id);
+
+		mutex_enter(&log_sys->mutex);
+
+		old_flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (flush_lsn > old_flushed_lsn) {
+			log_sys->flushed_to_disk_lsn = flush_lsn;
+		}
+
+		log_sys->n_flusher_fsyncs++;
+
+		MONITOR_INC(MONITOR_LOG_FLUSHER_FSYNCS);
+		MONITOR_SET(MONITOR_LOG_FLUSHER_AVG_GROUP_SIZE,
+			    log_sys->n_flush_waits
+			    / log_sys->n_flusher_fsyncs);
+
+		mutex_exit(&log_sys->mutex);
+
+		log_wake_waiters(log_sys->flush_events, old_flushed_lsn,
+				 flush_lsn);
+	}
+
+	mutex_enter(&log_sys->mutex);
+	log_sys->n_writer_threads--;
+	mutex_exit(&log_sys->mutex);
+
+	my_thread_end();
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+Starts the dedicated log writer and log flusher threads which take over the
+log file writes and fsyncs from log_write_up_to() callers. Called at
+startup when innodb_log_writer_threads is set. */
+UNIV_INTERN
+void
+log_writer_threads_start(void)
+/*==========================*/
+{
+	ut_ad(!srv_read_only_mode);
+	ut_ad(!log_sys->writer_threads_active);
+
+	log_sys->writer_event = os_event_create();
+	log_sys->flusher_event = os_event_create();
+
+	log_sys->write_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_WAIT_EVENTS * sizeof(os_event_t)));
+	log_sys->flush_events = static_cast<os_event_t*>(
+		mem_alloc(LOG_N_WAIT_EVENTS * sizeof(os_event_t)));
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		log_sys->write_events[i] = os_event_create();
+		log_sys->flush_events[i] = os_event_create();
+	}
+
+	log_sys->writer_threads_stop = false;
+	log_sys->n_writer_threads = 2;
+	log_sys->writer_threads_active = true;
+
+	os_thread_create(log_writer_thread, NULL, NULL);
+	os_thread_create(log_flusher_thread, NULL, NULL);
+}
+
+/******************************************************************//**
+Stops the dedicated log writer and log flusher threads and waits for them
+to exit. After this the log writes are done again by the threads calling
+log_write_up_to(). */
+UNIV_INTERN
+void
+log_writer_threads_stop(void)
+/*=========================*/
+{
+	if (!log_sys->writer_threads_active) {
+		return;
+	}
+
+	log_sys->writer_threads_stop = true;
+
+	while (log_sys->n_writer_threads > 0) {
+		os_event_set(log_sys->writer_event);
+		os_event_set(log_sys->flusher_event);
+		os_thread_sleep(10000);
+	}
+
+	log_sys->writer_threads_active = false;
+
+	/* Make the remaining waiters do their writes themselves */
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_set(log_sys->write_events[i]);
+		os_event_set(log_sys->flush_events[i]);
+	}
+}
+
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -3514,6 +3982,10 @@ loop:
 		os_rmb;
 	}
 
+	/* The page cleaners were the last ones to wait for log writes
+	in the background: from now on this thread does the log i/o */
+	log_writer_threads_stop();
+
 	mutex_enter(&log_sys->mutex);
 	server_busy = log_sys->n_pending_checkpoint_writes
 #ifdef UNIV_LOG_ARCHIVE
@@ -3938,6 +4410,23 @@ log_shutdown(void)
 	os_event_free(log_sys->no_flush_event);
 	os_event_free(log_sys->one_flushed_event);
 
+	if (log_sys->write_events != NULL) {
+		ut_ad(!log_sys->writer_threads_active);
+
+		for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+			os_event_free(log_sys->write_events[i]);
+			os_event_free(log_sys->flush_events[i]);
+		}
+
+		mem_free(log_sys->write_events);
+		mem_free(log_sys->flush_events);
+		log_sys->write_events = NULL;
+		log_sys->flush_events = NULL;
+
+		os_event_free(log_sys->writer_event);
+		os_event_free(log_sys->flusher_event);
+	}
+
 	rw_lock_free(&log_sys->checkpoint_lock);
 
 	mutex_free(&log_sys->mutex);
@@ -53,6 +53,7 @@ Created 9/20/1997 Heikki Tuuri
 # include "srv0srv.h"
 # include "srv0start.h"
 # include "trx0roll.h"
+# include "trx0purge.h"
 # include "row0merge.h"
 # include "sync0sync.h"
 #else /* !UNIV_HOTBACKUP */
@@ -151,6 +152,33 @@ is bigger than the lsn we are able to scan up to, that is an indication that
 the recovery failed and the database may be corrupt. */
 UNIV_INTERN lsn_t	recv_max_page_lsn;
 
+/** Number of pages to which redo log records have been applied during
+crash recovery */
+UNIV_INTERN ulint	recv_n_pages_applied	= 0;
+
+/** Total length of the redo log records that have been applied to pages
+during crash recovery, in bytes */
+UNIV_INTERN ulint	recv_n_bytes_applied	= 0;
+
+/** Time spent in redo log record application batches during crash
+recovery, in microseconds */
+UNIV_INTERN ib_uint64_t	recv_apply_time_us	= 0;
+
+#ifndef UNIV_HOTBACKUP
+/** Number of threads applying the current batch of hashed log records */
+static ulint	recv_apply_n_threads;
+
+/** Number of recv_apply_thread instances which have not yet completed
+their part of the current batch */
+static ulint	recv_apply_n_running;
+
+/** Number of recv_sys->addr_hash cells processed in the current batch */
+static ulint	recv_apply_n_cells_done;
+
+/** Thread numbers passed to the recv_apply_thread instances */
+static ulint	recv_apply_thread_nos[SRV_MAX_N_RECV_APPLY_THREADS];
+#endif /* !UNIV_HOTBACKUP */
+
 #ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	trx_rollback_clean_thread_key;
 #endif /* UNIV_PFS_THREAD */
@@ -162,6 +190,7 @@ UNIV_INTERN mysql_pfs_key_t	recv_sys_mutex_key;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	recv_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 # ifdef UNIV_PFS_MUTEX
@@ -1547,6 +1576,16 @@ recv_add_to_hash_table(
 		return;
 	}
 
+#ifndef UNIV_HOTBACKUP
+	if (trx_purge_undo_truncate_is_recreated(space)) {
+		/* The undo tablespace was being truncated: it has been
+		recreated empty and its headers are rebuilt after the log
+		scan, so its old log records must not be applied */
+
+		return;
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	len = rec_end - body;
 
 	recv = static_cast<recv_t*>(
@@ -1667,6 +1706,7 @@ recv_recover_page_func(
 	lsn_t		page_lsn;
 	lsn_t		page_newest_lsn;
 	ibool		modification_to_page;
+	ulint		n_bytes_applied = 0;
 #ifndef UNIV_HOTBACKUP
 	ibool		success;
 #endif /* !UNIV_HOTBACKUP */
@@ -1803,6 +1843,8 @@ recv_recover_page_func(
 							 block, &mtr,
 							 recv_addr->space);
 
+			n_bytes_applied += recv->len;
+
 			end_lsn = recv->start_lsn + recv->len;
 			mach_write_to_8(FIL_PAGE_LSN + page, end_lsn);
 			mach_write_to_8(UNIV_PAGE_SIZE
@@ -1854,6 +1896,11 @@ recv_recover_page_func(
 		recv_max_page_lsn = page_lsn;
 	}
 
+	if (modification_to_page) {
+		recv_n_pages_applied++;
+		recv_n_bytes_applied += n_bytes_applied;
+	}
+
 	recv_addr->state = RECV_PROCESSED;
 
 	ut_a(recv_sys->n_addrs);
@@ -1912,9 +1959,121 @@ recv_read_in_area(
 	return(n);
 }
 
+/*******************************************************************//**
+Applies the hashed log records of a part of recv_sys->addr_hash to the
+pages. The pages that are not in the buffer pool are read in
+asynchronously, and the i/o handler threads apply the log records to them.
+The cells of the hash table are divided among the recv_apply_n_threads
+threads applying the batch. */
+static
+void
+recv_apply_hashed_log_recs_low(
+/*===========================*/
+	ulint	thread_no)	/*!< in: number of this thread; 0 for the
+				thread calling recv_apply_hashed_log_recs() */
+{
+	recv_addr_t*	recv_addr;
+	ulint		n_cells;
+	mtr_t		mtr;
+
+	n_cells = hash_get_n_cells(recv_sys->addr_hash);
+
+	for (ulint i = thread_no; i < n_cells; i += recv_apply_n_threads) {
+
+		mutex_enter(&(recv_sys->mutex));
+
+		for (recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_FIRST(recv_sys->addr_hash, i));
+		     recv_addr != 0;
+		     recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_NEXT(addr_hash, recv_addr))) {
+
+			ulint	space = recv_addr->space;
+			ulint	zip_size = fil_space_get_zip_size(space);
+			ulint	page_no = recv_addr->page_no;
+
+			if (recv_addr->state == RECV_NOT_PROCESSED) {
+
+				mutex_exit(&(recv_sys->mutex));
+
+				if (buf_page_peek(space, page_no)) {
+					buf_block_t*	block;
+
+					mtr_start(&mtr);
+
+					block = buf_page_get(
+						space, zip_size, page_no,
+						RW_X_LATCH, &mtr);
+					buf_block_dbg_add_level(
+						block, SYNC_NO_ORDER_CHECK);
+
+					recv_recover_page(FALSE, block);
+					mtr_commit(&mtr);
+				} else {
+					recv_read_in_area(space, zip_size,
+							  page_no);
+				}
+
+				mutex_enter(&(recv_sys->mutex));
+			}
+		}
+
+		mutex_exit(&(recv_sys->mutex));
+
+		os_atomic_increment_ulint(&recv_apply_n_cells_done, 1);
+	}
+}
+
+/******************************************************************//**
+Thread applying a part of a batch of hashed log records in parallel with
+recv_apply_hashed_log_recs().
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(recv_apply_thread)(
+/*==============================*/
+	void*	arg)	/*!< in: pointer to the number of this thread */
+{
+	my_thread_init();
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	recv_apply_hashed_log_recs_low(*static_cast<ulint*>(arg));
+
+	os_atomic_decrement_ulint(&recv_apply_n_running, 1);
+
+	my_thread_end();
+	/* We count the number of threads in os_thread_exit().
+	A created thread should always use that to exit and not
+	use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Prints the progress of the current log record application batch in
+percent, continuing from the last printed value. */
+static
+void
+recv_apply_print_progress(
+/*======================*/
+	ulint*	last_printed)	/*!< in/out: next percentage to print */
+{
+	ulint	n_cells	= hash_get_n_cells(recv_sys->addr_hash);
+	ulint	percent	= recv_apply_n_cells_done * 100 / n_cells;
+
+	while (*last_printed < percent) {
+		fprintf(stderr, "%lu ", (ulong) *last_printed);
+		(*last_printed)++;
+	}
+}
+
 /*******************************************************************//**
 Empties the hash table of stored log records, applying them to appropriate
-pages. */
+pages. The work is divided among srv_n_recv_apply_threads threads. */
 UNIV_INTERN
 void
 recv_apply_hashed_log_recs(
@@ -1929,10 +2088,11 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-	recv_addr_t* recv_addr;
-	ulint	i;
-	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
+	ibool		has_printed	= FALSE;
+	ulint		n_printed	= 0;
+	ulint		n_pages_before;
+	ulint		n_bytes_before;
+	ib_uint64_t	start_time;
 loop:
 	mutex_enter(&(recv_sys->mutex));
 
@@ -1954,64 +2114,49 @@ loop:
 	recv_sys->apply_log_recs = TRUE;
 	recv_sys->apply_batch_on = TRUE;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
-
-		for (recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_FIRST(recv_sys->addr_hash, i));
-		     recv_addr != 0;
-		     recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_NEXT(addr_hash, recv_addr))) {
-
-			ulint	space = recv_addr->space;
-			ulint	zip_size = fil_space_get_zip_size(space);
-			ulint	page_no = recv_addr->page_no;
+	start_time = ut_time_us(NULL);
+	n_pages_before = recv_n_pages_applied;
+	n_bytes_before = recv_n_bytes_applied;
 
-			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ib_logf(IB_LOG_LEVEL_INFO,
-						"Starting an apply batch"
-						" of log records"
-						" to the database...");
-					fputs("InnoDB: Progress in percent: ",
-					      stderr);
-					has_printed = TRUE;
-				}
+	if (recv_sys->n_addrs != 0) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Starting an apply batch of log records"
+			" to the database...");
+		fputs("InnoDB: Progress in percent: ", stderr);
+		has_printed = TRUE;
+	}
 
-				mutex_exit(&(recv_sys->mutex));
+	/* Do not start more threads than there are pages to recover */
+	recv_apply_n_threads = ut_max(1, ut_min(srv_n_recv_apply_threads,
+						recv_sys->n_addrs));
+	recv_apply_n_running = recv_apply_n_threads - 1;
+	recv_apply_n_cells_done = 0;
 
-				if (buf_page_peek(space, page_no)) {
-					buf_block_t*	block;
+	mutex_exit(&(recv_sys->mutex));
 
-					mtr_start(&mtr);
+	for (ulint i = 1; i < recv_apply_n_threads; i++) {
+		recv_apply_thread_nos[i] = i;
+		os_thread_create(recv_apply_thread,
+				 &recv_apply_thread_nos[i], NULL);
+	}
 
-					block = buf_page_get(
-						space, zip_size, page_no,
-						RW_X_LATCH, &mtr);
-					buf_block_dbg_add_level(
-						block, SYNC_NO_ORDER_CHECK);
+	recv_apply_hashed_log_recs_low(0);
 
-					recv_recover_page(FALSE, block);
-					mtr_commit(&mtr);
-				} else {
-					recv_read_in_area(space, zip_size,
-							  page_no);
-				}
+	if (has_printed) {
+		recv_apply_print_progress(&n_printed);
+	}
 
-				mutex_enter(&(recv_sys->mutex));
-			}
-		}
+	while (recv_apply_n_running > 0) {
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+		os_thread_sleep(100000);
 
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
+		if (has_printed) {
+			recv_apply_print_progress(&n_printed);
 		}
 	}
 
+	mutex_enter(&(recv_sys->mutex));
+
 	/* Wait until all the pages have been processed */
 
 	while (recv_sys->n_addrs != 0) {
@@ -2069,7 +2214,22 @@ loop:
 	recv_sys_empty_hash();
 
 	if (has_printed) {
-		fprintf(stderr, "InnoDB: Apply batch completed\n");
+		ib_uint64_t	elapsed = ut_time_us(NULL) - start_time;
+		ulint		n_pages = recv_n_pages_applied
+			- n_pages_before;
+		ulint		n_bytes = recv_n_bytes_applied
+			- n_bytes_before;
+
+		recv_apply_time_us += elapsed;
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Apply batch completed: %lu pages, %lu bytes of log"
+			" records applied by %lu threads in %.2f seconds"
+			" (%lu pages/s, %lu bytes/s)",
+			(ulong) n_pages, (ulong) n_bytes,
+			(ulong) recv_apply_n_threads, elapsed / 1000000.0,
+			(ulong) (n_pages * 1000000 / ut_max(elapsed, 1)),
+			(ulong) (n_bytes * 1000000 / ut_max(elapsed, 1)));
 	}
 
 	mutex_exit(&(recv_sys->mutex));
@@ -2775,6 +2935,10 @@ recv_scan_log_recs(
 	ibool		finished;
 	ulint		data_len;
 	ibool		more_data;
+	ibool		batch_crc32;
+	ib_uint32_t	checksums[LOG_CHECKSUM_BATCH];
+	ulint		n_checksums;
+	ulint		checksum_no;
 
 	ut_ad(start_lsn % OS_FILE_LOG_BLOCK_SIZE == 0);
 	ut_ad(len % OS_FILE_LOG_BLOCK_SIZE == 0);
@@ -2787,7 +2951,19 @@ recv_scan_log_recs(
 	scanned_lsn = start_lsn;
 	more_data = FALSE;
 
+	/* With the CRC32 algorithm, the checksums of the blocks are
+	calculated in batches ahead of the scan. A block whose checksum
+	does not match is checked again block by block below. */
+	batch_crc32 = srv_log_checksum_algorithm
+		== SRV_CHECKSUM_ALGORITHM_CRC32
+		|| srv_log_checksum_algorithm
+		== SRV_CHECKSUM_ALGORITHM_STRICT_CRC32;
+	n_checksums = 0;
+	checksum_no = 0;
+
 	do {
+		ibool	checksum_ok;
+
 		no = log_block_get_hdr_no(log_block);
 		/*
 		fprintf(stderr, "Log block header no %lu\n", no);
@@ -2795,12 +2971,27 @@ recv_scan_log_recs(
 		fprintf(stderr, "Scanned lsn no %lu\n",
 		log_block_convert_lsn_to_no(scanned_lsn));
 		*/
+		if (batch_crc32 && checksum_no == n_checksums) {
+			n_checksums = ut_min(
+				(ulint) LOG_CHECKSUM_BATCH,
+				(ulint) (buf + len - log_block)
+				/ OS_FILE_LOG_BLOCK_SIZE);
+			checksum_no = 0;
+
+			log_blocks_calc_checksums_crc32(
+				log_block, n_checksums, checksums);
+		}
+
+		checksum_ok = batch_crc32
+			&& checksums[checksum_no++]
+			== log_block_get_checksum(log_block);
+
 		if (no != log_block_convert_lsn_to_no(scanned_lsn)
-		    || !log_block_checksum_is_ok_or_old_format(log_block)) {
+		    || (!checksum_ok
+			&& !log_block_checksum_is_ok_or_old_format(
+				log_block))) {
 
-			if (no == log_block_convert_lsn_to_no(scanned_lsn)
-			    && !log_block_checksum_is_ok_or_old_format(
-				    log_block)) {
+			if (no == log_block_convert_lsn_to_no(scanned_lsn)) {
 				fprintf(stderr,
 					"InnoDB: Log block no %lu at"
 					" lsn " LSN_PF " has\n"
@@ -3760,6 +3951,18 @@ void recv_dblwr_t::add(byte* page)
 	pages.push_back(page);
 }
 
+void recv_dblwr_t::operator() ()
+{
+	pages.clear();
+
+	for (std::list<byte*>::iterator i = bufs.begin();
+	     i != bufs.end(); ++i) {
+		ut_free(*i);
+	}
+
+	bufs.clear();
+}
+
 byte* recv_dblwr_t::find_page(ulint space_id, ulint page_no)
 {
 	std::vector<byte*> matches;
@@ -62,6 +62,14 @@ Created 10/21/1995 Heikki Tuuri
 #include <libaio.h>
 #endif
 
+#if defined(LINUX_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#endif
+
 #if defined(UNIV_LINUX) && defined(HAVE_SYS_IOCTL_H)
 # include <sys/ioctl.h>
 # ifndef DFS_IOCTL_ATOMIC_WRITE_SET
@@ -193,13 +201,41 @@ struct os_aio_slot_t{
 					OVERLAPPED struct */
 	OVERLAPPED	control;	/*!< Windows control block for the
 					aio request */
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
+# if defined(LINUX_NATIVE_AIO)
 	struct iocb	control;	/* Linux control block for aio */
+# endif /* LINUX_NATIVE_AIO */
 	int		n_bytes;	/* bytes written/read. */
 	int		ret;		/* AIO return code */
 #endif /* WIN_ASYNC_IO */
 };
 
+#if defined(LINUX_IO_URING)
+/** An io_uring instance. The rings are set up and driven through the
+io_uring system calls directly. */
+struct os_uring_t{
+	int		fd;		/*!< file descriptor of the ring */
+	os_ib_mutex_t	mutex;		/*!< protects the submission queue */
+	void*		ring_ptr;	/*!< mapping of the submission and
+					completion queue rings */
+	size_t		ring_size;	/*!< size of ring_ptr */
+	io_uring_sqe*	sqes;		/*!< submission queue entries */
+	size_t		sqes_size;	/*!< size of sqes in bytes */
+	unsigned*	sq_head;	/*!< consumed by the kernel */
+	unsigned*	sq_tail;	/*!< produced by us */
+	unsigned*	sq_array;	/*!< indexes into sqes */
+	unsigned	sq_mask;	/*!< mask for sq_head and sq_tail */
+	unsigned	sq_entries;	/*!< number of submission entries */
+	unsigned*	cq_head;	/*!< consumed by us */
+	unsigned*	cq_tail;	/*!< produced by the kernel */
+	unsigned	cq_mask;	/*!< mask for cq_head and cq_tail */
+	io_uring_cqe*	cqes;		/*!< completion queue entries */
+	ulint		n_queued;	/*!< number of entries in the
+					submission queue that have not been
+					passed to the kernel yet */
+};
+#endif /* LINUX_IO_URING */
+
 /** The asynchronous i/o array structure */
 struct os_aio_array_t{
 	os_ib_mutex_t	mutex;	/*!< the mutex protecting the aio array */
@@ -258,9 +294,17 @@ struct os_aio_array_t{
 				counts the number of not-submitted aio
 				request on that segment.*/
 #endif /* LINUX_NATIV_AIO */
+#if defined(LINUX_IO_URING)
+	os_uring_t**		uring;
+				/* One io_uring per segment, NULL if
+				the array does not use io_uring. The
+				completion queue of a ring is only
+				reaped by the i/o thread of the
+				segment. */
+#endif /* LINUX_IO_URING */
 };
 
-#if defined(LINUX_NATIVE_AIO)
+#if defined(LINUX_ASYNC_IO)
 /** timeout for each io_getevents() call = 500ms. */
 #define OS_AIO_REAP_TIMEOUT	(500000000UL)
 
@@ -271,6 +315,61 @@ struct os_aio_array_t{
 #define OS_AIO_IO_SETUP_RETRY_ATTEMPTS	5
 #endif
 
+#if defined(LINUX_IO_URING)
+/** Upper limit for the size of the registered file table of a ring */
+#define OS_URING_MAX_FILES	32768
+
+/** Largest buffer that is registered as one io_uring fixed buffer */
+#define OS_URING_MAX_BUF_SIZE	(1UL << 30)
+
+/** Number of rings that are used for batches of fsync requests */
+#define OS_URING_N_FLUSH_RINGS	4
+
+/** Number of fsync requests that a flush ring can have in flight */
+#define OS_URING_FLUSH_RING_SIZE	64
+
+/** All io_uring instances of the aio arrays and the flush rings. The
+registered file tables of all of them are kept identical. @{ */
+static os_uring_t**	os_uring_rings		= NULL;
+static ulint		os_uring_n_rings	= 0;
+static ulint		os_uring_max_rings	= 0;
+/* @} */
+
+/** Rings for batches of fsync requests */
+static os_uring_t*	os_uring_flush_rings[OS_URING_N_FLUSH_RINGS];
+
+/** Round robin counter for picking a flush ring */
+static ulint		os_uring_flush_next	= 0;
+
+/** A memory area that is registered as a fixed buffer in the rings
+of the aio arrays */
+struct os_uring_buf_t{
+	const byte*	start;	/*!< start of the area */
+	ulint		len;	/*!< length of the area */
+};
+
+/** Fixed buffers sorted by start address. They are registered once
+before any asynchronous i/o is submitted and never change afterwards. */
+static os_uring_buf_t*	os_uring_bufs		= NULL;
+
+/** Number of elements in os_uring_bufs */
+static ulint		os_uring_n_bufs		= 0;
+
+/** Size of the registered file tables, 0 if files are not registered.
+A file descriptor is registered at the index that equals its value. */
+static ulint		os_uring_n_files	= 0;
+
+/** Whether a file descriptor is currently registered */
+static bool*		os_uring_file_registered = NULL;
+
+/** Protects os_uring_file_registered and the updates of the
+registered file tables */
+static os_ib_mutex_t	os_uring_files_mutex	= NULL;
+
+static void os_aio_uring_register_file(os_file_t file);
+static void os_aio_uring_unregister_file(os_file_t file);
+#endif /* LINUX_IO_URING */
+
 /** Array of events used in simulated aio */
 static os_event_t*	os_aio_segment_wait_events = NULL;
 
@@ -1913,6 +2012,11 @@ os_file_create_func(
 		file.m_file = -1;
 	}
 
+#if defined(LINUX_IO_URING)
+	if (purpose == OS_FILE_AIO && file.m_file != -1) {
+		os_aio_uring_register_file(file.m_file);
+	}
+#endif /* LINUX_IO_URING */
 #endif /* __WIN__ */
 
 	return(file);
@@ -2125,6 +2229,10 @@ os_file_close_func(
 #else
 	int	ret;
 
+#if defined(LINUX_IO_URING)
+	os_aio_uring_unregister_file(file);
+#endif /* LINUX_IO_URING */
+
 	ret = close(file);
 
 	if (ret == -1) {
@@ -2161,6 +2269,10 @@ os_file_close_no_error_handling_func(
 #else
 	int	ret;
 
+#if defined(LINUX_IO_URING)
+	os_aio_uring_unregister_file(file);
+#endif /* LINUX_IO_URING */
+
 	ret = close(file);
 
 	if (ret == -1) {
@@ -4015,240 +4127,1097 @@ os_aio_native_aio_supported(void)
 }
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined(LINUX_IO_URING)
 /******************************************************************//**
-Creates an aio wait array. Note that we return NULL in case of failure.
-We don't care about freeing memory here because we assume that a
-failure will result in server refusing to start up.
-@return	own: aio array, NULL on failure */
+Sets up an io_uring instance and maps its queues.
+@return own: the ring, or NULL with errno set on failure */
 static
-os_aio_array_t*
-os_aio_array_create(
-/*================*/
-	ulint	n,		/*!< in: maximum number of pending aio
-				operations allowed; n must be
-				divisible by n_segments */
-	ulint	n_segments)	/*!< in: number of segments in the aio array */
+os_uring_t*
+os_uring_create(
+/*============*/
+	ulint	entries)	/*!< in: minimum number of submission
+				queue entries */
 {
-	os_aio_array_t*	array;
-#ifdef WIN_ASYNC_IO
-	OVERLAPPED*	over;
-#elif defined(LINUX_NATIVE_AIO)
-	struct io_event*	io_event = NULL;
-#endif /* WIN_ASYNC_IO */
-	ut_a(n > 0);
-	ut_a(n_segments > 0);
+	io_uring_params	params;
 
-	array = static_cast<os_aio_array_t*>(ut_malloc(sizeof(*array)));
-	memset(array, 0x0, sizeof(*array));
+	memset(&params, 0x0, sizeof(params));
 
-	array->mutex = os_mutex_create();
-	array->not_full = os_event_create();
-	array->is_empty = os_event_create();
+	params.flags = IORING_SETUP_CLAMP;
 
-	os_event_set(array->is_empty);
+	int	fd = (int) syscall(__NR_io_uring_setup, (unsigned) entries,
+				   &params);
 
-	array->n_slots = n;
-	array->n_segments = n_segments;
+	if (fd < 0) {
+		return(NULL);
+	}
 
-	array->slots = static_cast<os_aio_slot_t*>(
-		ut_malloc(n * sizeof(*array->slots)));
+	/* We rely on one mapping for both rings and on being able to
+	wait for completions with a timeout. */
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP)
+	    || !(params.features & IORING_FEAT_EXT_ARG)
+	    || params.sq_entries < entries) {
 
-	memset(array->slots, 0x0, sizeof(n * sizeof(*array->slots)));
-#ifdef __WIN__
-	array->handles = static_cast<HANDLE*>(ut_malloc(n * sizeof(HANDLE)));
-#endif /* __WIN__ */
+		close(fd);
+		errno = ENOSYS;
+		return(NULL);
+	}
 
-#if defined(LINUX_NATIVE_AIO)
-	array->aio_ctx = NULL;
-	array->aio_events = NULL;
+	size_t	sq_size = params.sq_off.array
+		+ params.sq_entries * sizeof(unsigned);
+	size_t	cq_size = params.cq_off.cqes
+		+ params.cq_entries * sizeof(io_uring_cqe);
+	size_t	ring_size = ut_max(sq_size, cq_size);
 
-	/* If we are not using native aio interface then skip this
-	part of initialization. */
-	if (!srv_use_native_aio) {
-		goto skip_native_aio;
+	void*	ring_ptr = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, fd,
+				IORING_OFF_SQ_RING);
+
+	if (ring_ptr == MAP_FAILED) {
+		int	err = errno;
+		close(fd);
+		errno = err;
+		return(NULL);
 	}
 
-	/* Initialize the io_context array. One io_context
-	per segment in the array. */
+	size_t	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
 
-	array->aio_ctx = static_cast<io_context**>(
-		ut_malloc(n_segments * sizeof(*array->aio_ctx)));
+	void*	sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+			    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
 
-	for (ulint i = 0; i < n_segments; ++i) {
-		if (!os_aio_linux_create_io_ctx(n/n_segments,
-						&array->aio_ctx[i])) {
-			/* If something bad happened during aio setup
-			we should call it a day and return right away.
-			We don't care about any leaks because a failure
-			to initialize the io subsystem means that the
-			server (or atleast the innodb storage engine)
-			is not going to startup. */
-			return(NULL);
-		}
+	if (sqes == MAP_FAILED) {
+		int	err = errno;
+		munmap(ring_ptr, ring_size);
+		close(fd);
+		errno = err;
+		return(NULL);
 	}
 
-	/* Initialize the event array. One event per slot. */
-	io_event = static_cast<struct io_event*>(
-		ut_malloc(n * sizeof(*io_event)));
+	os_uring_t*	ring = static_cast<os_uring_t*>(
+		ut_malloc(sizeof(*ring)));
+
+	byte*		ptr = static_cast<byte*>(ring_ptr);
+
+	ring->fd = fd;
+	ring->mutex = os_mutex_create();
+	ring->ring_ptr = ring_ptr;
+	ring->ring_size = ring_size;
+	ring->sqes = static_cast<io_uring_sqe*>(sqes);
+	ring->sqes_size = sqes_size;
+	ring->sq_head = reinterpret_cast<unsigned*>(ptr + params.sq_off.head);
+	ring->sq_tail = reinterpret_cast<unsigned*>(ptr + params.sq_off.tail);
+	ring->sq_array = reinterpret_cast<unsigned*>(
+		ptr + params.sq_off.array);
+	ring->sq_mask = *reinterpret_cast<unsigned*>(
+		ptr + params.sq_off.ring_mask);
+	ring->sq_entries = params.sq_entries;
+	ring->cq_head = reinterpret_cast<unsigned*>(ptr + params.cq_off.head);
+	ring->cq_tail = reinterpret_cast<unsigned*>(ptr + params.cq_off.tail);
+	ring->cq_mask = *reinterpret_cast<unsigned*>(
+		ptr + params.cq_off.ring_mask);
+	ring->cqes = reinterpret_cast<io_uring_cqe*>(
+		ptr + params.cq_off.cqes);
+	ring->n_queued = 0;
+
+	return(ring);
+}
 
-	memset(io_event, 0x0, sizeof(*io_event) * n);
-	array->aio_events = io_event;
+/******************************************************************//**
+Frees an io_uring instance. The kernel cancels any i/o still in
+flight and drops the registered buffers and files. */
+static
+void
+os_uring_free(
+/*==========*/
+	os_uring_t*	ring)	/*!< in, own: ring to free */
+{
+	munmap(ring->sqes, ring->sqes_size);
+	munmap(ring->ring_ptr, ring->ring_size);
+	close(ring->fd);
+	os_mutex_free(ring->mutex);
+	ut_free(ring);
+}
 
-	array->pending = static_cast<struct iocb**>(
-		ut_malloc(n * sizeof(struct iocb*)));
-	memset(array->pending, 0x0, sizeof(struct iocb*) * n);
-	array->count = static_cast<ulint*>(
-		ut_malloc(n_segments * sizeof(ulint)));
-	memset(array->count, 0x0, sizeof(ulint) * n_segments);
+/******************************************************************//**
+Returns the next free submission queue entry. The entry is cleared but
+not queued until os_uring_queue_sqe() is called. The caller must hold
+ring->mutex.
+@return submission queue entry, NULL if the queue is full */
+static
+io_uring_sqe*
+os_uring_get_sqe(
+/*=============*/
+	os_uring_t*	ring)	/*!< in: ring */
+{
+	unsigned	tail = *ring->sq_tail;
+	unsigned	head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
 
-skip_native_aio:
-#endif /* LINUX_NATIVE_AIO */
-	for (ulint i = 0; i < n; i++) {
-		os_aio_slot_t*	slot;
+	if (tail - head >= ring->sq_entries) {
+		return(NULL);
+	}
 
-		slot = os_aio_array_get_nth_slot(array, i);
+	io_uring_sqe*	sqe = &ring->sqes[tail & ring->sq_mask];
 
-		slot->pos = i;
-		slot->reserved = FALSE;
-#ifdef WIN_ASYNC_IO
-		slot->handle = CreateEvent(NULL,TRUE, FALSE, NULL);
+	memset(sqe, 0x0, sizeof(*sqe));
 
-		over = &slot->control;
+	return(sqe);
+}
 
-		over->hEvent = slot->handle;
+/******************************************************************//**
+Makes the entry returned by os_uring_get_sqe() visible to the kernel.
+It is passed to the kernel by the next os_uring_submit(). The caller
+must hold ring->mutex. */
+static
+void
+os_uring_queue_sqe(
+/*===============*/
+	os_uring_t*	ring)	/*!< in: ring */
+{
+	unsigned	tail = *ring->sq_tail;
 
-		array->handles[i] = over->hEvent;
+	ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
 
-#elif defined(LINUX_NATIVE_AIO)
-		memset(&slot->control, 0x0, sizeof(slot->control));
-		slot->n_bytes = 0;
-		slot->ret = 0;
-#endif /* WIN_ASYNC_IO */
-	}
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
 
-	return(array);
+	++ring->n_queued;
 }
 
-/************************************************************************//**
-Frees an aio wait array. */
+/******************************************************************//**
+Passes all the queued submission queue entries to the kernel. Errors
+of individual requests are reported in their completions; a failure of
+the submission itself is fatal because the requests refer to reserved
+aio slots. The caller must hold ring->mutex.
+@return number of entries submitted */
 static
-void
-os_aio_array_free(
-/*==============*/
-	os_aio_array_t*& array)	/*!< in, own: array to free */
+ulint
+os_uring_submit(
+/*============*/
+	os_uring_t*	ring)	/*!< in: ring */
 {
-#ifdef WIN_ASYNC_IO
-	ulint	i;
+	ulint	n_submitted = 0;
 
-	for (i = 0; i < array->n_slots; i++) {
-		os_aio_slot_t*	slot = os_aio_array_get_nth_slot(array, i);
-		CloseHandle(slot->handle);
-	}
-#endif /* WIN_ASYNC_IO */
+	while (ring->n_queued > 0) {
+		int	ret = (int) syscall(__NR_io_uring_enter, ring->fd,
+					    (unsigned) ring->n_queued, 0U, 0U,
+					    NULL, 0);
 
-#ifdef __WIN__
-	ut_free(array->handles);
-#endif /* __WIN__ */
-	os_mutex_free(array->mutex);
-	os_event_free(array->not_full);
-	os_event_free(array->is_empty);
+		if (ret > 0) {
+			ut_ad((ulint) ret <= ring->n_queued);
+			ring->n_queued -= ret;
+			n_submitted += ret;
+			continue;
+		}
 
-#if defined(LINUX_NATIVE_AIO)
-	if (srv_use_native_aio) {
-		ut_free(array->aio_events);
-		ut_free(array->aio_ctx);
+		if (ret == 0 || errno == EAGAIN || errno == EBUSY) {
+			/* Out of kernel resources or too many
+			completions that have not been reaped yet. */
+			os_thread_sleep(1000);
+			continue;
+		}
 
-#ifdef UNIV_DEBUG
-		for (size_t idx = 0; idx < array->n_slots; ++idx)
-			ut_ad(array->pending[idx] == NULL);
-		for (size_t idx = 0; idx < array->n_segments; ++idx)
-			ut_ad(array->count[idx] == 0);
-#endif
+		if (errno == EINTR) {
+			continue;
+		}
 
-		ut_free(array->pending);
-		ut_free(array->count);
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Trying to submit %lu aio requests, "
+			"io_uring_enter() set errno to %d: %s",
+			(ulong) ring->n_queued, errno, strerror(errno));
 	}
-#endif /* LINUX_NATIVE_AIO */
 
-	ut_free(array->slots);
-	ut_free(array);
-
-	array = 0;
+	return(n_submitted);
 }
 
-/***********************************************************************
-Initializes the asynchronous io system. Creates one array each for ibuf
-and log i/o. Also creates one array each for read and write where each
-array is divided logically into n_read_segs and n_write_segs
-respectively. The caller must create an i/o handler thread for each
-segment in these arrays. This function also creates the sync array.
-No i/o handler thread needs to be created for that */
-UNIV_INTERN
-ibool
-os_aio_init(
-/*========*/
-	ulint	n_per_seg,	/*<! in: maximum number of pending aio
-				operations allowed per segment */
-	ulint	n_read_segs,	/*<! in: number of reader threads */
-	ulint	n_write_segs,	/*<! in: number of writer threads */
-	ulint	n_slots_sync)	/*<! in: number of slots in the sync aio
-				array */
+/******************************************************************//**
+Waits for at least one completion on the ring.
+@return 0 if a completion is available, -errno otherwise; -ETIME if
+the wait timed out */
+static
+int
+os_uring_wait(
+/*==========*/
+	os_uring_t*	ring,		/*!< in: ring */
+	ulint		timeout_ns)	/*!< in: timeout in nanoseconds,
+					less than a second */
 {
-	os_io_init_simple();
-
-#if defined(LINUX_NATIVE_AIO)
-	/* Check if native aio is supported on this system and tmpfs */
-	if (srv_use_native_aio && !os_aio_native_aio_supported()) {
+	__kernel_timespec	ts;
+	io_uring_getevents_arg	arg;
 
-		ib_logf(IB_LOG_LEVEL_WARN, "Linux Native AIO disabled.");
+	ut_ad(timeout_ns < 1000000000UL);
 
-		srv_use_native_aio = FALSE;
-	}
-#endif /* LINUX_NATIVE_AIO */
+	ts.tv_sec = 0;
+	ts.tv_nsec = timeout_ns;
 
-	srv_reset_io_thread_op_info();
+	memset(&arg, 0x0, sizeof(arg));
+	arg.ts = reinterpret_cast<uintptr_t>(&ts);
 
-	os_aio_read_array = os_aio_array_create(
-		n_read_segs * n_per_seg, n_read_segs);
+	int	ret = (int) syscall(__NR_io_uring_enter, ring->fd, 0U, 1U,
+				    (unsigned) (IORING_ENTER_GETEVENTS
+						| IORING_ENTER_EXT_ARG),
+				    &arg, sizeof(arg));
 
-	if (os_aio_read_array == NULL) {
-		return(FALSE);
-	}
+	return(ret < 0 ? -errno : 0);
+}
 
-	ulint	start = (srv_read_only_mode) ? 0 : 2;
-	ulint	n_segs = n_read_segs + start;
+/******************************************************************//**
+Returns the oldest completion that has not been consumed yet. Only one
+thread may consume the completions of a ring.
+@return completion queue entry, NULL if none is available */
+static
+io_uring_cqe*
+os_uring_peek_cqe(
+/*==============*/
+	os_uring_t*	ring)	/*!< in: ring */
+{
+	unsigned	head = *ring->cq_head;
+	unsigned	tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
 
-	/* 0 is the ibuf segment and 1 is the insert buffer segment. */
-	for (ulint i = start; i < n_segs; ++i) {
-		ut_a(i < SRV_MAX_N_IO_THREADS);
-		srv_io_thread_function[i] = "read thread";
+	if (head == tail) {
+		return(NULL);
 	}
 
-	ulint	n_segments = n_read_segs;
+	return(&ring->cqes[head & ring->cq_mask]);
+}
 
-	if (!srv_read_only_mode) {
+/******************************************************************//**
+Marks the completion returned by os_uring_peek_cqe() as consumed. */
+static
+void
+os_uring_cqe_seen(
+/*==============*/
+	os_uring_t*	ring)	/*!< in: ring */
+{
+	__atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
 
-		os_aio_log_array = os_aio_array_create(n_per_seg, 1);
+/******************************************************************//**
+Checks whether the kernel supports io_uring with the features that we
+need. io_uring may also be disabled by a sysctl or a seccomp filter.
+@return TRUE if supported */
+static
+ibool
+os_aio_uring_supported(void)
+/*========================*/
+{
+	os_uring_t*	ring = os_uring_create(1);
 
-		if (os_aio_log_array == NULL) {
-			return(FALSE);
-		}
+	if (ring == NULL) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"io_uring setup failed with error %d: %s",
+			errno, strerror(errno));
+		return(FALSE);
+	}
 
-		++n_segments;
+	os_mutex_enter(ring->mutex);
 
-		srv_io_thread_function[1] = "log thread";
+	io_uring_sqe*	sqe = os_uring_get_sqe(ring);
 
-		os_aio_ibuf_array = os_aio_array_create(n_per_seg, 1);
+	sqe->opcode = IORING_OP_NOP;
+	os_uring_queue_sqe(ring);
 
-		if (os_aio_ibuf_array == NULL) {
-			return(FALSE);
-		}
+	int	ret = (int) syscall(__NR_io_uring_enter, ring->fd, 1U, 1U,
+				    (unsigned) IORING_ENTER_GETEVENTS, NULL, 0);
+	int	err = errno;
 
-		++n_segments;
+	io_uring_cqe*	cqe = os_uring_peek_cqe(ring);
+	ibool		ok = ret == 1 && cqe != NULL && cqe->res == 0;
 
-		srv_io_thread_function[0] = "insert buffer thread";
+	os_mutex_exit(ring->mutex);
+	os_uring_free(ring);
 
-		os_aio_write_array = os_aio_array_create(
+	if (!ok) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"io_uring test request failed with error %d: %s",
+			err, strerror(err));
+	}
+
+	return(ok);
+}
+
+/******************************************************************//**
+Adds a ring to os_uring_rings and registers the file table in it. */
+static
+void
+os_uring_add_ring(
+/*==============*/
+	os_uring_t*	ring)	/*!< in: ring */
+{
+	ut_a(os_uring_n_rings < os_uring_max_rings);
+
+	os_uring_rings[os_uring_n_rings++] = ring;
+
+	if (os_uring_n_files == 0) {
+		return;
+	}
+
+	int*	fds = static_cast<int*>(
+		ut_malloc(os_uring_n_files * sizeof(*fds)));
+
+	/* The table is sparse: descriptors are added when the data
+	files are opened. */
+	for (ulint i = 0; i < os_uring_n_files; ++i) {
+		fds[i] = -1;
+	}
+
+	int	ret = (int) syscall(__NR_io_uring_register, ring->fd,
+				    (unsigned) IORING_REGISTER_FILES, fds,
+				    (unsigned) os_uring_n_files);
+
+	if (ret < 0) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Registering %lu files with io_uring failed with "
+			"error %d: %s. Files will not be registered.",
+			(ulong) os_uring_n_files, errno, strerror(errno));
+
+		/* The tables of the rings created earlier are left
+		empty. */
+		os_uring_n_files = 0;
+	}
+
+	ut_free(fds);
+}
+
+/******************************************************************//**
+Updates the entry of a file descriptor in the registered file tables of
+all rings.
+@return true if all rings were updated */
+static
+bool
+os_uring_update_file(
+/*=================*/
+	os_file_t	file,	/*!< in: file descriptor */
+	int		value)	/*!< in: file descriptor to register or
+				-1 to unregister */
+{
+	io_uring_files_update	update;
+	bool			ok = true;
+
+	memset(&update, 0x0, sizeof(update));
+	update.offset = (unsigned) file;
+	update.fds = reinterpret_cast<uintptr_t>(&value);
+
+	for (ulint i = 0; i < os_uring_n_rings; ++i) {
+		int	ret = (int) syscall(
+			__NR_io_uring_register, os_uring_rings[i]->fd,
+			(unsigned) IORING_REGISTER_FILES_UPDATE, &update, 1U);
+
+		if (ret != 1) {
+			ok = false;
+		}
+	}
+
+	return(ok);
+}
+
+/******************************************************************//**
+Registers a data file opened for asynchronous i/o with the rings so
+that the kernel does not need to look up the descriptor per request. */
+static
+void
+os_aio_uring_register_file(
+/*=======================*/
+	os_file_t	file)	/*!< in: file descriptor */
+{
+	if (file < 0 || (ulint) file >= os_uring_n_files) {
+		return;
+	}
+
+	os_mutex_enter(os_uring_files_mutex);
+
+	if (os_uring_update_file(file, file)) {
+		os_uring_file_registered[file] = true;
+	} else {
+		/* Do not leave a reference to the file in the rings
+		that were updated. */
+		os_uring_update_file(file, -1);
+	}
+
+	os_mutex_exit(os_uring_files_mutex);
+}
+
+/******************************************************************//**
+Removes a file from the registered file tables before it is closed. */
+static
+void
+os_aio_uring_unregister_file(
+/*=========================*/
+	os_file_t	file)	/*!< in: file descriptor */
+{
+	if (file < 0 || (ulint) file >= os_uring_n_files
+	    || !os_uring_file_registered[file]) {
+		return;
+	}
+
+	os_mutex_enter(os_uring_files_mutex);
+
+	if (!os_uring_update_file(file, -1)) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Removing file descriptor %d from the io_uring "
+			"file tables failed", file);
+	}
+
+	os_uring_file_registered[file] = false;
+
+	os_mutex_exit(os_uring_files_mutex);
+}
+
+/******************************************************************//**
+Sets the file of a submission queue entry, using the registered file
+table if the file is registered. */
+static
+void
+os_uring_prep_file(
+/*===============*/
+	io_uring_sqe*	sqe,	/*!< in/out: submission queue entry */
+	os_file_t	file)	/*!< in: file descriptor */
+{
+	sqe->fd = file;
+
+	if (file >= 0 && (ulint) file < os_uring_n_files
+	    && os_uring_file_registered[file]) {
+
+		sqe->flags |= IOSQE_FIXED_FILE;
+	}
+}
+
+/** Orders fixed buffers by their start address */
+static
+bool
+os_uring_buf_less(
+/*==============*/
+	const os_uring_buf_t&	a,	/*!< in: buffer */
+	const os_uring_buf_t&	b)	/*!< in: buffer */
+{
+	return(a.start < b.start);
+}
+
+/******************************************************************//**
+Looks up the fixed buffer that contains a memory area.
+@return true if the area lies within a registered buffer */
+static
+bool
+os_uring_find_buf(
+/*==============*/
+	const byte*	buf,	/*!< in: start of the area */
+	ulint		len,	/*!< in: length of the area */
+	ulint*		index)	/*!< out: index of the fixed buffer */
+{
+	ulint	low = 0;
+	ulint	high = os_uring_n_bufs;
+
+	/* Find the last buffer that starts at or before buf. */
+	while (low < high) {
+		ulint	mid = (low + high) / 2;
+
+		if (os_uring_bufs[mid].start <= buf) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == 0) {
+		return(false);
+	}
+
+	const os_uring_buf_t*	b = &os_uring_bufs[low - 1];
+
+	if (buf + len > b->start + b->len) {
+		return(false);
+	}
+
+	*index = low - 1;
+
+	return(true);
+}
+
+/******************************************************************//**
+Queues the read or write of a reserved slot on a ring. The caller must
+hold ring->mutex. */
+static
+void
+os_aio_uring_prep(
+/*==============*/
+	os_uring_t*	ring,	/*!< in: ring of the slot's segment */
+	os_aio_slot_t*	slot)	/*!< in: reserved slot */
+{
+	io_uring_sqe*	sqe = os_uring_get_sqe(ring);
+
+	if (sqe == NULL) {
+		/* The queue is full of requests that were deferred. */
+		os_uring_submit(ring);
+		sqe = os_uring_get_sqe(ring);
+		ut_a(sqe != NULL);
+	}
+
+	ulint	buf_index;
+	bool	fixed = os_uring_find_buf(slot->buf, slot->len, &buf_index);
+
+	if (slot->type == OS_FILE_READ) {
+		sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	} else {
+		ut_a(slot->type == OS_FILE_WRITE);
+		sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+	}
+
+	os_uring_prep_file(sqe, slot->file.m_file);
+
+	sqe->off = slot->offset;
+	sqe->addr = reinterpret_cast<uintptr_t>(slot->buf);
+	sqe->len = (unsigned) slot->len;
+	sqe->buf_index = fixed ? (unsigned short) buf_index : 0;
+	sqe->user_data = reinterpret_cast<uintptr_t>(slot);
+
+	slot->n_bytes = 0;
+	slot->ret = 0;
+
+	os_uring_queue_sqe(ring);
+}
+
+/*******************************************************************//**
+Dispatches an AIO request through io_uring.
+@return	TRUE on success. */
+static
+ibool
+os_aio_uring_dispatch(
+/*==================*/
+	os_aio_array_t*	array,	/*!< in: io request array. */
+	os_aio_slot_t*	slot,	/*!< in: an already reserved slot. */
+	bool		defer)	/*!< in: leave the request queued until
+				the batch is submitted */
+{
+	ulint		slots_per_segment = array->n_slots / array->n_segments;
+	os_uring_t*	ring = array->uring[slot->pos / slots_per_segment];
+
+	ut_a(slot->reserved);
+
+	os_mutex_enter(ring->mutex);
+
+	os_aio_uring_prep(ring, slot);
+
+	if (!defer) {
+		os_uring_submit(ring);
+	}
+
+	os_mutex_exit(ring->mutex);
+
+	return(TRUE);
+}
+
+/******************************************************************//**
+Submits the deferred requests of all the rings of an aio array.
+@return number of requests submitted */
+static
+ulint
+os_aio_uring_submit_array(
+/*======================*/
+	os_aio_array_t*	array)	/*!< in: aio array, or NULL */
+{
+	ulint	n_submitted = 0;
+
+	if (array == NULL) {
+		return(0);
+	}
+
+	for (ulint i = 0; i < array->n_segments; ++i) {
+		os_uring_t*	ring = array->uring[i];
+
+		/* The requests that the calling thread deferred are
+		visible to it without the mutex. */
+		if (ring->n_queued == 0) {
+			continue;
+		}
+
+		os_mutex_enter(ring->mutex);
+		n_submitted += os_uring_submit(ring);
+		os_mutex_exit(ring->mutex);
+	}
+
+	return(n_submitted);
+}
+
+/******************************************************************//**
+This function is only used with io_uring. Waits for completions on the
+ring of a segment and marks the slots of the completed requests. Also
+submits the requests that were deferred on the ring if no completion
+arrives within the timeout, so that a forgotten batch can not stall
+the segment. */
+static
+void
+os_aio_uring_collect(
+/*=================*/
+	os_aio_array_t* array,		/*!< in/out: slot array. */
+	ulint		segment,	/*!< in: local segment no. */
+	ulint		seg_size)	/*!< in: segment size. */
+{
+	os_uring_t*	ring = array->uring[segment];
+	ulint		start_pos = segment * seg_size;
+	ulint		end_pos = start_pos + seg_size;
+
+	for (;;) {
+		ulint		n_reaped = 0;
+		io_uring_cqe*	cqe;
+
+		while ((cqe = os_uring_peek_cqe(ring)) != NULL) {
+			os_aio_slot_t*	slot = reinterpret_cast<os_aio_slot_t*>(
+				cqe->user_data);
+
+			ut_a(slot != NULL);
+			ut_a(slot->reserved);
+			ut_a(slot->pos >= start_pos);
+			ut_a(slot->pos < end_pos);
+
+			os_mutex_enter(array->mutex);
+			slot->n_bytes = cqe->res > 0 ? cqe->res : 0;
+			slot->ret = cqe->res < 0 ? cqe->res : 0;
+			slot->io_already_done = TRUE;
+			os_mutex_exit(array->mutex);
+
+			os_uring_cqe_seen(ring);
+			++n_reaped;
+		}
+
+		if (n_reaped > 0
+		    || srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS) {
+			return;
+		}
+
+		int	ret = os_uring_wait(ring, OS_AIO_REAP_TIMEOUT);
+
+		switch (ret) {
+		case -ETIME:
+			if (ring->n_queued > 0) {
+				os_mutex_enter(ring->mutex);
+				os_uring_submit(ring);
+				os_mutex_exit(ring->mutex);
+			}
+			/* fall through */
+		case 0:
+		case -EINTR:
+		case -EAGAIN:
+		case -EBUSY:
+			continue;
+		}
+
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"unexpected error %d from io_uring_enter()", -ret);
+	}
+}
+
+/******************************************************************//**
+Flushes a set of files through a flush ring: an fsync request for every
+file is submitted at once and the calling thread waits for all of them.
+A failed request is fatal, as it is in os_file_flush(). It is not retried:
+after a writeback error the kernel may already have dropped the dirty
+pages, and a second fsync could succeed without the data being on disk. */
+static
+void
+os_file_uring_flush_files(
+/*======================*/
+	pfs_os_file_t*	files,	/*!< in: files to flush */
+	ulint		n)	/*!< in: number of files */
+{
+	ulint		i = os_atomic_increment_ulint(&os_uring_flush_next, 1);
+	os_uring_t*	ring = os_uring_flush_rings[i % OS_URING_N_FLUSH_RINGS];
+
+	os_mutex_enter(ring->mutex);
+
+	ut_ad(ring->n_queued == 0);
+
+	for (ulint done = 0; done < n; ) {
+		ulint	batch = ut_min(n - done, (ulint) ring->sq_entries);
+
+		for (ulint j = done; j < done + batch; ++j) {
+			io_uring_sqe*	sqe = os_uring_get_sqe(ring);
+
+			ut_a(sqe != NULL);
+
+			sqe->opcode = IORING_OP_FSYNC;
+			os_uring_prep_file(sqe, files[j].m_file);
+			sqe->user_data = j;
+
+			os_uring_queue_sqe(ring);
+		}
+
+		os_uring_submit(ring);
+
+		for (ulint reaped = 0; reaped < batch; ) {
+			io_uring_cqe*	cqe = os_uring_peek_cqe(ring);
+
+			if (cqe == NULL) {
+				int	ret = os_uring_wait(
+					ring, OS_AIO_REAP_TIMEOUT);
+
+				if (ret != 0 && ret != -ETIME
+				    && ret != -EINTR && ret != -EAGAIN
+				    && ret != -EBUSY) {
+
+					ib_logf(IB_LOG_LEVEL_FATAL,
+						"unexpected error %d from "
+						"io_uring_enter()", -ret);
+				}
+
+				continue;
+			}
+
+			int	res = cqe->res;
+
+			os_uring_cqe_seen(ring);
+			++reaped;
+			++os_n_fsyncs;
+
+			if (res < 0) {
+				/* Since Linux returns EINVAL if the file is
+				actually a raw device, we choose to ignore
+				that error if we are using raw disks */
+				if (srv_start_raw_disk_in_use
+				    && res == -EINVAL) {
+					continue;
+				}
+
+				errno = -res;
+
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"The OS said file flush did not "
+					"succeed");
+
+				os_file_handle_error(NULL, "flush");
+
+				/* It is a fatal error if a file flush does
+				not succeed, because then the database can
+				get corrupt on disk */
+				ut_error;
+			}
+		}
+
+		done += batch;
+	}
+
+	os_mutex_exit(ring->mutex);
+}
+#endif /* LINUX_IO_URING */
+
+/******************************************************************//**
+Creates an aio wait array. Note that we return NULL in case of failure.
+We don't care about freeing memory here because we assume that a
+failure will result in server refusing to start up.
+@return	own: aio array, NULL on failure */
+static
+os_aio_array_t*
+os_aio_array_create(
+/*================*/
+	ulint	n,		/*!< in: maximum number of pending aio
+				operations allowed; n must be
+				divisible by n_segments */
+	ulint	n_segments)	/*!< in: number of segments in the aio array */
+{
+	os_aio_array_t*	array;
+#ifdef WIN_ASYNC_IO
+	OVERLAPPED*	over;
+#elif defined(LINUX_NATIVE_AIO)
+	struct io_event*	io_event = NULL;
+#endif /* WIN_ASYNC_IO */
+	ut_a(n > 0);
+	ut_a(n_segments > 0);
+
+	array = static_cast<os_aio_array_t*>(ut_malloc(sizeof(*array)));
+	memset(array, 0x0, sizeof(*array));
+
+	array->mutex = os_mutex_create();
+	array->not_full = os_event_create();
+	array->is_empty = os_event_create();
+
+	os_event_set(array->is_empty);
+
+	array->n_slots = n;
+	array->n_segments = n_segments;
+
+	array->slots = static_cast<os_aio_slot_t*>(
+		ut_malloc(n * sizeof(*array->slots)));
+
+	memset(array->slots, 0x0, sizeof(n * sizeof(*array->slots)));
+#ifdef __WIN__
+	array->handles = static_cast<HANDLE*>(ut_malloc(n * sizeof(HANDLE)));
+#endif /* __WIN__ */
+
+#if defined(LINUX_ASYNC_IO)
+	/* If we are not using native aio interface then skip this
+	part of initialization. */
+	if (!srv_use_native_aio) {
+		goto skip_native_aio;
+	}
+
+#if defined(LINUX_IO_URING)
+	if (srv_use_io_uring) {
+		/* One ring per segment, large enough for all the slots
+		of the segment. */
+		array->uring = static_cast<os_uring_t**>(
+			ut_malloc(n_segments * sizeof(*array->uring)));
+
+		for (ulint i = 0; i < n_segments; ++i) {
+			array->uring[i] = os_uring_create(n / n_segments);
+
+			if (array->uring[i] == NULL) {
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"io_uring setup failed with "
+					"error %d: %s", errno,
+					strerror(errno));
+				return(NULL);
+			}
+
+			os_uring_add_ring(array->uring[i]);
+		}
+
+		goto skip_native_aio;
+	}
+#endif /* LINUX_IO_URING */
+
+#if defined(LINUX_NATIVE_AIO)
+	/* Initialize the io_context array. One io_context
+	per segment in the array. */
+
+	array->aio_ctx = static_cast<io_context**>(
+		ut_malloc(n_segments * sizeof(*array->aio_ctx)));
+
+	for (ulint i = 0; i < n_segments; ++i) {
+		if (!os_aio_linux_create_io_ctx(n/n_segments,
+						&array->aio_ctx[i])) {
+			/* If something bad happened during aio setup
+			we should call it a day and return right away.
+			We don't care about any leaks because a failure
+			to initialize the io subsystem means that the
+			server (or atleast the innodb storage engine)
+			is not going to startup. */
+			return(NULL);
+		}
+	}
+
+	/* Initialize the event array. One event per slot. */
+	io_event = static_cast<struct io_event*>(
+		ut_malloc(n * sizeof(*io_event)));
+
+	memset(io_event, 0x0, sizeof(*io_event) * n);
+	array->aio_events = io_event;
+
+	array->pending = static_cast<struct iocb**>(
+		ut_malloc(n * sizeof(struct iocb*)));
+	memset(array->pending, 0x0, sizeof(struct iocb*) * n);
+	array->count = static_cast<ulint*>(
+		ut_malloc(n_segments * sizeof(ulint)));
+	memset(array->count, 0x0, sizeof(ulint) * n_segments);
+#endif /* LINUX_NATIVE_AIO */
+
+skip_native_aio:
+#endif /* LINUX_ASYNC_IO */
+	for (ulint i = 0; i < n; i++) {
+		os_aio_slot_t*	slot;
+
+		slot = os_aio_array_get_nth_slot(array, i);
+
+		slot->pos = i;
+		slot->reserved = FALSE;
+#ifdef WIN_ASYNC_IO
+		slot->handle = CreateEvent(NULL,TRUE, FALSE, NULL);
+
+		over = &slot->control;
+
+		over->hEvent = slot->handle;
+
+		array->handles[i] = over->hEvent;
+
+#elif defined(LINUX_ASYNC_IO)
+# if defined(LINUX_NATIVE_AIO)
+		memset(&slot->control, 0x0, sizeof(slot->control));
+# endif /* LINUX_NATIVE_AIO */
+		slot->n_bytes = 0;
+		slot->ret = 0;
+#endif /* WIN_ASYNC_IO */
+	}
+
+	return(array);
+}
+
+/************************************************************************//**
+Frees an aio wait array. */
+static
+void
+os_aio_array_free(
+/*==============*/
+	os_aio_array_t*& array)	/*!< in, own: array to free */
+{
+#ifdef WIN_ASYNC_IO
+	ulint	i;
+
+	for (i = 0; i < array->n_slots; i++) {
+		os_aio_slot_t*	slot = os_aio_array_get_nth_slot(array, i);
+		CloseHandle(slot->handle);
+	}
+#endif /* WIN_ASYNC_IO */
+
+#ifdef __WIN__
+	ut_free(array->handles);
+#endif /* __WIN__ */
+	os_mutex_free(array->mutex);
+	os_event_free(array->not_full);
+	os_event_free(array->is_empty);
+
+#if defined(LINUX_IO_URING)
+	if (array->uring != NULL) {
+		for (ulint i = 0; i < array->n_segments; ++i) {
+			os_uring_free(array->uring[i]);
+		}
+
+		ut_free(array->uring);
+	}
+#endif /* LINUX_IO_URING */
+#if defined(LINUX_NATIVE_AIO)
+	if (srv_use_native_aio && !srv_use_io_uring) {
+		ut_free(array->aio_events);
+		ut_free(array->aio_ctx);
+
+#ifdef UNIV_DEBUG
+		for (size_t idx = 0; idx < array->n_slots; ++idx)
+			ut_ad(array->pending[idx] == NULL);
+		for (size_t idx = 0; idx < array->n_segments; ++idx)
+			ut_ad(array->count[idx] == 0);
+#endif
+
+		ut_free(array->pending);
+		ut_free(array->count);
+	}
+#endif /* LINUX_NATIVE_AIO */
+
+	ut_free(array->slots);
+	ut_free(array);
+
+	array = 0;
+}
+
+/***********************************************************************
+Initializes the asynchronous io system. Creates one array each for ibuf
+and log i/o. Also creates one array each for read and write where each
+array is divided logically into n_read_segs and n_write_segs
+respectively. The caller must create an i/o handler thread for each
+segment in these arrays. This function also creates the sync array.
+No i/o handler thread needs to be created for that */
+UNIV_INTERN
+ibool
+os_aio_init(
+/*========*/
+	ulint	n_per_seg,	/*<! in: maximum number of pending aio
+				operations allowed per segment */
+	ulint	n_read_segs,	/*<! in: number of reader threads */
+	ulint	n_write_segs,	/*<! in: number of writer threads */
+	ulint	n_slots_sync)	/*<! in: number of slots in the sync aio
+				array */
+{
+	os_io_init_simple();
+
+#if defined(LINUX_IO_URING)
+	if (!srv_use_native_aio) {
+		srv_use_io_uring = FALSE;
+	} else if (srv_use_io_uring && !os_aio_uring_supported()) {
+
+		srv_use_io_uring = FALSE;
+
+# if defined(LINUX_NATIVE_AIO)
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"io_uring disabled, using Linux native AIO.");
+# else
+		ib_logf(IB_LOG_LEVEL_WARN, "io_uring disabled.");
+
+		srv_use_native_aio = FALSE;
+# endif /* LINUX_NATIVE_AIO */
+	}
+#endif /* LINUX_IO_URING */
+
+#if defined(LINUX_NATIVE_AIO)
+	/* Check if native aio is supported on this system and tmpfs */
+	if (srv_use_native_aio && !srv_use_io_uring
+	    && !os_aio_native_aio_supported()) {
+
+		ib_logf(IB_LOG_LEVEL_WARN, "Linux Native AIO disabled.");
+
+		srv_use_native_aio = FALSE;
+	}
+#endif /* LINUX_NATIVE_AIO */
+
+#if defined(LINUX_IO_URING)
+
+	if (srv_use_io_uring) {
+		ib_logf(IB_LOG_LEVEL_INFO, "Using io_uring for native AIO");
+
+		/* The read and write segments, the ibuf, log and sync
+		arrays and the flush rings */
+		os_uring_max_rings = n_read_segs + n_write_segs + 3
+			+ OS_URING_N_FLUSH_RINGS;
+		os_uring_rings = static_cast<os_uring_t**>(
+			ut_malloc(os_uring_max_rings
+				  * sizeof(*os_uring_rings)));
+		os_uring_n_rings = 0;
+
+		struct rlimit	limit;
+
+		os_uring_n_files = OS_URING_MAX_FILES;
+
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0
+		    && limit.rlim_cur < os_uring_n_files) {
+
+			os_uring_n_files = (ulint) limit.rlim_cur;
+		}
+
+		os_uring_file_registered = static_cast<bool*>(
+			ut_malloc(os_uring_n_files
+				  * sizeof(*os_uring_file_registered)));
+		memset(os_uring_file_registered, 0x0,
+		       os_uring_n_files * sizeof(*os_uring_file_registered));
+
+		os_uring_files_mutex = os_mutex_create();
+	}
+#endif /* LINUX_IO_URING */
+
+	srv_reset_io_thread_op_info();
+
+	os_aio_read_array = os_aio_array_create(
+		n_read_segs * n_per_seg, n_read_segs);
+
+	if (os_aio_read_array == NULL) {
+		return(FALSE);
+	}
+
+	ulint	start = (srv_read_only_mode) ? 0 : 2;
+	ulint	n_segs = n_read_segs + start;
+
+	/* 0 is the ibuf segment and 1 is the insert buffer segment. */
+	for (ulint i = start; i < n_segs; ++i) {
+		ut_a(i < SRV_MAX_N_IO_THREADS);
+		srv_io_thread_function[i] = "read thread";
+	}
+
+	ulint	n_segments = n_read_segs;
+
+	if (!srv_read_only_mode) {
+
+		os_aio_log_array = os_aio_array_create(n_per_seg, 1);
+
+		if (os_aio_log_array == NULL) {
+			return(FALSE);
+		}
+
+		++n_segments;
+
+		srv_io_thread_function[1] = "log thread";
+
+		os_aio_ibuf_array = os_aio_array_create(n_per_seg, 1);
+
+		if (os_aio_ibuf_array == NULL) {
+			return(FALSE);
+		}
+
+		++n_segments;
+
+		srv_io_thread_function[0] = "insert buffer thread";
+
+		os_aio_write_array = os_aio_array_create(
 			n_write_segs * n_per_seg, n_write_segs);
 
 		if (os_aio_write_array == NULL) {
@@ -4273,6 +5242,25 @@ os_aio_init(
 		return(FALSE);
 	}
 
+#if defined(LINUX_IO_URING)
+	if (srv_use_io_uring) {
+		for (ulint i = 0; i < OS_URING_N_FLUSH_RINGS; ++i) {
+			os_uring_flush_rings[i] = os_uring_create(
+				OS_URING_FLUSH_RING_SIZE);
+
+			if (os_uring_flush_rings[i] == NULL) {
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"io_uring setup failed with "
+					"error %d: %s", errno,
+					strerror(errno));
+				return(FALSE);
+			}
+
+			os_uring_add_ring(os_uring_flush_rings[i]);
+		}
+	}
+#endif /* LINUX_IO_URING */
+
 	os_aio_n_segments = n_segments;
 
 	os_aio_validate();
@@ -4315,6 +5303,34 @@ os_aio_free(void)
 
 	os_aio_array_free(os_aio_read_array);
 
+#if defined(LINUX_IO_URING)
+	if (os_uring_rings != NULL) {
+		for (ulint i = 0; i < OS_URING_N_FLUSH_RINGS; ++i) {
+			if (os_uring_flush_rings[i] != NULL) {
+				os_uring_free(os_uring_flush_rings[i]);
+				os_uring_flush_rings[i] = NULL;
+			}
+		}
+
+		ut_free(os_uring_rings);
+		os_uring_rings = NULL;
+		os_uring_n_rings = 0;
+		os_uring_max_rings = 0;
+
+		ut_free(os_uring_bufs);
+		os_uring_bufs = NULL;
+		os_uring_n_bufs = 0;
+
+		/* Files that are closed later need not be
+		unregistered. */
+		os_uring_n_files = 0;
+		ut_free(os_uring_file_registered);
+		os_uring_file_registered = NULL;
+		os_mutex_free(os_uring_files_mutex);
+		os_uring_files_mutex = NULL;
+	}
+#endif /* LINUX_IO_URING */
+
 	for (ulint i = 0; i < os_aio_n_segments; i++) {
 		os_event_free(os_aio_segment_wait_events[i]);
 	}
@@ -4374,7 +5390,7 @@ os_aio_wake_all_threads_at_shutdown(void)
 		os_aio_array_wake_win_aio_at_shutdown(os_aio_log_array);
 	}
 
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
 
 	/* When using native AIO interface the io helper threads
 	wait on io_getevents with a timeout value of 500ms. At
@@ -4548,9 +5564,10 @@ loop:
 	if (array->n_reserved == array->n_slots) {
 		os_mutex_exit(array->mutex);
 
-		if (!srv_use_native_aio) {
+		if (!srv_use_native_aio || srv_use_io_uring) {
 			/* If the handler threads are suspended, wake them
-			so that we get more slots */
+			so that we get more slots. With io_uring this
+			submits the requests of unfinished batches. */
 
 			os_aio_simulated_wake_handler_threads();
 		}
@@ -4673,10 +5690,12 @@ os_aio_array_free_slot(
 
 	ResetEvent(slot->handle);
 
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
 
 	if (srv_use_native_aio) {
+# if defined(LINUX_NATIVE_AIO)
 		memset(&slot->control, 0x0, sizeof(slot->control));
+# endif /* LINUX_NATIVE_AIO */
 		slot->n_bytes = 0;
 		slot->ret = 0;
 		/*fprintf(stderr, "Freed up Linux native slot.\n");*/
@@ -4747,6 +5766,18 @@ os_aio_simulated_wake_handler_threads(void)
 /*=======================================*/
 {
 	if (srv_use_native_aio) {
+#if defined(LINUX_IO_URING)
+		if (srv_use_io_uring) {
+			/* Submit the requests that were posted with
+			OS_AIO_SIMULATED_WAKE_LATER as one batch per
+			segment. */
+			os_aio_uring_submit_array(os_aio_read_array);
+			os_aio_uring_submit_array(os_aio_write_array);
+			os_aio_uring_submit_array(os_aio_ibuf_array);
+			os_aio_uring_submit_array(os_aio_log_array);
+		}
+#endif /* LINUX_IO_URING */
+
 		/* We do not use simulated aio: do nothing */
 
 		return;
@@ -4807,6 +5838,13 @@ os_aio_dispatch_read_array_submit_low(bool acquire_mutex MY_ATTRIBUTE((unused)))
 	if (!srv_use_native_aio) {
 		return;
 	}
+#if defined(LINUX_IO_URING)
+	if (srv_use_io_uring) {
+		srv_stats.n_aio_submitted.add(
+			os_aio_uring_submit_array(os_aio_read_array));
+		return;
+	}
+#endif /* LINUX_IO_URING */
 #if defined(LINUX_NATIVE_AIO)
 	os_aio_array_t*	array = os_aio_read_array;
 	ulint		total_submitted = 0;
@@ -4873,7 +5911,145 @@ os_aio_dispatch_read_array_submit()
 	os_aio_dispatch_read_array_submit_low(true);
 }
 
-#if defined(LINUX_NATIVE_AIO)
+/***********************************************************************//**
+Registers memory areas, normally the buffer pool chunks, as fixed buffers
+with the io_uring instances of the aio arrays. Reads and writes of pages
+that lie within them then skip mapping the pages on every request. Must be
+called once after os_aio_init() and before any asynchronous i/o on the
+areas is posted. Does nothing unless io_uring is used. */
+UNIV_INTERN
+void
+os_aio_register_buffers(
+/*====================*/
+	void* const*	mem,	/*!< in: start addresses of the areas */
+	const ulint*	size,	/*!< in: sizes of the areas in bytes */
+	ulint		n)	/*!< in: number of areas */
+{
+#if defined(LINUX_IO_URING)
+	if (!srv_use_io_uring || n == 0) {
+		return;
+	}
+
+	ut_a(os_uring_n_bufs == 0);
+
+	/* A fixed buffer can be at most 1GB, split the areas. */
+	ulint	n_bufs = 0;
+
+	for (ulint i = 0; i < n; ++i) {
+		n_bufs += (size[i] + OS_URING_MAX_BUF_SIZE - 1)
+			/ OS_URING_MAX_BUF_SIZE;
+	}
+
+	os_uring_buf_t*	bufs = static_cast<os_uring_buf_t*>(
+		ut_malloc(n_bufs * sizeof(*bufs)));
+
+	n_bufs = 0;
+
+	for (ulint i = 0; i < n; ++i) {
+		const byte*	start = static_cast<const byte*>(mem[i]);
+
+		for (ulint offset = 0; offset < size[i];
+		     offset += OS_URING_MAX_BUF_SIZE) {
+
+			bufs[n_bufs].start = start + offset;
+			bufs[n_bufs].len = ut_min(size[i] - offset,
+						  OS_URING_MAX_BUF_SIZE);
+			++n_bufs;
+		}
+	}
+
+	std::sort(bufs, bufs + n_bufs, os_uring_buf_less);
+
+	struct iovec*	iov = static_cast<struct iovec*>(
+		ut_malloc(n_bufs * sizeof(*iov)));
+
+	for (ulint i = 0; i < n_bufs; ++i) {
+		iov[i].iov_base = const_cast<byte*>(bufs[i].start);
+		iov[i].iov_len = bufs[i].len;
+	}
+
+	os_aio_array_t*	arrays[] = {
+		os_aio_read_array, os_aio_write_array,
+		os_aio_ibuf_array, os_aio_log_array
+	};
+
+	bool	ok = true;
+	int	err = 0;
+
+	for (ulint i = 0; ok && i < UT_ARR_SIZE(arrays); ++i) {
+		for (ulint j = 0;
+		     arrays[i] != NULL && j < arrays[i]->n_segments;
+		     ++j) {
+
+			int	ret = (int) syscall(
+				__NR_io_uring_register,
+				arrays[i]->uring[j]->fd,
+				(unsigned) IORING_REGISTER_BUFFERS,
+				iov, (unsigned) n_bufs);
+
+			if (ret < 0) {
+				err = errno;
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	ut_free(iov);
+
+	if (ok) {
+		os_uring_bufs = bufs;
+		os_uring_n_bufs = n_bufs;
+		return;
+	}
+
+	ib_logf(IB_LOG_LEVEL_WARN,
+		"Registering the buffer pool with io_uring failed with "
+		"error %d: %s. Consider raising the locked memory limit "
+		"(ulimit -l).", err, strerror(err));
+
+	/* Unregistering fails harmlessly on the rings where the
+	registration was not done. */
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+		for (ulint j = 0;
+		     arrays[i] != NULL && j < arrays[i]->n_segments;
+		     ++j) {
+
+			syscall(__NR_io_uring_register,
+				arrays[i]->uring[j]->fd,
+				(unsigned) IORING_UNREGISTER_BUFFERS,
+				NULL, 0U);
+		}
+	}
+
+	ut_free(bufs);
+#endif /* LINUX_IO_URING */
+}
+
+/***********************************************************************//**
+Flushes the write buffers of a set of files to the disk. With io_uring the
+fsync requests of all the files are in flight at the same time, otherwise
+the files are flushed one by one with os_file_flush(). */
+UNIV_INTERN
+void
+os_file_flush_files(
+/*================*/
+	pfs_os_file_t*	files,	/*!< in: files to flush */
+	ulint		n)	/*!< in: number of files */
+{
+#if defined(LINUX_IO_URING)
+	if (srv_use_io_uring && n > 1) {
+		os_file_uring_flush_files(files, n);
+		return;
+	}
+#endif /* LINUX_IO_URING */
+
+	for (ulint i = 0; i < n; ++i) {
+		os_file_flush(files[i]);
+	}
+}
+
+#if defined(LINUX_ASYNC_IO)
 /*******************************************************************//**
 Dispatch an AIO request to the kernel.
 @return	TRUE on success. */
@@ -4886,6 +6062,13 @@ os_aio_linux_dispatch(
 	bool		should_buffer)	/*!< in: should buffer the request
 					rather than submit. */
 {
+#if defined(LINUX_IO_URING)
+	if (array->uring != NULL) {
+		return(os_aio_uring_dispatch(array, slot, should_buffer));
+	}
+#endif /* LINUX_IO_URING */
+
+#if defined(LINUX_NATIVE_AIO)
 	int		ret;
 	struct iocb*	iocb;
 
@@ -4940,8 +6123,12 @@ os_aio_linux_dispatch(
 	}
 
 	return(TRUE);
-}
+#else
+	ut_error;
+	return(FALSE);
 #endif /* LINUX_NATIVE_AIO */
+}
+#endif /* LINUX_ASYNC_IO */
 
 
 /*******************************************************************//**
@@ -5073,16 +6260,24 @@ try_again:
 		break;
 	case OS_AIO_SYNC:
 		array = os_aio_sync_array;
-#if defined(LINUX_NATIVE_AIO)
+#if defined(LINUX_ASYNC_IO)
 		/* In Linux native AIO we don't use sync IO array. */
 		ut_a(!srv_use_native_aio);
-#endif /* LINUX_NATIVE_AIO */
+#endif /* LINUX_ASYNC_IO */
 		break;
 	default:
 		ut_error;
 		array = NULL; /* Eliminate compiler warning */
 	}
 
+#if defined(LINUX_IO_URING)
+	if (srv_use_io_uring && wake_later) {
+		/* The caller submits the batch later, queue the request
+		until then. */
+		should_buffer = true;
+	}
+#endif /* LINUX_IO_URING */
+
 	if (trx && type == OS_FILE_READ)
 	{
 		trx->io_reads++;
@@ -5097,7 +6292,7 @@ try_again:
 #ifdef WIN_ASYNC_IO
 			ret = ReadFile(file.m_file, buf, (DWORD) n, &len,
 				       &(slot->control));
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
 			if (!os_aio_linux_dispatch(array, slot,
 						   should_buffer)) {
 				goto err_exit;
@@ -5117,8 +6312,10 @@ try_again:
 #ifdef WIN_ASYNC_IO
 			ret = WriteFile(file.m_file, buf, (DWORD) n, &len,
 					&(slot->control));
-#elif defined(LINUX_NATIVE_AIO)
-			if (!os_aio_linux_dispatch(array, slot, false)) {
+#elif defined(LINUX_ASYNC_IO)
+			if (!os_aio_linux_dispatch(array, slot,
+						   srv_use_io_uring
+						   && should_buffer)) {
 				goto err_exit;
 			}
 #endif /* WIN_ASYNC_IO */
@@ -5162,9 +6359,9 @@ try_again:
 	/* aio was queued successfully! */
 	return(TRUE);
 
-#if defined LINUX_NATIVE_AIO || defined WIN_ASYNC_IO
+#if defined LINUX_ASYNC_IO || defined WIN_ASYNC_IO
 err_exit:
-#endif /* LINUX_NATIVE_AIO || WIN_ASYNC_IO */
+#endif /* LINUX_ASYNC_IO || WIN_ASYNC_IO */
 	os_aio_array_free_slot(array, slot);
 
 	if (os_file_handle_error(
@@ -5472,7 +6669,9 @@ retry:
 		ret);
 	ut_error;
 }
+#endif /* LINUX_NATIVE_AIO */
 
+#if defined(LINUX_ASYNC_IO)
 /**********************************************************************//**
 This function is only used in Linux native asynchronous i/o.
 Waits for an aio operation to complete. This function is used to wait for
@@ -5549,7 +6748,15 @@ os_aio_linux_handle(
 
 		srv_set_io_thread_op_info(global_seg,
 			"waiting for completed aio requests");
+#if defined(LINUX_IO_URING)
+		if (array->uring != NULL) {
+			os_aio_uring_collect(array, segment, n);
+			continue;
+		}
+#endif /* LINUX_IO_URING */
+#if defined(LINUX_NATIVE_AIO)
 		os_aio_linux_collect(array, segment, n);
+#endif /* LINUX_NATIVE_AIO */
 	}
 
 found:
@@ -5579,14 +6786,30 @@ found:
 	} else if ((slot->ret == 0) && (slot->n_bytes > 0)
 		   && (slot->n_bytes < (long) slot->len)) {
 		/* Partial read or write scenario */
-		int submit_ret;
-		struct iocb*    iocb;
 		slot->buf = (byte*)slot->buf + slot->n_bytes;
 		slot->offset = slot->offset + slot->n_bytes;
 		slot->len = slot->len - slot->n_bytes;
 		/* Resetting the bytes read/written */
 		slot->n_bytes = 0;
 		slot->io_already_done = FALSE;
+#if defined(LINUX_IO_URING)
+		if (array->uring != NULL) {
+			os_uring_t*	ring = array->uring[segment];
+
+			os_mutex_enter(ring->mutex);
+			os_aio_uring_prep(ring, slot);
+			os_uring_submit(ring);
+			os_mutex_exit(ring->mutex);
+
+			ret = FALSE;
+			os_mutex_exit(array->mutex);
+			goto wait_for_event;
+		}
+#endif /* LINUX_IO_URING */
+#if defined(LINUX_NATIVE_AIO)
+		int submit_ret;
+		struct iocb*    iocb;
+
 		iocb = &(slot->control);
 
 		if (slot->type == OS_FILE_READ) {
@@ -5613,6 +6836,7 @@ found:
 			os_mutex_exit(array->mutex);
 			goto wait_for_event;
 		}
+#endif /* LINUX_NATIVE_AIO */
 	} else {
 		errno = -slot->ret;
 
@@ -5634,7 +6858,7 @@ found:
 
 	return(ret);
 }
-#endif /* LINUX_NATIVE_AIO */
+#endif /* LINUX_ASYNC_IO */
 
 /**********************************************************************//**
 Does simulated aio. This function should be called by an i/o-handler
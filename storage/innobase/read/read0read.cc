@@ -31,6 +31,7 @@ Created 2/16/1997 Heikki Tuuri
 #endif
 
 #include "srv0srv.h"
+#include "srv0mon.h"
 #include "trx0sys.h"
 
 /*
@@ -193,6 +194,20 @@ read_view_create_low(
 					  sizeof(read_view_t));
 		view->max_descr = 0;
 		view->descriptors = NULL;
+		view->state = VIEW_OPEN;
+	} else if (view->state != VIEW_OPEN) {
+
+		/* The view was closed by read_view_close_lazy() and could
+		not be reused, remove it from the view list before it gets
+		rebuilt unless read_view_get_oldest() already did. */
+
+		ut_ad(mutex_own(&trx_sys->mutex));
+
+		if (view->state == VIEW_CLOSED) {
+			UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
+		}
+
+		view->state = VIEW_OPEN;
 	}
 
 	if (UNIV_UNLIKELY(view->max_descr < n)) {
@@ -245,6 +260,10 @@ read_view_clone(
 	clone->descriptors = old_descriptors;
 	clone->max_descr = old_max_descr;
 
+	/* The view may have been closed by its owner in the meantime, the
+	clone is not in the view list yet. */
+	clone->state = VIEW_OPEN;
+
 	if (view->n_descr) {
 		memcpy(clone->descriptors, view->descriptors,
 		       view->n_descr * sizeof(trx_id_t));
@@ -308,6 +327,7 @@ read_view_open_now_low(
 	view->undo_no = 0;
 	view->type = VIEW_NORMAL;
 	view->creator_trx_id = cr_trx_id;
+	view->descr_version = trx_sys->descr_version;
 
 	/* No future transactions should be visible in the view */
 
@@ -372,6 +392,56 @@ read_view_open_now_low(
 	return(view);
 }
 
+/*********************************************************************//**
+Tries to reopen a read view closed by read_view_close_lazy() without
+acquiring trx_sys->mutex. This is possible if no read-write transaction has
+started or finished since the view was opened: the set of active read-write
+transactions is then the same and the transaction ids assigned in the meantime
+belong to read-only transactions, which cannot modify any record.
+@return	true if the view has been reopened */
+static
+bool
+read_view_reopen(
+/*=============*/
+	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
+					transaction */
+	read_view_t*	view)		/*!< in/out: closed read view */
+{
+	ut_ad(view->state != VIEW_OPEN);
+
+	if (view->descr_version != trx_sys->descr_version) {
+
+		return(false);
+	}
+
+	/* Reopen the view before checking trx_sys->descr_version again.
+	Purge skips closed views, so that a read-write transaction could
+	have started or finished before it noticed the reopened view. The
+	compare-and-swap acts as a full memory barrier to order the store
+	to view->state with the load of trx_sys->descr_version. It fails
+	if read_view_get_oldest() has found the view out of date and
+	removed it from the view list in the meantime. */
+
+	if (!os_compare_and_swap_ulint(&view->state, VIEW_CLOSED, VIEW_OPEN)) {
+
+		return(false);
+	}
+
+	if (view->descr_version != trx_sys->descr_version) {
+
+		view->state = VIEW_CLOSED;
+		os_wmb;
+
+		return(false);
+	}
+
+	view->creator_trx_id = cr_trx_id;
+
+	MONITOR_INC(MONITOR_TRX_READ_VIEW_REUSE);
+
+	return(true);
+}
+
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
 point in time are seen in the view.
@@ -385,6 +455,21 @@ read_view_open_now(
 	read_view_t*&	view)		/*!< in,out: pre-allocated view array or
 					NULL if a new one needs to be created */
 {
+	if (view != NULL && view->state != VIEW_OPEN) {
+
+		if (read_view_reopen(cr_trx_id, view)) {
+
+			return(view);
+		}
+	} else {
+
+		/* Size the descriptors array outside trx_sys->mutex, based
+		on a dirty read of the number of used descriptors. It will be
+		resized under the mutex if it turns out to be too small. */
+
+		view = read_view_create_low(trx_sys->descr_n_used, view);
+	}
+
 	mutex_enter(&trx_sys->mutex);
 
 	view = read_view_open_now_low(cr_trx_id, view);
@@ -418,7 +503,7 @@ read_view_purge_open(
 
 	mutex_enter(&trx_sys->mutex);
 
-	oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
+	oldest_view = read_view_get_oldest();
 
 	if (oldest_view == NULL) {
 
@@ -545,9 +630,9 @@ read_fill_i_s_xtradb_read_view(i_s_xtradb_read_view_t* rv)
 
 	mutex_enter(&trx_sys->mutex);
 
-	if (UT_LIST_GET_LEN(trx_sys->view_list)) {
-		view = UT_LIST_GET_LAST(trx_sys->view_list);
-	} else {
+	view = read_view_get_oldest();
+
+	if (view == NULL) {
 		mutex_exit(&trx_sys->mutex);
 		return NULL;
 	}
@@ -580,6 +665,21 @@ read_view_free(
 		return;
 	}
 
+	if (view->state != VIEW_OPEN) {
+
+		/* The view was left in the view list by
+		read_view_close_lazy(), unless read_view_get_oldest()
+		removed it */
+
+		mutex_enter(&trx_sys->mutex);
+
+		if (view->state == VIEW_CLOSED) {
+			UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
+		}
+
+		mutex_exit(&trx_sys->mutex);
+	}
+
 	os_atomic_decrement_lint(&srv_read_views_memory,
 				 sizeof(read_view_t) +
 				 view->max_descr * sizeof(trx_id_t));
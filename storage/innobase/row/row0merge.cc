@@ -2353,6 +2353,220 @@ row_merge(
 	return(DB_SUCCESS);
 }
 
+/** A merge pass of row_merge_sort() whose runs are merged by several
+threads, see row_merge_pass_parallel() */
+struct row_merge_pass_t {
+	trx_t*			trx;		/*!< transaction */
+	const row_merge_dup_t*	dup;		/*!< descriptor of index
+						being created */
+	const merge_file_t*	file;		/*!< input file */
+	int			out_fd;		/*!< output file */
+	const ulint*		run_offset;	/*!< first offset of each
+						input run */
+	const ulint*		out_offset;	/*!< first offset of each
+						output run */
+	ulint			n_first;	/*!< number of runs in the
+						first half of the input; run
+						k is merged with run
+						n_first + k */
+	ulint			n_out;		/*!< number of output runs */
+	ulint			next;		/*!< output run to be picked
+						next by a thread; incremented
+						atomically */
+	ulint			n_rec;		/*!< number of records written;
+						incremented atomically */
+	dberr_t			error;		/*!< DB_SUCCESS, or the error
+						that stops the pass */
+};
+
+/** A thread of a parallel merge pass */
+struct row_merge_pass_thread_t {
+	row_merge_pass_t*	pass;		/*!< the merge pass */
+	row_merge_block_t*	block;		/*!< 3 buffers of the thread */
+};
+
+/*************************************************************//**
+Merge runs of a parallel merge pass until no run is left to be picked
+or the pass fails. Each output run is written to its own range of the
+output file, so the threads do not need to coordinate their writes. */
+static
+void
+row_merge_pass_work(
+/*================*/
+	row_merge_pass_t*	pass,	/*!< in/out: merge pass */
+	row_merge_block_t*	block)	/*!< in/out: 3 buffers */
+{
+	for (;;) {
+		ulint		i = os_atomic_increment_ulint(&pass->next, 1) - 1;
+		merge_file_t	of;
+		dberr_t		error;
+
+		if (i >= pass->n_out || pass->error != DB_SUCCESS) {
+			break;
+		}
+
+		if (trx_is_interrupted(pass->trx)) {
+			pass->error = DB_INTERRUPTED;
+			break;
+		}
+
+		of.fd = pass->out_fd;
+		of.offset = pass->out_offset[i];
+		of.n_rec = 0;
+
+		if (i < pass->n_first) {
+			ulint	foffs0 = pass->run_offset[i];
+			ulint	foffs1 = pass->run_offset[pass->n_first + i];
+
+			error = row_merge_blocks(pass->dup, pass->file, block,
+						 &foffs0, &foffs1, &of);
+		} else {
+			ulint	foffs1 = pass->run_offset[pass->n_first + i];
+
+			error = row_merge_blocks_copy(
+				pass->dup->index, pass->file, block,
+				&foffs1, &of)
+				? DB_SUCCESS : DB_CORRUPTION;
+		}
+
+		if (error != DB_SUCCESS) {
+			pass->error = error;
+			break;
+		}
+
+		os_atomic_increment_ulint(&pass->n_rec, of.n_rec);
+	}
+}
+
+/*********************************************************************//**
+Thread of a parallel merge pass.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pass_thread)(
+/*==================================*/
+	void*	arg)	/*!< in/out: row_merge_pass_thread_t */
+{
+	row_merge_pass_thread_t*	thr
+		= static_cast<row_merge_pass_thread_t*>(arg);
+
+	my_thread_init();
+
+	row_merge_pass_work(thr->pass, thr->block);
+
+	my_thread_end();
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*************************************************************//**
+Merge disk files with several threads. Like row_merge(), this merges
+run k of the first half of the input with run k of the second half, but
+the output runs are merged in parallel. A merged run is never longer
+than its two input runs together, so each output run is written at the
+offset where its input runs start, counted as if the two halves of the
+input were interleaved. The output runs may then be followed by unused
+blocks, which is why every pass of the sort must be done by this
+function once the first one was.
+@return	DB_SUCCESS or error code */
+static MY_ATTRIBUTE((nonnull))
+dberr_t
+row_merge_pass_parallel(
+/*====================*/
+	trx_t*			trx,	/*!< in: transaction */
+	const row_merge_dup_t*	dup,	/*!< in: descriptor of
+					index being created */
+	merge_file_t*		file,	/*!< in/out: file containing
+					index entries */
+	row_merge_block_t**	blocks,	/*!< in/out: 3 buffers for
+					each thread */
+	ulint			n_threads,/*!< in: number of elements
+					in blocks[] */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint*			num_run,/*!< in/out: Number of runs remain
+					to be merged */
+	ulint*			run_offset) /*!< in/out: Array contains the
+					first offset number for each merge
+					run */
+{
+	row_merge_pass_t		pass;
+	row_merge_pass_thread_t*	thrs;
+	os_thread_t*			threads;
+	ulint*				out_offset;
+	const ulint			n_first = *num_run / 2;
+	const ulint			n_out = *num_run - n_first;
+	const ulint			ihalf = run_offset[n_first];
+	ulint				i;
+
+	ut_ad(ihalf < file->offset);
+
+	out_offset = static_cast<ulint*>(
+		mem_alloc(n_out * sizeof *out_offset));
+
+	for (i = 0; i < n_out; i++) {
+		out_offset[i] = run_offset[n_first + i] - ihalf
+			+ (i < n_first ? run_offset[i] : ihalf);
+	}
+
+	pass.trx = trx;
+	pass.dup = dup;
+	pass.file = file;
+	pass.out_fd = *tmpfd;
+	pass.run_offset = run_offset;
+	pass.out_offset = out_offset;
+	pass.n_first = n_first;
+	pass.n_out = n_out;
+	pass.next = 0;
+	pass.n_rec = 0;
+	pass.error = DB_SUCCESS;
+
+	n_threads = ut_min(n_threads, n_out);
+
+	thrs = static_cast<row_merge_pass_thread_t*>(
+		mem_alloc(n_threads * sizeof *thrs));
+	threads = static_cast<os_thread_t*>(
+		mem_alloc(n_threads * sizeof *threads));
+
+	/* The calling thread merges runs too, with blocks[0]. */
+	for (i = 1; i < n_threads; i++) {
+		thrs[i].pass = &pass;
+		thrs[i].block = blocks[i];
+		threads[i] = os_thread_create(
+			row_merge_pass_thread, &thrs[i], NULL);
+	}
+
+	row_merge_pass_work(&pass, blocks[0]);
+
+	for (i = 1; i < n_threads; i++) {
+		os_thread_join(threads[i]);
+	}
+
+	mem_free(threads);
+	mem_free(thrs);
+
+	if (pass.error == DB_SUCCESS && pass.n_rec != file->n_rec) {
+		pass.error = DB_CORRUPTION;
+	}
+
+	if (pass.error == DB_SUCCESS) {
+		memcpy(run_offset, out_offset, n_out * sizeof *run_offset);
+		*num_run = n_out;
+
+		/* Swap file descriptors for the next pass. The output
+		runs take up at most as many blocks as the input. */
+		const int	fd = file->fd;
+
+		file->fd = *tmpfd;
+		*tmpfd = fd;
+	}
+
+	mem_free(out_offset);
+
+	return(pass.error);
+}
+
 /*************************************************************//**
 Merge disk files.
 @return	DB_SUCCESS or error code */
@@ -2366,12 +2580,17 @@ row_merge_sort(
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
 	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	int*			tmpfd)	/*!< in/out: temporary file handle */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint			n_threads)/*!< in: number of threads
+					merging the runs of each pass,
+					1 for none */
 {
-	const ulint	half	= file->offset / 2;
-	ulint		num_runs;
-	ulint*		run_offset;
-	dberr_t		error	= DB_SUCCESS;
+	const ulint		half	= file->offset / 2;
+	ulint			num_runs;
+	ulint*			run_offset;
+	row_merge_block_t**	blocks	= NULL;
+	ulint			block_size = 3 * srv_sort_buf_size;
+	dberr_t			error	= DB_SUCCESS;
 	DBUG_ENTER("row_merge_sort");
 
 	/* Record the number of merge runs we need to perform */
@@ -2393,10 +2612,42 @@ row_merge_sort(
 	of file marker).  Thus, it must be at least one block. */
 	ut_ad(file->offset > 0);
 
+	/* There are never more than num_runs / 2 runs to merge in
+	parallel. The other threads need sort buffers of their own. */
+	n_threads = ut_min(n_threads, num_runs / 2);
+
+	if (n_threads > 1) {
+		blocks = static_cast<row_merge_block_t**>(
+			mem_alloc(n_threads * sizeof *blocks));
+
+		blocks[0] = block;
+
+		for (ulint i = 1; i < n_threads; i++) {
+			blocks[i] = static_cast<row_merge_block_t*>(
+				os_mem_alloc_large(&block_size));
+
+			if (blocks[i] == NULL) {
+				n_threads = i;
+				break;
+			}
+		}
+
+		/* Every block is a run of its own at first. */
+		for (ulint i = 0; i < num_runs; i++) {
+			run_offset[i] = i;
+		}
+	}
+
 	/* Merge the runs until we have one big run */
 	do {
-		error = row_merge(trx, dup, file, block, tmpfd,
-				  &num_runs, run_offset);
+		if (n_threads > 1) {
+			error = row_merge_pass_parallel(
+				trx, dup, file, blocks, n_threads, tmpfd,
+				&num_runs, run_offset);
+		} else {
+			error = row_merge(trx, dup, file, block, tmpfd,
+					  &num_runs, run_offset);
+		}
 
 		if (error != DB_SUCCESS) {
 			break;
@@ -2405,6 +2656,14 @@ row_merge_sort(
 		UNIV_MEM_ASSERT_RW(run_offset, num_runs * sizeof *run_offset);
 	} while (num_runs > 1);
 
+	if (blocks != NULL) {
+		for (ulint i = 1; i < n_threads; i++) {
+			os_mem_free_large(blocks[i], block_size);
+		}
+
+		mem_free(blocks);
+	}
+
 	mem_free(run_offset);
 
 	DBUG_RETURN(error);
@@ -3615,6 +3874,186 @@ row_merge_drop_table(
 	return(row_drop_table_for_mysql(table->name, trx, false, false));
 }
 
+/** State shared by the threads that sort and load secondary indexes
+in parallel, see row_merge_sort_parallel() */
+struct row_merge_psort_t {
+	trx_t*			trx;		/*!< transaction */
+	dict_table_t*		old_table;	/*!< table where rows are
+						read from */
+	struct TABLE*		table;		/*!< MySQL table */
+	const ulint*		col_map;	/*!< mapping of old column
+						numbers to new ones, or NULL */
+	const char*		path;		/*!< directory for temporary
+						files, or NULL for tmpdir */
+	dict_index_t**		indexes;	/*!< indexes to be created */
+	merge_file_t*		merge_files;	/*!< merge files of indexes[] */
+	ulint			n_indexes;	/*!< size of indexes[] */
+	dberr_t*		errors;		/*!< out: error code of each
+						index sorted by the threads */
+	ulint			next;		/*!< index in indexes[] to be
+						picked next by a thread;
+						incremented atomically */
+};
+
+/*********************************************************************//**
+Check if an index can be sorted and loaded by a parallel sort thread.
+Unique indexes stay in the calling thread, because reporting a duplicate
+key writes the key value to the shared MySQL record buffer.
+@return	true if the index can be sorted in parallel */
+static
+bool
+row_merge_is_parallel_sort(
+/*=======================*/
+	const dict_index_t*	index,	/*!< in: index to be created */
+	const merge_file_t*	file)	/*!< in: merge file of the index */
+{
+	return(!(index->type & (DICT_FTS | DICT_UNIQUE)) && file->fd != -1);
+}
+
+/*********************************************************************//**
+Thread that merge sorts the files of secondary indexes and inserts the
+sorted entries to the indexes, until no index is left to be picked.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_sort_thread)(
+/*==================================*/
+	void*	arg)	/*!< in/out: row_merge_psort_t */
+{
+	row_merge_psort_t*	psort = static_cast<row_merge_psort_t*>(arg);
+	row_merge_block_t*	block;
+	ulint			block_size = 3 * srv_sort_buf_size;
+	int			tmpfd = -1;
+
+	my_thread_init();
+
+	block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&block_size));
+
+	for (;;) {
+		ulint	i = os_atomic_increment_ulint(&psort->next, 1) - 1;
+
+		if (i >= psort->n_indexes) {
+			break;
+		}
+
+		dict_index_t*	index = psort->indexes[i];
+		merge_file_t*	file = &psort->merge_files[i];
+		dberr_t		error;
+
+		if (!row_merge_is_parallel_sort(index, file)) {
+			continue;
+		}
+
+		if (block == NULL
+		    || row_merge_tmpfile_if_needed(&tmpfd, psort->path) < 0) {
+			psort->errors[i] = DB_OUT_OF_MEMORY;
+			continue;
+		}
+
+		row_merge_dup_t	dup = {
+			index, psort->table, psort->col_map, 0};
+
+		error = row_merge_sort(psort->trx, &dup, file, block, &tmpfd,
+				       1);
+
+		if (error == DB_SUCCESS) {
+			error = row_merge_insert_index_tuples(
+				psort->trx->id, index, psort->old_table,
+				file->fd, block);
+		}
+
+		psort->errors[i] = error;
+	}
+
+	row_merge_file_destroy_low(tmpfd);
+
+	if (block != NULL) {
+		os_mem_free_large(block, block_size);
+	}
+
+	my_thread_end();
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*********************************************************************//**
+Merge sort the files of the non-unique secondary indexes and insert the
+sorted entries to the indexes with up to srv_sort_threads threads, each
+thread building one index at a time with its own sort buffers. The other
+indexes are left to the caller.
+@return	error code of each index in indexes[] (to be freed with mem_free()),
+or NULL if fewer than two indexes could be sorted in parallel */
+static MY_ATTRIBUTE((nonnull(1, 2, 5, 6), warn_unused_result))
+dberr_t*
+row_merge_sort_parallel(
+/*====================*/
+	trx_t*		trx,		/*!< in: transaction */
+	dict_table_t*	old_table,	/*!< in: table where rows are
+					read from */
+	struct TABLE*	table,		/*!< in/out: MySQL table, for
+					reporting erroneous key value
+					if applicable */
+	const ulint*	col_map,	/*!< in: mapping of old column
+					numbers to new ones, or NULL */
+	dict_index_t**	indexes,	/*!< in: indexes to be created */
+	merge_file_t*	merge_files,	/*!< in/out: merge files of
+					indexes[] */
+	ulint		n_indexes)	/*!< in: size of indexes[] */
+{
+	row_merge_psort_t	psort;
+	os_thread_t*		threads;
+	ulint			n_parallel = 0;
+	ulint			n_threads;
+	ulint			i;
+
+	for (i = 0; i < n_indexes; i++) {
+		if (row_merge_is_parallel_sort(indexes[i], &merge_files[i])) {
+			n_parallel++;
+		}
+	}
+
+	n_threads = ut_min(static_cast<ulint>(srv_sort_threads), n_parallel);
+
+	if (n_threads < 2) {
+		return(NULL);
+	}
+
+	psort.trx = trx;
+	psort.old_table = old_table;
+	psort.table = table;
+	psort.col_map = col_map;
+	psort.path = thd_innodb_tmpdir(trx->mysql_thd);
+	psort.indexes = indexes;
+	psort.merge_files = merge_files;
+	psort.n_indexes = n_indexes;
+	psort.next = 0;
+	psort.errors = static_cast<dberr_t*>(
+		mem_alloc(n_indexes * sizeof *psort.errors));
+
+	for (i = 0; i < n_indexes; i++) {
+		psort.errors[i] = DB_SUCCESS;
+	}
+
+	threads = static_cast<os_thread_t*>(
+		mem_alloc(n_threads * sizeof *threads));
+
+	for (i = 0; i < n_threads; i++) {
+		threads[i] = os_thread_create(
+			row_merge_sort_thread, &psort, NULL);
+	}
+
+	for (i = 0; i < n_threads; i++) {
+		os_thread_join(threads[i]);
+	}
+
+	mem_free(threads);
+
+	return(psort.errors);
+}
+
 /*********************************************************************//**
 Build indexes on a table by reading a clustered index,
 creating a temporary file containing index entries, merge sorting
@@ -3661,6 +4100,7 @@ row_merge_build_indexes(
 	fts_psort_t*		merge_info = NULL;
 	ib_int64_t		sig_count = 0;
 	bool			fts_psort_initiated = false;
+	dberr_t*		psort_errors = NULL;
 	DBUG_ENTER("row_merge_build_indexes");
 
 	ut_ad(!srv_read_only_mode);
@@ -3741,7 +4181,13 @@ row_merge_build_indexes(
 	DEBUG_SYNC_C("row_merge_after_scan");
 
 	/* Now we have files containing index entries ready for
-	sorting and inserting. */
+	sorting and inserting. The non-unique secondary indexes are
+	sorted and inserted by parallel threads first; the online log
+	of every index is applied below, in the order of indexes[]. */
+
+	psort_errors = row_merge_sort_parallel(
+		trx, old_table, table, col_map, indexes, merge_files,
+		n_indexes);
 
 	for (i = 0; i < n_indexes; i++) {
 		dict_index_t*	sort_idx = indexes[i];
@@ -3819,13 +4265,23 @@ wait_again:
 #ifdef FTS_INTERNAL_DIAG_PRINT
 			DEBUG_FTS_SORT_PRINT("FTS_SORT: Complete Insert\n");
 #endif
+		} else if (psort_errors != NULL
+			   && row_merge_is_parallel_sort(
+				   indexes[i], &merge_files[i])) {
+			error = psort_errors[i];
 		} else if (merge_files[i].fd != -1) {
 			row_merge_dup_t	dup = {
 				sort_idx, table, col_map, 0};
 
+			/* An index that is not sorted by the parallel
+			phase can still have the runs of each merge
+			pass merged in parallel. */
 			error = row_merge_sort(
 				trx, &dup, &merge_files[i],
-				block, &tmpfd);
+				block, &tmpfd,
+				row_merge_is_parallel_sort(
+					sort_idx, &merge_files[i])
+				? srv_sort_threads : 1);
 
 			if (error == DB_SUCCESS) {
 				error = row_merge_insert_index_tuples(
@@ -3892,6 +4348,10 @@ func_exit:
 		dict_mem_index_free(fts_sort_idx);
 	}
 
+	if (psort_errors != NULL) {
+		mem_free(psort_errors);
+	}
+
 	mem_free(merge_files);
 	os_mem_free_large(block, block_size);
 
@@ -3647,19 +3647,12 @@ row_sel_try_search_shortcut_for_mysql(
 	ut_ad(dict_index_is_clust(index));
 	ut_ad(!prebuilt->templ_contains_blob);
 
-#ifndef UNIV_SEARCH_DEBUG
-	ut_ad(trx->has_search_latch);
+	ut_ad(!trx->has_search_latch);
 
-	btr_pcur_open_with_no_init(index, search_tuple, PAGE_CUR_GE,
-				   BTR_SEARCH_LEAF, pcur,
-				   RW_S_LATCH,
-				   mtr);
-#else /* UNIV_SEARCH_DEBUG */
 	btr_pcur_open_with_no_init(index, search_tuple, PAGE_CUR_GE,
 				   BTR_SEARCH_LEAF, pcur,
 				   0,
 				   mtr);
-#endif /* UNIV_SEARCH_DEBUG */
 	rec = btr_pcur_get_rec(pcur);
 
 	if (!page_rec_is_user_rec(rec)) {
@@ -4109,15 +4102,11 @@ row_search_for_mysql(
 			mysql_n_tables_locked == 0, because this might
 			also be INSERT INTO ... SELECT ... or
 			CREATE TABLE ... SELECT ... . Our algorithm is
-			NOT prepared to inserts interleaved with the SELECT,
-			and if we try that, we can deadlock on the adaptive
-			hash index semaphore! */
+			NOT prepared to inserts interleaved with the SELECT.
+			The adaptive hash index is searched without a
+			latch, and the record is protected by the page
+			latch. */
 
-#ifndef UNIV_SEARCH_DEBUG
-			ut_ad(!trx->has_search_latch);
-			rw_lock_s_lock(btr_search_get_latch(index));
-			trx->has_search_latch = TRUE;
-#endif
 			switch (row_sel_try_search_shortcut_for_mysql(
 					&rec, prebuilt, &offsets, &heap,
 					&mtr)) {
@@ -4171,7 +4160,7 @@ row_search_for_mysql(
 				fputs(" shortcut\n", stderr); */
 
 				err = DB_SUCCESS;
-				goto release_search_latch;
+				goto shortcut_exit;
 
 			case SEL_EXHAUSTED:
 			shortcut_mismatch:
@@ -4181,11 +4170,7 @@ row_search_for_mysql(
 				fputs(" record not found 2\n", stderr); */
 
 				err = DB_RECORD_NOT_FOUND;
-release_search_latch:
-				rw_lock_s_unlock(
-					btr_search_get_latch(index));
-				trx->has_search_latch = FALSE;
-
+shortcut_exit:
 				/* NOTE that we do NOT store the cursor
 				position */
 				goto func_exit;
@@ -4199,9 +4184,6 @@ release_search_latch:
 
 			mtr_commit(&mtr);
 			mtr_start(&mtr);
-
-			rw_lock_s_unlock(btr_search_get_latch(index));
-			trx->has_search_latch = FALSE;
 		}
 	}
 
@@ -440,6 +440,25 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_SET_MEMBER, MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 	 MONITOR_FLUSH_BACKGROUND_PAGES},
 
+	/* Page cleaner coordinator and worker timings */
+	{"buffer_flush_worker_time", "buffer",
+	 "Total time (in milliseconds) spent by page cleaner threads in"
+	 " flush list batches",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_WORKER_TIME},
+
+	{"buffer_flush_worker_max_time", "buffer",
+	 "Time (in milliseconds) spent by the slowest page cleaner thread"
+	 " in the last flush list batch",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_WORKER_MAX_TIME},
+
+	{"buffer_flush_coordinator_wait_time", "buffer",
+	 "Total time (in milliseconds) the page cleaner coordinator waited"
+	 " for the page cleaner workers",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_COORDINATOR_WAIT_TIME},
+
 	/* Cumulative counter for LRU batch scan */
 	{"buffer_LRU_batch_scanned", "buffer",
 	 "Total pages scanned as part of LRU batch",
@@ -472,6 +491,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_SET_MEMBER, MONITOR_LRU_BATCH_TOTAL_PAGE,
 	 MONITOR_LRU_BATCH_PAGES},
 
+	{"buffer_LRU_worker_time", "buffer",
+	 "Total time (in milliseconds) spent by LRU manager threads in"
+	 " LRU batches",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_WORKER_TIME},
+
 	/* Cumulative counter for single page LRU scans */
 	{"buffer_LRU_single_flush_scanned", "buffer",
 	 "Total pages scanned as part of single page LRU flush",
@@ -691,6 +716,10 @@ static monitor_info_t	innodb_counter_info[] =
 	 "auto-commit read-only transactions committed",
 	 MONITOR_NONE, MONITOR_DEFAULT_START, MONITOR_TRX_NL_RO_COMMIT},
 
+	{"trx_read_views_reused", "transaction", "Number of read views "
+	 "reopened without acquiring the transaction system mutex",
+	 MONITOR_NONE, MONITOR_DEFAULT_START, MONITOR_TRX_READ_VIEW_REUSE},
+
 	{"trx_commits_insert_update", "transaction",
 	 "Number of transactions committed with inserts and updates",
 	 MONITOR_NONE,
@@ -855,6 +884,27 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_LOG_WRITES},
 
+	{"log_flusher_fsyncs", "recovery",
+	 "Number of log fsyncs done by the log flusher thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSHER_FSYNCS},
+
+	{"log_flusher_waits", "recovery",
+	 "Number of times a thread waited for the log flusher thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSHER_WAITS},
+
+	{"log_flusher_avg_group_size", "recovery",
+	 "Average number of waits released by one log flusher fsync",
+	 MONITOR_DISPLAY_CURRENT,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSHER_AVG_GROUP_SIZE},
+
+	{"log_wait_spin_hits", "recovery",
+	 "Number of waits for the log writer or flusher thread which"
+	 " ended while spinning",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WAIT_SPIN_HITS},
+
 	/* ========== Counters for Page Compression ========== */
 	{"module_compress", "compression", "Page Compression Info",
 	 MONITOR_MODULE,
@@ -117,6 +117,13 @@ UNIV_INTERN ulint	srv_undo_tablespaces_open = 8;
 /* The number of rollback segments to use */
 UNIV_INTERN ulong	srv_undo_logs = 1;
 
+/** Whether undo tablespaces larger than srv_max_undo_log_size are
+truncated by purge. */
+UNIV_INTERN my_bool	srv_undo_log_truncate = FALSE;
+
+/** Size in bytes above which an undo tablespace is truncated. */
+UNIV_INTERN ulonglong	srv_max_undo_log_size = 1024 * 1024 * 1024;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN char*	srv_arch_dir	= NULL;
 UNIV_INTERN ulong	srv_log_arch_expire_sec	= 0;
@@ -148,6 +155,9 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of threads sorting and loading secondary indexes in parallel
+in index creation */
+UNIV_INTERN ulong	srv_sort_threads = 4;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -157,6 +167,9 @@ use simulated aio we build below with threads.
 Currently we support native aio on windows and linux */
 /* make srv_use_native_aio to be visible for other plugins */
 my_bool	srv_use_native_aio = TRUE;
+/* If this flag is TRUE and native aio is used on Linux, then the
+asynchronous i/o is submitted through io_uring instead of libaio */
+UNIV_INTERN my_bool	srv_use_io_uring = FALSE;
 UNIV_INTERN my_bool	srv_numa_interleave = FALSE;
 
 #ifdef __WIN__
@@ -265,6 +278,23 @@ UNIV_INTERN ulint	srv_lock_table_size	= ULINT_MAX;
 UNIV_INTERN ulint	srv_foreground_preflush
 	= SRV_FOREGROUND_PREFLUSH_EXP_BACKOFF;
 
+/** Number of page cleaner threads (the coordinator and the workers) and of
+LRU manager threads.  Each pair of them owns a subset of the buffer pool
+instances */
+UNIV_INTERN ulong	srv_n_page_cleaners = 1;
+
+/** Number of threads, including the thread doing the recovery, which apply
+the hashed redo log records to the pages in crash recovery */
+UNIV_INTERN ulong	srv_n_recv_apply_threads = 4;
+
+/** Whether the dedicated log writer and log flusher threads write and flush
+the log, so that committing threads only wait for them */
+UNIV_INTERN my_bool	srv_log_writer_threads = FALSE;
+
+/** Number of spin rounds a thread waiting for the log writer or log flusher
+thread does before it waits on an event */
+UNIV_INTERN ulong	srv_log_wait_spin_rounds = 100;
+
 /** The maximum time limit for a single LRU tail flush iteration by the page
 cleaner thread */
 UNIV_INTERN ulint	srv_cleaner_max_lru_time = 1000;
@@ -354,11 +384,11 @@ UNIV_INTERN ulong	srv_adaptive_flushing_lwm	= 10;
 /* Number of iterations over which adaptive flushing is averaged. */
 UNIV_INTERN ulong	srv_flushing_avg_loops		= 30;
 
-/* The tid of the cleaner thread */
-UNIV_INTERN os_tid_t	srv_cleaner_tid;
+/* The tids of the page cleaner coordinator (0) and worker threads */
+UNIV_INTERN os_tid_t	srv_cleaner_tids[SRV_MAX_N_PAGE_CLEANERS];
 
-/* The tid of the LRU manager thread */
-UNIV_INTERN os_tid_t	srv_lru_manager_tid;
+/* The tids of the LRU manager threads */
+UNIV_INTERN os_tid_t	srv_lru_manager_tids[SRV_MAX_N_PAGE_CLEANERS];
 
 /* The tids of the purge threads */
 UNIV_INTERN os_tid_t	srv_purge_tids[SRV_MAX_N_PURGE_THREADS];
@@ -403,6 +433,9 @@ UNIV_INTERN ulong	srv_n_purge_threads = 1;
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* purge truncates the history of the rollback segments on every Nth batch */
+UNIV_INTERN ulong	srv_purge_rseg_truncate_frequency = 128;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -457,6 +490,9 @@ UNIV_INTERN unsigned long long	srv_stats_persistent_sample_pages = 20;
 UNIV_INTERN my_bool		srv_stats_auto_recalc = TRUE;
 
 UNIV_INTERN ibool	srv_use_doublewrite_buf	= TRUE;
+/** Path to the parallel doublewrite file holding the doublewrite
+shards of the batch flushes */
+UNIV_INTERN char*	srv_parallel_doublewrite_path = NULL;
 UNIV_INTERN ibool       srv_use_atomic_writes = FALSE;
 #ifdef HAVE_POSIX_FALLOCATE
 UNIV_INTERN ibool       srv_use_posix_fallocate = FALSE;
@@ -496,6 +532,9 @@ static ulint		srv_n_rows_read_old		= 0;
 UNIV_INTERN ulint	srv_truncated_status_writes	= 0;
 UNIV_INTERN ulint	srv_available_undo_logs         = 0;
 
+UNIV_INTERN ulint	srv_undo_truncations		= 0;
+UNIV_INTERN ib_uint64_t	srv_undo_truncated_bytes	= 0;
+
 /* Ensure status variables are on separate cache lines */
 
 #define CACHE_LINE_SIZE 64
@@ -1533,8 +1572,18 @@ srv_printf_innodb_monitor(
 
 	mutex_enter(&trx_sys->mutex);
 
-	fprintf(file, "%lu read views open inside InnoDB\n",
-		UT_LIST_GET_LEN(trx_sys->view_list));
+	ulint		n_views = 0;
+
+	for (const read_view_t* view = UT_LIST_GET_FIRST(trx_sys->view_list);
+	     view != NULL;
+	     view = UT_LIST_GET_NEXT(view_list, view)) {
+
+		if (view->state == VIEW_OPEN) {
+			n_views++;
+		}
+	}
+
+	fprintf(file, "%lu read views open inside InnoDB\n", n_views);
 
 	fprintf(file, "%lu RW transactions active inside InnoDB\n",
 		UT_LIST_GET_LEN(trx_sys->rw_trx_list));
@@ -1545,8 +1594,8 @@ srv_printf_innodb_monitor(
 	fprintf(file, "%lu out of %lu descriptors used\n",
 		trx_sys->descr_n_used, trx_sys->descr_n_max);
 
-	if (UT_LIST_GET_LEN(trx_sys->view_list)) {
-		read_view_t*	view = UT_LIST_GET_LAST(trx_sys->view_list);
+	if (n_views) {
+		read_view_t*	view = read_view_get_oldest();
 
 		if (view) {
 			fprintf(file, "---OLDEST VIEW---\n");
@@ -1867,12 +1916,19 @@ srv_export_innodb_status(void)
 
 	export_vars.innodb_rows_deleted = srv_stats.n_rows_deleted;
 
+	export_vars.innodb_recovery_pages_applied = recv_n_pages_applied;
+	export_vars.innodb_recovery_bytes_applied = recv_n_bytes_applied;
+	export_vars.innodb_recovery_apply_time =
+		(ulint) (recv_apply_time_us / 1000);
+
 	export_vars.innodb_num_open_files = fil_n_file_opened;
 
 	export_vars.innodb_truncated_status_writes =
 		srv_truncated_status_writes;
 
 	export_vars.innodb_available_undo_logs = srv_available_undo_logs;
+	export_vars.innodb_undo_truncations = srv_undo_truncations;
+	export_vars.innodb_undo_truncated_bytes = srv_undo_truncated_bytes;
 	export_vars.innodb_read_views_memory
 		= os_atomic_increment_lint(&srv_read_views_memory, 0);
 	export_vars.innodb_descriptors_memory
@@ -1984,7 +2040,7 @@ loop:
 		if (srv_print_innodb_monitor) {
 			/* Reset mutex_skipped counter everytime
 			srv_print_innodb_monitor changes. This is to
-			ensure we will not be blocked by lock_sys->mutex
+			ensure we will not be blocked by lock_sys->latch
 			for short duration information printing,
 			such as requested by sync_array_print_long_waits() */
 			if (!last_srv_print_monitor) {
@@ -3280,12 +3336,21 @@ srv_do_purge(
 
 		/* Take a snapshot of the history list before purge. */
 		if ((rseg_history_len = trx_sys->rseg_history_len) == 0) {
+
+			/* All the undo logs have been purged: an undo
+			tablespace waiting to be drained can be truncated. */
+			trx_purge_truncate_undo_tablespaces();
 			break;
 		}
 
+		/* Truncate the history on every batch while an undo
+		tablespace is being drained, so that it empties quickly. */
+		ulint	truncate_frequency = trx_purge_undo_truncate_is_pending()
+			? 1 : srv_purge_rseg_truncate_frequency;
+
 		n_pages_purged = trx_purge(
 			n_use_threads, srv_purge_batch_size,
-			(++count % TRX_SYS_N_RSEGS) == 0);
+			(++count % truncate_frequency) == 0);
 
 		*n_total_purged += n_pages_purged;
 
@@ -3380,10 +3445,13 @@ srv_purge_coordinator_suspend(
 			wait for new records. The magic number 5000 is an
 			approximation for the case where we have cached UNDO
 			log records which prevent truncate of the UNDO
-			segments. */
+			segments. An undo tablespace waiting to be drained
+			is polled too: the logs left in it may only become
+			purgeable when the purge view advances. */
 
 			if (rseg_history_len == trx_sys->rseg_history_len
-			    && trx_sys->rseg_history_len < 5000) {
+			    && trx_sys->rseg_history_len < 5000
+			    && !trx_purge_undo_truncate_is_pending()) {
 
 				stop = true;
 			}
@@ -132,6 +132,9 @@ static pfs_os_file_t	files[1000];
 
 /** io_handler_thread parameters for thread identification */
 static ulint		n[SRV_MAX_N_IO_THREADS];
+/** page cleaner worker and LRU manager thread parameters for slot
+identification */
+static ulint		page_cleaner_slots[SRV_MAX_N_PAGE_CLEANERS];
 /** io_handler_thread identifiers, 32 is the maximum number of purge threads.
 The extra elements at the end are allocated as follows:
 SRV_MAX_N_IO_THREADS + 1: srv_master_thread
@@ -155,7 +158,7 @@ static char*	srv_monitor_file_name;
 #endif /* !UNIV_HOTBACKUP */
 
 /** Default undo tablespace size in UNIV_PAGEs count (10MB). */
-static const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
+const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
 	((1024 * 1024) * 10) / UNIV_PAGE_SIZE_DEF;
 
 /** */
@@ -1433,6 +1436,37 @@ srv_undo_tablespaces_init(
 		ut_a(undo_tablespace_ids[i] != 0);
 		ut_a(undo_tablespace_ids[i] != ULINT_UNDEFINED);
 
+		/* Start an undo tablespace whose truncation was interrupted
+		over from an empty file; its headers are rebuilt once the
+		redo log has been scanned. */
+
+		if (!create_new_db
+		    && trx_purge_undo_truncate_was_interrupted(
+			    undo_tablespace_ids[i])) {
+
+			if (srv_read_only_mode) {
+				ib_logf(IB_LOG_LEVEL_ERROR,
+					"Cannot complete the truncation of"
+					" undo tablespace '%s' in read-only"
+					" mode.", name);
+
+				return(DB_READ_ONLY);
+			}
+
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Recreating undo tablespace '%s' whose"
+				" truncation was interrupted.", name);
+
+			os_file_delete(innodb_file_data_key, name);
+
+			err = srv_undo_tablespace_create(
+				name, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES);
+
+			if (err != DB_SUCCESS) {
+				return(err);
+			}
+		}
+
 		err = srv_undo_tablespace_open(name, undo_tablespace_ids[i]);
 
 		if (err != DB_SUCCESS) {
@@ -1835,7 +1869,15 @@ innobase_start_or_create_for_mysql(void)
 		break;
 	}
 
-#elif defined(LINUX_NATIVE_AIO)
+#elif defined(LINUX_ASYNC_IO)
+
+# ifndef LINUX_NATIVE_AIO
+	/* Without libaio, native aio is only available through
+	io_uring. */
+	if (!srv_use_io_uring) {
+		srv_use_native_aio = FALSE;
+	}
+# endif /* !LINUX_NATIVE_AIO */
 
 	if (srv_use_native_aio) {
 		ib_logf(IB_LOG_LEVEL_INFO, "Using Linux native AIO");
@@ -1847,6 +1889,12 @@ innobase_start_or_create_for_mysql(void)
 	srv_use_native_aio = FALSE;
 #endif /* __WIN__ */
 
+#ifndef LINUX_IO_URING
+	/* io_uring is supported only on Linux when the support is
+	compiled in. */
+	srv_use_io_uring = FALSE;
+#endif /* !LINUX_IO_URING */
+
 	if (srv_file_flush_method_str == NULL) {
 		/* These are the default options */
 
@@ -1915,7 +1963,10 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* dict_stats_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
-			    + 1 /* buf_flush_page_cleaner_thread */
+			    + srv_n_recv_apply_threads /* recv_apply_thread */
+			    + srv_n_page_cleaners /* page cleaner threads */
+			    + srv_n_page_cleaners /* lru manager threads */
+			    + 2 /* log_writer_thread, log_flusher_thread */
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
@@ -1927,12 +1978,19 @@ innobase_start_or_create_for_mysql(void)
 			    + fts_sort_pll_degree * FTS_NUM_AUX_INDEX
 			      * max_connections;
 
-	if (srv_buf_pool_size < BUF_POOL_SIZE_THRESHOLD) {
+	if (srv_buf_pool_size < BUF_POOL_SIZE_THRESHOLD
+	    && !DBUG_EVALUATE_IF("ib_buf_pool_small_instances", true, false)) {
 		/* If buffer pool is less than 1 GB,
 		use only one buffer pool instance */
 		srv_buf_pool_instances = 1;
 	}
 
+	if (srv_n_page_cleaners > srv_buf_pool_instances) {
+		/* There is no benefit in having more page cleaner threads
+		than buffer pool instances. */
+		srv_n_page_cleaners = srv_buf_pool_instances;
+	}
+
 	srv_boot();
 
 	ib_logf(IB_LOG_LEVEL_INFO,
@@ -2510,6 +2568,10 @@ files_checked:
 			return(err);
 		}
 
+		/* Rebuild the undo tablespaces whose truncation was
+		interrupted before their rollback segments are loaded. */
+		trx_purge_undo_truncate_recover();
+
 		ib_bh = trx_sys_init_at_db_start();
 		n_recovered_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
 
@@ -2523,6 +2585,8 @@ files_checked:
 
 		recv_recovery_from_checkpoint_finish();
 
+		trx_purge_undo_truncate_recover_finish();
+
 		if (srv_force_recovery < SRV_FORCE_NO_IBUF_MERGE) {
 			/* The following call is necessary for the insert
 			buffer to work with multiple tablespaces. We must
@@ -2776,6 +2840,12 @@ files_checked:
 
 	ut_a(trx_purge_state() == PURGE_STATE_INIT);
 
+	if (!srv_read_only_mode && srv_log_writer_threads) {
+		/* Hand the log writes and flushes over to the dedicated
+		log writer and log flusher threads */
+		log_writer_threads_start();
+	}
+
 	/* Create the master thread which does purge and other utility
 	operations */
 
@@ -2809,10 +2879,25 @@ files_checked:
 		purge_sys->state = PURGE_STATE_DISABLED;
 	}
 
+	for (i = 0; i < srv_n_page_cleaners; ++i) {
+		page_cleaner_slots[i] = i;
+	}
+
 	if (!srv_read_only_mode) {
+		buf_flush_page_cleaner_init();
+
 		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
+
+		for (i = 1; i < srv_n_page_cleaners; ++i) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 page_cleaner_slots + i, NULL);
+		}
+	}
+
+	for (i = 0; i < srv_n_page_cleaners; ++i) {
+		os_thread_create(buf_flush_lru_manager_thread,
+				 page_cleaner_slots + i, NULL);
 	}
-	os_thread_create(buf_flush_lru_manager_thread, NULL, NULL);
 
 #ifdef UNIV_DEBUG
 	/* buf_debug_prints = TRUE; */
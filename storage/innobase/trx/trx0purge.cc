@@ -45,6 +45,8 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0thread.h"
 #include "srv0mon.h"
 #include "mtr0log.h"
+#include "log0log.h"
+#include "os0file.h"
 
 /** Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong		srv_max_purge_lag = 0;
@@ -73,6 +75,21 @@ UNIV_INTERN mysql_pfs_key_t	purge_sys_bh_mutex_key;
 UNIV_INTERN my_bool		srv_purge_view_update_only_debug;
 #endif /* UNIV_DEBUG */
 
+/** The undo tablespace that purge is draining for truncation, or 0 if
+none. Only accessed by the purge coordinator thread. */
+static ulint		trx_purge_undo_trunc_space = 0;
+
+/** Position among the undo tablespaces where the search for the next
+tablespace to truncate starts */
+static ulint		trx_purge_undo_trunc_next = 0;
+
+/** Undo tablespaces whose truncation was interrupted by a crash; they
+are rebuilt at startup */
+static ulint		trx_purge_undo_trunc_recv[TRX_SYS_N_RSEGS];
+
+/** Number of elements in trx_purge_undo_trunc_recv */
+static ulint		trx_purge_n_undo_trunc_recv = 0;
+
 /****************************************************************//**
 Builds a purge 'query' graph. The actual purge is performed by executing
 this query graph.
@@ -1179,6 +1196,434 @@ trx_purge_truncate(void)
 	} else {
 		trx_purge_truncate_history(&purge_sys->limit, purge_sys->view);
 	}
+
+	trx_purge_truncate_undo_tablespaces();
+}
+
+/********************************************************************//**
+Builds the name of the file that marks an undo tablespace truncation as
+in progress. */
+static
+void
+trx_purge_undo_trunc_log_name(
+/*==========================*/
+	char*	name,		/*!< out: file name */
+	ulint	len,		/*!< in: size of name */
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ut_snprintf(name, len, "%s%cundo%03lu_trunc.log",
+		    srv_undo_dir, SRV_PATH_SEPARATOR, space_id);
+}
+
+/********************************************************************//**
+Sets or clears the skip_allocation flag of the rollback segments in an
+undo tablespace.
+@return	number of rollback segments in the tablespace */
+static
+ulint
+trx_purge_undo_skip_allocation(
+/*===========================*/
+	ulint	space_id,	/*!< in: undo tablespace id */
+	bool	skip)		/*!< in: value of the flag */
+{
+	ulint	n_rsegs = 0;
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (rseg != NULL && rseg->space == space_id) {
+			mutex_enter(&rseg->mutex);
+			rseg->skip_allocation = skip;
+			mutex_exit(&rseg->mutex);
+
+			++n_rsegs;
+		}
+	}
+
+	return(n_rsegs);
+}
+
+/********************************************************************//**
+Chooses an undo tablespace that has grown larger than
+innodb_max_undo_log_size and stops assigning its rollback segments to new
+transactions, so that purge can drain it. A tablespace is only chosen if
+the rollback segments in other undo tablespaces can serve the new
+transactions meanwhile. */
+static
+void
+trx_purge_mark_undo_for_truncate(void)
+/*==================================*/
+{
+	ulint	space_id;
+	ulint	n_spaces = srv_undo_tablespaces_open;
+
+	if (n_spaces < 2) {
+		return;
+	}
+
+	for (ulint i = 0; i < n_spaces; ++i) {
+		ulint	pos = (trx_purge_undo_trunc_next + i) % n_spaces;
+		ulint	n_pages;
+		bool	in_space = false;
+		bool	in_other = false;
+
+		space_id = srv_undo_space_id_start + pos;
+
+		n_pages = fil_space_get_size(space_id);
+
+		if ((ib_uint64_t) n_pages * UNIV_PAGE_SIZE
+		    <= srv_max_undo_log_size) {
+
+			continue;
+		}
+
+		for (ulint j = 0; j < TRX_SYS_N_RSEGS; ++j) {
+			const trx_rseg_t*	rseg = trx_sys->rseg_array[j];
+
+			if (rseg == NULL || rseg->space == TRX_SYS_SPACE) {
+				continue;
+			} else if (rseg->space == space_id) {
+				in_space = true;
+			} else {
+				in_other = true;
+			}
+		}
+
+		if (!in_space || !in_other) {
+			continue;
+		}
+
+		trx_purge_undo_skip_allocation(space_id, true);
+
+		trx_purge_undo_trunc_space = space_id;
+		trx_purge_undo_trunc_next = pos + 1;
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Undo tablespace %lu has grown to %lu pages; it will"
+			" be truncated once purge has drained it.",
+			space_id, n_pages);
+
+		return;
+	}
+}
+
+/********************************************************************//**
+Checks whether all the undo logs in the rollback segments of an undo
+tablespace have been purged and no transaction uses them any more.
+@return	true if the undo tablespace can be truncated */
+static
+bool
+trx_purge_undo_is_drained(
+/*======================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		bool		in_use;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		if (purge_sys->next_stored && purge_sys->rseg == rseg) {
+			return(false);
+		}
+
+		/* The newest logs of the history list are only removed
+		from it when a later log is purged, which never happens
+		in a drained rollback segment. They are discarded with the
+		tablespace once purge has no log left to read here. */
+
+		mutex_enter(&rseg->mutex);
+
+		ut_ad(rseg->skip_allocation);
+
+		in_use = rseg->trx_ref_count > 0
+			|| rseg->last_page_no != FIL_NULL
+			|| UT_LIST_GET_LEN(rseg->update_undo_list) > 0
+			|| UT_LIST_GET_LEN(rseg->insert_undo_list) > 0;
+
+		mutex_exit(&rseg->mutex);
+
+		if (in_use) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/********************************************************************//**
+Counts the purged undo logs that are still in the history lists of the
+rollback segments of a drained undo tablespace.
+@return	number of undo logs */
+static
+ulint
+trx_purge_undo_history_len(
+/*=======================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	ulint	n_logs = 0;
+
+	for (ulint i = 0; i < TRX_SYS_N_RSEGS; ++i) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+		trx_rsegf_t*	rseg_hdr;
+		mtr_t		mtr;
+
+		if (rseg == NULL || rseg->space != space_id) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+		mutex_enter(&rseg->mutex);
+
+		rseg_hdr = trx_rsegf_get(rseg->space, rseg->zip_size,
+					 rseg->page_no, &mtr);
+
+		n_logs += flst_get_len(rseg_hdr + TRX_RSEG_HISTORY, &mtr);
+
+		mutex_exit(&rseg->mutex);
+		mtr_commit(&mtr);
+	}
+
+	return(n_logs);
+}
+
+/********************************************************************//**
+Truncates a drained undo tablespace back to its initial size. A marker
+file is kept while the tablespace is rebuilt, so that an interrupted
+truncation is completed at the next startup. */
+static
+void
+trx_purge_truncate_undo_tablespace(
+/*===============================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		success;
+	pfs_os_file_t	file;
+	ulint		old_size = fil_space_get_size(space_id);
+	ulint		new_size = SRV_UNDO_TABLESPACE_SIZE_IN_PAGES;
+	ulint		n_removed_logs;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	file = os_file_create_simple_no_error_handling(
+		innodb_file_data_key, name, OS_FILE_CREATE,
+		OS_FILE_READ_WRITE, &success);
+
+	if (!success) {
+		os_file_get_last_error(true);
+
+		ib_logf(IB_LOG_LEVEL_ERROR,
+			"Cannot create '%s'; undo tablespace %lu is not"
+			" truncated.", name, space_id);
+		return;
+	}
+
+	success = os_file_flush(file);
+
+	os_file_close(file);
+
+	if (!success) {
+		os_file_delete(innodb_file_data_key, name);
+		return;
+	}
+
+	n_removed_logs = trx_purge_undo_history_len(space_id);
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_truncate_crash",
+			DBUG_SUICIDE(););
+
+	if (fil_truncate_undo_tablespace(space_id, new_size) != DB_SUCCESS) {
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Failed to truncate undo tablespace %lu.", space_id);
+	}
+
+	trx_rseg_undo_tablespace_reinit(space_id, new_size);
+
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_decrement_ulint(&trx_sys->rseg_history_len, n_removed_logs);
+#else
+	mutex_enter(&trx_sys->mutex);
+	trx_sys->rseg_history_len -= n_removed_logs;
+	mutex_exit(&trx_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+	/* Make the new tablespace durable before the marker is removed:
+	the redo log of the old tablespace must not be applied to it. */
+
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	DBUG_EXECUTE_IF("ib_undo_trunc_before_marker_removal_crash",
+			DBUG_SUICIDE(););
+
+	os_file_delete(innodb_file_data_key, name);
+
+	srv_undo_truncations++;
+
+	if (old_size > new_size) {
+		srv_undo_truncated_bytes +=
+			(ib_uint64_t) (old_size - new_size) * UNIV_PAGE_SIZE;
+	}
+
+	ib_logf(IB_LOG_LEVEL_INFO,
+		"Truncated undo tablespace %lu from %lu to %lu pages.",
+		space_id, old_size, new_size);
+}
+
+/********************************************************************//**
+Truncates the undo tablespaces that have grown too large. An undo
+tablespace larger than innodb_max_undo_log_size is first marked, so that
+no new transactions use it, and truncated once purge has freed all its
+undo logs. Does nothing unless innodb_undo_log_truncate is set. */
+UNIV_INTERN
+void
+trx_purge_truncate_undo_tablespaces(void)
+/*=====================================*/
+{
+	if (srv_read_only_mode
+	    || srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+
+		return;
+	}
+
+	if (!srv_undo_log_truncate) {
+
+		if (trx_purge_undo_trunc_space != 0) {
+			/* Truncation was disabled: give the tablespace
+			back to the transactions. */
+			trx_purge_undo_skip_allocation(
+				trx_purge_undo_trunc_space, false);
+
+			trx_purge_undo_trunc_space = 0;
+		}
+
+		return;
+	}
+
+	if (trx_purge_undo_trunc_space == 0) {
+		trx_purge_mark_undo_for_truncate();
+	}
+
+	if (trx_purge_undo_trunc_space == 0
+	    || !trx_purge_undo_is_drained(trx_purge_undo_trunc_space)) {
+
+		return;
+	}
+
+	trx_purge_truncate_undo_tablespace(trx_purge_undo_trunc_space);
+
+	trx_purge_undo_skip_allocation(trx_purge_undo_trunc_space, false);
+
+	trx_purge_undo_trunc_space = 0;
+}
+
+/********************************************************************//**
+Checks whether an undo tablespace is being drained for truncation.
+@return	true if an undo tablespace is marked for truncation */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_is_pending(void)
+/*====================================*/
+{
+	return(trx_purge_undo_trunc_space != 0);
+}
+
+/********************************************************************//**
+Checks at startup whether the truncation of an undo tablespace was
+interrupted. Such a tablespace is recreated empty before the redo log is
+applied, and its redo log records are skipped.
+@return	true if the undo tablespace must be recreated */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_was_interrupted(
+/*====================================*/
+	ulint	space_id)	/*!< in: undo tablespace id */
+{
+	char		name[OS_FILE_MAX_PATH];
+	ibool		exists;
+	os_file_type_t	type;
+
+	trx_purge_undo_trunc_log_name(name, sizeof(name), space_id);
+
+	if (!os_file_status(name, &exists, &type) || !exists) {
+		return(false);
+	}
+
+	ut_a(trx_purge_n_undo_trunc_recv < TRX_SYS_N_RSEGS);
+
+	trx_purge_undo_trunc_recv[trx_purge_n_undo_trunc_recv++] = space_id;
+
+	return(true);
+}
+
+/********************************************************************//**
+Checks whether the redo log records of a tablespace must be skipped
+because the tablespace is an undo tablespace whose interrupted truncation
+is completed at startup.
+@return	true if the tablespace is recreated at startup */
+UNIV_INTERN
+bool
+trx_purge_undo_truncate_is_recreated(
+/*=================================*/
+	ulint	space_id)	/*!< in: tablespace id */
+{
+	for (ulint i = 0; i < trx_purge_n_undo_trunc_recv; ++i) {
+		if (trx_purge_undo_trunc_recv[i] == space_id) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/********************************************************************//**
+Rebuilds the file space and rollback segment headers of the undo
+tablespaces whose truncation was interrupted. Must be called after the
+redo log scan and before the rollback segments are loaded. */
+UNIV_INTERN
+void
+trx_purge_undo_truncate_recover(void)
+/*=================================*/
+{
+	for (ulint i = 0; i < trx_purge_n_undo_trunc_recv; ++i) {
+		ulint	space_id = trx_purge_undo_trunc_recv[i];
+
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Completing the truncation of undo tablespace %lu.",
+			space_id);
+
+		trx_rseg_undo_tablespace_reinit(
+			space_id, SRV_UNDO_TABLESPACE_SIZE_IN_PAGES);
+	}
+}
+
+/********************************************************************//**
+Finishes the recovery of interrupted undo tablespace truncations by making
+the rebuilt tablespaces durable and removing their marker files. Must be
+called after the redo log has been applied. */
+UNIV_INTERN
+void
+trx_purge_undo_truncate_recover_finish(void)
+/*========================================*/
+{
+	if (trx_purge_n_undo_trunc_recv == 0) {
+		return;
+	}
+
+	log_make_checkpoint_at(LSN_MAX, TRUE);
+
+	for (ulint i = 0; i < trx_purge_n_undo_trunc_recv; ++i) {
+		char	name[OS_FILE_MAX_PATH];
+
+		trx_purge_undo_trunc_log_name(
+			name, sizeof(name), trx_purge_undo_trunc_recv[i]);
+
+		os_file_delete(innodb_file_data_key, name);
+	}
+
+	trx_purge_n_undo_trunc_recv = 0;
 }
 
 /*******************************************************************//**
@@ -678,7 +678,7 @@ trx_rollback_resurrected(
 
 	/* The trx->is_recovered flag and trx->state are set
 	atomically under the protection of the trx->mutex (and
-	lock_sys->mutex) in lock_trx_release_locks(). We do not want
+	lock_sys->latch) in lock_trx_release_locks(). We do not want
 	to accidentally clean up a non-recovered transaction here. */
 
 	trx_mutex_enter(trx);
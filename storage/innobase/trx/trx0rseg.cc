@@ -31,6 +31,7 @@ Created 3/26/1996 Heikki Tuuri
 
 #include "trx0undo.h"
 #include "fut0lst.h"
+#include "fsp0fsp.h"
 #include "srv0srv.h"
 #include "trx0purge.h"
 #include "ut0bh.h"
@@ -109,22 +110,16 @@ trx_rseg_header_create(
 }
 
 /***********************************************************************//**
-Free's an instance of the rollback segment in memory. */
-UNIV_INTERN
+Frees the undo log segments cached for reuse in a rollback segment. */
+static
 void
-trx_rseg_mem_free(
-/*==============*/
-	trx_rseg_t*	rseg)	/* in, own: instance to free */
+trx_rseg_free_cached_undo(
+/*======================*/
+	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
 	trx_undo_t*	undo;
 	trx_undo_t*	next_undo;
 
-	mutex_free(&rseg->mutex);
-
-	/* There can't be any active transactions. */
-	ut_a(UT_LIST_GET_LEN(rseg->update_undo_list) == 0);
-	ut_a(UT_LIST_GET_LEN(rseg->insert_undo_list) == 0);
-
 	for (undo = UT_LIST_GET_FIRST(rseg->update_undo_cached);
 	     undo != NULL;
 	     undo = next_undo) {
@@ -150,6 +145,23 @@ trx_rseg_mem_free(
 
 		trx_undo_mem_free(undo);
 	}
+}
+
+/***********************************************************************//**
+Free's an instance of the rollback segment in memory. */
+UNIV_INTERN
+void
+trx_rseg_mem_free(
+/*==============*/
+	trx_rseg_t*	rseg)	/* in, own: instance to free */
+{
+	mutex_free(&rseg->mutex);
+
+	/* There can't be any active transactions. */
+	ut_a(UT_LIST_GET_LEN(rseg->update_undo_list) == 0);
+	ut_a(UT_LIST_GET_LEN(rseg->insert_undo_list) == 0);
+
+	trx_rseg_free_cached_undo(rseg);
 
 	/* const_cast<trx_rseg_t*>() because this function is
 	like a destructor.  */
@@ -342,6 +354,104 @@ trx_rseg_create(
 	return(rseg);
 }
 
+/*********************************************************************//**
+Reinitializes an undo tablespace that has been truncated to the given size:
+writes a new file space header and recreates the headers of the rollback
+segments that the trx system header places in the tablespace. The memory
+objects of those rollback segments, if they exist already, are reset to
+match. Purge must have processed all the undo logs of the rollback
+segments: the logs still in their history lists are discarded. */
+UNIV_INTERN
+void
+trx_rseg_undo_tablespace_reinit(
+/*============================*/
+	ulint	space,		/*!< in: undo tablespace id */
+	ulint	size)		/*!< in: size of the tablespace in pages */
+{
+	ulint		i;
+	mtr_t		mtr;
+	trx_sysf_t*	sys_header;
+	ulint		page_nos[TRX_SYS_N_RSEGS];
+
+	ut_a(space != TRX_SYS_SPACE);
+
+	/* Find the rollback segment slots of the tablespace first: the
+	trx system header page must not be latched while allocating
+	pages from the tablespace. */
+
+	mtr_start(&mtr);
+
+	sys_header = trx_sysf_get(&mtr);
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+
+		if (trx_sysf_rseg_get_page_no(sys_header, i, &mtr) != FIL_NULL
+		    && trx_sysf_rseg_get_space(sys_header, i, &mtr) == space) {
+
+			page_nos[i] = 0;
+		} else {
+			page_nos[i] = FIL_NULL;
+		}
+	}
+
+	mtr_commit(&mtr);
+
+	mtr_start(&mtr);
+
+	fsp_header_init(space, size, &mtr);
+
+	mtr_commit(&mtr);
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+
+		if (page_nos[i] == FIL_NULL) {
+			continue;
+		}
+
+		mtr_start(&mtr);
+
+		mtr_x_lock(fil_space_get_latch(space, NULL), &mtr);
+
+		page_nos[i] = trx_rseg_header_create(
+			space, 0, ULINT_MAX, i, &mtr);
+
+		ut_a(page_nos[i] != FIL_NULL);
+
+		mtr_commit(&mtr);
+	}
+
+	if (trx_sys == NULL) {
+		/* Called at startup before the rollback segments
+		were loaded. */
+		return;
+	}
+
+	for (i = 0; i < TRX_SYS_N_RSEGS; i++) {
+		trx_rseg_t*	rseg = trx_sys->rseg_array[i];
+
+		if (page_nos[i] == FIL_NULL || rseg == NULL) {
+			continue;
+		}
+
+		mutex_enter(&rseg->mutex);
+
+		ut_a(rseg->space == space);
+		ut_a(UT_LIST_GET_LEN(rseg->update_undo_list) == 0);
+		ut_a(UT_LIST_GET_LEN(rseg->insert_undo_list) == 0);
+
+		trx_rseg_free_cached_undo(rseg);
+
+		rseg->page_no = page_nos[i];
+		rseg->curr_size = 1;
+		rseg->last_page_no = FIL_NULL;
+		rseg->last_offset = 0;
+		rseg->last_trx_no = 0;
+		rseg->last_del_marks = FALSE;
+
+		mutex_exit(&rseg->mutex);
+	}
+}
+
 /*********************************************************************//**
 Creates the memory copies for rollback segments and initializes the
 rseg array in trx_sys at a database startup. */
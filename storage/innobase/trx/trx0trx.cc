@@ -170,6 +170,7 @@ trx_reserve_descriptor(
 	*descr = trx->id;
 
 	trx_sys->descr_n_used = n_used;
+	trx_sys->descr_version++;
 }
 
 /*************************************************************//**
@@ -210,6 +211,7 @@ trx_release_descriptor(
 	}
 
 	trx_sys->descr_n_used--;
+	trx_sys->descr_version++;
 }
 
 /****************************************************************//**
@@ -686,6 +688,8 @@ trx_resurrect_insert(
 
 	trx = trx_allocate_for_background();
 
+	++rseg->trx_ref_count;
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -807,6 +811,12 @@ trx_resurrect_update(
 	trx_undo_t*	undo,	/*!< in/out: update UNDO record */
 	trx_rseg_t*	rseg)	/*!< in/out: rollback segment */
 {
+	if (trx->rseg == NULL) {
+		++rseg->trx_ref_count;
+	} else {
+		ut_ad(trx->rseg == rseg);
+	}
+
 	trx->rseg = rseg;
 	trx->xid = undo->xid;
 	trx->id = undo->trx_id;
@@ -947,6 +957,7 @@ trx_assign_rseg_low(
 {
 	ulint		i;
 	trx_rseg_t*	rseg;
+	ulint		n_skipped = 0;
 	static ulint	latest_rseg = 0;
 
 	if (srv_read_only_mode) {
@@ -973,18 +984,54 @@ trx_assign_rseg_low(
 	defined for rollback segments. We want all UNDO records to be in
 	the non-system tablespaces. */
 
-	do {
-		rseg = trx_sys->rseg_array[i];
-		ut_a(rseg == NULL || i == rseg->id);
+	for (;;) {
+		do {
+			rseg = trx_sys->rseg_array[i];
+			ut_a(rseg == NULL || i == rseg->id);
+
+			i = (rseg == NULL) ? 0 : i + 1;
+
+		} while (rseg == NULL
+			 || (rseg->space == 0
+			     && n_tablespaces > 0
+			     && trx_sys->rseg_array[1] != NULL));
+
+		mutex_enter(&rseg->mutex);
+
+		/* Skip the rollback segments of an undo tablespace that
+		purge is draining for truncation, unless there seems to be
+		nothing else left to use. */
+
+		if (!rseg->skip_allocation || ++n_skipped > TRX_SYS_N_RSEGS) {
+			++rseg->trx_ref_count;
+			mutex_exit(&rseg->mutex);
+
+			return(rseg);
+		}
 
-		i = (rseg == NULL) ? 0 : i + 1;
+		mutex_exit(&rseg->mutex);
+	}
+}
 
-	} while (rseg == NULL
-		 || (rseg->space == 0
-		     && n_tablespaces > 0
-		     && trx_sys->rseg_array[1] != NULL));
+/******************************************************************//**
+Releases the rollback segment of a transaction that is being committed
+or cleaned up, so that its undo tablespace can be truncated. */
+static
+void
+trx_release_rseg(
+/*=============*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	trx_rseg_t*	rseg = trx->rseg;
+
+	if (rseg != NULL) {
+		mutex_enter(&rseg->mutex);
+		ut_ad(rseg->trx_ref_count > 0);
+		--rseg->trx_ref_count;
+		mutex_exit(&rseg->mutex);
 
-	return(rseg);
+		trx->rseg = NULL;
+	}
 }
 
 /****************************************************************//**
@@ -1394,7 +1441,11 @@ trx_commit_in_memory(
 
 		trx->state = TRX_STATE_NOT_STARTED;
 
-		read_view_remove(trx->global_read_view, false);
+		/* Leave the view in trx_sys->view_list, so that the next
+		non-locking read of this trx can reuse it without acquiring
+		trx_sys->mutex if no read-write transaction has started or
+		finished in the meantime. */
+		read_view_close_lazy(trx->global_read_view);
 
 		MONITOR_INC(MONITOR_TRX_NL_RO_COMMIT);
 	} else {
@@ -1513,7 +1564,7 @@ trx_commit_in_memory(
 	trx_named_savept_t*	savep = UT_LIST_GET_FIRST(trx->trx_savepoints);
 	trx_roll_savepoints_free(trx, savep);
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
@@ -1654,7 +1705,7 @@ trx_cleanup_at_db_startup(
 		trx_undo_insert_cleanup(trx);
 	}
 
-	trx->rseg = NULL;
+	trx_release_rseg(trx);
 	trx->undo_no = 0;
 	trx->last_sql_stat_start.least_undo_no = 0;
 
@@ -2084,7 +2135,7 @@ state_ok:
 
 /**********************************************************************//**
 Prints info about a transaction.
-The caller must hold lock_sys->mutex and trx_sys->mutex.
+The caller must hold lock_sys->latch and trx_sys->mutex.
 When possible, use trx_print() instead. */
 UNIV_INTERN
 void
@@ -2106,7 +2157,7 @@ trx_print_latched(
 
 /**********************************************************************//**
 Prints info about a transaction.
-Acquires and releases lock_sys->mutex and trx_sys->mutex. */
+Acquires and releases lock_sys->latch and trx_sys->mutex. */
 UNIV_INTERN
 void
 trx_print(
@@ -2152,7 +2203,7 @@ trx_assert_started(
 	/* trx->state can change from or to NOT_STARTED while we are holding
 	trx_sys->mutex for non-locking autocommit selects but not for other
 	types of transactions. It may change from ACTIVE to PREPARED. Unless
-	we are holding lock_sys->mutex, it may also change to COMMITTED. */
+	we are holding lock_sys->latch, it may also change to COMMITTED. */
 
 	switch (trx->state) {
 	case TRX_STATE_PREPARED:
@@ -2398,7 +2449,7 @@ This function is used to find one X/Open XA distributed transaction
 which is in the prepared state
 @return	trx on match, the trx->xid will be invalidated;
 note that the trx may have been committed, unless the caller is
-holding lock_sys->mutex */
+holding lock_sys->latch */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
 trx_t*
 trx_get_trx_by_xid_low(
@@ -2444,7 +2495,7 @@ This function is used to find one X/Open XA distributed transaction
 which is in the prepared state
 @return	trx or NULL; on match, the trx->xid will be invalidated;
 note that the trx may have been committed, unless the caller is
-holding lock_sys->mutex */
+holding lock_sys->latch */
 UNIV_INTERN
 trx_t*
 trx_get_trx_by_xid(
@@ -172,6 +172,247 @@ for RHEL4 support (GCC 3 doesn't support this instruction) */
 	asm(".byte 0xf2, 0x48, 0x0f, 0x38, 0xf1, 0x0a" \
 	    : "=c"(crc) : "c"(crc), "d"(buf)); \
 	len -= 8, buf += 8
+
+/* The crc32 instruction has a latency of three cycles but can be issued
+every cycle, so a single stream of crc32 instructions uses only a third
+of the CPU capacity. Long buffers are therefore split into three streams
+whose CRCs are calculated in an interleaved fashion. The CRC of the first
+stream is then shifted over the length of the second one and combined
+with it, and likewise with the third one. Shifting a CRC over a fixed
+number of zero bytes is a linear operation, which is done with tables
+built in ut_crc32_init(). */
+
+/** Length of each of the three streams of a long block */
+#define UT_CRC32_LONG	4096
+
+/** Length of each of the three streams of a short block */
+#define UT_CRC32_SHORT	256
+
+/* Tables that shift a CRC over UT_CRC32_LONG and UT_CRC32_SHORT zero
+bytes respectively, one byte of the CRC at a time */
+static ib_uint32_t	ut_crc32_long_table[4][256];
+static ib_uint32_t	ut_crc32_short_table[4][256];
+
+/********************************************************************//**
+Multiplies a 32x32 matrix over GF(2) by a vector.
+@return product */
+static
+ib_uint32_t
+ut_crc32_gf2_matrix_times(
+/*======================*/
+	const ib_uint32_t*	mat,	/*!< in: matrix, one column per bit */
+	ib_uint32_t		vec)	/*!< in: vector */
+{
+	ib_uint32_t	sum = 0;
+
+	while (vec) {
+		if (vec & 1) {
+			sum ^= *mat;
+		}
+		vec >>= 1;
+		mat++;
+	}
+
+	return(sum);
+}
+
+/********************************************************************//**
+Squares a 32x32 matrix over GF(2). */
+static
+void
+ut_crc32_gf2_matrix_square(
+/*=======================*/
+	ib_uint32_t*		square,	/*!< out: mat * mat */
+	const ib_uint32_t*	mat)	/*!< in: matrix */
+{
+	ulint	n;
+
+	for (n = 0; n < 32; n++) {
+		square[n] = ut_crc32_gf2_matrix_times(mat, mat[n]);
+	}
+}
+
+/********************************************************************//**
+Builds the table which shifts a CRC over len zero bytes. */
+static
+void
+ut_crc32_shift_table_init(
+/*======================*/
+	ib_uint32_t	table[4][256],	/*!< out: shift table */
+	ulint		len)		/*!< in: number of zero bytes, must
+					be a power of two */
+{
+	ib_uint32_t	even[32];	/* operator for an even power of
+					two zero bits */
+	ib_uint32_t	odd[32];	/* operator for an odd power of
+					two zero bits */
+	ib_uint32_t*	op;
+	ib_uint32_t	row;
+	ulint		n;
+
+	ut_a(len > 0 && !(len & (len - 1)));
+
+	/* The operator for one zero bit */
+	odd[0] = 0x82f63b78;
+	row = 1;
+	for (n = 1; n < 32; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+
+	/* The operators for two and four zero bits */
+	ut_crc32_gf2_matrix_square(even, odd);
+	ut_crc32_gf2_matrix_square(odd, even);
+
+	/* Square the operators, starting from the one for one zero byte,
+	until they cover len zero bytes */
+	for (;;) {
+		ut_crc32_gf2_matrix_square(even, odd);
+		op = even;
+		len >>= 1;
+		if (len == 0) {
+			break;
+		}
+
+		ut_crc32_gf2_matrix_square(odd, even);
+		op = odd;
+		len >>= 1;
+		if (len == 0) {
+			break;
+		}
+	}
+
+	for (n = 0; n < 256; n++) {
+		table[0][n] = ut_crc32_gf2_matrix_times(op, (ib_uint32_t) n);
+		table[1][n] = ut_crc32_gf2_matrix_times(
+			op, (ib_uint32_t) n << 8);
+		table[2][n] = ut_crc32_gf2_matrix_times(
+			op, (ib_uint32_t) n << 16);
+		table[3][n] = ut_crc32_gf2_matrix_times(
+			op, (ib_uint32_t) n << 24);
+	}
+}
+
+/********************************************************************//**
+Shifts a CRC over the number of zero bytes a table was built for.
+@return shifted CRC */
+UNIV_INLINE
+ib_uint64_t
+ut_crc32_shift(
+/*===========*/
+	const ib_uint32_t	table[4][256],	/*!< in: shift table */
+	ib_uint64_t		crc)		/*!< in: CRC */
+{
+	return(table[0][crc & 0xFF]
+	       ^ table[1][(crc >> 8) & 0xFF]
+	       ^ table[2][(crc >> 16) & 0xFF]
+	       ^ table[3][(crc >> 24) & 0xFF]);
+}
+
+/********************************************************************//**
+Adds eight bytes to a CRC using the crc32 instruction. The buffer does
+not need to be aligned.
+@return updated CRC */
+UNIV_INLINE
+ib_uint64_t
+ut_crc32_sse42_u64(
+/*===============*/
+	ib_uint64_t	crc,	/*!< in: CRC */
+	const byte*	buf)	/*!< in: data */
+{
+	ib_uint64_t	data;
+
+	memcpy(&data, buf, sizeof data);
+
+	asm("crc32q %1, %0" : "+r" (crc) : "rm" (data));
+
+	return(crc);
+}
+
+/********************************************************************//**
+Adds a byte to a CRC using the crc32 instruction.
+@return updated CRC */
+UNIV_INLINE
+ib_uint64_t
+ut_crc32_sse42_u8(
+/*==============*/
+	ib_uint64_t	crc,	/*!< in: CRC */
+	byte		data)	/*!< in: data */
+{
+	asm("crc32b %1, %0" : "+r" (crc) : "rm" (data));
+
+	return(crc);
+}
+
+/********************************************************************//**
+Adds three consecutive streams of len bytes each to a CRC, calculating
+the CRCs of the streams in an interleaved fashion.
+@return updated CRC */
+UNIV_INLINE
+ib_uint64_t
+ut_crc32_sse42_3way(
+/*================*/
+	ib_uint64_t		crc,	/*!< in: CRC */
+	const byte*		buf,	/*!< in: data, 3 * len bytes */
+	ulint			len,	/*!< in: length of a stream, a
+					multiple of 8 */
+	const ib_uint32_t	table[4][256])
+					/*!< in: table which shifts a CRC
+					over len zero bytes */
+{
+	ib_uint64_t	crc1 = 0;
+	ib_uint64_t	crc2 = 0;
+	const byte*	end = buf + len;
+
+	do {
+		crc = ut_crc32_sse42_u64(crc, buf);
+		crc1 = ut_crc32_sse42_u64(crc1, buf + len);
+		crc2 = ut_crc32_sse42_u64(crc2, buf + 2 * len);
+		buf += 8;
+	} while (buf < end);
+
+	crc = ut_crc32_shift(table, crc) ^ crc1;
+
+	return(ut_crc32_shift(table, crc) ^ crc2);
+}
+
+/********************************************************************//**
+Calculates the CRC32 of three buffers of the same length using CPU
+instructions, interleaving the calculations. */
+static
+void
+ut_crc32_sse42_3buf(
+/*================*/
+	const byte*	buf,	/*!< in: first buffer */
+	ulint		len,	/*!< in: length of each buffer */
+	ulint		stride,	/*!< in: distance between the buffers */
+	ib_uint32_t*	crcs)	/*!< out: CRC-32C of each buffer */
+{
+	ib_uint64_t	crc0 = (ib_uint32_t) (-1);
+	ib_uint64_t	crc1 = (ib_uint32_t) (-1);
+	ib_uint64_t	crc2 = (ib_uint32_t) (-1);
+	const byte*	buf1 = buf + stride;
+	const byte*	buf2 = buf + 2 * stride;
+	ulint		i;
+
+	ut_a(ut_crc32_sse2_enabled);
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		crc0 = ut_crc32_sse42_u64(crc0, buf + i);
+		crc1 = ut_crc32_sse42_u64(crc1, buf1 + i);
+		crc2 = ut_crc32_sse42_u64(crc2, buf2 + i);
+	}
+
+	for (; i < len; i++) {
+		crc0 = ut_crc32_sse42_u8(crc0, buf[i]);
+		crc1 = ut_crc32_sse42_u8(crc1, buf1[i]);
+		crc2 = ut_crc32_sse42_u8(crc2, buf2[i]);
+	}
+
+	crcs[0] = (ib_uint32_t) ((~crc0) & 0xFFFFFFFF);
+	crcs[1] = (ib_uint32_t) ((~crc1) & 0xFFFFFFFF);
+	crcs[2] = (ib_uint32_t) ((~crc2) & 0xFFFFFFFF);
+}
 #endif /* defined(__GNUC__) && defined(__x86_64__) */
 
 /********************************************************************//**
@@ -193,6 +434,20 @@ ut_crc32_sse42(
 		ut_crc32_sse42_byte;
 	}
 
+	while (len >= 3 * UT_CRC32_LONG) {
+		crc = ut_crc32_sse42_3way(crc, buf, UT_CRC32_LONG,
+					  ut_crc32_long_table);
+		buf += 3 * UT_CRC32_LONG;
+		len -= 3 * UT_CRC32_LONG;
+	}
+
+	while (len >= 3 * UT_CRC32_SHORT) {
+		crc = ut_crc32_sse42_3way(crc, buf, UT_CRC32_SHORT,
+					  ut_crc32_short_table);
+		buf += 3 * UT_CRC32_SHORT;
+		len -= 3 * UT_CRC32_SHORT;
+	}
+
 	while (len >= 32) {
 		ut_crc32_sse42_quadword;
 		ut_crc32_sse42_quadword;
@@ -310,9 +565,44 @@ ut_crc32_init()
 #endif /* defined(__GNUC__) && defined(__x86_64__) */
 
 	if (ut_crc32_sse2_enabled) {
+#if defined(__GNUC__) && defined(__x86_64__)
+		ut_crc32_shift_table_init(ut_crc32_long_table, UT_CRC32_LONG);
+		ut_crc32_shift_table_init(ut_crc32_short_table,
+					  UT_CRC32_SHORT);
+#endif /* defined(__GNUC__) && defined(__x86_64__) */
 		ut_crc32 = ut_crc32_sse42;
 	} else {
 		ut_crc32_slice8_table_init();
 		ut_crc32 = ut_crc32_slice8;
 	}
 }
+
+/********************************************************************//**
+Calculates the CRC32 of several buffers of the same length which are
+laid out at a fixed distance from each other, such as the log blocks of
+a log buffer. With CPU support, the CRCs of three buffers at a time are
+calculated in an interleaved fashion, which is faster than calculating
+them one after another. */
+UNIV_INTERN
+void
+ut_crc32_batch(
+/*===========*/
+	const byte*	buf,	/*!< in: first buffer */
+	ulint		len,	/*!< in: length of each buffer */
+	ulint		stride,	/*!< in: distance between the starts of
+				two consecutive buffers */
+	ulint		n,	/*!< in: number of buffers */
+	ib_uint32_t*	crcs)	/*!< out: CRC-32C of each buffer */
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	if (ut_crc32_sse2_enabled) {
+		for (; n >= 3; n -= 3, buf += 3 * stride, crcs += 3) {
+			ut_crc32_sse42_3buf(buf, len, stride, crcs);
+		}
+	}
+#endif /* defined(__GNUC__) && defined(__x86_64__) */
+
+	for (; n > 0; n--, buf += stride, crcs++) {
+		*crcs = ut_crc32(buf, len);
+	}
+}
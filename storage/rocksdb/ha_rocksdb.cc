@@ -375,6 +375,7 @@ static uint32_t rocksdb_validate_tables = 1;
 static char *rocksdb_datadir;
 static uint32_t rocksdb_table_stats_sampling_pct;
 static my_bool rocksdb_enable_bulk_load_api = 1;
+static uint32_t rocksdb_bulk_load_writer_threads = 0;
 static my_bool rpl_skip_tx_api_var = 0;
 static my_bool rocksdb_print_snapshot_conflict_queries = 0;
 
@@ -428,6 +429,7 @@ const ulong RDB_MAX_LOCK_WAIT_SECONDS = 1024 * 1024 * 1024;
 const ulong RDB_MAX_ROW_LOCKS = 1024 * 1024 * 1024;
 const ulong RDB_DEFAULT_BULK_LOAD_SIZE = 1000;
 const ulong RDB_MAX_BULK_LOAD_SIZE = 1024 * 1024 * 1024;
+const uint RDB_MAX_BULK_LOAD_WRITER_THREADS = 64;
 const size_t RDB_DEFAULT_MERGE_BUF_SIZE = 64 * 1024 * 1024;
 const size_t RDB_MIN_MERGE_BUF_SIZE = 100;
 const size_t RDB_DEFAULT_MERGE_COMBINE_READ_SIZE = 1024 * 1024 * 1024;
@@ -461,6 +463,21 @@ static MYSQL_SYSVAR_BOOL(enable_bulk_load_api, rocksdb_enable_bulk_load_api,
                          "Enables using SstFileWriter for bulk loading",
                          nullptr, nullptr, rocksdb_enable_bulk_load_api);
 
+static MYSQL_THDVAR_BOOL(
+    bulk_load_allow_unsorted, PLUGIN_VAR_RQCMDARG,
+    "Allow rows to be bulk loaded in any primary key order by sorting them "
+    "with an external merge sort",
+    nullptr, nullptr, FALSE);
+
+static MYSQL_SYSVAR_UINT(
+    bulk_load_writer_threads, rocksdb_bulk_load_writer_threads,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Number of threads writing sst files for bulk loads in the background. "
+    "Each of them may hold a buffered sst file of each bulk load in memory. "
+    "0 writes the sst files in the loading thread.",
+    nullptr, nullptr, /* default */ 0, /* min */ 0,
+    /* max */ RDB_MAX_BULK_LOAD_WRITER_THREADS, 0);
+
 static MYSQL_THDVAR_STR(tmpdir, PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_MEMALLOC,
                         "Directory for temporary files during DDL operations.",
                         nullptr, nullptr, "");
@@ -1156,6 +1173,8 @@ static struct st_mysql_sys_var *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(bulk_load_size),
     MYSQL_SYSVAR(merge_buf_size),
     MYSQL_SYSVAR(enable_bulk_load_api),
+    MYSQL_SYSVAR(bulk_load_allow_unsorted),
+    MYSQL_SYSVAR(bulk_load_writer_threads),
     MYSQL_SYSVAR(tmpdir),
     MYSQL_SYSVAR(merge_combine_read_size),
     MYSQL_SYSVAR(skip_bloom_filter_on_read),
@@ -1755,6 +1774,14 @@ public:
   virtual rocksdb::Status get(rocksdb::ColumnFamilyHandle *const column_family,
                               const rocksdb::Slice &key,
                               std::string *value) const = 0;
+  /*
+    Batched version of get(): look up all of the keys in one call. The
+    statuses and values are returned in the order of the keys.
+  */
+  virtual std::vector<rocksdb::Status>
+  multi_get(rocksdb::ColumnFamilyHandle *const column_family,
+            const std::vector<rocksdb::Slice> &keys,
+            std::vector<std::string> *const values) const = 0;
   virtual rocksdb::Status
   get_for_update(rocksdb::ColumnFamilyHandle *const column_family,
                  const rocksdb::Slice &key, std::string *const value,
@@ -2021,6 +2048,23 @@ public:
     return m_rocksdb_tx->Get(m_read_opts, column_family, key, value);
   }
 
+  std::vector<rocksdb::Status>
+  multi_get(rocksdb::ColumnFamilyHandle *const column_family,
+            const std::vector<rocksdb::Slice> &keys,
+            std::vector<std::string> *const values) const override {
+    const std::vector<rocksdb::ColumnFamilyHandle *> cfs(keys.size(),
+                                                         column_family);
+    /*
+      Transaction::MultiGet() has to merge every key with the write batch
+      of the transaction and does so with one Get() per key. Nothing needs
+      merging when the transaction has not written anything yet, so go to
+      the DB directly and get a real batched lookup in that case.
+    */
+    if (!has_modifications())
+      return rdb->MultiGet(m_read_opts, cfs, keys, values);
+    return m_rocksdb_tx->MultiGet(m_read_opts, cfs, keys, values);
+  }
+
   rocksdb::Status
   get_for_update(rocksdb::ColumnFamilyHandle *const column_family,
                  const rocksdb::Slice &key, std::string *const value,
@@ -2242,6 +2286,23 @@ public:
                                       value);
   }
 
+  std::vector<rocksdb::Status>
+  multi_get(rocksdb::ColumnFamilyHandle *const column_family,
+            const std::vector<rocksdb::Slice> &keys,
+            std::vector<std::string> *const values) const override {
+    if (!has_modifications()) {
+      const std::vector<rocksdb::ColumnFamilyHandle *> cfs(keys.size(),
+                                                           column_family);
+      return rdb->MultiGet(m_read_opts, cfs, keys, values);
+    }
+
+    std::vector<rocksdb::Status> statuses(keys.size());
+    values->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+      statuses[i] = get(column_family, keys[i], &(*values)[i]);
+    return statuses;
+  }
+
   rocksdb::Status
   get_for_update(rocksdb::ColumnFamilyHandle *const column_family,
                  const rocksdb::Slice &key, std::string *const value,
@@ -3320,6 +3381,7 @@ static int rocksdb_init_func(void *const p) {
 
 
   Rdb_sst_info::init(rdb);
+  Rdb_sst_info::start_writer_threads(rocksdb_bulk_load_writer_threads);
 
   /*
     Enable auto compaction, things needed for compaction filter are finished
@@ -3389,6 +3451,9 @@ static int rocksdb_done_func(void *const p) {
   // signal the drop index thread to stop
   rdb_drop_idx_thread.signal(true);
 
+  // All bulk loads have finished, stop the sst writer threads
+  Rdb_sst_info::stop_writer_threads();
+
   // Flush all memtables for not lose data, even if WAL is disabled.
   rocksdb_flush_all_memtables();
 
@@ -3712,7 +3777,8 @@ ha_rocksdb::ha_rocksdb(my_core::handlerton *const hton,
       m_sk_match_prefix(nullptr), m_sk_match_prefix_buf(nullptr),
       m_sk_packed_tuple_old(nullptr), m_dup_sk_packed_tuple(nullptr),
       m_dup_sk_packed_tuple_old(nullptr), m_pack_buffer(nullptr),
-      m_lock_rows(RDB_LOCK_NONE), m_keyread_only(FALSE),
+      m_mrr_fetch_start(0), m_mrr_pos(0), m_lock_rows(RDB_LOCK_NONE),
+      m_keyread_only(FALSE),
       m_bulk_load_tx(nullptr), m_encoder_arr(nullptr),
       m_row_checksums_checked(0), m_in_rpl_delete_rows(false),
       m_in_rpl_update_rows(false) {
@@ -6152,7 +6218,8 @@ int ha_rocksdb::get_row_by_rowid(uchar *const buf, const char *const rowid,
 
   if (m_lock_rows == RDB_LOCK_NONE) {
     tx->acquire_snapshot(true);
-    s = tx->get(m_pk_descr->get_cf(), key_slice, &m_retrieved_record);
+    if (m_mrr_keys.empty() || !mrr_batch_get(tx, key_slice, &s))
+      s = tx->get(m_pk_descr->get_cf(), key_slice, &m_retrieved_record);
   } else {
     s = get_for_update(tx, m_pk_descr->get_cf(), key_slice,
                        &m_retrieved_record);
@@ -6180,6 +6247,67 @@ int ha_rocksdb::get_row_by_rowid(uchar *const buf, const char *const rowid,
   DBUG_RETURN(rc);
 }
 
+/*
+  Look up a row in the rows announced by mrr_prefetch_rowids(), fetching the
+  next chunk of them with MultiGet() if needed. On success the row is put
+  into m_retrieved_record.
+
+  @return
+    true   - key was part of the batch, *status is the lookup result
+    false  - key is not in the batch, caller must do a point lookup
+*/
+
+bool ha_rocksdb::mrr_batch_get(Rdb_transaction *const tx,
+                               const rocksdb::Slice &key,
+                               rocksdb::Status *const status) {
+  DBUG_ASSERT(tx != nullptr);
+  DBUG_ASSERT(status != nullptr);
+
+  /*
+    DS-MRR reads the rowids in buffer order, but may skip some of them
+    (see RANGE_SEQ_IF::skip_record), so search forward from the last hit.
+  */
+  size_t pos = m_mrr_pos;
+  while (pos < m_mrr_keys.size() && key != rocksdb::Slice(m_mrr_keys[pos]))
+    pos++;
+
+  if (pos == m_mrr_keys.size())
+    return false;
+
+  /* Tells batched lookups from point lookups in tests */
+  DBUG_EXECUTE_IF("myrocks_mrr_batch_not_found", {
+    *status = rocksdb::Status::NotFound();
+    return true;
+  });
+
+  if (pos < m_mrr_fetch_start ||
+      pos >= m_mrr_fetch_start + m_mrr_statuses.size()) {
+    const size_t end = std::min(pos + RDB_MRR_BATCH_SIZE, m_mrr_keys.size());
+    const std::vector<rocksdb::Slice> keys(m_mrr_keys.begin() + pos,
+                                           m_mrr_keys.begin() + end);
+
+    m_mrr_values.clear();
+    m_mrr_statuses = tx->multi_get(m_pk_descr->get_cf(), keys, &m_mrr_values);
+    m_mrr_fetch_start = pos;
+  }
+
+  /* The same rowid may be requested again for the next range */
+  m_mrr_pos = pos;
+  *status = m_mrr_statuses[pos - m_mrr_fetch_start];
+  if (status->ok())
+    m_retrieved_record = m_mrr_values[pos - m_mrr_fetch_start];
+
+  return true;
+}
+
+void ha_rocksdb::mrr_batch_reset() {
+  m_mrr_keys.clear();
+  m_mrr_values.clear();
+  m_mrr_statuses.clear();
+  m_mrr_fetch_start = 0;
+  m_mrr_pos = 0;
+}
+
 int ha_rocksdb::index_next(uchar *const buf) {
   DBUG_ENTER_FUNC();
 
@@ -6900,21 +7028,38 @@ int ha_rocksdb::check_duplicate_sk(const TABLE *table_arg,
 
 int ha_rocksdb::bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
                               const rocksdb::Slice &key,
-                              const rocksdb::Slice &value) {
+                              const rocksdb::Slice &value,
+                              const bool sort) {
   rocksdb::ColumnFamilyHandle *const cf = kd.get_cf();
   DBUG_ASSERT(cf != nullptr);
 
+  int rc;
+
   if (m_sst_info == nullptr) {
-    m_sst_info = std::make_shared<Rdb_sst_info>(
+    const auto sst_info = std::make_shared<Rdb_sst_info>(
         rdb, m_table_handler->m_table_name, kd.get_name(), cf,
         rocksdb_db_options, THDVAR(ha_thd(), trace_sst_api));
+
+    if (sort) {
+      rc = sst_info->enable_sort(thd_rocksdb_tmpdir(),
+                                 THDVAR(ha_thd(), merge_buf_size),
+                                 THDVAR(ha_thd(), merge_combine_read_size));
+      if (rc != 0) {
+        /* Do not start the bulk load, the next key tries again */
+        my_printf_error(ER_UNKNOWN_ERROR, "Failed to start bulk load (%s)",
+                        MYF(0), sst_info->error_message().c_str());
+        return rc;
+      }
+    }
+
+    m_sst_info = sst_info;
     tx->start_bulk_load(this);
     m_bulk_load_tx = tx;
   }
 
   DBUG_ASSERT(m_sst_info != nullptr);
 
-  int rc = m_sst_info->put(key, value);
+  rc = m_sst_info->put(key, value);
   if (rc != 0) {
     my_printf_error(ER_UNKNOWN_ERROR,
                     "Failed to add a key to sst file writer(%s)", MYF(0),
@@ -6990,7 +7135,8 @@ int ha_rocksdb::update_pk(const Rdb_key_def &kd,
     /*
       Write the primary key directly to an SST file using an SstFileWriter
      */
-    rc = bulk_load_key(row_info.tx, kd, row_info.new_pk_slice, value_slice);
+    rc = bulk_load_key(row_info.tx, kd, row_info.new_pk_slice, value_slice,
+                       THDVAR(table->in_use, bulk_load_allow_unsorted));
   } else if (row_info.skip_unique_check) {
     /*
       It is responsibility of the user to make sure that the data being
@@ -7434,6 +7580,7 @@ int ha_rocksdb::rnd_end() {
   DBUG_ENTER_FUNC();
 
   release_scan_iterator();
+  mrr_batch_reset();
 
   DBUG_RETURN(HA_EXIT_SUCCESS);
 }
@@ -7460,6 +7607,8 @@ int ha_rocksdb::index_end() {
   DBUG_ENTER_FUNC();
 
   release_scan_iterator();
+  m_ds_mrr.dsmrr_close();
+  mrr_batch_reset();
 
   active_index = MAX_KEY;
   in_range_check_pushed_down = FALSE;
@@ -7717,6 +7866,77 @@ int ha_rocksdb::rnd_pos(uchar *const buf, uchar *const pos) {
   DBUG_RETURN(rc);
 }
 
+/*
+  Multi Range Read interface, DS-MRR calls. The rowids collected by DS-MRR
+  are read back in batches with MultiGet(), see mrr_prefetch_rowids().
+*/
+
+int ha_rocksdb::multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
+                                      uint n_ranges, uint mode,
+                                      HANDLER_BUFFER *buf) {
+  mrr_batch_reset();
+  return m_ds_mrr.dsmrr_init(this, seq, seq_init_param, n_ranges, mode, buf);
+}
+
+int ha_rocksdb::multi_range_read_next(char **range_info) {
+  return m_ds_mrr.dsmrr_next(range_info);
+}
+
+ha_rows ha_rocksdb::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
+                                                void *seq_init_param,
+                                                uint n_ranges, uint *bufsz,
+                                                uint *flags,
+                                                Cost_estimate *cost) {
+  /* See comments in ha_myisam::multi_range_read_info_const */
+  m_ds_mrr.init(this, table);
+  return m_ds_mrr.dsmrr_info_const(keyno, seq, seq_init_param, n_ranges,
+                                   bufsz, flags, cost);
+}
+
+ha_rows ha_rocksdb::multi_range_read_info(uint keyno, uint n_ranges,
+                                          uint keys, uint *bufsz,
+                                          uint *flags, Cost_estimate *cost) {
+  m_ds_mrr.init(this, table);
+  return m_ds_mrr.dsmrr_info(keyno, n_ranges, keys, bufsz, flags, cost);
+}
+
+/*
+  @brief
+    Remember the rowids DS-MRR is going to read with rnd_pos(), so that
+    get_row_by_rowid() can fetch them with MultiGet() instead of issuing a
+    Get() per row.
+
+  @detail
+    Locking reads go through GetForUpdate() one row at a time and are not
+    batched.
+*/
+
+void ha_rocksdb::mrr_prefetch_rowids(const uchar *const rowids, uint n_rowids,
+                                     uint elem_size) {
+  DBUG_ENTER_FUNC();
+
+  mrr_batch_reset();
+
+  if (m_lock_rows != RDB_LOCK_NONE || n_rowids < 2)
+    DBUG_VOID_RETURN;
+
+  m_mrr_keys.reserve(n_rowids);
+  for (uint i = 0; i < n_rowids; i++) {
+    const char *const rowid =
+        reinterpret_cast<const char *>(rowids) + i * elem_size;
+    const size_t len =
+        m_pk_descr->key_length(table, rocksdb::Slice(rowid, ref_length));
+    if (len == size_t(-1)) {
+      /* Let rnd_pos() report the corruption */
+      mrr_batch_reset();
+      break;
+    }
+    m_mrr_keys.emplace_back(rowid, len);
+  }
+
+  DBUG_VOID_RETURN;
+}
+
 /*
   @brief
     Calculate (if needed) the bitmap of indexes that are modified by the
@@ -9147,7 +9367,7 @@ int ha_rocksdb::inplace_populate_sk(
       /*
         Insert key and slice to SST via SSTFileWriter API.
       */
-      if ((res = bulk_load_key(tx, *index, merge_key, merge_val))) {
+      if ((res = bulk_load_key(tx, *index, merge_key, merge_val, false))) {
         break;
       }
     }
@@ -156,6 +156,13 @@ const char *const INDEX_THREAD_NAME = "myrocks-index";
 #define DEFAULT_SUBCOMPACTIONS 1
 #define MAX_SUBCOMPACTIONS 64
 
+/*
+  Number of rows fetched with one MultiGet() call when reading the rows
+  found by a Disk-Sweep MRR scan. Bounds the memory used for the values of
+  a batch, while still amortizing the per-lookup overhead.
+*/
+#define RDB_MRR_BATCH_SIZE 128
+
 /*
   Defines the field sizes for serializing XID object to a string representation.
   string byte format: [field_size: field_value, ...]
@@ -408,6 +415,22 @@ class ha_rocksdb : public my_core::handler {
   */
   std::string m_retrieved_record;
 
+  /*
+    Rowids announced by DS-MRR through mrr_prefetch_rowids(), in the order
+    in which rnd_pos() is going to ask for them. The rows are fetched with
+    MultiGet() in chunks of RDB_MRR_BATCH_SIZE keys:
+    m_mrr_values[i] holds the row for m_mrr_keys[m_mrr_fetch_start + i].
+  */
+  std::vector<std::string> m_mrr_keys;
+  std::vector<std::string> m_mrr_values;
+  std::vector<rocksdb::Status> m_mrr_statuses;
+  size_t m_mrr_fetch_start;
+  /* Position in m_mrr_keys of the next rowid expected by rnd_pos() */
+  size_t m_mrr_pos;
+
+  /* Disk-Sweep Multi-Range Read implementation */
+  my_core::DsMrr_impl m_ds_mrr;
+
   /* Type of locking to apply to rows */
   enum { RDB_LOCK_NONE, RDB_LOCK_READ, RDB_LOCK_WRITE } m_lock_rows;
 
@@ -468,6 +491,11 @@ class ha_rocksdb : public my_core::handler {
                  rocksdb::ColumnFamilyHandle *const column_family,
                  const rocksdb::Slice &key, std::string *const value) const;
 
+  bool mrr_batch_get(Rdb_transaction *const tx, const rocksdb::Slice &key,
+                     rocksdb::Status *const status)
+      __attribute__((__nonnull__, __warn_unused_result__));
+  void mrr_batch_reset();
+
   int get_row_by_rowid(uchar *const buf, const char *const rowid,
                        const uint rowid_size)
       __attribute__((__nonnull__, __warn_unused_result__));
@@ -922,7 +950,8 @@ private:
                          struct unique_sk_buf_info *sk_info)
       __attribute__((__nonnull__, __warn_unused_result__));
   int bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
-                    const rocksdb::Slice &key, const rocksdb::Slice &value)
+                    const rocksdb::Slice &key, const rocksdb::Slice &value,
+                    const bool sort)
       __attribute__((__nonnull__, __warn_unused_result__));
   int update_pk(const Rdb_key_def &kd, const struct update_row_info &row_info,
                 const bool &pk_changed) __attribute__((__warn_unused_result__));
@@ -1003,6 +1032,22 @@ public:
 
   int rnd_pos(uchar *const buf, uchar *const pos) override
       __attribute__((__warn_unused_result__));
+
+  int multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
+                            uint n_ranges, uint mode,
+                            HANDLER_BUFFER *buf) override
+      __attribute__((__warn_unused_result__));
+  int multi_range_read_next(char **range_info) override
+      __attribute__((__warn_unused_result__));
+  ha_rows multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
+                                      void *seq_init_param, uint n_ranges,
+                                      uint *bufsz, uint *flags,
+                                      Cost_estimate *cost) override;
+  ha_rows multi_range_read_info(uint keyno, uint n_ranges, uint keys,
+                                uint *bufsz, uint *flags,
+                                Cost_estimate *cost) override;
+  void mrr_prefetch_rowids(const uchar *const rowids, uint n_rowids,
+                           uint elem_size) override;
   void position(const uchar *const record) override;
   int info(uint) override;
 
@@ -1022,6 +1067,8 @@ public:
 
     /* Free blob data */
     m_retrieved_record.clear();
+    mrr_batch_reset();
+    m_ds_mrr.reset();
 
     DBUG_RETURN(HA_EXIT_SUCCESS);
   }
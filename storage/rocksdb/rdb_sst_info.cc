@@ -34,9 +34,21 @@
 #include "./ha_rocksdb.h"
 #include "./ha_rocksdb_proto.h"
 #include "./rdb_cf_options.h"
+#include "./rdb_index_merge.h"
 
 namespace myrocks {
 
+/*
+  The bulk load writer threads are shared by all bulk loads and take
+  batches from a single queue.  Without writer threads each bulk load
+  writes and ingests its sst files one at a time in the loading thread.
+*/
+static std::mutex rdb_sst_writer_mutex;
+static std::condition_variable rdb_sst_writer_cond;
+static std::deque<Rdb_sst_batch *> rdb_sst_writer_queue;
+static std::vector<std::thread> rdb_sst_writer_threads;
+static bool rdb_sst_writer_stop = false;
+
 Rdb_sst_file::Rdb_sst_file(rocksdb::DB *const db,
                            rocksdb::ColumnFamilyHandle *const cf,
                            const rocksdb::DBOptions &db_options,
@@ -116,54 +128,71 @@ std::string Rdb_sst_file::generateKey(const std::string &key) {
   return res;
 }
 
-// This function is run by the background thread
-rocksdb::Status Rdb_sst_file::commit() {
+rocksdb::Status Rdb_sst_file::finish() {
   DBUG_ASSERT(m_sst_file_writer != nullptr);
 
-  rocksdb::Status s;
   rocksdb::ExternalSstFileInfo fileinfo; /// Finish may should be modified
 
   // Close out the sst file
-  s = m_sst_file_writer->Finish(&fileinfo);
+  const rocksdb::Status s = m_sst_file_writer->Finish(&fileinfo);
   if (m_tracing) {
     // NO_LINT_DEBUG
     sql_print_information("SST Tracing: Finish returned %s",
                           s.ok() ? "ok" : "not ok");
   }
 
+  if (s.ok() && m_tracing) {
+    // NO_LINT_DEBUG
+    sql_print_information("SST Tracing: Finished file %s, smallest key: %s, "
+                          "largest key: %s, file size: %lu, "
+                          "num_entries: %lu",
+                          fileinfo.file_path.c_str(),
+                          generateKey(fileinfo.smallest_key).c_str(),
+                          generateKey(fileinfo.largest_key).c_str(),
+                          fileinfo.file_size, fileinfo.num_entries);
+  }
+
+  delete m_sst_file_writer;
+  m_sst_file_writer = nullptr;
+
+  return s;
+}
+
+rocksdb::Status Rdb_sst_file::commit() {
+  rocksdb::Status s = finish();
   if (s.ok()) {
-    if (m_tracing) {
-      // NO_LINT_DEBUG
-      sql_print_information("SST Tracing: Adding file %s, smallest key: %s, "
-                            "largest key: %s, file size: %lu, "
-                            "num_entries: %lu",
-                            fileinfo.file_path.c_str(),
-                            generateKey(fileinfo.smallest_key).c_str(),
-                            generateKey(fileinfo.largest_key).c_str(),
-                            fileinfo.file_size, fileinfo.num_entries);
-    }
+    s = ingest(m_db, m_cf, {m_name}, m_tracing);
+  }
 
-    // Add the file to the database
-    // Set the snapshot_consistency parameter to false since no one
-    // should be accessing the table we are bulk loading
-    rocksdb::IngestExternalFileOptions opts;
-    opts.move_files = true;
-    opts.snapshot_consistency = false;
-    opts.allow_global_seqno = false;
-    opts.allow_blocking_flush = false;
-    s = m_db->IngestExternalFile(m_cf, {m_name}, opts);
-
-    if (m_tracing) {
+  return s;
+}
+
+// Add finished sst files, which must not overlap, to the database
+rocksdb::Status Rdb_sst_file::ingest(rocksdb::DB *const db,
+                                     rocksdb::ColumnFamilyHandle *const cf,
+                                     const std::vector<std::string> &names,
+                                     const bool tracing) {
+  DBUG_ASSERT(db != nullptr);
+  DBUG_ASSERT(cf != nullptr);
+  DBUG_ASSERT(!names.empty());
+
+  // Set the snapshot_consistency parameter to false since no one
+  // should be accessing the table we are bulk loading
+  rocksdb::IngestExternalFileOptions opts;
+  opts.move_files = true;
+  opts.snapshot_consistency = false;
+  opts.allow_global_seqno = false;
+  opts.allow_blocking_flush = false;
+  const rocksdb::Status s = db->IngestExternalFile(cf, names, opts);
+
+  if (tracing) {
+    for (const auto &name : names) {
       // NO_LINT_DEBUG
       sql_print_information("SST Tracing: AddFile(%s) returned %s",
-                            fileinfo.file_path.c_str(),
-                            s.ok() ? "ok" : "not ok");
+                            name.c_str(), s.ok() ? "ok" : "not ok");
     }
   }
 
-  delete m_sst_file_writer;
-  m_sst_file_writer = nullptr;
-
   return s;
 }
 
@@ -173,11 +202,8 @@ Rdb_sst_info::Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
                            const rocksdb::DBOptions &db_options,
                            const bool &tracing)
     : m_db(db), m_cf(cf), m_db_options(db_options), m_curr_size(0),
-      m_sst_count(0), m_error_msg(""),
-#if defined(RDB_SST_INFO_USE_THREAD)
-      m_queue(), m_mutex(), m_cond(), m_thread(nullptr), m_finished(false),
-#endif
-      m_sst_file(nullptr), m_tracing(tracing) {
+      m_sst_count(0), m_error_msg(""), m_sst_file(nullptr), m_tracing(tracing),
+      m_merge(nullptr), m_batch(nullptr), m_batches_pending(0) {
   m_prefix = db->GetName() + "/";
 
   std::string normalized_table;
@@ -204,19 +230,56 @@ Rdb_sst_info::Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
 
 Rdb_sst_info::~Rdb_sst_info() {
   DBUG_ASSERT(m_sst_file == nullptr);
-#if defined(RDB_SST_INFO_USE_THREAD)
-  DBUG_ASSERT(m_thread == nullptr);
-#endif
+
+  // The writer threads may still be working on our batches after an error
+  wait_for_batches(0);
+  delete m_batch;
+}
+
+/*
+  Sort the keys added from now on with an external merge sort, so that
+  they don't have to arrive in order.
+*/
+int Rdb_sst_info::enable_sort(const char *const tmpfile_path,
+                              const ulonglong &merge_buf_size,
+                              const ulonglong &merge_combine_read_size) {
+  DBUG_ASSERT(m_merge == nullptr);
+  DBUG_ASSERT(m_sst_count == 0);
+
+  m_merge.reset(new Rdb_index_merge(tmpfile_path, merge_buf_size,
+                                    merge_combine_read_size,
+                                    m_cf->GetComparator()));
+
+  const int rc = m_merge->init();
+  if (rc != 0) {
+    set_error_msg("Failed to initialize the external merge sort");
+    m_merge = nullptr;
+  }
+
+  return rc;
 }
 
 int Rdb_sst_info::open_new_sst_file() {
   DBUG_ASSERT(m_sst_file == nullptr);
+  DBUG_ASSERT(m_batch == nullptr);
 
   // Create the new sst file's name
   const std::string name = m_prefix + std::to_string(m_sst_count++) + m_suffix;
 
   // Create the new sst file object
-  m_sst_file = new Rdb_sst_file(m_db, m_cf, m_db_options, name, m_tracing);
+  Rdb_sst_file *const sst_file =
+      new Rdb_sst_file(m_db, m_cf, m_db_options, name, m_tracing);
+
+  if (!rdb_sst_writer_threads.empty()) {
+    // A writer thread will open the file and write the batch out
+    m_batch = new Rdb_sst_batch();
+    m_batch->m_owner = this;
+    m_batch->m_file.reset(sst_file);
+    m_curr_size = 0;
+    return HA_EXIT_SUCCESS;
+  }
+
+  m_sst_file = sst_file;
 
   // Open the sst file
   const rocksdb::Status s = m_sst_file->open();
@@ -233,33 +296,34 @@ int Rdb_sst_info::open_new_sst_file() {
 }
 
 void Rdb_sst_info::close_curr_sst_file() {
-  DBUG_ASSERT(m_sst_file != nullptr);
+  DBUG_ASSERT(m_sst_file != nullptr || m_batch != nullptr);
   DBUG_ASSERT(m_curr_size > 0);
 
-#if defined(RDB_SST_INFO_USE_THREAD)
-  if (m_thread == nullptr) {
-    // We haven't already started a background thread, so start one
-    m_thread = new std::thread(thread_fcn, this);
-  }
+  if (m_batch != nullptr) {
+    // Keep at most one batch per writer thread in flight so that the
+    // memory used by a bulk load stays bounded
+    wait_for_batches(static_cast<uint>(rdb_sst_writer_threads.size()) - 1);
 
-  DBUG_ASSERT(m_thread != nullptr);
+    {
+      const std::lock_guard<std::mutex> guard(m_mutex);
+      m_batches_pending++;
+    }
 
-  {
-    // Add this finished sst file to the queue (while holding mutex)
-    const std::lock_guard<std::mutex> guard(m_mutex);
-    m_queue.push(m_sst_file);
-  }
+    {
+      const std::lock_guard<std::mutex> guard(rdb_sst_writer_mutex);
+      rdb_sst_writer_queue.push_back(m_batch);
+    }
 
-  // Notify the background thread that there is a new entry in the queue
-  m_cond.notify_one();
-#else
-  const rocksdb::Status s = m_sst_file->commit();
-  if (!s.ok()) {
-    set_error_msg(s.ToString());
-  }
+    rdb_sst_writer_cond.notify_one();
+    m_batch = nullptr;
+  } else {
+    const rocksdb::Status s = m_sst_file->commit();
+    if (!s.ok()) {
+      set_error_msg(s.ToString());
+    }
 
-  delete m_sst_file;
-#endif
+    delete m_sst_file;
+  }
 
   // Reset for next sst file
   m_sst_file = nullptr;
@@ -267,6 +331,21 @@ void Rdb_sst_info::close_curr_sst_file() {
 }
 
 int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
+  if (m_merge != nullptr) {
+    // The keys are added to sst files in order at commit
+    const int rc = m_merge->add(key, value);
+    if (rc != 0) {
+      set_error_msg("Failed to add a key to the external merge sort");
+    }
+
+    return rc;
+  }
+
+  return put_sorted(key, value);
+}
+
+int Rdb_sst_info::put_sorted(const rocksdb::Slice &key,
+                             const rocksdb::Slice &value) {
   int rc;
 
   if (m_curr_size >= m_max_size) {
@@ -274,7 +353,17 @@ int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
     close_curr_sst_file();
 
     // While we are here, check to see if we have had any errors from the
-    // background thread - we don't want to wait for the end to report them
+    // writer threads - we don't want to wait for the end to report them
+    std::string bg_error_msg;
+    {
+      const std::lock_guard<std::mutex> guard(m_mutex);
+      bg_error_msg = m_bg_error_msg;
+    }
+
+    if (m_error_msg.empty() && !bg_error_msg.empty()) {
+      set_error_msg(bg_error_msg);
+    }
+
     if (!m_error_msg.empty()) {
       return HA_EXIT_FAILURE;
     }
@@ -288,6 +377,23 @@ int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
     }
   }
 
+  if (m_batch != nullptr) {
+    // The sst file writer would only see an out of order key in a writer
+    // thread, so check the order here to fail the statement right away
+    if (!m_last_key.empty() &&
+        m_cf->GetComparator()->Compare(key, m_last_key) <= 0) {
+      set_error_msg("Keys must be added in order");
+      return HA_EXIT_FAILURE;
+    }
+
+    m_last_key.assign(key.data(), key.size());
+    m_batch->m_data.append(key.data(), key.size());
+    m_batch->m_data.append(value.data(), value.size());
+    m_batch->m_sizes.push_back(std::make_pair(key.size(), value.size()));
+    m_curr_size += key.size() + value.size();
+    return HA_EXIT_SUCCESS;
+  }
+
   DBUG_ASSERT(m_sst_file != nullptr);
 
   // Add the key/value to the current sst file
@@ -303,23 +409,52 @@ int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
 }
 
 int Rdb_sst_info::commit() {
+  if (m_merge != nullptr) {
+    // Add the sorted keys, stopping at the first error
+    rocksdb::Slice merge_key;
+    rocksdb::Slice merge_val;
+    int rc;
+    while ((rc = m_merge->next(&merge_key, &merge_val)) == 0) {
+      if (put_sorted(merge_key, merge_val) != 0) {
+        break;
+      }
+    }
+
+    // -1 means that all the keys were read
+    if (rc > 0) {
+      set_error_msg("Failed to read a key from the external merge sort");
+    }
+
+    m_merge = nullptr;
+  }
+
   if (m_curr_size > 0) {
     // Close out any existing files
     close_curr_sst_file();
   }
 
-#if defined(RDB_SST_INFO_USE_THREAD)
-  if (m_thread != nullptr) {
-    // Tell the background thread we are done
-    m_finished = true;
-    m_cond.notify_one();
+  // Wait for the writer threads and ingest their files all at once
+  wait_for_batches(0);
 
-    // Wait for the background thread to finish
-    m_thread->join();
-    delete m_thread;
-    m_thread = nullptr;
+  if (m_error_msg.empty() && !m_bg_error_msg.empty()) {
+    set_error_msg(m_bg_error_msg);
   }
-#endif
+
+  if (m_error_msg.empty() && !m_files.empty()) {
+    std::vector<std::string> names;
+    for (const auto &sst_file : m_files) {
+      names.push_back(sst_file->name());
+    }
+
+    const rocksdb::Status s =
+        Rdb_sst_file::ingest(m_db, m_cf, names, m_tracing);
+    if (!s.ok()) {
+      set_error_msg(s.ToString());
+    }
+  }
+
+  // Remove the files that were not ingested
+  m_files.clear();
 
   // Did we get any errors?
   if (!m_error_msg.empty()) {
@@ -329,59 +464,107 @@ int Rdb_sst_info::commit() {
   return HA_EXIT_SUCCESS;
 }
 
+void Rdb_sst_info::wait_for_batches(const uint max_pending) {
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_cond.wait(lk, [&] { return m_batches_pending <= max_pending; });
+}
+
 void Rdb_sst_info::set_error_msg(const std::string &msg) {
-#if defined(RDB_SST_INFO_USE_THREAD)
-  // Both the foreground and background threads can set the error message
-  // so lock the mutex to protect it.  We only want the first error that
-  // we encounter.
-  const std::lock_guard<std::mutex> guard(m_mutex);
-#endif
   my_printf_error(ER_UNKNOWN_ERROR, "bulk load error: %s", MYF(0), msg.c_str());
   if (m_error_msg.empty()) {
     m_error_msg = msg;
   }
 }
 
-#if defined(RDB_SST_INFO_USE_THREAD)
-// Static thread function - the Rdb_sst_info object is in 'object'
-void Rdb_sst_info::thread_fcn(void *object) {
-  reinterpret_cast<Rdb_sst_info *>(object)->run_thread();
+// This function is run by a writer thread
+void Rdb_sst_info::finish_batch(Rdb_sst_batch *const batch,
+                                const rocksdb::Status &s) {
+  std::unique_ptr<Rdb_sst_file> sst_file = std::move(batch->m_file);
+  delete batch;
+
+  const std::lock_guard<std::mutex> guard(m_mutex);
+  if (!s.ok() && m_bg_error_msg.empty()) {
+    m_bg_error_msg = s.ToString();
+  }
+
+  m_files.push_back(std::move(sst_file));
+  m_batches_pending--;
+
+  // Notify while holding the mutex, the owner may be destroyed as soon as
+  // it sees its last batch finished
+  m_cond.notify_all();
 }
 
-void Rdb_sst_info::run_thread() {
-  const std::unique_lock<std::mutex> lk(m_mutex);
+// This function is run by a writer thread
+void Rdb_sst_info::write_batch(Rdb_sst_batch *const batch) {
+  Rdb_sst_file *const sst_file = batch->m_file.get();
 
-  do {
-    // Wait for notification or 1 second to pass
-    m_cond.wait_for(lk, std::chrono::seconds(1));
+  rocksdb::Status s = sst_file->open();
 
-    // Inner loop pulls off all Rdb_sst_file entries and processes them
-    while (!m_queue.empty()) {
-      const Rdb_sst_file *const sst_file = m_queue.front();
-      m_queue.pop();
+  const char *data = batch->m_data.data();
+  for (const auto &sizes : batch->m_sizes) {
+    if (!s.ok()) {
+      break;
+    }
 
-      // Release the lock - we don't want to hold it while committing the file
-      lk.unlock();
+    s = sst_file->put(rocksdb::Slice(data, sizes.first),
+                      rocksdb::Slice(data + sizes.first, sizes.second));
+    data += sizes.first + sizes.second;
+  }
 
-      // Close out the sst file and add it to the database
-      const rocksdb::Status s = sst_file->commit();
-      if (!s.ok()) {
-        set_error_msg(s.ToString());
-      }
+  if (s.ok()) {
+    s = sst_file->finish();
+  }
+
+  batch->m_owner->finish_batch(batch, s);
+}
+
+void Rdb_sst_info::run_writer_thread() {
+  std::unique_lock<std::mutex> lk(rdb_sst_writer_mutex);
 
-      delete sst_file;
+  for (;;) {
+    rdb_sst_writer_cond.wait(lk, [] {
+      return rdb_sst_writer_stop || !rdb_sst_writer_queue.empty();
+    });
 
-      // Reacquire the lock for the next inner loop iteration
-      lk.lock();
+    // Bulk loads have all finished before the threads are stopped
+    if (rdb_sst_writer_queue.empty()) {
+      break;
     }
 
-    // If the queue is empty and the main thread has indicated we should exit
-    // break out of the loop.
-  } while (!m_finished);
+    Rdb_sst_batch *const batch = rdb_sst_writer_queue.front();
+    rdb_sst_writer_queue.pop_front();
+
+    // Release the lock - we don't want to hold it while writing the file
+    lk.unlock();
+    write_batch(batch);
+    lk.lock();
+  }
+}
+
+void Rdb_sst_info::start_writer_threads(const uint count) {
+  DBUG_ASSERT(rdb_sst_writer_threads.empty());
+
+  rdb_sst_writer_stop = false;
+  for (uint ii = 0; ii < count; ii++) {
+    rdb_sst_writer_threads.push_back(std::thread(run_writer_thread));
+  }
+}
+
+void Rdb_sst_info::stop_writer_threads() {
+  {
+    const std::lock_guard<std::mutex> guard(rdb_sst_writer_mutex);
+    rdb_sst_writer_stop = true;
+  }
+
+  rdb_sst_writer_cond.notify_all();
+
+  for (auto &thread : rdb_sst_writer_threads) {
+    thread.join();
+  }
 
-  DBUG_ASSERT(m_queue.empty());
+  rdb_sst_writer_threads.clear();
 }
-#endif
 
 void Rdb_sst_info::init(const rocksdb::DB *const db) {
   const std::string path = db->GetName() + FN_DIRSEP;
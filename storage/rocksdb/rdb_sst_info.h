@@ -16,22 +16,28 @@
 
 #pragma once
 
+/* MySQL header files */
+#include "./my_global.h" /* ulonglong */
+
 /* C++ standard header files */
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 /* RocksDB header files */
 #include "rocksdb/db.h"
 #include "rocksdb/sst_file_writer.h"
 
-// define RDB_SST_INFO_USE_THREAD /* uncomment to use threads */
-
 namespace myrocks {
 
+class Rdb_index_merge;
+class Rdb_sst_info;
+
 class Rdb_sst_file {
 private:
   Rdb_sst_file(const Rdb_sst_file &p) = delete;
@@ -54,7 +60,26 @@ public:
 
   rocksdb::Status open();
   rocksdb::Status put(const rocksdb::Slice &key, const rocksdb::Slice &value);
+  rocksdb::Status finish();
   rocksdb::Status commit();
+
+  const std::string &name() const { return m_name; }
+
+  static rocksdb::Status ingest(rocksdb::DB *const db,
+                                rocksdb::ColumnFamilyHandle *const cf,
+                                const std::vector<std::string> &names,
+                                const bool tracing);
+};
+
+/*
+  The sorted keys and values of one sst file, written out by one of the
+  bulk load writer threads.
+*/
+struct Rdb_sst_batch {
+  Rdb_sst_info *m_owner;
+  std::unique_ptr<Rdb_sst_file> m_file;
+  std::string m_data; // keys and values back to back
+  std::vector<std::pair<size_t, size_t>> m_sizes; // key and value sizes
 };
 
 class Rdb_sst_info {
@@ -71,25 +96,31 @@ private:
   std::string m_error_msg;
   std::string m_prefix;
   static std::string m_suffix;
-#if defined(RDB_SST_INFO_USE_THREAD)
-  std::queue<Rdb_sst_file *> m_queue;
-  std::mutex m_mutex;
-  std::condition_variable m_cond;
-  std::thread *m_thread;
-  bool m_finished;
-#endif
   Rdb_sst_file *m_sst_file;
   const bool m_tracing;
 
+  // Unsorted input is sorted here before being added to sst files
+  std::unique_ptr<Rdb_index_merge> m_merge;
+
+  // Files written by the writer threads are ingested together at commit
+  Rdb_sst_batch *m_batch;
+  std::string m_last_key;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  uint m_batches_pending;
+  std::vector<std::unique_ptr<Rdb_sst_file>> m_files;
+  std::string m_bg_error_msg;
+
   int open_new_sst_file();
   void close_curr_sst_file();
+  int put_sorted(const rocksdb::Slice &key, const rocksdb::Slice &value);
+  void wait_for_batches(const uint max_pending);
   void set_error_msg(const std::string &msg);
 
-#if defined(RDB_SST_INFO_USE_THREAD)
-  void run_thread();
+  void finish_batch(Rdb_sst_batch *const batch, const rocksdb::Status &s);
 
-  static void thread_fcn(void *object);
-#endif
+  static void write_batch(Rdb_sst_batch *const batch);
+  static void run_writer_thread();
 
 public:
   Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
@@ -98,12 +129,18 @@ public:
                const rocksdb::DBOptions &db_options, const bool &tracing);
   ~Rdb_sst_info();
 
+  int enable_sort(const char *const tmpfile_path,
+                  const ulonglong &merge_buf_size,
+                  const ulonglong &merge_combine_read_size);
   int put(const rocksdb::Slice &key, const rocksdb::Slice &value);
   int commit();
 
   const std::string &error_message() const { return m_error_msg; }
 
   static void init(const rocksdb::DB *const db);
+
+  static void start_writer_threads(const uint count);
+  static void stop_writer_threads();
 };
 
 } // namespace myrocks
@@ -0,0 +1,557 @@
+/* Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "my_global.h"
+#include "my_rdtsc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef LINUX_NATIVE_AIO
+#include <libaio.h>
+#endif
+
+#ifdef LINUX_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace innodb_os0file_unittest {
+
+/*
+  Storage microbenchmark of the InnoDB AIO backends: the synchronous
+  reads and writes done by the simulated AIO handler threads, libaio and
+  io_uring. Each backend reads a batch of random pages, as read-ahead
+  does, and writes a batch of pages followed by a flush, as a buffer pool
+  flush batch does. The contents read back are checked against what was
+  written.
+
+  The backends are driven with the same system calls that os0file.cc
+  uses, so that the test does not need the rest of the storage engine.
+  Increase num_iterations and the file size to get stable numbers, and
+  set TMPDIR to the file system of interest: tmpfs does not support
+  O_DIRECT and shows little difference.
+*/
+
+// Size of an InnoDB page with the default page size.
+static const size_t page_size= 16384;
+// Number of pages in the test file.
+static const size_t n_file_pages= 1024;
+// Number of pages in a read-ahead area or a flush batch.
+static const size_t batch_size= 64;
+// Number of batches timed for each backend. Increase for benchmarking!
+static const int num_iterations= 20;
+
+
+/* Fills a page with a pattern derived from its page number and the
+generation of the write. */
+static void fill_page(unsigned char *page, size_t page_no, unsigned gen)
+{
+  for (size_t ix= 0; ix < page_size; ix+= 4)
+  {
+    uint32 v= static_cast<uint32>(page_no * 2654435761U + gen + ix);
+    memcpy(page + ix, &v, 4);
+  }
+}
+
+
+/* One AIO backend: submits a batch of page reads or writes and waits for
+all of them to complete, or flushes the file. */
+class Backend
+{
+public:
+  virtual ~Backend() {}
+  virtual const char *name() const= 0;
+  /* Returns false if the backend is not usable. */
+  virtual bool init(int fd)= 0;
+  virtual bool io(bool write, unsigned char *const *bufs,
+                  const size_t *page_nos, size_t n)= 0;
+  virtual bool flush()= 0;
+};
+
+
+/* The simulated AIO handler threads do synchronous I/O one request at
+a time. */
+class SyncBackend : public Backend
+{
+public:
+  SyncBackend() : m_fd(-1) {}
+
+  virtual const char *name() const { return "simulated"; }
+
+  virtual bool init(int fd) { m_fd= fd; return true; }
+
+  virtual bool io(bool write, unsigned char *const *bufs,
+                  const size_t *page_nos, size_t n)
+  {
+    for (size_t i= 0; i < n; i++)
+    {
+      off_t off= static_cast<off_t>(page_nos[i] * page_size);
+      ssize_t ret= write
+        ? pwrite(m_fd, bufs[i], page_size, off)
+        : pread(m_fd, bufs[i], page_size, off);
+
+      if (ret != static_cast<ssize_t>(page_size))
+        return false;
+    }
+    return true;
+  }
+
+  virtual bool flush() { return fsync(m_fd) == 0; }
+
+private:
+  int m_fd;
+};
+
+
+#ifdef LINUX_NATIVE_AIO
+/* libaio submits the batch with one io_submit() but has no asynchronous
+flush, so the flush is a synchronous fsync() as in os_file_flush(). */
+class LibaioBackend : public Backend
+{
+public:
+  LibaioBackend() : m_fd(-1), m_ctx(0) {}
+
+  virtual ~LibaioBackend()
+  {
+    if (m_ctx)
+      io_destroy(m_ctx);
+  }
+
+  virtual const char *name() const { return "libaio"; }
+
+  virtual bool init(int fd)
+  {
+    m_fd= fd;
+    return io_setup(batch_size, &m_ctx) == 0;
+  }
+
+  virtual bool io(bool write, unsigned char *const *bufs,
+                  const size_t *page_nos, size_t n)
+  {
+    struct iocb cbs[batch_size];
+    struct iocb *cbp[batch_size];
+    struct io_event events[batch_size];
+
+    for (size_t i= 0; i < n; i++)
+    {
+      long long off= static_cast<long long>(page_nos[i] * page_size);
+
+      if (write)
+        io_prep_pwrite(&cbs[i], m_fd, bufs[i], page_size, off);
+      else
+        io_prep_pread(&cbs[i], m_fd, bufs[i], page_size, off);
+      cbp[i]= &cbs[i];
+    }
+
+    if (io_submit(m_ctx, n, cbp) != static_cast<int>(n))
+      return false;
+
+    for (size_t done= 0; done < n; )
+    {
+      int ret= io_getevents(m_ctx, 1, n - done, events + done, NULL);
+
+      if (ret == -EINTR)
+        continue;
+      if (ret < 0)
+        return false;
+      for (int i= 0; i < ret; i++)
+        if (events[done + i].res != page_size)
+          return false;
+      done+= ret;
+    }
+    return true;
+  }
+
+  virtual bool flush() { return fsync(m_fd) == 0; }
+
+private:
+  int m_fd;
+  io_context_t m_ctx;
+};
+#endif /* LINUX_NATIVE_AIO */
+
+
+#ifdef LINUX_IO_URING
+/* io_uring with a registered file and registered buffers, submitting
+the batch with one io_uring_enter() and flushing with IORING_OP_FSYNC. */
+class UringBackend : public Backend
+{
+public:
+  UringBackend()
+    : m_fd(-1), m_ring_fd(-1), m_ring(MAP_FAILED), m_ring_size(0),
+      m_sqes(MAP_FAILED), m_sqes_size(0), m_fixed(false) {}
+
+  virtual ~UringBackend()
+  {
+    if (m_sqes != MAP_FAILED)
+      munmap(m_sqes, m_sqes_size);
+    if (m_ring != MAP_FAILED)
+      munmap(m_ring, m_ring_size);
+    if (m_ring_fd >= 0)
+      close(m_ring_fd);
+  }
+
+  virtual const char *name() const { return "io_uring"; }
+
+  virtual bool init(int fd)
+  {
+    struct io_uring_params p;
+
+    memset(&p, 0, sizeof p);
+    m_fd= fd;
+    m_ring_fd= static_cast<int>(syscall(__NR_io_uring_setup,
+                                        batch_size, &p));
+    if (m_ring_fd < 0 || !(p.features & IORING_FEAT_SINGLE_MMAP))
+      return false;
+
+    m_ring_size= std::max<size_t>(p.sq_off.array
+                                  + p.sq_entries * sizeof(__u32),
+                                  p.cq_off.cqes
+                                  + p.cq_entries
+                                  * sizeof(struct io_uring_cqe));
+    m_ring= mmap(NULL, m_ring_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+    m_sqes_size= p.sq_entries * sizeof(struct io_uring_sqe);
+    m_sqes= mmap(NULL, m_sqes_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+    if (m_ring == MAP_FAILED || m_sqes == MAP_FAILED)
+      return false;
+
+    char *ring= static_cast<char*>(m_ring);
+    m_sq_tail= reinterpret_cast<unsigned*>(ring + p.sq_off.tail);
+    m_sq_mask= *reinterpret_cast<unsigned*>(ring + p.sq_off.ring_mask);
+    m_sq_array= reinterpret_cast<unsigned*>(ring + p.sq_off.array);
+    m_cq_head= reinterpret_cast<unsigned*>(ring + p.cq_off.head);
+    m_cq_tail= reinterpret_cast<unsigned*>(ring + p.cq_off.tail);
+    m_cq_mask= *reinterpret_cast<unsigned*>(ring + p.cq_off.ring_mask);
+    m_cqes= reinterpret_cast<struct io_uring_cqe*>(ring + p.cq_off.cqes);
+
+    return syscall(__NR_io_uring_register, m_ring_fd,
+                   IORING_REGISTER_FILES, &m_fd, 1) == 0;
+  }
+
+  /* Registers the page buffers as fixed buffers. Buffer pool frames are
+  registered the same way by os_aio_register_buffers(). */
+  void register_buffers(unsigned char *const *bufs, size_t n)
+  {
+    struct iovec iov[batch_size];
+
+    for (size_t i= 0; i < n; i++)
+    {
+      iov[i].iov_base= bufs[i];
+      iov[i].iov_len= page_size;
+    }
+    m_fixed= syscall(__NR_io_uring_register, m_ring_fd,
+                     IORING_REGISTER_BUFFERS, iov, n) == 0;
+    m_bufs.assign(bufs, bufs + n);
+  }
+
+  bool fixed_buffers() const { return m_fixed; }
+
+  virtual bool io(bool write, unsigned char *const *bufs,
+                  const size_t *page_nos, size_t n)
+  {
+    for (size_t i= 0; i < n; i++)
+    {
+      struct io_uring_sqe *sqe= prep();
+      int buf_index= find_buf(bufs[i]);
+
+      if (buf_index >= 0)
+      {
+        sqe->opcode= write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index= static_cast<__u16>(buf_index);
+      }
+      else
+      {
+        sqe->opcode= write ? IORING_OP_WRITE : IORING_OP_READ;
+      }
+      sqe->addr= reinterpret_cast<__u64>(bufs[i]);
+      sqe->len= page_size;
+      sqe->off= page_nos[i] * page_size;
+    }
+    return submit_and_wait(n, page_size);
+  }
+
+  virtual bool flush()
+  {
+    prep()->opcode= IORING_OP_FSYNC;
+    return submit_and_wait(1, 0);
+  }
+
+private:
+  struct io_uring_sqe *prep()
+  {
+    unsigned tail= *m_sq_tail;
+    unsigned idx= tail & m_sq_mask;
+    struct io_uring_sqe *sqe= static_cast<struct io_uring_sqe*>(m_sqes)
+                              + idx;
+
+    memset(sqe, 0, sizeof *sqe);
+    sqe->fd= 0;
+    sqe->flags= IOSQE_FIXED_FILE;
+    m_sq_array[idx]= idx;
+    __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+  }
+
+  int find_buf(const unsigned char *buf) const
+  {
+    if (!m_fixed)
+      return -1;
+    for (size_t i= 0; i < m_bufs.size(); i++)
+      if (m_bufs[i] == buf)
+        return static_cast<int>(i);
+    return -1;
+  }
+
+  bool submit_and_wait(size_t n, __s32 expected)
+  {
+    size_t done= 0;
+    size_t submitted= 0;
+    bool ok= true;
+
+    while (done < n)
+    {
+      long ret= syscall(__NR_io_uring_enter, m_ring_fd, n - submitted,
+                        1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+      if (ret < 0 && errno != EINTR)
+        return false;
+      if (ret > 0)
+        submitted+= ret;
+
+      unsigned head= *m_cq_head;
+      unsigned tail= __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+
+      for (; head != tail; head++, done++)
+        if (m_cqes[head & m_cq_mask].res != expected)
+          ok= false;
+      __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+    }
+    return ok;
+  }
+
+  int m_fd;
+  int m_ring_fd;
+  void *m_ring;
+  size_t m_ring_size;
+  void *m_sqes;
+  size_t m_sqes_size;
+  unsigned *m_sq_tail;
+  unsigned m_sq_mask;
+  unsigned *m_sq_array;
+  unsigned *m_cq_head;
+  unsigned *m_cq_tail;
+  unsigned m_cq_mask;
+  struct io_uring_cqe *m_cqes;
+  bool m_fixed;
+  std::vector<unsigned char*> m_bufs;
+};
+#endif /* LINUX_IO_URING */
+
+
+class OsFileAioTest : public ::testing::Test
+{
+protected:
+  OsFileAioTest() : fd(-1), mem(NULL) {}
+
+  virtual void SetUp()
+  {
+    const char *dir= getenv("TMPDIR");
+    char path[FN_REFLEN];
+
+    snprintf(path, sizeof path, "%s/os0file-t-XXXXXX", dir ? dir : "/tmp");
+    fd= mkstemp(path);
+    ASSERT_GE(fd, 0);
+    unlink(path);
+
+    void *ptr= NULL;
+    ASSERT_EQ(0, posix_memalign(&ptr, page_size, batch_size * page_size));
+    mem= static_cast<unsigned char*>(ptr);
+    for (size_t i= 0; i < batch_size; i++)
+      bufs[i]= mem + i * page_size;
+
+    /* Write the initial contents of the file synchronously. */
+    for (size_t page_no= 0; page_no < n_file_pages; page_no++)
+    {
+      fill_page(bufs[0], page_no, 0);
+      ASSERT_EQ(static_cast<ssize_t>(page_size),
+                pwrite(fd, bufs[0], page_size,
+                       static_cast<off_t>(page_no * page_size)));
+    }
+    ASSERT_EQ(0, fsync(fd));
+    generation.assign(n_file_pages, 0);
+    srand(1);
+  }
+
+  virtual void TearDown()
+  {
+    free(mem);
+    if (fd >= 0)
+      close(fd);
+  }
+
+  /* Picks batch_size distinct random pages. */
+  void pick_pages(size_t *page_nos)
+  {
+    for (size_t i= 0; i < batch_size; i++)
+    {
+      bool dup;
+
+      do
+      {
+        page_nos[i]= static_cast<size_t>(rand()) % n_file_pages;
+        dup= false;
+        for (size_t j= 0; j < i; j++)
+          dup|= page_nos[j] == page_nos[i];
+      } while (dup);
+    }
+  }
+
+  /* Reads random batches of pages and checks their contents. */
+  void run_reads(Backend *backend, const char *what)
+  {
+    unsigned char expected[page_size];
+    size_t page_nos[batch_size];
+    ulonglong usec= 0;
+
+    for (int it= 0; it < num_iterations; it++)
+    {
+      pick_pages(page_nos);
+
+      ulonglong start= my_timer_microseconds();
+      ASSERT_TRUE(backend->io(false, bufs, page_nos, batch_size));
+      usec+= my_timer_microseconds() - start;
+
+      for (size_t i= 0; i < batch_size; i++)
+      {
+        fill_page(expected, page_nos[i], generation[page_nos[i]]);
+        ASSERT_EQ(0, memcmp(expected, bufs[i], page_size))
+          << backend->name() << " page " << page_nos[i];
+      }
+    }
+    report(backend->name(), what, usec);
+  }
+
+  /* Writes random batches of pages, each followed by a flush, and reads
+  them back synchronously. */
+  void run_flushes(Backend *backend, const char *what)
+  {
+    unsigned char check[page_size];
+    size_t page_nos[batch_size];
+    ulonglong usec= 0;
+
+    for (int it= 0; it < num_iterations; it++)
+    {
+      pick_pages(page_nos);
+      for (size_t i= 0; i < batch_size; i++)
+        fill_page(bufs[i], page_nos[i], ++generation[page_nos[i]]);
+
+      ulonglong start= my_timer_microseconds();
+      ASSERT_TRUE(backend->io(true, bufs, page_nos, batch_size));
+      ASSERT_TRUE(backend->flush());
+      usec+= my_timer_microseconds() - start;
+
+      for (size_t i= 0; i < batch_size; i++)
+      {
+        ASSERT_EQ(static_cast<ssize_t>(page_size),
+                  pread(fd, check, page_size,
+                        static_cast<off_t>(page_nos[i] * page_size)));
+        ASSERT_EQ(0, memcmp(check, bufs[i], page_size))
+          << backend->name() << " page " << page_nos[i];
+      }
+    }
+    report(backend->name(), what, usec);
+  }
+
+  // Prints the time spent per batch and the page throughput.
+  void report(const char *backend, const char *what, ulonglong usec)
+  {
+    if (usec == 0)
+      usec= 1;
+    printf("# %s %s: %.1f us per batch of %u pages, %.0f pages/s\n",
+           backend, what, (double) usec / num_iterations,
+           (unsigned) batch_size,
+           (double) num_iterations * batch_size * 1000000.0 / usec);
+  }
+
+  void run(Backend *backend)
+  {
+    run_reads(backend, "page reads");
+    run_flushes(backend, "flush batches");
+  }
+
+  int fd;
+  unsigned char *mem;
+  unsigned char *bufs[batch_size];
+  // Number of times each page of the file has been rewritten.
+  std::vector<unsigned> generation;
+};
+
+
+TEST_F(OsFileAioTest, Simulated)
+{
+  SyncBackend backend;
+
+  ASSERT_TRUE(backend.init(fd));
+  run(&backend);
+}
+
+
+#ifdef LINUX_NATIVE_AIO
+TEST_F(OsFileAioTest, Libaio)
+{
+  LibaioBackend backend;
+
+  if (!backend.init(fd))
+  {
+    printf("# libaio is not supported, skipped\n");
+    return;
+  }
+  run(&backend);
+}
+#endif /* LINUX_NATIVE_AIO */
+
+
+#ifdef LINUX_IO_URING
+TEST_F(OsFileAioTest, IoUring)
+{
+  UringBackend backend;
+
+  if (!backend.init(fd))
+  {
+    printf("# io_uring is not supported, skipped\n");
+    return;
+  }
+  backend.register_buffers(bufs, batch_size);
+  if (!backend.fixed_buffers())
+    printf("# io_uring buffers could not be registered\n");
+  run(&backend);
+}
+#endif /* LINUX_IO_URING */
+
+}
@@ -0,0 +1,183 @@
+/* Copyright (c) 2017, Percona Inc. All Rights Reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "my_global.h"
+#include "my_rdtsc.h"
+
+#include "univ.i"
+#include "ut0crc32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace innodb_ut0crc32_unittest {
+
+/*
+  Checks the CRC-32C implementation chosen at runtime against a bitwise
+  reference, and reports its throughput.
+
+  The throughput tests are microbenchmarks: increase num_iterations to get
+  stable numbers.
+*/
+
+/* Bitwise CRC-32C, reflected polynomial 0x82f63b78. */
+static ib_uint32_t crc32c_reference(const byte *buf, ulint len)
+{
+  ib_uint32_t crc= 0xFFFFFFFF;
+
+  while (len--)
+  {
+    crc^= *buf++;
+    for (int k= 0; k < 8; k++)
+      crc= (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+  }
+  return ~crc;
+}
+
+
+class UtCrc32Test : public ::testing::Test
+{
+protected:
+  // Number of times each buffer is checksummed. Increase for benchmarking!
+  static const int num_iterations= 1000;
+  // Size of an InnoDB page with the default page size.
+  static const ulint page_size= 16384;
+  // Size of a redo log block and of its checksummed part.
+  static const ulint log_block_size= 512;
+  static const ulint log_block_data= 508;
+
+  static void SetUpTestCase()
+  {
+    ut_crc32_init();
+  }
+
+  virtual void SetUp()
+  {
+    data.resize(4 * page_size);
+    for (ulint ix= 0; ix < data.size(); ix++)
+      data[ix]= static_cast<byte>(rand());
+  }
+
+  // Prints the throughput of processing bytes in the given time.
+  void report(const char *what, ulonglong bytes, ulonglong usec)
+  {
+    if (usec == 0)
+      usec= 1;
+    printf("# %s: %.2f GB/s (%s CPU crc32 instructions)\n",
+           what, (double) bytes / usec / 1000.0,
+           ut_crc32_sse2_enabled ? "using" : "not using");
+  }
+
+  std::vector<byte> data;
+};
+
+
+TEST_F(UtCrc32Test, KnownValue)
+{
+  const char *check= "123456789";
+
+  EXPECT_EQ(0xE3069283U, ut_crc32((const byte*) check, 9));
+  EXPECT_EQ(0U, ut_crc32((const byte*) check, 0));
+}
+
+
+TEST_F(UtCrc32Test, MatchesReference)
+{
+  /* Cover unaligned starts and the lengths at which the interleaved
+     streams of long and short blocks kick in. */
+  const ulint lengths[]= { 1, 7, 8, 31, 767, 768, 769, 1000, 4096,
+                           12287, 12288, 12289, 13056, 16338, 16384,
+                           3 * 16384 };
+
+  for (ulint offset= 0; offset < 8; offset++)
+  {
+    for (ulint ix= 0; ix < array_elements(lengths); ix++)
+    {
+      const byte *buf= &data[offset];
+      ulint len= lengths[ix];
+
+      EXPECT_EQ(crc32c_reference(buf, len), ut_crc32(buf, len))
+        << "offset " << offset << " length " << len;
+    }
+  }
+}
+
+
+TEST_F(UtCrc32Test, Batch)
+{
+  const ulint max_blocks= data.size() / log_block_size;
+  std::vector<ib_uint32_t> crcs(max_blocks);
+
+  for (ulint n= 0; n <= 7; n++)
+  {
+    ut_crc32_batch(&data[0], log_block_data, log_block_size, n, &crcs[0]);
+    for (ulint ix= 0; ix < n; ix++)
+      EXPECT_EQ(ut_crc32(&data[ix * log_block_size], log_block_data),
+                crcs[ix]) << "batch of " << n << " block " << ix;
+  }
+
+  ut_crc32_batch(&data[1], 100, 333, 10, &crcs[0]);
+  for (ulint ix= 0; ix < 10; ix++)
+    EXPECT_EQ(crc32c_reference(&data[1 + ix * 333], 100), crcs[ix]);
+}
+
+
+TEST_F(UtCrc32Test, PageThroughput)
+{
+  ib_uint32_t sum= 0;
+  ulonglong start= my_timer_microseconds();
+
+  for (int i= 0; i < num_iterations; i++)
+    sum+= ut_crc32(&data[0], page_size);
+
+  report("page checksums", (ulonglong) num_iterations * page_size,
+         my_timer_microseconds() - start);
+  EXPECT_EQ(crc32c_reference(&data[0], page_size) * num_iterations, sum);
+}
+
+
+TEST_F(UtCrc32Test, LogBlockThroughput)
+{
+  const ulint n_blocks= data.size() / log_block_size;
+  std::vector<ib_uint32_t> crcs(n_blocks);
+  ulonglong start;
+
+  start= my_timer_microseconds();
+  for (int i= 0; i < num_iterations; i++)
+    for (ulint ix= 0; ix < n_blocks; ix++)
+      crcs[ix]= ut_crc32(&data[ix * log_block_size], log_block_data);
+  report("log block checksums, one by one",
+         (ulonglong) num_iterations * n_blocks * log_block_data,
+         my_timer_microseconds() - start);
+
+  start= my_timer_microseconds();
+  for (int i= 0; i < num_iterations; i++)
+    ut_crc32_batch(&data[0], log_block_data, log_block_size, n_blocks,
+                   &crcs[0]);
+  report("log block checksums, in batches",
+         (ulonglong) num_iterations * n_blocks * log_block_data,
+         my_timer_microseconds() - start);
+
+  for (ulint ix= 0; ix < n_blocks; ix++)
+    EXPECT_EQ(crc32c_reference(&data[ix * log_block_size], log_block_data),
+              crcs[ix]);
+}
+
+}